@@ -2,6 +2,7 @@ package com.contactsmanagerrn
 
 import com.facebook.react.bridge.*
 import io.contactsmanager.api.ContactService
+import io.contactsmanager.api.models.CMContact
 import io.contactsmanager.api.models.CMContactFieldType
 import io.contactsmanager.api.models.CMContactsManagerOptions
 import io.contactsmanager.api.models.CMUserInfo
@@ -10,12 +11,27 @@ import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.withContext
+import java.util.UUID
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicLong
 
 class RNContactService(private val reactContext: ReactApplicationContext) :
     ReactContextBaseJavaModule(reactContext) {
 
     private val coroutineScope = CoroutineScope(Dispatchers.Main)
 
+    // ContactService has no streaming enumeration on Android, so a cursor pages through one fetch
+    private class ContactCursorState(val contacts: List<CMContact>) {
+        var position = 0
+    }
+
+    private val contactCursors = ConcurrentHashMap<Long, ContactCursorState>()
+    private val nextCursorId = AtomicLong(1)
+
+    // No change history on Android: every change set is a full scan and only its token can be committed
+    private val changesLock = Any()
+    private var pendingChangesToken: String? = null
+
     override fun getName(): String {
         return "RNContactService"
     }
@@ -190,6 +206,87 @@ class RNContactService(private val reactContext: ReactApplicationContext) :
         }
     }
 
+    @ReactMethod
+    fun openContactCursor(fieldType: Int, readAhead: Int, promise: Promise) {
+        coroutineScope.launch {
+            try {
+                val contactService = ContactService.getInstance(reactContext)
+                val cmFieldType = when (fieldType) {
+                    0 -> CMContactFieldType.ANY
+                    1 -> CMContactFieldType.PHONE
+                    2 -> CMContactFieldType.EMAIL
+                    3 -> CMContactFieldType.NOTES
+                    else -> CMContactFieldType.ANY
+                }
+
+                val result = withContext(Dispatchers.IO) {
+                    contactService.fetchContacts(cmFieldType)
+                }
+
+                result.fold(
+                    onSuccess = { contacts ->
+                        val cursorId = nextCursorId.getAndIncrement()
+                        contactCursors[cursorId] = ContactCursorState(contacts)
+                        val response = Arguments.createMap().apply {
+                            putString("token", cursorToken(cursorId, 0))
+                        }
+                        promise.resolve(response)
+                    },
+                    onFailure = { error ->
+                        promise.reject("cursor_error", error.message, error)
+                    }
+                )
+            } catch (e: Exception) {
+                promise.reject("cursor_error", "Failed to open contact cursor: ${e.message}", e)
+            }
+        }
+    }
+
+    @ReactMethod
+    fun readContactCursor(token: String, count: Int, promise: Promise) {
+        val position = parseCursorToken(token)
+        if (position == null) {
+            promise.reject("invalid_argument", "Invalid cursor token: $token")
+            return
+        }
+        val cursor = contactCursors[position.first]
+        if (cursor == null) {
+            promise.reject("cursor_closed", "Contact cursor is closed")
+            return
+        }
+
+        synchronized(cursor) {
+            if (position.second != cursor.position) {
+                promise.reject("stale_cursor_token", "Cursor token is not the cursor's current position")
+                return
+            }
+            val end = minOf(cursor.contacts.size, cursor.position + maxOf(count, 1))
+            val page = cursor.contacts.subList(cursor.position, end)
+            cursor.position = end
+            val done = end == cursor.contacts.size
+            if (done) {
+                contactCursors.remove(position.first)
+            }
+
+            val response = Arguments.createMap().apply {
+                putArray("contacts", ContactsConverter.toJSArray(page))
+                putString("token", cursorToken(position.first, end))
+                putBoolean("done", done)
+            }
+            promise.resolve(response)
+        }
+    }
+
+    @ReactMethod
+    fun closeContactCursor(token: String, promise: Promise) {
+        val position = parseCursorToken(token)
+        if (position == null) {
+            promise.reject("invalid_argument", "Invalid cursor token: $token")
+            return
+        }
+        promise.resolve(contactCursors.remove(position.first) != null)
+    }
+
     @ReactMethod
     fun fetchContactWithId(contactId: String, promise: Promise) {
         coroutineScope.launch {
@@ -217,6 +314,21 @@ class RNContactService(private val reactContext: ReactApplicationContext) :
         }
     }
 
+    @ReactMethod
+    fun setImageTransferMode(mode: String, promise: Promise) {
+        // Photos always travel inline on Android; there is no image cache to hand out handles from
+        when (mode) {
+            "inline" -> promise.resolve(true)
+            "handle" -> promise.reject("unsupported", "Image handles are not supported on Android; photos are sent inline")
+            else -> promise.reject("invalid_argument", "Unknown image transfer mode: $mode")
+        }
+    }
+
+    @ReactMethod
+    fun getContactImage(imageId: String, sizeClass: String, promise: Promise) {
+        promise.reject("unsupported", "getContactImage is not supported on Android; photos are sent inline")
+    }
+
     @ReactMethod
     fun getContactsCount(promise: Promise) {
         coroutineScope.launch {
@@ -299,6 +411,52 @@ class RNContactService(private val reactContext: ReactApplicationContext) :
         }
     }
 
+    @ReactMethod
+    fun getContactChangesForSync(promise: Promise) {
+        coroutineScope.launch {
+            try {
+                val contactService = ContactService.getInstance(reactContext)
+                val result = withContext(Dispatchers.IO) {
+                    contactService.fetchContacts()
+                }
+
+                result.fold(
+                    onSuccess = { contacts ->
+                        val token = UUID.randomUUID().toString()
+                        synchronized(changesLock) {
+                            pendingChangesToken = token
+                        }
+                        val response = Arguments.createMap().apply {
+                            putArray("added", ContactsConverter.toJSArray(contacts))
+                            putArray("updated", Arguments.createArray())
+                            putArray("deletedIds", Arguments.createArray())
+                            putBoolean("fullScan", true)
+                            putString("token", token)
+                        }
+                        promise.resolve(response)
+                    },
+                    onFailure = { error ->
+                        promise.reject("sync_error", error.message, error)
+                    }
+                )
+            } catch (e: Exception) {
+                promise.reject("sync_error", "Failed to read contact changes: ${e.message}", e)
+            }
+        }
+    }
+
+    @ReactMethod
+    fun commitContactChanges(token: String, promise: Promise) {
+        val committed = synchronized(changesLock) {
+            val pending = pendingChangesToken == token
+            if (pending) {
+                pendingChangesToken = null
+            }
+            pending
+        }
+        promise.resolve(committed)
+    }
+
     @ReactMethod
     fun startSync(sourceId: String, userId: String, promise: Promise) {
         coroutineScope.launch {
@@ -331,8 +489,26 @@ class RNContactService(private val reactContext: ReactApplicationContext) :
         promise.resolve(true)
     }
 
+    override fun invalidate() {
+        // Cursors left open by a reloaded JS context would keep their contacts alive
+        contactCursors.clear()
+        super.invalidate()
+    }
+
     // Helper methods for converting between JS and native objects
 
+    private fun cursorToken(cursorId: Long, position: Int): String = "$cursorId:$position"
+
+    private fun parseCursorToken(token: String): Pair<Long, Int>? {
+        val parts = token.split(":")
+        if (parts.size != 2) {
+            return null
+        }
+        val cursorId = parts[0].toLongOrNull() ?: return null
+        val position = parts[1].toIntOrNull() ?: return null
+        return Pair(cursorId, position)
+    }
+
     private fun readableMapToUserInfo(userInfo: ReadableMap): CMUserInfo {
         return CMUserInfo(
             userId = userInfo.getString("userId") ?: throw IllegalArgumentException("userId is required"),
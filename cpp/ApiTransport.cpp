@@ -0,0 +1,52 @@
+//
+//  ApiTransport.cpp
+//  ContactsManagerCore
+//
+
+#include "ApiTransport.h"
+
+#include "TextUtils.h"
+
+#include <algorithm>
+
+namespace contactsmanager {
+
+namespace {
+
+void appendPercentEncoded(std::string &out, std::string_view value) {
+  static const char kHex[] = "0123456789ABCDEF";
+  for (char c : value) {
+    if (text::isAsciiAlnum(c) || c == '-' || c == '.' || c == '_' || c == '~') {
+      out.push_back(c);
+    } else {
+      unsigned char byte = static_cast<unsigned char>(c);
+      out.push_back('%');
+      out.push_back(kHex[byte >> 4]);
+      out.push_back(kHex[byte & 0xF]);
+    }
+  }
+}
+
+} // namespace
+
+std::string canonicalParameters(const std::vector<std::pair<std::string, std::string>> &parameters) {
+  std::vector<const std::pair<std::string, std::string> *> sorted;
+  sorted.reserve(parameters.size());
+  for (const auto &parameter : parameters) {
+    sorted.push_back(&parameter);
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const auto *lhs, const auto *rhs) { return *lhs < *rhs; });
+
+  std::string out;
+  for (const auto *parameter : sorted) {
+    if (!out.empty()) {
+      out.push_back('&');
+    }
+    appendPercentEncoded(out, parameter->first);
+    out.push_back('=');
+    appendPercentEncoded(out, parameter->second);
+  }
+  return out;
+}
+
+} // namespace contactsmanager
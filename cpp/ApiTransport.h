@@ -0,0 +1,62 @@
+//
+//  ApiTransport.h
+//  ContactsManagerCore
+//
+//  Portable form of a CMAPIClient call, so request-level policies (caching,
+//  batching) can live in the core and be tested against a local stand-in.
+//
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace contactsmanager {
+
+struct ApiRequest {
+  std::string method = "GET";
+  // Path below the API base URL, e.g. "/api/v1/recommendations/contacts-using-app"
+  std::string endpoint;
+  // Query parameters for GET, JSON body fields otherwise
+  std::vector<std::pair<std::string, std::string>> parameters;
+  // JSON body sent as is, for bodies that are not flat string fields; parameters are then ignored
+  std::string body;
+  bool requiresAuth = true;
+  // Sent as If-None-Match when set
+  std::string ifNoneMatch;
+};
+
+struct ApiResponse {
+  // HTTP status, 0 when no response arrived
+  int statusCode = 0;
+  std::string body;
+  // ETag header, empty if none
+  std::string etag;
+
+  bool ok() const { return statusCode >= 200 && statusCode < 300; }
+  bool notModified() const { return statusCode == 304; }
+};
+
+/**
+ * Sends API requests (CMAPIClient on iOS, a local stand-in on the host)
+ */
+class ApiTransport {
+public:
+  virtual ~ApiTransport() = default;
+
+  /**
+   * Sends the request and calls done exactly once, from any thread
+   */
+  virtual void send(ApiRequest request, std::function<void(ApiResponse response)> done) = 0;
+};
+
+/**
+ * Parameters sorted by name and percent-encoded as "a=1&b=2", so equal
+ * parameter sets give equal strings whatever order they were added in
+ */
+std::string canonicalParameters(const std::vector<std::pair<std::string, std::string>> &parameters);
+
+} // namespace contactsmanager
@@ -0,0 +1,83 @@
+//
+//  Base64.cpp
+//  ContactsManagerCore
+//
+
+#include "Base64.h"
+
+namespace contactsmanager {
+namespace base64 {
+
+namespace {
+const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int sextetFor(char c) {
+  if (c >= 'A' && c <= 'Z') {
+    return c - 'A';
+  }
+  if (c >= 'a' && c <= 'z') {
+    return c - 'a' + 26;
+  }
+  if (c >= '0' && c <= '9') {
+    return c - '0' + 52;
+  }
+  return c == '+' ? 62 : c == '/' ? 63 : -1;
+}
+} // namespace
+
+std::string encode(const uint8_t *data, size_t size) {
+  std::string out(encodedLength(size), '=');
+  size_t o = 0;
+  size_t i = 0;
+  for (; i + 3 <= size; i += 3) {
+    uint32_t triple = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | uint32_t(data[i + 2]);
+    out[o++] = kAlphabet[(triple >> 18) & 0x3f];
+    out[o++] = kAlphabet[(triple >> 12) & 0x3f];
+    out[o++] = kAlphabet[(triple >> 6) & 0x3f];
+    out[o++] = kAlphabet[triple & 0x3f];
+  }
+  size_t remaining = size - i;
+  if (remaining > 0) {
+    uint32_t triple = uint32_t(data[i]) << 16;
+    if (remaining == 2) {
+      triple |= uint32_t(data[i + 1]) << 8;
+    }
+    out[o++] = kAlphabet[(triple >> 18) & 0x3f];
+    out[o++] = kAlphabet[(triple >> 12) & 0x3f];
+    if (remaining == 2) {
+      out[o++] = kAlphabet[(triple >> 6) & 0x3f];
+    }
+  }
+  return out;
+}
+
+bool decode(std::string_view encoded, std::string &out) {
+  out.clear();
+  if (encoded.size() % 4 != 0) {
+    return false;
+  }
+  out.reserve(encoded.size() / 4 * 3);
+  for (size_t i = 0; i < encoded.size(); i += 4) {
+    bool last = i + 4 == encoded.size();
+    size_t padding = last && encoded[i + 3] == '=' ? 1 + (encoded[i + 2] == '=') : 0;
+    uint32_t quad = 0;
+    for (size_t j = 0; j < 4; ++j) {
+      int sextet = j >= 4 - padding ? 0 : sextetFor(encoded[i + j]);
+      if (sextet < 0) {
+        return false;
+      }
+      quad = (quad << 6) | static_cast<uint32_t>(sextet);
+    }
+    out.push_back(static_cast<char>(quad >> 16));
+    if (padding < 2) {
+      out.push_back(static_cast<char>(quad >> 8));
+    }
+    if (padding < 1) {
+      out.push_back(static_cast<char>(quad));
+    }
+  }
+  return true;
+}
+
+} // namespace base64
+} // namespace contactsmanager
@@ -0,0 +1,31 @@
+//
+//  Base64.h
+//  ContactsManagerCore
+//
+//  Standard (RFC 4648) base64 with padding, matching
+//  -[NSData base64EncodedStringWithOptions:0].
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace contactsmanager {
+namespace base64 {
+
+constexpr size_t encodedLength(size_t byteCount) {
+  return ((byteCount + 2) / 3) * 4;
+}
+
+std::string encode(const uint8_t *data, size_t size);
+
+/**
+ * Decodes padded base64 into out; false (out unspecified) on any other input
+ */
+bool decode(std::string_view encoded, std::string &out);
+
+} // namespace base64
+} // namespace contactsmanager
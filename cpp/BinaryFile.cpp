@@ -0,0 +1,118 @@
+//
+//  BinaryFile.cpp
+//  ContactsManagerCore
+//
+
+#include "BinaryFile.h"
+
+#include "ContactHashing.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace contactsmanager {
+namespace binary {
+
+void writeUint32(std::string &out, uint32_t value) {
+  char bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  out.append(bytes, sizeof(value));
+}
+
+void writeUint64(std::string &out, uint64_t value) {
+  char bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  out.append(bytes, sizeof(value));
+}
+
+void writeDouble(std::string &out, double value) {
+  char bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  out.append(bytes, sizeof(value));
+}
+
+void writeString(std::string &out, std::string_view value) {
+  writeUint32(out, static_cast<uint32_t>(value.size()));
+  out.append(value);
+}
+
+bool Reader::readString(std::string &value) {
+  uint32_t length = 0;
+  if (!readUint32(length) || length > data_.size() - offset_) {
+    return false;
+  }
+  value.assign(data_.data() + offset_, length);
+  offset_ += length;
+  return true;
+}
+
+bool Reader::expect(std::string_view bytes) {
+  if (data_.substr(offset_, bytes.size()) != bytes) {
+    return false;
+  }
+  offset_ += bytes.size();
+  return true;
+}
+
+bool Reader::readRaw(void *value, size_t size) {
+  if (size > data_.size() - offset_) {
+    return false;
+  }
+  std::memcpy(value, data_.data() + offset_, size);
+  offset_ += size;
+  return true;
+}
+
+bool readFile(const std::string &path, std::string &data) {
+  data.clear();
+  FILE *file = std::fopen(path.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+  char buffer[64 * 1024];
+  size_t read = 0;
+  while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.append(buffer, read);
+  }
+  std::fclose(file);
+  return true;
+}
+
+bool writeFileAtomically(const std::string &path, std::string_view data) {
+  std::string temporaryPath = path + ".tmp";
+  FILE *file = std::fopen(temporaryPath.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+  written = std::fclose(file) == 0 && written;
+  if (!written || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool writeAll(int fd, const void *bytes, size_t length, off_t offset) {
+  const char *next = static_cast<const char *>(bytes);
+  while (length > 0) {
+    ssize_t written = ::pwrite(fd, next, length, offset);
+    if (written <= 0) {
+      return false;
+    }
+    next += written;
+    length -= static_cast<size_t>(written);
+    offset += written;
+  }
+  return true;
+}
+
+uint32_t checksum32(const void *bytes, size_t length) {
+  uint64_t hash = fnv1a64(std::string_view(static_cast<const char *>(bytes), length));
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+} // namespace binary
+} // namespace contactsmanager
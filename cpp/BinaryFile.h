@@ -0,0 +1,84 @@
+//
+//  BinaryFile.h
+//  ContactsManagerCore
+//
+//  Helpers for the small on-device files the core persists (search index,
+//  change tracker state). Values are written in native byte order since the
+//  files never leave the device; every read is bounds checked so a truncated
+//  or corrupt file is rejected rather than misread.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <sys/types.h>
+
+namespace contactsmanager {
+namespace binary {
+
+void writeUint32(std::string &out, uint32_t value);
+void writeUint64(std::string &out, uint64_t value);
+
+/**
+ * The IEEE 754 bits, as writeUint64 would write them
+ */
+void writeDouble(std::string &out, double value);
+
+/**
+ * Length-prefixed (uint32) string
+ */
+void writeString(std::string &out, std::string_view value);
+
+class Reader {
+public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  bool readUint32(uint32_t &value) { return readRaw(&value, sizeof(value)); }
+  bool readUint64(uint64_t &value) { return readRaw(&value, sizeof(value)); }
+  bool readDouble(double &value) { return readRaw(&value, sizeof(value)); }
+  bool readString(std::string &value);
+
+  /**
+   * Consumes the expected bytes, e.g. a file magic
+   */
+  bool expect(std::string_view bytes);
+
+  bool atEnd() const { return offset_ == data_.size(); }
+
+private:
+  bool readRaw(void *value, size_t size);
+
+  std::string_view data_;
+  size_t offset_ = 0;
+};
+
+/**
+ * Reads the whole file; false if it cannot be opened
+ */
+bool readFile(const std::string &path, std::string &data);
+
+/**
+ * Writes the file atomically (temporary file + rename)
+ */
+bool writeFileAtomically(const std::string &path, std::string_view data);
+
+/**
+ * pwrite until every byte is written; false on the first error
+ */
+bool writeAll(int fd, const void *bytes, size_t length, off_t offset);
+
+/**
+ * 32-bit record checksum (folded FNV-1a) the journaled files use to tell a
+ * torn write from a real record
+ */
+uint32_t checksum32(const void *bytes, size_t length);
+inline uint32_t checksum32(std::string_view bytes) {
+  return checksum32(bytes.data(), bytes.size());
+}
+
+} // namespace binary
+} // namespace contactsmanager
@@ -0,0 +1,105 @@
+//
+//  BulkCreateBodyStream.cpp
+//  ContactsManagerCore
+//
+
+#include "BulkCreateBodyStream.h"
+
+#include "DeflateStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace contactsmanager {
+
+BulkCreateBodyStream::BulkCreateBodyStream(const Contact *first, size_t count, ServerContactContext context,
+                                           bool skipDuplicates, WireEncoding encoding)
+    : first_(first), count_(count), context_(std::move(context)), skipDuplicates_(skipDuplicates) {
+  if (encoding.format == WireFormat::Cbor) {
+    cbor_.emplace(encoded_);
+  } else {
+    json_.emplace(encoded_);
+  }
+  if (encoding.compression != WireCompression::None) {
+    deflate_ = std::make_unique<DeflateStream>(
+        compressed_, encoding.compression == WireCompression::Gzip ? DeflateFormat::Gzip : DeflateFormat::Zlib);
+    pending_ = &compressed_;
+  } else {
+    pending_ = &encoded_;
+  }
+}
+
+BulkCreateBodyStream::~BulkCreateBodyStream() = default;
+
+template <typename Writer>
+void BulkCreateBodyStream::encodeNext(Writer &writer) {
+  if (stage_ == Stage::Start) {
+    writer.beginObject();
+    writer.key("contacts");
+    writer.beginArray();
+    stage_ = Stage::Contacts;
+  }
+  if (next_ < count_) {
+    writeServerContact(writer, first_[next_++], context_);
+    return;
+  }
+  writer.endArray();
+  writer.key("skipDuplicates");
+  writer.boolValue(skipDuplicates_);
+  writer.endObject();
+  stage_ = Stage::Finished;
+}
+
+bool BulkCreateBodyStream::fill() {
+  pending_->clear();
+  pendingOffset_ = 0;
+  // The compressor may hold a whole contact back, so keep going until it emits
+  while (pending_->empty() && stage_ != Stage::Finished && !failed_) {
+    if (cbor_) {
+      encodeNext(*cbor_);
+    } else {
+      encodeNext(*json_);
+    }
+    if (deflate_) {
+      bool compressed = deflate_->write(encoded_) && (stage_ != Stage::Finished || deflate_->finish());
+      encoded_.clear();
+      if (!compressed) {
+        failed_ = true;
+        compressed_.clear();
+      }
+    }
+  }
+  return !pending_->empty();
+}
+
+std::string_view BulkCreateBodyStream::nextChunk() {
+  if (pendingOffset_ == pending_->size() && !fill()) {
+    return {};
+  }
+  std::string_view chunk = std::string_view(*pending_).substr(pendingOffset_);
+  pendingOffset_ = pending_->size();
+  bytesRead_ += chunk.size();
+  return chunk;
+}
+
+size_t BulkCreateBodyStream::read(char *buffer, size_t capacity) {
+  size_t copied = 0;
+  while (copied < capacity) {
+    if (pendingOffset_ == pending_->size() && !fill()) {
+      break;
+    }
+    size_t length = std::min(capacity - copied, pending_->size() - pendingOffset_);
+    std::memcpy(buffer + copied, pending_->data() + pendingOffset_, length);
+    pendingOffset_ += length;
+    copied += length;
+  }
+  bytesRead_ += copied;
+  return copied;
+}
+
+bool BulkCreateBodyStream::atEnd() const {
+  return !failed_ && stage_ == Stage::Finished && pendingOffset_ == pending_->size();
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,91 @@
+//
+//  BulkCreateBodyStream.h
+//  ContactsManagerCore
+//
+//  CMServerContactBulkCreate body produced on demand, for a chunked HTTP body
+//  (an NSInputStream behind HTTPBodyStream) instead of one NSData. Each refill
+//  serializes the next contact straight from its fields, so the stream holds
+//  one contact's encoding plus the compressor window, however large the batch.
+//
+//  The bytes are identical to encodeBulkCreateBody for the same encoding.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "ServerContactJson.h"
+#include "SyncWireFormat.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace contactsmanager {
+
+class DeflateStream;
+
+class BulkCreateBodyStream {
+public:
+  /**
+   * Streams contacts [first, first + count), which must stay alive and
+   * unchanged until the body is read
+   */
+  BulkCreateBodyStream(const Contact *first, size_t count, ServerContactContext context, bool skipDuplicates,
+                       WireEncoding encoding = {});
+  ~BulkCreateBodyStream();
+
+  BulkCreateBodyStream(const BulkCreateBodyStream &) = delete;
+  BulkCreateBodyStream &operator=(const BulkCreateBodyStream &) = delete;
+
+  /**
+   * Next piece of the body, valid until the following call; empty once the
+   * body is complete or compression failed
+   */
+  std::string_view nextChunk();
+
+  /**
+   * Copies up to capacity bytes into buffer (NSInputStream read:maxLength:);
+   * 0 once the body is complete or compression failed
+   */
+  size_t read(char *buffer, size_t capacity);
+
+  /**
+   * True once every byte has been handed out
+   */
+  bool atEnd() const;
+
+  bool failed() const { return failed_; }
+  size_t bytesRead() const { return bytesRead_; }
+
+private:
+  enum class Stage { Start, Contacts, Finished };
+
+  bool fill();
+  template <typename Writer>
+  void encodeNext(Writer &writer);
+
+  const Contact *first_;
+  size_t count_;
+  ServerContactContext context_;
+  bool skipDuplicates_;
+
+  // Writer output; handed to the compressor when there is one, else it is the pending bytes
+  std::string encoded_;
+  // Bytes ready to read, from pendingOffset_
+  std::string compressed_;
+  std::string *pending_;
+  size_t pendingOffset_ = 0;
+
+  std::optional<JsonWriter> json_;
+  std::optional<CborWriter> cbor_;
+  std::unique_ptr<DeflateStream> deflate_;
+
+  Stage stage_ = Stage::Start;
+  size_t next_ = 0;
+  size_t bytesRead_ = 0;
+  bool failed_ = false;
+};
+
+} // namespace contactsmanager
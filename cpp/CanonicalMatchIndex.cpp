@@ -0,0 +1,357 @@
+//
+//  CanonicalMatchIndex.cpp
+//  ContactsManagerCore
+//
+
+#include "CanonicalMatchIndex.h"
+
+#include "BinaryFile.h"
+#include "ContactHashing.h"
+#include "PhoneNumberKey.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'C', 'M', 'C', 'M'};
+constexpr uint32_t kFileVersion = 1;
+// Phone keys use the low 55 bits; email keys are told apart by the top bit
+constexpr uint64_t kEmailKeyBit = 1ULL << 63;
+
+std::vector<uint64_t> matchKeysFor(const Contact &contact, uint16_t defaultCountryCode) {
+  std::vector<uint64_t> keys;
+  keys.reserve(contact.phoneNumbers.size() + contact.emailAddresses.size());
+  for (const auto &phone : contact.phoneNumbers) {
+    if (uint64_t key = phoneMatchKey(phone.value, defaultCountryCode)) {
+      keys.push_back(key);
+    }
+  }
+  for (const auto &email : contact.emailAddresses) {
+    if (uint64_t key = emailMatchKey(email.value)) {
+      keys.push_back(key);
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+void writeEntry(std::string &out, const LocalCanonicalContact &entry) {
+  const CanonicalContact &canonical = entry.canonicalContact;
+  binary::writeString(out, entry.contactId);
+  binary::writeString(out, entry.sourceContactId);
+  binary::writeString(out, canonical.identifier);
+  binary::writeString(out, canonical.organizationId);
+  binary::writeString(out, canonical.organizationUserId);
+  binary::writeString(out, canonical.email);
+  binary::writeString(out, canonical.phone);
+  binary::writeString(out, canonical.fullName);
+  binary::writeString(out, canonical.avatarUrl);
+  binary::writeUint32(out, canonical.isActive ? 1 : 0);
+  binary::writeDouble(out, canonical.createdAt);
+  binary::writeDouble(out, canonical.updatedAt);
+}
+
+bool readEntry(binary::Reader &reader, LocalCanonicalContact &entry) {
+  CanonicalContact &canonical = entry.canonicalContact;
+  uint32_t isActive = 0;
+  if (!reader.readString(entry.contactId) || !reader.readString(entry.sourceContactId) ||
+      !reader.readString(canonical.identifier) || !reader.readString(canonical.organizationId) ||
+      !reader.readString(canonical.organizationUserId) || !reader.readString(canonical.email) ||
+      !reader.readString(canonical.phone) || !reader.readString(canonical.fullName) ||
+      !reader.readString(canonical.avatarUrl) || !reader.readUint32(isActive) || isActive > 1 ||
+      !reader.readDouble(canonical.createdAt) || !reader.readDouble(canonical.updatedAt)) {
+    return false;
+  }
+  canonical.isActive = isActive != 0;
+  return true;
+}
+
+} // namespace
+
+uint64_t emailMatchKey(std::string_view email) {
+  std::string_view address = text::trimmed(email);
+  if (address.empty()) {
+    return 0;
+  }
+  return fnv1a64(text::lowercased(address)) | kEmailKeyBit;
+}
+
+uint64_t phoneMatchKey(std::string_view phone, uint16_t defaultCountryCode) {
+  return phoneKeyFor(phone, defaultCountryCode).bits();
+}
+
+bool CanonicalMatchIndex::upsertContact(const Contact &contact) {
+  if (contact.isDeleted) {
+    return removeContact(contact.identifier);
+  }
+  std::vector<uint64_t> keys = matchKeysFor(contact, options_.defaultCountryCode);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = keysByContact_.find(contact.identifier);
+  if (found == keysByContact_.end()) {
+    addKeysLocked(contact.identifier, keys);
+    keysByContact_.emplace(contact.identifier, std::move(keys));
+    return true;
+  }
+  if (found->second == keys) {
+    return false;
+  }
+  // Only the keys that came or went touch the key map
+  std::vector<uint64_t> removed;
+  std::vector<uint64_t> added;
+  std::set_difference(found->second.begin(), found->second.end(), keys.begin(), keys.end(),
+                      std::back_inserter(removed));
+  std::set_difference(keys.begin(), keys.end(), found->second.begin(), found->second.end(),
+                      std::back_inserter(added));
+  removeKeysLocked(contact.identifier, removed);
+  addKeysLocked(contact.identifier, added);
+  found->second = std::move(keys);
+  return true;
+}
+
+bool CanonicalMatchIndex::removeContact(std::string_view identifier) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = keysByContact_.find(std::string(identifier));
+  if (found == keysByContact_.end()) {
+    return false;
+  }
+  removeKeysLocked(found->first, found->second);
+  keysByContact_.erase(found);
+  return true;
+}
+
+size_t CanonicalMatchIndex::syncWith(const std::vector<Contact> &contacts) {
+  size_t changed = 0;
+  std::unordered_set<std::string_view> live;
+  live.reserve(contacts.size());
+  for (const auto &contact : contacts) {
+    changed += upsertContact(contact) ? 1 : 0;
+    if (!contact.isDeleted) {
+      live.insert(contact.identifier);
+    }
+  }
+
+  std::vector<std::string> gone;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &entry : keysByContact_) {
+      if (live.count(entry.first) == 0) {
+        gone.push_back(entry.first);
+      }
+    }
+  }
+  for (const auto &identifier : gone) {
+    changed += removeContact(identifier) ? 1 : 0;
+  }
+  return changed;
+}
+
+std::vector<std::string> CanonicalMatchIndex::contactsMatching(std::string_view email, std::string_view phone) const {
+  uint64_t keys[2] = {emailMatchKey(email), phoneMatchKey(phone, options_.defaultCountryCode)};
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::string> matches;
+  for (uint64_t key : keys) {
+    auto found = key == 0 ? contactsByKey_.end() : contactsByKey_.find(key);
+    if (found != contactsByKey_.end()) {
+      matches.insert(matches.end(), found->second.begin(), found->second.end());
+    }
+  }
+  std::sort(matches.begin(), matches.end());
+  matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+  return matches;
+}
+
+std::string CanonicalMatchIndex::resolveLocalContact(const LocalCanonicalContact &entry) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return resolveLocked(entry);
+}
+
+void CanonicalMatchIndex::storeContactsUsingApp(std::vector<LocalCanonicalContact> results, size_t limit,
+                                                double now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cached_ = true;
+  results_ = std::move(results);
+  fetchedLimit_ = limit;
+  fetchedAt_ = now;
+}
+
+void CanonicalMatchIndex::invalidate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cached_ = false;
+  results_.clear();
+  fetchedLimit_ = 0;
+  fetchedAt_ = 0;
+}
+
+CachedCanonicalMatches CanonicalMatchIndex::contactsUsingApp(size_t limit, double now) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CachedCanonicalMatches cached;
+  // A response shorter than its limit was the whole list, so it covers any limit
+  if (!cached_ || (limit > fetchedLimit_ && results_.size() >= fetchedLimit_)) {
+    return cached;
+  }
+  cached.hit = true;
+  // A clock that went backwards cannot vouch for the response either
+  cached.stale = now < fetchedAt_ || now - fetchedAt_ >= options_.ttl;
+
+  size_t count = std::min(limit, results_.size());
+  cached.matches.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    cached.matches.push_back(CanonicalMatch{results_[i], resolveLocked(results_[i])});
+  }
+  return cached;
+}
+
+size_t CanonicalMatchIndex::contactCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return keysByContact_.size();
+}
+
+// File layout (native byte order, the index never leaves the device):
+//   "CMCM" version contactCount
+//   contactCount x identifier keyCount key*
+//   cached fetchedLimit fetchedAt resultCount, resultCount x entry
+// The key map is rebuilt from the per-contact keys on load.
+bool CanonicalMatchIndex::save(const std::string &path) const {
+  std::string out;
+  out.append(kFileMagic, sizeof(kFileMagic));
+  binary::writeUint32(out, kFileVersion);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    binary::writeUint32(out, static_cast<uint32_t>(keysByContact_.size()));
+    for (const auto &entry : keysByContact_) {
+      binary::writeString(out, entry.first);
+      binary::writeUint32(out, static_cast<uint32_t>(entry.second.size()));
+      for (uint64_t key : entry.second) {
+        binary::writeUint64(out, key);
+      }
+    }
+    binary::writeUint32(out, cached_ ? 1 : 0);
+    binary::writeUint64(out, fetchedLimit_);
+    binary::writeDouble(out, fetchedAt_);
+    binary::writeUint32(out, static_cast<uint32_t>(results_.size()));
+    for (const auto &entry : results_) {
+      writeEntry(out, entry);
+    }
+  }
+
+  return binary::writeFileAtomically(path, out);
+}
+
+bool CanonicalMatchIndex::load(const std::string &path) {
+  std::string data;
+  bool read = binary::readFile(path, data);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  clearLocked();
+  binary::Reader reader(data);
+  if (!read || !reader.expect(std::string_view(kFileMagic, sizeof(kFileMagic)))) {
+    return false;
+  }
+
+  uint32_t version = 0;
+  uint32_t contactCount = 0;
+  if (!reader.readUint32(version) || version != kFileVersion || !reader.readUint32(contactCount)) {
+    return false;
+  }
+
+  for (uint32_t c = 0; c < contactCount; ++c) {
+    std::string identifier;
+    uint32_t keyCount = 0;
+    if (!reader.readString(identifier) || !reader.readUint32(keyCount) || keysByContact_.count(identifier) != 0) {
+      clearLocked();
+      return false;
+    }
+    std::vector<uint64_t> keys;
+    for (uint32_t k = 0; k < keyCount; ++k) {
+      uint64_t key = 0;
+      if (!reader.readUint64(key) || key == 0 || (!keys.empty() && !(keys.back() < key))) {
+        clearLocked();
+        return false;
+      }
+      keys.push_back(key);
+    }
+    addKeysLocked(identifier, keys);
+    keysByContact_.emplace(std::move(identifier), std::move(keys));
+  }
+
+  uint32_t cached = 0;
+  uint64_t fetchedLimit = 0;
+  uint32_t resultCount = 0;
+  if (!reader.readUint32(cached) || cached > 1 || !reader.readUint64(fetchedLimit) ||
+      !reader.readDouble(fetchedAt_) || !reader.readUint32(resultCount)) {
+    clearLocked();
+    return false;
+  }
+  results_.resize(resultCount);
+  for (auto &entry : results_) {
+    if (!readEntry(reader, entry)) {
+      clearLocked();
+      return false;
+    }
+  }
+  if (!reader.atEnd()) {
+    clearLocked();
+    return false;
+  }
+  cached_ = cached != 0;
+  fetchedLimit_ = static_cast<size_t>(fetchedLimit);
+  return true;
+}
+
+void CanonicalMatchIndex::addKeysLocked(const std::string &identifier, const std::vector<uint64_t> &keys) {
+  for (uint64_t key : keys) {
+    auto &contacts = contactsByKey_[key];
+    contacts.insert(std::lower_bound(contacts.begin(), contacts.end(), identifier), identifier);
+  }
+}
+
+void CanonicalMatchIndex::removeKeysLocked(const std::string &identifier, const std::vector<uint64_t> &keys) {
+  for (uint64_t key : keys) {
+    auto found = contactsByKey_.find(key);
+    if (found == contactsByKey_.end()) {
+      continue;
+    }
+    auto &contacts = found->second;
+    auto position = std::lower_bound(contacts.begin(), contacts.end(), identifier);
+    if (position != contacts.end() && *position == identifier) {
+      contacts.erase(position);
+    }
+    if (contacts.empty()) {
+      contactsByKey_.erase(found);
+    }
+  }
+}
+
+std::string CanonicalMatchIndex::resolveLocked(const LocalCanonicalContact &entry) const {
+  if (!entry.sourceContactId.empty() && keysByContact_.count(entry.sourceContactId) != 0) {
+    return entry.sourceContactId;
+  }
+  const CanonicalContact &canonical = entry.canonicalContact;
+  std::string best;
+  for (uint64_t key : {emailMatchKey(canonical.email), phoneMatchKey(canonical.phone, options_.defaultCountryCode)}) {
+    auto found = key == 0 ? contactsByKey_.end() : contactsByKey_.find(key);
+    if (found != contactsByKey_.end() && (best.empty() || found->second.front() < best)) {
+      best = found->second.front();
+    }
+  }
+  return best;
+}
+
+void CanonicalMatchIndex::clearLocked() {
+  keysByContact_.clear();
+  contactsByKey_.clear();
+  cached_ = false;
+  results_.clear();
+  fetchedLimit_ = 0;
+  fetchedAt_ = 0;
+}
+
+} // namespace contactsmanager
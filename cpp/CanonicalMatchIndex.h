@@ -0,0 +1,147 @@
+//
+//  CanonicalMatchIndex.h
+//  ContactsManagerCore
+//
+//  Local join between the canonical contacts the server returns for
+//  getContactsUsingApp and the contacts on the device. Every device contact
+//  is filed under a hash of each normalized phone number and email address,
+//  updated per contact as sync sees changes, so resolving a canonical contact
+//  to a device contact is a hash lookup instead of a store query.
+//
+//  The last getContactsUsingApp response is cached with its fetch time.
+//  Within the TTL a screen is served from the cache alone; after it the
+//  cached matches are still returned, marked stale, for the caller to show
+//  while it refetches. The index and the cached response persist to one file.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "SocialModels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+struct CanonicalMatchOptions {
+  // Calling code for numbers stored without one, 0 for none (see phoneKeyFor);
+  // canonical numbers are international, so local ones need it to match
+  uint16_t defaultCountryCode = 0;
+  // Seconds a cached response is served without revalidation
+  double ttl = 300;
+};
+
+struct CanonicalMatch {
+  LocalCanonicalContact entry;
+  // Device contact the canonical contact resolves to; empty when none is left
+  std::string localContactId;
+};
+
+struct CachedCanonicalMatches {
+  // False when nothing cached covers the requested limit; fetch first
+  bool hit = false;
+  // True when the cached response is past its TTL; show it, then refetch
+  bool stale = false;
+  std::vector<CanonicalMatch> matches;
+};
+
+/**
+ * Hash of a normalized email address (trimmed, lowercased); 0 for an empty one
+ */
+uint64_t emailMatchKey(std::string_view email);
+
+/**
+ * Hash of a phone number's PhoneKey; 0 when it is not a phone number
+ */
+uint64_t phoneMatchKey(std::string_view phone, uint16_t defaultCountryCode);
+
+class CanonicalMatchIndex {
+public:
+  explicit CanonicalMatchIndex(CanonicalMatchOptions options = {}) : options_(options) {}
+
+  CanonicalMatchIndex(const CanonicalMatchIndex &) = delete;
+  CanonicalMatchIndex &operator=(const CanonicalMatchIndex &) = delete;
+
+  /**
+   * Files a contact under its current phone and email keys; deleted
+   * contacts are removed
+   * @return true if the index changed
+   */
+  bool upsertContact(const Contact &contact);
+
+  /**
+   * @return true if the contact was indexed
+   */
+  bool removeContact(std::string_view identifier);
+
+  /**
+   * Makes the local side match the given contacts
+   * @return number of contacts added, changed or removed
+   */
+  size_t syncWith(const std::vector<Contact> &contacts);
+
+  /**
+   * Device contacts filed under the email or phone, ordered by identifier
+   */
+  std::vector<std::string> contactsMatching(std::string_view email, std::string_view phone) const;
+
+  /**
+   * The sourceContactId when that contact is still on the device, otherwise
+   * the first contact sharing the canonical contact's email or phone
+   */
+  std::string resolveLocalContact(const LocalCanonicalContact &entry) const;
+
+  /**
+   * Caches a getContactsUsingApp response requested with limit at time now
+   * (seconds since 1970)
+   */
+  void storeContactsUsingApp(std::vector<LocalCanonicalContact> results, size_t limit, double now);
+
+  /**
+   * Drops the cached response, e.g. after a follow or a sign-out
+   */
+  void invalidate();
+
+  /**
+   * The cached response, resolved against the current device contacts
+   */
+  CachedCanonicalMatches contactsUsingApp(size_t limit, double now) const;
+
+  size_t contactCount() const;
+
+  /**
+   * Writes the index and the cached response to path atomically
+   */
+  bool save(const std::string &path) const;
+
+  /**
+   * Replaces the contents with those stored at path; on any error the index
+   * is left empty and false is returned
+   */
+  bool load(const std::string &path);
+
+private:
+  void addKeysLocked(const std::string &identifier, const std::vector<uint64_t> &keys);
+  void removeKeysLocked(const std::string &identifier, const std::vector<uint64_t> &keys);
+  std::string resolveLocked(const LocalCanonicalContact &entry) const;
+  void clearLocked();
+
+  CanonicalMatchOptions options_;
+  mutable std::mutex mutex_;
+  // Sorted keys per contact, and the contacts under each key sorted by identifier
+  std::unordered_map<std::string, std::vector<uint64_t>> keysByContact_;
+  std::unordered_map<uint64_t, std::vector<std::string>> contactsByKey_;
+
+  bool cached_ = false;
+  std::vector<LocalCanonicalContact> results_;
+  size_t fetchedLimit_ = 0;
+  double fetchedAt_ = 0;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,158 @@
+//
+//  CborWriter.cpp
+//  ContactsManagerCore
+//
+
+#include "CborWriter.h"
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr uint8_t kMajorUnsigned = 0;
+constexpr uint8_t kMajorNegative = 1;
+constexpr uint8_t kMajorText = 3;
+constexpr uint8_t kMajorTag = 6;
+
+constexpr uint8_t kIndefiniteArray = 0x9f;
+constexpr uint8_t kIndefiniteMap = 0xbf;
+constexpr uint8_t kBreak = 0xff;
+constexpr uint8_t kFalse = 0xf4;
+constexpr uint8_t kTrue = 0xf5;
+constexpr uint8_t kNull = 0xf6;
+constexpr uint8_t kFloat64 = 0xfb;
+
+constexpr uint64_t kStringRefNamespaceTag = 256;
+constexpr uint64_t kStringRefTag = 25;
+
+} // namespace
+
+size_t cborMinSharedStringLength(uint64_t count) {
+  if (count < 24) {
+    return 3;
+  }
+  if (count < 256) {
+    return 4;
+  }
+  if (count < 65536) {
+    return 5;
+  }
+  if (count < 4294967296ULL) {
+    return 7;
+  }
+  return 11;
+}
+
+void CborWriter::writeHead(uint8_t major, uint64_t value) {
+  uint8_t initial = static_cast<uint8_t>(major << 5);
+  if (value < 24) {
+    out_.push_back(static_cast<char>(initial | value));
+    return;
+  }
+  int bytes;
+  if (value <= 0xff) {
+    out_.push_back(static_cast<char>(initial | 24));
+    bytes = 1;
+  } else if (value <= 0xffff) {
+    out_.push_back(static_cast<char>(initial | 25));
+    bytes = 2;
+  } else if (value <= 0xffffffffULL) {
+    out_.push_back(static_cast<char>(initial | 26));
+    bytes = 4;
+  } else {
+    out_.push_back(static_cast<char>(initial | 27));
+    bytes = 8;
+  }
+  for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+    out_.push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+void CborWriter::beforeValue() {
+  // The namespace wraps the top-level item
+  if (depth_ == 0 && shareStrings_) {
+    writeHead(kMajorTag, kStringRefNamespaceTag);
+    stringCount_ = 0;
+    sharedStrings_.clear();
+  }
+}
+
+void CborWriter::beginObject() {
+  beforeValue();
+  out_.push_back(static_cast<char>(kIndefiniteMap));
+  depth_++;
+}
+
+void CborWriter::endObject() {
+  out_.push_back(static_cast<char>(kBreak));
+  depth_--;
+}
+
+void CborWriter::beginArray() {
+  beforeValue();
+  out_.push_back(static_cast<char>(kIndefiniteArray));
+  depth_++;
+}
+
+void CborWriter::endArray() {
+  out_.push_back(static_cast<char>(kBreak));
+  depth_--;
+}
+
+void CborWriter::stringValue(std::string_view value) {
+  beforeValue();
+  if (shareStrings_ && value.size() >= cborMinSharedStringLength(stringCount_)) {
+    size_t hash = std::hash<std::string_view>()(value);
+    auto it = sharedStrings_.find(hash);
+    if (it != sharedStrings_.end() && it->second.text == value) {
+      writeHead(kMajorTag, kStringRefTag);
+      writeHead(kMajorUnsigned, it->second.index);
+      return;
+    }
+    if (it == sharedStrings_.end() && sharedStrings_.size() < kMaxSharedStrings) {
+      sharedStrings_.emplace(hash, SharedString{stringCount_, std::string(value)});
+    }
+    stringCount_++;
+  }
+  writeHead(kMajorText, value.size());
+  out_.append(value);
+}
+
+void CborWriter::intValue(int64_t value) {
+  beforeValue();
+  if (value >= 0) {
+    writeHead(kMajorUnsigned, static_cast<uint64_t>(value));
+  } else {
+    writeHead(kMajorNegative, static_cast<uint64_t>(-1 - value));
+  }
+}
+
+void CborWriter::doubleValue(double value) {
+  if (!std::isfinite(value)) {
+    nullValue();
+    return;
+  }
+  beforeValue();
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  out_.push_back(static_cast<char>(kFloat64));
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    out_.push_back(static_cast<char>((bits >> shift) & 0xff));
+  }
+}
+
+void CborWriter::boolValue(bool value) {
+  beforeValue();
+  out_.push_back(static_cast<char>(value ? kTrue : kFalse));
+}
+
+void CborWriter::nullValue() {
+  beforeValue();
+  out_.push_back(static_cast<char>(kNull));
+}
+
+} // namespace contactsmanager
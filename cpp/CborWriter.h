@@ -0,0 +1,91 @@
+//
+//  CborWriter.h
+//  ContactsManagerCore
+//
+//  Streaming CBOR (RFC 8949) writer with the same interface as JsonWriter, so
+//  the server-contact writers can emit either format. Objects and arrays use
+//  indefinite lengths, which lets them be written without counting first.
+//
+//  With string sharing on, the document is wrapped in a stringref namespace
+//  (tags 256 and 25, cbor.schmorp.de/stringref): a string written before is
+//  replaced by a reference to its index, so the keys and labels every contact
+//  repeats (phoneNumbers[].label, isPrimary, ...) cost two or three bytes.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace contactsmanager {
+
+class CborWriter {
+public:
+  // Strings the writer remembers for references; later strings are still
+  // numbered (the decoder numbers them too) but written in full
+  static constexpr size_t kMaxSharedStrings = 4096;
+
+  explicit CborWriter(std::string &out, bool shareStrings = true) : out_(out), shareStrings_(shareStrings) {}
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  /**
+   * Object key; the next call must write its value
+   */
+  void key(std::string_view name) { stringValue(name); }
+
+  void stringValue(std::string_view value);
+  void intValue(int64_t value);
+
+  /**
+   * Float64; NaN and infinities are written as null, as JsonWriter does
+   */
+  void doubleValue(double value);
+
+  void boolValue(bool value);
+  void nullValue();
+
+  /**
+   * key + stringValue
+   */
+  void field(std::string_view name, std::string_view value) {
+    key(name);
+    stringValue(value);
+  }
+
+  /**
+   * Nesting depth of the containers still open
+   */
+  size_t depth() const { return depth_; }
+
+private:
+  struct SharedString {
+    uint64_t index = 0;
+    std::string text;
+  };
+
+  void beforeValue();
+  void writeHead(uint8_t major, uint64_t value);
+
+  std::string &out_;
+  bool shareStrings_;
+  size_t depth_ = 0;
+  // Strings numbered so far in the namespace, shared or not
+  uint64_t stringCount_ = 0;
+  // Keyed by std::hash of the text so lookups need no temporary string; a
+  // collision is written in full
+  std::unordered_map<size_t, SharedString> sharedStrings_;
+};
+
+/**
+ * Shortest string the stringref namespace numbers once it holds count strings
+ */
+size_t cborMinSharedStringLength(uint64_t count);
+
+} // namespace contactsmanager
@@ -0,0 +1,179 @@
+//
+//  Contact.cpp
+//  ContactsManagerCore
+//
+
+#include "Contact.h"
+#include "TextUtils.h"
+
+namespace contactsmanager {
+
+namespace {
+
+void appendNameComponent(std::string &out, const std::string &component) {
+  std::string_view trimmedComponent = text::trimmed(component);
+  if (trimmedComponent.empty()) {
+    return;
+  }
+  if (!out.empty()) {
+    out.push_back(' ');
+  }
+  out.append(trimmedComponent);
+}
+
+void appendMatchToken(std::string &out, std::string_view token) {
+  if (token.empty()) {
+    return;
+  }
+  if (!out.empty()) {
+    out.push_back(' ');
+  }
+  text::appendLowercased(out, token);
+}
+
+void appendPhoneDigits(std::string &out, std::string_view phone) {
+  size_t start = out.size();
+  out.push_back(' ');
+  for (char c : phone) {
+    if (text::isAsciiDigit(c)) {
+      out.push_back(c);
+    }
+  }
+  if (out.size() == start + 1) {
+    out.resize(start);
+  }
+}
+
+// Phone values compare by exact key, so a reformatted number is not a change; hashing uses the same rule
+bool samePhoneNumbers(const std::vector<PhoneNumber> &lhs, const std::vector<PhoneNumber> &rhs,
+                      uint16_t defaultCountryCode) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    if (lhs[i].contactId != rhs[i].contactId || lhs[i].type != rhs[i].type || lhs[i].emoji != rhs[i].emoji ||
+        !phoneNumbersEqual(lhs[i].value, rhs[i].value, defaultCountryCode)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+const std::string &Contact::displayInfo() const {
+  if (!displayName.empty()) {
+    return displayName;
+  }
+  if (!organizationName.empty()) {
+    return organizationName;
+  }
+  if (!phoneNumbers.empty() && !phoneNumbers.front().value.empty()) {
+    return phoneNumbers.front().value;
+  }
+  if (!emailAddresses.empty() && !emailAddresses.front().value.empty()) {
+    return emailAddresses.front().value;
+  }
+  return displayName;
+}
+
+void Contact::updateDisplayInfo() {
+  std::string name;
+  appendNameComponent(name, namePrefix);
+  appendNameComponent(name, givenName);
+  appendNameComponent(name, middleName);
+  appendNameComponent(name, familyName);
+  appendNameComponent(name, nameSuffix);
+  if (name.empty()) {
+    appendNameComponent(name, nickname);
+  }
+  if (name.empty()) {
+    appendNameComponent(name, organizationName);
+  }
+  displayName = std::move(name);
+  contactSection = contactSectionForName();
+  matchString = generateMatchString();
+}
+
+void Contact::markAsDirty(double now) {
+  dirtyTime = now;
+}
+
+std::string Contact::generateMatchString() const {
+  std::string out;
+  out.reserve(128);
+  appendMatchToken(out, displayName);
+  appendMatchToken(out, givenName);
+  appendMatchToken(out, middleName);
+  appendMatchToken(out, familyName);
+  appendMatchToken(out, previousFamilyName);
+  appendMatchToken(out, nickname);
+  appendMatchToken(out, organizationName);
+  appendMatchToken(out, departmentName);
+  appendMatchToken(out, jobTitle);
+  for (const auto &phone : phoneNumbers) {
+    appendMatchToken(out, phone.value);
+    appendPhoneDigits(out, phone.value);
+  }
+  for (const auto &email : emailAddresses) {
+    appendMatchToken(out, email.value);
+  }
+  for (const auto &address : addresses) {
+    appendMatchToken(out, address.street);
+    appendMatchToken(out, address.city);
+    appendMatchToken(out, address.state);
+    appendMatchToken(out, address.postalCode);
+    appendMatchToken(out, address.country);
+  }
+  for (const auto &url : urlAddresses) {
+    appendMatchToken(out, url.value);
+  }
+  for (const auto &profile : socialProfiles) {
+    appendMatchToken(out, profile.username);
+  }
+  for (const auto &relation : relations) {
+    appendMatchToken(out, relation.name);
+  }
+  for (const auto &im : instantMessageAddresses) {
+    appendMatchToken(out, im.username);
+  }
+  appendMatchToken(out, notes);
+  return out;
+}
+
+std::string Contact::contactSectionForName() const {
+  const std::string *candidates[] = {&familyName, &givenName, &displayName, &organizationName};
+  for (const std::string *candidate : candidates) {
+    std::string_view value = text::trimmed(*candidate);
+    if (value.empty()) {
+      continue;
+    }
+    char first = value.front();
+    if (text::isAsciiAlpha(first)) {
+      return std::string(1, text::toUpperAscii(first));
+    }
+    return "#";
+  }
+  return "#";
+}
+
+bool Contact::isEqualToContact(const Contact &other, uint16_t defaultCountryCode) const {
+  return identifier == other.identifier && displayName == other.displayName &&
+         contactType == other.contactType && namePrefix == other.namePrefix &&
+         givenName == other.givenName && middleName == other.middleName &&
+         familyName == other.familyName && previousFamilyName == other.previousFamilyName &&
+         nameSuffix == other.nameSuffix && nickname == other.nickname &&
+         organizationName == other.organizationName && departmentName == other.departmentName &&
+         jobTitle == other.jobTitle && samePhoneNumbers(phoneNumbers, other.phoneNumbers, defaultCountryCode) &&
+         emailAddresses == other.emailAddresses && addresses == other.addresses &&
+         dates == other.dates && urlAddresses == other.urlAddresses &&
+         socialProfiles == other.socialProfiles && relations == other.relations &&
+         instantMessageAddresses == other.instantMessageAddresses && notes == other.notes &&
+         bio == other.bio && location == other.location && birthday == other.birthday &&
+         imageUrl == other.imageUrl && imageData == other.imageData &&
+         thumbnailImageData == other.thumbnailImageData && interests == other.interests &&
+         avatars == other.avatars && parentContactId == other.parentContactId &&
+         sourceId == other.sourceId;
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,134 @@
+//
+//  Contact.h
+//  ContactsManagerCore
+//
+//  Portable mirror of CMContact. Nullable NSString properties are
+//  represented as empty strings, matching what the RN bridges emit.
+//
+
+#pragma once
+
+#include "ContactDetail.h"
+#include "PhoneNumberKey.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace contactsmanager {
+
+/**
+ * Types of fields to fetch (mirrors CMContactFieldType)
+ */
+enum class ContactFieldType : int {
+  Any = 0,
+  Phone = 1,
+  Email = 2,
+  Notes = 3,
+};
+
+/**
+ * Contact in the device's address book (mirrors CMContact)
+ */
+struct Contact {
+  // Primary identifiers
+  std::string identifier;
+  std::string displayName;
+
+  // Basic information
+  int64_t contactType = 0;
+  std::string namePrefix;
+  std::string givenName;
+  std::string middleName;
+  std::string familyName;
+  std::string previousFamilyName;
+  std::string nameSuffix;
+  std::string nickname;
+
+  // Organization details
+  std::string organizationName;
+  std::string departmentName;
+  std::string jobTitle;
+
+  // Contact information collections
+  std::vector<PhoneNumber> phoneNumbers;
+  std::vector<EmailAddress> emailAddresses;
+  std::vector<PostalAddress> addresses;
+  std::vector<ContactDate> dates;
+  std::vector<ContactURL> urlAddresses;
+  std::vector<SocialProfile> socialProfiles;
+  std::vector<Relation> relations;
+  std::vector<InstantMessage> instantMessageAddresses;
+
+  // Additional information
+  std::string notes;
+  std::string bio;
+  std::string location;
+
+  // Birthday, in seconds since 1970
+  std::optional<double> birthday;
+
+  // Image data
+  std::string imageUrl;
+  std::vector<uint8_t> imageData;
+  std::vector<uint8_t> thumbnailImageData;
+  bool imageDataAvailable = false;
+
+  // Extra data
+  std::vector<std::string> interests;
+  std::vector<std::string> avatars;
+
+  // Sync information
+  bool isDeleted = false;
+  double dirtyTime = 0;
+  double lastSyncedAt = 0;
+
+  std::string contactSection;
+  std::string matchString;
+  std::string parentContactId;
+  std::string sourceId;
+  double createdAt = 0;
+
+  Contact() = default;
+  explicit Contact(std::string identifier) : identifier(std::move(identifier)) {}
+
+  /**
+   * Returns the most relevant contact information following a priority order:
+   * display name, organization, first phone number, first email address
+   */
+  const std::string &displayInfo() const;
+
+  /**
+   * Updates the display name, section and match string from the name components
+   */
+  void updateDisplayInfo();
+
+  /**
+   * Marks the contact as dirty for syncing
+   * @param now Current time in seconds since 1970
+   */
+  void markAsDirty(double now);
+
+  /**
+   * Generates a lowercase search match string containing all contact information
+   */
+  std::string generateMatchString() const;
+
+  /**
+   * Creates a section identifier ("A"-"Z" or "#") based on the contact's name
+   */
+  std::string contactSectionForName() const;
+
+  /**
+   * Checks if two contacts are equal, ignoring sync bookkeeping fields; phone
+   * numbers are compared by exact PhoneKey so formatting differences do not
+   * count, consistent with contactHash128
+   * @param defaultCountryCode Calling code for numbers stored without one, so
+   *   "5551234567" equals "+1 555 123 4567" when it is 1
+   */
+  bool isEqualToContact(const Contact &other, uint16_t defaultCountryCode = defaultCallingCode()) const;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,217 @@
+//
+//  ContactChangeFeed.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactChangeFeed.h"
+
+#include "BinaryFile.h"
+#include "ContactHashing.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'C', 'M', 'C', 'T'};
+// Version 2: hashes come from contactHash128
+constexpr uint32_t kFileVersion = 2;
+
+} // namespace
+
+uint64_t contactContentHash(const Contact &contact) {
+  return contactHash128(contact).low;
+}
+
+ContactChangeTracker &ContactChangeTracker::sharedInstance() {
+  static ContactChangeTracker tracker;
+  return tracker;
+}
+
+ContactChangeSet ContactChangeTracker::pendingChanges(const ContactChangeHistory &history,
+                                                      const ContactScan &scan) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (token_.empty()) {
+    // Token first: edits made during the scan then replay on the next sync
+    std::string token = history.currentToken();
+    ContactChangeSet changes = fullScanLocked(scan);
+    changes.token = std::move(token);
+    return changes;
+  }
+
+  // Only the last event per contact matters: an edit followed by a delete is a delete,
+  // a delete followed by a re-add is an update
+  std::vector<std::string> order;
+  std::unordered_map<std::string, bool> exists;
+  std::string nextToken;
+  ChangeHistoryStatus status = history.changesSince(
+      token_,
+      [&](const ContactChangeEvent &event) {
+        auto inserted = exists.emplace(event.identifier, event.kind != ContactChangeKind::Deleted);
+        if (inserted.second) {
+          order.push_back(event.identifier);
+        } else {
+          inserted.first->second = event.kind != ContactChangeKind::Deleted;
+        }
+      },
+      nextToken);
+
+  if (status != ChangeHistoryStatus::Ok) {
+    // The scan reflects the store at or after this token, so replaying from it later is safe
+    std::string token = history.currentToken();
+    ContactChangeSet changes = fullScanLocked(scan);
+    changes.token = std::move(token);
+    return changes;
+  }
+
+  ContactChangeSet changes;
+  changes.baseToken = token_;
+  changes.token = std::move(nextToken);
+  for (auto &identifier : order) {
+    bool known = hashes_.count(identifier) != 0;
+    if (!exists[identifier]) {
+      if (known) {
+        changes.deleted.push_back(std::move(identifier));
+      }
+    } else if (known) {
+      changes.updated.push_back(std::move(identifier));
+    } else {
+      changes.added.push_back(std::move(identifier));
+    }
+  }
+  return changes;
+}
+
+ContactChangeSet ContactChangeTracker::pendingChanges(const ContactScan &scan) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fullScanLocked(scan);
+}
+
+ContactChangeSet ContactChangeTracker::fullScanLocked(const ContactScan &scan) const {
+  ContactChangeSet changes;
+  changes.fullScan = true;
+  changes.baseToken = token_;
+
+  std::unordered_set<std::string_view> seen;
+  seen.reserve(hashes_.size());
+  scan([&](Contact &&contact) {
+    uint64_t hash = contactContentHash(contact);
+    auto known = hashes_.find(contact.identifier);
+    if (known == hashes_.end()) {
+      changes.added.push_back(contact.identifier);
+    } else {
+      seen.insert(known->first);
+      if (known->second == hash) {
+        return true;
+      }
+      changes.updated.push_back(contact.identifier);
+    }
+    changes.hashes.emplace(std::move(contact.identifier), hash);
+    return true;
+  });
+
+  for (const auto &entry : hashes_) {
+    if (seen.count(entry.first) == 0) {
+      changes.deleted.push_back(entry.first);
+    }
+  }
+  return changes;
+}
+
+bool ContactChangeTracker::commit(const ContactChangeSet &changes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (changes.baseToken != token_) {
+    return false;
+  }
+  for (const auto &identifier : changes.deleted) {
+    hashes_.erase(identifier);
+  }
+  for (const auto *identifiers : {&changes.added, &changes.updated}) {
+    for (const auto &identifier : *identifiers) {
+      auto hash = changes.hashes.find(identifier);
+      hashes_[identifier] = hash == changes.hashes.end() ? 0 : hash->second;
+    }
+  }
+  token_ = changes.token;
+  return true;
+}
+
+std::string ContactChangeTracker::token() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return token_;
+}
+
+size_t ContactChangeTracker::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hashes_.size();
+}
+
+bool ContactChangeTracker::isKnown(std::string_view identifier) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hashes_.count(std::string(identifier)) != 0;
+}
+
+void ContactChangeTracker::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  token_.clear();
+  hashes_.clear();
+}
+
+// File layout (native byte order):
+//   "CMCT" version token count
+//   count x identifier hash
+bool ContactChangeTracker::save(const std::string &path) const {
+  std::string out;
+  out.append(kFileMagic, sizeof(kFileMagic));
+  binary::writeUint32(out, kFileVersion);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    binary::writeString(out, token_);
+    binary::writeUint32(out, static_cast<uint32_t>(hashes_.size()));
+    for (const auto &entry : hashes_) {
+      binary::writeString(out, entry.first);
+      binary::writeUint64(out, entry.second);
+    }
+  }
+  return binary::writeFileAtomically(path, out);
+}
+
+bool ContactChangeTracker::load(const std::string &path) {
+  std::string data;
+  bool read = binary::readFile(path, data);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  token_.clear();
+  hashes_.clear();
+  binary::Reader reader(data);
+  uint32_t version = 0;
+  uint32_t count = 0;
+  std::string token;
+  if (!read || !reader.expect(std::string_view(kFileMagic, sizeof(kFileMagic))) || !reader.readUint32(version) ||
+      version != kFileVersion || !reader.readString(token) || !reader.readUint32(count)) {
+    return false;
+  }
+
+  std::unordered_map<std::string, uint64_t> hashes;
+  // Each entry takes at least 12 bytes, which bounds the reservation for a corrupt count
+  hashes.reserve(std::min<size_t>(count, data.size() / 12));
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string identifier;
+    uint64_t hash = 0;
+    if (!reader.readString(identifier) || !reader.readUint64(hash) ||
+        !hashes.emplace(std::move(identifier), hash).second) {
+      return false;
+    }
+  }
+  if (!reader.atEnd()) {
+    return false;
+  }
+  token_ = std::move(token);
+  hashes_ = std::move(hashes);
+  return true;
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,157 @@
+//
+//  ContactChangeFeed.h
+//  ContactsManagerCore
+//
+//  Incremental change detection for sync. Instead of rehashing the whole
+//  address book on every sync, the tracker replays the store's change history
+//  (CNChangeHistoryFetchRequest on iOS) from the token it persisted after the
+//  last successful sync and reports only the contacts added, updated or
+//  deleted since. When there is no token yet, the history has expired or been
+//  reset, or the platform has no history, it falls back to one full scan that
+//  hashes every contact and diffs against the stored hashes.
+//
+//  Changes are computed and committed in two steps so a sync that fails
+//  half-way replays the same changes next time.
+//
+
+#pragma once
+
+#include "Contact.h"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+enum class ContactChangeKind : uint8_t {
+  Added,
+  Updated,
+  Deleted,
+};
+
+struct ContactChangeEvent {
+  ContactChangeKind kind = ContactChangeKind::Updated;
+  std::string identifier;
+};
+
+enum class ChangeHistoryStatus : uint8_t {
+  Ok,
+  // The token is older than the history the store keeps
+  Expired,
+  // The store asked clients to drop their state and refetch everything
+  DropEverything,
+  // No change history on this platform or the fetch failed
+  Unavailable,
+};
+
+/**
+ * Source of store change events, in the order they happened
+ */
+class ContactChangeHistory {
+public:
+  virtual ~ContactChangeHistory() = default;
+
+  /**
+   * Token for the current end of the history
+   */
+  virtual std::string currentToken() const = 0;
+
+  /**
+   * Visits every event after token. Events visited before a non-Ok status is
+   * returned must be ignored.
+   * @param nextToken Set to the token after the last event on success
+   */
+  virtual ChangeHistoryStatus changesSince(const std::string &token,
+                                           const std::function<void(const ContactChangeEvent &)> &visit,
+                                           std::string &nextToken) const = 0;
+};
+
+/**
+ * Calls emit for each contact in the store and stops early when emit returns
+ * false (same shape as ContactCursor's Enumerator)
+ */
+using ContactScan = std::function<void(const std::function<bool(Contact &&)> &emit)>;
+
+/**
+ * Contacts changed since the last commit, identifiers in first-seen order
+ */
+struct ContactChangeSet {
+  std::vector<std::string> added;
+  std::vector<std::string> updated;
+  std::vector<std::string> deleted;
+  // True when the change history could not be used and every contact was hashed
+  bool fullScan = false;
+  // Token the changes were computed from and the token to commit
+  std::string baseToken;
+  std::string token;
+  // Content hash per added or updated identifier. Full scans fill it; callers
+  // that fetch history changes should add theirs, otherwise the next full scan
+  // reports those contacts once more.
+  std::unordered_map<std::string, uint64_t> hashes;
+
+  bool empty() const { return added.empty() && updated.empty() && deleted.empty(); }
+};
+
+/**
+ * Content hash the tracker compares on full scans (low half of contactHash128)
+ */
+uint64_t contactContentHash(const Contact &contact);
+
+class ContactChangeTracker {
+public:
+  ContactChangeTracker() = default;
+
+  ContactChangeTracker(const ContactChangeTracker &) = delete;
+  ContactChangeTracker &operator=(const ContactChangeTracker &) = delete;
+
+  static ContactChangeTracker &sharedInstance();
+
+  /**
+   * Changes since the last commit. Replays the history when a token is
+   * stored and falls back to hashing every contact from scan otherwise.
+   * Does not modify the tracker.
+   */
+  ContactChangeSet pendingChanges(const ContactChangeHistory &history, const ContactScan &scan) const;
+
+  /**
+   * Full scan against the stored hashes, for platforms without a change history
+   */
+  ContactChangeSet pendingChanges(const ContactScan &scan) const;
+
+  /**
+   * Records the changes as synced and stores their token
+   * @return false if another commit happened since the changes were computed
+   */
+  bool commit(const ContactChangeSet &changes);
+
+  std::string token() const;
+  size_t size() const;
+  bool isKnown(std::string_view identifier) const;
+  void clear();
+
+  /**
+   * Writes the tracker state to path atomically
+   */
+  bool save(const std::string &path) const;
+
+  /**
+   * Replaces the state with the one stored at path; on any error the tracker
+   * is left empty (the next sync does a full scan) and false is returned
+   */
+  bool load(const std::string &path);
+
+private:
+  ContactChangeSet fullScanLocked(const ContactScan &scan) const;
+
+  mutable std::mutex mutex_;
+  std::string token_;
+  // Synced contacts and their content hash, 0 when only the history reported them
+  std::unordered_map<std::string, uint64_t> hashes_;
+};
+
+} // namespace contactsmanager
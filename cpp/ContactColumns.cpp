@@ -0,0 +1,406 @@
+//
+//  ContactColumns.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactColumns.h"
+
+#include <limits>
+
+namespace contactsmanager {
+
+namespace {
+
+const char *const kStringFieldNames[kContactStringFieldCount] = {
+    "identifier",       "displayName",    "namePrefix", "givenName",     "middleName",
+    "familyName",       "previousFamilyName", "nameSuffix", "nickname",  "organizationName",
+    "departmentName",   "jobTitle",       "notes",      "bio",           "location",
+    "imageUrl",         "contactSection", "matchString", "parentContactId", "sourceId",
+};
+
+const char *const kNumberFieldNames[kContactNumberFieldCount] = {
+    "contactType", "isDeleted", "dirtyTime", "lastSyncedAt", "createdAt", "birthday", "imageDataAvailable",
+};
+
+} // namespace
+
+const std::string &contactStringFieldValue(const Contact &contact, ContactStringField field) {
+  switch (field) {
+  case ContactStringField::Identifier:
+    return contact.identifier;
+  case ContactStringField::DisplayName:
+    return contact.displayName;
+  case ContactStringField::NamePrefix:
+    return contact.namePrefix;
+  case ContactStringField::GivenName:
+    return contact.givenName;
+  case ContactStringField::MiddleName:
+    return contact.middleName;
+  case ContactStringField::FamilyName:
+    return contact.familyName;
+  case ContactStringField::PreviousFamilyName:
+    return contact.previousFamilyName;
+  case ContactStringField::NameSuffix:
+    return contact.nameSuffix;
+  case ContactStringField::Nickname:
+    return contact.nickname;
+  case ContactStringField::OrganizationName:
+    return contact.organizationName;
+  case ContactStringField::DepartmentName:
+    return contact.departmentName;
+  case ContactStringField::JobTitle:
+    return contact.jobTitle;
+  case ContactStringField::Notes:
+    return contact.notes;
+  case ContactStringField::Bio:
+    return contact.bio;
+  case ContactStringField::Location:
+    return contact.location;
+  case ContactStringField::ImageUrl:
+    return contact.imageUrl;
+  case ContactStringField::ContactSection:
+    return contact.contactSection;
+  case ContactStringField::MatchString:
+    return contact.matchString;
+  case ContactStringField::ParentContactId:
+    return contact.parentContactId;
+  case ContactStringField::SourceId:
+  case ContactStringField::Count:
+    break;
+  }
+  return contact.sourceId;
+}
+
+double contactNumberFieldValue(const Contact &contact, ContactNumberField field) {
+  switch (field) {
+  case ContactNumberField::ContactType:
+    return static_cast<double>(contact.contactType);
+  case ContactNumberField::IsDeleted:
+    return contact.isDeleted ? 1 : 0;
+  case ContactNumberField::DirtyTime:
+    return contact.dirtyTime;
+  case ContactNumberField::LastSyncedAt:
+    return contact.lastSyncedAt;
+  case ContactNumberField::CreatedAt:
+    return contact.createdAt;
+  case ContactNumberField::Birthday:
+    return contact.birthday ? *contact.birthday : std::numeric_limits<double>::quiet_NaN();
+  case ContactNumberField::ImageDataAvailable:
+  case ContactNumberField::Count:
+    break;
+  }
+  return contact.imageDataAvailable ? 1 : 0;
+}
+
+const char *contactFieldName(ContactStringField field) {
+  return kStringFieldNames[static_cast<size_t>(field)];
+}
+
+const char *contactFieldName(ContactNumberField field) {
+  return kNumberFieldNames[static_cast<size_t>(field)];
+}
+
+std::optional<ContactStringField> contactStringFieldNamed(std::string_view name) {
+  for (size_t i = 0; i < kContactStringFieldCount; ++i) {
+    if (name == kStringFieldNames[i]) {
+      return static_cast<ContactStringField>(i);
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<ContactNumberField> contactNumberFieldNamed(std::string_view name) {
+  for (size_t i = 0; i < kContactNumberFieldCount; ++i) {
+    if (name == kNumberFieldNames[i]) {
+      return static_cast<ContactNumberField>(i);
+    }
+  }
+  return std::nullopt;
+}
+
+namespace {
+
+// Arena bytes and item counts of a contact list, to size the columns up front
+struct ColumnSizes {
+  size_t arenaBytes = 0;
+  size_t phones = 0;
+  size_t emails = 0;
+  size_t addresses = 0;
+  size_t dates = 0;
+  size_t urls = 0;
+  size_t socialProfiles = 0;
+  size_t relations = 0;
+  size_t instantMessages = 0;
+  size_t interests = 0;
+  size_t avatars = 0;
+};
+
+void addSizes(ColumnSizes &sizes, const Contact &contact) {
+  size_t bytes = contact.imageData.size() + contact.thumbnailImageData.size();
+  for (size_t field = 0; field < kContactStringFieldCount; ++field) {
+    bytes += contactStringFieldValue(contact, static_cast<ContactStringField>(field)).size();
+  }
+  for (const auto &phone : contact.phoneNumbers) {
+    bytes += phone.value.size() + phone.type.size() + phone.emoji.size();
+  }
+  for (const auto &email : contact.emailAddresses) {
+    bytes += email.value.size() + email.type.size() + email.emoji.size();
+  }
+  for (const auto &address : contact.addresses) {
+    bytes += address.street.size() + address.city.size() + address.state.size() + address.postalCode.size() +
+             address.country.size() + address.type.size() + address.emoji.size();
+  }
+  for (const auto &date : contact.dates) {
+    bytes += date.type.size();
+  }
+  for (const auto &url : contact.urlAddresses) {
+    bytes += url.value.size() + url.type.size() + url.emoji.size();
+  }
+  for (const auto &profile : contact.socialProfiles) {
+    bytes += profile.service.size() + profile.username.size() + profile.urlString.size();
+  }
+  for (const auto &relation : contact.relations) {
+    bytes += relation.name.size() + relation.type.size();
+  }
+  for (const auto &message : contact.instantMessageAddresses) {
+    bytes += message.service.size() + message.username.size() + message.type.size();
+  }
+  for (const auto &interest : contact.interests) {
+    bytes += interest.size();
+  }
+  for (const auto &avatar : contact.avatars) {
+    bytes += avatar.size();
+  }
+  sizes.arenaBytes += bytes;
+  sizes.phones += contact.phoneNumbers.size();
+  sizes.emails += contact.emailAddresses.size();
+  sizes.addresses += contact.addresses.size();
+  sizes.dates += contact.dates.size();
+  sizes.urls += contact.urlAddresses.size();
+  sizes.socialProfiles += contact.socialProfiles.size();
+  sizes.relations += contact.relations.size();
+  sizes.instantMessages += contact.instantMessageAddresses.size();
+  sizes.interests += contact.interests.size();
+  sizes.avatars += contact.avatars.size();
+}
+
+std::string_view bytesOf(const std::vector<uint8_t> &bytes) {
+  return std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+} // namespace
+
+ContactColumns::ContactColumns(const std::vector<Contact> &contacts, const std::vector<std::string> &imageIds)
+    : rowCount_(contacts.size()) {
+  ColumnSizes sizes;
+  for (const auto &contact : contacts) {
+    addSizes(sizes, contact);
+  }
+  for (const auto &imageId : imageIds) {
+    sizes.arenaBytes += imageId.size();
+  }
+
+  arena_.reserve(sizes.arenaBytes);
+  strings_.resize(rowCount_ * kContactStringFieldCount);
+  numbers_.resize(rowCount_ * kContactNumberFieldCount);
+  hasBirthday_.resize(rowCount_);
+  imageIds_.resize(rowCount_);
+  imageData_.resize(rowCount_);
+  thumbnailImageData_.resize(rowCount_);
+  dateValues_.reserve(sizes.dates);
+
+  struct Layout {
+    Collection &collection;
+    size_t width;
+    size_t items;
+  };
+  Layout layouts[] = {
+      {phones_, 3, sizes.phones},
+      {emails_, 3, sizes.emails},
+      {addresses_, 7, sizes.addresses},
+      {dates_, 1, sizes.dates},
+      {urls_, 3, sizes.urls},
+      {socialProfiles_, 3, sizes.socialProfiles},
+      {relations_, 2, sizes.relations},
+      {instantMessages_, 3, sizes.instantMessages},
+      {interests_, 1, sizes.interests},
+      {avatars_, 1, sizes.avatars},
+  };
+  for (Layout &layout : layouts) {
+    layout.collection.width = layout.width;
+    layout.collection.starts.reserve(rowCount_ + 1);
+    layout.collection.refs.reserve(layout.items * layout.width);
+  }
+
+  for (size_t row = 0; row < rowCount_; ++row) {
+    const Contact &contact = contacts[row];
+    for (size_t field = 0; field < kContactStringFieldCount; ++field) {
+      strings_[field * rowCount_ + row] = intern(contactStringFieldValue(contact, static_cast<ContactStringField>(field)));
+    }
+    for (size_t field = 0; field < kContactNumberFieldCount; ++field) {
+      numbers_[field * rowCount_ + row] = contactNumberFieldValue(contact, static_cast<ContactNumberField>(field));
+    }
+    hasBirthday_[row] = contact.birthday.has_value() ? 1 : 0;
+    if (row < imageIds.size()) {
+      imageIds_[row] = intern(imageIds[row]);
+    }
+    imageData_[row] = intern(bytesOf(contact.imageData));
+    thumbnailImageData_[row] = intern(bytesOf(contact.thumbnailImageData));
+
+    for (Layout &layout : layouts) {
+      layout.collection.starts.push_back(static_cast<uint32_t>(layout.collection.refs.size() / layout.width));
+    }
+    for (const auto &phone : contact.phoneNumbers) {
+      appendItem(phones_, {phone.value, phone.type, phone.emoji});
+    }
+    for (const auto &email : contact.emailAddresses) {
+      appendItem(emails_, {email.value, email.type, email.emoji});
+    }
+    for (const auto &address : contact.addresses) {
+      appendItem(addresses_, {address.street, address.city, address.state, address.postalCode, address.country,
+                              address.type, address.emoji});
+    }
+    for (const auto &date : contact.dates) {
+      appendItem(dates_, {date.type});
+      dateValues_.push_back(date.date);
+    }
+    for (const auto &url : contact.urlAddresses) {
+      appendItem(urls_, {url.value, url.type, url.emoji});
+    }
+    for (const auto &profile : contact.socialProfiles) {
+      appendItem(socialProfiles_, {profile.service, profile.username, profile.urlString});
+    }
+    for (const auto &relation : contact.relations) {
+      appendItem(relations_, {relation.name, relation.type});
+    }
+    for (const auto &message : contact.instantMessageAddresses) {
+      appendItem(instantMessages_, {message.service, message.username, message.type});
+    }
+    for (const auto &interest : contact.interests) {
+      appendItem(interests_, {interest});
+    }
+    for (const auto &avatar : contact.avatars) {
+      appendItem(avatars_, {avatar});
+    }
+  }
+  for (Layout &layout : layouts) {
+    layout.collection.starts.push_back(static_cast<uint32_t>(layout.collection.refs.size() / layout.width));
+  }
+}
+
+ContactColumns::StringRef ContactColumns::intern(std::string_view value) {
+  if (value.empty()) {
+    return {};
+  }
+  StringRef ref{arena_.size(), static_cast<uint32_t>(value.size())};
+  arena_.insert(arena_.end(), value.begin(), value.end());
+  return ref;
+}
+
+void ContactColumns::appendItem(Collection &collection, std::initializer_list<std::string_view> values) {
+  for (std::string_view value : values) {
+    collection.refs.push_back(intern(value));
+  }
+}
+
+std::string_view ContactColumns::stringAt(size_t row, ContactStringField field) const {
+  return resolve(strings_[static_cast<size_t>(field) * rowCount_ + row]);
+}
+
+double ContactColumns::numberAt(size_t row, ContactNumberField field) const {
+  return numbers_[static_cast<size_t>(field) * rowCount_ + row];
+}
+
+LabeledValueView ContactColumns::labeledValueAt(size_t row, const Collection &collection, size_t index) const {
+  const StringRef *refs = collection.item(row, index);
+  return {stringAt(row, ContactStringField::Identifier), resolve(refs[0]), resolve(refs[1]), resolve(refs[2])};
+}
+
+LabeledValueView ContactColumns::phoneNumberAt(size_t row, size_t index) const {
+  return labeledValueAt(row, phones_, index);
+}
+
+LabeledValueView ContactColumns::emailAddressAt(size_t row, size_t index) const {
+  return labeledValueAt(row, emails_, index);
+}
+
+PostalAddressView ContactColumns::addressAt(size_t row, size_t index) const {
+  const StringRef *refs = addresses_.item(row, index);
+  return {stringAt(row, ContactStringField::Identifier), resolve(refs[0]), resolve(refs[1]), resolve(refs[2]),
+          resolve(refs[3]), resolve(refs[4]), resolve(refs[5]), resolve(refs[6])};
+}
+
+ContactDateView ContactColumns::dateAt(size_t row, size_t index) const {
+  return {stringAt(row, ContactStringField::Identifier), dateValues_[dates_.starts[row] + index],
+          resolve(*dates_.item(row, index))};
+}
+
+LabeledValueView ContactColumns::urlAddressAt(size_t row, size_t index) const {
+  return labeledValueAt(row, urls_, index);
+}
+
+SocialProfileView ContactColumns::socialProfileAt(size_t row, size_t index) const {
+  const StringRef *refs = socialProfiles_.item(row, index);
+  return {stringAt(row, ContactStringField::Identifier), resolve(refs[0]), resolve(refs[1]), resolve(refs[2])};
+}
+
+RelationView ContactColumns::relationAt(size_t row, size_t index) const {
+  const StringRef *refs = relations_.item(row, index);
+  return {stringAt(row, ContactStringField::Identifier), resolve(refs[0]), resolve(refs[1])};
+}
+
+InstantMessageView ContactColumns::instantMessageAt(size_t row, size_t index) const {
+  const StringRef *refs = instantMessages_.item(row, index);
+  return {stringAt(row, ContactStringField::Identifier), resolve(refs[0]), resolve(refs[1]), resolve(refs[2])};
+}
+
+std::string_view ContactColumns::interestAt(size_t row, size_t index) const {
+  return resolve(*interests_.item(row, index));
+}
+
+std::string_view ContactColumns::avatarAt(size_t row, size_t index) const {
+  return resolve(*avatars_.item(row, index));
+}
+
+size_t ContactColumns::memoryUsage() const {
+  size_t bytes = arena_.capacity() + strings_.capacity() * sizeof(StringRef) + numbers_.capacity() * sizeof(double) +
+                 hasBirthday_.capacity() +
+                 (imageIds_.capacity() + imageData_.capacity() + thumbnailImageData_.capacity()) * sizeof(StringRef) +
+                 dateValues_.capacity() * sizeof(double);
+  for (const Collection *collection :
+       {&phones_, &emails_, &addresses_, &dates_, &urls_, &socialProfiles_, &relations_, &instantMessages_,
+        &interests_, &avatars_}) {
+    bytes += collection->memoryUsage();
+  }
+  return bytes;
+}
+
+ContactColumnRegistry &ContactColumnRegistry::sharedInstance() {
+  static ContactColumnRegistry registry;
+  return registry;
+}
+
+uint64_t ContactColumnRegistry::add(std::shared_ptr<const ContactColumns> columns) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t handle = nextHandle_++;
+  entries_.emplace(handle, std::move(columns));
+  return handle;
+}
+
+std::shared_ptr<const ContactColumns> ContactColumnRegistry::get(uint64_t handle) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(handle);
+  return it == entries_.end() ? nullptr : it->second;
+}
+
+bool ContactColumnRegistry::release(uint64_t handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.erase(handle) > 0;
+}
+
+size_t ContactColumnRegistry::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+} // namespace contactsmanager
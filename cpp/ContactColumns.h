@@ -0,0 +1,272 @@
+//
+//  ContactColumns.h
+//  ContactsManagerCore
+//
+//  Immutable columnar snapshot of a contact list. All strings live in a single
+//  arena and every field is a column of (offset, length) references, so a list
+//  of N contacts costs a handful of allocations instead of N dictionaries.
+//  The JSI ContactListHostObject reads rows lazily from this buffer. Every
+//  collection and the photo fields are carried too, so a row has the same
+//  data as the contactToDictionary result for that contact.
+//
+
+#pragma once
+
+#include "Contact.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+enum class ContactStringField : uint8_t {
+  Identifier,
+  DisplayName,
+  NamePrefix,
+  GivenName,
+  MiddleName,
+  FamilyName,
+  PreviousFamilyName,
+  NameSuffix,
+  Nickname,
+  OrganizationName,
+  DepartmentName,
+  JobTitle,
+  Notes,
+  Bio,
+  Location,
+  ImageUrl,
+  ContactSection,
+  MatchString,
+  ParentContactId,
+  SourceId,
+  Count
+};
+
+enum class ContactNumberField : uint8_t {
+  ContactType,
+  IsDeleted,
+  DirtyTime,
+  LastSyncedAt,
+  CreatedAt,
+  Birthday,
+  ImageDataAvailable,
+  Count
+};
+
+constexpr size_t kContactStringFieldCount = static_cast<size_t>(ContactStringField::Count);
+constexpr size_t kContactNumberFieldCount = static_cast<size_t>(ContactNumberField::Count);
+
+/**
+ * JS property name of a column ("givenName", "isDeleted", ...)
+ */
+const char *contactFieldName(ContactStringField field);
+const char *contactFieldName(ContactNumberField field);
+
+/**
+ * Looks up a column by its JS property name
+ */
+std::optional<ContactStringField> contactStringFieldNamed(std::string_view name);
+std::optional<ContactNumberField> contactNumberFieldNamed(std::string_view name);
+
+/**
+ * Reads a column value straight from a contact; birthday is NaN when absent
+ */
+const std::string &contactStringFieldValue(const Contact &contact, ContactStringField field);
+double contactNumberFieldValue(const Contact &contact, ContactNumberField field);
+
+/**
+ * Borrowed view of a phone number, email address or URL; contactId is the
+ * owning row's identifier, as for every view below
+ */
+struct LabeledValueView {
+  std::string_view contactId;
+  std::string_view value;
+  std::string_view type;
+  std::string_view emoji;
+};
+
+struct PostalAddressView {
+  std::string_view contactId;
+  std::string_view street;
+  std::string_view city;
+  std::string_view state;
+  std::string_view postalCode;
+  std::string_view country;
+  std::string_view type;
+  std::string_view emoji;
+};
+
+struct ContactDateView {
+  std::string_view contactId;
+  // Seconds since 1970
+  double date = 0;
+  std::string_view type;
+};
+
+struct SocialProfileView {
+  std::string_view contactId;
+  std::string_view service;
+  std::string_view username;
+  std::string_view urlString;
+};
+
+struct RelationView {
+  std::string_view contactId;
+  std::string_view name;
+  std::string_view type;
+};
+
+struct InstantMessageView {
+  std::string_view contactId;
+  std::string_view service;
+  std::string_view username;
+  std::string_view type;
+};
+
+class ContactColumns {
+public:
+  /**
+   * @param imageIds Photo handle per row (see ContactImageCache), or empty
+   *   when photos are carried inline as the contacts' image bytes
+   */
+  explicit ContactColumns(const std::vector<Contact> &contacts, const std::vector<std::string> &imageIds = {});
+
+  ContactColumns(const ContactColumns &) = delete;
+  ContactColumns &operator=(const ContactColumns &) = delete;
+
+  size_t size() const { return rowCount_; }
+
+  std::string_view stringAt(size_t row, ContactStringField field) const;
+
+  /**
+   * Numeric column value; booleans are 0/1
+   */
+  double numberAt(size_t row, ContactNumberField field) const;
+
+  bool hasBirthday(size_t row) const { return hasBirthday_[row] != 0; }
+
+  /**
+   * Photo handle, empty when the row has none
+   */
+  std::string_view imageIdAt(size_t row) const { return resolve(imageIds_[row]); }
+
+  /**
+   * Raw photo bytes, empty unless the contacts carried them
+   */
+  std::string_view imageDataAt(size_t row) const { return resolve(imageData_[row]); }
+  std::string_view thumbnailImageDataAt(size_t row) const { return resolve(thumbnailImageData_[row]); }
+
+  size_t phoneNumberCount(size_t row) const { return phones_.count(row); }
+  LabeledValueView phoneNumberAt(size_t row, size_t index) const;
+
+  size_t emailAddressCount(size_t row) const { return emails_.count(row); }
+  LabeledValueView emailAddressAt(size_t row, size_t index) const;
+
+  size_t addressCount(size_t row) const { return addresses_.count(row); }
+  PostalAddressView addressAt(size_t row, size_t index) const;
+
+  size_t dateCount(size_t row) const { return dates_.count(row); }
+  ContactDateView dateAt(size_t row, size_t index) const;
+
+  size_t urlAddressCount(size_t row) const { return urls_.count(row); }
+  LabeledValueView urlAddressAt(size_t row, size_t index) const;
+
+  size_t socialProfileCount(size_t row) const { return socialProfiles_.count(row); }
+  SocialProfileView socialProfileAt(size_t row, size_t index) const;
+
+  size_t relationCount(size_t row) const { return relations_.count(row); }
+  RelationView relationAt(size_t row, size_t index) const;
+
+  size_t instantMessageCount(size_t row) const { return instantMessages_.count(row); }
+  InstantMessageView instantMessageAt(size_t row, size_t index) const;
+
+  size_t interestCount(size_t row) const { return interests_.count(row); }
+  std::string_view interestAt(size_t row, size_t index) const;
+
+  size_t avatarCount(size_t row) const { return avatars_.count(row); }
+  std::string_view avatarAt(size_t row, size_t index) const;
+
+  /**
+   * Approximate heap footprint of the snapshot in bytes
+   */
+  size_t memoryUsage() const;
+
+private:
+  struct StringRef {
+    // Inline photo bytes can take the arena past 4 GiB; a single value cannot
+    uint64_t offset = 0;
+    uint32_t length = 0;
+  };
+
+  // One kind of detail item, each item width consecutive refs; the items of
+  // a row are starts[row] up to starts[row + 1]
+  struct Collection {
+    size_t width = 1;
+    std::vector<uint32_t> starts;
+    std::vector<StringRef> refs;
+
+    size_t count(size_t row) const { return starts[row + 1] - starts[row]; }
+    const StringRef *item(size_t row, size_t index) const { return &refs[(starts[row] + index) * width]; }
+    size_t memoryUsage() const { return starts.capacity() * sizeof(uint32_t) + refs.capacity() * sizeof(StringRef); }
+  };
+
+  StringRef intern(std::string_view value);
+  std::string_view resolve(StringRef ref) const {
+    return std::string_view(arena_.data() + ref.offset, ref.length);
+  }
+  void appendItem(Collection &collection, std::initializer_list<std::string_view> values);
+  LabeledValueView labeledValueAt(size_t row, const Collection &collection, size_t index) const;
+
+  size_t rowCount_ = 0;
+  // Strings and inline photo bytes
+  std::vector<char> arena_;
+  // Field-major: strings_[field * rowCount_ + row]
+  std::vector<StringRef> strings_;
+  std::vector<double> numbers_;
+  std::vector<uint8_t> hasBirthday_;
+  std::vector<StringRef> imageIds_;
+  std::vector<StringRef> imageData_;
+  std::vector<StringRef> thumbnailImageData_;
+  Collection phones_;
+  Collection emails_;
+  Collection addresses_;
+  Collection dates_;
+  // Date of each item in dates_
+  std::vector<double> dateValues_;
+  Collection urls_;
+  Collection socialProfiles_;
+  Collection relations_;
+  Collection instantMessages_;
+  Collection interests_;
+  Collection avatars_;
+};
+
+/**
+ * Process-wide table of live snapshots. The bridge resolves the fetch promise
+ * with a numeric handle and JS exchanges it for a HostObject through JSI.
+ */
+class ContactColumnRegistry {
+public:
+  static ContactColumnRegistry &sharedInstance();
+
+  uint64_t add(std::shared_ptr<const ContactColumns> columns);
+  std::shared_ptr<const ContactColumns> get(uint64_t handle) const;
+  bool release(uint64_t handle);
+  size_t size() const;
+
+private:
+  mutable std::mutex mutex_;
+  uint64_t nextHandle_ = 1;
+  std::unordered_map<uint64_t, std::shared_ptr<const ContactColumns>> entries_;
+};
+
+} // namespace contactsmanager
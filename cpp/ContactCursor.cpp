@@ -0,0 +1,36 @@
+//
+//  ContactCursor.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactCursor.h"
+
+#include <charconv>
+
+namespace contactsmanager {
+
+std::string formatCursorToken(CursorToken token) {
+  return std::to_string(token.cursorId) + ":" + std::to_string(token.offset);
+}
+
+std::optional<CursorToken> parseCursorToken(std::string_view text) {
+  size_t separator = text.find(':');
+  if (separator == std::string_view::npos) {
+    return std::nullopt;
+  }
+  CursorToken token;
+  const char *idEnd = text.data() + separator;
+  auto idResult = std::from_chars(text.data(), idEnd, token.cursorId);
+  if (idResult.ec != std::errc() || idResult.ptr != idEnd || separator == 0) {
+    return std::nullopt;
+  }
+  const char *offsetBegin = idEnd + 1;
+  const char *end = text.data() + text.size();
+  auto offsetResult = std::from_chars(offsetBegin, end, token.offset);
+  if (offsetResult.ec != std::errc() || offsetResult.ptr != end || offsetBegin == end) {
+    return std::nullopt;
+  }
+  return token;
+}
+
+} // namespace contactsmanager
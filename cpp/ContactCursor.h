@@ -0,0 +1,268 @@
+//
+//  ContactCursor.h
+//  ContactsManagerCore
+//
+//  Pull-based cursor over a single pass of the contact store. The store is
+//  enumerated once on a producer thread that fills a bounded read-ahead buffer
+//  and blocks while it is full, so a consumer that stops pulling (a list view
+//  that is already full) also stops the enumeration. Each page carries an
+//  opaque position token the next pull must present.
+//
+//  Item is the platform contact type: Contact on the host build, CMContact *
+//  in the iOS bridge.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace contactsmanager {
+
+/**
+ * Position inside a cursor, exchanged with JS as "<cursorId>:<offset>"
+ */
+struct CursorToken {
+  uint64_t cursorId = 0;
+  uint64_t offset = 0;
+};
+
+std::string formatCursorToken(CursorToken token);
+std::optional<CursorToken> parseCursorToken(std::string_view text);
+
+enum class CursorStatus : uint8_t {
+  Ok,
+  // The token does not belong to this cursor or is not its current position
+  StaleToken,
+  // Another pull has not returned yet; pulls must be serialized
+  Busy,
+  Closed,
+};
+
+template <typename Item>
+struct CursorPage {
+  CursorStatus status = CursorStatus::Ok;
+  std::vector<Item> items;
+  // Token for the following pull; meaningless once done is set
+  CursorToken next;
+  bool done = false;
+};
+
+template <typename Item>
+class ContactCursor {
+public:
+  /**
+   * Calls emit for each contact in store order and stops early when emit
+   * returns false, mirroring CNContactStore's enumeration block
+   */
+  using Enumerator = std::function<void(const std::function<bool(Item &&)> &emit)>;
+
+  static constexpr size_t kDefaultReadAhead = 256;
+
+  ContactCursor(uint64_t cursorId, Enumerator enumerator, size_t readAhead = kDefaultReadAhead)
+      : cursorId_(cursorId), readAhead_(readAhead == 0 ? 1 : readAhead) {
+    producer_ = std::thread([this, enumerator = std::move(enumerator)] { produce(enumerator); });
+  }
+
+  ContactCursor(const ContactCursor &) = delete;
+  ContactCursor &operator=(const ContactCursor &) = delete;
+
+  ~ContactCursor() {
+    close();
+    if (producer_.joinable()) {
+      producer_.join();
+    }
+  }
+
+  uint64_t cursorId() const { return cursorId_; }
+
+  CursorToken firstToken() const { return CursorToken{cursorId_, 0}; }
+
+  /**
+   * Blocks until maxCount contacts are buffered or the store is exhausted,
+   * then returns them. The position is claimed before waiting, so a second
+   * pull made meanwhile gets Busy even with the same token.
+   */
+  CursorPage<Item> next(CursorToken token, size_t maxCount) {
+    CursorPage<Item> page;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (closed_) {
+      page.status = CursorStatus::Closed;
+      return page;
+    }
+    if (pulling_) {
+      page.status = CursorStatus::Busy;
+      return page;
+    }
+    if (token.cursorId != cursorId_ || token.offset != delivered_) {
+      page.status = CursorStatus::StaleToken;
+      return page;
+    }
+    pulling_ = true;
+
+    size_t wanted = maxCount == 0 ? 1 : maxCount;
+    page.items.reserve(wanted);
+    while (page.items.size() < wanted) {
+      consumerReady_.wait(lock, [this] { return !buffer_.empty() || finished_ || closed_; });
+      if (closed_) {
+        pulling_ = false;
+        page.items.clear();
+        page.status = CursorStatus::Closed;
+        return page;
+      }
+      if (buffer_.empty()) {
+        break;
+      }
+      while (!buffer_.empty() && page.items.size() < wanted) {
+        page.items.push_back(std::move(buffer_.front()));
+        buffer_.pop_front();
+      }
+      producerReady_.notify_one();
+    }
+
+    pulling_ = false;
+    delivered_ += page.items.size();
+    page.next = CursorToken{cursorId_, delivered_};
+    page.done = finished_ && buffer_.empty();
+    return page;
+  }
+
+  /**
+   * Stops the enumeration and wakes any waiting pull
+   */
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      buffer_.clear();
+    }
+    producerReady_.notify_all();
+    consumerReady_.notify_all();
+  }
+
+  /**
+   * Whether a pull is waiting for the producer
+   */
+  bool pulling() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pulling_;
+  }
+
+  /**
+   * Contacts the producer has taken from the store so far
+   */
+  uint64_t enumeratedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enumerated_;
+  }
+
+private:
+  void produce(const Enumerator &enumerator) {
+    enumerator([this](Item &&item) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      producerReady_.wait(lock, [this] { return buffer_.size() < readAhead_ || closed_; });
+      if (closed_) {
+        return false;
+      }
+      buffer_.push_back(std::move(item));
+      enumerated_++;
+      consumerReady_.notify_one();
+      return true;
+    });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+    consumerReady_.notify_all();
+  }
+
+  const uint64_t cursorId_;
+  const size_t readAhead_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable producerReady_;
+  std::condition_variable consumerReady_;
+  std::deque<Item> buffer_;
+  uint64_t delivered_ = 0;
+  uint64_t enumerated_ = 0;
+  bool pulling_ = false;
+  bool finished_ = false;
+  bool closed_ = false;
+  std::thread producer_;
+};
+
+/**
+ * Process-wide table of open cursors, keyed by cursor ID
+ */
+template <typename Item>
+class ContactCursorRegistry {
+public:
+  static ContactCursorRegistry &sharedInstance() {
+    static ContactCursorRegistry registry;
+    return registry;
+  }
+
+  std::shared_ptr<ContactCursor<Item>> open(typename ContactCursor<Item>::Enumerator enumerator,
+                                            size_t readAhead = ContactCursor<Item>::kDefaultReadAhead) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t cursorId = nextCursorId_++;
+    auto cursor = std::make_shared<ContactCursor<Item>>(cursorId, std::move(enumerator), readAhead);
+    cursors_.emplace(cursorId, cursor);
+    return cursor;
+  }
+
+  std::shared_ptr<ContactCursor<Item>> get(uint64_t cursorId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cursors_.find(cursorId);
+    return it == cursors_.end() ? nullptr : it->second;
+  }
+
+  bool close(uint64_t cursorId) {
+    std::shared_ptr<ContactCursor<Item>> cursor;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = cursors_.find(cursorId);
+      if (it == cursors_.end()) {
+        return false;
+      }
+      cursor = std::move(it->second);
+      cursors_.erase(it);
+    }
+    cursor->close();
+    return true;
+  }
+
+  void closeAll() {
+    std::unordered_map<uint64_t, std::shared_ptr<ContactCursor<Item>>> cursors;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cursors.swap(cursors_);
+    }
+    for (auto &entry : cursors) {
+      entry.second->close();
+    }
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cursors_.size();
+  }
+
+private:
+  mutable std::mutex mutex_;
+  uint64_t nextCursorId_ = 1;
+  std::unordered_map<uint64_t, std::shared_ptr<ContactCursor<Item>>> cursors_;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,475 @@
+//
+//  ContactDeduplication.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactDeduplication.h"
+
+#include "ContactHashing.h"
+#include "PhoneNumberKey.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+
+namespace contactsmanager {
+
+namespace {
+
+// Block keys carry their kind in the top bits so a phone tail never meets an email hash
+constexpr unsigned kBlockKindShift = 60;
+constexpr uint64_t kBlockValueMask = (1ULL << kBlockKindShift) - 1;
+constexpr uint64_t kPhoneBlock = 1;
+constexpr uint64_t kEmailBlock = 2;
+constexpr uint64_t kNameBlock = 3;
+// Spare top bit, set on a contact's copy of a key whose block is compared pairwise
+constexpr uint64_t kExhaustiveBlock = 1ULL << 63;
+// Above every block key
+constexpr uint64_t kBlockKeyEnd = kExhaustiveBlock;
+// Seven digits: the subscriber number, present in national and international forms alike
+constexpr uint64_t kPhoneTailModulus = 10000000;
+
+// Score weights; a shared phone or email plus a similar name clears the default threshold
+constexpr double kPhoneWeight = 0.45;
+constexpr double kEmailWeight = 0.45;
+constexpr double kNameWeight = 0.4;
+// A shared detail with nothing in the name to contradict it
+constexpr double kUnnamedWeight = 0.3;
+// A shared landline or family email under clearly different names
+constexpr double kNameConflictPenalty = 0.2;
+constexpr double kOrganizationWeight = 0.05;
+constexpr double kMinNameSimilarity = 0.7;
+// Best a pair can do without a shared phone or email
+constexpr double kMaxNameOnlyScore = std::max(kNameWeight, kUnnamedWeight) + kOrganizationWeight;
+
+// Longer names are compared on their first bytes
+constexpr size_t kMaxJaroLength = 128;
+
+struct Profile {
+  // Folded "given family", and "family given" to catch swapped fields
+  std::string name;
+  std::string swappedName;
+  std::vector<PhoneKey> phones;
+  std::vector<uint64_t> emails;
+  uint64_t organization = 0;
+};
+
+uint64_t blockKey(uint64_t kind, uint64_t value) {
+  return (kind << kBlockKindShift) | (value & kBlockValueMask);
+}
+
+Profile makeProfile(const Contact &contact, const DedupOptions &options) {
+  Profile profile;
+  std::string given = text::folded(text::trimmed(contact.givenName));
+  std::string family = text::folded(text::trimmed(contact.familyName));
+  if (given.empty() && family.empty()) {
+    given = text::folded(text::trimmed(contact.nickname));
+  }
+  profile.name = given;
+  if (!given.empty() && !family.empty()) {
+    profile.name.push_back(' ');
+    profile.swappedName = family + ' ' + given;
+  }
+  profile.name.append(family);
+
+  for (const auto &phone : contact.phoneNumbers) {
+    PhoneKey key = phoneKeyFor(phone.value, options.defaultCountryCode);
+    if (key.valid()) {
+      profile.phones.push_back(key);
+    }
+  }
+  for (const auto &email : contact.emailAddresses) {
+    std::string_view address = text::trimmed(email.value);
+    if (!address.empty()) {
+      profile.emails.push_back(fnv1a64(text::lowercased(address)));
+    }
+  }
+  std::sort(profile.emails.begin(), profile.emails.end());
+  profile.emails.erase(std::unique(profile.emails.begin(), profile.emails.end()), profile.emails.end());
+
+  std::string_view organization = text::trimmed(contact.organizationName);
+  if (!organization.empty()) {
+    profile.organization = fnv1a64(text::folded(organization));
+  }
+  return profile;
+}
+
+void appendBlockKeys(const Contact &contact, const Profile &profile, uint32_t index,
+                     std::vector<std::pair<uint64_t, uint32_t>> &entries) {
+  for (PhoneKey phone : profile.phones) {
+    uint64_t digits = phone.length() >= 7 ? phone.digits() % kPhoneTailModulus : phone.digits();
+    entries.emplace_back(blockKey(kPhoneBlock, digits), index);
+  }
+  for (uint64_t email : profile.emails) {
+    entries.emplace_back(blockKey(kEmailBlock, email), index);
+  }
+  std::string phonetic = soundexCode(contact.givenName);
+  phonetic.push_back('/');
+  phonetic.append(soundexCode(contact.familyName));
+  if (phonetic.size() > 1) {
+    entries.emplace_back(blockKey(kNameBlock, fnv1a64(phonetic)), index);
+  }
+}
+
+bool sharesPhone(const Profile &lhs, const Profile &rhs) {
+  for (PhoneKey left : lhs.phones) {
+    for (PhoneKey right : rhs.phones) {
+      if (phoneKeysMatch(left, right)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool sharesEmail(const Profile &lhs, const Profile &rhs) {
+  auto left = lhs.emails.begin();
+  auto right = rhs.emails.begin();
+  while (left != lhs.emails.end() && right != rhs.emails.end()) {
+    if (*left == *right) {
+      return true;
+    }
+    if (*left < *right) {
+      ++left;
+    } else {
+      ++right;
+    }
+  }
+  return false;
+}
+
+// Pairs that cannot reach the threshold may score 0 without comparing names
+double scoreProfiles(const Profile &lhs, const Profile &rhs, double threshold) {
+  bool phone = sharesPhone(lhs, rhs);
+  bool email = sharesEmail(lhs, rhs);
+  if (!phone && !email && threshold > kMaxNameOnlyScore) {
+    return 0;
+  }
+  double score = (phone ? kPhoneWeight : 0) + (email ? kEmailWeight : 0);
+  if (lhs.name.empty() || rhs.name.empty()) {
+    score += kUnnamedWeight;
+  } else {
+    double similarity = jaroWinklerSimilarity(lhs.name, rhs.name);
+    if (!rhs.swappedName.empty()) {
+      similarity = std::max(similarity, jaroWinklerSimilarity(lhs.name, rhs.swappedName));
+    }
+    if (similarity >= kMinNameSimilarity) {
+      score += kNameWeight * (similarity - kMinNameSimilarity) / (1 - kMinNameSimilarity);
+    } else if (phone || email) {
+      score -= kNameConflictPenalty;
+    }
+  }
+  if (lhs.organization != 0 && lhs.organization == rhs.organization) {
+    score += kOrganizationWeight;
+  }
+  return std::min(1.0, std::max(0.0, score));
+}
+
+// How much a contact would bring to a merge; the richest member is kept
+size_t completeness(const Contact &contact) {
+  return contact.phoneNumbers.size() + contact.emailAddresses.size() + contact.addresses.size() +
+         contact.urlAddresses.size() + contact.socialProfiles.size() + !contact.givenName.empty() +
+         !contact.familyName.empty() + !contact.organizationName.empty() + contact.birthday.has_value() +
+         contact.imageDataAvailable;
+}
+
+class DisjointSets {
+public:
+  explicit DisjointSets(size_t count) : parent_(count) { std::iota(parent_.begin(), parent_.end(), 0u); }
+
+  uint32_t find(uint32_t node) {
+    while (parent_[node] != node) {
+      parent_[node] = parent_[parent_[node]];
+      node = parent_[node];
+    }
+    return node;
+  }
+
+  void join(uint32_t lhs, uint32_t rhs) {
+    lhs = find(lhs);
+    rhs = find(rhs);
+    if (lhs != rhs) {
+      parent_[std::max(lhs, rhs)] = std::min(lhs, rhs);
+    }
+  }
+
+private:
+  std::vector<uint32_t> parent_;
+};
+
+} // namespace
+
+std::string soundexCode(std::string_view name) {
+  // Digits for 'a'..'z'; vowels (and y) are 0, h and w are skipped
+  static const char kCodes[] = "01230120022455012623010202";
+  std::string letters = text::folded(name);
+  std::string code;
+  char last = 0;
+  for (char c : letters) {
+    if (!text::isAsciiAlpha(c)) {
+      continue;
+    }
+    c = text::toLowerAscii(c);
+    char digit = kCodes[c - 'a'];
+    if (code.empty()) {
+      code.push_back(text::toUpperAscii(c));
+    } else if (c == 'h' || c == 'w') {
+      continue;
+    } else if (digit != '0' && digit != last) {
+      code.push_back(digit);
+      if (code.size() == 4) {
+        break;
+      }
+    }
+    last = digit;
+  }
+  if (!code.empty()) {
+    code.resize(4, '0');
+  }
+  return code;
+}
+
+double jaroWinklerSimilarity(std::string_view lhs, std::string_view rhs) {
+  if (lhs == rhs) {
+    return 1.0;
+  }
+  if (lhs.empty() || rhs.empty()) {
+    return 0.0;
+  }
+  lhs = lhs.substr(0, kMaxJaroLength);
+  rhs = rhs.substr(0, kMaxJaroLength);
+  bool lhsMatched[kMaxJaroLength] = {};
+  bool rhsMatched[kMaxJaroLength] = {};
+  size_t window = std::max(lhs.size(), rhs.size()) / 2;
+  window = window > 0 ? window - 1 : 0;
+
+  size_t matches = 0;
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    size_t begin = i > window ? i - window : 0;
+    size_t end = std::min(rhs.size(), i + window + 1);
+    for (size_t j = begin; j < end; ++j) {
+      if (!rhsMatched[j] && lhs[i] == rhs[j]) {
+        lhsMatched[i] = rhsMatched[j] = true;
+        matches++;
+        break;
+      }
+    }
+  }
+  if (matches == 0) {
+    return 0.0;
+  }
+
+  size_t transpositions = 0;
+  for (size_t i = 0, j = 0; i < lhs.size(); ++i) {
+    if (!lhsMatched[i]) {
+      continue;
+    }
+    while (!rhsMatched[j]) {
+      j++;
+    }
+    transpositions += lhs[i] != rhs[j++];
+  }
+  double m = static_cast<double>(matches);
+  double jaro = (m / static_cast<double>(lhs.size()) + m / static_cast<double>(rhs.size()) +
+                 (m - static_cast<double>(transpositions / 2)) / m) /
+                3.0;
+
+  size_t prefix = 0;
+  while (prefix < 4 && prefix < lhs.size() && prefix < rhs.size() && lhs[prefix] == rhs[prefix]) {
+    prefix++;
+  }
+  return jaro + static_cast<double>(prefix) * 0.1 * (1.0 - jaro);
+}
+
+double scoreDuplicatePair(const Contact &lhs, const Contact &rhs, const DedupOptions &options) {
+  return scoreProfiles(makeProfile(lhs, options), makeProfile(rhs, options), 0);
+}
+
+DedupResult findDuplicateContacts(const std::vector<Contact> &contacts, const DedupOptions &options) {
+  DedupResult result;
+  std::vector<Profile> profiles(contacts.size());
+  std::vector<std::pair<uint64_t, uint32_t>> entries;
+  entries.reserve(contacts.size() * 4);
+  for (uint32_t i = 0; i < contacts.size(); ++i) {
+    if (contacts[i].isDeleted) {
+      continue;
+    }
+    profiles[i] = makeProfile(contacts[i], options);
+    appendBlockKeys(contacts[i], profiles[i], i, entries);
+  }
+  std::sort(entries.begin(), entries.end());
+  // Two numbers with the same tail file a contact under one key once
+  entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+  // Every contact's keys in ascending order, flagged when their block is compared pairwise: a pair
+  // sharing several keys is then scored in the first such block only, without a set of seen pairs
+  std::vector<uint32_t> keyOffsets(contacts.size() + 1, 0);
+  for (const auto &entry : entries) {
+    keyOffsets[entry.second + 1]++;
+  }
+  std::partial_sum(keyOffsets.begin(), keyOffsets.end(), keyOffsets.begin());
+  std::vector<uint64_t> contactKeys(entries.size());
+  std::vector<uint32_t> nextKey(keyOffsets.begin(), keyOffsets.end() - 1);
+  std::vector<std::pair<size_t, size_t>> blocks;
+  for (size_t begin = 0; begin < entries.size();) {
+    size_t end = begin + 1;
+    while (end < entries.size() && entries[end].first == entries[begin].first) {
+      end++;
+    }
+    uint64_t flag = end - begin <= options.maxBlockSize ? kExhaustiveBlock : 0;
+    for (size_t i = begin; i < end; ++i) {
+      contactKeys[nextKey[entries[i].second]++] = entries[i].first | flag;
+    }
+    if (end - begin > 1) {
+      blocks.emplace_back(begin, end);
+    }
+    begin = end;
+  }
+
+  auto sharesPairwiseBlockBefore = [&](uint32_t lhs, uint32_t rhs, uint64_t key) {
+    for (size_t i = keyOffsets[lhs], j = keyOffsets[rhs]; i < keyOffsets[lhs + 1] && j < keyOffsets[rhs + 1];) {
+      uint64_t left = contactKeys[i] & ~kExhaustiveBlock;
+      uint64_t right = contactKeys[j] & ~kExhaustiveBlock;
+      if (left >= key || right >= key) {
+        break;
+      }
+      if (left == right && (contactKeys[i] & kExhaustiveBlock) != 0) {
+        return true;
+      }
+      i += left <= right;
+      j += right <= left;
+    }
+    return false;
+  };
+
+  DisjointSets sets(contacts.size());
+  auto score = [&](uint32_t lhs, uint32_t rhs) {
+    result.candidatePairs++;
+    double value = scoreProfiles(profiles[lhs], profiles[rhs], options.matchThreshold);
+    if (value >= options.matchThreshold) {
+      result.matches.push_back({lhs, rhs, value});
+      sets.join(lhs, rhs);
+    }
+  };
+
+  // Pairs from sorted-neighbourhood blocks, scored once the pairwise blocks are done
+  std::vector<uint64_t> windowPairs;
+  std::vector<uint32_t> block;
+  for (const auto &range : blocks) {
+    uint64_t key = entries[range.first].first;
+    block.clear();
+    for (size_t i = range.first; i < range.second; ++i) {
+      block.push_back(entries[i].second);
+    }
+
+    if (block.size() <= options.maxBlockSize) {
+      // Members are in index order
+      for (size_t i = 0; i < block.size(); ++i) {
+        for (size_t j = i + 1; j < block.size(); ++j) {
+          if (!sharesPairwiseBlockBefore(block[i], block[j], key)) {
+            score(block[i], block[j]);
+          }
+        }
+      }
+      continue;
+    }
+    // Sorted neighbourhood: near-identical names end up next to each other
+    std::sort(block.begin(), block.end(), [&profiles](uint32_t lhs, uint32_t rhs) {
+      return profiles[lhs].name != profiles[rhs].name ? profiles[lhs].name < profiles[rhs].name : lhs < rhs;
+    });
+    for (size_t i = 0; i < block.size(); ++i) {
+      for (size_t j = i + 1; j < block.size() && j <= i + options.neighbourWindow; ++j) {
+        uint32_t lhs = std::min(block[i], block[j]);
+        uint32_t rhs = std::max(block[i], block[j]);
+        windowPairs.push_back((static_cast<uint64_t>(lhs) << 32) | rhs);
+      }
+    }
+  }
+  std::sort(windowPairs.begin(), windowPairs.end());
+  windowPairs.erase(std::unique(windowPairs.begin(), windowPairs.end()), windowPairs.end());
+  for (uint64_t pair : windowPairs) {
+    uint32_t lhs = static_cast<uint32_t>(pair >> 32);
+    uint32_t rhs = static_cast<uint32_t>(pair);
+    if (!sharesPairwiseBlockBefore(lhs, rhs, kBlockKeyEnd)) {
+      score(lhs, rhs);
+    }
+  }
+  std::sort(result.matches.begin(), result.matches.end(), [](const DuplicatePair &lhs, const DuplicatePair &rhs) {
+    return lhs.first != rhs.first ? lhs.first < rhs.first : lhs.second < rhs.second;
+  });
+
+  // Links the user (or an earlier run) already made
+  std::vector<bool> isParent(contacts.size(), false);
+  std::unordered_map<std::string_view, uint32_t> indexByIdentifier;
+  for (uint32_t i = 0; i < contacts.size(); ++i) {
+    if (!contacts[i].isDeleted && !contacts[i].parentContactId.empty()) {
+      if (indexByIdentifier.empty()) {
+        for (uint32_t j = 0; j < contacts.size(); ++j) {
+          if (!contacts[j].isDeleted) {
+            indexByIdentifier.emplace(contacts[j].identifier, j);
+          }
+        }
+      }
+      auto parent = indexByIdentifier.find(contacts[i].parentContactId);
+      if (parent != indexByIdentifier.end() && parent->second != i) {
+        sets.join(i, parent->second);
+        isParent[parent->second] = true;
+      }
+    }
+  }
+
+  std::unordered_map<uint32_t, size_t> clusterByRoot;
+  for (uint32_t i = 0; i < contacts.size(); ++i) {
+    // A set's root is its lowest index, so it is seen before the other members
+    uint32_t root = sets.find(i);
+    if (root == i) {
+      continue;
+    }
+    auto inserted = clusterByRoot.emplace(root, result.clusters.size());
+    if (inserted.second) {
+      result.clusters.emplace_back();
+      result.clusters.back().members.push_back(root);
+    }
+    result.clusters[inserted.first->second].members.push_back(i);
+  }
+
+  for (auto &cluster : result.clusters) {
+    auto better = [&](uint32_t lhs, uint32_t rhs) -> bool {
+      if (isParent[lhs] != isParent[rhs]) {
+        return isParent[lhs];
+      }
+      size_t left = completeness(contacts[lhs]);
+      size_t right = completeness(contacts[rhs]);
+      if (left != right) {
+        return left > right;
+      }
+      return contacts[lhs].createdAt != contacts[rhs].createdAt ? contacts[lhs].createdAt < contacts[rhs].createdAt
+                                                                : lhs < rhs;
+    };
+    auto primary = std::min_element(cluster.members.begin(), cluster.members.end(), better);
+    std::iter_swap(cluster.members.begin(), primary);
+    std::sort(cluster.members.begin() + 1, cluster.members.end());
+  }
+  std::sort(result.clusters.begin(), result.clusters.end(),
+            [](const MergeCluster &lhs, const MergeCluster &rhs) { return lhs.members[0] < rhs.members[0]; });
+  return result;
+}
+
+size_t assignParentContactIds(std::vector<Contact> &contacts, const DedupResult &result) {
+  size_t changed = 0;
+  for (const auto &cluster : result.clusters) {
+    const std::string &primary = contacts[cluster.members[0]].identifier;
+    for (size_t i = 1; i < cluster.members.size(); ++i) {
+      Contact &member = contacts[cluster.members[i]];
+      if (member.parentContactId != primary) {
+        member.parentContactId = primary;
+        changed++;
+      }
+    }
+  }
+  return changed;
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,92 @@
+//
+//  ContactDeduplication.h
+//  ContactsManagerCore
+//
+//  On-device duplicate detection, so duplicates can be linked through
+//  parentContactId before upload instead of being resolved by the server.
+//
+//  Candidates come from blocking: every contact is filed under a key per
+//  phone number (its last seven digits, so national and international forms
+//  meet), per normalized email address and for its phonetic name (Soundex of
+//  the given and family names). Only contacts sharing a key are compared. A
+//  block too large to compare pairwise (a shared switchboard number, a common
+//  name) is sorted by name and each contact is compared with its next few
+//  neighbours, so candidate generation stays linear in the book size.
+//
+//  Candidate pairs are scored from matching phones and emails and the name
+//  similarity (Jaro-Winkler); pairs at or above the threshold are joined into
+//  merge clusters.
+//
+
+#pragma once
+
+#include "Contact.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace contactsmanager {
+
+struct DedupOptions {
+  // Calling code for numbers stored without one, 0 for none (see phoneKeyFor)
+  uint16_t defaultCountryCode = 0;
+  double matchThreshold = 0.75;
+  // Blocks up to this size are compared pairwise
+  size_t maxBlockSize = 32;
+  // Neighbours each contact is compared with in a larger block
+  size_t neighbourWindow = 8;
+};
+
+struct DuplicatePair {
+  // Indexes into the input, first < second
+  uint32_t first = 0;
+  uint32_t second = 0;
+  double score = 0;
+};
+
+struct MergeCluster {
+  // Indexes into the input; the contact to keep comes first, then ascending
+  std::vector<uint32_t> members;
+};
+
+struct DedupResult {
+  // Clusters of two or more contacts, ordered by their first member
+  std::vector<MergeCluster> clusters;
+  // Scored pairs at or above the threshold, ordered by index
+  std::vector<DuplicatePair> matches;
+  size_t candidatePairs = 0;
+};
+
+/**
+ * Four-character Soundex code of a name ("Robert" and "Rupert" give "R163"),
+ * after diacritic folding; empty when the name has no ASCII letter
+ */
+std::string soundexCode(std::string_view name);
+
+/**
+ * Jaro-Winkler similarity in [0, 1] of two byte strings; 1 for equal strings
+ */
+double jaroWinklerSimilarity(std::string_view lhs, std::string_view rhs);
+
+/**
+ * Likelihood in [0, 1] that two contacts are the same person
+ */
+double scoreDuplicatePair(const Contact &lhs, const Contact &rhs, const DedupOptions &options = {});
+
+/**
+ * Finds the merge clusters in a book. Deleted contacts are ignored; a contact
+ * whose parentContactId names another contact in the book is always in its
+ * cluster, and an existing parent is kept in preference to other members.
+ */
+DedupResult findDuplicateContacts(const std::vector<Contact> &contacts, const DedupOptions &options = {});
+
+/**
+ * Points the parentContactId of every non-primary member at its cluster's
+ * first member; returns how many contacts changed
+ */
+size_t assignParentContactIds(std::vector<Contact> &contacts, const DedupResult &result);
+
+} // namespace contactsmanager
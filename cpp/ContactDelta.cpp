@@ -0,0 +1,537 @@
+//
+//  ContactDelta.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactDelta.h"
+#include "BinaryFile.h"
+#include "ContactHashing.h"
+
+#include <algorithm>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'C', 'M', 'S', 'N'};
+constexpr uint32_t kFileVersion = 1;
+
+struct StringField {
+  ContactField field;
+  std::string Contact::*member;
+};
+
+// Every scalar field except Birthday and ContactType
+constexpr StringField kStringFields[] = {
+    {ContactField::DisplayName, &Contact::displayName},
+    {ContactField::GivenName, &Contact::givenName},
+    {ContactField::FamilyName, &Contact::familyName},
+    {ContactField::NamePrefix, &Contact::namePrefix},
+    {ContactField::NameSuffix, &Contact::nameSuffix},
+    {ContactField::MiddleName, &Contact::middleName},
+    {ContactField::PreviousFamilyName, &Contact::previousFamilyName},
+    {ContactField::Nickname, &Contact::nickname},
+    {ContactField::Notes, &Contact::notes},
+    {ContactField::Bio, &Contact::bio},
+    {ContactField::Location, &Contact::location},
+    {ContactField::ContactSection, &Contact::contactSection},
+    {ContactField::MatchString, &Contact::matchString},
+    {ContactField::OrganizationName, &Contact::organizationName},
+    {ContactField::DepartmentName, &Contact::departmentName},
+    {ContactField::JobTitle, &Contact::jobTitle},
+};
+
+// Calls visit(collection, member) for every collection
+template <typename Visitor>
+void forEachCollection(Visitor &&visit) {
+  visit(ContactCollection::PhoneNumbers, &Contact::phoneNumbers);
+  visit(ContactCollection::EmailAddresses, &Contact::emailAddresses);
+  visit(ContactCollection::Urls, &Contact::urlAddresses);
+  visit(ContactCollection::SocialProfiles, &Contact::socialProfiles);
+  visit(ContactCollection::Addresses, &Contact::addresses);
+  visit(ContactCollection::InstantMessages, &Contact::instantMessageAddresses);
+  visit(ContactCollection::Relations, &Contact::relations);
+  visit(ContactCollection::Dates, &Contact::dates);
+}
+
+// Item equality on the synced fields; contactId is implied by the contact
+
+bool sameItem(const PhoneNumber &lhs, const PhoneNumber &rhs) {
+  return lhs.value == rhs.value && lhs.type == rhs.type && lhs.emoji == rhs.emoji;
+}
+
+bool sameItem(const EmailAddress &lhs, const EmailAddress &rhs) {
+  return lhs.value == rhs.value && lhs.type == rhs.type && lhs.emoji == rhs.emoji;
+}
+
+bool sameItem(const ContactURL &lhs, const ContactURL &rhs) {
+  return lhs.value == rhs.value && lhs.type == rhs.type && lhs.emoji == rhs.emoji;
+}
+
+bool sameItem(const SocialProfile &lhs, const SocialProfile &rhs) {
+  return lhs.service == rhs.service && lhs.username == rhs.username && lhs.urlString == rhs.urlString;
+}
+
+bool sameItem(const PostalAddress &lhs, const PostalAddress &rhs) {
+  return lhs.street == rhs.street && lhs.city == rhs.city && lhs.state == rhs.state &&
+         lhs.postalCode == rhs.postalCode && lhs.country == rhs.country && lhs.type == rhs.type &&
+         lhs.emoji == rhs.emoji;
+}
+
+bool sameItem(const InstantMessage &lhs, const InstantMessage &rhs) {
+  return lhs.service == rhs.service && lhs.username == rhs.username && lhs.type == rhs.type;
+}
+
+bool sameItem(const Relation &lhs, const Relation &rhs) {
+  return lhs.name == rhs.name && lhs.type == rhs.type;
+}
+
+bool sameItem(const ContactDate &lhs, const ContactDate &rhs) {
+  return lhs.date == rhs.date && lhs.type == rhs.type;
+}
+
+template <typename Item>
+void diffCollection(ContactCollection collection, const std::vector<Item> &base, const std::vector<Item> &current,
+                    std::vector<Item> &values, std::vector<CollectionPatch> &patches) {
+  // Keep base items that match current in order; the unmatched rest of current is appended
+  CollectionPatch patch;
+  patch.collection = collection;
+  size_t kept = 0;
+  for (size_t i = 0; i < base.size(); ++i) {
+    if (kept < current.size() && sameItem(base[i], current[kept])) {
+      kept++;
+    } else {
+      patch.removed.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  if (patch.removed.empty() && kept == current.size()) {
+    return;
+  }
+  if (kept == 0 || (!patch.removed.empty() && patch.removed.front() == 0)) {
+    // Either nothing survives, so sending the list is never larger than removing and appending,
+    // or the primary item changes and only a full list carries its isPrimary flag
+    patch.replace = true;
+    patch.removed.clear();
+    values = current;
+  } else {
+    values.assign(current.begin() + static_cast<std::ptrdiff_t>(kept), current.end());
+  }
+  patches.push_back(std::move(patch));
+}
+
+// Snapshot encoding
+
+void encodeItem(std::string &out, const PhoneNumber &item) {
+  binary::writeString(out, item.value);
+  binary::writeString(out, item.type);
+  binary::writeString(out, item.emoji);
+}
+
+bool decodeItem(binary::Reader &reader, PhoneNumber &item) {
+  return reader.readString(item.value) && reader.readString(item.type) && reader.readString(item.emoji);
+}
+
+void encodeItem(std::string &out, const EmailAddress &item) {
+  binary::writeString(out, item.value);
+  binary::writeString(out, item.type);
+  binary::writeString(out, item.emoji);
+}
+
+bool decodeItem(binary::Reader &reader, EmailAddress &item) {
+  return reader.readString(item.value) && reader.readString(item.type) && reader.readString(item.emoji);
+}
+
+void encodeItem(std::string &out, const ContactURL &item) {
+  binary::writeString(out, item.value);
+  binary::writeString(out, item.type);
+  binary::writeString(out, item.emoji);
+}
+
+bool decodeItem(binary::Reader &reader, ContactURL &item) {
+  return reader.readString(item.value) && reader.readString(item.type) && reader.readString(item.emoji);
+}
+
+void encodeItem(std::string &out, const SocialProfile &item) {
+  binary::writeString(out, item.service);
+  binary::writeString(out, item.username);
+  binary::writeString(out, item.urlString);
+}
+
+bool decodeItem(binary::Reader &reader, SocialProfile &item) {
+  return reader.readString(item.service) && reader.readString(item.username) && reader.readString(item.urlString);
+}
+
+void encodeItem(std::string &out, const PostalAddress &item) {
+  binary::writeString(out, item.street);
+  binary::writeString(out, item.city);
+  binary::writeString(out, item.state);
+  binary::writeString(out, item.postalCode);
+  binary::writeString(out, item.country);
+  binary::writeString(out, item.type);
+  binary::writeString(out, item.emoji);
+}
+
+bool decodeItem(binary::Reader &reader, PostalAddress &item) {
+  return reader.readString(item.street) && reader.readString(item.city) && reader.readString(item.state) &&
+         reader.readString(item.postalCode) && reader.readString(item.country) && reader.readString(item.type) &&
+         reader.readString(item.emoji);
+}
+
+void encodeItem(std::string &out, const InstantMessage &item) {
+  binary::writeString(out, item.service);
+  binary::writeString(out, item.username);
+  binary::writeString(out, item.type);
+}
+
+bool decodeItem(binary::Reader &reader, InstantMessage &item) {
+  return reader.readString(item.service) && reader.readString(item.username) && reader.readString(item.type);
+}
+
+void encodeItem(std::string &out, const Relation &item) {
+  binary::writeString(out, item.name);
+  binary::writeString(out, item.type);
+}
+
+bool decodeItem(binary::Reader &reader, Relation &item) {
+  return reader.readString(item.name) && reader.readString(item.type);
+}
+
+void encodeItem(std::string &out, const ContactDate &item) {
+  binary::writeDouble(out, item.date);
+  binary::writeString(out, item.type);
+}
+
+bool decodeItem(binary::Reader &reader, ContactDate &item) {
+  return reader.readDouble(item.date) && reader.readString(item.type);
+}
+
+std::string encodeSnapshot(const Contact &contact) {
+  std::string out;
+  binary::writeString(out, contact.identifier);
+  binary::writeUint64(out, static_cast<uint64_t>(contact.contactType));
+  for (const auto &field : kStringFields) {
+    binary::writeString(out, contact.*field.member);
+  }
+  binary::writeUint32(out, contact.birthday ? 1 : 0);
+  if (contact.birthday) {
+    binary::writeDouble(out, *contact.birthday);
+  }
+  binary::writeString(out, contact.imageUrl);
+  forEachCollection([&](ContactCollection, auto member) {
+    const auto &items = contact.*member;
+    binary::writeUint32(out, static_cast<uint32_t>(items.size()));
+    for (const auto &item : items) {
+      encodeItem(out, item);
+    }
+  });
+  binary::writeUint32(out, static_cast<uint32_t>(contact.interests.size()));
+  for (const auto &interest : contact.interests) {
+    binary::writeString(out, interest);
+  }
+  return out;
+}
+
+bool decodeSnapshot(std::string_view data, Contact &contact) {
+  binary::Reader reader(data);
+  uint64_t contactType = 0;
+  uint32_t hasBirthday = 0;
+  if (!reader.readString(contact.identifier) || !reader.readUint64(contactType)) {
+    return false;
+  }
+  contact.contactType = static_cast<int64_t>(contactType);
+  for (const auto &field : kStringFields) {
+    if (!reader.readString(contact.*field.member)) {
+      return false;
+    }
+  }
+  if (!reader.readUint32(hasBirthday)) {
+    return false;
+  }
+  if (hasBirthday) {
+    double birthday = 0;
+    if (!reader.readDouble(birthday)) {
+      return false;
+    }
+    contact.birthday = birthday;
+  }
+  if (!reader.readString(contact.imageUrl)) {
+    return false;
+  }
+  bool ok = true;
+  forEachCollection([&](ContactCollection, auto member) {
+    auto &items = contact.*member;
+    uint32_t count = 0;
+    if (!ok || !reader.readUint32(count)) {
+      ok = false;
+      return;
+    }
+    for (uint32_t i = 0; i < count && ok; ++i) {
+      items.emplace_back();
+      items.back().contactId = contact.identifier;
+      ok = decodeItem(reader, items.back());
+    }
+  });
+  uint32_t interests = 0;
+  if (!ok || !reader.readUint32(interests)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < interests; ++i) {
+    contact.interests.emplace_back();
+    if (!reader.readString(contact.interests.back())) {
+      return false;
+    }
+  }
+  return reader.atEnd();
+}
+
+} // namespace
+
+const char *contactFieldName(ContactField field) {
+  switch (field) {
+  case ContactField::DisplayName:
+    return "displayName";
+  case ContactField::GivenName:
+    return "givenName";
+  case ContactField::FamilyName:
+    return "familyName";
+  case ContactField::NamePrefix:
+    return "namePrefix";
+  case ContactField::NameSuffix:
+    return "nameSuffix";
+  case ContactField::MiddleName:
+    return "middleName";
+  case ContactField::PreviousFamilyName:
+    return "previousFamilyName";
+  case ContactField::Nickname:
+    return "nickname";
+  case ContactField::Notes:
+    return "notes";
+  case ContactField::Bio:
+    return "bio";
+  case ContactField::Location:
+    return "location";
+  case ContactField::ContactSection:
+    return "contactSection";
+  case ContactField::MatchString:
+    return "matchString";
+  case ContactField::OrganizationName:
+    return "organizationName";
+  case ContactField::DepartmentName:
+    return "departmentName";
+  case ContactField::JobTitle:
+    return "jobTitle";
+  case ContactField::Birthday:
+    return "birthday";
+  case ContactField::ContactType:
+    return "contactType";
+  }
+  return "";
+}
+
+const char *contactCollectionName(ContactCollection collection) {
+  switch (collection) {
+  case ContactCollection::PhoneNumbers:
+    return "phoneNumbers";
+  case ContactCollection::EmailAddresses:
+    return "emailAddresses";
+  case ContactCollection::Urls:
+    return "urls";
+  case ContactCollection::SocialProfiles:
+    return "socialProfiles";
+  case ContactCollection::Addresses:
+    return "addresses";
+  case ContactCollection::InstantMessages:
+    return "instantMessageAddresses";
+  case ContactCollection::Relations:
+    return "relations";
+  case ContactCollection::Dates:
+    return "dates";
+  }
+  return "";
+}
+
+const CollectionPatch *ContactPatch::collection(ContactCollection collection) const {
+  for (const auto &patch : collections) {
+    if (patch.collection == collection) {
+      return &patch;
+    }
+  }
+  return nullptr;
+}
+
+ContactPatch diffContacts(const Contact &base, const Contact &current) {
+  ContactPatch patch;
+  patch.contactId = current.identifier;
+  patch.values.identifier = current.identifier;
+  patch.baseVersion = serverContactHash128(base);
+  patch.version = serverContactHash128(current);
+
+  for (const auto &field : kStringFields) {
+    if (base.*field.member != current.*field.member) {
+      patch.fields |= contactFieldBit(field.field);
+      patch.values.*field.member = current.*field.member;
+    }
+  }
+  if (base.birthday != current.birthday) {
+    patch.fields |= contactFieldBit(ContactField::Birthday);
+    patch.values.birthday = current.birthday;
+  }
+  if (base.contactType != current.contactType) {
+    patch.fields |= contactFieldBit(ContactField::ContactType);
+    patch.values.contactType = current.contactType;
+  }
+  forEachCollection([&](ContactCollection collection, auto member) {
+    diffCollection(collection, base.*member, current.*member, patch.values.*member, patch.collections);
+  });
+  return patch;
+}
+
+bool applyContactPatch(Contact &contact, const ContactPatch &patch) {
+  for (const auto &collection : patch.collections) {
+    bool valid = true;
+    forEachCollection([&](ContactCollection id, auto member) {
+      if (id != collection.collection) {
+        return;
+      }
+      size_t size = (contact.*member).size();
+      for (size_t i = 0; i < collection.removed.size(); ++i) {
+        if (collection.removed[i] >= size || (i > 0 && collection.removed[i] <= collection.removed[i - 1])) {
+          valid = false;
+        }
+      }
+    });
+    if (!valid) {
+      return false;
+    }
+  }
+
+  for (const auto &field : kStringFields) {
+    if (patch.hasField(field.field)) {
+      contact.*field.member = patch.values.*field.member;
+    }
+  }
+  if (patch.hasField(ContactField::Birthday)) {
+    contact.birthday = patch.values.birthday;
+  }
+  if (patch.hasField(ContactField::ContactType)) {
+    contact.contactType = patch.values.contactType;
+  }
+  forEachCollection([&](ContactCollection id, auto member) {
+    const CollectionPatch *collection = patch.collection(id);
+    if (!collection) {
+      return;
+    }
+    auto &items = contact.*member;
+    const auto &values = patch.values.*member;
+    if (collection->replace) {
+      items = values;
+      return;
+    }
+    for (auto it = collection->removed.rbegin(); it != collection->removed.rend(); ++it) {
+      items.erase(items.begin() + *it);
+    }
+    items.insert(items.end(), values.begin(), values.end());
+  });
+  return true;
+}
+
+ContactSnapshotStore &ContactSnapshotStore::sharedInstance() {
+  static ContactSnapshotStore store;
+  return store;
+}
+
+std::optional<Contact> ContactSnapshotStore::get(std::string_view contactId) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = snapshots_.find(std::string(contactId));
+  if (it == snapshots_.end()) {
+    return std::nullopt;
+  }
+  Contact contact;
+  if (!decodeSnapshot(it->second, contact)) {
+    return std::nullopt;
+  }
+  return contact;
+}
+
+void ContactSnapshotStore::put(const Contact &contact) {
+  std::string snapshot = encodeSnapshot(contact);
+  std::lock_guard<std::mutex> lock(mutex_);
+  snapshots_[contact.identifier] = std::move(snapshot);
+}
+
+bool ContactSnapshotStore::remove(std::string_view contactId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return snapshots_.erase(std::string(contactId)) > 0;
+}
+
+bool ContactSnapshotStore::contains(std::string_view contactId) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return snapshots_.count(std::string(contactId)) > 0;
+}
+
+size_t ContactSnapshotStore::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return snapshots_.size();
+}
+
+void ContactSnapshotStore::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  snapshots_.clear();
+}
+
+std::optional<ContactPatch> ContactSnapshotStore::patchFor(const Contact &current) const {
+  std::optional<Contact> base = get(current.identifier);
+  if (!base) {
+    return std::nullopt;
+  }
+  return diffContacts(*base, current);
+}
+
+bool ContactSnapshotStore::save(const std::string &path) const {
+  std::string out;
+  out.append(kFileMagic, sizeof(kFileMagic));
+  binary::writeUint32(out, kFileVersion);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    binary::writeUint32(out, static_cast<uint32_t>(snapshots_.size()));
+    for (const auto &entry : snapshots_) {
+      binary::writeString(out, entry.first);
+      binary::writeString(out, entry.second);
+    }
+  }
+  return binary::writeFileAtomically(path, out);
+}
+
+bool ContactSnapshotStore::load(const std::string &path) {
+  std::string data;
+  bool read = binary::readFile(path, data);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  snapshots_.clear();
+  binary::Reader reader(data);
+  uint32_t version = 0;
+  uint32_t count = 0;
+  if (!read || !reader.expect(std::string_view(kFileMagic, sizeof(kFileMagic))) || !reader.readUint32(version) ||
+      version != kFileVersion || !reader.readUint32(count)) {
+    return false;
+  }
+
+  std::unordered_map<std::string, std::string> snapshots;
+  // Each entry takes at least 8 bytes, which bounds the reservation for a corrupt count
+  snapshots.reserve(std::min<size_t>(count, data.size() / 8));
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string identifier;
+    std::string snapshot;
+    if (!reader.readString(identifier) || !reader.readString(snapshot) ||
+        !snapshots.emplace(std::move(identifier), std::move(snapshot)).second) {
+      return false;
+    }
+  }
+  if (!reader.atEnd()) {
+    return false;
+  }
+  snapshots_ = std::move(snapshots);
+  return true;
+}
+
+} // namespace contactsmanager
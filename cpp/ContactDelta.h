@@ -0,0 +1,169 @@
+//
+//  ContactDelta.h
+//  ContactsManagerCore
+//
+//  Field-level deltas for contact sync. The snapshot store keeps the last
+//  version of each contact the server acknowledged; a changed contact is then
+//  diffed against it field by field and per sub-collection, and only the
+//  differences are uploaded as a patch. Patches name the version they apply
+//  to, so a server that holds no (or a different) base version rejects them
+//  and the client falls back to a full upsert.
+//
+//  Collection patches remove items by their index in the base list and append
+//  new items. That is only possible when the surviving items keep their
+//  relative order and come before every new item, and when the first item
+//  (the one sent as isPrimary) stays first; otherwise the whole list is
+//  replaced. Patch versions are serverContactHash128, so imageUrl and
+//  interests, which the server contact does not carry, neither appear in
+//  patches nor change a version.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "StreamingHash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+/**
+ * Scalar fields a patch can set, in CMServerContact order
+ */
+enum class ContactField : uint8_t {
+  DisplayName,
+  GivenName,
+  FamilyName,
+  NamePrefix,
+  NameSuffix,
+  MiddleName,
+  PreviousFamilyName,
+  Nickname,
+  Notes,
+  Bio,
+  Location,
+  ContactSection,
+  MatchString,
+  OrganizationName,
+  DepartmentName,
+  JobTitle,
+  Birthday,
+  ContactType,
+};
+
+constexpr size_t kContactFieldCount = static_cast<size_t>(ContactField::ContactType) + 1;
+
+constexpr uint32_t contactFieldBit(ContactField field) {
+  return 1u << static_cast<uint32_t>(field);
+}
+
+enum class ContactCollection : uint8_t {
+  PhoneNumbers,
+  EmailAddresses,
+  Urls,
+  SocialProfiles,
+  Addresses,
+  InstantMessages,
+  Relations,
+  Dates,
+};
+
+constexpr size_t kContactCollectionCount = static_cast<size_t>(ContactCollection::Dates) + 1;
+
+/**
+ * CMServerContact key of the field or collection
+ */
+const char *contactFieldName(ContactField field);
+const char *contactCollectionName(ContactCollection collection);
+
+struct CollectionPatch {
+  ContactCollection collection = ContactCollection::PhoneNumbers;
+  // Replace the list with the items in ContactPatch::values instead
+  bool replace = false;
+  // Indices into the base list, ascending
+  std::vector<uint32_t> removed;
+};
+
+struct ContactPatch {
+  std::string contactId;
+  // serverContactHash128 of the snapshot the patch applies to, and of the result
+  Hash128 baseVersion;
+  Hash128 version;
+  // contactFieldBit mask of the fields to set
+  uint32_t fields = 0;
+  std::vector<CollectionPatch> collections;
+  // New values of the fields in the mask; each patched collection holds the
+  // items to append (every item when replaced)
+  Contact values;
+
+  bool hasField(ContactField field) const { return (fields & contactFieldBit(field)) != 0; }
+  const CollectionPatch *collection(ContactCollection collection) const;
+};
+
+/**
+ * Patch that turns base into current (on the fields the server stores)
+ */
+ContactPatch diffContacts(const Contact &base, const Contact &current);
+
+/**
+ * Applies patch to contact in place
+ * @return false, leaving contact untouched, if a removed index is out of range
+ */
+bool applyContactPatch(Contact &contact, const ContactPatch &patch);
+
+/**
+ * Last version of each contact the server acknowledged. Snapshots hold the
+ * synced and hashed fields only (no image bytes or sync bookkeeping) and are
+ * kept encoded, so the store costs about as much memory as the text it holds.
+ */
+class ContactSnapshotStore {
+public:
+  ContactSnapshotStore() = default;
+
+  ContactSnapshotStore(const ContactSnapshotStore &) = delete;
+  ContactSnapshotStore &operator=(const ContactSnapshotStore &) = delete;
+
+  static ContactSnapshotStore &sharedInstance();
+
+  std::optional<Contact> get(std::string_view contactId) const;
+
+  /**
+   * Records contact as the server's current version
+   */
+  void put(const Contact &contact);
+
+  bool remove(std::string_view contactId);
+  bool contains(std::string_view contactId) const;
+  size_t size() const;
+  void clear();
+
+  /**
+   * Patch from the acknowledged snapshot to current
+   * @return nullopt when there is no snapshot, i.e. the contact must be upserted
+   */
+  std::optional<ContactPatch> patchFor(const Contact &current) const;
+
+  /**
+   * Writes the snapshots to path atomically
+   */
+  bool save(const std::string &path) const;
+
+  /**
+   * Replaces the snapshots with the ones stored at path; on any error the
+   * store is left empty (every contact is upserted once) and false is returned
+   */
+  bool load(const std::string &path);
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::string> snapshots_;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,49 @@
+//
+//  ContactDetail.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactDetail.h"
+
+namespace contactsmanager {
+
+bool operator==(const PhoneNumber &lhs, const PhoneNumber &rhs) {
+  return lhs.contactId == rhs.contactId && lhs.value == rhs.value && lhs.type == rhs.type &&
+         lhs.emoji == rhs.emoji;
+}
+
+bool operator==(const EmailAddress &lhs, const EmailAddress &rhs) {
+  return lhs.contactId == rhs.contactId && lhs.value == rhs.value && lhs.type == rhs.type &&
+         lhs.emoji == rhs.emoji;
+}
+
+bool operator==(const PostalAddress &lhs, const PostalAddress &rhs) {
+  return lhs.contactId == rhs.contactId && lhs.street == rhs.street && lhs.city == rhs.city &&
+         lhs.state == rhs.state && lhs.postalCode == rhs.postalCode && lhs.country == rhs.country &&
+         lhs.type == rhs.type && lhs.emoji == rhs.emoji;
+}
+
+bool operator==(const ContactDate &lhs, const ContactDate &rhs) {
+  return lhs.contactId == rhs.contactId && lhs.date == rhs.date && lhs.type == rhs.type;
+}
+
+bool operator==(const ContactURL &lhs, const ContactURL &rhs) {
+  return lhs.contactId == rhs.contactId && lhs.value == rhs.value && lhs.type == rhs.type &&
+         lhs.emoji == rhs.emoji;
+}
+
+bool operator==(const SocialProfile &lhs, const SocialProfile &rhs) {
+  return lhs.contactId == rhs.contactId && lhs.service == rhs.service &&
+         lhs.username == rhs.username && lhs.urlString == rhs.urlString;
+}
+
+bool operator==(const Relation &lhs, const Relation &rhs) {
+  return lhs.contactId == rhs.contactId && lhs.name == rhs.name && lhs.type == rhs.type;
+}
+
+bool operator==(const InstantMessage &lhs, const InstantMessage &rhs) {
+  return lhs.contactId == rhs.contactId && lhs.service == rhs.service &&
+         lhs.username == rhs.username && lhs.type == rhs.type;
+}
+
+} // namespace contactsmanager
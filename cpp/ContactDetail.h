@@ -0,0 +1,107 @@
+//
+//  ContactDetail.h
+//  ContactsManagerCore
+//
+//  Portable mirrors of the CMContactDetail value types.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace contactsmanager {
+
+/**
+ * Phone number for a contact (mirrors CMContactPhoneNumber)
+ */
+struct PhoneNumber {
+  std::string contactId;
+  std::string value;
+  std::string type;
+  std::string emoji;
+};
+
+/**
+ * Email address for a contact (mirrors CMContactEmailAddress)
+ */
+struct EmailAddress {
+  std::string contactId;
+  std::string value;
+  std::string type;
+  std::string emoji;
+};
+
+/**
+ * Physical address for a contact (mirrors CMContactAddress)
+ */
+struct PostalAddress {
+  std::string contactId;
+  std::string street;
+  std::string city;
+  std::string state;
+  std::string postalCode;
+  std::string country;
+  std::string type;
+  std::string emoji;
+};
+
+/**
+ * Date associated with a contact (mirrors CMContactDate)
+ * The date is stored as seconds since 1970.
+ */
+struct ContactDate {
+  std::string contactId;
+  double date = 0;
+  std::string type;
+};
+
+/**
+ * URL for a contact (mirrors CMContactURL)
+ */
+struct ContactURL {
+  std::string contactId;
+  std::string value;
+  std::string type;
+  std::string emoji;
+};
+
+/**
+ * Social profile for a contact (mirrors CMContactSocialProfile)
+ */
+struct SocialProfile {
+  std::string contactId;
+  std::string service;
+  std::string username;
+  std::string urlString;
+};
+
+/**
+ * Relationship for a contact (mirrors CMContactRelation)
+ */
+struct Relation {
+  std::string contactId;
+  std::string name;
+  std::string type;
+};
+
+/**
+ * Instant message address for a contact (mirrors CMContactInstantMessage)
+ */
+struct InstantMessage {
+  std::string contactId;
+  std::string service;
+  std::string username;
+  std::string type;
+};
+
+bool operator==(const PhoneNumber &lhs, const PhoneNumber &rhs);
+bool operator==(const EmailAddress &lhs, const EmailAddress &rhs);
+bool operator==(const PostalAddress &lhs, const PostalAddress &rhs);
+bool operator==(const ContactDate &lhs, const ContactDate &rhs);
+bool operator==(const ContactURL &lhs, const ContactURL &rhs);
+bool operator==(const SocialProfile &lhs, const SocialProfile &rhs);
+bool operator==(const Relation &lhs, const Relation &rhs);
+bool operator==(const InstantMessage &lhs, const InstantMessage &rhs);
+
+} // namespace contactsmanager
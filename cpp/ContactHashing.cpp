@@ -0,0 +1,233 @@
+//
+//  ContactHashing.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactHashing.h"
+
+#include <cmath>
+
+namespace contactsmanager {
+
+namespace {
+
+// Feeds one contact into a sink in section order. The sink provides
+// begin(ContactSection) and the hasher the section's fields go to.
+template <typename Sink>
+void feedContact(const Contact &contact, uint16_t defaultCountryCode, Sink &sink) {
+  auto field = [&sink](std::string_view value) { sink.hasher().updateField(value); };
+  // Same precision the string serialization used ("%.3f")
+  auto number = [&sink](double value) {
+    sink.hasher().updateUint64(static_cast<uint64_t>(std::llround(value * 1000.0)));
+  };
+  auto count = [&sink](size_t value) { sink.hasher().updateUint64(value); };
+
+  sink.begin(ContactSection::Identity);
+  field(contact.identifier);
+  sink.hasher().updateUint64(static_cast<uint64_t>(contact.contactType));
+
+  sink.begin(ContactSection::Name);
+  field(contact.displayName);
+  field(contact.namePrefix);
+  field(contact.givenName);
+  field(contact.middleName);
+  field(contact.familyName);
+  field(contact.previousFamilyName);
+  field(contact.nameSuffix);
+  field(contact.nickname);
+
+  sink.begin(ContactSection::Organization);
+  field(contact.organizationName);
+  field(contact.departmentName);
+  field(contact.jobTitle);
+
+  sink.begin(ContactSection::Notes);
+  field(contact.notes);
+  field(contact.bio);
+  field(contact.location);
+
+  sink.begin(ContactSection::Dates);
+  count(contact.birthday ? 1 : 0);
+  if (contact.birthday) {
+    number(*contact.birthday);
+  }
+  count(contact.dates.size());
+  for (const auto &date : contact.dates) {
+    number(date.date);
+    field(date.type);
+  }
+
+  sink.begin(ContactSection::Image);
+  field(contact.imageUrl);
+
+  sink.begin(ContactSection::Phones);
+  count(contact.phoneNumbers.size());
+  for (const auto &phone : contact.phoneNumbers) {
+    // Numbers are hashed by key so reformatting a number does not change the hash
+    PhoneKey key = phoneKeyFor(phone.value, defaultCountryCode);
+    if (key.valid()) {
+      count(1);
+      sink.hasher().updateUint64(key.bits());
+    } else {
+      count(0);
+      field(phone.value);
+    }
+    field(phone.type);
+  }
+
+  sink.begin(ContactSection::Emails);
+  count(contact.emailAddresses.size());
+  for (const auto &email : contact.emailAddresses) {
+    field(email.value);
+    field(email.type);
+  }
+
+  sink.begin(ContactSection::Addresses);
+  count(contact.addresses.size());
+  for (const auto &address : contact.addresses) {
+    field(address.street);
+    field(address.city);
+    field(address.state);
+    field(address.postalCode);
+    field(address.country);
+    field(address.type);
+  }
+
+  sink.begin(ContactSection::Urls);
+  count(contact.urlAddresses.size());
+  for (const auto &url : contact.urlAddresses) {
+    field(url.value);
+    field(url.type);
+  }
+
+  sink.begin(ContactSection::SocialProfiles);
+  count(contact.socialProfiles.size());
+  for (const auto &profile : contact.socialProfiles) {
+    field(profile.service);
+    field(profile.username);
+    field(profile.urlString);
+  }
+
+  sink.begin(ContactSection::Relations);
+  count(contact.relations.size());
+  for (const auto &relation : contact.relations) {
+    field(relation.name);
+    field(relation.type);
+  }
+
+  sink.begin(ContactSection::InstantMessages);
+  count(contact.instantMessageAddresses.size());
+  for (const auto &im : contact.instantMessageAddresses) {
+    field(im.service);
+    field(im.username);
+    field(im.type);
+  }
+
+  sink.begin(ContactSection::Interests);
+  count(contact.interests.size());
+  for (const auto &interest : contact.interests) {
+    field(interest);
+  }
+  sink.end();
+}
+
+// Every section into one hasher
+class WholeContactSink {
+public:
+  void begin(ContactSection) {}
+  void end() {}
+  StreamingHasher &hasher() { return hasher_; }
+
+private:
+  StreamingHasher hasher_;
+};
+
+// Every section the server stores into one hasher; the rest is dropped
+class ServerContactSink {
+public:
+  void begin(ContactSection section) {
+    skip_ = section == ContactSection::Image || section == ContactSection::Interests;
+  }
+  void end() {}
+  StreamingHasher &hasher() { return skip_ ? skipped_ : hasher_; }
+  Hash128 digest() { return hasher_.digest(); }
+
+private:
+  StreamingHasher hasher_;
+  StreamingHasher skipped_;
+  bool skip_ = false;
+};
+
+// One hasher per section, reset at each boundary
+class SectionSink {
+public:
+  explicit SectionSink(ContactDigest &digest) : digest_(digest) {}
+
+  void begin(ContactSection section) {
+    end();
+    section_ = static_cast<size_t>(section);
+    hasher_ = StreamingHasher(section_);
+    open_ = true;
+  }
+
+  void end() {
+    if (open_) {
+      digest_.sections[section_] = hasher_.digest().low;
+      open_ = false;
+    }
+  }
+
+  StreamingHasher &hasher() { return hasher_; }
+
+private:
+  ContactDigest &digest_;
+  StreamingHasher hasher_;
+  size_t section_ = 0;
+  bool open_ = false;
+};
+
+} // namespace
+
+uint64_t fnv1a64(std::string_view bytes, uint64_t seed) {
+  uint64_t hash = seed;
+  for (unsigned char c : bytes) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+Hash128 contactHash128(const Contact &contact, uint16_t defaultCountryCode) {
+  WholeContactSink sink;
+  feedContact(contact, defaultCountryCode, sink);
+  return sink.hasher().digest();
+}
+
+Hash128 serverContactHash128(const Contact &contact, uint16_t defaultCountryCode) {
+  ServerContactSink sink;
+  feedContact(contact, defaultCountryCode, sink);
+  return sink.digest();
+}
+
+ContactDigest contactDigest(const Contact &contact, uint16_t defaultCountryCode) {
+  ContactDigest digest;
+  SectionSink sink(digest);
+  feedContact(contact, defaultCountryCode, sink);
+  return digest;
+}
+
+uint32_t changedContactSections(const ContactDigest &before, const ContactDigest &after) {
+  uint32_t changed = 0;
+  for (size_t i = 0; i < kContactSectionCount; ++i) {
+    if (before.sections[i] != after.sections[i]) {
+      changed |= 1u << i;
+    }
+  }
+  return changed;
+}
+
+std::string generateContactHash(const Contact &contact) {
+  return formatHash128(contactHash128(contact));
+}
+
+} // namespace contactsmanager
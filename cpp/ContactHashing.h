@@ -0,0 +1,99 @@
+//
+//  ContactHashing.h
+//  ContactsManagerCore
+//
+//  Port of CMContact (Hashing). Every hashed field is streamed straight into a
+//  128-bit StreamingHasher (length-prefixed, lists count-prefixed), so hashing
+//  a contact builds no intermediate string and allocates nothing. Phone
+//  numbers enter the hash as their PhoneKey, completed with the default
+//  calling code, so formatting-only edits and "5551234567" versus
+//  "+1 555 123 4567" keep the hash stable. A per-section digest tells the sync layer which parts of a
+//  contact changed.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "PhoneNumberKey.h"
+#include "StreamingHash.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace contactsmanager {
+
+/**
+ * 64-bit FNV-1a over a byte range
+ */
+uint64_t fnv1a64(std::string_view bytes, uint64_t seed = 0xcbf29ce484222325ULL);
+
+/**
+ * Groups of contact fields with their own digest
+ */
+enum class ContactSection : uint8_t {
+  // identifier, contactType
+  Identity,
+  // displayName and the name components
+  Name,
+  // organizationName, departmentName, jobTitle
+  Organization,
+  // notes, bio, location
+  Notes,
+  // birthday and dates
+  Dates,
+  // imageUrl
+  Image,
+  Phones,
+  Emails,
+  Addresses,
+  Urls,
+  SocialProfiles,
+  Relations,
+  InstantMessages,
+  Interests,
+};
+
+constexpr size_t kContactSectionCount = static_cast<size_t>(ContactSection::Interests) + 1;
+
+constexpr uint32_t contactSectionBit(ContactSection section) {
+  return 1u << static_cast<uint32_t>(section);
+}
+
+/**
+ * 64-bit digest per section
+ */
+struct ContactDigest {
+  std::array<uint64_t, kContactSectionCount> sections{};
+
+  uint64_t section(ContactSection section) const { return sections[static_cast<size_t>(section)]; }
+};
+
+/**
+ * 128-bit digest of every hashed field; sync metadata (lastSyncedAt, dirtyTime, ...) is excluded
+ * @param defaultCountryCode Calling code for numbers stored without one; must match the one equality uses
+ */
+Hash128 contactHash128(const Contact &contact, uint16_t defaultCountryCode = defaultCallingCode());
+
+ContactDigest contactDigest(const Contact &contact, uint16_t defaultCountryCode = defaultCallingCode());
+
+/**
+ * contactHash128 without the Image and Interests sections, which the server
+ * contact does not carry; sync versions use it so they change only with what is uploaded
+ */
+Hash128 serverContactHash128(const Contact &contact, uint16_t defaultCountryCode = defaultCallingCode());
+
+/**
+ * Bitmask of contactSectionBit values for the sections that differ
+ */
+uint32_t changedContactSections(const ContactDigest &before, const ContactDigest &after);
+
+/**
+ * Generate a hash string representing the current state of the contact
+ * @return 32 lowercase hex characters of contactHash128
+ */
+std::string generateContactHash(const Contact &contact);
+
+} // namespace contactsmanager
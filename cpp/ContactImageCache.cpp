@@ -0,0 +1,168 @@
+//
+//  ContactImageCache.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactImageCache.h"
+
+#include "StreamingHash.h"
+
+namespace contactsmanager {
+
+std::optional<ImageSizeClass> imageSizeClassNamed(std::string_view name) {
+  if (name == "thumbnail") {
+    return ImageSizeClass::Thumbnail;
+  }
+  if (name == "full") {
+    return ImageSizeClass::Full;
+  }
+  return std::nullopt;
+}
+
+ContactImageCache::ContactImageCache(size_t byteBudget, size_t maxContactReferences)
+    : byteBudget_(byteBudget), maxContactReferences_(maxContactReferences) {}
+
+ContactImageCache &ContactImageCache::sharedInstance() {
+  static ContactImageCache cache;
+  return cache;
+}
+
+std::string ContactImageCache::imageIdForContent(ImageBytesView full, ImageBytesView thumbnail) {
+  ImageBytesView addressed = full.empty() ? thumbnail : full;
+  if (addressed.empty()) {
+    return std::string();
+  }
+  // Stripe-wise rather than byte-wise, since photos run to megabytes; the length is part of the digest
+  std::string_view bytes(reinterpret_cast<const char *>(addressed.data), addressed.size);
+  return "img-" + formatHash128(hash128(bytes));
+}
+
+std::string ContactImageCache::registerContactImages(std::string_view contactId, ImageBytesView full,
+                                                     ImageBytesView thumbnail, bool cacheFull) {
+  std::string imageId = imageIdForContent(full, thumbnail);
+  if (imageId.empty()) {
+    return imageId;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  rememberContactLocked(imageId, contactId);
+  if (!thumbnail.empty()) {
+    storeLocked(imageId, ImageSizeClass::Thumbnail, thumbnail);
+  }
+  if (cacheFull && !full.empty()) {
+    storeLocked(imageId, ImageSizeClass::Full, full);
+  }
+  evictLocked();
+  return imageId;
+}
+
+void ContactImageCache::store(std::string_view imageId, ImageSizeClass sizeClass, ImageBytesView bytes) {
+  if (imageId.empty() || bytes.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  storeLocked(imageId, sizeClass, bytes);
+}
+
+std::shared_ptr<const std::vector<uint8_t>> ContactImageCache::lookup(std::string_view imageId,
+                                                                      ImageSizeClass sizeClass) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(entryKey(imageId, sizeClass));
+  if (it == entries_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  lru_.splice(lru_.begin(), lru_, it->second.lruPosition);
+  auto reference = contactIds_.find(std::string(imageId));
+  if (reference != contactIds_.end()) {
+    referenceLru_.splice(referenceLru_.begin(), referenceLru_, reference->second.lruPosition);
+  }
+  return it->second.bytes;
+}
+
+std::optional<std::string> ContactImageCache::contactIdForImage(std::string_view imageId) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = contactIds_.find(std::string(imageId));
+  if (it == contactIds_.end()) {
+    return std::nullopt;
+  }
+  return it->second.contactId;
+}
+
+ImageCacheStats ContactImageCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ImageCacheStats stats;
+  stats.entries = entries_.size();
+  stats.bytes = bytes_;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  stats.contactReferences = contactIds_.size();
+  return stats;
+}
+
+void ContactImageCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  lru_.clear();
+  contactIds_.clear();
+  referenceLru_.clear();
+  bytes_ = 0;
+}
+
+std::string ContactImageCache::entryKey(std::string_view imageId, ImageSizeClass sizeClass) {
+  std::string key(imageId);
+  key.push_back(sizeClass == ImageSizeClass::Thumbnail ? 't' : 'f');
+  return key;
+}
+
+void ContactImageCache::storeLocked(std::string_view imageId, ImageSizeClass sizeClass, ImageBytesView bytes) {
+  std::string key = entryKey(imageId, sizeClass);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    // Content addressed: same ID means same bytes, only refresh recency
+    lru_.splice(lru_.begin(), lru_, it->second.lruPosition);
+    return;
+  }
+  if (bytes.size > byteBudget_) {
+    return;
+  }
+
+  lru_.push_front(key);
+  Entry entry;
+  entry.bytes = std::make_shared<const std::vector<uint8_t>>(bytes.data, bytes.data + bytes.size);
+  entry.lruPosition = lru_.begin();
+  entries_.emplace(std::move(key), std::move(entry));
+  bytes_ += bytes.size;
+  evictLocked();
+}
+
+void ContactImageCache::rememberContactLocked(const std::string &imageId, std::string_view contactId) {
+  auto it = contactIds_.find(imageId);
+  if (it != contactIds_.end()) {
+    it->second.contactId = std::string(contactId);
+    referenceLru_.splice(referenceLru_.begin(), referenceLru_, it->second.lruPosition);
+    return;
+  }
+  referenceLru_.push_front(imageId);
+  contactIds_.emplace(imageId, ContactReference{std::string(contactId), referenceLru_.begin()});
+}
+
+void ContactImageCache::evictLocked() {
+  while (bytes_ > byteBudget_ && !lru_.empty()) {
+    auto it = entries_.find(lru_.back());
+    bytes_ -= it->second.bytes->size();
+    entries_.erase(it);
+    lru_.pop_back();
+    evictions_++;
+  }
+  // References are small and outlive the bytes, but every image ID ever
+  // handed out must not keep one
+  while (contactIds_.size() > maxContactReferences_ && !referenceLru_.empty()) {
+    contactIds_.erase(referenceLru_.back());
+    referenceLru_.pop_back();
+  }
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,131 @@
+//
+//  ContactImageCache.h
+//  ContactsManagerCore
+//
+//  Content-addressed, byte-bounded cache for contact photos. Contacts carry an
+//  opaque image ID derived from the photo bytes instead of inline base64; JS asks
+//  for the bytes of one size class when it actually renders the image.
+//  Contacts sharing the same photo share one entry.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+enum class ImageSizeClass : uint8_t {
+  Thumbnail,
+  Full,
+};
+
+/**
+ * Parses "thumbnail" / "full"
+ */
+std::optional<ImageSizeClass> imageSizeClassNamed(std::string_view name);
+
+struct ImageBytesView {
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+
+  bool empty() const { return size == 0; }
+};
+
+struct ImageCacheStats {
+  size_t entries = 0;
+  size_t bytes = 0;
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t evictions = 0;
+  // Image IDs whose owning contact is remembered for reloads
+  size_t contactReferences = 0;
+};
+
+class ContactImageCache {
+public:
+  static constexpr size_t kDefaultByteBudget = 32 * 1024 * 1024;
+  static constexpr size_t kDefaultMaxContactReferences = 20000;
+
+  /**
+   * @param maxContactReferences Most image IDs whose owning contact is
+   *   remembered; the least recently used are forgotten first
+   */
+  explicit ContactImageCache(size_t byteBudget = kDefaultByteBudget,
+                             size_t maxContactReferences = kDefaultMaxContactReferences);
+
+  static ContactImageCache &sharedInstance();
+
+  /**
+   * Opaque ID for the given photo; the full image is addressed when present,
+   * otherwise the thumbnail. Returns an empty string when both are empty.
+   */
+  static std::string imageIdForContent(ImageBytesView full, ImageBytesView thumbnail);
+
+  /**
+   * Registers a contact's photo and returns its image ID. The thumbnail is cached
+   * eagerly; the full image only when cacheFull is set, since it can always be
+   * reloaded through the contact ID.
+   */
+  std::string registerContactImages(std::string_view contactId, ImageBytesView full, ImageBytesView thumbnail,
+                                    bool cacheFull);
+
+  /**
+   * Caches the bytes of one size class for an image ID (e.g. after a reload)
+   */
+  void store(std::string_view imageId, ImageSizeClass sizeClass, ImageBytesView bytes);
+
+  /**
+   * Cached bytes, or nullptr when the entry was never stored or has been evicted
+   */
+  std::shared_ptr<const std::vector<uint8_t>> lookup(std::string_view imageId, ImageSizeClass sizeClass);
+
+  /**
+   * Contact that last registered the image, used to reload evicted bytes;
+   * nullopt once the reference itself has been evicted
+   */
+  std::optional<std::string> contactIdForImage(std::string_view imageId) const;
+
+  ImageCacheStats stats() const;
+  void clear();
+
+private:
+  struct Entry {
+    std::shared_ptr<const std::vector<uint8_t>> bytes;
+    std::list<std::string>::iterator lruPosition;
+  };
+
+  struct ContactReference {
+    std::string contactId;
+    std::list<std::string>::iterator lruPosition;
+  };
+
+  static std::string entryKey(std::string_view imageId, ImageSizeClass sizeClass);
+  void storeLocked(std::string_view imageId, ImageSizeClass sizeClass, ImageBytesView bytes);
+  void rememberContactLocked(const std::string &imageId, std::string_view contactId);
+  void evictLocked();
+
+  mutable std::mutex mutex_;
+  size_t byteBudget_;
+  size_t maxContactReferences_;
+  size_t bytes_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+  size_t evictions_ = 0;
+  // Most recently used at the front
+  std::list<std::string> lru_;
+  std::unordered_map<std::string, Entry> entries_;
+  // Image IDs by recency of registration or lookup, most recent at the front
+  std::list<std::string> referenceLru_;
+  std::unordered_map<std::string, ContactReference> contactIds_;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,706 @@
+//
+//  ContactSearchIndex.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactSearchIndex.h"
+
+#include "BinaryFile.h"
+#include "ContactHashing.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'C', 'M', 'S', 'I'};
+constexpr uint32_t kFileVersion = 2;
+// Longer runs are truncated; nobody types a 64 character prefix
+constexpr size_t kMaxTokenLength = 64;
+// National number length used to index phones without their country code
+constexpr size_t kNationalNumberDigits = 10;
+// Initials are stored as ordinary terms behind a byte no word can contain
+constexpr char kInitialsMarker = '\x01';
+constexpr size_t kMaxInitials = 4;
+
+// Match quality by kind; multiplied by the weight of the field that matched
+constexpr double kExactQuality = 1.0;
+constexpr double kPrefixQuality = 0.8;
+constexpr double kInitialsQuality = 0.7;
+constexpr double kOneEditQuality = 0.6;
+constexpr double kTwoEditQuality = 0.45;
+
+bool isTokenByte(char c) {
+  return text::isAsciiAlnum(c) || static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool isPhoneQueryByte(char c) {
+  return text::isAsciiDigit(c) || c == '+' || c == '-' || c == '(' || c == ')' || c == '.' || text::isAsciiSpace(c);
+}
+
+template <typename Visit>
+void forEachWord(std::string_view value, Visit &&visit) {
+  size_t i = 0;
+  while (i < value.size()) {
+    while (i < value.size() && !isTokenByte(value[i])) {
+      ++i;
+    }
+    size_t start = i;
+    while (i < value.size() && isTokenByte(value[i])) {
+      ++i;
+    }
+    if (i > start) {
+      std::string word;
+      text::appendFolded(word, value.substr(start, std::min(i - start, kMaxTokenLength)));
+      visit(std::move(word));
+    }
+  }
+}
+
+void addWords(std::vector<SearchToken> &tokens, std::string_view value, uint32_t field) {
+  forEachWord(value, [&](std::string word) { tokens.push_back({std::move(word), field}); });
+}
+
+std::string phoneDigits(std::string_view value) {
+  std::string digits;
+  for (char c : value) {
+    if (text::isAsciiDigit(c)) {
+      digits.push_back(c);
+    }
+  }
+  return digits;
+}
+
+void addPhone(std::vector<SearchToken> &tokens, std::string_view value) {
+  std::string digits = phoneDigits(value);
+  if (digits.empty()) {
+    return;
+  }
+  if (digits.size() > kNationalNumberDigits) {
+    tokens.push_back({digits.substr(digits.size() - kNationalNumberDigits), SearchField::Phone});
+  }
+  tokens.push_back({std::move(digits), SearchField::Phone});
+}
+
+void addInitials(std::vector<SearchToken> &tokens, const std::vector<const std::string *> &components) {
+  std::string initials(1, kInitialsMarker);
+  for (const std::string *component : components) {
+    forEachWord(*component, [&](std::string word) {
+      if (initials.size() <= kMaxInitials && text::isAsciiAlnum(word[0])) {
+        initials.push_back(word[0]);
+      }
+    });
+  }
+  if (initials.size() >= 3) {
+    tokens.push_back({std::move(initials), SearchField::Name});
+  }
+}
+
+double fieldWeight(uint32_t fields) {
+  if (fields & SearchField::Name) {
+    return 1.0;
+  }
+  if (fields & SearchField::Phone) {
+    return 0.9;
+  }
+  if (fields & SearchField::Organization) {
+    return 0.8;
+  }
+  if (fields & SearchField::Email) {
+    return 0.7;
+  }
+  if (fields & SearchField::Address) {
+    return 0.5;
+  }
+  return 0.4;
+}
+
+uint64_t documentFingerprint(const std::string &sortKey, const std::vector<SearchToken> &tokens) {
+  uint64_t hash = fnv1a64(sortKey);
+  for (const auto &token : tokens) {
+    hash = fnv1a64(token.text, hash ^ 0xff);
+    char fields[sizeof(uint32_t)];
+    std::memcpy(fields, &token.fields, sizeof(fields));
+    hash = fnv1a64(std::string_view(fields, sizeof(fields)), hash);
+  }
+  return hash;
+}
+
+} // namespace
+
+std::vector<SearchToken> searchTokensForContact(const Contact &contact) {
+  std::vector<SearchToken> tokens;
+  addWords(tokens, contact.namePrefix, SearchField::Name);
+  addWords(tokens, contact.givenName, SearchField::Name);
+  addWords(tokens, contact.middleName, SearchField::Name);
+  addWords(tokens, contact.familyName, SearchField::Name);
+  addWords(tokens, contact.previousFamilyName, SearchField::Name);
+  addWords(tokens, contact.nameSuffix, SearchField::Name);
+  addWords(tokens, contact.nickname, SearchField::Name);
+  addWords(tokens, contact.displayName, SearchField::Name);
+  // "jd" for John Doe; with a middle name both "jd" and "jad" find John A. Doe
+  addInitials(tokens, {&contact.givenName, &contact.familyName});
+  if (!contact.middleName.empty()) {
+    addInitials(tokens, {&contact.givenName, &contact.middleName, &contact.familyName});
+  }
+  for (const auto &email : contact.emailAddresses) {
+    addWords(tokens, email.value, SearchField::Email);
+  }
+  for (const auto &phone : contact.phoneNumbers) {
+    addPhone(tokens, phone.value);
+  }
+  for (const auto &address : contact.addresses) {
+    addWords(tokens, address.street, SearchField::Address);
+    addWords(tokens, address.city, SearchField::Address);
+    addWords(tokens, address.state, SearchField::Address);
+    addWords(tokens, address.postalCode, SearchField::Address);
+    addWords(tokens, address.country, SearchField::Address);
+  }
+  addWords(tokens, contact.organizationName, SearchField::Organization);
+  addWords(tokens, contact.departmentName, SearchField::Organization);
+  addWords(tokens, contact.jobTitle, SearchField::Organization);
+  addWords(tokens, contact.notes, SearchField::Notes);
+
+  std::sort(tokens.begin(), tokens.end(),
+            [](const SearchToken &a, const SearchToken &b) { return a.text < b.text; });
+  size_t out = 0;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (out > 0 && tokens[out - 1].text == tokens[i].text) {
+      tokens[out - 1].fields |= tokens[i].fields;
+    } else {
+      if (out != i) {
+        tokens[out] = std::move(tokens[i]);
+      }
+      ++out;
+    }
+  }
+  tokens.resize(out);
+  return tokens;
+}
+
+size_t maxSearchEdits(size_t tokenLength) {
+  if (tokenLength < 3) {
+    return 0;
+  }
+  return tokenLength <= 5 ? 1 : 2;
+}
+
+std::vector<std::string> searchQueryTokens(std::string_view query) {
+  std::vector<std::string> tokens;
+  std::string_view trimmedQuery = text::trimmed(query);
+  if (trimmedQuery.empty()) {
+    return tokens;
+  }
+
+  if (std::all_of(trimmedQuery.begin(), trimmedQuery.end(), isPhoneQueryByte)) {
+    std::string digits = phoneDigits(trimmedQuery);
+    if (!digits.empty()) {
+      tokens.push_back(std::move(digits));
+      return tokens;
+    }
+  }
+
+  forEachWord(trimmedQuery, [&](std::string word) {
+    if (std::find(tokens.begin(), tokens.end(), word) == tokens.end()) {
+      tokens.push_back(std::move(word));
+    }
+  });
+  return tokens;
+}
+
+ContactSearchIndex &ContactSearchIndex::sharedInstance() {
+  static ContactSearchIndex index;
+  return index;
+}
+
+bool ContactSearchIndex::upsert(const Contact &contact) {
+  if (contact.identifier.empty()) {
+    return false;
+  }
+  if (contact.isDeleted) {
+    return remove(contact.identifier);
+  }
+
+  Document document;
+  document.identifier = contact.identifier;
+  document.sortKey = text::lowercased(contact.displayInfo());
+  document.tokens = searchTokensForContact(contact);
+  document.fingerprint = documentFingerprint(document.sortKey, document.tokens);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = slotsById_.find(contact.identifier);
+  if (it != slotsById_.end()) {
+    if (documents_[it->second].fingerprint == document.fingerprint) {
+      return false;
+    }
+    removeSlotLocked(it->second);
+  }
+  insertLocked(std::move(document));
+  return true;
+}
+
+bool ContactSearchIndex::remove(std::string_view identifier) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = slotsById_.find(std::string(identifier));
+  if (it == slotsById_.end()) {
+    return false;
+  }
+  removeSlotLocked(it->second);
+  return true;
+}
+
+size_t ContactSearchIndex::syncWith(const std::vector<Contact> &contacts) {
+  size_t changes = 0;
+  std::unordered_map<std::string, bool> present;
+  present.reserve(contacts.size());
+  for (const auto &contact : contacts) {
+    if (upsert(contact)) {
+      changes++;
+    }
+    if (!contact.isDeleted) {
+      present.emplace(contact.identifier, true);
+    }
+  }
+
+  std::vector<std::string> stale;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &entry : slotsById_) {
+      if (present.find(entry.first) == present.end()) {
+        stale.push_back(entry.first);
+      }
+    }
+  }
+  for (const auto &identifier : stale) {
+    if (remove(identifier)) {
+      changes++;
+    }
+  }
+  return changes;
+}
+
+SearchResults ContactSearchIndex::search(std::string_view query, uint32_t fields, size_t offset,
+                                         size_t limit) const {
+  std::vector<std::string> queryTokens = searchQueryTokens(query);
+  std::lock_guard<std::mutex> lock(mutex_);
+  return searchLocked(queryTokens, fields, offset, limit);
+}
+
+std::vector<std::string> ContactSearchIndex::quickSearch(std::string_view query, size_t limit) const {
+  return search(query, SearchField::All, 0, limit).identifiers;
+}
+
+size_t ContactSearchIndex::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return slotsById_.size();
+}
+
+size_t ContactSearchIndex::termCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return terms_.size();
+}
+
+void ContactSearchIndex::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  clearLocked();
+}
+
+// File layout (native byte order, the index never leaves the device):
+//   "CMSI" version termCount documentCount
+//   termCount x term text, in sorted order
+//   documentCount x identifier sortKey fingerprint tokenCount (termOrdinal fields)*
+// Postings are rebuilt from the documents on load; terms are already sorted so
+// the term map is filled by appending.
+bool ContactSearchIndex::save(const std::string &path) const {
+  std::string out;
+  out.append(kFileMagic, sizeof(kFileMagic));
+  binary::writeUint32(out, kFileVersion);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_map<std::string_view, uint32_t> ordinals;
+    ordinals.reserve(terms_.size());
+    binary::writeUint32(out, static_cast<uint32_t>(terms_.size()));
+    binary::writeUint32(out, static_cast<uint32_t>(slotsById_.size()));
+    for (const auto &term : terms_) {
+      ordinals.emplace(term.first, static_cast<uint32_t>(ordinals.size()));
+      binary::writeString(out, term.first);
+    }
+    for (const auto &document : documents_) {
+      if (!document.live) {
+        continue;
+      }
+      binary::writeString(out, document.identifier);
+      binary::writeString(out, document.sortKey);
+      binary::writeUint64(out, document.fingerprint);
+      binary::writeUint32(out, static_cast<uint32_t>(document.tokens.size()));
+      for (const auto &token : document.tokens) {
+        binary::writeUint32(out, ordinals.at(token.text));
+        binary::writeUint32(out, token.fields);
+      }
+    }
+  }
+
+  return binary::writeFileAtomically(path, out);
+}
+
+bool ContactSearchIndex::load(const std::string &path) {
+  std::string data;
+  bool read = binary::readFile(path, data);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  clearLocked();
+  binary::Reader reader(data);
+  if (!read || !reader.expect(std::string_view(kFileMagic, sizeof(kFileMagic)))) {
+    return false;
+  }
+
+  uint32_t version = 0;
+  uint32_t termCount = 0;
+  uint32_t documentCount = 0;
+  if (!reader.readUint32(version) || version != kFileVersion || !reader.readUint32(termCount) ||
+      !reader.readUint32(documentCount)) {
+    return false;
+  }
+
+  std::vector<std::string> texts(termCount);
+  for (uint32_t t = 0; t < termCount; ++t) {
+    if (!reader.readString(texts[t]) || (t > 0 && !(texts[t - 1] < texts[t]))) {
+      return false;
+    }
+  }
+
+  std::vector<std::vector<Posting>> postings(termCount);
+  for (uint32_t slot = 0; slot < documentCount; ++slot) {
+    Document document;
+    uint32_t tokenCount = 0;
+    if (!reader.readString(document.identifier) || !reader.readString(document.sortKey) ||
+        !reader.readUint64(document.fingerprint) || !reader.readUint32(tokenCount) ||
+        slotsById_.count(document.identifier) != 0) {
+      clearLocked();
+      return false;
+    }
+    document.tokens.reserve(tokenCount);
+    for (uint32_t t = 0; t < tokenCount; ++t) {
+      uint32_t ordinal = 0;
+      uint32_t fields = 0;
+      if (!reader.readUint32(ordinal) || !reader.readUint32(fields) || ordinal >= termCount) {
+        clearLocked();
+        return false;
+      }
+      document.tokens.push_back(SearchToken{texts[ordinal], fields});
+      postings[ordinal].push_back(Posting{slot, fields});
+    }
+    document.live = true;
+    slotsById_.emplace(document.identifier, slot);
+    documents_.push_back(std::move(document));
+  }
+  if (!reader.atEnd()) {
+    clearLocked();
+    return false;
+  }
+
+  for (uint32_t t = 0; t < termCount; ++t) {
+    if (!postings[t].empty()) {
+      terms_.emplace_hint(terms_.end(), std::move(texts[t]), std::move(postings[t]));
+    }
+  }
+  ranksDirty_ = true;
+  return true;
+}
+
+SearchResults ContactSearchIndex::searchLocked(const std::vector<std::string> &queryTokens, uint32_t fields,
+                                               size_t offset, size_t limit) const {
+  ensureRanksLocked();
+  SearchResults results;
+
+  if (queryTokens.empty()) {
+    results.totalCount = order_.size();
+    for (size_t i = offset; i < order_.size() && i - offset < limit; ++i) {
+      results.identifiers.push_back(documents_[order_[i]].identifier);
+      results.scores.push_back(0);
+    }
+    return results;
+  }
+
+  // A contact stays a candidate while it matches every token seen so far; its
+  // score is the sum of its best match per token
+  tokenScores_.resize(documents_.size(), 0);
+  totalScores_.resize(documents_.size(), 0);
+  std::vector<uint32_t> candidates;
+  for (size_t i = 0; i < queryTokens.size(); ++i) {
+    std::vector<uint32_t> touched;
+    scoreTokenLocked(queryTokens[i], fields, touched);
+    if (i == 0) {
+      candidates = touched;
+      for (uint32_t slot : candidates) {
+        totalScores_[slot] = tokenScores_[slot];
+      }
+    } else {
+      size_t kept = 0;
+      for (uint32_t slot : candidates) {
+        if (tokenScores_[slot] > 0) {
+          totalScores_[slot] += tokenScores_[slot];
+          candidates[kept++] = slot;
+        } else {
+          totalScores_[slot] = 0;
+        }
+      }
+      candidates.resize(kept);
+    }
+    for (uint32_t slot : touched) {
+      tokenScores_[slot] = 0;
+    }
+  }
+
+  results.totalCount = candidates.size();
+  if (offset < candidates.size() && limit > 0) {
+    size_t end = offset + std::min(limit, candidates.size() - offset);
+    auto byScore = [this](uint32_t a, uint32_t b) {
+      if (totalScores_[a] != totalScores_[b]) {
+        return totalScores_[a] > totalScores_[b];
+      }
+      return ranks_[a] < ranks_[b];
+    };
+    std::partial_sort(candidates.begin(), candidates.begin() + end, candidates.end(), byScore);
+    results.identifiers.reserve(end - offset);
+    results.scores.reserve(end - offset);
+    for (size_t i = offset; i < end; ++i) {
+      results.identifiers.push_back(documents_[candidates[i]].identifier);
+      results.scores.push_back(totalScores_[candidates[i]]);
+    }
+  }
+  for (uint32_t slot : candidates) {
+    totalScores_[slot] = 0;
+  }
+  return results;
+}
+
+void ContactSearchIndex::scoreTokenLocked(const std::string &token, uint32_t fields,
+                                          std::vector<uint32_t> &touched) const {
+  size_t maxEdits = text::isAsciiDigit(token[0]) ? 0 : maxSearchEdits(token.size());
+  if (maxEdits == 0) {
+    for (auto it = terms_.lower_bound(token); it != terms_.end() && it->first.compare(0, token.size(), token) == 0;
+         ++it) {
+      scorePostingsLocked(it->second, it->first.size() == token.size() ? kExactQuality : kPrefixQuality, fields,
+                          touched);
+    }
+  } else {
+    scoreFuzzyTermsLocked(token, maxEdits, fields, touched);
+  }
+
+  if (token.size() >= 2 && token.size() <= kMaxInitials &&
+      std::all_of(token.begin(), token.end(), [](char c) { return text::isAsciiAlpha(c); })) {
+    std::string initials = kInitialsMarker + token;
+    for (auto it = terms_.lower_bound(initials);
+         it != terms_.end() && it->first.compare(0, initials.size(), initials) == 0; ++it) {
+      scorePostingsLocked(it->second, kInitialsQuality, fields, touched);
+    }
+  }
+}
+
+void ContactSearchIndex::scorePostingsLocked(const std::vector<Posting> &postings, double quality, uint32_t fields,
+                                             std::vector<uint32_t> &touched) const {
+  for (const Posting &posting : postings) {
+    uint32_t matched = posting.fields & fields;
+    if (matched == 0) {
+      continue;
+    }
+    double score = quality * fieldWeight(matched);
+    double &best = tokenScores_[posting.slot];
+    if (best == 0) {
+      touched.push_back(posting.slot);
+    }
+    best = std::max(best, score);
+  }
+}
+
+// Walks the terms that share the token's first letter as if they formed a
+// trie: rows of the (optimal string alignment) edit distance matrix are kept
+// per depth and reused across terms with a common prefix, and a whole subtree
+// is skipped once no extension can come back within maxEdits. A term matches
+// when any of its prefixes is within maxEdits of the token, since the last
+// token is usually still being typed.
+void ContactSearchIndex::scoreFuzzyTermsLocked(const std::string &token, size_t maxEdits, uint32_t fields,
+                                               std::vector<uint32_t> &touched) const {
+  const size_t columns = token.size() + 1;
+  const int limit = static_cast<int>(maxEdits);
+  // rows[d] is the matrix row after d term characters; best[d] the smallest
+  // full-token distance over depths 0..d; rowMin[d] the row's minimum
+  std::vector<int> rows((kMaxTokenLength + 1) * columns);
+  std::vector<int> best(kMaxTokenLength + 1);
+  std::vector<int> rowMin(kMaxTokenLength + 1);
+  for (size_t j = 0; j < columns; ++j) {
+    rows[j] = static_cast<int>(j);
+  }
+  best[0] = static_cast<int>(token.size());
+  rowMin[0] = 0;
+
+  const std::string first(1, token[0]);
+  std::string_view previous;
+  auto it = terms_.lower_bound(first);
+  while (it != terms_.end() && it->first[0] == token[0]) {
+    const std::string &term = it->first;
+    size_t depth = std::min(term.size(), kMaxTokenLength);
+    size_t shared = 0;
+    while (shared < previous.size() && shared < depth && previous[shared] == term[shared]) {
+      ++shared;
+    }
+    previous = term;
+
+    size_t pruneAt = 0;
+    for (size_t d = shared + 1; d <= depth; ++d) {
+      int *row = &rows[d * columns];
+      const int *above = &rows[(d - 1) * columns];
+      const int *twoAbove = d >= 2 ? &rows[(d - 2) * columns] : nullptr;
+      char c = term[d - 1];
+      row[0] = static_cast<int>(d);
+      int minimum = row[0];
+      for (size_t j = 1; j < columns; ++j) {
+        int cost = token[j - 1] == c ? 0 : 1;
+        int value = std::min({above[j] + 1, row[j - 1] + 1, above[j - 1] + cost});
+        if (twoAbove && j >= 2 && token[j - 1] == term[d - 2] && token[j - 2] == c) {
+          value = std::min(value, twoAbove[j - 2] + 1);
+        }
+        row[j] = value;
+        minimum = std::min(minimum, value);
+      }
+      rowMin[d] = minimum;
+      best[d] = std::min(best[d - 1], row[columns - 1]);
+      if (best[d] > limit && minimum > limit && rowMin[d - 1] >= limit) {
+        pruneAt = d;
+        break;
+      }
+    }
+
+    if (pruneAt > 0) {
+      // Nothing below this prefix can match: jump past every term that starts with it
+      std::string next = term.substr(0, pruneAt);
+      while (!next.empty() && static_cast<unsigned char>(next.back()) == 0xFF) {
+        next.pop_back();
+      }
+      if (next.empty()) {
+        break;
+      }
+      next.back() = static_cast<char>(next.back() + 1);
+      previous = std::string_view();
+      it = terms_.lower_bound(next);
+      continue;
+    }
+
+    int distance = best[depth];
+    if (distance <= limit) {
+      double quality;
+      if (distance == 0) {
+        quality = term.size() == token.size() ? kExactQuality : kPrefixQuality;
+      } else {
+        quality = distance == 1 ? kOneEditQuality : kTwoEditQuality;
+      }
+      scorePostingsLocked(it->second, quality, fields, touched);
+    }
+    ++it;
+  }
+}
+
+uint32_t ContactSearchIndex::allocateSlotLocked() {
+  if (!freeSlots_.empty()) {
+    uint32_t slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    return slot;
+  }
+  documents_.emplace_back();
+  return static_cast<uint32_t>(documents_.size() - 1);
+}
+
+void ContactSearchIndex::insertLocked(Document document) {
+  uint32_t slot = allocateSlotLocked();
+  document.live = true;
+  slotsById_[document.identifier] = slot;
+  documents_[slot] = std::move(document);
+  addPostingsLocked(slot);
+  ranksDirty_ = true;
+}
+
+void ContactSearchIndex::removeSlotLocked(uint32_t slot) {
+  removePostingsLocked(slot);
+  slotsById_.erase(documents_[slot].identifier);
+  documents_[slot] = Document();
+  freeSlots_.push_back(slot);
+  ranksDirty_ = true;
+}
+
+void ContactSearchIndex::addPostingsLocked(uint32_t slot) {
+  for (const auto &token : documents_[slot].tokens) {
+    auto it = terms_.find(token.text);
+    if (it == terms_.end()) {
+      it = terms_.emplace(token.text, std::vector<Posting>()).first;
+    }
+    // Postings stay sorted by slot so removal is a binary search
+    auto &postings = it->second;
+    auto position = std::lower_bound(postings.begin(), postings.end(), slot,
+                                     [](const Posting &posting, uint32_t value) { return posting.slot < value; });
+    postings.insert(position, Posting{slot, token.fields});
+  }
+}
+
+void ContactSearchIndex::removePostingsLocked(uint32_t slot) {
+  for (const auto &token : documents_[slot].tokens) {
+    auto it = terms_.find(token.text);
+    if (it == terms_.end()) {
+      continue;
+    }
+    auto &postings = it->second;
+    auto position = std::lower_bound(postings.begin(), postings.end(), slot,
+                                     [](const Posting &posting, uint32_t value) { return posting.slot < value; });
+    if (position != postings.end() && position->slot == slot) {
+      postings.erase(position);
+    }
+    if (postings.empty()) {
+      terms_.erase(it);
+    }
+  }
+}
+
+void ContactSearchIndex::ensureRanksLocked() const {
+  if (!ranksDirty_ && ranks_.size() == documents_.size()) {
+    return;
+  }
+  std::vector<uint32_t> order;
+  order.reserve(slotsById_.size());
+  for (uint32_t slot = 0; slot < documents_.size(); ++slot) {
+    if (documents_[slot].live) {
+      order.push_back(slot);
+    }
+  }
+  std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+    const Document &left = documents_[a];
+    const Document &right = documents_[b];
+    if (left.sortKey != right.sortKey) {
+      return left.sortKey < right.sortKey;
+    }
+    return left.identifier < right.identifier;
+  });
+  ranks_.assign(documents_.size(), 0);
+  for (uint32_t rank = 0; rank < order.size(); ++rank) {
+    ranks_[order[rank]] = rank;
+  }
+  order_ = std::move(order);
+  ranksDirty_ = false;
+}
+
+void ContactSearchIndex::clearLocked() {
+  documents_.clear();
+  freeSlots_.clear();
+  slotsById_.clear();
+  terms_.clear();
+  ranks_.clear();
+  order_.clear();
+  tokenScores_.clear();
+  totalScores_.clear();
+  ranksDirty_ = false;
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,181 @@
+//
+//  ContactSearchIndex.h
+//  ContactsManagerCore
+//
+//  Inverted prefix index over the searchable fields of the address book. Every
+//  field is split into lowercase tokens tagged with the CMSearchFieldType bit
+//  they came from; phone numbers are indexed as digit strings and Latin
+//  diacritics are folded to ASCII. Every query token must match for a contact
+//  to be returned; a token matches an indexed token it is a prefix of, a name's
+//  initials ("jd" -> John Doe), or, from three letters on, a token within a
+//  small edit distance (typos and transpositions). Results are ranked by match
+//  quality and then display name.
+//
+//  The index is updated per contact (unchanged contacts are skipped by
+//  fingerprint) and persisted to a single file, so a cold start loads it
+//  instead of rescanning the store.
+//
+
+#pragma once
+
+#include "Contact.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+/**
+ * Searchable field bits (mirrors CMSearchFieldType)
+ */
+namespace SearchField {
+constexpr uint32_t Name = 1u << 0;
+constexpr uint32_t Email = 1u << 1;
+constexpr uint32_t Phone = 1u << 2;
+constexpr uint32_t Address = 1u << 3;
+constexpr uint32_t Organization = 1u << 4;
+constexpr uint32_t Notes = 1u << 5;
+constexpr uint32_t All = 0xFFFFFFFFu;
+} // namespace SearchField
+
+/**
+ * One indexed token and the fields it occurs in
+ */
+struct SearchToken {
+  std::string text;
+  uint32_t fields = 0;
+};
+
+/**
+ * Tokens the index stores for a contact, merged and sorted by text
+ */
+std::vector<SearchToken> searchTokensForContact(const Contact &contact);
+
+/**
+ * Splits a query into lowercase tokens the same way contacts are tokenized.
+ * A query made only of digits and phone punctuation becomes one digit token.
+ */
+std::vector<std::string> searchQueryTokens(std::string_view query);
+
+/**
+ * Edits tolerated for a query token of the given length: none below three
+ * letters, one up to five, two beyond
+ */
+size_t maxSearchEdits(size_t tokenLength);
+
+struct SearchResults {
+  std::vector<std::string> identifiers;
+  // Match quality per identifier, higher is better
+  std::vector<double> scores;
+  size_t totalCount = 0;
+};
+
+class ContactSearchIndex {
+public:
+  static constexpr size_t kQuickSearchLimit = 50;
+
+  ContactSearchIndex() = default;
+
+  ContactSearchIndex(const ContactSearchIndex &) = delete;
+  ContactSearchIndex &operator=(const ContactSearchIndex &) = delete;
+
+  static ContactSearchIndex &sharedInstance();
+
+  /**
+   * Indexes or reindexes a contact; deleted contacts are removed
+   * @return true if the index changed
+   */
+  bool upsert(const Contact &contact);
+
+  /**
+   * @return true if the contact was indexed
+   */
+  bool remove(std::string_view identifier);
+
+  /**
+   * Makes the index match the given contacts: upserts each one and removes
+   * every indexed contact that is not in the list
+   * @return number of contacts added, changed or removed
+   */
+  size_t syncWith(const std::vector<Contact> &contacts);
+
+  /**
+   * One page of the ranked matches; an empty query lists every contact in
+   * display name order
+   * @param fields Bitmask of SearchField values to match against
+   */
+  SearchResults search(std::string_view query, uint32_t fields, size_t offset, size_t limit) const;
+
+  /**
+   * Top kQuickSearchLimit matches across all fields, for search-as-you-type
+   */
+  std::vector<std::string> quickSearch(std::string_view query, size_t limit = kQuickSearchLimit) const;
+
+  size_t size() const;
+  size_t termCount() const;
+  void clear();
+
+  /**
+   * Writes the index to path atomically (temporary file + rename)
+   */
+  bool save(const std::string &path) const;
+
+  /**
+   * Replaces the contents with the index stored at path; on any error the
+   * index is left empty and false is returned
+   */
+  bool load(const std::string &path);
+
+private:
+  struct Posting {
+    uint32_t slot;
+    uint32_t fields;
+  };
+
+  struct Document {
+    std::string identifier;
+    std::string sortKey;
+    uint64_t fingerprint = 0;
+    std::vector<SearchToken> tokens;
+    bool live = false;
+  };
+
+  SearchResults searchLocked(const std::vector<std::string> &queryTokens, uint32_t fields, size_t offset,
+                             size_t limit) const;
+  void scoreTokenLocked(const std::string &token, uint32_t fields, std::vector<uint32_t> &touched) const;
+  void scorePostingsLocked(const std::vector<Posting> &postings, double quality, uint32_t fields,
+                           std::vector<uint32_t> &touched) const;
+  void scoreFuzzyTermsLocked(const std::string &token, size_t maxEdits, uint32_t fields,
+                             std::vector<uint32_t> &touched) const;
+  uint32_t allocateSlotLocked();
+  void insertLocked(Document document);
+  void removeSlotLocked(uint32_t slot);
+  void addPostingsLocked(uint32_t slot);
+  void removePostingsLocked(uint32_t slot);
+  void ensureRanksLocked() const;
+  void clearLocked();
+
+  mutable std::mutex mutex_;
+  std::vector<Document> documents_;
+  std::vector<uint32_t> freeSlots_;
+  std::unordered_map<std::string, uint32_t> slotsById_;
+  // Ordered so a prefix maps to one contiguous range of terms
+  std::map<std::string, std::vector<Posting>, std::less<>> terms_;
+
+  // Display order of each slot and live slots in display order, rebuilt lazily after changes
+  mutable std::vector<uint32_t> ranks_;
+  mutable std::vector<uint32_t> order_;
+  mutable bool ranksDirty_ = false;
+  // Per-query scratch: best score of each slot for the current query token,
+  // and the running total over the tokens matched so far
+  mutable std::vector<double> tokenScores_;
+  mutable std::vector<double> totalScores_;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,185 @@
+//
+//  ContactUploadPipeline.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactUploadPipeline.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace contactsmanager {
+
+namespace {
+
+// Weight of the newest batch in the smoothed bytes per contact
+constexpr double kBytesSmoothing = 0.3;
+// Largest factor a single batch may grow the size by
+constexpr double kMaxGrowth = 2.0;
+
+} // namespace
+
+AdaptiveBatchSizer::AdaptiveBatchSizer(const UploadPipelineOptions &options) : options_(options) {
+  options_.minBatchSize = std::max<size_t>(options_.minBatchSize, 1);
+  options_.maxBatchSize = std::max(options_.maxBatchSize, options_.minBatchSize);
+  batchSize_ = clamp(static_cast<double>(options_.initialBatchSize));
+}
+
+size_t AdaptiveBatchSizer::clamp(double size) const {
+  double limit = static_cast<double>(options_.maxBatchSize);
+  if (bytesPerContact_ > 0 && options_.maxBodyBytes > 0) {
+    limit = std::min(limit, static_cast<double>(options_.maxBodyBytes) / bytesPerContact_);
+  }
+  size = std::min(size, limit);
+  return std::max(options_.minBatchSize, static_cast<size_t>(std::max(size, 0.0)));
+}
+
+void AdaptiveBatchSizer::recordSuccess(size_t count, size_t bodyBytes, std::chrono::duration<double> latency) {
+  if (count == 0) {
+    return;
+  }
+  double perContact = static_cast<double>(bodyBytes) / static_cast<double>(count);
+  bytesPerContact_ = bytesPerContact_ == 0 ? perContact
+                                           : bytesPerContact_ + kBytesSmoothing * (perContact - bytesPerContact_);
+
+  // Scale the batch that just finished towards the target latency, then move
+  // halfway there so one noisy round trip cannot swing the size
+  double target = std::chrono::duration<double>(options_.targetLatency).count();
+  double seconds = std::max(latency.count(), 1e-6);
+  double desired = static_cast<double>(count) * target / seconds;
+  double current = static_cast<double>(batchSize_);
+  double next = std::min((current + desired) / 2, current * kMaxGrowth);
+  batchSize_ = clamp(std::round(next));
+}
+
+void AdaptiveBatchSizer::recordFailure() {
+  batchSize_ = clamp(static_cast<double>(batchSize_ / 2));
+}
+
+ContactUploadPipeline::ContactUploadPipeline(UploadTransport &transport, UploadPipelineOptions options)
+    : transport_(transport), options_(options), sizer_(options) {
+  options_.maxInFlight = std::max<size_t>(options_.maxInFlight, 1);
+  options_.maxAttempts = std::max<size_t>(options_.maxAttempts, 1);
+}
+
+size_t ContactUploadPipeline::batchSize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sizer_.batchSize();
+}
+
+void ContactUploadPipeline::cancel() {
+  // Notify under the lock: once run() sees the flag the pipeline may be destroyed
+  std::lock_guard<std::mutex> lock(mutex_);
+  cancelled_ = true;
+  changed_.notify_all();
+}
+
+UploadReport ContactUploadPipeline::run(size_t contactCount, const BatchEncoder &encode,
+                                        const BatchAcknowledged &acknowledged) {
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point started = Clock::now();
+  UploadReport report;
+  // Failed ranges go back to the front so the upload stays roughly in order
+  std::deque<Range> retries;
+  size_t nextOffset = 0;
+  bool failed = false;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    changed_.wait(lock, [&] {
+      bool stopping = failed || cancelled_;
+      bool haveWork = !retries.empty() || nextOffset < contactCount;
+      return !completions_.empty() || (!stopping && haveWork && inFlight_ < options_.maxInFlight) ||
+             (inFlight_ == 0 && (stopping || !haveWork));
+    });
+
+    while (!completions_.empty()) {
+      Completion completion = std::move(completions_.front());
+      completions_.pop_front();
+      const UploadBatch &batch = completion.batch;
+      if (completion.response.status == UploadStatus::Ok) {
+        sizer_.recordSuccess(batch.count, batch.bodyBytes, batch.latency);
+        report.uploaded += batch.count;
+        if (acknowledged) {
+          lock.unlock();
+          acknowledged(batch, completion.response);
+          lock.lock();
+        }
+        continue;
+      }
+      sizer_.recordFailure();
+      if (batch.attempt >= options_.maxAttempts) {
+        failed = true;
+        continue;
+      }
+      if (completion.response.status == UploadStatus::TimedOut && batch.idempotent) {
+        retries.push_front({batch.offset, batch.count, batch.attempt + 1, true});
+        continue;
+      }
+      // Retry in halves: if one contact makes the server choke, the rest of
+      // the batch still gets through
+      size_t firstHalf = batch.count > 1 ? batch.count / 2 : batch.count;
+      if (batch.count > firstHalf) {
+        retries.push_front({batch.offset + firstHalf, batch.count - firstHalf, batch.attempt + 1});
+      }
+      retries.push_front({batch.offset, firstHalf, batch.attempt + 1});
+    }
+
+    bool stopping = failed || cancelled_;
+    bool haveWork = !retries.empty() || nextOffset < contactCount;
+    if (inFlight_ == 0 && (stopping || !haveWork)) {
+      break;
+    }
+    if (stopping || !haveWork || inFlight_ >= options_.maxInFlight) {
+      continue;
+    }
+
+    Range range;
+    if (!retries.empty()) {
+      range = retries.front();
+      retries.pop_front();
+      size_t size = sizer_.batchSize();
+      if (!range.whole && range.count > size) {
+        retries.push_front({range.offset + size, range.count - size, range.attempt});
+        range.count = size;
+      }
+      report.retries++;
+    } else {
+      range.offset = nextOffset;
+      range.count = std::min(sizer_.batchSize(), contactCount - nextOffset);
+      nextOffset += range.count;
+    }
+    inFlight_++;
+
+    // Encode without the lock so completions of earlier batches are not held up
+    lock.unlock();
+    UploadRequest request = encode(range.offset, range.count);
+    UploadBatch batch;
+    batch.offset = range.offset;
+    batch.count = range.count;
+    batch.bodyBytes = request.body.size();
+    batch.attempt = range.attempt;
+    batch.idempotent = !request.idempotencyKey.empty();
+    report.batches++;
+    report.bytes += request.body.size();
+    const Clock::time_point sent = Clock::now();
+    transport_.send(std::move(request), options_.uploadTimeout, [this, batch, sent](UploadResponse response) mutable {
+      batch.latency = Clock::now() - sent;
+      // Notify under the lock: once run() sees inFlight_ reach zero the pipeline may be destroyed
+      std::lock_guard<std::mutex> completionLock(mutex_);
+      completions_.push_back({batch, std::move(response)});
+      inFlight_--;
+      changed_.notify_all();
+    });
+    lock.lock();
+  }
+
+  report.cancelled = cancelled_ && !failed && report.uploaded < contactCount;
+  report.ok = !failed && report.uploaded == contactCount;
+  // The cancel is spent on this run, so the pipeline can run again
+  cancelled_ = false;
+  report.elapsed = Clock::now() - started;
+  return report;
+}
+
+} // namespace contactsmanager
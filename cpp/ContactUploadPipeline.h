@@ -0,0 +1,188 @@
+//
+//  ContactUploadPipeline.h
+//  ContactsManagerCore
+//
+//  Uploads a contact range in batches with several requests in flight. The
+//  next batch is encoded while earlier ones are on the wire, so serialization
+//  overlaps the round trips instead of adding to them. Batch size adapts to
+//  what the server shows: batches that come back well inside the target
+//  latency grow (up to maxContactsPerBatch and the body size cap), slow ones
+//  shrink, and a failed or timed-out batch is halved and retried. A batch
+//  sent with an idempotency key that timed out may have been applied, so it
+//  is retried whole under the same key for the server to answer from its
+//  replay cache.
+//
+
+#pragma once
+
+#include "SyncWireFormat.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace contactsmanager {
+
+enum class UploadStatus : uint8_t {
+  Ok,
+  // The server or the network reported an error
+  Failed,
+  // No response within the batch's upload timeout
+  TimedOut,
+};
+
+struct UploadRequest {
+  std::string body;
+  // Sent as the Idempotency-Key header when set, so the server applies a
+  // re-sent batch at most once
+  std::string idempotencyKey = {};
+  // Sent as Content-Type and Content-Encoding; plain JSON unless negotiated
+  WireEncoding encoding = {};
+};
+
+struct UploadResponse {
+  UploadStatus status = UploadStatus::Ok;
+  std::string body;
+};
+
+/**
+ * Sends request bodies to the sync endpoint (CMAPIClient on iOS, a local
+ * stand-in on the host)
+ */
+class UploadTransport {
+public:
+  virtual ~UploadTransport() = default;
+
+  /**
+   * Sends the request and calls done exactly once, from any thread. Must
+   * report TimedOut once timeout passes without a response.
+   */
+  virtual void send(UploadRequest request, std::chrono::milliseconds timeout,
+                    std::function<void(UploadResponse response)> done) = 0;
+};
+
+struct UploadPipelineOptions {
+  size_t initialBatchSize = 100;
+  size_t minBatchSize = 10;
+  // CMAPIConfig maxContactsPerBatch
+  size_t maxBatchSize = 500;
+  size_t maxInFlight = 3;
+  // CMAPIConfig uploadTimeout, applied to each batch
+  std::chrono::milliseconds uploadTimeout{30000};
+  // Batch latency the sizer steers towards
+  std::chrono::milliseconds targetLatency{2000};
+  size_t maxBodyBytes = 4u << 20;
+  // Attempts per contact before the upload gives up
+  size_t maxAttempts = 3;
+};
+
+/**
+ * Picks the next batch size from the batches acknowledged so far
+ */
+class AdaptiveBatchSizer {
+public:
+  explicit AdaptiveBatchSizer(const UploadPipelineOptions &options);
+
+  size_t batchSize() const { return batchSize_; }
+
+  void recordSuccess(size_t count, size_t bodyBytes, std::chrono::duration<double> latency);
+
+  /**
+   * Halves the batch size
+   */
+  void recordFailure();
+
+private:
+  size_t clamp(double size) const;
+
+  UploadPipelineOptions options_;
+  size_t batchSize_;
+  // Smoothed body bytes per contact, 0 until the first batch
+  double bytesPerContact_ = 0;
+};
+
+struct UploadBatch {
+  size_t offset = 0;
+  size_t count = 0;
+  size_t bodyBytes = 0;
+  // 1 for the first attempt at these contacts
+  size_t attempt = 1;
+  // The request carried an idempotency key
+  bool idempotent = false;
+  std::chrono::duration<double> latency{0};
+};
+
+struct UploadReport {
+  bool ok = false;
+  bool cancelled = false;
+  size_t uploaded = 0;
+  size_t batches = 0;
+  size_t retries = 0;
+  uint64_t bytes = 0;
+  std::chrono::duration<double> elapsed{0};
+};
+
+class ContactUploadPipeline {
+public:
+  /**
+   * Encodes contacts [offset, offset + count) as one request
+   */
+  using BatchEncoder = std::function<UploadRequest(size_t offset, size_t count)>;
+
+  /**
+   * Called on the run() thread for each batch the server acknowledged, in
+   * completion order
+   */
+  using BatchAcknowledged = std::function<void(const UploadBatch &batch, const UploadResponse &response)>;
+
+  explicit ContactUploadPipeline(UploadTransport &transport, UploadPipelineOptions options = {});
+
+  ContactUploadPipeline(const ContactUploadPipeline &) = delete;
+  ContactUploadPipeline &operator=(const ContactUploadPipeline &) = delete;
+
+  /**
+   * Uploads contacts [0, contactCount) and returns once every batch was
+   * acknowledged, the upload failed or it was cancelled; requests already in
+   * flight are always waited for. May be called again once it returns.
+   */
+  UploadReport run(size_t contactCount, const BatchEncoder &encode, const BatchAcknowledged &acknowledged = {});
+
+  /**
+   * Stops issuing batches for the current run, or for the next one when
+   * none is running; safe to call from any thread
+   */
+  void cancel();
+
+  size_t batchSize() const;
+
+private:
+  struct Range {
+    size_t offset = 0;
+    size_t count = 0;
+    size_t attempt = 1;
+    // Re-sent as one request, under the key of the attempt that timed out
+    bool whole = false;
+  };
+
+  struct Completion {
+    UploadBatch batch;
+    UploadResponse response;
+  };
+
+  UploadTransport &transport_;
+  UploadPipelineOptions options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable changed_;
+  std::deque<Completion> completions_;
+  size_t inFlight_ = 0;
+  AdaptiveBatchSizer sizer_;
+  bool cancelled_ = false;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,100 @@
+//
+//  DeflateStream.cpp
+//  ContactsManagerCore
+//
+
+#include "DeflateStream.h"
+
+#include <zlib.h>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr size_t kChunkSize = 16 * 1024;
+// zlib's windowBits: 15 is the largest window, +16 selects gzip, +32 detects either when inflating
+constexpr int kWindowBits = 15;
+
+} // namespace
+
+struct DeflateStream::State {
+  z_stream stream{};
+  unsigned char buffer[kChunkSize];
+};
+
+DeflateStream::DeflateStream(std::string &out, DeflateFormat format, int level)
+    : state_(new State()), out_(out) {
+  int windowBits = format == DeflateFormat::Gzip ? kWindowBits + 16 : kWindowBits;
+  ok_ = deflateInit2(&state_->stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+DeflateStream::~DeflateStream() {
+  // Safe on a stream whose init failed
+  deflateEnd(&state_->stream);
+}
+
+bool DeflateStream::pump(std::string_view bytes, int flush) {
+  z_stream &stream = state_->stream;
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(bytes.data()));
+  stream.avail_in = static_cast<uInt>(bytes.size());
+  int status;
+  do {
+    stream.next_out = state_->buffer;
+    stream.avail_out = static_cast<uInt>(kChunkSize);
+    status = deflate(&stream, flush);
+    if (status == Z_STREAM_ERROR) {
+      return false;
+    }
+    out_.append(reinterpret_cast<const char *>(state_->buffer), kChunkSize - stream.avail_out);
+  } while (stream.avail_out == 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+  return true;
+}
+
+bool DeflateStream::write(std::string_view bytes) {
+  if (!ok_ || finished_) {
+    return false;
+  }
+  bytesIn_ += bytes.size();
+  // zlib counts input in uInt, so very large writes go in pieces
+  while (!bytes.empty()) {
+    std::string_view piece = bytes.substr(0, 1u << 30);
+    if (!pump(piece, Z_NO_FLUSH)) {
+      ok_ = false;
+      return false;
+    }
+    bytes.remove_prefix(piece.size());
+  }
+  return true;
+}
+
+bool DeflateStream::finish() {
+  if (!ok_ || finished_) {
+    return false;
+  }
+  finished_ = true;
+  ok_ = pump({}, Z_FINISH);
+  return ok_;
+}
+
+bool inflateBytes(std::string_view compressed, std::string &out) {
+  z_stream stream{};
+  if (inflateInit2(&stream, kWindowBits + 32) != Z_OK) {
+    return false;
+  }
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
+  stream.avail_in = static_cast<uInt>(compressed.size());
+  int status;
+  do {
+    size_t used = out.size();
+    out.resize(used + kChunkSize);
+    stream.next_out = reinterpret_cast<Bytef *>(&out[used]);
+    stream.avail_out = static_cast<uInt>(kChunkSize);
+    status = inflate(&stream, Z_NO_FLUSH);
+    out.resize(used + kChunkSize - stream.avail_out);
+  } while (status == Z_OK);
+  bool complete = status == Z_STREAM_END && stream.avail_in == 0;
+  inflateEnd(&stream);
+  return complete;
+}
+
+} // namespace contactsmanager
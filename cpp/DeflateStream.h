@@ -0,0 +1,67 @@
+//
+//  DeflateStream.h
+//  ContactsManagerCore
+//
+//  Incremental zlib compression for request bodies. Bytes are compressed as
+//  they are written, so an encoder can hand over each contact as soon as it is
+//  serialized and never hold the uncompressed body.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace contactsmanager {
+
+enum class DeflateFormat {
+  // zlib wrapper, HTTP "Content-Encoding: deflate"
+  Zlib,
+  // HTTP "Content-Encoding: gzip"
+  Gzip,
+};
+
+class DeflateStream {
+public:
+  /**
+   * Appends compressed bytes to out; level is zlib's 1 (fastest) to 9 (smallest)
+   */
+  explicit DeflateStream(std::string &out, DeflateFormat format = DeflateFormat::Zlib, int level = 6);
+  ~DeflateStream();
+
+  DeflateStream(const DeflateStream &) = delete;
+  DeflateStream &operator=(const DeflateStream &) = delete;
+
+  /**
+   * False once zlib reported an error; the output is then incomplete
+   */
+  bool ok() const { return ok_; }
+
+  bool write(std::string_view bytes);
+
+  /**
+   * Flushes the remaining output and the trailer; nothing may be written after
+   */
+  bool finish();
+
+  size_t bytesIn() const { return bytesIn_; }
+
+private:
+  bool pump(std::string_view bytes, int flush);
+
+  struct State;
+  std::unique_ptr<State> state_;
+  std::string &out_;
+  bool ok_ = false;
+  bool finished_ = false;
+  size_t bytesIn_ = 0;
+};
+
+/**
+ * Decompresses a zlib or gzip stream (detected from its header)
+ */
+bool inflateBytes(std::string_view compressed, std::string &out);
+
+} // namespace contactsmanager
@@ -0,0 +1,55 @@
+//
+//  FeedCursor.cpp
+//  ContactsManagerCore
+//
+
+#include "FeedCursor.h"
+
+#include "Base64.h"
+#include "BinaryFile.h"
+#include "ContactHashing.h"
+
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr uint32_t kCursorVersion = 1;
+
+} // namespace
+
+bool feedPositionBefore(const FeedPosition &lhs, const FeedPosition &rhs) {
+  if (lhs.createdAt != rhs.createdAt) {
+    return lhs.createdAt > rhs.createdAt;
+  }
+  return lhs.identifier > rhs.identifier;
+}
+
+// Layout: version, feed hash, createdAt bits, identifier; base64 on the wire
+std::string encodeFeedCursor(std::string_view feed, const FeedPosition &position) {
+  std::string bytes;
+  binary::writeUint32(bytes, kCursorVersion);
+  binary::writeUint64(bytes, fnv1a64(feed));
+  binary::writeDouble(bytes, position.createdAt);
+  binary::writeString(bytes, position.identifier);
+  return base64::encode(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size());
+}
+
+std::optional<FeedPosition> decodeFeedCursor(std::string_view feed, std::string_view cursor) {
+  std::string bytes;
+  if (!base64::decode(cursor, bytes)) {
+    return std::nullopt;
+  }
+  binary::Reader reader(bytes);
+  uint32_t version = 0;
+  uint64_t feedHash = 0;
+  FeedPosition position;
+  if (!reader.readUint32(version) || version != kCursorVersion || !reader.readUint64(feedHash) ||
+      feedHash != fnv1a64(feed) || !reader.readDouble(position.createdAt) ||
+      !reader.readString(position.identifier) || !reader.atEnd()) {
+    return std::nullopt;
+  }
+  return position;
+}
+
+} // namespace contactsmanager
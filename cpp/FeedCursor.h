@@ -0,0 +1,51 @@
+//
+//  FeedCursor.h
+//  ContactsManagerCore
+//
+//  Opaque cursors for the social feeds (getFeed, getUpcomingEvents,
+//  getForYouFeed, getUserEvents, followers and following lists). A cursor
+//  names the last item of a page by its sort key instead of counting items,
+//  so the next page is a keyset seek whatever the depth, and events
+//  published meanwhile cannot shift items into or out of it.
+//
+
+#pragma once
+
+#include "SocialModels.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace contactsmanager {
+
+/**
+ * Position in a feed ordered newest first: createdAt descending, ties by
+ * identifier descending
+ */
+struct FeedPosition {
+  double createdAt = 0;
+  std::string identifier;
+};
+
+/**
+ * True when an item at lhs is shown before one at rhs
+ */
+bool feedPositionBefore(const FeedPosition &lhs, const FeedPosition &rhs);
+
+inline FeedPosition feedPositionOf(const SocialEvent &event) {
+  return FeedPosition{event.createdAt, event.eventId};
+}
+
+/**
+ * Cursor for the items after position; the feed name is bound in so a
+ * cursor is only accepted by the feed that issued it
+ */
+std::string encodeFeedCursor(std::string_view feed, const FeedPosition &position);
+
+/**
+ * Position named by a cursor, or nullopt for a malformed cursor or one from another feed
+ */
+std::optional<FeedPosition> decodeFeedCursor(std::string_view feed, std::string_view cursor);
+
+} // namespace contactsmanager
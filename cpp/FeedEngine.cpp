@@ -0,0 +1,257 @@
+//
+//  FeedEngine.cpp
+//  ContactsManagerCore
+//
+
+#include "FeedEngine.h"
+
+#include "ContactHashing.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace contactsmanager {
+
+FeedEngine::FeedEngine(FeedSource &source, FeedEngineOptions options, Listener listener)
+    : source_(source), options_(options), listener_(std::move(listener)) {
+  options_.pageSize = std::max<size_t>(options_.pageSize, 1);
+}
+
+FeedEngine::~FeedEngine() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  closing_ = true;
+  idle_.wait(lock, [this] { return !fetching_; });
+}
+
+void FeedEngine::reload() {
+  Fetch fetch;
+  bool start = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+    pages_.clear();
+    pageStarts_.assign(1, 0);
+    pageOfId_.clear();
+    nextCursor_.clear();
+    hasMore_ = true;
+    failed_ = false;
+    residentItems_ = 0;
+    start = nextFetchLocked(fetch);
+  }
+  if (start) {
+    startFetch(std::move(fetch));
+  }
+}
+
+void FeedEngine::setViewport(size_t first, size_t count) {
+  Fetch fetch;
+  bool start = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    viewportFirst_ = first;
+    viewportCount_ = count;
+    failed_ = false;
+    evictLocked();
+    start = nextFetchLocked(fetch);
+  }
+  if (start) {
+    startFetch(std::move(fetch));
+  }
+}
+
+size_t FeedEngine::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pageStarts_.back();
+}
+
+std::optional<SocialEvent> FeedEngine::itemAt(size_t position) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (position >= pageStarts_.back()) {
+    return std::nullopt;
+  }
+  size_t index = pageForPositionLocked(position);
+  const Page &page = pages_[index];
+  if (!page.resident) {
+    return std::nullopt;
+  }
+  const SocialEvent &event = page.items[position - pageStarts_[index]];
+  if (event.eventId.empty()) {
+    return std::nullopt;
+  }
+  return event;
+}
+
+bool FeedEngine::hasMore() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hasMore_;
+}
+
+bool FeedEngine::isFetching() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fetching_;
+}
+
+FeedEngineStats FeedEngine::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FeedEngineStats stats = stats_;
+  stats.residentItems = residentItems_;
+  return stats;
+}
+
+void FeedEngine::windowLocked(size_t &from, size_t &to) const {
+  from = viewportFirst_ > options_.prefetchDistance ? viewportFirst_ - options_.prefetchDistance : 0;
+  to = viewportFirst_ + viewportCount_ + options_.prefetchDistance;
+}
+
+size_t FeedEngine::pageForPositionLocked(size_t position) const {
+  // Pages emptied by deduplication share their start with the next page and are skipped
+  return static_cast<size_t>(std::upper_bound(pageStarts_.begin(), pageStarts_.end(), position) -
+                             pageStarts_.begin()) -
+         1;
+}
+
+// One fetch at a time: evicted pages in the window come back before the feed grows
+bool FeedEngine::nextFetchLocked(Fetch &fetch) {
+  if (fetching_ || closing_ || failed_) {
+    return false;
+  }
+  size_t from = 0;
+  size_t to = 0;
+  windowLocked(from, to);
+  for (size_t index = from < pageStarts_.back() ? pageForPositionLocked(from) : pages_.size();
+       index < pages_.size() && pageStarts_[index] < to; ++index) {
+    if (!pages_[index].resident) {
+      fetch = Fetch{index, pages_[index].cursor, generation_};
+      fetching_ = true;
+      return true;
+    }
+  }
+  if (hasMore_ && pageStarts_.back() < to) {
+    fetch = Fetch{pages_.size(), nextCursor_, generation_};
+    fetching_ = true;
+    return true;
+  }
+  return false;
+}
+
+void FeedEngine::startFetch(Fetch fetch) {
+  std::string cursor = fetch.cursor;
+  source_.fetchPage(cursor, options_.pageSize, [this, fetch = std::move(fetch)](bool ok, FeedPage page) {
+    deliver(fetch, ok, std::move(page));
+  });
+}
+
+void FeedEngine::deliver(const Fetch &fetch, bool ok, FeedPage page) {
+  bool changed = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fetch.generation == generation_) {
+      if (!ok) {
+        // Not retried until the viewport moves, so an unreachable server is not hammered
+        failed_ = true;
+        stats_.failedFetches++;
+      } else if (fetch.page == pages_.size()) {
+        appendPageLocked(fetch, std::move(page));
+        changed = true;
+      } else if (fetch.page < pages_.size()) {
+        refillPageLocked(fetch.page, std::move(page));
+        changed = true;
+      }
+      evictLocked();
+    }
+  }
+  if (changed && listener_) {
+    listener_();
+  }
+
+  // fetching_ is cleared only now so the destructor cannot run under the listener
+  Fetch next;
+  bool start = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fetching_ = false;
+    start = nextFetchLocked(next);
+    if (!start) {
+      idle_.notify_all();
+    }
+  }
+  if (start) {
+    startFetch(std::move(next));
+  }
+}
+
+void FeedEngine::appendPageLocked(const Fetch &fetch, FeedPage page) {
+  uint32_t index = static_cast<uint32_t>(pages_.size());
+  Page entry;
+  entry.cursor = fetch.cursor;
+  entry.resident = true;
+  for (SocialEvent &event : page.items) {
+    uint64_t id = fnv1a64(event.eventId);
+    if (!pageOfId_.emplace(id, index).second) {
+      stats_.duplicatesDropped++;
+      continue;
+    }
+    entry.ids.push_back(id);
+    entry.items.push_back(std::move(event));
+  }
+  residentItems_ += entry.items.size();
+  pageStarts_.push_back(pageStarts_.back() + entry.items.size());
+  // An empty page with a cursor would be requested forever
+  hasMore_ = !page.nextCursor.empty() && !page.items.empty();
+  nextCursor_ = std::move(page.nextCursor);
+  stats_.pagesFetched++;
+  pages_.push_back(std::move(entry));
+}
+
+// Keeps the page's recorded IDs in their recorded order; events published
+// since are left to the top of the feed, and events gone from it stay as
+// empty slots so later positions do not move
+void FeedEngine::refillPageLocked(size_t index, FeedPage page) {
+  Page &entry = pages_[index];
+  std::vector<SocialEvent> items(entry.ids.size());
+  for (SocialEvent &event : page.items) {
+    uint64_t id = fnv1a64(event.eventId);
+    auto owner = pageOfId_.find(id);
+    if (owner == pageOfId_.end() || owner->second != index) {
+      continue;
+    }
+    auto slot = std::find(entry.ids.begin(), entry.ids.end(), id);
+    items[static_cast<size_t>(slot - entry.ids.begin())] = std::move(event);
+  }
+  entry.items = std::move(items);
+  entry.resident = true;
+  residentItems_ += entry.items.size();
+  stats_.pagesRefetched++;
+}
+
+void FeedEngine::evictLocked() {
+  size_t from = 0;
+  size_t to = 0;
+  windowLocked(from, to);
+  while (residentItems_ > options_.maxResidentItems) {
+    size_t victim = pages_.size();
+    size_t farthest = 0;
+    for (size_t index = 0; index < pages_.size(); ++index) {
+      if (!pages_[index].resident || pages_[index].items.empty()) {
+        continue;
+      }
+      size_t start = pageStarts_[index];
+      size_t end = pageStarts_[index + 1];
+      size_t distance = end <= from ? from - end + 1 : (start >= to ? start - to + 1 : 0);
+      if (distance > farthest) {
+        farthest = distance;
+        victim = index;
+      }
+    }
+    if (victim == pages_.size()) {
+      break;
+    }
+    Page &page = pages_[victim];
+    residentItems_ -= page.items.size();
+    std::vector<SocialEvent>().swap(page.items);
+    page.resident = false;
+    stats_.pagesEvicted++;
+  }
+}
+
+} // namespace contactsmanager
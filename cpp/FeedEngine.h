@@ -0,0 +1,164 @@
+//
+//  FeedEngine.h
+//  ContactsManagerCore
+//
+//  Client side of a cursor-paginated social feed. The engine requests the
+//  next page while the viewport is still prefetchDistance items from the
+//  end, drops events it has already placed (by eventId) so a page that
+//  overlaps an earlier one cannot show an event twice, and keeps at most
+//  maxResidentItems events in memory. Pages far from the viewport give up
+//  their events but keep their cursor and event IDs, so positions stay
+//  stable and scrolling back refetches the page from its own cursor.
+//
+
+#pragma once
+
+#include "SocialModels.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+struct FeedPage {
+  std::vector<SocialEvent> items;
+  // Cursor for the following page; empty at the end of the feed
+  std::string nextCursor;
+};
+
+/**
+ * One paginated feed endpoint (CMSocialService on iOS, a local stand-in on the host)
+ */
+class FeedSource {
+public:
+  virtual ~FeedSource() = default;
+
+  /**
+   * Fetches up to limit items after cursor (empty for the first page) and
+   * calls done exactly once, from any thread; ok is false when the request failed
+   */
+  virtual void fetchPage(const std::string &cursor, size_t limit,
+                         std::function<void(bool ok, FeedPage page)> done) = 0;
+};
+
+struct FeedEngineOptions {
+  size_t pageSize = 20;
+  // Items left beyond the viewport at which the next page is requested
+  size_t prefetchDistance = 10;
+  // Events kept in memory; pages furthest from the viewport are dropped first
+  size_t maxResidentItems = 200;
+};
+
+struct FeedEngineStats {
+  size_t pagesFetched = 0;
+  // Evicted pages fetched again when scrolled back into view
+  size_t pagesRefetched = 0;
+  size_t pagesEvicted = 0;
+  size_t duplicatesDropped = 0;
+  size_t failedFetches = 0;
+  size_t residentItems = 0;
+};
+
+class FeedEngine {
+public:
+  /**
+   * Called after items were added or refetched, on the thread that delivered the page
+   */
+  using Listener = std::function<void()>;
+
+  FeedEngine(FeedSource &source, FeedEngineOptions options = {}, Listener listener = {});
+
+  /**
+   * Waits for a fetch in flight; no fetch is started once destruction begins
+   */
+  ~FeedEngine();
+
+  FeedEngine(const FeedEngine &) = delete;
+  FeedEngine &operator=(const FeedEngine &) = delete;
+
+  /**
+   * Drops everything and fetches the first page
+   */
+  void reload();
+
+  /**
+   * Positions [first, first + count) are on screen; fetches what is needed
+   * to show them and what lies prefetchDistance beyond, and evicts pages
+   * far away. A failed fetch is retried on the next call.
+   */
+  void setViewport(size_t first, size_t count);
+
+  /**
+   * Positions placed so far, including evicted ones
+   */
+  size_t size() const;
+
+  /**
+   * The event at a position; nullopt while its page is evicted or once the
+   * event has disappeared from the feed
+   */
+  std::optional<SocialEvent> itemAt(size_t position) const;
+
+  bool hasMore() const;
+  bool isFetching() const;
+  FeedEngineStats stats() const;
+
+private:
+  struct Page {
+    // Cursor this page was fetched with
+    std::string cursor;
+    std::vector<uint64_t> ids;
+    // Empty while evicted; an event with an empty eventId has left the feed
+    std::vector<SocialEvent> items;
+    bool resident = false;
+  };
+
+  struct Fetch {
+    // Index of the page to fill; pages_.size() for a new page
+    size_t page = 0;
+    std::string cursor;
+    uint64_t generation = 0;
+  };
+
+  bool nextFetchLocked(Fetch &fetch);
+  void startFetch(Fetch fetch);
+  void deliver(const Fetch &fetch, bool ok, FeedPage page);
+  void appendPageLocked(const Fetch &fetch, FeedPage page);
+  void refillPageLocked(size_t index, FeedPage page);
+  void evictLocked();
+  // Positions that must stay resident: the viewport widened by prefetchDistance
+  void windowLocked(size_t &from, size_t &to) const;
+  size_t pageForPositionLocked(size_t position) const;
+
+  FeedSource &source_;
+  FeedEngineOptions options_;
+  Listener listener_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable idle_;
+  bool fetching_ = false;
+  bool closing_ = false;
+  // Bumped by reload() so a page requested before it is dropped
+  uint64_t generation_ = 0;
+
+  std::vector<Page> pages_;
+  // First position of each page, plus the total at the end
+  std::vector<size_t> pageStarts_ = {0};
+  std::unordered_map<uint64_t, uint32_t> pageOfId_;
+  std::string nextCursor_;
+  bool hasMore_ = true;
+  bool failed_ = false;
+  size_t viewportFirst_ = 0;
+  size_t viewportCount_ = 0;
+  size_t residentItems_ = 0;
+  FeedEngineStats stats_;
+};
+
+} // namespace contactsmanager
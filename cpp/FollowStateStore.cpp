@@ -0,0 +1,270 @@
+//
+//  FollowStateStore.cpp
+//  ContactsManagerCore
+//
+
+#include "FollowStateStore.h"
+
+#include "JsonWriter.h"
+
+#include <memory>
+#include <utility>
+
+namespace contactsmanager {
+
+FollowStateStore::FollowStateStore(ApiTransport &transport, FollowStateOptions options, Listener listener)
+    : transport_(transport), options_(std::move(options)), listener_(std::move(listener)) {
+  if (options_.maxBatchSize == 0) {
+    options_.maxBatchSize = 1;
+  }
+}
+
+FollowStateStore::~FollowStateStore() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  flushAgain_ = false;
+  idle_.wait(lock, [this] { return !sending_; });
+}
+
+void FollowStateStore::setFollowing(const std::vector<std::string> &userIds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  confirmed_.clear();
+  for (const std::string &userId : userIds) {
+    confirmed_[userId] = true;
+  }
+  knowsAll_ = true;
+}
+
+void FollowStateStore::confirm(const std::string &userId, bool following) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  confirmed_[userId] = following;
+}
+
+void FollowStateStore::follow(const std::string &userId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  setLocked(userId, true);
+}
+
+void FollowStateStore::unfollow(const std::string &userId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  setLocked(userId, false);
+}
+
+std::optional<bool> FollowStateStore::isFollowing(const std::string &userId) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto pending = pending_.find(userId);
+  if (pending != pending_.end()) {
+    return pending->second;
+  }
+  return sentStateLocked(userId);
+}
+
+void FollowStateStore::flush() {
+  std::vector<ApiRequest> requests;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sending_) {
+      flushAgain_ = true;
+      return;
+    }
+    if (!prepareBatchLocked(requests)) {
+      return;
+    }
+  }
+  send(std::move(requests));
+}
+
+bool FollowStateStore::hasPendingChanges() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !pending_.empty();
+}
+
+bool FollowStateStore::isFlushing() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sending_;
+}
+
+FollowStateStats FollowStateStore::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FollowStateStats stats = stats_;
+  stats.pending = pending_.size();
+  return stats;
+}
+
+// A change that brings the user back to the state already sent cancels the queued one
+void FollowStateStore::setLocked(const std::string &userId, bool following) {
+  auto pending = pending_.find(userId);
+  if (pending != pending_.end()) {
+    if (pending->second == following) {
+      return;
+    }
+    pending_.erase(pending);
+    stats_.coalesced++;
+  }
+  std::optional<bool> sent = sentStateLocked(userId);
+  if (sent && *sent == following) {
+    return;
+  }
+  pending_[userId] = following;
+}
+
+std::optional<bool> FollowStateStore::sentStateLocked(const std::string &userId) const {
+  auto inFlight = inFlight_.find(userId);
+  if (inFlight != inFlight_.end()) {
+    return inFlight->second;
+  }
+  auto confirmed = confirmed_.find(userId);
+  if (confirmed != confirmed_.end()) {
+    return confirmed->second;
+  }
+  if (knowsAll_) {
+    return false;
+  }
+  return std::nullopt;
+}
+
+bool FollowStateStore::prepareBatchLocked(std::vector<ApiRequest> &requests) {
+  flushAgain_ = false;
+  if (pending_.empty()) {
+    return false;
+  }
+  std::vector<std::string> follows;
+  std::vector<std::string> unfollows;
+  while (!pending_.empty() && inFlight_.size() < options_.maxBatchSize) {
+    auto change = pending_.begin();
+    (change->second ? follows : unfollows).push_back(change->first);
+    inFlight_.emplace(change->first, change->second);
+    pending_.erase(change);
+  }
+  // Whatever did not fit goes out when this batch is answered
+  flushAgain_ = !pending_.empty();
+  sending_ = true;
+  stats_.changesSent += inFlight_.size();
+
+  if (options_.batchEndpoint.empty()) {
+    // One call per user, all in flight together
+    for (const auto *userIds : {&follows, &unfollows}) {
+      for (const std::string &userId : *userIds) {
+        ApiRequest request;
+        request.method = "POST";
+        request.endpoint = userIds == &follows ? options_.followEndpoint : options_.unfollowEndpoint;
+        request.parameters = {{"user_id", userId}};
+        requests.push_back(std::move(request));
+      }
+    }
+    stats_.requests += requests.size();
+    return true;
+  }
+
+  std::string body;
+  JsonWriter writer(body);
+  writer.beginObject();
+  writer.key("follow");
+  writer.beginArray();
+  for (const std::string &userId : follows) {
+    writer.stringValue(userId);
+  }
+  writer.endArray();
+  writer.key("unfollow");
+  writer.beginArray();
+  for (const std::string &userId : unfollows) {
+    writer.stringValue(userId);
+  }
+  writer.endArray();
+  writer.endObject();
+
+  ApiRequest request;
+  request.method = "POST";
+  request.endpoint = options_.batchEndpoint;
+  request.body = std::move(body);
+  requests.push_back(std::move(request));
+  stats_.requests++;
+  return true;
+}
+
+void FollowStateStore::send(std::vector<ApiRequest> requests) {
+  // Collects the answers of one round; the last one completes it
+  struct Round {
+    std::mutex mutex;
+    size_t remaining = 0;
+    bool batchFailed = false;
+    std::unordered_set<std::string> failed;
+  };
+  auto round = std::make_shared<Round>();
+  round->remaining = requests.size();
+  bool batch = !options_.batchEndpoint.empty();
+  for (ApiRequest &request : requests) {
+    std::string userId = batch ? std::string() : request.parameters.front().second;
+    transport_.send(std::move(request), [this, round, batch, userId](ApiResponse response) {
+      std::unordered_set<std::string> failed;
+      {
+        std::lock_guard<std::mutex> lock(round->mutex);
+        if (!response.ok()) {
+          round->batchFailed = batch;
+          if (!batch) {
+            round->failed.insert(userId);
+          }
+        }
+        if (--round->remaining > 0) {
+          return;
+        }
+        failed.swap(round->failed);
+      }
+      if (round->batchFailed) {
+        // The batch endpoint fails as a whole
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &change : inFlight_) {
+          failed.insert(change.first);
+        }
+      }
+      complete(failed);
+    });
+  }
+}
+
+void FollowStateStore::complete(const std::unordered_set<std::string> &failed) {
+  std::vector<std::string> confirmed;
+  std::vector<std::string> rolledBack;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_map<std::string, bool> batch;
+    batch.swap(inFlight_);
+    for (auto &change : batch) {
+      if (failed.count(change.first) == 0) {
+        confirmed_[change.first] = change.second;
+        confirmed.push_back(change.first);
+        continue;
+      }
+      auto pending = pending_.find(change.first);
+      if (pending == pending_.end()) {
+        rolledBack.push_back(change.first);
+        stats_.rolledBack++;
+      } else if (sentStateLocked(change.first) == pending->second) {
+        // Toggled back while the batch was in flight; the failure already left it there
+        pending_.erase(pending);
+      }
+    }
+    if (!failed.empty()) {
+      flushAgain_ = false;
+    }
+  }
+  if (listener_) {
+    listener_(confirmed, rolledBack);
+  }
+
+  // sending_ is cleared only now so the destructor cannot run under the listener
+  std::vector<ApiRequest> next;
+  bool more = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sending_ = false;
+    more = flushAgain_ && prepareBatchLocked(next);
+    if (!more) {
+      idle_.notify_all();
+    }
+  }
+  if (more) {
+    send(std::move(next));
+  }
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,125 @@
+//
+//  FollowStateStore.h
+//  ContactsManagerCore
+//
+//  Local follow state behind followUser, unfollowUser and isFollowingUser.
+//  A follow or unfollow takes effect locally at once; the change is queued
+//  and sent with every other queued change when the store is flushed, as one
+//  request to a batch endpoint when the server has one and otherwise as the
+//  per-user follow and unfollow calls, all issued together. Toggling a user
+//  back before the flush cancels the change, and toggling several times sends
+//  only the final state. Changes that fail are rolled back to the last state
+//  the server confirmed, and the listener is told which users reverted.
+//
+//  isFollowing is answered from the store: queued state first, then the
+//  batch in flight, then confirmed state.
+//
+
+#pragma once
+
+#include "ApiTransport.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace contactsmanager {
+
+struct FollowStateOptions {
+  // CMAPIConfig followEndpoint and unfollowEndpoint, POSTed with a user_id parameter per change
+  std::string followEndpoint = "/api/v1/social/follow";
+  std::string unfollowEndpoint = "/api/v1/social/unfollow";
+  // When set, every change goes in one request instead: a JSON body
+  // {"follow": [user IDs], "unfollow": [user IDs]} that succeeds or fails as a whole
+  std::string batchEndpoint;
+  // Changes per flush round; the rest are sent once the round is answered
+  size_t maxBatchSize = 100;
+};
+
+struct FollowStateStats {
+  size_t requests = 0;
+  size_t changesSent = 0;
+  // Changes cancelled or superseded before they were sent
+  size_t coalesced = 0;
+  size_t rolledBack = 0;
+  size_t pending = 0;
+};
+
+class FollowStateStore {
+public:
+  /**
+   * Called after each batch is answered, on the transport's thread
+   */
+  using Listener =
+      std::function<void(const std::vector<std::string> &confirmed, const std::vector<std::string> &rolledBack)>;
+
+  FollowStateStore(ApiTransport &transport, FollowStateOptions options = {}, Listener listener = {});
+
+  /**
+   * Waits for a batch in flight; queued changes are not sent
+   */
+  ~FollowStateStore();
+
+  FollowStateStore(const FollowStateStore &) = delete;
+  FollowStateStore &operator=(const FollowStateStore &) = delete;
+
+  /**
+   * The complete following list from the server; users not in it are not followed
+   */
+  void setFollowing(const std::vector<std::string> &userIds);
+
+  /**
+   * One user's state as the server reported it, e.g. from isFollowingUser
+   */
+  void confirm(const std::string &userId, bool following);
+
+  void follow(const std::string &userId);
+  void unfollow(const std::string &userId);
+
+  /**
+   * nullopt when the store knows nothing about the user and the server must be asked
+   */
+  std::optional<bool> isFollowing(const std::string &userId) const;
+
+  /**
+   * Sends the queued changes. While a batch is in flight the flush happens
+   * when it is answered; after a failure nothing more is sent until the next call.
+   */
+  void flush();
+
+  bool hasPendingChanges() const;
+  bool isFlushing() const;
+  FollowStateStats stats() const;
+
+private:
+  void setLocked(const std::string &userId, bool following);
+  std::optional<bool> sentStateLocked(const std::string &userId) const;
+  bool prepareBatchLocked(std::vector<ApiRequest> &requests);
+  void send(std::vector<ApiRequest> requests);
+  void complete(const std::unordered_set<std::string> &failed);
+
+  ApiTransport &transport_;
+  FollowStateOptions options_;
+  Listener listener_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable idle_;
+  bool sending_ = false;
+  bool flushAgain_ = false;
+  // After setFollowing, users not in confirmed_ are known not to be followed
+  bool knowsAll_ = false;
+  std::unordered_map<std::string, bool> confirmed_;
+  std::unordered_map<std::string, bool> inFlight_;
+  // Ordered so batches are deterministic
+  std::map<std::string, bool> pending_;
+  FollowStateStats stats_;
+};
+
+} // namespace contactsmanager
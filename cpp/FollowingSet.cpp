@@ -0,0 +1,208 @@
+//
+//  FollowingSet.cpp
+//  ContactsManagerCore
+//
+
+#include "FollowingSet.h"
+
+#include "BinaryFile.h"
+#include "ContactHashing.h"
+
+#include <algorithm>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'C', 'M', 'F', 'S'};
+constexpr uint32_t kFileVersion = 1;
+constexpr size_t kMinimumCapacity = 64;
+
+uint64_t userHash(std::string_view userId) {
+  return fnv1a64(userId);
+}
+
+// splitmix64 finalizer; FNV-1a alone leaves the high bits poorly mixed for short IDs
+uint64_t mixed(uint64_t hash) {
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+// Maps a 32-bit value onto [0, range) without a division
+uint64_t reduce(uint32_t value, uint64_t range) {
+  return (static_cast<uint64_t>(value) * range) >> 32;
+}
+
+} // namespace
+
+FollowingSet::FollowingSet(FollowingSetOptions options) : options_(options) {
+  options_.bitsPerEntry = std::max<size_t>(options_.bitsPerEntry, 1);
+  options_.probes = std::max<size_t>(options_.probes, 1);
+  std::lock_guard<std::mutex> lock(mutex_);
+  rebuildFilterLocked();
+}
+
+void FollowingSet::assign(const std::vector<std::string> &userIds) {
+  std::vector<uint64_t> hashes;
+  hashes.reserve(userIds.size());
+  for (const std::string &userId : userIds) {
+    hashes.push_back(userHash(userId));
+  }
+  std::sort(hashes.begin(), hashes.end());
+  hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  hashes_ = std::move(hashes);
+  rebuildFilterLocked();
+}
+
+bool FollowingSet::add(std::string_view userId) {
+  uint64_t hash = userHash(userId);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto position = std::lower_bound(hashes_.begin(), hashes_.end(), hash);
+  if (position != hashes_.end() && *position == hash) {
+    return false;
+  }
+  hashes_.insert(position, hash);
+  if (hashes_.size() > filterCapacity_) {
+    rebuildFilterLocked();
+  } else {
+    setFilterBitsLocked(hash);
+  }
+  return true;
+}
+
+// Bloom filter bits cannot be cleared; removed users only cost a binary
+// search until enough have gone that the filter is rebuilt
+bool FollowingSet::remove(std::string_view userId) {
+  uint64_t hash = userHash(userId);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto position = std::lower_bound(hashes_.begin(), hashes_.end(), hash);
+  if (position == hashes_.end() || *position != hash) {
+    return false;
+  }
+  hashes_.erase(position);
+  if (++removedSinceRebuild_ > filterCapacity_ / 4) {
+    rebuildFilterLocked();
+  }
+  return true;
+}
+
+bool FollowingSet::contains(std::string_view userId) const {
+  uint64_t hash = userHash(userId);
+  std::lock_guard<std::mutex> lock(mutex_);
+  return containsLocked(hash);
+}
+
+std::vector<bool> FollowingSet::containsEach(const std::vector<std::string> &userIds) const {
+  std::vector<bool> result(userIds.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < userIds.size(); ++i) {
+    result[i] = containsLocked(userHash(userIds[i]));
+  }
+  return result;
+}
+
+size_t FollowingSet::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hashes_.size();
+}
+
+size_t FollowingSet::memoryBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (hashes_.capacity() + filter_.capacity()) * sizeof(uint64_t);
+}
+
+// File layout (native byte order, the set never leaves the device):
+//   "CMFS" version count count x hash, ascending
+bool FollowingSet::save(const std::string &path) const {
+  std::string out;
+  out.append(kFileMagic, sizeof(kFileMagic));
+  binary::writeUint32(out, kFileVersion);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    binary::writeUint32(out, static_cast<uint32_t>(hashes_.size()));
+    for (uint64_t hash : hashes_) {
+      binary::writeUint64(out, hash);
+    }
+  }
+  return binary::writeFileAtomically(path, out);
+}
+
+bool FollowingSet::load(const std::string &path) {
+  std::string data;
+  bool read = binary::readFile(path, data);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  hashes_.clear();
+  rebuildFilterLocked();
+  binary::Reader reader(data);
+  uint32_t version = 0;
+  uint32_t count = 0;
+  if (!read || !reader.expect(std::string_view(kFileMagic, sizeof(kFileMagic))) || !reader.readUint32(version) ||
+      version != kFileVersion || !reader.readUint32(count)) {
+    return false;
+  }
+  std::vector<uint64_t> hashes(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (!reader.readUint64(hashes[i]) || (i > 0 && hashes[i] <= hashes[i - 1])) {
+      return false;
+    }
+  }
+  if (!reader.atEnd()) {
+    return false;
+  }
+  hashes_ = std::move(hashes);
+  rebuildFilterLocked();
+  return true;
+}
+
+bool FollowingSet::containsLocked(uint64_t hash) const {
+  return filterMayContainLocked(hash) && std::binary_search(hashes_.begin(), hashes_.end(), hash);
+}
+
+// Probes are h1 + i * h2 (Kirsch-Mitzenmacher) over the two halves of the mixed hash
+bool FollowingSet::filterMayContainLocked(uint64_t hash) const {
+  uint64_t bits = mixed(hash);
+  uint32_t h1 = static_cast<uint32_t>(bits);
+  uint32_t h2 = static_cast<uint32_t>(bits >> 32) | 1;
+  for (size_t i = 0; i < options_.probes; ++i) {
+    uint64_t bit = reduce(h1 + static_cast<uint32_t>(i) * h2, filterBits_);
+    if ((filter_[bit >> 6] & (uint64_t(1) << (bit & 63))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FollowingSet::setFilterBitsLocked(uint64_t hash) {
+  uint64_t bits = mixed(hash);
+  uint32_t h1 = static_cast<uint32_t>(bits);
+  uint32_t h2 = static_cast<uint32_t>(bits >> 32) | 1;
+  for (size_t i = 0; i < options_.probes; ++i) {
+    uint64_t bit = reduce(h1 + static_cast<uint32_t>(i) * h2, filterBits_);
+    filter_[bit >> 6] |= uint64_t(1) << (bit & 63);
+  }
+}
+
+// Room for a quarter more entries, so single follows rarely trigger a rebuild; the hash
+// array is trimmed to the same room so mass unfollows give memory back
+void FollowingSet::rebuildFilterLocked() {
+  filterCapacity_ = std::max(kMinimumCapacity, hashes_.size() + hashes_.size() / 4);
+  size_t words = (filterCapacity_ * options_.bitsPerEntry + 63) / 64;
+  filterBits_ = static_cast<uint64_t>(words) * 64;
+  std::vector<uint64_t>(words, 0).swap(filter_);
+  removedSinceRebuild_ = 0;
+  if (hashes_.capacity() > filterCapacity_) {
+    hashes_.shrink_to_fit();
+  }
+  for (uint64_t hash : hashes_) {
+    setFilterBitsLocked(hash);
+  }
+}
+
+} // namespace contactsmanager
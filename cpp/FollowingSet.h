@@ -0,0 +1,90 @@
+//
+//  FollowingSet.h
+//  ContactsManagerCore
+//
+//  Compact copy of the current user's following list for follow badges.
+//  User IDs are kept as a sorted array of 64-bit hashes, fronted by a Bloom
+//  filter so the common answer, "not followed", is a few bit tests without
+//  touching the array; a filter hit is confirmed by binary search. The list
+//  is downloaded once, kept current with add and remove as follows and
+//  unfollows are confirmed, and persisted so badges need no network call.
+//
+//  Two IDs with the same 64-bit hash would share a badge; at 10^6 follows
+//  the chance of that is about 3 in 10^8.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace contactsmanager {
+
+struct FollowingSetOptions {
+  // About 0.8% of lookups for unfollowed users reach the array at 10 bits and 7 probes
+  size_t bitsPerEntry = 10;
+  size_t probes = 7;
+};
+
+class FollowingSet {
+public:
+  explicit FollowingSet(FollowingSetOptions options = {});
+
+  FollowingSet(const FollowingSet &) = delete;
+  FollowingSet &operator=(const FollowingSet &) = delete;
+
+  /**
+   * Replaces the set with a complete following list
+   */
+  void assign(const std::vector<std::string> &userIds);
+
+  /**
+   * @return true if the set changed
+   */
+  bool add(std::string_view userId);
+  bool remove(std::string_view userId);
+
+  bool contains(std::string_view userId) const;
+
+  /**
+   * One answer per ID, under a single lock, for a screen of badges
+   */
+  std::vector<bool> containsEach(const std::vector<std::string> &userIds) const;
+
+  size_t size() const;
+  size_t memoryBytes() const;
+
+  /**
+   * Writes the hashes atomically to path
+   */
+  bool save(const std::string &path) const;
+
+  /**
+   * Replaces the set with the one stored at path; on any error the set is
+   * left empty and false is returned
+   */
+  bool load(const std::string &path);
+
+private:
+  bool containsLocked(uint64_t hash) const;
+  bool filterMayContainLocked(uint64_t hash) const;
+  void setFilterBitsLocked(uint64_t hash);
+  // Sizes the filter for the current entries and fills it
+  void rebuildFilterLocked();
+
+  FollowingSetOptions options_;
+  mutable std::mutex mutex_;
+  // Sorted, unique
+  std::vector<uint64_t> hashes_;
+  std::vector<uint64_t> filter_;
+  uint64_t filterBits_ = 0;
+  // Entries the filter was sized for; added past it or removed since, it is rebuilt
+  size_t filterCapacity_ = 0;
+  size_t removedSinceRebuild_ = 0;
+};
+
+} // namespace contactsmanager
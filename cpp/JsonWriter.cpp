@@ -0,0 +1,139 @@
+//
+//  JsonWriter.cpp
+//  ContactsManagerCore
+//
+
+#include "JsonWriter.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace contactsmanager {
+
+void appendJsonString(std::string &out, std::string_view value) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  out.push_back('"');
+  size_t runStart = 0;
+  for (size_t i = 0; i < value.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(value[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    out.append(value.data() + runStart, i - runStart);
+    runStart = i + 1;
+    switch (c) {
+    case '"':
+      out.append("\\\"");
+      break;
+    case '\\':
+      out.append("\\\\");
+      break;
+    case '\n':
+      out.append("\\n");
+      break;
+    case '\r':
+      out.append("\\r");
+      break;
+    case '\t':
+      out.append("\\t");
+      break;
+    default:
+      out.append("\\u00");
+      out.push_back(kHexDigits[c >> 4]);
+      out.push_back(kHexDigits[c & 0xF]);
+      break;
+    }
+  }
+  out.append(value.data() + runStart, value.size() - runStart);
+  out.push_back('"');
+}
+
+void JsonWriter::beforeValue() {
+  if (afterKey_) {
+    afterKey_ = false;
+    return;
+  }
+  if (depth_ == 0) {
+    return;
+  }
+  uint64_t bit = 1ULL << (depth_ - 1);
+  if (hasElement_ & bit) {
+    out_.push_back(',');
+  }
+  hasElement_ |= bit;
+}
+
+void JsonWriter::open(char bracket) {
+  beforeValue();
+  assert(depth_ < kMaxDepth);
+  out_.push_back(bracket);
+  depth_++;
+  hasElement_ &= ~(1ULL << (depth_ - 1));
+}
+
+void JsonWriter::close(char bracket) {
+  assert(depth_ > 0 && !afterKey_);
+  depth_--;
+  out_.push_back(bracket);
+}
+
+void JsonWriter::beginObject() { open('{'); }
+
+void JsonWriter::endObject() { close('}'); }
+
+void JsonWriter::beginArray() { open('['); }
+
+void JsonWriter::endArray() { close(']'); }
+
+void JsonWriter::key(std::string_view name) {
+  beforeValue();
+  appendJsonString(out_, name);
+  out_.push_back(':');
+  afterKey_ = true;
+}
+
+void JsonWriter::stringValue(std::string_view value) {
+  beforeValue();
+  appendJsonString(out_, value);
+}
+
+void JsonWriter::intValue(int64_t value) {
+  beforeValue();
+  char buffer[24];
+  int length = std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+  out_.append(buffer, static_cast<size_t>(length));
+}
+
+void JsonWriter::doubleValue(double value) {
+  beforeValue();
+  if (!std::isfinite(value)) {
+    out_.append("null");
+    return;
+  }
+  char buffer[32];
+  // Try the short form first and fall back to full precision when it does not round-trip
+  int length = std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (std::strtod(buffer, nullptr) != value) {
+    length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  }
+  out_.append(buffer, static_cast<size_t>(length));
+}
+
+void JsonWriter::boolValue(bool value) {
+  beforeValue();
+  out_.append(value ? "true" : "false");
+}
+
+void JsonWriter::nullValue() {
+  beforeValue();
+  out_.append("null");
+}
+
+void JsonWriter::rawValue(std::string_view json) {
+  beforeValue();
+  out_.append(json);
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,84 @@
+//
+//  JsonWriter.h
+//  ContactsManagerCore
+//
+//  Minimal JSON writer that appends straight to a string, so request bodies
+//  are produced without building an NSDictionary/NSArray tree first. Commas
+//  and nesting are tracked by the writer; callers only open and close
+//  containers and emit keys and values in order.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace contactsmanager {
+
+class JsonWriter {
+public:
+  static constexpr size_t kMaxDepth = 64;
+
+  explicit JsonWriter(std::string &out) : out_(out) {}
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  /**
+   * Object key; the next call must write its value
+   */
+  void key(std::string_view name);
+
+  void stringValue(std::string_view value);
+  void intValue(int64_t value);
+
+  /**
+   * Shortest representation that reads back to the same double; NaN and
+   * infinities are written as null
+   */
+  void doubleValue(double value);
+
+  void boolValue(bool value);
+  void nullValue();
+
+  /**
+   * Value that is already encoded JSON, copied as is
+   */
+  void rawValue(std::string_view json);
+
+  /**
+   * key + stringValue
+   */
+  void field(std::string_view name, std::string_view value) {
+    key(name);
+    stringValue(value);
+  }
+
+  /**
+   * Nesting depth of the containers still open
+   */
+  size_t depth() const { return depth_; }
+
+private:
+  void beforeValue();
+  void open(char bracket);
+  void close(char bracket);
+
+  std::string &out_;
+  // Bit n is set once the container at depth n has an element
+  uint64_t hasElement_ = 0;
+  size_t depth_ = 0;
+  bool afterKey_ = false;
+};
+
+/**
+ * Appends value as a quoted JSON string, escaping quotes, backslashes and
+ * control characters; other UTF-8 bytes are copied as is
+ */
+void appendJsonString(std::string &out, std::string_view value);
+
+} // namespace contactsmanager
@@ -0,0 +1,333 @@
+//
+//  LocalSocialGraph.cpp
+//  ContactsManagerCore
+//
+
+#include "LocalSocialGraph.h"
+
+#include "CanonicalMatchIndex.h"
+#include "ContactHashing.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+namespace contactsmanager {
+
+namespace {
+
+enum ContactFlag : uint8_t {
+  kContactFollowed = 1 << 0,
+  kContactFollower = 1 << 1,
+  kContactRelation = 1 << 2,
+  kContactSelf = 1 << 3,
+};
+
+enum AttributeKind : uint8_t {
+  kOrganization = 0,
+  kEmailDomain = 1,
+};
+
+// Local signal weights; they add up to 1
+constexpr double kFollowsYouWeight = 0.30;
+constexpr double kInAddressBookWeight = 0.20;
+constexpr double kInteractionsWeight = 0.20;
+constexpr double kRelationWeight = 0.10;
+constexpr double kOrganizationWeight = 0.12;
+constexpr double kDomainWeight = 0.08;
+// Sharing an organization or domain with the user counts fully; being
+// common among their contacts counts this much at most
+constexpr double kAffinityShare = 0.6;
+// Engaged members at which an attribute's affinity saturates
+constexpr double kAffinitySaturation = 8;
+
+// Shared by unrelated people, so a shared address says nothing
+const char *const kWebmailDomains[] = {
+    "aol.com",     "gmail.com",   "gmx.com",      "gmx.de",   "googlemail.com", "hotmail.com", "icloud.com",
+    "live.com",    "mac.com",     "mail.com",     "me.com",   "msn.com",        "outlook.com", "proton.me",
+    "protonmail.com", "qq.com",   "yahoo.com",    "yandex.ru",
+};
+
+// Attribute keys carry their kind in the top bits so organizations and domains never collide
+uint64_t attributeKey(AttributeKind kind, std::string_view normalized) {
+  return (fnv1a64(normalized) >> 2) | (static_cast<uint64_t>(kind) << 62);
+}
+
+uint64_t organizationKey(std::string_view organization) {
+  std::string_view name = text::trimmed(organization);
+  return name.empty() ? 0 : attributeKey(kOrganization, text::folded(name));
+}
+
+uint64_t emailDomainKey(std::string_view email) {
+  size_t at = email.rfind('@');
+  if (at == std::string_view::npos) {
+    return 0;
+  }
+  std::string domain = text::lowercased(text::trimmed(email.substr(at + 1)));
+  if (domain.empty()) {
+    return 0;
+  }
+  for (const char *webmail : kWebmailDomains) {
+    if (domain == webmail) {
+      return 0;
+    }
+  }
+  return attributeKey(kEmailDomain, domain);
+}
+
+uint64_t userKey(std::string_view userId) {
+  return userId.empty() ? 0 : fnv1a64(userId);
+}
+
+bool containsKey(const std::vector<uint64_t> &sorted, uint64_t key) {
+  return key != 0 && std::binary_search(sorted.begin(), sorted.end(), key);
+}
+
+template <typename Pairs>
+auto rangeFor(const Pairs &pairs, uint64_t key) {
+  using Pair = typename Pairs::value_type;
+  return std::equal_range(pairs.begin(), pairs.end(), Pair{key, 0},
+                          [](const Pair &lhs, const Pair &rhs) { return lhs.first < rhs.first; });
+}
+
+std::string personName(const Contact &contact) {
+  std::string name = text::folded(text::trimmed(contact.givenName));
+  std::string family = text::folded(text::trimmed(contact.familyName));
+  if (!name.empty() && !family.empty()) {
+    name.push_back(' ');
+  }
+  return name + family;
+}
+
+} // namespace
+
+LocalSocialGraph::LocalSocialGraph(const std::vector<Contact> &contacts,
+                                   const std::vector<FollowRelationship> &following,
+                                   const std::vector<FollowRelationship> &followers,
+                                   const std::unordered_map<std::string, uint32_t> &interactionCounts,
+                                   SocialGraphOptions options)
+    : options_(std::move(options)) {
+  // Relations name people, not cards, so they are matched by name
+  std::unordered_set<std::string> relationNames;
+  for (const auto &contact : contacts) {
+    for (const auto &relation : contact.relations) {
+      if (!relation.name.empty()) {
+        relationNames.insert(text::folded(text::trimmed(relation.name)));
+      }
+    }
+  }
+
+  std::unordered_map<uint64_t, uint32_t> attributeIds;
+  uint32_t maxInteractions = 0;
+  std::vector<uint32_t> rawInteractions;
+  attributeOffsets_.push_back(0);
+  for (const auto &contact : contacts) {
+    if (contact.isDeleted) {
+      continue;
+    }
+    uint32_t index = static_cast<uint32_t>(contactFlags_.size());
+    uint8_t flags = 0;
+    if (contact.identifier == options_.selfContactId) {
+      flags |= kContactSelf;
+    }
+    if (relationNames.count(personName(contact)) != 0) {
+      flags |= kContactRelation;
+    }
+    contactFlags_.push_back(flags);
+
+    auto interactions = interactionCounts.find(contact.identifier);
+    rawInteractions.push_back(interactions == interactionCounts.end() ? 0 : interactions->second);
+    maxInteractions = std::max(maxInteractions, rawInteractions.back());
+
+    for (const auto &phone : contact.phoneNumbers) {
+      if (uint64_t key = phoneMatchKey(phone.value, options_.defaultCountryCode)) {
+        contactsByKey_.emplace_back(key, index);
+      }
+    }
+
+    size_t firstTarget = attributeTargets_.size();
+    auto addAttribute = [&](uint64_t key) {
+      if (key == 0) {
+        return;
+      }
+      auto inserted = attributeIds.emplace(key, static_cast<uint32_t>(attributeIds.size()));
+      uint32_t attribute = inserted.first->second;
+      if (inserted.second) {
+        attributesByKey_.emplace_back(key, attribute);
+        attributeKinds_.push_back(static_cast<uint8_t>(key >> 62));
+      }
+      if (std::find(attributeTargets_.begin() + static_cast<std::ptrdiff_t>(firstTarget), attributeTargets_.end(),
+                    attribute) == attributeTargets_.end()) {
+        attributeTargets_.push_back(attribute);
+      }
+    };
+    addAttribute(organizationKey(contact.organizationName));
+    for (const auto &email : contact.emailAddresses) {
+      if (uint64_t key = emailMatchKey(email.value)) {
+        contactsByKey_.emplace_back(key, index);
+      }
+      addAttribute(emailDomainKey(email.value));
+    }
+    attributeOffsets_.push_back(static_cast<uint32_t>(attributeTargets_.size()));
+  }
+  std::sort(contactsByKey_.begin(), contactsByKey_.end());
+  contactsByKey_.erase(std::unique(contactsByKey_.begin(), contactsByKey_.end()), contactsByKey_.end());
+  std::sort(attributesByKey_.begin(), attributesByKey_.end());
+
+  contactInteractions_.resize(rawInteractions.size());
+  double scale = maxInteractions == 0 ? 0 : 1.0 / std::log1p(static_cast<double>(maxInteractions));
+  for (size_t i = 0; i < rawInteractions.size(); ++i) {
+    contactInteractions_[i] = static_cast<float>(std::log1p(static_cast<double>(rawInteractions[i])) * scale);
+  }
+
+  // Follow edges name users by ID; the expanded side, when present, also
+  // reaches the contacts that share its phone or email
+  std::vector<uint32_t> matched;
+  auto addFollows = [&](const std::vector<FollowRelationship> &relationships, bool userFollows,
+                        std::vector<uint64_t> &users) {
+    for (const auto &relationship : relationships) {
+      const std::string &otherId = userFollows ? relationship.followedId : relationship.followerId;
+      const CanonicalContact &other = userFollows ? relationship.followed : relationship.follower;
+      for (const std::string *id : {&relationship.userId, &otherId, &other.identifier, &other.organizationUserId}) {
+        if (uint64_t key = userKey(*id)) {
+          users.push_back(key);
+        }
+      }
+      matchedContacts(other, matched);
+      for (uint32_t contact : matched) {
+        contactFlags_[contact] |= userFollows ? kContactFollowed : kContactFollower;
+      }
+    }
+    std::sort(users.begin(), users.end());
+    users.erase(std::unique(users.begin(), users.end()), users.end());
+  };
+  addFollows(following, true, following_);
+  addFollows(followers, false, followers_);
+
+  attributeMembers_.assign(attributeKinds_.size(), 0);
+  attributeEngaged_.assign(attributeKinds_.size(), 0);
+  attributeIsSelf_.assign(attributeKinds_.size(), 0);
+  for (size_t contact = 0; contact < contactFlags_.size(); ++contact) {
+    uint8_t flags = contactFlags_[contact];
+    bool engaged = (flags & (kContactFollowed | kContactFollower)) != 0 || contactInteractions_[contact] > 0;
+    for (uint32_t t = attributeOffsets_[contact]; t < attributeOffsets_[contact + 1]; ++t) {
+      uint32_t attribute = attributeTargets_[t];
+      if (flags & kContactSelf) {
+        attributeIsSelf_[attribute] = 1;
+        continue;
+      }
+      attributeMembers_[attribute]++;
+      attributeEngaged_[attribute] += engaged ? 1 : 0;
+    }
+  }
+}
+
+void LocalSocialGraph::matchedContacts(const CanonicalContact &candidate, std::vector<uint32_t> &out) const {
+  out.clear();
+  for (uint64_t key : {emailMatchKey(candidate.email), phoneMatchKey(candidate.phone, options_.defaultCountryCode)}) {
+    if (key == 0) {
+      continue;
+    }
+    auto range = rangeFor(contactsByKey_, key);
+    for (auto it = range.first; it != range.second; ++it) {
+      if ((contactFlags_[it->second] & kContactSelf) == 0) {
+        out.push_back(it->second);
+      }
+    }
+  }
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+CandidateFeatures LocalSocialGraph::featuresFor(const CanonicalContact &candidate) const {
+  CandidateFeatures features;
+  uint64_t ids[2] = {userKey(candidate.identifier), userKey(candidate.organizationUserId)};
+  for (uint64_t id : ids) {
+    features.alreadyFollowing |= containsKey(following_, id);
+    features.followsYou |= containsKey(followers_, id);
+  }
+
+  // Thread-local scratch keeps rank() free of per-candidate allocations
+  thread_local std::vector<uint32_t> matched;
+  matchedContacts(candidate, matched);
+  features.inAddressBook = !matched.empty();
+
+  auto considerAttribute = [&](uint32_t attribute) {
+    double engaged = attributeEngaged_[attribute] + 0.25 * attributeMembers_[attribute];
+    double affinity = std::min(1.0, std::log2(1.0 + engaged) / std::log2(1.0 + kAffinitySaturation));
+    bool self = attributeIsSelf_[attribute] != 0;
+    if (attributeKinds_[attribute] == kOrganization) {
+      features.sameOrganizationAsYou |= self;
+      features.organizationAffinity = std::max(features.organizationAffinity, affinity);
+    } else {
+      features.sameEmailDomainAsYou |= self;
+      features.domainAffinity = std::max(features.domainAffinity, affinity);
+    }
+  };
+
+  for (uint32_t contact : matched) {
+    uint8_t flags = contactFlags_[contact];
+    features.alreadyFollowing |= (flags & kContactFollowed) != 0;
+    features.followsYou |= (flags & kContactFollower) != 0;
+    features.isRelation |= (flags & kContactRelation) != 0;
+    features.interactions = std::max(features.interactions, static_cast<double>(contactInteractions_[contact]));
+    for (uint32_t t = attributeOffsets_[contact]; t < attributeOffsets_[contact + 1]; ++t) {
+      considerAttribute(attributeTargets_[t]);
+    }
+  }
+  // The candidate's own work address counts even when they are not in the book
+  if (uint64_t domain = emailDomainKey(candidate.email)) {
+    auto range = rangeFor(attributesByKey_, domain);
+    if (range.first != range.second) {
+      considerAttribute(range.first->second);
+    }
+  }
+  return features;
+}
+
+double LocalSocialGraph::scoreFor(const CandidateFeatures &features, size_t rank, size_t count) const {
+  double local = (features.followsYou ? kFollowsYouWeight : 0) + (features.inAddressBook ? kInAddressBookWeight : 0) +
+                 kInteractionsWeight * features.interactions + (features.isRelation ? kRelationWeight : 0) +
+                 kOrganizationWeight *
+                     (features.sameOrganizationAsYou ? 1.0 : kAffinityShare * features.organizationAffinity) +
+                 kDomainWeight * (features.sameEmailDomainAsYou ? 1.0 : kAffinityShare * features.domainAffinity);
+  double prior = count <= 1 ? 1.0 : 1.0 - static_cast<double>(rank) / static_cast<double>(count - 1);
+  double weight = std::min(1.0, std::max(0.0, options_.serverRankWeight));
+  return weight * prior + (1.0 - weight) * local;
+}
+
+std::vector<RankedCandidate> LocalSocialGraph::rank(const std::vector<CanonicalContact> &candidates,
+                                                    size_t limit) const {
+  std::vector<RankedCandidate> ranked;
+  ranked.reserve(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    RankedCandidate candidate;
+    candidate.index = static_cast<uint32_t>(i);
+    candidate.features = featuresFor(candidates[i]);
+    if (candidate.features.alreadyFollowing) {
+      continue;
+    }
+    candidate.score = scoreFor(candidate.features, i, candidates.size());
+    ranked.push_back(candidate);
+  }
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](const RankedCandidate &lhs, const RankedCandidate &rhs) { return lhs.score > rhs.score; });
+  if (ranked.size() > limit) {
+    ranked.resize(limit);
+  }
+  return ranked;
+}
+
+size_t LocalSocialGraph::memoryBytes() const {
+  return contactsByKey_.capacity() * sizeof(KeyIndex::value_type) +
+         attributesByKey_.capacity() * sizeof(KeyIndex::value_type) +
+         (following_.capacity() + followers_.capacity()) * sizeof(uint64_t) + contactFlags_.capacity() +
+         contactInteractions_.capacity() * sizeof(float) +
+         (attributeOffsets_.capacity() + attributeTargets_.capacity() + attributeMembers_.capacity() +
+          attributeEngaged_.capacity()) *
+             sizeof(uint32_t) +
+         attributeKinds_.capacity() + attributeIsSelf_.capacity();
+}
+
+} // namespace contactsmanager
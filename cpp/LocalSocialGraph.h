@@ -0,0 +1,127 @@
+//
+//  LocalSocialGraph.h
+//  ContactsManagerCore
+//
+//  On-device re-ranking of getUsersYouMightKnow candidates with signals the
+//  server never sees: whether a candidate is in the address book, how often
+//  the user is in touch with them, relations, and the organizations and
+//  email domains they share with the user and their contacts.
+//
+//  The graph holds no strings. Contacts and attribute nodes (organization
+//  names, work email domains) are dense indexes linked by CSR adjacency
+//  arrays; phone numbers, email addresses and user IDs are 64-bit hashes in
+//  sorted arrays. Scoring a candidate is a few binary searches and a walk
+//  over its matched contacts' attribute nodes, whose statistics are
+//  precomputed when the graph is built.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "SocialModels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace contactsmanager {
+
+struct SocialGraphOptions {
+  // Calling code for numbers stored without one, 0 for none (see phoneKeyFor)
+  uint16_t defaultCountryCode = 0;
+  // Identifier of the user's own card in the book, empty if unknown
+  std::string selfContactId;
+  // Weight of the server's order against the local signals, in [0, 1]
+  double serverRankWeight = 0.3;
+};
+
+struct CandidateFeatures {
+  bool alreadyFollowing = false;
+  bool followsYou = false;
+  bool inAddressBook = false;
+  // A matched contact is named in a relation on another card
+  bool isRelation = false;
+  bool sameOrganizationAsYou = false;
+  bool sameEmailDomainAsYou = false;
+  // Interactions with the matched contacts, log-scaled to [0, 1] against the book's maximum
+  double interactions = 0;
+  // How strongly the matched contacts' organizations and email domains are
+  // represented among the user's contacts and follows, in [0, 1]
+  double organizationAffinity = 0;
+  double domainAffinity = 0;
+};
+
+struct RankedCandidate {
+  // Index into the server's list
+  uint32_t index = 0;
+  double score = 0;
+  CandidateFeatures features;
+};
+
+class LocalSocialGraph {
+public:
+  /**
+   * @param following Relationships in which the user is the follower
+   * @param followers Relationships in which the user is followed
+   * @param interactionCounts Calls and messages per contact identifier, as far as the app knows them
+   */
+  LocalSocialGraph(const std::vector<Contact> &contacts, const std::vector<FollowRelationship> &following,
+                   const std::vector<FollowRelationship> &followers,
+                   const std::unordered_map<std::string, uint32_t> &interactionCounts = {},
+                   SocialGraphOptions options = {});
+
+  CandidateFeatures featuresFor(const CanonicalContact &candidate) const;
+
+  /**
+   * Local score in [0, 1] of a candidate the server ranked at position rank of count
+   */
+  double scoreFor(const CandidateFeatures &features, size_t rank, size_t count) const;
+
+  /**
+   * Re-ranks the server's candidates, best first; candidates the user
+   * already follows are dropped. Ties keep the server's order.
+   */
+  std::vector<RankedCandidate> rank(const std::vector<CanonicalContact> &candidates,
+                                    size_t limit = std::numeric_limits<size_t>::max()) const;
+
+  size_t contactCount() const { return contactFlags_.size(); }
+  size_t attributeCount() const { return attributeMembers_.size(); }
+
+  /**
+   * Bytes held by the graph's arrays
+   */
+  size_t memoryBytes() const;
+
+private:
+  // (key, node) pairs sorted by key
+  using KeyIndex = std::vector<std::pair<uint64_t, uint32_t>>;
+
+  void matchedContacts(const CanonicalContact &candidate, std::vector<uint32_t> &out) const;
+
+  SocialGraphOptions options_;
+  // Phone and email match keys to contacts, attribute keys to attribute nodes
+  KeyIndex contactsByKey_;
+  KeyIndex attributesByKey_;
+  // Hashed user IDs, sorted
+  std::vector<uint64_t> following_;
+  std::vector<uint64_t> followers_;
+
+  // Per contact: kContact* flags and log-scaled interactions
+  std::vector<uint8_t> contactFlags_;
+  std::vector<float> contactInteractions_;
+  // Contact -> attribute adjacency
+  std::vector<uint32_t> attributeOffsets_;
+  std::vector<uint32_t> attributeTargets_;
+  // Per attribute node: contacts filed under it, how many of them the user
+  // follows or interacts with, and whether it is the user's own
+  std::vector<uint32_t> attributeMembers_;
+  std::vector<uint32_t> attributeEngaged_;
+  std::vector<uint8_t> attributeKinds_;
+  std::vector<uint8_t> attributeIsSelf_;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,230 @@
+//
+//  MutualFollowIndex.cpp
+//  ContactsManagerCore
+//
+
+#include "MutualFollowIndex.h"
+
+#include "ContactHashing.h"
+#include "SortedIntersection.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace contactsmanager {
+
+namespace {
+
+bool insertKey(std::vector<uint64_t> &keys, uint64_t key) {
+  auto position = std::lower_bound(keys.begin(), keys.end(), key);
+  if (position != keys.end() && *position == key) {
+    return false;
+  }
+  keys.insert(position, key);
+  return true;
+}
+
+bool eraseKey(std::vector<uint64_t> &keys, uint64_t key) {
+  auto position = std::lower_bound(keys.begin(), keys.end(), key);
+  if (position == keys.end() || *position != key) {
+    return false;
+  }
+  keys.erase(position);
+  return true;
+}
+
+void sortUnique(std::vector<uint64_t> &keys) {
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+// The follow time is copied next to the pointer so sorting does not chase it
+struct PageEntry {
+  double createdAt;
+  const FollowRelationship *relationship;
+};
+
+bool newerFollow(const PageEntry &lhs, const PageEntry &rhs) {
+  if (lhs.createdAt != rhs.createdAt) {
+    return lhs.createdAt > rhs.createdAt;
+  }
+  return lhs.relationship->identifier > rhs.relationship->identifier;
+}
+
+} // namespace
+
+uint64_t mutualUserKey(std::string_view userId) {
+  return fnv1a64(userId);
+}
+
+uint64_t followingUserKey(const FollowRelationship &relationship) {
+  const std::string &organizationUserId = relationship.followed.organizationUserId;
+  return mutualUserKey(organizationUserId.empty() ? relationship.userId : organizationUserId);
+}
+
+uint64_t followerUserKey(const FollowRelationship &relationship) {
+  const std::string &organizationUserId = relationship.follower.organizationUserId;
+  return mutualUserKey(organizationUserId.empty() ? relationship.userId : organizationUserId);
+}
+
+void MutualFollowIndex::setFollowing(std::vector<FollowRelationship> following) {
+  std::vector<std::pair<uint64_t, uint32_t>> order;
+  order.reserve(following.size());
+  for (size_t i = 0; i < following.size(); ++i) {
+    order.emplace_back(followingUserKey(following[i]), static_cast<uint32_t>(i));
+  }
+  // A user listed twice keeps the first relationship
+  std::sort(order.begin(), order.end());
+  std::vector<uint64_t> keys;
+  std::vector<std::unique_ptr<FollowRelationship>> relationships;
+  keys.reserve(order.size());
+  relationships.reserve(order.size());
+  for (const auto &entry : order) {
+    if (!keys.empty() && keys.back() == entry.first) {
+      continue;
+    }
+    keys.push_back(entry.first);
+    relationships.push_back(std::make_unique<FollowRelationship>(std::move(following[entry.second])));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  followingKeys_ = std::move(keys);
+  following_ = std::move(relationships);
+  invalidateLocked();
+}
+
+void MutualFollowIndex::setFollowers(const std::vector<FollowRelationship> &followers) {
+  std::vector<uint64_t> keys;
+  keys.reserve(followers.size());
+  for (const FollowRelationship &relationship : followers) {
+    keys.push_back(followerUserKey(relationship));
+  }
+  sortUnique(keys);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  followerKeys_ = std::move(keys);
+  invalidateLocked();
+}
+
+bool MutualFollowIndex::addFollowing(FollowRelationship relationship) {
+  uint64_t key = followingUserKey(relationship);
+  std::lock_guard<std::mutex> lock(mutex_);
+  invalidateLocked();
+  auto position = std::lower_bound(followingKeys_.begin(), followingKeys_.end(), key);
+  size_t index = static_cast<size_t>(position - followingKeys_.begin());
+  if (position != followingKeys_.end() && *position == key) {
+    // Refreshed in place; its place in the pages can still change
+    *following_[index] = std::move(relationship);
+    return false;
+  }
+  followingKeys_.insert(position, key);
+  following_.insert(following_.begin() + static_cast<std::ptrdiff_t>(index),
+                    std::make_unique<FollowRelationship>(std::move(relationship)));
+  return true;
+}
+
+bool MutualFollowIndex::removeFollowing(uint64_t userKey) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto position = std::lower_bound(followingKeys_.begin(), followingKeys_.end(), userKey);
+  if (position == followingKeys_.end() || *position != userKey) {
+    return false;
+  }
+  following_.erase(following_.begin() + (position - followingKeys_.begin()));
+  followingKeys_.erase(position);
+  invalidateLocked();
+  return true;
+}
+
+bool MutualFollowIndex::addFollower(const FollowRelationship &relationship) {
+  uint64_t key = followerUserKey(relationship);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!insertKey(followerKeys_, key)) {
+    return false;
+  }
+  invalidateLocked();
+  return true;
+}
+
+bool MutualFollowIndex::removeFollower(uint64_t userKey) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!eraseKey(followerKeys_, userKey)) {
+    return false;
+  }
+  invalidateLocked();
+  return true;
+}
+
+size_t MutualFollowIndex::mutualCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!countValid_) {
+    count_ = intersectSorted(followingKeys_.data(), followingKeys_.size(), followerKeys_.data(),
+                             followerKeys_.size(), nullptr);
+    countValid_ = true;
+  }
+  return count_;
+}
+
+bool MutualFollowIndex::isMutual(uint64_t userKey) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::binary_search(followingKeys_.begin(), followingKeys_.end(), userKey) &&
+         std::binary_search(followerKeys_.begin(), followerKeys_.end(), userKey);
+}
+
+std::vector<FollowRelationship> MutualFollowIndex::mutualPage(size_t skip, size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  orderLocked();
+  std::vector<FollowRelationship> page;
+  for (size_t i = skip; i < mutual_.size() && page.size() < limit; ++i) {
+    page.push_back(*mutual_[i]);
+  }
+  return page;
+}
+
+size_t MutualFollowIndex::followingCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return followingKeys_.size();
+}
+
+size_t MutualFollowIndex::followerCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return followerKeys_.size();
+}
+
+size_t MutualFollowIndex::memoryBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (followingKeys_.capacity() + followerKeys_.capacity()) * sizeof(uint64_t) +
+         following_.capacity() * sizeof(std::unique_ptr<FollowRelationship>) +
+         mutual_.capacity() * sizeof(const FollowRelationship *);
+}
+
+void MutualFollowIndex::orderLocked() {
+  if (orderValid_) {
+    return;
+  }
+  std::vector<uint32_t> positions(std::min(followingKeys_.size(), followerKeys_.size()));
+  size_t count = intersectSorted(followingKeys_.data(), followingKeys_.size(), followerKeys_.data(),
+                                 followerKeys_.size(), positions.data());
+  std::vector<PageEntry> entries;
+  entries.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const FollowRelationship *relationship = following_[positions[i]].get();
+    entries.push_back(PageEntry{relationship->createdAt, relationship});
+  }
+  std::sort(entries.begin(), entries.end(), newerFollow);
+  mutual_.clear();
+  mutual_.reserve(count);
+  for (const PageEntry &entry : entries) {
+    mutual_.push_back(entry.relationship);
+  }
+  count_ = count;
+  countValid_ = true;
+  orderValid_ = true;
+}
+
+void MutualFollowIndex::invalidateLocked() {
+  countValid_ = false;
+  orderValid_ = false;
+  mutual_.clear();
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,97 @@
+//
+//  MutualFollowIndex.h
+//  ContactsManagerCore
+//
+//  Mutual follows computed on the device from the cached followers and
+//  following lists instead of paged from getMutualFollowsWithSkip. Each
+//  list is kept as a sorted array of user keys; the mutual set is their
+//  intersection (see SortedIntersection.h), recomputed only after a list
+//  changed, so counts and pages agree with the lists already shown.
+//
+//  A user's key is the hash of the other side's organizationUserId when the
+//  server expanded it, else of the relationship's userId; both lists must
+//  come from the same server so the same user gets the same key in each.
+//
+
+#pragma once
+
+#include "SocialModels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace contactsmanager {
+
+/**
+ * Key of the user on the other side of a relationship from the following list
+ */
+uint64_t followingUserKey(const FollowRelationship &relationship);
+
+/**
+ * Key of the user on the other side of a relationship from the followers list
+ */
+uint64_t followerUserKey(const FollowRelationship &relationship);
+
+/**
+ * Key of a user from an organizationUserId or userId
+ */
+uint64_t mutualUserKey(std::string_view userId);
+
+class MutualFollowIndex {
+public:
+  MutualFollowIndex() = default;
+
+  MutualFollowIndex(const MutualFollowIndex &) = delete;
+  MutualFollowIndex &operator=(const MutualFollowIndex &) = delete;
+
+  void setFollowing(std::vector<FollowRelationship> following);
+  void setFollowers(const std::vector<FollowRelationship> &followers);
+
+  /**
+   * @return true if the list changed
+   */
+  bool addFollowing(FollowRelationship relationship);
+  bool removeFollowing(uint64_t userKey);
+  bool addFollower(const FollowRelationship &relationship);
+  bool removeFollower(uint64_t userKey);
+
+  size_t mutualCount();
+  bool isMutual(uint64_t userKey) const;
+
+  /**
+   * Mutual follows newest first by follow time (createdAt, then identifier),
+   * as relationships from the following list
+   */
+  std::vector<FollowRelationship> mutualPage(size_t skip, size_t limit);
+
+  size_t followingCount() const;
+  size_t followerCount() const;
+
+  /**
+   * Key arrays, relationship pointers and cached results; the relationships themselves are not counted
+   */
+  size_t memoryBytes() const;
+
+private:
+  void orderLocked();
+  void invalidateLocked();
+
+  mutable std::mutex mutex_;
+  // Sorted, unique
+  std::vector<uint64_t> followingKeys_;
+  std::vector<uint64_t> followerKeys_;
+  // Relationship of each following key, at the same index; boxed so inserts move pointers only
+  std::vector<std::unique_ptr<FollowRelationship>> following_;
+
+  // Counting needs only the intersection; pages also sort it, once per change
+  bool countValid_ = false;
+  size_t count_ = 0;
+  bool orderValid_ = false;
+  std::vector<const FollowRelationship *> mutual_;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,526 @@
+//
+//  PhoneNumberKey.cpp
+//  ContactsManagerCore
+//
+
+#include "PhoneNumberKey.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+
+// The vector scan needs a byte shuffle: SSSE3 pshufb or AArch64 tbl
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define CM_PHONE_KEY_SSSE3 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CM_PHONE_KEY_NEON 1
+#endif
+
+namespace contactsmanager {
+
+namespace {
+
+// Room for an "00" international prefix and a trunk "0" on top of 15 digits
+constexpr size_t kMaxRawDigits = PhoneKey::kMaxDigits + 2;
+// Shortest national number matched against the tail of an international one
+constexpr size_t kMinSuffixDigits = 7;
+constexpr size_t kMaxCountryCodeDigits = 3;
+
+struct RegionCallingCode {
+  char region[3];
+  uint16_t callingCode;
+};
+
+// ISO 3166-1 regions in code order
+constexpr RegionCallingCode kRegionCallingCodes[] = {
+    {"AD", 376}, {"AE", 971}, {"AF", 93}, {"AG", 1}, {"AI", 1}, {"AL", 355}, {"AM", 374}, {"AO", 244}, {"AR", 54},
+    {"AS", 1}, {"AT", 43}, {"AU", 61}, {"AW", 297}, {"AX", 358}, {"AZ", 994},
+    {"BA", 387}, {"BB", 1}, {"BD", 880}, {"BE", 32}, {"BF", 226}, {"BG", 359}, {"BH", 973}, {"BI", 257}, {"BJ", 229},
+    {"BL", 590}, {"BM", 1}, {"BN", 673}, {"BO", 591}, {"BQ", 599}, {"BR", 55}, {"BS", 1}, {"BT", 975}, {"BW", 267},
+    {"BY", 375}, {"BZ", 501},
+    {"CA", 1}, {"CC", 61}, {"CD", 243}, {"CF", 236}, {"CG", 242}, {"CH", 41}, {"CI", 225}, {"CK", 682}, {"CL", 56},
+    {"CM", 237}, {"CN", 86}, {"CO", 57}, {"CR", 506}, {"CU", 53}, {"CV", 238}, {"CW", 599}, {"CX", 61}, {"CY", 357},
+    {"CZ", 420},
+    {"DE", 49}, {"DJ", 253}, {"DK", 45}, {"DM", 1}, {"DO", 1}, {"DZ", 213},
+    {"EC", 593}, {"EE", 372}, {"EG", 20}, {"EH", 212}, {"ER", 291}, {"ES", 34}, {"ET", 251},
+    {"FI", 358}, {"FJ", 679}, {"FK", 500}, {"FM", 691}, {"FO", 298}, {"FR", 33},
+    {"GA", 241}, {"GB", 44}, {"GD", 1}, {"GE", 995}, {"GF", 594}, {"GG", 44}, {"GH", 233}, {"GI", 350}, {"GL", 299},
+    {"GM", 220}, {"GN", 224}, {"GP", 590}, {"GQ", 240}, {"GR", 30}, {"GT", 502}, {"GU", 1}, {"GW", 245}, {"GY", 592},
+    {"HK", 852}, {"HN", 504}, {"HR", 385}, {"HT", 509}, {"HU", 36},
+    {"ID", 62}, {"IE", 353}, {"IL", 972}, {"IM", 44}, {"IN", 91}, {"IO", 246}, {"IQ", 964}, {"IR", 98}, {"IS", 354},
+    {"IT", 39},
+    {"JE", 44}, {"JM", 1}, {"JO", 962}, {"JP", 81},
+    {"KE", 254}, {"KG", 996}, {"KH", 855}, {"KI", 686}, {"KM", 269}, {"KN", 1}, {"KP", 850}, {"KR", 82}, {"KW", 965},
+    {"KY", 1}, {"KZ", 7},
+    {"LA", 856}, {"LB", 961}, {"LC", 1}, {"LI", 423}, {"LK", 94}, {"LR", 231}, {"LS", 266}, {"LT", 370}, {"LU", 352},
+    {"LV", 371}, {"LY", 218},
+    {"MA", 212}, {"MC", 377}, {"MD", 373}, {"ME", 382}, {"MF", 590}, {"MG", 261}, {"MH", 692}, {"MK", 389},
+    {"ML", 223}, {"MM", 95}, {"MN", 976}, {"MO", 853}, {"MP", 1}, {"MQ", 596}, {"MR", 222}, {"MS", 1}, {"MT", 356},
+    {"MU", 230}, {"MV", 960}, {"MW", 265}, {"MX", 52}, {"MY", 60}, {"MZ", 258},
+    {"NA", 264}, {"NC", 687}, {"NE", 227}, {"NF", 672}, {"NG", 234}, {"NI", 505}, {"NL", 31}, {"NO", 47}, {"NP", 977},
+    {"NR", 674}, {"NU", 683}, {"NZ", 64},
+    {"OM", 968},
+    {"PA", 507}, {"PE", 51}, {"PF", 689}, {"PG", 675}, {"PH", 63}, {"PK", 92}, {"PL", 48}, {"PM", 508}, {"PR", 1},
+    {"PS", 970}, {"PT", 351}, {"PW", 680}, {"PY", 595},
+    {"QA", 974},
+    {"RE", 262}, {"RO", 40}, {"RS", 381}, {"RU", 7}, {"RW", 250},
+    {"SA", 966}, {"SB", 677}, {"SC", 248}, {"SD", 249}, {"SE", 46}, {"SG", 65}, {"SH", 290}, {"SI", 386}, {"SJ", 47},
+    {"SK", 421}, {"SL", 232}, {"SM", 378}, {"SN", 221}, {"SO", 252}, {"SR", 597}, {"SS", 211}, {"ST", 239},
+    {"SV", 503}, {"SX", 1}, {"SY", 963}, {"SZ", 268},
+    {"TC", 1}, {"TD", 235}, {"TG", 228}, {"TH", 66}, {"TJ", 992}, {"TK", 690}, {"TL", 670}, {"TM", 993}, {"TN", 216},
+    {"TO", 676}, {"TR", 90}, {"TT", 1}, {"TV", 688}, {"TW", 886}, {"TZ", 255},
+    {"UA", 380}, {"UG", 256}, {"US", 1}, {"UY", 598}, {"UZ", 998},
+    {"VA", 39}, {"VC", 1}, {"VE", 58}, {"VG", 1}, {"VI", 1}, {"VN", 84}, {"VU", 678},
+    {"WF", 681}, {"WS", 685},
+    {"XK", 383},
+    {"YE", 967}, {"YT", 262},
+    {"ZA", 27}, {"ZM", 260}, {"ZW", 263}
+};
+
+std::atomic<uint16_t> defaultCallingCodeValue{0};
+
+constexpr uint64_t kPowersOfTen[] = {1ULL,
+                                     10ULL,
+                                     100ULL,
+                                     1000ULL,
+                                     10000ULL,
+                                     100000ULL,
+                                     1000000ULL,
+                                     10000000ULL,
+                                     100000000ULL,
+                                     1000000000ULL,
+                                     10000000000ULL,
+                                     100000000000ULL,
+                                     1000000000000ULL,
+                                     10000000000000ULL,
+                                     100000000000000ULL,
+                                     1000000000000000ULL,
+                                     10000000000000000ULL,
+                                     100000000000000000ULL};
+
+size_t decimalLength(uint64_t value) {
+  size_t length = 0;
+  while (length < kMaxRawDigits && value >= kPowersOfTen[length]) {
+    length++;
+  }
+  return length;
+}
+
+enum class ByteClass : uint8_t { Digit, Formatting, Extension, Invalid };
+
+ByteClass classify(unsigned char c) {
+  if (c >= '0' && c <= '9') {
+    return ByteClass::Digit;
+  }
+  if (c >= 0x80) {
+    return ByteClass::Formatting;
+  }
+  switch (c) {
+  case ' ':
+  case '\t':
+  case '-':
+  case '.':
+  case '(':
+  case ')':
+  case '/':
+    return ByteClass::Formatting;
+  case 'x':
+  case 'X':
+  case 'e':
+  case 'E':
+  case ',':
+  case ';':
+  case '#':
+    return ByteClass::Extension;
+  default:
+    return ByteClass::Invalid;
+  }
+}
+
+// Leading zero digits of the number, counting at most three
+size_t leadingZeroDigits(const unsigned char *p, const unsigned char *end) {
+  size_t zeros = 0;
+  for (; p < end && zeros < 3; ++p) {
+    ByteClass byteClass = classify(*p);
+    if (byteClass == ByteClass::Digit && *p == '0') {
+      zeros++;
+    } else if (byteClass != ByteClass::Formatting) {
+      break;
+    }
+  }
+  return zeros;
+}
+
+struct DigitScan {
+  uint64_t value = 0;
+  size_t length = 0;
+  bool invalid = false;
+};
+
+// Scans the bytes one at a time; returns false once the number has ended.
+// The digits accumulate in locals: stores through scan could alias the input.
+bool scanScalar(const unsigned char *p, const unsigned char *end, DigitScan &scan) {
+  uint64_t value = scan.value;
+  size_t length = scan.length;
+  bool more = true;
+  for (; p < end && more; ++p) {
+    switch (classify(*p)) {
+    case ByteClass::Digit:
+      if (length == kMaxRawDigits) {
+        scan.invalid = true;
+        more = false;
+        break;
+      }
+      value = value * 10 + (*p - '0');
+      length++;
+      break;
+    case ByteClass::Formatting:
+      break;
+    case ByteClass::Extension:
+      more = false;
+      break;
+    case ByteClass::Invalid:
+      scan.invalid = true;
+      more = false;
+      break;
+    }
+  }
+  scan.value = value;
+  scan.length = length;
+  return more;
+}
+
+#if defined(CM_PHONE_KEY_SSSE3) || defined(CM_PHONE_KEY_NEON)
+
+constexpr size_t kBlockSize = 16;
+
+// For each 8-bit digit mask, the shuffle that packs those bytes to the end of
+// an 8-byte lane; 0x80 selects zero
+struct CompactionTable {
+  unsigned char indices[256][8];
+};
+
+constexpr CompactionTable makeCompactionTable() {
+  CompactionTable table{};
+  for (unsigned mask = 0; mask < 256; ++mask) {
+    unsigned count = 0;
+    for (unsigned bit = 0; bit < 8; ++bit) {
+      count += (mask >> bit) & 1;
+    }
+    unsigned slot = 0;
+    for (; slot < 8 - count; ++slot) {
+      table.indices[mask][slot] = 0x80;
+    }
+    for (unsigned bit = 0; bit < 8; ++bit) {
+      if ((mask >> bit) & 1) {
+        table.indices[mask][slot++] = static_cast<unsigned char>(bit);
+      }
+    }
+  }
+  return table;
+}
+
+constexpr CompactionTable kCompaction = makeCompactionTable();
+
+// The first available bytes of p followed by spaces, as two little-endian
+// words. Overlapping loads keep short numbers in registers without reading
+// past the input.
+void loadPaddedWords(const unsigned char *p, size_t available, uint64_t &low, uint64_t &high) {
+  constexpr uint64_t kSpaces = 0x2020202020202020ULL;
+  if (available >= 8) {
+    std::memcpy(&low, p, 8);
+    uint64_t tail;
+    std::memcpy(&tail, p + available - 8, 8);
+    size_t extra = available - 8;
+    high = extra == 0 ? kSpaces : (tail >> (8 * (8 - extra))) | (kSpaces << (8 * extra));
+  } else {
+    high = kSpaces;
+    low = kSpaces;
+    for (size_t i = 0; i < available; ++i) {
+      low = (low & ~(0xFFULL << (8 * i))) | (static_cast<uint64_t>(p[i]) << (8 * i));
+    }
+  }
+}
+
+// Shuffle for a 16-bit digit mask: each half packs its digits to its own end
+uint64_t compactionIndices(uint32_t mask, uint64_t &high) {
+  uint64_t low;
+  std::memcpy(&low, kCompaction.indices[mask & 0xFF], 8);
+  std::memcpy(&high, kCompaction.indices[(mask >> 8) & 0xFF], 8);
+  // Point the upper half at bytes 8-15; 0x80 + 8 still selects zero
+  high += 0x0808080808080808ULL;
+  return low;
+}
+
+#if defined(CM_PHONE_KEY_SSSE3)
+
+__m128i loadBlock(const unsigned char *p, size_t available) {
+  if (available >= kBlockSize) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  }
+  uint64_t low;
+  uint64_t high;
+  loadPaddedWords(p, available, low, high);
+  return _mm_set_epi64x(static_cast<long long>(high), static_cast<long long>(low));
+}
+
+// Digit and formatting masks of sixteen bytes
+void classifyBlock(__m128i v, uint32_t &digits, uint32_t &formatting) {
+  // Signed compares: bytes >= 0x80 are negative and never digits
+  __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+  __m128i format = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+  format = _mm_or_si128(format, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('.')), _mm_cmpeq_epi8(v, _mm_set1_epi8('/'))));
+  format = _mm_or_si128(format, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('(')), _mm_cmpeq_epi8(v, _mm_set1_epi8(')'))));
+  format = _mm_or_si128(format, _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+  digits = static_cast<uint32_t>(_mm_movemask_epi8(digit));
+  // The sign bit marks non-ASCII bytes
+  formatting = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(format, v)));
+}
+
+// Packs the digits selected by mask and returns each half as an integer
+void convertDigits(__m128i v, uint32_t mask, uint64_t &first, uint64_t &second) {
+  uint64_t high;
+  uint64_t low = compactionIndices(mask, high);
+  __m128i shuffle = _mm_set_epi64x(static_cast<long long>(high), static_cast<long long>(low));
+  __m128i packed = _mm_shuffle_epi8(_mm_sub_epi8(v, _mm_set1_epi8('0')), shuffle);
+  // Pairs of digits, then groups of four, then of eight
+  __m128i pairs = _mm_maddubs_epi16(packed, _mm_set1_epi16(0x010A));
+  __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(100 | (1 << 16)));
+  __m128i narrowed = _mm_packs_epi32(quads, quads);
+  __m128i octets = _mm_madd_epi16(narrowed, _mm_set1_epi32(10000 | (1 << 16)));
+  first = static_cast<uint32_t>(_mm_cvtsi128_si32(octets));
+  second = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(octets, 4)));
+}
+
+#else
+
+uint8x16_t loadBlock(const unsigned char *p, size_t available) {
+  if (available >= kBlockSize) {
+    return vld1q_u8(p);
+  }
+  uint64_t low;
+  uint64_t high;
+  loadPaddedWords(p, available, low, high);
+  return vcombine_u8(vcreate_u8(low), vcreate_u8(high));
+}
+
+uint32_t movemask(uint8x16_t mask) {
+  const uint8x16_t weights = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t bits = vandq_u8(mask, weights);
+  return static_cast<uint32_t>(vaddv_u8(vget_low_u8(bits))) | (static_cast<uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+
+// Digit and formatting masks of sixteen bytes
+void classifyBlock(uint8x16_t v, uint32_t &digits, uint32_t &formatting) {
+  uint8x16_t digit = vcltq_u8(vsubq_u8(v, vdupq_n_u8('0')), vdupq_n_u8(10));
+  uint8x16_t format = vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('-')));
+  format = vorrq_u8(format, vorrq_u8(vceqq_u8(v, vdupq_n_u8('.')), vceqq_u8(v, vdupq_n_u8('/'))));
+  format = vorrq_u8(format, vorrq_u8(vceqq_u8(v, vdupq_n_u8('(')), vceqq_u8(v, vdupq_n_u8(')'))));
+  format = vorrq_u8(format, vorrq_u8(vceqq_u8(v, vdupq_n_u8('\t')), vcgeq_u8(v, vdupq_n_u8(0x80))));
+  digits = movemask(digit);
+  formatting = movemask(format);
+}
+
+// Packs the digits selected by mask and returns each half as an integer
+void convertDigits(uint8x16_t v, uint32_t mask, uint64_t &first, uint64_t &second) {
+  uint64_t high;
+  uint64_t low = compactionIndices(mask, high);
+  uint8x16_t shuffle = vcombine_u8(vcreate_u8(low), vcreate_u8(high));
+  uint16x8_t packed = vreinterpretq_u16_u8(vqtbl1q_u8(vsubq_u8(v, vdupq_n_u8('0')), shuffle));
+  // Pairs of digits, then groups of four, then of eight
+  uint16x8_t pairs = vmlaq_n_u16(vshrq_n_u16(packed, 8), vandq_u16(packed, vdupq_n_u16(0x00FF)), 10);
+  uint32x4_t wide = vreinterpretq_u32_u16(pairs);
+  uint32x4_t quads = vmlaq_n_u32(vshrq_n_u32(wide, 16), vandq_u32(wide, vdupq_n_u32(0xFFFF)), 100);
+  uint64x2_t wider = vreinterpretq_u64_u32(quads);
+  uint32x2_t octets = vmla_n_u32(vshrn_n_u64(wider, 32), vmovn_u64(wider), 10000);
+  first = vget_lane_u32(octets, 0);
+  second = vget_lane_u32(octets, 1);
+}
+
+#endif
+
+// Takes the digits of one block of kBlockSize bytes, the first available of
+// which are input; returns the offset of the first byte that is neither a
+// digit nor formatting, or kBlockSize
+size_t scanBlock(const unsigned char *p, size_t available, DigitScan &scan) {
+  auto v = loadBlock(p, available);
+  uint32_t digits;
+  uint32_t formatting;
+  classifyBlock(v, digits, formatting);
+  uint32_t other = ~(digits | formatting) & 0xFFFF;
+  size_t stop = kBlockSize;
+  if (other != 0) {
+    // Only the digits before the first unexpected byte belong to this pass
+    stop = static_cast<size_t>(__builtin_ctz(other));
+    digits &= (1u << stop) - 1;
+  }
+  size_t count = static_cast<size_t>(__builtin_popcount(digits));
+  if (scan.length + count > kMaxRawDigits) {
+    scan.invalid = true;
+    return 0;
+  }
+
+  uint64_t first;
+  uint64_t second;
+  convertDigits(v, digits, first, second);
+  size_t secondCount = static_cast<size_t>(__builtin_popcount(digits >> 8));
+  scan.value = (scan.value * kPowersOfTen[count - secondCount] + first) * kPowersOfTen[secondCount] + second;
+  scan.length += count;
+  return stop;
+}
+
+// Classifies sixteen bytes at a time, packs the digits with one shuffle and
+// converts them with three multiply-adds instead of a dependent step per
+// digit. The tail is padded with spaces so short numbers take the vector path
+// too; a block with an extension marker or a stray byte hands over to the
+// byte loop.
+bool scanVectorized(const unsigned char *p, const unsigned char *end, DigitScan &scan) {
+  while (p < end) {
+    size_t available = static_cast<size_t>(end - p);
+    size_t stop = scanBlock(p, available, scan);
+    if (scan.invalid) {
+      return false;
+    }
+    if (stop < kBlockSize) {
+      return scanScalar(p + stop, end, scan);
+    }
+    p += std::min(available, kBlockSize);
+  }
+  return true;
+}
+
+#endif
+
+template <bool Vectorized>
+PhoneKey normalize(std::string_view value, uint16_t defaultCountryCode) {
+  const auto *p = reinterpret_cast<const unsigned char *>(value.data());
+  const auto *end = p + value.size();
+
+  // Formatting and a "+" may precede the first digit
+  bool international = false;
+  for (; p < end; ++p) {
+    if (*p == '+' && !international) {
+      international = true;
+    } else if (classify(*p) != ByteClass::Formatting) {
+      break;
+    }
+  }
+
+  size_t leadingZeros = p < end && *p == '0' ? leadingZeroDigits(p, end) : 0;
+  DigitScan scan;
+#if defined(CM_PHONE_KEY_SSSE3) || defined(CM_PHONE_KEY_NEON)
+  if (Vectorized) {
+    scanVectorized(p, end, scan);
+  } else {
+    scanScalar(p, end, scan);
+  }
+#else
+  scanScalar(p, end, scan);
+#endif
+  if (scan.invalid || scan.length == 0) {
+    return PhoneKey();
+  }
+
+  size_t length = scan.length;
+  leadingZeros = std::min(leadingZeros, length);
+  if (international) {
+    // Country codes never start with 0
+    if (leadingZeros > 0) {
+      return PhoneKey();
+    }
+  } else if (leadingZeros >= 2) {
+    // "00" is the international call prefix
+    length -= 2;
+    international = true;
+    if (leadingZeros > 2) {
+      return PhoneKey();
+    }
+  } else {
+    // Trunk prefix
+    length -= leadingZeros;
+    if (length == 0) {
+      return PhoneKey();
+    }
+    if (defaultCountryCode != 0) {
+      bool hasCountryCode = defaultCountryCode == 1 && length == 11 && scan.value / kPowersOfTen[10] == 1;
+      if (!hasCountryCode) {
+        size_t codeLength = decimalLength(defaultCountryCode);
+        if (length + codeLength > PhoneKey::kMaxDigits) {
+          return PhoneKey();
+        }
+        scan.value += defaultCountryCode * kPowersOfTen[length];
+        length += codeLength;
+      }
+      international = true;
+    }
+  }
+
+  if (length == 0 || length > PhoneKey::kMaxDigits) {
+    return PhoneKey();
+  }
+  return PhoneKey(scan.value, length, international);
+}
+
+} // namespace
+
+PhoneKey phoneKeyFor(std::string_view value, uint16_t defaultCountryCode) {
+  return normalize<true>(value, defaultCountryCode);
+}
+
+PhoneKey phoneKeyForScalar(std::string_view value, uint16_t defaultCountryCode) {
+  return normalize<false>(value, defaultCountryCode);
+}
+
+bool phoneKeysMatch(PhoneKey lhs, PhoneKey rhs) {
+  if (!lhs.valid() || !rhs.valid()) {
+    return false;
+  }
+  if (lhs == rhs) {
+    return true;
+  }
+  if (lhs.international() == rhs.international()) {
+    return false;
+  }
+  PhoneKey national = lhs.international() ? rhs : lhs;
+  PhoneKey international = lhs.international() ? lhs : rhs;
+  size_t length = national.length();
+  if (length < kMinSuffixDigits || international.length() <= length ||
+      international.length() - length > kMaxCountryCodeDigits) {
+    return false;
+  }
+  return international.digits() % kPowersOfTen[length] == national.digits();
+}
+
+uint16_t callingCodeForRegion(std::string_view region) {
+  if (region.size() != 2) {
+    return 0;
+  }
+  char code[3] = {static_cast<char>(region[0] & ~0x20), static_cast<char>(region[1] & ~0x20), '\0'};
+  auto entry = std::lower_bound(std::begin(kRegionCallingCodes), std::end(kRegionCallingCodes), code,
+                                [](const RegionCallingCode &lhs, const char *rhs) {
+                                  return std::strcmp(lhs.region, rhs) < 0;
+                                });
+  return entry != std::end(kRegionCallingCodes) && std::strcmp(entry->region, code) == 0 ? entry->callingCode : 0;
+}
+
+void setDefaultCallingCode(uint16_t callingCode) {
+  defaultCallingCodeValue.store(callingCode, std::memory_order_relaxed);
+}
+
+uint16_t defaultCallingCode() {
+  return defaultCallingCodeValue.load(std::memory_order_relaxed);
+}
+
+bool phoneNumbersEqual(std::string_view lhs, std::string_view rhs, uint16_t defaultCountryCode) {
+  PhoneKey lhsKey = phoneKeyFor(lhs, defaultCountryCode);
+  PhoneKey rhsKey = phoneKeyFor(rhs, defaultCountryCode);
+  if (!lhsKey.valid() || !rhsKey.valid()) {
+    return lhs == rhs;
+  }
+  return lhsKey == rhsKey;
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,122 @@
+//
+//  PhoneNumberKey.h
+//  ContactsManagerCore
+//
+//  Formatting-independent phone number keys. A phone value is reduced to its
+//  digits ("+1 (555) 123-4567" and "+15551234567" give the same key) and
+//  packed with its digit count and whether it carried a country code into one
+//  64-bit integer, so comparing, hashing and deduplicating numbers never
+//  touches the original strings again.
+//
+//  The digit scan is vectorized with NEON on arm64 and SSSE3 on x86 hosts and
+//  falls back to a byte loop elsewhere; both produce identical keys.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace contactsmanager {
+
+/**
+ * Normalized phone number: the digits of the E.164 number (or of the national
+ * number when no country code is known) as a decimal integer, plus the digit
+ * count and an international flag. A zero key is "not a phone number".
+ */
+class PhoneKey {
+public:
+  // E.164 numbers have at most 15 digits
+  static constexpr size_t kMaxDigits = 15;
+
+  constexpr PhoneKey() = default;
+  constexpr PhoneKey(uint64_t digits, size_t length, bool international)
+      : bits_((digits & kDigitsMask) | (static_cast<uint64_t>(length) << kLengthShift) |
+              (international ? kInternationalBit : 0)) {}
+
+  static constexpr PhoneKey fromBits(uint64_t bits) {
+    PhoneKey key;
+    key.bits_ = bits;
+    return key;
+  }
+
+  constexpr bool valid() const { return bits_ != 0; }
+  constexpr uint64_t digits() const { return bits_ & kDigitsMask; }
+  constexpr size_t length() const { return static_cast<size_t>((bits_ >> kLengthShift) & 0xF); }
+  constexpr bool international() const { return (bits_ & kInternationalBit) != 0; }
+
+  /**
+   * The packed key; equal numbers have equal bits
+   */
+  constexpr uint64_t bits() const { return bits_; }
+
+  friend constexpr bool operator==(PhoneKey lhs, PhoneKey rhs) { return lhs.bits_ == rhs.bits_; }
+  friend constexpr bool operator!=(PhoneKey lhs, PhoneKey rhs) { return lhs.bits_ != rhs.bits_; }
+
+private:
+  // 10^15 < 2^50
+  static constexpr uint64_t kDigitsMask = (1ULL << 50) - 1;
+  static constexpr unsigned kLengthShift = 50;
+  static constexpr uint64_t kInternationalBit = 1ULL << 54;
+
+  uint64_t bits_ = 0;
+};
+
+struct PhoneKeyHash {
+  size_t operator()(PhoneKey key) const {
+    uint64_t bits = key.bits() * 0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t>(bits ^ (bits >> 32));
+  }
+};
+
+/**
+ * Normalizes a phone value to its key.
+ *
+ * Spaces, "-", ".", "(", ")", "/" and non-ASCII bytes (no-break spaces,
+ * dashes, direction marks) are formatting. A leading "+" or "00" marks an
+ * international number; otherwise a single trunk "0" is dropped and, when
+ * defaultCountryCode is set, the number is made international with it
+ * (NANP numbers that already start with the country code "1" are kept). An
+ * extension ("x", "ext", ",", ";", "#") ends the number. Any other letter, or
+ * more than 15 digits, gives an invalid key.
+ *
+ * @param defaultCountryCode Calling code for numbers without one, 0 for none
+ */
+PhoneKey phoneKeyFor(std::string_view value, uint16_t defaultCountryCode = 0);
+
+/**
+ * Same as phoneKeyFor without the vectorized scan, for tests and benchmarks
+ */
+PhoneKey phoneKeyForScalar(std::string_view value, uint16_t defaultCountryCode = 0);
+
+/**
+ * True when the keys denote the same number: equal keys, or a national key
+ * of at least seven digits that is the tail of an international key after a
+ * one to three digit country code
+ */
+bool phoneKeysMatch(PhoneKey lhs, PhoneKey rhs);
+
+/**
+ * Calling code of an ISO 3166-1 alpha-2 region ("US" is 1, "GB" is 44), 0 for
+ * an unknown region
+ */
+uint16_t callingCodeForRegion(std::string_view region);
+
+/**
+ * Calling code that contact equality and contactHash128 assume for numbers
+ * stored without one. The bridges set it from the device region; 0, the
+ * default, keeps such numbers national.
+ */
+void setDefaultCallingCode(uint16_t callingCode);
+uint16_t defaultCallingCode();
+
+/**
+ * Compares two phone values by exact key, or byte for byte when either is not
+ * a phone number. This is the rule contact equality and contactHash128 use;
+ * it is transitive, unlike phoneKeysMatch, which duplicate detection uses.
+ * @param defaultCountryCode Calling code for numbers without one, 0 for none
+ */
+bool phoneNumbersEqual(std::string_view lhs, std::string_view rhs, uint16_t defaultCountryCode = defaultCallingCode());
+
+} // namespace contactsmanager
@@ -0,0 +1,288 @@
+//
+//  ResponseCache.cpp
+//  ContactsManagerCore
+//
+
+#include "ResponseCache.h"
+
+#include "BinaryFile.h"
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'C', 'M', 'R', 'C'};
+constexpr uint32_t kFileVersion = 1;
+// Separates the user from the rest of the key; user IDs never contain it
+constexpr char kUserSeparator = '\n';
+
+size_t entryBytes(const std::string &key, const CachedResponse &response) {
+  return key.size() + response.body.size() + response.etag.size();
+}
+
+double systemNow() {
+  return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+std::string responseCacheKey(const ApiRequest &request, std::string_view userId) {
+  std::string key(userId);
+  key.push_back(kUserSeparator);
+  key += request.method;
+  key.push_back(' ');
+  key += request.endpoint;
+  key.push_back('?');
+  key += canonicalParameters(request.parameters);
+  return key;
+}
+
+ResponseCache &ResponseCache::sharedInstance() {
+  static ResponseCache cache;
+  return cache;
+}
+
+CacheLookup ResponseCache::lookup(const std::string &key, double now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CacheLookup result;
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    misses_++;
+    return result;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lruPosition);
+  result.response = it->second.response;
+
+  // A clock that went backwards cannot vouch for the entry
+  double age = now - result.response->fetchedAt;
+  if (age >= 0 && age < options_.maxAge) {
+    result.state = CacheState::Fresh;
+    hits_++;
+  } else if (age >= 0 && age < options_.maxAge + options_.maxStale) {
+    result.state = CacheState::Stale;
+    staleHits_++;
+  } else {
+    result.state = CacheState::Expired;
+    misses_++;
+  }
+  return result;
+}
+
+void ResponseCache::store(const std::string &key, std::string body, std::string etag, double now) {
+  auto response = std::make_shared<CachedResponse>();
+  response->body = std::move(body);
+  response->etag = std::move(etag);
+  response->fetchedAt = now;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  storeLocked(key, std::move(response));
+  evictLocked();
+}
+
+std::shared_ptr<const CachedResponse> ResponseCache::revalidated(const std::string &key, double now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  // Entries are shared with readers, so renewing one replaces it
+  auto renewed = std::make_shared<CachedResponse>(*it->second.response);
+  renewed->fetchedAt = now;
+  it->second.response = renewed;
+  lru_.splice(lru_.begin(), lru_, it->second.lruPosition);
+  revalidations_++;
+  return renewed;
+}
+
+void ResponseCache::remove(const std::string &key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    removeLocked(it);
+  }
+}
+
+size_t ResponseCache::removeUser(std::string_view userId) {
+  std::string prefix(userId);
+  prefix.push_back(kUserSeparator);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t removed = 0;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto next = std::next(it);
+    if (it->first.compare(0, prefix.size(), prefix) == 0) {
+      removeLocked(it);
+      removed++;
+    }
+    it = next;
+  }
+  return removed;
+}
+
+void ResponseCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  lru_.clear();
+  bytes_ = 0;
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ResponseCacheStats stats;
+  stats.entries = entries_.size();
+  stats.bytes = bytes_;
+  stats.hits = hits_;
+  stats.staleHits = staleHits_;
+  stats.misses = misses_;
+  stats.revalidations = revalidations_;
+  stats.evictions = evictions_;
+  return stats;
+}
+
+// File layout (native byte order, the cache never leaves the device):
+//   "CMRC" version entryCount
+//   entryCount x key body etag fetchedAt, most recently used first
+bool ResponseCache::save(const std::string &path) const {
+  std::string out;
+  out.append(kFileMagic, sizeof(kFileMagic));
+  binary::writeUint32(out, kFileVersion);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    binary::writeUint32(out, static_cast<uint32_t>(lru_.size()));
+    for (const auto &key : lru_) {
+      const CachedResponse &response = *entries_.at(key).response;
+      binary::writeString(out, key);
+      binary::writeString(out, response.body);
+      binary::writeString(out, response.etag);
+      binary::writeDouble(out, response.fetchedAt);
+    }
+  }
+
+  return binary::writeFileAtomically(path, out);
+}
+
+bool ResponseCache::load(const std::string &path) {
+  std::string data;
+  bool read = binary::readFile(path, data);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  lru_.clear();
+  bytes_ = 0;
+  binary::Reader reader(data);
+  uint32_t version = 0;
+  uint32_t entryCount = 0;
+  if (!read || !reader.expect(std::string_view(kFileMagic, sizeof(kFileMagic))) || !reader.readUint32(version) ||
+      version != kFileVersion || !reader.readUint32(entryCount)) {
+    return false;
+  }
+
+  std::vector<std::pair<std::string, std::shared_ptr<CachedResponse>>> loaded;
+  for (uint32_t i = 0; i < entryCount; ++i) {
+    std::string key;
+    auto response = std::make_shared<CachedResponse>();
+    if (!reader.readString(key) || !reader.readString(response->body) || !reader.readString(response->etag) ||
+        !reader.readDouble(response->fetchedAt)) {
+      return false;
+    }
+    loaded.emplace_back(std::move(key), std::move(response));
+  }
+  if (!reader.atEnd()) {
+    return false;
+  }
+
+  // Least recently used first, so the order survives and the budget evicts from the tail
+  for (auto it = loaded.rbegin(); it != loaded.rend(); ++it) {
+    storeLocked(it->first, std::move(it->second));
+  }
+  evictLocked();
+  return true;
+}
+
+void ResponseCache::storeLocked(const std::string &key, std::shared_ptr<const CachedResponse> response) {
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    removeLocked(it);
+  }
+  bytes_ += entryBytes(key, *response);
+  lru_.push_front(key);
+  entries_.emplace(key, Entry{std::move(response), lru_.begin()});
+}
+
+void ResponseCache::removeLocked(std::unordered_map<std::string, Entry>::iterator entry) {
+  bytes_ -= entryBytes(entry->first, *entry->second.response);
+  lru_.erase(entry->second.lruPosition);
+  entries_.erase(entry);
+}
+
+void ResponseCache::evictLocked() {
+  while ((bytes_ > options_.maxBytes || entries_.size() > options_.maxEntries) && !lru_.empty()) {
+    removeLocked(entries_.find(lru_.back()));
+    evictions_++;
+  }
+}
+
+CachingApiClient::CachingApiClient(ApiTransport &transport, ResponseCache &cache, Clock clock)
+    : transport_(transport), cache_(cache), clock_(clock ? std::move(clock) : Clock(systemNow)) {}
+
+void CachingApiClient::get(ApiRequest request, std::string_view userId, Callback callback) {
+  request.method = "GET";
+  std::string key = responseCacheKey(request, userId);
+  CacheLookup cached = cache_.lookup(key, clock_());
+
+  bool served = cached.state == CacheState::Fresh || cached.state == CacheState::Stale;
+  // What the caller already has, if anything
+  std::shared_ptr<const CachedResponse> shown = served ? cached.response : nullptr;
+  if (served) {
+    CachedApiResponse result;
+    result.response.statusCode = 200;
+    result.response.body = cached.response->body;
+    result.response.etag = cached.response->etag;
+    result.fromCache = true;
+    result.stale = cached.state == CacheState::Stale;
+    callback(result);
+    if (cached.state == CacheState::Fresh) {
+      return;
+    }
+  }
+
+  if (cached.response) {
+    request.ifNoneMatch = cached.response->etag;
+  }
+  transport_.send(std::move(request), [this, key = std::move(key), callback = std::move(callback),
+                                       shown = std::move(shown)](ApiResponse response) {
+    CachedApiResponse result;
+    if (response.notModified()) {
+      std::shared_ptr<const CachedResponse> renewed = cache_.revalidated(key, clock_());
+      if (shown) {
+        return;
+      }
+      if (renewed) {
+        result.response.statusCode = 200;
+        result.response.body = renewed->body;
+        result.response.etag = renewed->etag;
+        result.fromCache = true;
+        callback(result);
+        return;
+      }
+      // Evicted while the request was in flight; nothing to show for the 304
+    } else if (response.statusCode == 200) {
+      cache_.store(key, response.body, response.etag, clock_());
+      if (shown && shown->body == response.body) {
+        // Unchanged, but the server did not answer the conditional request with a 304
+        return;
+      }
+    } else if (shown) {
+      // Keep showing the stale response; the next call retries
+      return;
+    }
+    result.response = std::move(response);
+    callback(result);
+  });
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,189 @@
+//
+//  ResponseCache.h
+//  ContactsManagerCore
+//
+//  Stale-while-revalidate cache for GET responses such as the recommendation
+//  endpoints (getInviteRecommendations, getContactsUsingApp,
+//  getUsersYouMightKnow). Responses are keyed by endpoint, parameters and
+//  user, kept in a bounded LRU and persisted to one file, so a screen's first
+//  paint comes from the cache even after a cold start.
+//
+//  A response younger than maxAge is served without a request. An older one
+//  is served at once and revalidated in the background with If-None-Match;
+//  a 304 only renews it, a 200 replaces it and is delivered as well unless
+//  its body is the one already shown. Past
+//  maxStale it is no longer shown, but its ETag still makes the request
+//  conditional.
+//
+
+#pragma once
+
+#include "ApiTransport.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace contactsmanager {
+
+struct ResponseCacheOptions {
+  size_t maxEntries = 64;
+  size_t maxBytes = 4 * 1024 * 1024;
+  // Seconds a response is served without revalidation
+  double maxAge = 60;
+  // Seconds a response may still be served while it is revalidated
+  double maxStale = 7 * 24 * 3600;
+};
+
+struct CachedResponse {
+  std::string body;
+  std::string etag;
+  // Seconds since 1970 of the last 200 or 304
+  double fetchedAt = 0;
+};
+
+enum class CacheState : uint8_t {
+  Missing,
+  Fresh,
+  // Servable, revalidate now
+  Stale,
+  // Too old to serve; only the ETag is still useful
+  Expired,
+};
+
+struct CacheLookup {
+  CacheState state = CacheState::Missing;
+  // Set unless state is Missing
+  std::shared_ptr<const CachedResponse> response;
+};
+
+struct ResponseCacheStats {
+  size_t entries = 0;
+  size_t bytes = 0;
+  // Fresh responses served without a request
+  size_t hits = 0;
+  // Stale responses served while revalidating
+  size_t staleHits = 0;
+  // Missing or expired lookups
+  size_t misses = 0;
+  // 304 answers that renewed an entry
+  size_t revalidations = 0;
+  size_t evictions = 0;
+};
+
+/**
+ * Cache key of a request for one user: method, endpoint, canonical parameters
+ */
+std::string responseCacheKey(const ApiRequest &request, std::string_view userId);
+
+class ResponseCache {
+public:
+  explicit ResponseCache(ResponseCacheOptions options = {}) : options_(options) {}
+
+  static ResponseCache &sharedInstance();
+
+  ResponseCache(const ResponseCache &) = delete;
+  ResponseCache &operator=(const ResponseCache &) = delete;
+
+  /**
+   * Looks a key up at time now and counts the outcome
+   */
+  CacheLookup lookup(const std::string &key, double now);
+
+  /**
+   * Stores a 200 response, replacing any previous one
+   */
+  void store(const std::string &key, std::string body, std::string etag, double now);
+
+  /**
+   * Renews an entry after a 304; nullptr if it was evicted meanwhile
+   */
+  std::shared_ptr<const CachedResponse> revalidated(const std::string &key, double now);
+
+  void remove(const std::string &key);
+
+  /**
+   * Drops every entry of one user, e.g. on sign-out
+   */
+  size_t removeUser(std::string_view userId);
+
+  void clear();
+  ResponseCacheStats stats() const;
+
+  /**
+   * Writes the entries, most recently used first, atomically to path
+   */
+  bool save(const std::string &path) const;
+
+  /**
+   * Replaces the entries with those stored at path, keeping the budget; on
+   * any error the cache is left empty and false is returned
+   */
+  bool load(const std::string &path);
+
+private:
+  struct Entry {
+    std::shared_ptr<const CachedResponse> response;
+    std::list<std::string>::iterator lruPosition;
+  };
+
+  void storeLocked(const std::string &key, std::shared_ptr<const CachedResponse> response);
+  void removeLocked(std::unordered_map<std::string, Entry>::iterator entry);
+  void evictLocked();
+
+  ResponseCacheOptions options_;
+  mutable std::mutex mutex_;
+  size_t bytes_ = 0;
+  size_t hits_ = 0;
+  size_t staleHits_ = 0;
+  size_t misses_ = 0;
+  size_t revalidations_ = 0;
+  size_t evictions_ = 0;
+  // Most recently used at the front
+  std::list<std::string> lru_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+struct CachedApiResponse {
+  ApiResponse response;
+  // Served from the cache (including after a 304) rather than a new 200
+  bool fromCache = false;
+  // Served past maxAge; a revalidation is in flight
+  bool stale = false;
+};
+
+/**
+ * Sends GET requests through a ResponseCache
+ */
+class CachingApiClient {
+public:
+  using Callback = std::function<void(const CachedApiResponse &result)>;
+  // Seconds since 1970
+  using Clock = std::function<double()>;
+
+  /**
+   * @param clock Defaults to the system clock
+   */
+  CachingApiClient(ApiTransport &transport, ResponseCache &cache, Clock clock = {});
+
+  /**
+   * Calls back at once with a fresh or stale cached response. Anything but a
+   * fresh one is then fetched, and the result delivered unless a 304, a
+   * failure or an identical body follows a response already served. Cached responses are
+   * delivered on the caller's thread, fetched ones on the transport's.
+   */
+  void get(ApiRequest request, std::string_view userId, Callback callback);
+
+private:
+  ApiTransport &transport_;
+  ResponseCache &cache_;
+  Clock clock_;
+};
+
+} // namespace contactsmanager
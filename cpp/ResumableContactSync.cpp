@@ -0,0 +1,164 @@
+//
+//  ResumableContactSync.cpp
+//  ContactsManagerCore
+//
+
+#include "ResumableContactSync.h"
+
+#include "ContactHashing.h"
+#include "SyncInfoStore.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+ResumableContactSync::ResumableContactSync(SyncJournal &journal, UploadTransport &transport,
+                                           UploadPipelineOptions options)
+    : journal_(journal), transport_(transport), options_(options), pipeline_(transport, options) {}
+
+void ResumableContactSync::cancel() {
+  cancelled_ = true;
+  pipeline_.cancel();
+}
+
+bool ResumableContactSync::resend(const PendingBatch &batch, const std::vector<const Contact *> &contacts,
+                                  const BodyEncoder &encode) {
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool done = false;
+  UploadResponse response;
+  transport_.send(UploadRequest{encode(contacts), batch.idempotencyKey, {}}, options_.uploadTimeout,
+                  [&](UploadResponse result) {
+                    // Notify under the lock: the waiter owns these locals
+                    std::lock_guard<std::mutex> lock(mutex);
+                    response = std::move(result);
+                    done = true;
+                    finished.notify_one();
+                  });
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [&] { return done; });
+  return response.status == UploadStatus::Ok && journal_.acknowledgeBatch(batch.idempotencyKey);
+}
+
+ResumableSyncReport ResumableContactSync::run(std::string_view sessionId, const std::vector<Contact> &contacts,
+                                              const BodyEncoder &encode) {
+  ResumableSyncReport report;
+  if (!journal_.isOpen()) {
+    return report;
+  }
+  report.resumed = !journal_.sessionId().empty();
+  if (!report.resumed && !journal_.beginSession(sessionId)) {
+    return report;
+  }
+
+  std::vector<JournalEntry> entries(contacts.size());
+  std::unordered_map<uint64_t, size_t> indexByKey;
+  indexByKey.reserve(contacts.size());
+  for (size_t i = 0; i < contacts.size(); ++i) {
+    entries[i] = {SyncInfoStore::keyFor(contacts[i].identifier), contactHash128(contacts[i])};
+    indexByKey[entries[i].contactKey] = i;
+    report.skipped += journal_.isAcknowledged(entries[i]) ? 1 : 0;
+  }
+
+  // Batches the previous run sent without seeing the answer go first, under
+  // their original keys, as long as their contacts are unchanged
+  for (const auto &batch : journal_.pendingBatches()) {
+    if (cancelled_) {
+      break;
+    }
+    std::vector<const Contact *> batchContacts;
+    batchContacts.reserve(batch.entries.size());
+    bool unchanged = true;
+    bool acknowledged = true;
+    for (const auto &entry : batch.entries) {
+      auto it = indexByKey.find(entry.contactKey);
+      if (it == indexByKey.end() || !(entries[it->second].contentHash == entry.contentHash)) {
+        unchanged = false;
+        break;
+      }
+      batchContacts.push_back(&contacts[it->second]);
+      acknowledged = acknowledged && journal_.isAcknowledged(entry);
+    }
+    if (unchanged && !acknowledged && resend(batch, batchContacts, encode)) {
+      report.resent += batchContacts.size();
+    } else {
+      // Its contacts go out with the rest under new keys
+      journal_.abandonBatch(batch.idempotencyKey);
+    }
+  }
+
+  std::vector<size_t> remaining;
+  for (size_t i = 0; i < contacts.size(); ++i) {
+    if (!journal_.isAcknowledged(entries[i])) {
+      remaining.push_back(i);
+    }
+  }
+  if (cancelled_) {
+    report.cancelled = true;
+    return report;
+  }
+
+  // Journaled batches of this run not acknowledged yet, by the range of remaining they cover. Both callbacks
+  // run on this thread, so they need no lock.
+  struct Outstanding {
+    size_t offset = 0;
+    size_t count = 0;
+    std::string key;
+  };
+  std::vector<Outstanding> outstanding;
+  report.upload = pipeline_.run(
+      remaining.size(),
+      [&](size_t offset, size_t count) {
+        std::vector<const Contact *> batchContacts(count);
+        std::vector<JournalEntry> batchEntries(count);
+        for (size_t i = 0; i < count; ++i) {
+          size_t index = remaining[offset + i];
+          batchContacts[i] = &contacts[index];
+          batchEntries[i] = entries[index];
+        }
+        // A range encoded again is a retry. The same contacts go out under their original key, so a batch the
+        // server applied before its answer was lost is not applied twice; a failed batch the pipeline split
+        // was rejected, so it is abandoned and its parts get keys of their own.
+        std::string key;
+        for (auto it = outstanding.begin(); it != outstanding.end();) {
+          if (it->offset == offset && it->count == count) {
+            key = it->key;
+            ++it;
+          } else if (it->offset < offset + count && offset < it->offset + it->count) {
+            journal_.abandonBatch(it->key);
+            it = outstanding.erase(it);
+          } else {
+            ++it;
+          }
+        }
+        if (key.empty()) {
+          // Journaled before the request leaves, so a crash mid-flight is always recoverable
+          key = journal_.beginBatch(batchEntries);
+          if (!key.empty()) {
+            outstanding.push_back({offset, count, key});
+          }
+        }
+        return UploadRequest{encode(batchContacts), key, {}};
+      },
+      [&](const UploadBatch &batch, const UploadResponse &) {
+        for (auto it = outstanding.begin(); it != outstanding.end(); ++it) {
+          if (it->offset == batch.offset && it->count == batch.count) {
+            journal_.acknowledgeBatch(it->key);
+            outstanding.erase(it);
+            break;
+          }
+        }
+      });
+
+  report.ok = report.upload.ok;
+  report.cancelled = !report.ok && cancelled_;
+  if (report.ok) {
+    journal_.finishSession();
+  }
+  return report;
+}
+
+} // namespace contactsmanager
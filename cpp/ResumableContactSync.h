@@ -0,0 +1,74 @@
+//
+//  ResumableContactSync.h
+//  ContactsManagerCore
+//
+//  Drives a contact upload through ContactUploadPipeline with every batch
+//  checkpointed in a SyncJournal, so a sync the OS cut short continues where
+//  it stopped. On start it skips contacts the journal has acknowledged at
+//  their current content hash, re-sends batches that were in flight when the
+//  previous run died under their original idempotency keys (the server either
+//  applies them or answers from its replay cache), and uploads the rest.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "ContactUploadPipeline.h"
+#include "SyncJournal.h"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace contactsmanager {
+
+struct ResumableSyncReport {
+  bool ok = false;
+  bool cancelled = false;
+  // Continued a session found in the journal
+  bool resumed = false;
+  // Already acknowledged at their current version
+  size_t skipped = 0;
+  // Re-sent in batches that were in flight when the previous run stopped
+  size_t resent = 0;
+  UploadReport upload;
+};
+
+class ResumableContactSync {
+public:
+  /**
+   * Encodes one batch as a request body
+   */
+  using BodyEncoder = std::function<std::string(const std::vector<const Contact *> &contacts)>;
+
+  ResumableContactSync(SyncJournal &journal, UploadTransport &transport, UploadPipelineOptions options = {});
+
+  ResumableContactSync(const ResumableContactSync &) = delete;
+  ResumableContactSync &operator=(const ResumableContactSync &) = delete;
+
+  /**
+   * Continues the journaled session if there is one, otherwise starts
+   * sessionId. The journal is cleared once every contact was acknowledged.
+   */
+  ResumableSyncReport run(std::string_view sessionId, const std::vector<Contact> &contacts,
+                          const BodyEncoder &encode);
+
+  /**
+   * Stops after the batches in flight; safe to call from any thread
+   */
+  void cancel();
+
+private:
+  bool resend(const PendingBatch &batch, const std::vector<const Contact *> &contacts, const BodyEncoder &encode);
+
+  SyncJournal &journal_;
+  UploadTransport &transport_;
+  UploadPipelineOptions options_;
+  ContactUploadPipeline pipeline_;
+  std::atomic<bool> cancelled_{false};
+};
+
+} // namespace contactsmanager
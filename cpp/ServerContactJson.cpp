@@ -0,0 +1,445 @@
+//
+//  ServerContactJson.cpp
+//  ContactsManagerCore
+//
+
+#include "ServerContactJson.h"
+#include "ContactHashing.h"
+
+#include <cmath>
+#include <cstdio>
+#include <optional>
+
+namespace contactsmanager {
+
+namespace {
+
+// Keys CMServerContact toDictionary omits when the value is empty
+bool isOptionalField(ContactField field) {
+  switch (field) {
+  case ContactField::DisplayName:
+  case ContactField::Nickname:
+  case ContactField::Notes:
+  case ContactField::ContactType:
+    return false;
+  default:
+    return true;
+  }
+}
+
+template <typename Writer>
+void optionalField(Writer &writer, std::string_view name, std::string_view value) {
+  if (!value.empty()) {
+    writer.field(name, value);
+  }
+}
+
+// Value of a string field; nullptr for Birthday and ContactType
+const std::string *fieldText(ContactField field, const Contact &contact) {
+  switch (field) {
+  case ContactField::DisplayName:
+    return &contact.displayName;
+  case ContactField::GivenName:
+    return &contact.givenName;
+  case ContactField::FamilyName:
+    return &contact.familyName;
+  case ContactField::NamePrefix:
+    return &contact.namePrefix;
+  case ContactField::NameSuffix:
+    return &contact.nameSuffix;
+  case ContactField::MiddleName:
+    return &contact.middleName;
+  case ContactField::PreviousFamilyName:
+    return &contact.previousFamilyName;
+  case ContactField::Nickname:
+    return &contact.nickname;
+  case ContactField::Notes:
+    return &contact.notes;
+  case ContactField::Bio:
+    return &contact.bio;
+  case ContactField::Location:
+    return &contact.location;
+  case ContactField::ContactSection:
+    return &contact.contactSection;
+  case ContactField::MatchString:
+    return &contact.matchString;
+  case ContactField::OrganizationName:
+    return &contact.organizationName;
+  case ContactField::DepartmentName:
+    return &contact.departmentName;
+  case ContactField::JobTitle:
+    return &contact.jobTitle;
+  case ContactField::Birthday:
+  case ContactField::ContactType:
+    return nullptr;
+  }
+  return nullptr;
+}
+
+bool isFieldEmpty(ContactField field, const Contact &contact) {
+  if (const std::string *text = fieldText(field, contact)) {
+    return text->empty();
+  }
+  return field == ContactField::Birthday && !contact.birthday;
+}
+
+// Shared by full contacts and patches, so a patched field reads back exactly
+// like the same field in a full upsert
+template <typename Writer>
+void writeFieldValue(Writer &writer, ContactField field, const Contact &contact) {
+  if (const std::string *text = fieldText(field, contact)) {
+    writer.stringValue(*text);
+  } else if (field == ContactField::Birthday) {
+    if (contact.birthday) {
+      writer.stringValue(formatIso8601(*contact.birthday));
+    } else {
+      writer.nullValue();
+    }
+  } else {
+    writer.intValue(contact.contactType);
+  }
+}
+
+template <typename Writer, typename Item>
+void writeItems(Writer &writer, const std::vector<Item> &items, bool firstIsPrimary) {
+  writer.beginArray();
+  for (size_t i = 0; i < items.size(); ++i) {
+    writeServerItem(writer, items[i], firstIsPrimary && i == 0);
+  }
+  writer.endArray();
+}
+
+// Writes the items of one collection of contact
+template <typename Writer>
+void writeCollectionItems(Writer &writer, const Contact &contact, ContactCollection collection,
+                          bool firstIsPrimary) {
+  switch (collection) {
+  case ContactCollection::PhoneNumbers:
+    writeItems(writer, contact.phoneNumbers, firstIsPrimary);
+    return;
+  case ContactCollection::EmailAddresses:
+    writeItems(writer, contact.emailAddresses, firstIsPrimary);
+    return;
+  case ContactCollection::Urls:
+    writeItems(writer, contact.urlAddresses, firstIsPrimary);
+    return;
+  case ContactCollection::SocialProfiles:
+    writeItems(writer, contact.socialProfiles, firstIsPrimary);
+    return;
+  case ContactCollection::Addresses:
+    writeItems(writer, contact.addresses, firstIsPrimary);
+    return;
+  case ContactCollection::InstantMessages:
+    writeItems(writer, contact.instantMessageAddresses, firstIsPrimary);
+    return;
+  case ContactCollection::Relations:
+    writeItems(writer, contact.relations, firstIsPrimary);
+    return;
+  case ContactCollection::Dates:
+    writeItems(writer, contact.dates, firstIsPrimary);
+    return;
+  }
+}
+
+template <typename Writer>
+void writeServerContactFields(Writer &writer, const Contact &contact, const ServerContactContext &context) {
+  writer.field("sourceContactId", contact.identifier);
+  for (size_t i = 0; i < kContactFieldCount; ++i) {
+    ContactField field = static_cast<ContactField>(i);
+    if (isOptionalField(field) && isFieldEmpty(field, contact)) {
+      continue;
+    }
+    writer.key(contactFieldName(field));
+    writeFieldValue(writer, field, contact);
+  }
+  writer.field("organizationId", context.organizationId);
+  writer.field("sourceId", context.sourceId);
+  for (size_t i = 0; i < kContactCollectionCount; ++i) {
+    ContactCollection collection = static_cast<ContactCollection>(i);
+    writer.key(contactCollectionName(collection));
+    writeCollectionItems(writer, contact, collection, true);
+  }
+  writer.key("tags");
+  writer.beginArray();
+  writer.endArray();
+  writer.key("customFields");
+  writer.beginObject();
+  writer.endObject();
+}
+
+template <typename ContactAt>
+std::string encodeBulkCreate(size_t count, ContactAt contactAt, const ServerContactContext &context,
+                             bool skipDuplicates) {
+  std::string body;
+  JsonWriter writer(body);
+  writer.beginObject();
+  writer.key("contacts");
+  writer.beginArray();
+  for (size_t i = 0; i < count; ++i) {
+    writeServerContact(writer, contactAt(i), context);
+  }
+  writer.endArray();
+  writer.key("skipDuplicates");
+  writer.boolValue(skipDuplicates);
+  writer.endObject();
+  return body;
+}
+
+} // namespace
+
+std::string formatIso8601(double secondsSince1970) {
+  int64_t seconds = static_cast<int64_t>(std::floor(secondsSince1970));
+  int64_t days = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+  int64_t secondOfDay = seconds - days * 86400;
+
+  // Civil date from days since 1970-01-01 (proleptic Gregorian calendar)
+  int64_t z = days + 719468;
+  int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  int64_t dayOfEra = z - era * 146097;
+  int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+  int64_t day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+  int64_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+  int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+  char buffer[48];
+  int length = std::snprintf(buffer, sizeof(buffer), "%04lld-%02lld-%02lldT%02lld:%02lld:%02lldZ",
+                             static_cast<long long>(year), static_cast<long long>(month),
+                             static_cast<long long>(day), static_cast<long long>(secondOfDay / 3600),
+                             static_cast<long long>(secondOfDay / 60 % 60), static_cast<long long>(secondOfDay % 60));
+  return std::string(buffer, static_cast<size_t>(length));
+}
+
+template <typename Writer>
+void writeServerItem(Writer &writer, const PhoneNumber &phone, bool isPrimary) {
+  writer.beginObject();
+  writer.field("type", phone.type);
+  writer.field("label", phone.type);
+  writer.field("value", phone.value);
+  writer.key("isPrimary");
+  writer.boolValue(isPrimary);
+  optionalField(writer, "emoji", phone.emoji);
+  writer.endObject();
+}
+
+template <typename Writer>
+void writeServerItem(Writer &writer, const EmailAddress &email, bool isPrimary) {
+  writer.beginObject();
+  writer.field("type", email.type);
+  writer.field("label", email.type);
+  writer.field("value", email.value);
+  writer.key("isPrimary");
+  writer.boolValue(isPrimary);
+  optionalField(writer, "emoji", email.emoji);
+  writer.endObject();
+}
+
+template <typename Writer>
+void writeServerItem(Writer &writer, const ContactURL &url, bool isPrimary) {
+  writer.beginObject();
+  writer.field("type", url.type);
+  writer.field("label", url.type);
+  writer.field("value", url.value);
+  writer.key("isPrimary");
+  writer.boolValue(isPrimary);
+  optionalField(writer, "emoji", url.emoji);
+  writer.endObject();
+}
+
+template <typename Writer>
+void writeServerItem(Writer &writer, const SocialProfile &profile, bool) {
+  writer.beginObject();
+  writer.field("platform", profile.service);
+  optionalField(writer, "username", profile.username);
+  optionalField(writer, "url", profile.urlString);
+  writer.endObject();
+}
+
+template <typename Writer>
+void writeServerItem(Writer &writer, const PostalAddress &address, bool isPrimary) {
+  writer.beginObject();
+  optionalField(writer, "type", address.type);
+  writer.field("label", address.type);
+  optionalField(writer, "streetAddress", address.street);
+  optionalField(writer, "city", address.city);
+  optionalField(writer, "region", address.state);
+  optionalField(writer, "postalCode", address.postalCode);
+  optionalField(writer, "country", address.country);
+  writer.key("isPrimary");
+  writer.boolValue(isPrimary);
+  writer.endObject();
+}
+
+template <typename Writer>
+void writeServerItem(Writer &writer, const InstantMessage &im, bool isPrimary) {
+  writer.beginObject();
+  writer.field("service", im.service);
+  optionalField(writer, "username", im.username);
+  writer.field("type", im.type);
+  writer.key("isPrimary");
+  writer.boolValue(isPrimary);
+  writer.endObject();
+}
+
+template <typename Writer>
+void writeServerItem(Writer &writer, const Relation &relation, bool) {
+  writer.beginObject();
+  writer.field("name", relation.name);
+  writer.field("relationType", relation.type);
+  writer.endObject();
+}
+
+template <typename Writer>
+void writeServerItem(Writer &writer, const ContactDate &date, bool isPrimary) {
+  writer.beginObject();
+  writer.field("label", date.type);
+  writer.field("date", formatIso8601(date.date));
+  writer.key("isPrimary");
+  writer.boolValue(isPrimary);
+  writer.endObject();
+}
+
+template <typename Writer>
+void writeServerContact(Writer &writer, const Contact &contact, const ServerContactContext &context) {
+  writer.beginObject();
+  writeServerContactFields(writer, contact, context);
+  writer.endObject();
+}
+
+template <typename Writer>
+void writeContactPatch(Writer &writer, const ContactPatch &patch) {
+  writer.beginObject();
+  writer.field("sourceContactId", patch.contactId);
+  writer.field("baseVersion", formatHash128(patch.baseVersion));
+  writer.field("version", formatHash128(patch.version));
+  if (patch.fields != 0) {
+    writer.key("set");
+    writer.beginObject();
+    for (size_t i = 0; i < kContactFieldCount; ++i) {
+      ContactField field = static_cast<ContactField>(i);
+      if (!patch.hasField(field)) {
+        continue;
+      }
+      writer.key(contactFieldName(field));
+      if (isOptionalField(field) && isFieldEmpty(field, patch.values)) {
+        writer.nullValue();
+      } else {
+        writeFieldValue(writer, field, patch.values);
+      }
+    }
+    writer.endObject();
+  }
+  if (!patch.collections.empty()) {
+    writer.key("collections");
+    writer.beginObject();
+    for (const auto &collection : patch.collections) {
+      writer.key(contactCollectionName(collection.collection));
+      writer.beginObject();
+      if (collection.replace) {
+        writer.key("items");
+        writeCollectionItems(writer, patch.values, collection.collection, true);
+      } else {
+        writer.key("remove");
+        writer.beginArray();
+        for (uint32_t index : collection.removed) {
+          writer.intValue(index);
+        }
+        writer.endArray();
+        // At least one base item survives, so appended items are never first
+        writer.key("add");
+        writeCollectionItems(writer, patch.values, collection.collection, false);
+      }
+      writer.endObject();
+    }
+    writer.endObject();
+  }
+  writer.endObject();
+}
+
+std::string encodeBulkCreateBody(const std::vector<Contact> &contacts, const ServerContactContext &context,
+                                 bool skipDuplicates) {
+  return encodeBulkCreateBody(contacts.data(), contacts.size(), context, skipDuplicates);
+}
+
+std::string encodeBulkCreateBody(const Contact *first, size_t count, const ServerContactContext &context,
+                                 bool skipDuplicates) {
+  return encodeBulkCreate(count, [first](size_t i) -> const Contact & { return first[i]; }, context,
+                          skipDuplicates);
+}
+
+std::string encodeBulkCreateBody(const std::vector<const Contact *> &contacts, const ServerContactContext &context,
+                                 bool skipDuplicates) {
+  return encodeBulkCreate(contacts.size(), [&contacts](size_t i) -> const Contact & { return *contacts[i]; },
+                          context, skipDuplicates);
+}
+
+DeltaSyncBody encodeDeltaSyncBody(const std::vector<Contact> &contacts, const ContactSnapshotStore &snapshots,
+                                  const ServerContactContext &context, bool skipDuplicates) {
+  DeltaSyncBody result;
+  std::string upserts;
+  std::string patches;
+  JsonWriter upsertWriter(upserts);
+  JsonWriter patchWriter(patches);
+  upsertWriter.beginArray();
+  patchWriter.beginArray();
+
+  std::string full;
+  std::string patchJson;
+  for (const auto &contact : contacts) {
+    full.clear();
+    JsonWriter fullWriter(full);
+    fullWriter.beginObject();
+    writeServerContactFields(fullWriter, contact, context);
+    fullWriter.field("version", formatHash128(serverContactHash128(contact)));
+    fullWriter.endObject();
+
+    std::optional<ContactPatch> patch = snapshots.patchFor(contact);
+    if (patch) {
+      patchJson.clear();
+      JsonWriter singlePatchWriter(patchJson);
+      writeContactPatch(singlePatchWriter, *patch);
+      if (patchJson.size() < full.size()) {
+        patchWriter.rawValue(patchJson);
+        result.patched.push_back(contact.identifier);
+        continue;
+      }
+    }
+    upsertWriter.rawValue(full);
+    result.upserted.push_back(contact.identifier);
+  }
+  upsertWriter.endArray();
+  patchWriter.endArray();
+
+  JsonWriter writer(result.body);
+  writer.beginObject();
+  writer.field("organizationId", context.organizationId);
+  writer.field("sourceId", context.sourceId);
+  writer.key("skipDuplicates");
+  writer.boolValue(skipDuplicates);
+  writer.key("contacts");
+  writer.rawValue(upserts);
+  writer.key("patches");
+  writer.rawValue(patches);
+  writer.endObject();
+  return result;
+}
+
+#define CM_INSTANTIATE_SERVER_WRITERS(Writer)                                                                        \
+  template void writeServerItem(Writer &, const PhoneNumber &, bool);                                                \
+  template void writeServerItem(Writer &, const EmailAddress &, bool);                                               \
+  template void writeServerItem(Writer &, const ContactURL &, bool);                                                 \
+  template void writeServerItem(Writer &, const SocialProfile &, bool);                                              \
+  template void writeServerItem(Writer &, const PostalAddress &, bool);                                              \
+  template void writeServerItem(Writer &, const InstantMessage &, bool);                                             \
+  template void writeServerItem(Writer &, const Relation &, bool);                                                   \
+  template void writeServerItem(Writer &, const ContactDate &, bool);                                                \
+  template void writeServerContact(Writer &, const Contact &, const ServerContactContext &);                         \
+  template void writeContactPatch(Writer &, const ContactPatch &);
+
+CM_INSTANTIATE_SERVER_WRITERS(JsonWriter)
+CM_INSTANTIATE_SERVER_WRITERS(CborWriter)
+
+#undef CM_INSTANTIATE_SERVER_WRITERS
+
+} // namespace contactsmanager
@@ -0,0 +1,102 @@
+//
+//  ServerContactJson.h
+//  ContactsManagerCore
+//
+//  JSON bodies for the contacts sync endpoint, written with JsonWriter in the
+//  shape CMServerContact / CMServerContactBulkCreate toDictionary produce
+//  (optional keys are omitted when empty, isPrimary marks the first item).
+//
+//  A delta sync body carries full contacts and patches side by side:
+//
+//    {"organizationId", "sourceId", "skipDuplicates",
+//     "contacts": [CMServerContact + "version"],
+//     "patches": [{"sourceContactId", "baseVersion", "version",
+//                  "set": {field: value | null},
+//                  "collections": {name: {"remove": [index], "add": [item]} | {"items": [item]}}}]}
+//
+//  Versions are formatHash128 strings of serverContactHash128. A field set to null is removed from the
+//  server's copy, matching an omitted optional key in a full upsert.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "ContactDelta.h"
+#include "CborWriter.h"
+#include "JsonWriter.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace contactsmanager {
+
+struct ServerContactContext {
+  std::string organizationId;
+  std::string sourceId;
+};
+
+/**
+ * UTC timestamp in the format CMContactSource uses (yyyy-MM-dd'T'HH:mm:ss'Z')
+ */
+std::string formatIso8601(double secondsSince1970);
+
+// The writers below take a JsonWriter or a CborWriter; both are instantiated
+// in ServerContactJson.cpp, so the two wire formats share one schema
+
+template <typename Writer>
+void writeServerItem(Writer &writer, const PhoneNumber &phone, bool isPrimary);
+template <typename Writer>
+void writeServerItem(Writer &writer, const EmailAddress &email, bool isPrimary);
+template <typename Writer>
+void writeServerItem(Writer &writer, const ContactURL &url, bool isPrimary);
+template <typename Writer>
+void writeServerItem(Writer &writer, const SocialProfile &profile, bool isPrimary);
+template <typename Writer>
+void writeServerItem(Writer &writer, const PostalAddress &address, bool isPrimary);
+template <typename Writer>
+void writeServerItem(Writer &writer, const InstantMessage &im, bool isPrimary);
+template <typename Writer>
+void writeServerItem(Writer &writer, const Relation &relation, bool isPrimary);
+template <typename Writer>
+void writeServerItem(Writer &writer, const ContactDate &date, bool isPrimary);
+
+/**
+ * One CMServerContact object; the local identifier goes in sourceContactId
+ */
+template <typename Writer>
+void writeServerContact(Writer &writer, const Contact &contact, const ServerContactContext &context);
+
+template <typename Writer>
+void writeContactPatch(Writer &writer, const ContactPatch &patch);
+
+/**
+ * CMServerContactBulkCreate body with every contact in full
+ */
+std::string encodeBulkCreateBody(const std::vector<Contact> &contacts, const ServerContactContext &context,
+                                 bool skipDuplicates);
+
+/**
+ * Same body for contacts [first, first + count), so upload batches need not copy
+ */
+std::string encodeBulkCreateBody(const Contact *first, size_t count, const ServerContactContext &context,
+                                 bool skipDuplicates);
+std::string encodeBulkCreateBody(const std::vector<const Contact *> &contacts, const ServerContactContext &context,
+                                 bool skipDuplicates);
+
+struct DeltaSyncBody {
+  std::string body;
+  // Identifiers sent in full and as patches, in body order
+  std::vector<std::string> upserted;
+  std::vector<std::string> patched;
+};
+
+/**
+ * Delta sync body for the changed contacts: a patch for each contact with an
+ * acknowledged snapshot (unless the patch would be larger than the contact),
+ * the full contact otherwise
+ */
+DeltaSyncBody encodeDeltaSyncBody(const std::vector<Contact> &contacts, const ContactSnapshotStore &snapshots,
+                                  const ServerContactContext &context, bool skipDuplicates);
+
+} // namespace contactsmanager
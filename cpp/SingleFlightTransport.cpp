@@ -0,0 +1,93 @@
+//
+//  SingleFlightTransport.cpp
+//  ContactsManagerCore
+//
+
+#include "SingleFlightTransport.h"
+
+#include <utility>
+
+namespace contactsmanager {
+
+SingleFlightTransport::SingleFlightTransport(ApiTransport &transport, IdentityProvider identity,
+                                             SingleFlightOptions options)
+    : transport_(transport), identity_(std::move(identity)), options_(options) {}
+
+SingleFlightTransport::~SingleFlightTransport() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return flights_.empty() && delivering_ == 0; });
+}
+
+// Fields are separated by newlines; only the body could contain one, so it comes last
+std::string SingleFlightTransport::flightKey(const ApiRequest &request, const std::string &identity) {
+  std::string key = request.requiresAuth ? identity : std::string();
+  key.push_back('\n');
+  key += request.method;
+  key.push_back(' ');
+  key += request.endpoint;
+  key.push_back('?');
+  key += canonicalParameters(request.parameters);
+  key.push_back('\n');
+  key += request.ifNoneMatch;
+  key.push_back('\n');
+  key += request.body;
+  return key;
+}
+
+void SingleFlightTransport::send(ApiRequest request, std::function<void(ApiResponse response)> done) {
+  bool shared = options_.includeWrites || request.method == "GET";
+  if (!shared) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.requests++;
+      stats_.sent++;
+    }
+    transport_.send(std::move(request), std::move(done));
+    return;
+  }
+
+  std::string key = flightKey(request, request.requiresAuth && identity_ ? identity_() : std::string());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.requests++;
+    auto flight = flights_.find(key);
+    if (flight != flights_.end()) {
+      flight->second.push_back(std::move(done));
+      stats_.deduplicated++;
+      return;
+    }
+    flights_[key].push_back(std::move(done));
+    stats_.sent++;
+  }
+  transport_.send(std::move(request),
+                  [this, key = std::move(key)](ApiResponse response) { complete(key, response); });
+}
+
+SingleFlightStats SingleFlightTransport::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  SingleFlightStats stats = stats_;
+  stats.inFlight = flights_.size();
+  return stats;
+}
+
+void SingleFlightTransport::complete(const std::string &key, const ApiResponse &response) {
+  std::vector<std::function<void(ApiResponse)>> waiting;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto flight = flights_.find(key);
+    waiting = std::move(flight->second);
+    flights_.erase(flight);
+    delivering_++;
+  }
+  // A caller that sends the same request from its callback starts a new round trip
+  for (auto &done : waiting) {
+    done(response);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  delivering_--;
+  if (flights_.empty() && delivering_ == 0) {
+    idle_.notify_all();
+  }
+}
+
+} // namespace contactsmanager
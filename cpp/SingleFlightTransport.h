@@ -0,0 +1,89 @@
+//
+//  SingleFlightTransport.h
+//  ContactsManagerCore
+//
+//  ApiTransport wrapper that shares one round trip between identical
+//  requests in flight at the same time, e.g. several screens asking for
+//  getUserInfo, the recommendation endpoints or the same getFeed page at
+//  once. Requests are identical when method, endpoint, parameters, body,
+//  If-None-Match and the caller's auth identity all match; every caller
+//  gets the one response. Nothing is kept once it is answered, so a request
+//  sent after that goes out again (caching is ResponseCache's job).
+//
+//  Only GET is shared unless writes are enabled: two identical POSTs are
+//  usually two intended actions.
+//
+
+#pragma once
+
+#include "ApiTransport.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+struct SingleFlightOptions {
+  // Also share POST, PUT and DELETE; only for endpoints that are reads behind a POST
+  bool includeWrites = false;
+};
+
+struct SingleFlightStats {
+  // Requests handed to the wrapper
+  size_t requests = 0;
+  // Requests passed on to the transport
+  size_t sent = 0;
+  // Requests answered by a round trip another caller started
+  size_t deduplicated = 0;
+  size_t inFlight = 0;
+};
+
+class SingleFlightTransport : public ApiTransport {
+public:
+  /**
+   * Identity the transport authenticates as right now, e.g. the signed-in
+   * user's ID; requests that require auth are only shared within one identity
+   */
+  using IdentityProvider = std::function<std::string()>;
+
+  SingleFlightTransport(ApiTransport &transport, IdentityProvider identity, SingleFlightOptions options = {});
+
+  /**
+   * Waits for the round trips in flight
+   */
+  ~SingleFlightTransport() override;
+
+  SingleFlightTransport(const SingleFlightTransport &) = delete;
+  SingleFlightTransport &operator=(const SingleFlightTransport &) = delete;
+
+  void send(ApiRequest request, std::function<void(ApiResponse response)> done) override;
+
+  SingleFlightStats stats() const;
+
+  /**
+   * Key under which a request is shared, for an auth identity
+   */
+  static std::string flightKey(const ApiRequest &request, const std::string &identity);
+
+private:
+  void complete(const std::string &key, const ApiResponse &response);
+
+  ApiTransport &transport_;
+  IdentityProvider identity_;
+  SingleFlightOptions options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable idle_;
+  // Callers waiting on each round trip, the one that started it first
+  std::unordered_map<std::string, std::vector<std::function<void(ApiResponse)>>> flights_;
+  // Round trips whose callbacks are still running, on top of those in flights_
+  size_t delivering_ = 0;
+  SingleFlightStats stats_;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,367 @@
+//
+//  SocialEventStore.cpp
+//  ContactsManagerCore
+//
+
+#include "SocialEventStore.h"
+
+#include "BinaryFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_set>
+#include <utility>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'C', 'M', 'E', 'V'};
+// Version 2: feeds carry their complete flag
+constexpr uint32_t kFileVersion = 2;
+
+size_t eventBytes(const SocialEvent &event) {
+  size_t bytes = sizeof(SocialEvent) + event.eventId.size() + event.organizationId.size() +
+                 event.canonicalContactId.size() + event.eventType.size() + event.title.size() +
+                 event.description.size() + event.location.size() + event.userId.size() +
+                 event.createdBy.name.size() + event.createdBy.avatarUrl.size();
+  for (const auto &entry : event.metadata) {
+    bytes += sizeof(entry) + entry.first.size() + entry.second.size();
+  }
+  return bytes;
+}
+
+void writeEvent(std::string &out, const SocialEvent &event) {
+  binary::writeString(out, event.eventId);
+  binary::writeString(out, event.organizationId);
+  binary::writeString(out, event.canonicalContactId);
+  binary::writeString(out, event.eventType);
+  binary::writeString(out, event.title);
+  binary::writeString(out, event.description);
+  binary::writeString(out, event.location);
+  binary::writeDouble(out, event.startTime);
+  binary::writeDouble(out, event.endTime);
+  binary::writeUint32(out, static_cast<uint32_t>(event.metadata.size()));
+  for (const auto &entry : event.metadata) {
+    binary::writeString(out, entry.first);
+    binary::writeString(out, entry.second);
+  }
+  binary::writeUint32(out, event.isPublic ? 1 : 0);
+  binary::writeDouble(out, event.createdAt);
+  binary::writeDouble(out, event.updatedAt);
+  binary::writeString(out, event.userId);
+  binary::writeString(out, event.createdBy.name);
+  binary::writeString(out, event.createdBy.avatarUrl);
+}
+
+bool readEvent(binary::Reader &reader, SocialEvent &event) {
+  uint32_t metadataCount = 0;
+  if (!reader.readString(event.eventId) || !reader.readString(event.organizationId) ||
+      !reader.readString(event.canonicalContactId) || !reader.readString(event.eventType) ||
+      !reader.readString(event.title) || !reader.readString(event.description) ||
+      !reader.readString(event.location) || !reader.readDouble(event.startTime) ||
+      !reader.readDouble(event.endTime) || !reader.readUint32(metadataCount)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < metadataCount; ++i) {
+    std::pair<std::string, std::string> entry;
+    if (!reader.readString(entry.first) || !reader.readString(entry.second)) {
+      return false;
+    }
+    event.metadata.push_back(std::move(entry));
+  }
+  uint32_t isPublic = 0;
+  if (!reader.readUint32(isPublic) || isPublic > 1 || !reader.readDouble(event.createdAt) ||
+      !reader.readDouble(event.updatedAt) || !reader.readString(event.userId) ||
+      !reader.readString(event.createdBy.name) || !reader.readString(event.createdBy.avatarUrl)) {
+    return false;
+  }
+  event.isPublic = isPublic == 1;
+  return !event.eventId.empty();
+}
+
+} // namespace
+
+SocialEventStore &SocialEventStore::sharedInstance() {
+  static SocialEventStore store;
+  return store;
+}
+
+std::shared_ptr<const SocialEvent> SocialEventStore::store(SocialEvent event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_ptr<const SocialEvent> stored = storeLocked(std::move(event), false);
+  evictLocked();
+  return stored;
+}
+
+void SocialEventStore::storeFeedPage(const std::string &feed, std::vector<SocialEvent> events,
+                                     std::string nextCursor, bool firstPage) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Feed &stored = feeds_[feed];
+  if (firstPage) {
+    stored.eventIds.clear();
+    stored.complete = true;
+  }
+  bool appending = stored.complete;
+  std::unordered_set<std::string> present(stored.eventIds.begin(), stored.eventIds.end());
+  for (SocialEvent &event : events) {
+    if (event.eventId.empty()) {
+      continue;
+    }
+    if (appending && present.insert(event.eventId).second) {
+      if (stored.eventIds.size() < options_.maxFeedEvents) {
+        stored.eventIds.push_back(event.eventId);
+      } else {
+        cutShort(stored, stored.eventIds.size());
+        appending = false;
+      }
+    }
+    storeLocked(std::move(event), false);
+  }
+  if (stored.complete) {
+    stored.nextCursor = std::move(nextCursor);
+  }
+  evictLocked();
+}
+
+CachedFeed SocialEventStore::feed(const std::string &feed, size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CachedFeed result;
+  auto found = feeds_.find(feed);
+  if (found == feeds_.end()) {
+    misses_++;
+    return result;
+  }
+  result.complete = found->second.complete;
+  for (const std::string &eventId : found->second.eventIds) {
+    if (result.events.size() == limit) {
+      break;
+    }
+    auto entry = entries_.find(eventId);
+    if (entry == entries_.end()) {
+      // Evictions cut the feeds short, so this only guards against a file listing events it lacks
+      result.complete = false;
+      misses_++;
+      break;
+    }
+    lru_.splice(lru_.begin(), lru_, entry->second.lruPosition);
+    result.events.push_back(entry->second.event);
+    hits_++;
+  }
+  if (result.complete) {
+    result.nextCursor = found->second.nextCursor;
+  }
+  return result;
+}
+
+std::shared_ptr<const SocialEvent> SocialEventStore::event(const std::string &eventId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = entries_.find(eventId);
+  if (entry == entries_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, entry->second.lruPosition);
+  hits_++;
+  return entry->second.event;
+}
+
+bool SocialEventStore::updateEvent(SocialEvent event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.find(event.eventId) == entries_.end()) {
+    return false;
+  }
+  storeLocked(std::move(event), true);
+  evictLocked();
+  return true;
+}
+
+bool SocialEventStore::removeEvent(const std::string &eventId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool removed = false;
+  auto entry = entries_.find(eventId);
+  if (entry != entries_.end()) {
+    removeLocked(entry);
+    removed = true;
+  }
+  // Drop the ID from the feeds even when the event itself was not stored
+  for (auto &feed : feeds_) {
+    std::vector<std::string> &ids = feed.second.eventIds;
+    size_t before = ids.size();
+    ids.erase(std::remove(ids.begin(), ids.end(), eventId), ids.end());
+    removed = removed || ids.size() != before;
+  }
+  return removed;
+}
+
+void SocialEventStore::removeFeed(const std::string &feed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  feeds_.erase(feed);
+}
+
+void SocialEventStore::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  lru_.clear();
+  feeds_.clear();
+  bytes_ = 0;
+}
+
+SocialEventStoreStats SocialEventStore::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  SocialEventStoreStats stats;
+  stats.events = entries_.size();
+  stats.bytes = bytes_;
+  stats.feeds = feeds_.size();
+  for (const auto &feed : feeds_) {
+    stats.feedEntries += feed.second.eventIds.size();
+  }
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  return stats;
+}
+
+// File layout (native byte order, the store never leaves the device):
+//   "CMEV" version eventCount
+//   eventCount x event, most recently used first
+//   feedCount
+//   feedCount x name nextCursor complete idCount idCount x eventId
+bool SocialEventStore::save(const std::string &path) const {
+  std::string out;
+  out.append(kFileMagic, sizeof(kFileMagic));
+  binary::writeUint32(out, kFileVersion);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    binary::writeUint32(out, static_cast<uint32_t>(lru_.size()));
+    for (const auto &eventId : lru_) {
+      writeEvent(out, *entries_.at(eventId).event);
+    }
+    binary::writeUint32(out, static_cast<uint32_t>(feeds_.size()));
+    for (const auto &feed : feeds_) {
+      binary::writeString(out, feed.first);
+      binary::writeString(out, feed.second.nextCursor);
+      binary::writeUint32(out, feed.second.complete ? 1 : 0);
+      binary::writeUint32(out, static_cast<uint32_t>(feed.second.eventIds.size()));
+      for (const auto &eventId : feed.second.eventIds) {
+        binary::writeString(out, eventId);
+      }
+    }
+  }
+
+  return binary::writeFileAtomically(path, out);
+}
+
+bool SocialEventStore::load(const std::string &path) {
+  std::string data;
+  bool read = binary::readFile(path, data);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  lru_.clear();
+  feeds_.clear();
+  bytes_ = 0;
+  binary::Reader reader(data);
+  uint32_t version = 0;
+  uint32_t eventCount = 0;
+  if (!read || !reader.expect(std::string_view(kFileMagic, sizeof(kFileMagic))) || !reader.readUint32(version) ||
+      version != kFileVersion || !reader.readUint32(eventCount)) {
+    return false;
+  }
+
+  std::vector<SocialEvent> events;
+  for (uint32_t i = 0; i < eventCount; ++i) {
+    SocialEvent event;
+    if (!readEvent(reader, event)) {
+      return false;
+    }
+    events.push_back(std::move(event));
+  }
+  uint32_t feedCount = 0;
+  if (!reader.readUint32(feedCount)) {
+    return false;
+  }
+  std::unordered_map<std::string, Feed> feeds;
+  for (uint32_t i = 0; i < feedCount; ++i) {
+    std::string name;
+    Feed feed;
+    uint32_t complete = 0;
+    uint32_t idCount = 0;
+    if (!reader.readString(name) || !reader.readString(feed.nextCursor) || !reader.readUint32(complete) ||
+        complete > 1 || !reader.readUint32(idCount)) {
+      return false;
+    }
+    feed.complete = complete == 1;
+    for (uint32_t j = 0; j < idCount; ++j) {
+      std::string eventId;
+      if (!reader.readString(eventId)) {
+        return false;
+      }
+      feed.eventIds.push_back(std::move(eventId));
+    }
+    feeds.emplace(std::move(name), std::move(feed));
+  }
+  if (!reader.atEnd()) {
+    return false;
+  }
+
+  // Least recently used first, so the order survives and the budget evicts from the tail
+  for (auto it = events.rbegin(); it != events.rend(); ++it) {
+    storeLocked(std::move(*it), true);
+  }
+  feeds_ = std::move(feeds);
+  evictLocked();
+  return true;
+}
+
+std::shared_ptr<const SocialEvent> SocialEventStore::storeLocked(SocialEvent event, bool force) {
+  auto it = entries_.find(event.eventId);
+  if (it != entries_.end()) {
+    if (!force && it->second.event->updatedAt > event.updatedAt) {
+      lru_.splice(lru_.begin(), lru_, it->second.lruPosition);
+      return it->second.event;
+    }
+    removeLocked(it);
+  }
+  auto stored = std::make_shared<const SocialEvent>(std::move(event));
+  bytes_ += eventBytes(*stored);
+  lru_.push_front(stored->eventId);
+  entries_.emplace(stored->eventId, Entry{stored, lru_.begin()});
+  return stored;
+}
+
+void SocialEventStore::removeLocked(std::unordered_map<std::string, Entry>::iterator entry) {
+  bytes_ -= eventBytes(*entry->second.event);
+  lru_.erase(entry->second.lruPosition);
+  entries_.erase(entry);
+}
+
+void SocialEventStore::evictLocked() {
+  std::unordered_set<std::string> evicted;
+  while ((bytes_ > options_.maxBytes || entries_.size() > options_.maxEvents) && !lru_.empty()) {
+    evicted.insert(lru_.back());
+    removeLocked(entries_.find(lru_.back()));
+    evictions_++;
+  }
+  if (evicted.empty()) {
+    return;
+  }
+  // A feed reads up to its first missing event, so the IDs after it only take memory
+  for (auto &feed : feeds_) {
+    std::vector<std::string> &ids = feed.second.eventIds;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      if (evicted.count(ids[i]) > 0) {
+        cutShort(feed.second, i);
+        break;
+      }
+    }
+  }
+}
+
+void SocialEventStore::cutShort(Feed &feed, size_t length) {
+  feed.eventIds.resize(length);
+  feed.nextCursor.clear();
+  feed.complete = false;
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,145 @@
+//
+//  SocialEventStore.h
+//  ContactsManagerCore
+//
+//  Normalized store for the events of the social feeds (getFeed,
+//  getUpcomingEvents, getForYouFeed, getUserEvents). Each event is kept
+//  once, keyed by eventId and shared by every feed it appears in; a feed
+//  holds only its ordered event IDs and the cursor of its next page. Events
+//  are kept in a bounded LRU and, with the feeds, persisted to one file so
+//  feeds render from the store after a cold start.
+//
+//  Evicting an event cuts every feed that lists it short just before it; the
+//  feed then reports itself incomplete, without a cursor, and its next first
+//  page replaces it. A feed also keeps at most maxFeedEvents IDs and is cut
+//  short the same way when a page goes past that, so the feeds stay bounded
+//  along with the events.
+//
+
+#pragma once
+
+#include "SocialModels.h"
+
+#include <cstddef>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+struct SocialEventStoreOptions {
+  size_t maxEvents = 2000;
+  size_t maxBytes = 2 * 1024 * 1024;
+  // Event IDs kept per feed
+  size_t maxFeedEvents = 500;
+};
+
+struct CachedFeed {
+  std::vector<std::shared_ptr<const SocialEvent>> events;
+  // Cursor for the page after the stored ones; empty at the end of the feed or when incomplete
+  std::string nextCursor;
+  // False when the feed was cut short by an eviction or maxFeedEvents, or is not stored
+  bool complete = false;
+};
+
+struct SocialEventStoreStats {
+  size_t events = 0;
+  // Estimated memory of the events
+  size_t bytes = 0;
+  size_t feeds = 0;
+  size_t feedEntries = 0;
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t evictions = 0;
+};
+
+class SocialEventStore {
+public:
+  explicit SocialEventStore(SocialEventStoreOptions options = {}) : options_(options) {}
+
+  static SocialEventStore &sharedInstance();
+
+  SocialEventStore(const SocialEventStore &) = delete;
+  SocialEventStore &operator=(const SocialEventStore &) = delete;
+
+  /**
+   * Stores an event from a list; one already stored with a later updatedAt is
+   * kept, so a page that was in flight cannot undo an update
+   */
+  std::shared_ptr<const SocialEvent> store(SocialEvent event);
+
+  /**
+   * Stores one page of a feed. The first page replaces the feed's event IDs,
+   * later pages append those not already in it unless the feed was cut short.
+   */
+  void storeFeedPage(const std::string &feed, std::vector<SocialEvent> events, std::string nextCursor,
+                     bool firstPage);
+
+  /**
+   * The stored feed, at most limit events, marking them recently used
+   */
+  CachedFeed feed(const std::string &feed, size_t limit = std::numeric_limits<size_t>::max());
+
+  std::shared_ptr<const SocialEvent> event(const std::string &eventId);
+
+  /**
+   * Replaces a stored event with the result of updateEvent, keeping its
+   * place in every feed; false if it is not stored
+   */
+  bool updateEvent(SocialEvent event);
+
+  /**
+   * Drops an event after deleteEvent, from the store and from every feed
+   */
+  bool removeEvent(const std::string &eventId);
+
+  void removeFeed(const std::string &feed);
+  void clear();
+  SocialEventStoreStats stats() const;
+
+  /**
+   * Writes the events, most recently used first, and the feeds atomically to path
+   */
+  bool save(const std::string &path) const;
+
+  /**
+   * Replaces the contents with those stored at path, keeping the budget; on
+   * any error the store is left empty and false is returned
+   */
+  bool load(const std::string &path);
+
+private:
+  struct Entry {
+    std::shared_ptr<const SocialEvent> event;
+    std::list<std::string>::iterator lruPosition;
+  };
+
+  struct Feed {
+    std::vector<std::string> eventIds;
+    std::string nextCursor;
+    // False once cut short; later pages no longer follow the stored IDs
+    bool complete = true;
+  };
+
+  std::shared_ptr<const SocialEvent> storeLocked(SocialEvent event, bool force);
+  void removeLocked(std::unordered_map<std::string, Entry>::iterator entry);
+  void evictLocked();
+  static void cutShort(Feed &feed, size_t length);
+
+  SocialEventStoreOptions options_;
+  mutable std::mutex mutex_;
+  size_t bytes_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+  size_t evictions_ = 0;
+  // Most recently used at the front
+  std::list<std::string> lru_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::unordered_map<std::string, Feed> feeds_;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,96 @@
+//
+//  SocialModels.h
+//  ContactsManagerCore
+//
+//  Portable mirrors of the CMSocialModels value types. Nullable NSString
+//  properties are empty strings and NSDate properties are seconds since
+//  1970 (0 when absent), as in Contact.
+//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace contactsmanager {
+
+/**
+ * User of the app in the canonical contacts system (mirrors CMCanonicalContact)
+ */
+struct CanonicalContact {
+  std::string identifier;
+  std::string organizationId;
+  std::string organizationUserId;
+  std::string email;
+  std::string phone;
+  std::string fullName;
+  std::string avatarUrl;
+  bool isActive = false;
+  double createdAt = 0;
+  double updatedAt = 0;
+};
+
+/**
+ * Canonical contact the server matched to one of the device's contacts
+ * (mirrors CMLocalCanonicalContact without the CMContact itself)
+ */
+struct LocalCanonicalContact {
+  std::string contactId;
+  // Local identifier of the matched device contact, as uploaded
+  std::string sourceContactId;
+  CanonicalContact canonicalContact;
+};
+
+/**
+ * One follow edge (mirrors CMFollowRelationship without its localContact)
+ */
+struct FollowRelationship {
+  std::string identifier;
+  std::string followerId;
+  std::string followedId;
+  // The other side of the edge as seen from the list it came in
+  std::string userId;
+  std::string displayName;
+  std::string photoUrl;
+  std::string username;
+  std::string bio;
+  std::string website;
+  double createdAt = 0;
+  bool isFollowing = false;
+  // Expanded sides, when the server included them; empty identifiers otherwise
+  CanonicalContact follower;
+  CanonicalContact followed;
+  std::string contactId;
+};
+
+/**
+ * Author shown on an event (mirrors CMEventCreator)
+ */
+struct EventCreator {
+  std::string name;
+  std::string avatarUrl;
+};
+
+/**
+ * Event in a social feed (mirrors CMSocialEvent)
+ */
+struct SocialEvent {
+  std::string eventId;
+  std::string organizationId;
+  std::string canonicalContactId;
+  std::string eventType;
+  std::string title;
+  std::string description;
+  std::string location;
+  double startTime = 0;
+  double endTime = 0;
+  std::vector<std::pair<std::string, std::string>> metadata;
+  bool isPublic = false;
+  double createdAt = 0;
+  double updatedAt = 0;
+  std::string userId;
+  EventCreator createdBy;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,268 @@
+//
+//  SortedIntersection.cpp
+//  ContactsManagerCore
+//
+
+#include "SortedIntersection.h"
+
+#include <algorithm>
+
+// 64-bit lane equality: SSE2 (every x86-64) builds it from 32-bit compares, AArch64 has it
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CM_INTERSECT_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CM_INTERSECT_NEON 1
+#endif
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr size_t kBlock = 4;
+constexpr size_t kWindow = 8;
+// Below this size ratio merging beats galloping
+constexpr size_t kGallopRatio = 32;
+
+#if defined(CM_INTERSECT_SSE2)
+
+__m128i equal64(__m128i lhs, __m128i rhs) {
+  __m128i halves = _mm_cmpeq_epi32(lhs, rhs);
+  return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+__m128i swapLanes(__m128i value) {
+  return _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+unsigned laneMask(__m128i value) {
+  return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(value)));
+}
+
+__m128i load2(const uint64_t *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+// Bit k set when a[k] is one of b[0..3]
+unsigned matchBlock(const uint64_t *a, const uint64_t *b) {
+  __m128i a0 = load2(a);
+  __m128i a1 = load2(a + 2);
+  __m128i b0 = load2(b);
+  __m128i b1 = load2(b + 2);
+  __m128i b0s = swapLanes(b0);
+  __m128i b1s = swapLanes(b1);
+  __m128i m0 = _mm_or_si128(_mm_or_si128(equal64(a0, b0), equal64(a0, b0s)),
+                            _mm_or_si128(equal64(a0, b1), equal64(a0, b1s)));
+  __m128i m1 = _mm_or_si128(_mm_or_si128(equal64(a1, b0), equal64(a1, b0s)),
+                            _mm_or_si128(equal64(a1, b1), equal64(a1, b1s)));
+  return laneMask(m0) | (laneMask(m1) << 2);
+}
+
+// Bit k set when window[k] == key, for eight keys
+unsigned matchWindow(const uint64_t *window, uint64_t key) {
+  __m128i needle = _mm_set1_epi64x(static_cast<long long>(key));
+  unsigned mask = 0;
+  for (size_t i = 0; i < kWindow; i += 2) {
+    mask |= laneMask(equal64(load2(window + i), needle)) << i;
+  }
+  return mask;
+}
+
+#elif defined(CM_INTERSECT_NEON)
+
+unsigned laneMask(uint64x2_t value) {
+  return static_cast<unsigned>((vgetq_lane_u64(value, 0) & 1) | (vgetq_lane_u64(value, 1) & 2));
+}
+
+unsigned matchBlock(const uint64_t *a, const uint64_t *b) {
+  uint64x2_t a0 = vld1q_u64(a);
+  uint64x2_t a1 = vld1q_u64(a + 2);
+  uint64x2_t b0 = vld1q_u64(b);
+  uint64x2_t b1 = vld1q_u64(b + 2);
+  uint64x2_t b0s = vextq_u64(b0, b0, 1);
+  uint64x2_t b1s = vextq_u64(b1, b1, 1);
+  uint64x2_t m0 = vorrq_u64(vorrq_u64(vceqq_u64(a0, b0), vceqq_u64(a0, b0s)),
+                            vorrq_u64(vceqq_u64(a0, b1), vceqq_u64(a0, b1s)));
+  uint64x2_t m1 = vorrq_u64(vorrq_u64(vceqq_u64(a1, b0), vceqq_u64(a1, b0s)),
+                            vorrq_u64(vceqq_u64(a1, b1), vceqq_u64(a1, b1s)));
+  return laneMask(m0) | (laneMask(m1) << 2);
+}
+
+unsigned matchWindow(const uint64_t *window, uint64_t key) {
+  uint64x2_t needle = vdupq_n_u64(key);
+  unsigned mask = 0;
+  for (size_t i = 0; i < kWindow; i += 2) {
+    mask |= laneMask(vceqq_u64(vld1q_u64(window + i), needle)) << i;
+  }
+  return mask;
+}
+
+#else
+
+unsigned matchBlock(const uint64_t *a, const uint64_t *b) {
+  unsigned mask = 0;
+  for (size_t i = 0; i < kBlock; ++i) {
+    bool match = a[i] == b[0] || a[i] == b[1] || a[i] == b[2] || a[i] == b[3];
+    mask |= static_cast<unsigned>(match) << i;
+  }
+  return mask;
+}
+
+unsigned matchWindow(const uint64_t *window, uint64_t key) {
+  unsigned mask = 0;
+  for (size_t i = 0; i < kWindow; ++i) {
+    mask |= static_cast<unsigned>(window[i] == key) << i;
+  }
+  return mask;
+}
+
+#endif
+
+unsigned lowestBit(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+  unsigned bit = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    bit++;
+  }
+  return bit;
+#endif
+}
+
+size_t mergeTail(const uint64_t *a, size_t i, size_t aSize, const uint64_t *b, size_t j, size_t bSize,
+                 uint32_t *positions, size_t count) {
+  while (i < aSize && j < bSize) {
+    if (a[i] < b[j]) {
+      i++;
+    } else if (b[j] < a[i]) {
+      j++;
+    } else {
+      if (positions) {
+        positions[count] = static_cast<uint32_t>(i);
+      }
+      count++;
+      i++;
+      j++;
+    }
+  }
+  return count;
+}
+
+// Blocks of four from each side; the block with the smaller last key (or
+// both) moves on, so every pair that can match is compared exactly once
+size_t mergeBlocks(const uint64_t *a, size_t aSize, const uint64_t *b, size_t bSize, uint32_t *positions) {
+  size_t i = 0;
+  size_t j = 0;
+  size_t count = 0;
+  while (i + kBlock <= aSize && j + kBlock <= bSize) {
+    uint64_t aLast = a[i + kBlock - 1];
+    uint64_t bLast = b[j + kBlock - 1];
+    unsigned mask = matchBlock(a + i, b + j);
+    while (mask != 0) {
+      unsigned bit = lowestBit(mask);
+      if (positions) {
+        positions[count] = static_cast<uint32_t>(i + bit);
+      }
+      count++;
+      mask &= mask - 1;
+    }
+    i += aLast <= bLast ? kBlock : 0;
+    j += bLast <= aLast ? kBlock : 0;
+  }
+  return mergeTail(a, i, aSize, b, j, bSize, positions, count);
+}
+
+// Index of key in large at or after from, or large's size when absent. Any
+// index at or below key's lower bound comes back in next, as the start for
+// the following (larger) key.
+size_t gallop(const uint64_t *large, size_t size, size_t from, uint64_t key, size_t &next) {
+  if (from >= size || large[from] > key) {
+    next = from;
+    return size;
+  }
+  if (large[from] == key) {
+    next = from + 1;
+    return from;
+  }
+  // large[low] < key throughout; large[high] >= key or high == size
+  size_t low = from;
+  size_t step = 1;
+  size_t high = from + 1;
+  while (high < size && large[high] < key) {
+    low = high;
+    step <<= 1;
+    high = low + step;
+  }
+  high = std::min(high, size);
+  while (high - low > kWindow) {
+    size_t middle = low + (high - low) / 2;
+    if (large[middle] < key) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  size_t start = low + 1;
+  next = start;
+  if (start + kWindow <= size) {
+    unsigned mask = matchWindow(large + start, key);
+    if (mask == 0) {
+      return size;
+    }
+    size_t found = start + lowestBit(mask);
+    next = found + 1;
+    return found;
+  }
+  for (size_t k = start; k < size && large[k] <= key; ++k) {
+    if (large[k] == key) {
+      next = k + 1;
+      return k;
+    }
+  }
+  return size;
+}
+
+} // namespace
+
+size_t intersectSorted(const uint64_t *a, size_t aSize, const uint64_t *b, size_t bSize, uint32_t *positions) {
+  if (aSize == 0 || bSize == 0) {
+    return 0;
+  }
+  size_t count = 0;
+  if (aSize * kGallopRatio < bSize) {
+    size_t from = 0;
+    for (size_t i = 0; i < aSize; ++i) {
+      if (gallop(b, bSize, from, a[i], from) != bSize) {
+        if (positions) {
+          positions[count] = static_cast<uint32_t>(i);
+        }
+        count++;
+      }
+    }
+    return count;
+  }
+  if (bSize * kGallopRatio < aSize) {
+    size_t from = 0;
+    for (size_t j = 0; j < bSize; ++j) {
+      size_t found = gallop(a, aSize, from, b[j], from);
+      if (found != aSize) {
+        if (positions) {
+          positions[count] = static_cast<uint32_t>(found);
+        }
+        count++;
+      }
+    }
+    return count;
+  }
+  return mergeBlocks(a, aSize, b, bSize, positions);
+}
+
+size_t intersectSortedScalar(const uint64_t *a, size_t aSize, const uint64_t *b, size_t bSize,
+                             uint32_t *positions) {
+  return mergeTail(a, 0, aSize, b, 0, bSize, positions, 0);
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,34 @@
+//
+//  SortedIntersection.h
+//  ContactsManagerCore
+//
+//  Intersection of sorted sets of 64-bit keys, e.g. hashed user IDs. Sets of
+//  similar size are merged four keys at a time, each block of one compared
+//  with a block of the other in vector registers (SSE2 on x86, NEON on
+//  AArch64, a scalar loop elsewhere). When one set is much smaller each of
+//  its keys gallops through the larger one and the last window of eight is
+//  checked with one vector comparison.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace contactsmanager {
+
+/**
+ * Intersects two ascending arrays without duplicates
+ * @param positions Receives the index in a of every common key, ascending;
+ *   room for min(aSize, bSize) entries, or nullptr to only count
+ * @return Number of common keys
+ */
+size_t intersectSorted(const uint64_t *a, size_t aSize, const uint64_t *b, size_t bSize, uint32_t *positions);
+
+/**
+ * Plain merge with the same contract, for comparison
+ */
+size_t intersectSortedScalar(const uint64_t *a, size_t aSize, const uint64_t *b, size_t bSize,
+                             uint32_t *positions);
+
+} // namespace contactsmanager
@@ -0,0 +1,197 @@
+//
+//  StreamingHash.cpp
+//  ContactsManagerCore
+//
+
+#include "StreamingHash.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace contactsmanager {
+
+namespace {
+
+constexpr uint64_t kPrime32_1 = 0x9E3779B1ULL;
+constexpr uint64_t kPrime32_2 = 0x85EBCA77ULL;
+constexpr uint64_t kPrime32_3 = 0xC2B2AE3DULL;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+
+// SplitMix64 output for a fixed seed; changing these changes every persisted digest
+constexpr uint64_t kSecret[12] = {
+    0x705a92109c0e6c8aULL, 0x79b0e8ae0590880dULL, 0xe45b0a59d8afa696ULL, 0xa623e72612392724ULL,
+    0xc813bace44367d2dULL, 0x09618a1e29e365cbULL, 0xe3b77d499f3a82ffULL, 0x7516fb3dddffe3a0ULL,
+    0xc516377f50f32ef0ULL, 0x8d1a9461fe658d3eULL, 0x56bdfb49e01c0d00ULL, 0xcae89dbef4b46be8ULL,
+};
+
+// Scramble the lanes after this many stripes (1 KiB)
+constexpr size_t kStripesPerBlock = 16;
+
+inline uint64_t readLittleEndian64(const unsigned char *bytes) {
+  uint64_t value;
+  std::memcpy(&value, bytes, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap64(value);
+#endif
+  return value;
+}
+
+inline void writeLittleEndian64(unsigned char *bytes, uint64_t value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap64(value);
+#endif
+  std::memcpy(bytes, &value, sizeof(value));
+}
+
+inline uint64_t secret(size_t index, uint64_t seed) {
+  return (index & 1) ? kSecret[index] - seed : kSecret[index] + seed;
+}
+
+inline uint64_t multiplyFold64(uint64_t lhs, uint64_t rhs) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+  uint64_t lhsLow = lhs & 0xFFFFFFFFULL;
+  uint64_t lhsHigh = lhs >> 32;
+  uint64_t rhsLow = rhs & 0xFFFFFFFFULL;
+  uint64_t rhsHigh = rhs >> 32;
+  uint64_t lowLow = lhsLow * rhsLow;
+  uint64_t highLow = lhsHigh * rhsLow;
+  uint64_t lowHigh = lhsLow * rhsHigh;
+  uint64_t highHigh = lhsHigh * rhsHigh;
+  uint64_t cross = (lowLow >> 32) + (highLow & 0xFFFFFFFFULL) + lowHigh;
+  uint64_t upper = (highLow >> 32) + (cross >> 32) + highHigh;
+  uint64_t lower = (cross << 32) | (lowLow & 0xFFFFFFFFULL);
+  return lower ^ upper;
+#endif
+}
+
+inline uint64_t avalanche(uint64_t hash) {
+  hash ^= hash >> 37;
+  hash *= kPrime64_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+void accumulateStripe(uint64_t *lanes, const unsigned char *stripe, size_t stripeIndex, uint64_t seed) {
+  size_t offset = stripeIndex % 4;
+  for (size_t lane = 0; lane < 8; ++lane) {
+    uint64_t value = readLittleEndian64(stripe + lane * 8);
+    uint64_t keyed = value ^ secret(lane + offset, seed);
+    lanes[lane ^ 1] += value;
+    lanes[lane] += (keyed & 0xFFFFFFFFULL) * (keyed >> 32);
+  }
+}
+
+void scrambleLanes(uint64_t *lanes, uint64_t seed) {
+  for (size_t lane = 0; lane < 8; ++lane) {
+    uint64_t value = lanes[lane];
+    value ^= value >> 47;
+    value ^= secret(lane + 4, seed);
+    lanes[lane] = value * kPrime32_1;
+  }
+}
+
+uint64_t mergeLanes(const uint64_t *lanes, size_t secretOffset, uint64_t start, uint64_t seed) {
+  uint64_t result = start;
+  for (size_t pair = 0; pair < 4; ++pair) {
+    result += multiplyFold64(lanes[2 * pair] ^ secret(2 * pair + secretOffset, seed),
+                             lanes[2 * pair + 1] ^ secret(2 * pair + secretOffset + 1, seed));
+  }
+  return avalanche(result);
+}
+
+} // namespace
+
+std::string formatHash128(const Hash128 &hash) {
+  char buffer[33];
+  std::snprintf(buffer, sizeof(buffer), "%016llx%016llx", static_cast<unsigned long long>(hash.high),
+                static_cast<unsigned long long>(hash.low));
+  return std::string(buffer, 32);
+}
+
+StreamingHasher::StreamingHasher(uint64_t seed)
+    : lanes_{kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3, kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1},
+      seed_(seed) {}
+
+void StreamingHasher::update(const void *bytes, size_t length) {
+  const unsigned char *input = static_cast<const unsigned char *>(bytes);
+  totalLength_ += length;
+  if (buffered_ + length < kStripeSize) {
+    if (length > 0) {
+      std::memcpy(buffer_ + buffered_, input, length);
+    }
+    buffered_ += length;
+    return;
+  }
+  if (buffered_ > 0) {
+    size_t fill = kStripeSize - buffered_;
+    std::memcpy(buffer_ + buffered_, input, fill);
+    consumeStripe(buffer_);
+    input += fill;
+    length -= fill;
+    buffered_ = 0;
+  }
+  while (length >= kStripeSize) {
+    consumeStripe(input);
+    input += kStripeSize;
+    length -= kStripeSize;
+  }
+  if (length > 0) {
+    std::memcpy(buffer_, input, length);
+  }
+  buffered_ = length;
+}
+
+void StreamingHasher::updateField(std::string_view value) {
+  unsigned char prefix[4];
+  uint32_t length = static_cast<uint32_t>(value.size());
+  for (size_t i = 0; i < sizeof(prefix); ++i) {
+    prefix[i] = static_cast<unsigned char>(length >> (8 * i));
+  }
+  update(prefix, sizeof(prefix));
+  update(value.data(), value.size());
+}
+
+void StreamingHasher::updateUint64(uint64_t value) {
+  unsigned char bytes[8];
+  writeLittleEndian64(bytes, value);
+  update(bytes, sizeof(bytes));
+}
+
+void StreamingHasher::consumeStripe(const unsigned char *stripe) {
+  accumulateStripe(lanes_, stripe, stripes_, seed_);
+  if (++stripes_ % kStripesPerBlock == 0) {
+    scrambleLanes(lanes_, seed_);
+  }
+}
+
+Hash128 StreamingHasher::digest() const {
+  uint64_t lanes[8];
+  std::memcpy(lanes, lanes_, sizeof(lanes));
+  if (buffered_ > 0) {
+    // Zero padding is disambiguated by the total length below
+    unsigned char last[kStripeSize] = {};
+    std::memcpy(last, buffer_, buffered_);
+    accumulateStripe(lanes, last, stripes_, seed_);
+  }
+  scrambleLanes(lanes, seed_);
+
+  Hash128 hash;
+  hash.low = mergeLanes(lanes, 0, totalLength_ * kPrime64_1, seed_);
+  hash.high = mergeLanes(lanes, 3, ~(totalLength_ * kPrime64_2), seed_);
+  return hash;
+}
+
+Hash128 hash128(std::string_view bytes, uint64_t seed) {
+  StreamingHasher hasher(seed);
+  hasher.update(bytes);
+  return hasher.digest();
+}
+
+} // namespace contactsmanager
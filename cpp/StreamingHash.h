@@ -0,0 +1,74 @@
+//
+//  StreamingHash.h
+//  ContactsManagerCore
+//
+//  Fast non-cryptographic 128-bit hash that is fed incrementally, so callers
+//  can hash a record field by field without building an intermediate string.
+//  The construction follows XXH3 (eight 64-bit lanes accumulated over 64-byte
+//  stripes, periodic scrambling, 128-bit multiply folding on output); input is
+//  read as little-endian, so digests are identical on every platform and are
+//  safe to persist.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace contactsmanager {
+
+struct Hash128 {
+  uint64_t low = 0;
+  uint64_t high = 0;
+
+  friend bool operator==(const Hash128 &lhs, const Hash128 &rhs) {
+    return lhs.low == rhs.low && lhs.high == rhs.high;
+  }
+  friend bool operator!=(const Hash128 &lhs, const Hash128 &rhs) { return !(lhs == rhs); }
+};
+
+/**
+ * 32 lowercase hex characters, high half first
+ */
+std::string formatHash128(const Hash128 &hash);
+
+class StreamingHasher {
+public:
+  static constexpr size_t kStripeSize = 64;
+
+  explicit StreamingHasher(uint64_t seed = 0);
+
+  void update(const void *bytes, size_t length);
+  void update(std::string_view bytes) { update(bytes.data(), bytes.size()); }
+
+  /**
+   * Length-prefixed bytes, so adjacent fields cannot run into each other
+   */
+  void updateField(std::string_view value);
+
+  void updateUint64(uint64_t value);
+
+  /**
+   * Digest of everything fed so far; the hasher can keep being updated
+   */
+  Hash128 digest() const;
+
+private:
+  void consumeStripe(const unsigned char *stripe);
+
+  uint64_t lanes_[8];
+  unsigned char buffer_[kStripeSize];
+  size_t buffered_ = 0;
+  size_t stripes_ = 0;
+  uint64_t totalLength_ = 0;
+  uint64_t seed_;
+};
+
+/**
+ * One-shot 128-bit hash of a byte range
+ */
+Hash128 hash128(std::string_view bytes, uint64_t seed = 0);
+
+} // namespace contactsmanager
@@ -0,0 +1,425 @@
+//
+//  SyncInfoStore.cpp
+//  ContactsManagerCore
+//
+
+#include "SyncInfoStore.h"
+
+#include "BinaryFile.h"
+#include "ContactHashing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace contactsmanager {
+
+// File layout (native byte order, the file never leaves the device):
+//   header:  "CMSS" version recordSize reserved sortedCount(u64) reserved checksum
+//   sorted:  sortedCount records, ascending key, no duplicates or tombstones
+//   tail:    appended records, later records supersede earlier ones
+//   record:  key(u64) contentHash(2 x u64) lastSyncedAt(f64) flags(u32) checksum(u32)
+// Checksums let open tell a torn or partially written tail record from a real one.
+
+namespace {
+
+constexpr char kFileMagic[4] = {'C', 'M', 'S', 'S'};
+constexpr uint32_t kFileVersion = 1;
+// Tombstones only ever appear in the tail
+constexpr uint32_t kRemovedFlag = 1u << 31;
+
+constexpr size_t kSortedCountOffset = 16;
+constexpr size_t kHeaderChecksumOffset = 28;
+constexpr size_t kFlagsOffset = 32;
+constexpr size_t kRecordChecksumOffset = 36;
+
+template <typename T>
+T loadValue(const unsigned char *bytes, size_t offset) {
+  T value;
+  std::memcpy(&value, bytes + offset, sizeof(value));
+  return value;
+}
+
+template <typename T>
+void storeValue(unsigned char *bytes, size_t offset, T value) {
+  std::memcpy(bytes + offset, &value, sizeof(value));
+}
+
+void encodeHeader(unsigned char *bytes, uint64_t sortedCount) {
+  std::memset(bytes, 0, SyncInfoStore::kHeaderSize);
+  std::memcpy(bytes, kFileMagic, sizeof(kFileMagic));
+  storeValue<uint32_t>(bytes, 4, kFileVersion);
+  storeValue<uint32_t>(bytes, 8, static_cast<uint32_t>(SyncInfoStore::kRecordSize));
+  storeValue<uint64_t>(bytes, kSortedCountOffset, sortedCount);
+  storeValue<uint32_t>(bytes, kHeaderChecksumOffset, binary::checksum32(bytes, kHeaderChecksumOffset));
+}
+
+bool decodeHeader(const unsigned char *bytes, uint64_t &sortedCount) {
+  if (std::memcmp(bytes, kFileMagic, sizeof(kFileMagic)) != 0 || loadValue<uint32_t>(bytes, 4) != kFileVersion ||
+      loadValue<uint32_t>(bytes, 8) != SyncInfoStore::kRecordSize ||
+      loadValue<uint32_t>(bytes, kHeaderChecksumOffset) != binary::checksum32(bytes, kHeaderChecksumOffset)) {
+    return false;
+  }
+  sortedCount = loadValue<uint64_t>(bytes, kSortedCountOffset);
+  return true;
+}
+
+void encodeRecord(unsigned char *bytes, uint64_t key, const SyncInfoRecord &record, uint32_t flags) {
+  storeValue<uint64_t>(bytes, 0, key);
+  storeValue<uint64_t>(bytes, 8, record.contentHash.low);
+  storeValue<uint64_t>(bytes, 16, record.contentHash.high);
+  storeValue<double>(bytes, 24, record.lastSyncedAt);
+  storeValue<uint32_t>(bytes, kFlagsOffset, flags);
+  storeValue<uint32_t>(bytes, kRecordChecksumOffset, binary::checksum32(bytes, kRecordChecksumOffset));
+}
+
+SyncInfoRecord decodeRecord(const unsigned char *bytes) {
+  SyncInfoRecord record;
+  record.contentHash.low = loadValue<uint64_t>(bytes, 8);
+  record.contentHash.high = loadValue<uint64_t>(bytes, 16);
+  record.lastSyncedAt = loadValue<double>(bytes, 24);
+  record.flags = loadValue<uint32_t>(bytes, kFlagsOffset) & ~kRemovedFlag;
+  return record;
+}
+
+bool readAll(int fd, unsigned char *bytes, size_t length, off_t offset) {
+  while (length > 0) {
+    ssize_t read = ::pread(fd, bytes, length, offset);
+    if (read <= 0) {
+      return false;
+    }
+    bytes += read;
+    length -= static_cast<size_t>(read);
+    offset += read;
+  }
+  return true;
+}
+
+} // namespace
+
+SyncInfoStore::~SyncInfoStore() {
+  close();
+}
+
+uint64_t SyncInfoStore::keyFor(std::string_view contactId) {
+  return fnv1a64(contactId);
+}
+
+bool SyncInfoStore::open(const std::string &path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closeLocked();
+  discarded_ = 0;
+  if (!openLocked(path)) {
+    closeLocked();
+    return false;
+  }
+  return true;
+}
+
+bool SyncInfoStore::openLocked(const std::string &path) {
+  path_ = path;
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    return false;
+  }
+  struct stat info;
+  if (::fstat(fd_, &info) != 0) {
+    return false;
+  }
+
+  unsigned char header[kHeaderSize];
+  uint64_t size = static_cast<uint64_t>(info.st_size);
+  if (size < kHeaderSize) {
+    // New file, or a crash before the first header reached the disk
+    encodeHeader(header, 0);
+    if (::ftruncate(fd_, 0) != 0 || !binary::writeAll(fd_, header, kHeaderSize, 0) || ::fsync(fd_) != 0) {
+      return false;
+    }
+    size = kHeaderSize;
+  } else if (!readAll(fd_, header, kHeaderSize, 0)) {
+    return false;
+  }
+  if (!decodeHeader(header, sortedCount_) || sortedCount_ > (size - kHeaderSize) / kRecordSize) {
+    return false;
+  }
+
+  mapLength_ = kHeaderSize + static_cast<size_t>(sortedCount_) * kRecordSize;
+  void *map = ::mmap(nullptr, mapLength_, PROT_READ, MAP_SHARED, fd_, 0);
+  if (map == MAP_FAILED) {
+    map_ = nullptr;
+    return false;
+  }
+  map_ = static_cast<const unsigned char *>(map);
+  liveCount_ = static_cast<size_t>(sortedCount_);
+
+  // Replay the tail; the first torn or corrupt record ends it
+  uint64_t offset = mapLength_;
+  std::vector<unsigned char> tail(static_cast<size_t>(size - offset));
+  if (!tail.empty() && !readAll(fd_, tail.data(), tail.size(), static_cast<off_t>(offset))) {
+    return false;
+  }
+  size_t position = 0;
+  while (position + kRecordSize <= tail.size()) {
+    const unsigned char *bytes = tail.data() + position;
+    if (loadValue<uint32_t>(bytes, kRecordChecksumOffset) != binary::checksum32(bytes, kRecordChecksumOffset)) {
+      break;
+    }
+    uint64_t key = loadValue<uint64_t>(bytes, 0);
+    bool removed = (loadValue<uint32_t>(bytes, kFlagsOffset) & kRemovedFlag) != 0;
+    bool existed = getLocked(key).has_value();
+    liveCount_ += (!removed && !existed) ? 1 : 0;
+    liveCount_ -= (removed && existed) ? 1 : 0;
+    tail_[key] = TailEntry{decodeRecord(bytes), removed};
+    tailRecords_++;
+    position += kRecordSize;
+  }
+  fileSize_ = offset + position;
+  if (position < tail.size()) {
+    discarded_ = (tail.size() - position + kRecordSize - 1) / kRecordSize;
+    if (::ftruncate(fd_, static_cast<off_t>(fileSize_)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SyncInfoStore::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closeLocked();
+}
+
+void SyncInfoStore::closeLocked() {
+  if (map_) {
+    ::munmap(const_cast<unsigned char *>(map_), mapLength_);
+    map_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  mapLength_ = 0;
+  sortedCount_ = 0;
+  fileSize_ = 0;
+  tail_.clear();
+  tailRecords_ = 0;
+  liveCount_ = 0;
+}
+
+bool SyncInfoStore::isOpen() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fd_ >= 0;
+}
+
+std::optional<SyncInfoRecord> SyncInfoStore::get(std::string_view contactId) const {
+  return getByKey(keyFor(contactId));
+}
+
+std::optional<SyncInfoRecord> SyncInfoStore::getByKey(uint64_t key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return getLocked(key);
+}
+
+std::optional<SyncInfoRecord> SyncInfoStore::getLocked(uint64_t key) const {
+  auto entry = tail_.find(key);
+  if (entry != tail_.end()) {
+    return entry->second.removed ? std::nullopt : std::optional<SyncInfoRecord>(entry->second.record);
+  }
+  return sortedLookupLocked(key);
+}
+
+std::optional<SyncInfoRecord> SyncInfoStore::sortedLookupLocked(uint64_t key) const {
+  size_t low = 0;
+  size_t high = static_cast<size_t>(sortedCount_);
+  const unsigned char *records = map_ + kHeaderSize;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    uint64_t middleKey = loadValue<uint64_t>(records + middle * kRecordSize, 0);
+    if (middleKey < key) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  if (low < sortedCount_ && loadValue<uint64_t>(records + low * kRecordSize, 0) == key) {
+    return decodeRecord(records + low * kRecordSize);
+  }
+  return std::nullopt;
+}
+
+bool SyncInfoStore::put(std::string_view contactId, const SyncInfoRecord &record) {
+  return putByKey(keyFor(contactId), record);
+}
+
+bool SyncInfoStore::putByKey(uint64_t key, const SyncInfoRecord &record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return appendLocked(key, record, false);
+}
+
+bool SyncInfoStore::remove(std::string_view contactId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t key = keyFor(contactId);
+  if (!getLocked(key)) {
+    return false;
+  }
+  return appendLocked(key, SyncInfoRecord(), true);
+}
+
+bool SyncInfoStore::appendLocked(uint64_t key, const SyncInfoRecord &record, bool removed) {
+  if (fd_ < 0) {
+    return false;
+  }
+  unsigned char bytes[kRecordSize];
+  encodeRecord(bytes, key, record, removed ? (record.flags | kRemovedFlag) : (record.flags & ~kRemovedFlag));
+  if (!binary::writeAll(fd_, bytes, kRecordSize, static_cast<off_t>(fileSize_))) {
+    // Drop whatever part of the record made it to the file. The result is ignored on purpose: the
+    // partial record is shorter than a record, so the next append at fileSize_ overwrites all of it and
+    // open discards it as torn, and the false return already reports the failed put.
+    (void)::ftruncate(fd_, static_cast<off_t>(fileSize_));
+    return false;
+  }
+  fileSize_ += kRecordSize;
+
+  bool existed = getLocked(key).has_value();
+  liveCount_ += (!removed && !existed) ? 1 : 0;
+  liveCount_ -= (removed && existed) ? 1 : 0;
+  TailEntry entry{record, removed};
+  entry.record.flags &= ~kRemovedFlag;
+  tail_[key] = entry;
+  tailRecords_++;
+
+  if (tailRecords_ >= compactionThreshold_) {
+    return compactLocked();
+  }
+  return true;
+}
+
+void SyncInfoStore::forEach(const std::function<void(uint64_t key, const SyncInfoRecord &record)> &visit) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const unsigned char *records = map_ ? map_ + kHeaderSize : nullptr;
+  for (uint64_t i = 0; i < sortedCount_; ++i) {
+    uint64_t key = loadValue<uint64_t>(records + i * kRecordSize, 0);
+    if (tail_.count(key) == 0) {
+      visit(key, decodeRecord(records + i * kRecordSize));
+    }
+  }
+  for (const auto &entry : tail_) {
+    if (!entry.second.removed) {
+      visit(entry.first, entry.second.record);
+    }
+  }
+}
+
+bool SyncInfoStore::compact() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return compactLocked();
+}
+
+bool SyncInfoStore::compactLocked() {
+  if (fd_ < 0) {
+    return false;
+  }
+
+  // Merge the sorted region with the sorted tail, tail entries winning
+  std::vector<std::pair<uint64_t, const TailEntry *>> tail;
+  tail.reserve(tail_.size());
+  for (const auto &entry : tail_) {
+    tail.emplace_back(entry.first, &entry.second);
+  }
+  std::sort(tail.begin(), tail.end(),
+            [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+  std::vector<unsigned char> out(kHeaderSize + liveCount_ * kRecordSize);
+  unsigned char *cursor = out.data() + kHeaderSize;
+  size_t written = 0;
+  const unsigned char *records = map_ + kHeaderSize;
+  size_t sortedIndex = 0;
+  size_t tailIndex = 0;
+  while (sortedIndex < sortedCount_ || tailIndex < tail.size()) {
+    uint64_t sortedKey = sortedIndex < sortedCount_ ? loadValue<uint64_t>(records + sortedIndex * kRecordSize, 0)
+                                                    : UINT64_MAX;
+    if (tailIndex < tail.size() && (sortedIndex >= sortedCount_ || tail[tailIndex].first <= sortedKey)) {
+      const auto &entry = tail[tailIndex];
+      if (entry.first == sortedKey && sortedIndex < sortedCount_) {
+        sortedIndex++;
+      }
+      tailIndex++;
+      if (entry.second->removed) {
+        continue;
+      }
+      encodeRecord(cursor, entry.first, entry.second->record, entry.second->record.flags);
+    } else {
+      std::memcpy(cursor, records + sortedIndex * kRecordSize, kRecordSize);
+      sortedIndex++;
+    }
+    cursor += kRecordSize;
+    written++;
+  }
+  encodeHeader(out.data(), written);
+
+  std::string temporaryPath = path_ + ".tmp";
+  int fd = ::open(temporaryPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool saved = binary::writeAll(fd, out.data(), kHeaderSize + written * kRecordSize, 0) && ::fsync(fd) == 0;
+  saved = ::close(fd) == 0 && saved;
+  if (!saved || std::rename(temporaryPath.c_str(), path_.c_str()) != 0) {
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+
+  std::string path = path_;
+  closeLocked();
+  if (!openLocked(path)) {
+    closeLocked();
+    return false;
+  }
+  return true;
+}
+
+bool SyncInfoStore::sync() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fd_ >= 0 && ::fsync(fd_) == 0;
+}
+
+bool SyncInfoStore::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return false;
+  }
+  std::string path = path_;
+  closeLocked();
+  if (std::remove(path.c_str()) != 0 || !openLocked(path)) {
+    closeLocked();
+    return false;
+  }
+  return true;
+}
+
+size_t SyncInfoStore::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return liveCount_;
+}
+
+size_t SyncInfoStore::tailRecordCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tailRecords_;
+}
+
+size_t SyncInfoStore::discardedRecordCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return discarded_;
+}
+
+void SyncInfoStore::setCompactionThreshold(size_t threshold) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  compactionThreshold_ = threshold == 0 ? 1 : threshold;
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,155 @@
+//
+//  SyncInfoStore.h
+//  ContactsManagerCore
+//
+//  Persistent per-contact sync metadata (CMContactSyncInfo's hash, sync time
+//  and flags) in fixed-width records keyed by a 64-bit hash of the contact ID.
+//
+//  The file is a sorted, compacted region followed by an append-only tail.
+//  Opening maps the sorted region and looks records up in place by binary
+//  search, so nothing is decoded at launch; only the tail (bounded by the
+//  compaction threshold) is read into memory. Each update appends one record,
+//  and a torn or corrupt tail record left by a crash is truncated away on the
+//  next open. Compaction rewrites the file through a temporary file and
+//  rename, so a crash during it leaves the previous file intact.
+//
+
+#pragma once
+
+#include "StreamingHash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace contactsmanager {
+
+/**
+ * Sync flags (mirror CMContactSyncInfo's BOOL properties)
+ */
+namespace SyncFlag {
+constexpr uint32_t Deleted = 1u << 0;
+constexpr uint32_t Dirty = 1u << 1;
+constexpr uint32_t SyncInProgress = 1u << 2;
+constexpr uint32_t SyncFailed = 1u << 3;
+} // namespace SyncFlag
+
+struct SyncInfoRecord {
+  // contactHash128 of the synced contact
+  Hash128 contentHash;
+  double lastSyncedAt = 0;
+  uint32_t flags = 0;
+
+  bool operator==(const SyncInfoRecord &other) const {
+    return contentHash == other.contentHash && lastSyncedAt == other.lastSyncedAt && flags == other.flags;
+  }
+  bool operator!=(const SyncInfoRecord &other) const { return !(*this == other); }
+};
+
+class SyncInfoStore {
+public:
+  static constexpr size_t kHeaderSize = 32;
+  static constexpr size_t kRecordSize = 40;
+  static constexpr size_t kDefaultCompactionThreshold = 4096;
+
+  SyncInfoStore() = default;
+  ~SyncInfoStore();
+
+  SyncInfoStore(const SyncInfoStore &) = delete;
+  SyncInfoStore &operator=(const SyncInfoStore &) = delete;
+
+  /**
+   * Key records are stored under (64-bit FNV-1a of the contact ID)
+   */
+  static uint64_t keyFor(std::string_view contactId);
+
+  /**
+   * Opens or creates the store at path, dropping any torn or corrupt records
+   * at the end of the tail
+   * @return false if the file cannot be opened or is not a sync-info store
+   */
+  bool open(const std::string &path);
+  void close();
+  bool isOpen() const;
+
+  std::optional<SyncInfoRecord> get(std::string_view contactId) const;
+  std::optional<SyncInfoRecord> getByKey(uint64_t key) const;
+
+  /**
+   * Appends the record; compacts once the tail reaches the threshold
+   * @return false if the record could not be written or the compaction failed
+   */
+  bool put(std::string_view contactId, const SyncInfoRecord &record);
+  bool putByKey(uint64_t key, const SyncInfoRecord &record);
+
+  /**
+   * Appends a tombstone
+   * @return true if the contact had a record
+   */
+  bool remove(std::string_view contactId);
+
+  /**
+   * Visits every live record, in no particular order
+   */
+  void forEach(const std::function<void(uint64_t key, const SyncInfoRecord &record)> &visit) const;
+
+  /**
+   * Rewrites the file as one sorted region without superseded records or tombstones
+   */
+  bool compact();
+
+  /**
+   * Flushes appended records to stable storage
+   */
+  bool sync();
+
+  /**
+   * Drops every record
+   */
+  bool clear();
+
+  size_t size() const;
+  size_t tailRecordCount() const;
+
+  /**
+   * Records dropped by the last open because they were torn or corrupt
+   */
+  size_t discardedRecordCount() const;
+
+  void setCompactionThreshold(size_t threshold);
+
+private:
+  struct TailEntry {
+    SyncInfoRecord record;
+    bool removed = false;
+  };
+
+  bool openLocked(const std::string &path);
+  void closeLocked();
+  bool appendLocked(uint64_t key, const SyncInfoRecord &record, bool removed);
+  bool compactLocked();
+  std::optional<SyncInfoRecord> sortedLookupLocked(uint64_t key) const;
+  std::optional<SyncInfoRecord> getLocked(uint64_t key) const;
+
+  mutable std::mutex mutex_;
+  std::string path_;
+  int fd_ = -1;
+  // Mapping of the header and sorted region
+  const unsigned char *map_ = nullptr;
+  size_t mapLength_ = 0;
+  uint64_t sortedCount_ = 0;
+  uint64_t fileSize_ = 0;
+  // Latest tail record per key
+  std::unordered_map<uint64_t, TailEntry> tail_;
+  size_t tailRecords_ = 0;
+  size_t liveCount_ = 0;
+  size_t discarded_ = 0;
+  size_t compactionThreshold_ = kDefaultCompactionThreshold;
+};
+
+} // namespace contactsmanager
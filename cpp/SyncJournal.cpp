@@ -0,0 +1,317 @@
+//
+//  SyncJournal.cpp
+//  ContactsManagerCore
+//
+
+#include "SyncJournal.h"
+
+#include "BinaryFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace contactsmanager {
+
+// File layout (native byte order, the file never leaves the device):
+//   header:  "CMSJ" version(u32)
+//   record:  type(u32) length(u32) payload checksum(u32 over type, length and payload)
+//   session: sessionId(string); always the first record
+//   begin:   idempotencyKey(string) count(u32) count x (contactKey(u64) hash(2 x u64))
+//   ack, abandon: idempotencyKey(string)
+
+namespace {
+
+constexpr char kFileMagic[4] = {'C', 'M', 'S', 'J'};
+constexpr uint32_t kFileVersion = 1;
+constexpr size_t kHeaderSize = 8;
+constexpr size_t kRecordOverhead = 12;
+constexpr size_t kEntrySize = 24;
+
+enum RecordType : uint32_t {
+  kSessionRecord = 1,
+  kBeginRecord = 2,
+  kAckRecord = 3,
+  kAbandonRecord = 4,
+};
+
+} // namespace
+
+SyncJournal::~SyncJournal() {
+  close();
+}
+
+bool SyncJournal::open(const std::string &path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+  clearStateLocked();
+  discarded_ = 0;
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  std::string data;
+  if (fd_ < 0 || !binary::readFile(path, data)) {
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+    return false;
+  }
+
+  if (data.size() < kHeaderSize) {
+    // New file, or a crash before the header reached the disk
+    fileSize_ = 0;
+    if (!resetLocked()) {
+      ::close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    return true;
+  }
+  binary::Reader header(std::string_view(data).substr(0, kHeaderSize));
+  uint32_t version = 0;
+  if (!header.expect(std::string_view(kFileMagic, sizeof(kFileMagic))) || !header.readUint32(version) ||
+      version != kFileVersion) {
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+
+  // Replay; the first torn or corrupt record ends the journal
+  size_t position = kHeaderSize;
+  while (data.size() - position >= kRecordOverhead) {
+    uint32_t type = 0;
+    uint32_t length = 0;
+    std::memcpy(&type, data.data() + position, sizeof(type));
+    std::memcpy(&length, data.data() + position + 4, sizeof(length));
+    if (length > data.size() - position - kRecordOverhead) {
+      break;
+    }
+    std::string_view framed(data.data() + position, 8 + static_cast<size_t>(length));
+    uint32_t checksum = 0;
+    std::memcpy(&checksum, data.data() + position + framed.size(), sizeof(checksum));
+    if (checksum != binary::checksum32(framed) || !applyLocked(type, framed.substr(8))) {
+      break;
+    }
+    position += framed.size() + sizeof(checksum);
+  }
+  fileSize_ = position;
+  if (position < data.size()) {
+    discarded_ = data.size() - position;
+    if (::ftruncate(fd_, static_cast<off_t>(fileSize_)) != 0) {
+      ::close(fd_);
+      fd_ = -1;
+      clearStateLocked();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SyncJournal::applyLocked(uint32_t type, std::string_view payload) {
+  binary::Reader reader(payload);
+  std::string text;
+  if (!reader.readString(text)) {
+    return false;
+  }
+  if (type == kSessionRecord) {
+    // A session starts the journal; anything else before it is corrupt
+    if (!sessionId_.empty() || text.empty() || !reader.atEnd()) {
+      return false;
+    }
+    sessionId_ = std::move(text);
+    return true;
+  }
+  if (sessionId_.empty()) {
+    return false;
+  }
+
+  switch (type) {
+  case kBeginRecord: {
+    uint32_t count = 0;
+    if (!reader.readUint32(count) || count > payload.size() / kEntrySize) {
+      return false;
+    }
+    Pending batch;
+    batch.sequence = nextBatch_++;
+    batch.entries.resize(count);
+    for (auto &entry : batch.entries) {
+      if (!reader.readUint64(entry.contactKey) || !reader.readUint64(entry.contentHash.low) ||
+          !reader.readUint64(entry.contentHash.high)) {
+        return false;
+      }
+    }
+    if (!reader.atEnd()) {
+      return false;
+    }
+    pending_[std::move(text)] = std::move(batch);
+    return true;
+  }
+  case kAckRecord:
+  case kAbandonRecord: {
+    auto it = pending_.find(text);
+    if (it == pending_.end() || !reader.atEnd()) {
+      return false;
+    }
+    if (type == kAckRecord) {
+      for (const auto &entry : it->second.entries) {
+        acknowledged_[entry.contactKey] = entry.contentHash;
+      }
+    }
+    pending_.erase(it);
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+bool SyncJournal::appendLocked(uint32_t type, std::string_view payload) {
+  if (fd_ < 0) {
+    return false;
+  }
+  std::string record;
+  record.reserve(kRecordOverhead + payload.size());
+  binary::writeUint32(record, type);
+  binary::writeUint32(record, static_cast<uint32_t>(payload.size()));
+  record.append(payload);
+  binary::writeUint32(record, binary::checksum32(record));
+  // The record only counts once it is on stable storage; a crash before that
+  // leaves a torn record the next open drops
+  if (!binary::writeAll(fd_, record.data(), record.size(), static_cast<off_t>(fileSize_)) || ::fsync(fd_) != 0) {
+    return false;
+  }
+  fileSize_ += record.size();
+  return applyLocked(type, payload);
+}
+
+bool SyncJournal::resetLocked() {
+  std::string header(kFileMagic, sizeof(kFileMagic));
+  binary::writeUint32(header, kFileVersion);
+  clearStateLocked();
+  if (::ftruncate(fd_, 0) != 0 || !binary::writeAll(fd_, header.data(), header.size(), 0) || ::fsync(fd_) != 0) {
+    return false;
+  }
+  fileSize_ = header.size();
+  return true;
+}
+
+void SyncJournal::clearStateLocked() {
+  fileSize_ = 0;
+  sessionId_.clear();
+  nextBatch_ = 0;
+  acknowledged_.clear();
+  pending_.clear();
+}
+
+void SyncJournal::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  clearStateLocked();
+}
+
+bool SyncJournal::isOpen() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fd_ >= 0;
+}
+
+std::string SyncJournal::sessionId() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sessionId_;
+}
+
+bool SyncJournal::beginSession(std::string_view sessionId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ < 0 || sessionId.empty() || !resetLocked()) {
+    return false;
+  }
+  std::string payload;
+  binary::writeString(payload, sessionId);
+  return appendLocked(kSessionRecord, payload);
+}
+
+bool SyncJournal::finishSession() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fd_ >= 0 && resetLocked();
+}
+
+std::string SyncJournal::beginBatch(const std::vector<JournalEntry> &entries) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (sessionId_.empty()) {
+    return {};
+  }
+  // Unique within the session and across sessions, so a server that keeps
+  // keys for a while never confuses two syncs
+  std::string key = sessionId_ + "/" + std::to_string(nextBatch_);
+  std::string payload;
+  payload.reserve(key.size() + 8 + entries.size() * kEntrySize);
+  binary::writeString(payload, key);
+  binary::writeUint32(payload, static_cast<uint32_t>(entries.size()));
+  for (const auto &entry : entries) {
+    binary::writeUint64(payload, entry.contactKey);
+    binary::writeUint64(payload, entry.contentHash.low);
+    binary::writeUint64(payload, entry.contentHash.high);
+  }
+  return appendLocked(kBeginRecord, payload) ? key : std::string();
+}
+
+bool SyncJournal::acknowledgeBatch(std::string_view idempotencyKey) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.find(std::string(idempotencyKey)) == pending_.end()) {
+    return false;
+  }
+  std::string payload;
+  binary::writeString(payload, idempotencyKey);
+  return appendLocked(kAckRecord, payload);
+}
+
+bool SyncJournal::abandonBatch(std::string_view idempotencyKey) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.find(std::string(idempotencyKey)) == pending_.end()) {
+    return false;
+  }
+  std::string payload;
+  binary::writeString(payload, idempotencyKey);
+  return appendLocked(kAbandonRecord, payload);
+}
+
+bool SyncJournal::isAcknowledged(const JournalEntry &entry) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = acknowledged_.find(entry.contactKey);
+  return it != acknowledged_.end() && it->second == entry.contentHash;
+}
+
+size_t SyncJournal::acknowledgedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return acknowledged_.size();
+}
+
+std::vector<PendingBatch> SyncJournal::pendingBatches() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<uint64_t, PendingBatch>> ordered;
+  ordered.reserve(pending_.size());
+  for (const auto &entry : pending_) {
+    ordered.push_back({entry.second.sequence, PendingBatch{entry.first, entry.second.entries}});
+  }
+  std::sort(ordered.begin(), ordered.end(),
+            [](const auto &left, const auto &right) { return left.first < right.first; });
+  std::vector<PendingBatch> batches;
+  batches.reserve(ordered.size());
+  for (auto &entry : ordered) {
+    batches.push_back(std::move(entry.second));
+  }
+  return batches;
+}
+
+size_t SyncJournal::discardedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return discarded_;
+}
+
+} // namespace contactsmanager
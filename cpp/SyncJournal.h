@@ -0,0 +1,127 @@
+//
+//  SyncJournal.h
+//  ContactsManagerCore
+//
+//  Durable batch-level checkpoint for a contact upload. Before a batch is sent
+//  its contacts (key and content hash) are recorded under an idempotency key;
+//  once the server acknowledges it, an ack record follows. Both are flushed to
+//  stable storage before the call returns, so after the OS kills a background
+//  sync the next run knows exactly which contacts the server already has and
+//  which batches may or may not have reached it.
+//
+//  The file is append-only: a header, then checksummed records. A torn record
+//  left by a crash is dropped on the next open, which at worst turns an ack
+//  back into a pending batch that is re-sent under the same key.
+//
+
+#pragma once
+
+#include "StreamingHash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+
+struct JournalEntry {
+  // SyncInfoStore::keyFor(contact identifier)
+  uint64_t contactKey = 0;
+  // contactHash128 of the uploaded contact
+  Hash128 contentHash;
+};
+
+struct PendingBatch {
+  std::string idempotencyKey;
+  std::vector<JournalEntry> entries;
+};
+
+class SyncJournal {
+public:
+  SyncJournal() = default;
+  ~SyncJournal();
+
+  SyncJournal(const SyncJournal &) = delete;
+  SyncJournal &operator=(const SyncJournal &) = delete;
+
+  /**
+   * Opens or creates the journal at path and replays it, dropping a torn or
+   * corrupt record at the end
+   * @return false if the file cannot be opened or is not a sync journal
+   */
+  bool open(const std::string &path);
+  void close();
+  bool isOpen() const;
+
+  /**
+   * Session being journaled; empty when no sync is in progress
+   */
+  std::string sessionId() const;
+
+  /**
+   * Discards whatever the journal holds and starts recording sessionId
+   */
+  bool beginSession(std::string_view sessionId);
+
+  /**
+   * Clears the journal once every contact of the session was acknowledged
+   */
+  bool finishSession();
+
+  /**
+   * Records a batch about to be sent and returns its idempotency key, empty on failure
+   */
+  std::string beginBatch(const std::vector<JournalEntry> &entries);
+
+  bool acknowledgeBatch(std::string_view idempotencyKey);
+
+  /**
+   * Drops a pending batch that will not be re-sent (its contacts changed or
+   * were acknowledged by other batches)
+   */
+  bool abandonBatch(std::string_view idempotencyKey);
+
+  /**
+   * True if the server acknowledged the contact at this content hash in the current session
+   */
+  bool isAcknowledged(const JournalEntry &entry) const;
+
+  size_t acknowledgedCount() const;
+
+  /**
+   * Batches that were begun but neither acknowledged nor abandoned, in begin order
+   */
+  std::vector<PendingBatch> pendingBatches() const;
+
+  /**
+   * Bytes dropped from the end by the last open because they were torn or corrupt
+   */
+  size_t discardedBytes() const;
+
+private:
+  struct Pending {
+    // Begin order
+    uint64_t sequence = 0;
+    std::vector<JournalEntry> entries;
+  };
+
+  bool appendLocked(uint32_t type, std::string_view payload);
+  bool applyLocked(uint32_t type, std::string_view payload);
+  bool resetLocked();
+  void clearStateLocked();
+
+  mutable std::mutex mutex_;
+  int fd_ = -1;
+  uint64_t fileSize_ = 0;
+  std::string sessionId_;
+  uint64_t nextBatch_ = 0;
+  std::unordered_map<uint64_t, Hash128> acknowledged_;
+  std::unordered_map<std::string, Pending> pending_;
+  size_t discarded_ = 0;
+};
+
+} // namespace contactsmanager
@@ -0,0 +1,96 @@
+//
+//  SyncWireFormat.cpp
+//  ContactsManagerCore
+//
+
+#include "SyncWireFormat.h"
+
+#include "BulkCreateBodyStream.h"
+#include "TextUtils.h"
+
+namespace contactsmanager {
+
+namespace {
+
+bool equalsIgnoringCase(std::string_view left, std::string_view right) {
+  if (left.size() != right.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < left.size(); ++i) {
+    if (text::toLowerAscii(left[i]) != text::toLowerAscii(right[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// True if the comma-separated header lists token with a non-zero q value
+bool listsToken(std::string_view header, std::string_view token) {
+  while (!header.empty()) {
+    size_t comma = header.find(',');
+    std::string_view item = header.substr(0, comma);
+    header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+
+    size_t semicolon = item.find(';');
+    if (!equalsIgnoringCase(text::trimmed(item.substr(0, semicolon)), token)) {
+      continue;
+    }
+    bool refused = false;
+    while (semicolon != std::string_view::npos) {
+      item.remove_prefix(semicolon + 1);
+      semicolon = item.find(';');
+      std::string_view parameter = text::trimmed(item.substr(0, semicolon));
+      if (parameter.size() >= 2 && (parameter[0] == 'q' || parameter[0] == 'Q') && parameter[1] == '=') {
+        std::string_view value = text::trimmed(parameter.substr(2));
+        refused = value.find_first_not_of("0.") == std::string_view::npos;
+      }
+    }
+    if (!refused) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+const char *wireContentType(WireFormat format) {
+  return format == WireFormat::Cbor ? "application/cbor" : "application/json";
+}
+
+const char *wireContentEncoding(WireCompression compression) {
+  switch (compression) {
+  case WireCompression::Deflate:
+    return "deflate";
+  case WireCompression::Gzip:
+    return "gzip";
+  case WireCompression::None:
+    break;
+  }
+  return "";
+}
+
+WireEncoding negotiateWireEncoding(std::string_view accept, std::string_view acceptEncoding) {
+  WireEncoding encoding;
+  if (listsToken(accept, wireContentType(WireFormat::Cbor))) {
+    encoding.format = WireFormat::Cbor;
+  }
+  if (listsToken(acceptEncoding, "deflate")) {
+    encoding.compression = WireCompression::Deflate;
+  } else if (listsToken(acceptEncoding, "gzip")) {
+    encoding.compression = WireCompression::Gzip;
+  }
+  return encoding;
+}
+
+std::string encodeBulkCreateBody(const Contact *first, size_t count, const ServerContactContext &context,
+                                 bool skipDuplicates, WireEncoding encoding) {
+  BulkCreateBodyStream stream(first, count, context, skipDuplicates, encoding);
+  std::string body;
+  for (std::string_view chunk = stream.nextChunk(); !chunk.empty(); chunk = stream.nextChunk()) {
+    body.append(chunk);
+  }
+  return stream.failed() ? std::string() : body;
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,73 @@
+//
+//  SyncWireFormat.h
+//  ContactsManagerCore
+//
+//  Optional compact encodings for /contacts sync bodies. The document is the
+//  same as the JSON body (ServerContactJson), written as CBOR with shared
+//  strings and/or compressed with deflate or gzip. The server advertises what
+//  it accepts; the client picks from that and labels the request with the
+//  matching Content-Type and Content-Encoding, falling back to plain JSON.
+//
+//  Bodies are produced in one pass by BulkCreateBodyStream: each contact is
+//  serialized and handed to the compressor straight away, so neither an
+//  object graph nor the uncompressed body is ever held.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "ServerContactJson.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace contactsmanager {
+
+enum class WireFormat : uint8_t {
+  Json,
+  Cbor,
+};
+
+enum class WireCompression : uint8_t {
+  None,
+  Deflate,
+  Gzip,
+};
+
+struct WireEncoding {
+  WireFormat format = WireFormat::Json;
+  WireCompression compression = WireCompression::None;
+
+  bool operator==(const WireEncoding &other) const {
+    return format == other.format && compression == other.compression;
+  }
+  bool operator!=(const WireEncoding &other) const { return !(*this == other); }
+};
+
+/**
+ * Content-Type header value
+ */
+const char *wireContentType(WireFormat format);
+
+/**
+ * Content-Encoding header value; empty for no compression
+ */
+const char *wireContentEncoding(WireCompression compression);
+
+/**
+ * Picks the request encoding from the server's Accept and Accept-Encoding
+ * values. CBOR and compression are only used when listed (q=0 counts as not
+ * listed); deflate is preferred over gzip for its smaller framing.
+ */
+WireEncoding negotiateWireEncoding(std::string_view accept, std::string_view acceptEncoding);
+
+/**
+ * CMServerContactBulkCreate body for contacts [first, first + count) in the
+ * given encoding; empty if compression failed
+ */
+std::string encodeBulkCreateBody(const Contact *first, size_t count, const ServerContactContext &context,
+                                 bool skipDuplicates, WireEncoding encoding);
+
+} // namespace contactsmanager
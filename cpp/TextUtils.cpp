@@ -0,0 +1,146 @@
+//
+//  TextUtils.cpp
+//  ContactsManagerCore
+//
+
+#include "TextUtils.h"
+
+namespace contactsmanager {
+namespace text {
+
+namespace {
+
+// ASCII base letter for U+00C0-U+00FF; '\0' marks entries spelled out in
+// latin1Expansion or left alone (multiplication and division signs)
+const char kLatin1Base[64 + 1] =
+    "aaaaaa\0ceeeeiiii"   // U+00C0 - U+00CF
+    "dnooooo\0ouuuuy\0\0" // U+00D0 - U+00DF
+    "aaaaaa\0ceeeeiiii"   // U+00E0 - U+00EF
+    "dnooooo\0ouuuuy\0y";  // U+00F0 - U+00FF
+
+// ASCII base letter for U+0100-U+017F, upper and lower case alternating
+const char kLatinExtendedABase[128 + 1] =
+    "aaaaaaccccccccdd"   // U+0100 - U+010F
+    "ddeeeeeeeeeegggg"   // U+0110 - U+011F
+    "gggghhhhiiiiiiii"   // U+0120 - U+012F
+    "ii\0\0jjkkklllllll" // U+0130 - U+013F
+    "lllnnnnnnnnnoooo"   // U+0140 - U+014F
+    "oo\0\0rrrrrrssssss" // U+0150 - U+015F
+    "ssttttttuuuuuuuu"   // U+0160 - U+016F
+    "uuuuwwyyyzzzzzzs";  // U+0170 - U+017F
+
+const char *latin1Expansion(unsigned codepoint) {
+  switch (codepoint) {
+  case 0xC6:
+  case 0xE6:
+    return "ae";
+  case 0xDE:
+  case 0xFE:
+    return "th";
+  case 0xDF:
+    return "ss";
+  case 0x132:
+  case 0x133:
+    return "ij";
+  case 0x152:
+  case 0x153:
+    return "oe";
+  default:
+    return nullptr;
+  }
+}
+
+} // namespace
+
+void appendLowercased(std::string &out, std::string_view in) {
+  size_t offset = out.size();
+  out.resize(offset + in.size());
+  for (size_t i = 0; i < in.size(); ++i) {
+    out[offset + i] = toLowerAscii(in[i]);
+  }
+}
+
+std::string lowercased(std::string_view in) {
+  std::string out;
+  appendLowercased(out, in);
+  return out;
+}
+
+void appendFolded(std::string &out, std::string_view in) {
+  out.reserve(out.size() + in.size());
+  for (size_t i = 0; i < in.size(); ++i) {
+    unsigned char lead = static_cast<unsigned char>(in[i]);
+    if (lead < 0x80) {
+      out.push_back(toLowerAscii(static_cast<char>(lead)));
+      continue;
+    }
+    if (lead >= 0xC3 && lead <= 0xC5 && i + 1 < in.size()) {
+      unsigned char trail = static_cast<unsigned char>(in[i + 1]);
+      if ((trail & 0xC0) == 0x80) {
+        unsigned codepoint = ((lead & 0x1Fu) << 6) | (trail & 0x3Fu);
+        char base = 0;
+        if (codepoint >= 0xC0 && codepoint <= 0xFF) {
+          base = kLatin1Base[codepoint - 0xC0];
+        } else if (codepoint >= 0x100 && codepoint <= 0x17F) {
+          base = kLatinExtendedABase[codepoint - 0x100];
+        }
+        const char *expansion = base ? nullptr : latin1Expansion(codepoint);
+        if (base || expansion) {
+          if (base) {
+            out.push_back(base);
+          } else {
+            out.append(expansion);
+          }
+          ++i;
+          continue;
+        }
+      }
+    }
+    out.push_back(static_cast<char>(lead));
+  }
+}
+
+std::string folded(std::string_view in) {
+  std::string out;
+  appendFolded(out, in);
+  return out;
+}
+
+std::string_view trimmed(std::string_view in) {
+  size_t begin = 0;
+  size_t end = in.size();
+  while (begin < end && isAsciiSpace(in[begin])) {
+    ++begin;
+  }
+  while (end > begin && isAsciiSpace(in[end - 1])) {
+    --end;
+  }
+  return in.substr(begin, end - begin);
+}
+
+bool containsCaseInsensitive(std::string_view haystack, std::string_view needle) {
+  if (needle.empty()) {
+    return true;
+  }
+  if (needle.size() > haystack.size()) {
+    return false;
+  }
+  char first = toLowerAscii(needle[0]);
+  size_t last = haystack.size() - needle.size();
+  for (size_t i = 0; i <= last; ++i) {
+    if (toLowerAscii(haystack[i]) != first) {
+      continue;
+    }
+    size_t j = 1;
+    while (j < needle.size() && toLowerAscii(haystack[i + j]) == toLowerAscii(needle[j])) {
+      ++j;
+    }
+    if (j == needle.size()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace text
+} // namespace contactsmanager
@@ -0,0 +1,75 @@
+//
+//  TextUtils.h
+//  ContactsManagerCore
+//
+//  Byte-level string helpers shared by the match string, hashing and search code.
+//  Strings are UTF-8; only ASCII bytes are case folded, apart from the Latin
+//  transliteration in appendFolded.
+//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace contactsmanager {
+namespace text {
+
+inline char toLowerAscii(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+inline char toUpperAscii(char c) {
+  return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+inline bool isAsciiAlpha(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline bool isAsciiDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+inline bool isAsciiAlnum(char c) {
+  return isAsciiAlpha(c) || isAsciiDigit(c);
+}
+
+inline bool isAsciiSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/**
+ * Appends the ASCII-lowercased copy of the input to the output buffer
+ */
+void appendLowercased(std::string &out, std::string_view in);
+
+/**
+ * Returns the ASCII-lowercased copy of the input
+ */
+std::string lowercased(std::string_view in);
+
+/**
+ * Appends the lowercased input with Latin diacritics folded to ASCII
+ * ("José Ørsted" -> "jose orsted", "ß" -> "ss"). Covers Latin-1 Supplement
+ * and Latin Extended-A; other bytes are copied unchanged.
+ */
+void appendFolded(std::string &out, std::string_view in);
+
+/**
+ * Returns the lowercased, diacritic-folded copy of the input
+ */
+std::string folded(std::string_view in);
+
+/**
+ * Returns the input without leading and trailing ASCII whitespace
+ */
+std::string_view trimmed(std::string_view in);
+
+/**
+ * Returns true if the haystack contains the needle, comparing ASCII case-insensitively
+ */
+bool containsCaseInsensitive(std::string_view haystack, std::string_view needle);
+
+} // namespace text
+} // namespace contactsmanager
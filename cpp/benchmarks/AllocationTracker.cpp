@@ -0,0 +1,85 @@
+//
+//  AllocationTracker.cpp
+//  ContactsManagerCore
+//
+
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace contactsmanager {
+namespace benchmark {
+
+namespace {
+
+std::atomic<size_t> gLiveBytes{0};
+std::atomic<size_t> gPeakBytes{0};
+std::atomic<size_t> gAllocations{0};
+
+// Keeps the payload aligned for any fundamental type
+constexpr size_t kHeaderSize = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+
+void *trackedAllocate(size_t size) {
+  void *block = std::malloc(size + kHeaderSize);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *static_cast<size_t *>(block) = size;
+  size_t live = gLiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+  size_t peak = gPeakBytes.load(std::memory_order_relaxed);
+  while (live > peak && !gPeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  gAllocations.fetch_add(1, std::memory_order_relaxed);
+  return static_cast<char *>(block) + kHeaderSize;
+}
+
+void trackedFree(void *pointer) {
+  if (!pointer) {
+    return;
+  }
+  void *block = static_cast<char *>(pointer) - kHeaderSize;
+  gLiveBytes.fetch_sub(*static_cast<size_t *>(block), std::memory_order_relaxed);
+  std::free(block);
+}
+
+} // namespace
+
+AllocationStats allocationStats() {
+  return {gLiveBytes.load(std::memory_order_relaxed), gPeakBytes.load(std::memory_order_relaxed),
+          gAllocations.load(std::memory_order_relaxed)};
+}
+
+void resetAllocationPeak() {
+  gPeakBytes.store(gLiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  gAllocations.store(0, std::memory_order_relaxed);
+}
+
+} // namespace benchmark
+} // namespace contactsmanager
+
+void *operator new(size_t size) {
+  return contactsmanager::benchmark::trackedAllocate(size);
+}
+
+void *operator new[](size_t size) {
+  return contactsmanager::benchmark::trackedAllocate(size);
+}
+
+void operator delete(void *pointer) noexcept {
+  contactsmanager::benchmark::trackedFree(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+  contactsmanager::benchmark::trackedFree(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+  contactsmanager::benchmark::trackedFree(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+  contactsmanager::benchmark::trackedFree(pointer);
+}
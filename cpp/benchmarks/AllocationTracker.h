@@ -0,0 +1,52 @@
+//
+//  AllocationTracker.h
+//  ContactsManagerCore
+//
+//  Heap accounting for the benchmark drivers. AllocationTracker.cpp replaces
+//  the global operator new/delete, so live and peak heap bytes can be sampled
+//  per phase rather than only as process-wide peak RSS.
+//
+
+#pragma once
+
+#include <cstddef>
+
+namespace contactsmanager {
+namespace benchmark {
+
+struct AllocationStats {
+  size_t liveBytes = 0;
+  size_t peakBytes = 0;
+  size_t allocations = 0;
+};
+
+AllocationStats allocationStats();
+
+/**
+ * Resets the peak to the current live byte count and zeroes the allocation counter
+ */
+void resetAllocationPeak();
+
+/**
+ * Tracks the heap growth of one benchmark phase
+ */
+class AllocationScope {
+public:
+  AllocationScope() : baseline_((resetAllocationPeak(), allocationStats().liveBytes)) {}
+
+  /**
+   * Highest heap usage above the starting point since construction
+   */
+  size_t peakBytes() const {
+    size_t peak = allocationStats().peakBytes;
+    return peak > baseline_ ? peak - baseline_ : 0;
+  }
+
+  size_t allocations() const { return allocationStats().allocations; }
+
+private:
+  size_t baseline_;
+};
+
+} // namespace benchmark
+} // namespace contactsmanager
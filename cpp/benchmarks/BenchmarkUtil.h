@@ -0,0 +1,135 @@
+//
+//  BenchmarkUtil.h
+//  ContactsManagerCore
+//
+//  Timing, memory and argument helpers shared by the benchmark drivers.
+//  Every driver accepts --quick (small sizes, used by ctest) and
+//  --sizes=1000,10000 to override the address book sizes.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace contactsmanager {
+namespace benchmark {
+
+class Stopwatch {
+public:
+  Stopwatch() : start_(Clock::now()) {}
+
+  void reset() { start_ = Clock::now(); }
+
+  double elapsedSeconds() const {
+    return std::chrono::duration<double>(Clock::now() - start_).count();
+  }
+
+  double elapsedMillis() const { return elapsedSeconds() * 1000.0; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start_;
+};
+
+/**
+ * Peak resident set size of this process in bytes, or 0 when unavailable
+ */
+inline size_t peakRssBytes() {
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  return static_cast<size_t>(usage.ru_maxrss);
+#else
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
+struct BenchmarkArgs {
+  bool quick = false;
+  std::vector<size_t> sizes;
+};
+
+/**
+ * Parses --quick and --sizes=...; defaultSizes apply when --sizes is absent,
+ * quickSizes when --quick is given
+ */
+inline BenchmarkArgs parseBenchmarkArgs(int argc, char **argv, std::vector<size_t> defaultSizes,
+                                        std::vector<size_t> quickSizes) {
+  BenchmarkArgs args;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--quick") == 0) {
+      args.quick = true;
+    } else if (std::strncmp(argv[i], "--sizes=", 8) == 0) {
+      const char *cursor = argv[i] + 8;
+      while (*cursor) {
+        char *end = nullptr;
+        unsigned long long value = std::strtoull(cursor, &end, 10);
+        if (end == cursor) {
+          break;
+        }
+        args.sizes.push_back(static_cast<size_t>(value));
+        cursor = *end == ',' ? end + 1 : end;
+      }
+    }
+  }
+  if (args.sizes.empty()) {
+    args.sizes = args.quick ? std::move(quickSizes) : std::move(defaultSizes);
+  }
+  return args;
+}
+
+/**
+ * Prints one result row: name, input size, wall time and throughput
+ */
+inline void reportResult(const char *name, size_t size, double seconds, double operations,
+                         const char *unit = "ops") {
+  double rate = seconds > 0 ? operations / seconds : 0;
+  std::printf("%-36s n=%-8zu %10.3f ms %14.0f %s/s\n", name, size, seconds * 1000.0, rate, unit);
+}
+
+/**
+ * Prints one result row for a size measurement in bytes
+ */
+inline void reportBytes(const char *name, size_t size, double bytes) {
+  std::printf("%-36s n=%-8zu %14.0f bytes (%.2f MiB)\n", name, size, bytes, bytes / (1024.0 * 1024.0));
+}
+
+/**
+ * Prints one result row for a plain count
+ */
+inline void reportCount(const char *name, size_t size, double count, const char *unit) {
+  std::printf("%-36s n=%-8zu %14.0f %s\n", name, size, count, unit);
+}
+
+/**
+ * Keeps the optimizer from discarding a computed value
+ */
+template <typename T>
+inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const T *sink;
+  sink = &value;
+#endif
+}
+
+} // namespace benchmark
+} // namespace contactsmanager
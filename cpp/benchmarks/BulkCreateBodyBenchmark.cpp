@@ -0,0 +1,133 @@
+//
+//  BulkCreateBodyBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Memory and throughput of producing one bulk-create body three ways:
+//  streamed through 64 KiB reads as a chunked HTTP body would be, written
+//  whole into one string, and the toDictionary shape the iOS client uses
+//  today, modelled as a JsonValue tree per contact serialized at the end.
+//
+//  Phases run smallest first so the process peak RSS printed after each one
+//  shows its growth; the heap peak is per phase.
+//
+
+#include "AllocationTracker.h"
+#include "BenchmarkUtil.h"
+#include "BulkCreateBodyStream.h"
+#include "JsonValue.h"
+#include "ServerContactJson.h"
+#include "SyntheticAddressBook.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+using testing::JsonValue;
+
+namespace {
+
+const ServerContactContext kContext{"org-benchmark", "source-benchmark"};
+constexpr size_t kReadSize = 64 * 1024;
+
+void writeTree(JsonWriter &writer, const JsonValue &value) {
+  switch (value.type) {
+  case JsonValue::Type::Null:
+    writer.nullValue();
+    break;
+  case JsonValue::Type::Bool:
+    writer.boolValue(value.boolean);
+    break;
+  case JsonValue::Type::Number:
+    writer.doubleValue(value.number);
+    break;
+  case JsonValue::Type::String:
+    writer.stringValue(value.string);
+    break;
+  case JsonValue::Type::Array:
+    writer.beginArray();
+    for (const auto &item : value.array) {
+      writeTree(writer, item);
+    }
+    writer.endArray();
+    break;
+  case JsonValue::Type::Object:
+    writer.beginObject();
+    for (const auto &member : value.object) {
+      writer.key(member.first);
+      writeTree(writer, member.second);
+    }
+    writer.endObject();
+    break;
+  }
+}
+
+void reportPhase(const char *name, size_t size, double seconds, const AllocationScope &scope) {
+  reportResult(name, size, seconds, static_cast<double>(size), "contacts");
+  reportBytes(name, size, static_cast<double>(scope.peakBytes()));
+  reportBytes("  process peak rss", size, static_cast<double>(peakRssBytes()));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {1000, 5000, 20000}, {500});
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+    size_t streamedBytes = 0;
+    {
+      AllocationScope scope;
+      Stopwatch stopwatch;
+      BulkCreateBodyStream stream(book.data(), book.size(), kContext, false);
+      std::vector<char> buffer(kReadSize);
+      while (size_t length = stream.read(buffer.data(), buffer.size())) {
+        streamedBytes += length;
+        doNotOptimize(buffer);
+      }
+      reportPhase("stream, 64 KiB reads", size, stopwatch.elapsedSeconds(), scope);
+    }
+
+    size_t wholeBytes = 0;
+    {
+      AllocationScope scope;
+      Stopwatch stopwatch;
+      std::string body = encodeBulkCreateBody(book, kContext, false);
+      wholeBytes = body.size();
+      doNotOptimize(body);
+      reportPhase("whole body string", size, stopwatch.elapsedSeconds(), scope);
+    }
+
+    {
+      // Building the tree by parsing is not what Foundation does, so only the
+      // serialize step is timed; the heap peak covers tree and output together
+      AllocationScope scope;
+      JsonValue tree;
+      tree.type = JsonValue::Type::Object;
+      JsonValue contacts;
+      contacts.type = JsonValue::Type::Array;
+      std::string json;
+      for (const auto &contact : book) {
+        json.clear();
+        JsonWriter writer(json);
+        writeServerContact(writer, contact, kContext);
+        contacts.array.push_back(*JsonValue::parse(json));
+      }
+      tree.set("contacts", std::move(contacts));
+      tree.set("skipDuplicates", JsonValue::makeBool(false));
+      Stopwatch stopwatch;
+      std::string body;
+      JsonWriter writer(body);
+      writeTree(writer, tree);
+      doNotOptimize(body);
+      reportPhase("object tree + serialize", size, stopwatch.elapsedSeconds(), scope);
+    }
+
+    if (streamedBytes != wholeBytes) {
+      std::fprintf(stderr, "streamed %zu bytes, expected %zu\n", streamedBytes, wholeBytes);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,135 @@
+//
+//  CanonicalMatchBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Latency of resolving a getContactsUsingApp page to device contacts: a scan
+//  of the book per result (what a store query per result amounts to) against
+//  the canonical match index, and a repeated screen served from its cache.
+//  Index build, incremental update and persistence costs are reported too.
+//
+
+#include "BenchmarkUtil.h"
+#include "CanonicalMatchIndex.h"
+#include "PhoneNumberKey.h"
+#include "SyntheticAddressBook.h"
+#include "TextUtils.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr size_t kResultCount = 200;
+constexpr uint16_t kCountryCode = 1;
+constexpr double kNow = 1700000000;
+
+std::vector<LocalCanonicalContact> makeResults(const std::vector<Contact> &book) {
+  testing::SplitMix64 random(11);
+  std::vector<LocalCanonicalContact> results;
+  for (size_t i = 0; i < kResultCount; ++i) {
+    const Contact &contact = book[random.nextBelow(book.size())];
+    LocalCanonicalContact entry;
+    entry.contactId = "server-" + std::to_string(i);
+    entry.canonicalContact.identifier = "canonical-" + std::to_string(i);
+    entry.canonicalContact.fullName = contact.displayName;
+    // Half the results name a source contact that has since been re-created
+    entry.sourceContactId = i % 2 == 0 ? contact.identifier : "deleted-" + std::to_string(i);
+    if (!contact.phoneNumbers.empty()) {
+      PhoneKey key = phoneKeyFor(contact.phoneNumbers[0].value, kCountryCode);
+      entry.canonicalContact.phone = "+" + std::to_string(key.digits());
+    }
+    if (!contact.emailAddresses.empty()) {
+      entry.canonicalContact.email = contact.emailAddresses[0].value;
+    }
+    results.push_back(std::move(entry));
+  }
+  return results;
+}
+
+std::string scanForMatch(const std::vector<Contact> &book, const LocalCanonicalContact &entry) {
+  const CanonicalContact &canonical = entry.canonicalContact;
+  PhoneKey phone = phoneKeyFor(canonical.phone, kCountryCode);
+  std::string email = text::lowercased(canonical.email);
+  for (const auto &contact : book) {
+    if (contact.identifier == entry.sourceContactId) {
+      return contact.identifier;
+    }
+  }
+  for (const auto &contact : book) {
+    for (const auto &number : contact.phoneNumbers) {
+      if (phone.valid() && phoneKeyFor(number.value, kCountryCode) == phone) {
+        return contact.identifier;
+      }
+    }
+    for (const auto &address : contact.emailAddresses) {
+      if (!email.empty() && text::lowercased(address.value) == email) {
+        return contact.identifier;
+      }
+    }
+  }
+  return {};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000}, {2000});
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+    std::vector<LocalCanonicalContact> results = makeResults(book);
+    double pageOperations = static_cast<double>(results.size());
+
+    Stopwatch stopwatch;
+    size_t scanned = 0;
+    for (const auto &entry : results) {
+      scanned += scanForMatch(book, entry).empty() ? 0 : 1;
+    }
+    reportResult("page: scan per result", size, stopwatch.elapsedSeconds(), pageOperations, "results");
+
+    CanonicalMatchIndex index(CanonicalMatchOptions{kCountryCode, 300});
+    stopwatch.reset();
+    index.syncWith(book);
+    reportResult("index: build", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "contacts");
+
+    stopwatch.reset();
+    size_t joined = 0;
+    for (const auto &entry : results) {
+      joined += index.resolveLocalContact(entry).empty() ? 0 : 1;
+    }
+    reportResult("page: hash join", size, stopwatch.elapsedSeconds(), pageOperations, "results");
+    if (joined != scanned) {
+      std::fprintf(stderr, "hash join matched %zu results, scan matched %zu\n", joined, scanned);
+      return 1;
+    }
+
+    index.storeContactsUsingApp(results, kResultCount, kNow);
+    stopwatch.reset();
+    CachedCanonicalMatches cached = index.contactsUsingApp(kResultCount, kNow + 60);
+    reportResult("page: cached screen", size, stopwatch.elapsedSeconds(), pageOperations, "results");
+    doNotOptimize(cached);
+
+    // A sync that touched 1% of the book
+    std::vector<Contact> edited = book;
+    for (size_t i = 0; i < edited.size(); i += 100) {
+      edited[i].emailAddresses.push_back({edited[i].identifier, "new" + std::to_string(i) + "@example.com", "work", ""});
+    }
+    stopwatch.reset();
+    size_t changed = index.syncWith(edited);
+    reportResult("index: incremental sync", size, stopwatch.elapsedSeconds(), static_cast<double>(changed),
+                 "contacts");
+
+    std::string path = "cm_canonical_match_benchmark.bin";
+    stopwatch.reset();
+    index.save(path);
+    CanonicalMatchIndex loaded(CanonicalMatchOptions{kCountryCode, 300});
+    loaded.load(path);
+    reportResult("index: save + load", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "contacts");
+    std::remove(path.c_str());
+  }
+  return 0;
+}
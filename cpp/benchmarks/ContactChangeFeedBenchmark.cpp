@@ -0,0 +1,85 @@
+//
+//  ContactChangeFeedBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Finds the contacts changed since the last sync after a small batch of
+//  edits, once by rehashing the whole address book and once by replaying the
+//  store's change history and fetching only the changed contacts. Reports wall
+//  time and the number of store records materialized by each.
+//
+
+#include "BenchmarkUtil.h"
+#include "ContactChangeFeed.h"
+#include "SimulatedContactStore.h"
+#include "SyntheticAddressBook.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr size_t kEdits = 100;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000}, {1000});
+
+  for (size_t size : args.sizes) {
+    testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(size));
+    testing::SimulatedChangeHistory history(store);
+    ContactScan scan = [&store](const std::function<bool(Contact &&)> &emit) { store.enumerate(emit); };
+
+    ContactChangeTracker tracker;
+    tracker.commit(tracker.pendingChanges(history, scan));
+
+    // Edit, delete and add a few contacts the way a user would between two syncs
+    testing::SplitMix64 random(size);
+    for (size_t i = 0; i < kEdits; ++i) {
+      std::string identifier = "contact-" + std::to_string(random.nextBelow(size));
+      if (i % 10 == 0) {
+        store.removeContact(identifier);
+      } else if (i % 10 == 1) {
+        store.addContact(testing::makeSyntheticContact(size + i, random));
+      } else {
+        Contact contact = testing::makeSyntheticContact(0, random);
+        contact.identifier = identifier;
+        store.updateContact(std::move(contact));
+      }
+    }
+
+    size_t expectedChanges = 0;
+    {
+      store.resetCounters();
+      Stopwatch stopwatch;
+      ContactChangeSet changes = tracker.pendingChanges(scan);
+      expectedChanges = changes.added.size() + changes.updated.size() + changes.deleted.size();
+      doNotOptimize(changes.hashes.size());
+      reportResult("full rehash", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "contacts");
+      reportCount("full rehash records read", size, static_cast<double>(store.recordsRead()), "records");
+    }
+
+    {
+      store.resetCounters();
+      Stopwatch stopwatch;
+      ContactChangeSet changes = tracker.pendingChanges(history, scan);
+      std::vector<std::string> changed = changes.added;
+      changed.insert(changed.end(), changes.updated.begin(), changes.updated.end());
+      std::vector<Contact> contacts = store.fetchContacts(changed);
+      doNotOptimize(contacts.data());
+      double seconds = stopwatch.elapsedSeconds();
+      size_t found = changes.added.size() + changes.updated.size() + changes.deleted.size();
+      reportResult("change history", size, seconds, static_cast<double>(size), "contacts");
+      reportCount("change history records read", size, static_cast<double>(store.recordsRead()), "records");
+      if (changes.fullScan || found != expectedChanges) {
+        std::fprintf(stderr, "change history found %zu changes, full rehash %zu\n", found, expectedChanges);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
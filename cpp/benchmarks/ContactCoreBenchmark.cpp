@@ -0,0 +1,57 @@
+//
+//  ContactCoreBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Baseline throughput for the contact hot paths: building display info and
+//  match strings, hashing, and diffing two snapshots of the same book.
+//
+
+#include "BenchmarkUtil.h"
+#include "ContactHashing.h"
+#include "SyntheticAddressBook.h"
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {1000, 10000, 100000, 500000}, {1000});
+
+  for (size_t size : args.sizes) {
+    Stopwatch stopwatch;
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+    reportResult("generate", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "contacts");
+
+    stopwatch.reset();
+    size_t matchBytes = 0;
+    for (auto &contact : book) {
+      contact.updateDisplayInfo();
+      matchBytes += contact.matchString.size();
+    }
+    doNotOptimize(matchBytes);
+    reportResult("updateDisplayInfo", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "contacts");
+
+    stopwatch.reset();
+    size_t hashBytes = 0;
+    for (const auto &contact : book) {
+      hashBytes += generateContactHash(contact).size();
+    }
+    doNotOptimize(hashBytes);
+    reportResult("generateContactHash", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "contacts");
+
+    std::vector<Contact> snapshot = book;
+    for (size_t i = 0; i < snapshot.size(); i += 100) {
+      snapshot[i].jobTitle += " (updated)";
+    }
+    stopwatch.reset();
+    size_t changed = 0;
+    for (size_t i = 0; i < book.size(); ++i) {
+      if (!book[i].isEqualToContact(snapshot[i])) {
+        ++changed;
+      }
+    }
+    doNotOptimize(changed);
+    reportResult("isEqualToContact diff", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "contacts");
+    reportBytes("peak rss", size, static_cast<double>(peakRssBytes()));
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+//
+//  ContactCursorBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Walks a whole address book page by page through the batchSize/batchIndex
+//  API, which re-enumerates the store from the start on every call, and
+//  through a ContactCursor that enumerates it once. Reports wall time and the
+//  number of store records materialized; the batch walk grows quadratically,
+//  the cursor linearly.
+//
+
+#include "BenchmarkUtil.h"
+#include "ContactCursor.h"
+#include "SimulatedContactStore.h"
+#include "SyntheticAddressBook.h"
+
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr size_t kPageSize = 100;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {1000, 5000, 20000}, {500});
+
+  for (size_t size : args.sizes) {
+    testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(size));
+
+    {
+      store.resetCounters();
+      Stopwatch stopwatch;
+      size_t delivered = 0;
+      for (size_t batchIndex = 0;; ++batchIndex) {
+        std::vector<Contact> batch = store.fetchBatch(kPageSize, batchIndex);
+        delivered += batch.size();
+        doNotOptimize(batch.data());
+        if (batch.size() < kPageSize) {
+          break;
+        }
+      }
+      reportResult("batch index walk", size, stopwatch.elapsedSeconds(), static_cast<double>(delivered),
+                   "contacts");
+      reportCount("batch index records read", size, static_cast<double>(store.recordsRead()), "records");
+    }
+
+    {
+      store.resetCounters();
+      Stopwatch stopwatch;
+      size_t delivered = 0;
+      ContactCursor<Contact> cursor(
+          1, [&store](const std::function<bool(Contact &&)> &emit) { store.enumerate(emit); });
+      CursorToken token = cursor.firstToken();
+      for (;;) {
+        CursorPage<Contact> page = cursor.next(token, kPageSize);
+        delivered += page.items.size();
+        doNotOptimize(page.items.data());
+        if (page.done || page.status != CursorStatus::Ok) {
+          break;
+        }
+        token = page.next;
+      }
+      reportResult("cursor walk", size, stopwatch.elapsedSeconds(), static_cast<double>(delivered), "contacts");
+      reportCount("cursor records read", size, static_cast<double>(store.recordsRead()), "records");
+    }
+
+    {
+      // A list view that fills after two pages: the cursor stops reading the store
+      store.resetCounters();
+      Stopwatch stopwatch;
+      auto cursor = std::make_unique<ContactCursor<Contact>>(
+          1, [&store](const std::function<bool(Contact &&)> &emit) { store.enumerate(emit); });
+      CursorPage<Contact> first = cursor->next(cursor->firstToken(), kPageSize);
+      CursorPage<Contact> second = cursor->next(first.next, kPageSize);
+      doNotOptimize(second.items.data());
+      cursor.reset();
+      reportResult("cursor first two pages", size, stopwatch.elapsedSeconds(),
+                   static_cast<double>(first.items.size() + second.items.size()), "contacts");
+      reportCount("cursor first two pages records read", size, static_cast<double>(store.recordsRead()), "records");
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,102 @@
+//
+//  ContactDedupBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Runs duplicate detection over synthetic books with 5% injected duplicates
+//  and reports time, candidate pairs per contact, and pairwise precision and
+//  recall against the injected pairs. The generated base book reuses names
+//  and can repeat an email address; pairs of base contacts with the same name
+//  and a shared address are real duplicates too, and pairs between them (or
+//  their copies) are left out of the precision count rather than scored as
+//  false positives.
+//
+
+#include "BenchmarkUtil.h"
+#include "ContactDeduplication.h"
+#include "SyntheticAddressBook.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr double kDuplicateRate = 0.05;
+
+bool generatedTwice(const Contact &lhs, const Contact &rhs) {
+  if (lhs.givenName != rhs.givenName || lhs.familyName != rhs.familyName) {
+    return false;
+  }
+  for (const auto &left : lhs.emailAddresses) {
+    for (const auto &right : rhs.emailAddresses) {
+      if (left.value == right.value) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void reportRatio(const char *name, size_t size, double ratio) {
+  std::printf("%-36s n=%-8zu %14.4f\n", name, size, ratio);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000}, {2000});
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+    std::vector<std::pair<size_t, size_t>> injected = testing::appendSyntheticDuplicates(book, kDuplicateRate);
+
+    Stopwatch stopwatch;
+    DedupResult result = findDuplicateContacts(book);
+    reportResult("findDuplicateContacts", book.size(), stopwatch.elapsedSeconds(), static_cast<double>(book.size()),
+                 "contacts");
+    reportCount("candidate pairs", book.size(), static_cast<double>(result.candidatePairs), "pairs");
+
+    std::set<std::pair<size_t, size_t>> found;
+    for (const auto &cluster : result.clusters) {
+      for (size_t i = 0; i < cluster.members.size(); ++i) {
+        for (size_t j = i + 1; j < cluster.members.size(); ++j) {
+          found.emplace(std::min(cluster.members[i], cluster.members[j]),
+                        std::max(cluster.members[i], cluster.members[j]));
+        }
+      }
+    }
+    size_t truePositives = 0;
+    for (const auto &pair : injected) {
+      truePositives += found.count(pair);
+    }
+    std::set<std::pair<size_t, size_t>> truth(injected.begin(), injected.end());
+    std::vector<size_t> originalOf(book.size());
+    for (size_t i = 0; i < book.size(); ++i) {
+      originalOf[i] = i;
+    }
+    for (const auto &pair : injected) {
+      originalOf[pair.second] = pair.first;
+    }
+    size_t scored = 0;
+    for (const auto &pair : found) {
+      size_t lhs = originalOf[pair.first];
+      size_t rhs = originalOf[pair.second];
+      bool baseDuplicate = lhs != rhs && generatedTwice(book[lhs], book[rhs]);
+      scored += truth.count(pair) != 0 || !baseDuplicate;
+    }
+    double precision = scored == 0 ? 1.0 : static_cast<double>(truePositives) / static_cast<double>(scored);
+    double recall = injected.empty() ? 1.0 : static_cast<double>(truePositives) / static_cast<double>(injected.size());
+    reportRatio("precision", book.size(), precision);
+    reportRatio("recall", book.size(), recall);
+    if (recall < 0.9) {
+      std::fprintf(stderr, "recall %.3f below 0.9\n", recall);
+      return 1;
+    }
+  }
+  return 0;
+}
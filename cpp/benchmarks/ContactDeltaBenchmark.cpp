@@ -0,0 +1,123 @@
+//
+//  ContactDeltaBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Uploads one round of typical edits (a phone number changed, added or
+//  removed, a job title updated) to the local sync server stand-in, once as
+//  full CMServerContactBulkCreate upserts and once as a delta sync against the
+//  acknowledged snapshots. Reports request body bytes, encode time and the
+//  memory held by the snapshot store.
+//
+
+#include "AllocationTracker.h"
+#include "BenchmarkUtil.h"
+#include "ContactDelta.h"
+#include "ServerContactJson.h"
+#include "SimulatedSyncServer.h"
+#include "SyntheticAddressBook.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+// Fraction of the book edited between two syncs
+constexpr size_t kEditEvery = 20;
+
+const ServerContactContext kContext{"org-benchmark", "source-benchmark"};
+
+std::vector<Contact> editContacts(std::vector<Contact> &book) {
+  testing::SplitMix64 random(book.size());
+  std::vector<Contact> changed;
+  for (size_t i = 0; i < book.size(); i += kEditEvery) {
+    Contact &contact = book[i];
+    switch (random.nextBelow(4)) {
+    case 0:
+      contact.phoneNumbers.back().value = "+1 415 555 " + std::to_string(1000 + random.nextBelow(9000));
+      break;
+    case 1:
+      contact.phoneNumbers.push_back({contact.identifier, "+1 212 555 0199", "work", ""});
+      break;
+    case 2:
+      if (contact.phoneNumbers.size() > 1) {
+        contact.phoneNumbers.pop_back();
+      } else {
+        contact.emailAddresses.push_back({contact.identifier, "new@example.com", "work", ""});
+      }
+      break;
+    default:
+      contact.jobTitle = "Senior " + contact.jobTitle;
+      break;
+    }
+    contact.updateDisplayInfo();
+    changed.push_back(contact);
+  }
+  return changed;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000}, {1000});
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+
+    testing::SimulatedSyncServer fullServer;
+    testing::SimulatedSyncServer deltaServer;
+    ContactSnapshotStore snapshots;
+    // First sync: nothing is acknowledged yet, so both paths upload every contact in full
+    fullServer.handleBulkCreate(encodeBulkCreateBody(book, kContext, false));
+    deltaServer.handleDeltaSync(encodeDeltaSyncBody(book, snapshots, kContext, false).body);
+    {
+      AllocationScope allocations;
+      for (const auto &contact : book) {
+        snapshots.put(contact);
+      }
+      reportBytes("snapshot store heap", size, static_cast<double>(allocations.peakBytes()));
+    }
+
+    std::vector<Contact> changed = editContacts(book);
+    fullServer.resetCounters();
+    deltaServer.resetCounters();
+
+    {
+      Stopwatch stopwatch;
+      std::string body = encodeBulkCreateBody(changed, kContext, false);
+      double seconds = stopwatch.elapsedSeconds();
+      fullServer.handleBulkCreate(body);
+      reportResult("full upsert encode", size, seconds, static_cast<double>(changed.size()), "contacts");
+      reportBytes("full upsert body", size, static_cast<double>(fullServer.bytesReceived()));
+    }
+
+    {
+      Stopwatch stopwatch;
+      DeltaSyncBody body = encodeDeltaSyncBody(changed, snapshots, kContext, false);
+      double seconds = stopwatch.elapsedSeconds();
+      testing::SimulatedSyncServer::SyncResult result = deltaServer.handleDeltaSync(body.body);
+      reportResult("delta encode (diff + patch)", size, seconds, static_cast<double>(changed.size()), "contacts");
+      reportBytes("delta body", size, static_cast<double>(deltaServer.bytesReceived()));
+      reportCount("delta patched", size, static_cast<double>(body.patched.size()), "contacts");
+      if (!result.ok || !result.rejected.empty() || result.patched + result.upserted != changed.size()) {
+        std::fprintf(stderr, "delta sync applied %zu of %zu contacts\n", result.patched + result.upserted,
+                     changed.size());
+        return 1;
+      }
+    }
+
+    // Both servers must now hold the same contacts
+    for (const auto &contact : changed) {
+      const testing::JsonValue *full = fullServer.contact(contact.identifier);
+      const testing::JsonValue *delta = deltaServer.contact(contact.identifier);
+      if (!full || !delta || *full != *delta) {
+        std::fprintf(stderr, "server copies of %s differ\n", contact.identifier.c_str());
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,157 @@
+//
+//  ContactHashBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Hashes every contact in a synthetic address book, once with the previous
+//  approach (serialize all fields into a '|'-joined string, FNV-1a it and
+//  format 16 hex characters) and once per entry point of the streaming
+//  128-bit hasher. Reports hashes per second and heap allocations per pass.
+//
+
+#include "AllocationTracker.h"
+#include "BenchmarkUtil.h"
+#include "ContactHashing.h"
+#include "PhoneNumberKey.h"
+#include "SyntheticAddressBook.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+// Previous implementation, kept as the baseline
+
+void appendField(std::string &out, std::string_view value) {
+  out.append(value);
+  out.push_back('|');
+}
+
+void appendPhone(std::string &out, std::string_view value) {
+  PhoneKey key = phoneKeyFor(value);
+  if (!key.valid()) {
+    appendField(out, value);
+    return;
+  }
+  char buffer[20];
+  int length = std::snprintf(buffer, sizeof(buffer), "%llx", static_cast<unsigned long long>(key.bits()));
+  out.append(buffer, static_cast<size_t>(length));
+  out.push_back('|');
+}
+
+void appendNumber(std::string &out, double value) {
+  char buffer[32];
+  int length = std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+  out.append(buffer, static_cast<size_t>(length));
+  out.push_back('|');
+}
+
+std::string legacyHashInput(const Contact &contact) {
+  std::string out;
+  appendField(out, contact.identifier);
+  appendField(out, contact.displayName);
+  appendNumber(out, static_cast<double>(contact.contactType));
+  appendField(out, contact.namePrefix);
+  appendField(out, contact.givenName);
+  appendField(out, contact.middleName);
+  appendField(out, contact.familyName);
+  appendField(out, contact.previousFamilyName);
+  appendField(out, contact.nameSuffix);
+  appendField(out, contact.nickname);
+  appendField(out, contact.organizationName);
+  appendField(out, contact.departmentName);
+  appendField(out, contact.jobTitle);
+  appendField(out, contact.notes);
+  appendField(out, contact.bio);
+  appendField(out, contact.location);
+  if (contact.birthday) {
+    appendNumber(out, *contact.birthday);
+  } else {
+    appendField(out, "");
+  }
+  appendField(out, contact.imageUrl);
+  for (const auto &phone : contact.phoneNumbers) {
+    appendPhone(out, phone.value);
+    appendField(out, phone.type);
+  }
+  for (const auto &email : contact.emailAddresses) {
+    appendField(out, email.value);
+    appendField(out, email.type);
+  }
+  for (const auto &address : contact.addresses) {
+    appendField(out, address.street);
+    appendField(out, address.city);
+    appendField(out, address.state);
+    appendField(out, address.postalCode);
+    appendField(out, address.country);
+    appendField(out, address.type);
+  }
+  for (const auto &date : contact.dates) {
+    appendNumber(out, date.date);
+    appendField(out, date.type);
+  }
+  for (const auto &url : contact.urlAddresses) {
+    appendField(out, url.value);
+    appendField(out, url.type);
+  }
+  for (const auto &profile : contact.socialProfiles) {
+    appendField(out, profile.service);
+    appendField(out, profile.username);
+    appendField(out, profile.urlString);
+  }
+  for (const auto &relation : contact.relations) {
+    appendField(out, relation.name);
+    appendField(out, relation.type);
+  }
+  for (const auto &im : contact.instantMessageAddresses) {
+    appendField(out, im.service);
+    appendField(out, im.username);
+    appendField(out, im.type);
+  }
+  for (const auto &interest : contact.interests) {
+    appendField(out, interest);
+  }
+  return out;
+}
+
+std::string legacyContactHash(const Contact &contact) {
+  uint64_t hash = fnv1a64(legacyHashInput(contact));
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+  return std::string(buffer, 16);
+}
+
+template <typename HashFunction>
+void runPass(const char *name, const std::vector<Contact> &book, HashFunction hash) {
+  AllocationScope allocations;
+  Stopwatch stopwatch;
+  for (const auto &contact : book) {
+    hash(contact);
+  }
+  double seconds = stopwatch.elapsedSeconds();
+  size_t allocationCount = allocations.allocations();
+  reportResult(name, book.size(), seconds, static_cast<double>(book.size()), "hashes");
+  std::string allocationName = std::string(name) + " allocations";
+  reportCount(allocationName.c_str(), book.size(), static_cast<double>(allocationCount), "allocs");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000}, {1000});
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+
+    runPass("string + fnv1a64 (previous)", book,
+            [](const Contact &contact) { doNotOptimize(legacyContactHash(contact).size()); });
+    runPass("generateContactHash", book,
+            [](const Contact &contact) { doNotOptimize(generateContactHash(contact).size()); });
+    runPass("contactHash128", book, [](const Contact &contact) { doNotOptimize(contactHash128(contact).low); });
+    runPass("contactDigest", book, [](const Contact &contact) { doNotOptimize(contactDigest(contact).sections[0]); });
+  }
+  return 0;
+}
@@ -0,0 +1,112 @@
+//
+//  ContactImageBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Bytes over the bridge and peak memory for a contact fetch when photos are
+//  inlined as base64 (imageData + thumbnailImageData on every contact) versus
+//  image handle mode, where contacts carry an image ID and the first screen
+//  pulls its thumbnails from ContactImageCache on demand.
+//
+
+#include "AllocationTracker.h"
+#include "Base64.h"
+#include "BenchmarkUtil.h"
+#include "ContactImageCache.h"
+#include "SyntheticAddressBook.h"
+
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr size_t kVisibleRows = 50;
+
+ImageBytesView view(const std::vector<uint8_t> &bytes) {
+  return ImageBytesView{bytes.data(), bytes.size()};
+}
+
+// Only the part of the payload that differs between the two modes
+void appendImageFieldsInline(const Contact &contact, std::string &payload) {
+  payload.append("\"imageData\":\"");
+  payload.append(base64::encode(contact.imageData.data(), contact.imageData.size()));
+  payload.append("\",\"thumbnailImageData\":\"");
+  payload.append(base64::encode(contact.thumbnailImageData.data(), contact.thumbnailImageData.size()));
+  payload.append("\",");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {500, 2000, 5000}, {200});
+
+  testing::SyntheticBookOptions options;
+  options.imageRate = 0.6;
+  options.imageBytes = 48 * 1024;
+  options.thumbnailBytes = 4 * 1024;
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size, options);
+
+    {
+      AllocationScope allocations;
+      Stopwatch stopwatch;
+      std::string payload;
+      for (const auto &contact : book) {
+        if (contact.imageDataAvailable) {
+          appendImageFieldsInline(contact, payload);
+        }
+      }
+      doNotOptimize(payload.size());
+      reportResult("inline base64 fetch", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "contacts");
+      reportBytes("inline base64 bytes over bridge", size, static_cast<double>(payload.size()));
+      reportBytes("inline base64 peak heap", size, static_cast<double>(allocations.peakBytes()));
+    }
+
+    {
+      ContactImageCache cache;
+      AllocationScope allocations;
+      Stopwatch stopwatch;
+      std::string payload;
+      std::vector<std::string> imageIds;
+      imageIds.reserve(book.size());
+      for (const auto &contact : book) {
+        if (!contact.imageDataAvailable) {
+          imageIds.emplace_back();
+          continue;
+        }
+        std::string imageId = cache.registerContactImages(contact.identifier, view(contact.imageData),
+                                                          view(contact.thumbnailImageData), false);
+        payload.append("\"imageId\":\"");
+        payload.append(imageId);
+        payload.append("\",");
+        imageIds.push_back(std::move(imageId));
+      }
+      double fetchSeconds = stopwatch.elapsedSeconds();
+      size_t fetchBytes = payload.size();
+
+      // First screen: one getContactImage(imageId, 'thumbnail') per visible photo
+      for (size_t row = 0; row < kVisibleRows && row < imageIds.size(); ++row) {
+        if (imageIds[row].empty()) {
+          continue;
+        }
+        auto bytes = cache.lookup(imageIds[row], ImageSizeClass::Thumbnail);
+        if (bytes) {
+          payload.append(base64::encode(bytes->data(), bytes->size()));
+        }
+      }
+      doNotOptimize(payload.size());
+      reportResult("image handle fetch", size, fetchSeconds, static_cast<double>(size), "contacts");
+      reportResult("image handle fetch + first screen", size, stopwatch.elapsedSeconds(), static_cast<double>(size),
+                   "contacts");
+      reportBytes("image handle bytes over bridge (fetch)", size, static_cast<double>(fetchBytes));
+      reportBytes("image handle bytes over bridge (+ first screen)", size, static_cast<double>(payload.size()));
+      reportBytes("image handle peak heap", size, static_cast<double>(allocations.peakBytes()));
+      reportBytes("image cache resident", size, static_cast<double>(cache.stats().bytes));
+    }
+  }
+  reportBytes("process peak RSS", 0, static_cast<double>(peakRssBytes()));
+  return 0;
+}
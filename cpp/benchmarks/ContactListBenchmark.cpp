@@ -0,0 +1,189 @@
+//
+//  ContactListBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Compares the dictionary fetch path (one nested dictionary per contact,
+//  then serialized again for the bridge) with the columnar snapshot that the
+//  JSI ContactListHostObject reads lazily.
+//
+
+#include "AllocationTracker.h"
+#include "BenchmarkUtil.h"
+#include "ContactColumns.h"
+#include "SyntheticAddressBook.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+// Stand-in for NSDictionary/NSArray/NSString trees built by contactToDictionary
+struct BridgeValue {
+  enum class Kind { String, Number, Array, Object } kind = Kind::String;
+  std::string string;
+  double number = 0;
+  std::vector<std::string> keys;
+  std::vector<BridgeValue> values;
+
+  static BridgeValue makeString(const std::string &value) {
+    BridgeValue result;
+    result.string = value;
+    return result;
+  }
+
+  static BridgeValue makeNumber(double value) {
+    BridgeValue result;
+    result.kind = Kind::Number;
+    result.number = value;
+    return result;
+  }
+
+  void set(const char *key, BridgeValue value) {
+    keys.emplace_back(key);
+    values.push_back(std::move(value));
+  }
+};
+
+BridgeValue labeledValueDictionary(const std::string &contactId, const std::string &value, const std::string &type,
+                                   const std::string &emoji) {
+  BridgeValue dict;
+  dict.kind = BridgeValue::Kind::Object;
+  dict.set("contactId", BridgeValue::makeString(contactId));
+  dict.set("value", BridgeValue::makeString(value));
+  dict.set("type", BridgeValue::makeString(type));
+  dict.set("emoji", BridgeValue::makeString(emoji));
+  return dict;
+}
+
+BridgeValue contactToDictionary(const Contact &contact) {
+  BridgeValue dict;
+  dict.kind = BridgeValue::Kind::Object;
+  for (size_t i = 0; i < kContactStringFieldCount; ++i) {
+    auto field = static_cast<ContactStringField>(i);
+    dict.set(contactFieldName(field), BridgeValue::makeString(contactStringFieldValue(contact, field)));
+  }
+  for (size_t i = 0; i < kContactNumberFieldCount; ++i) {
+    auto field = static_cast<ContactNumberField>(i);
+    dict.set(contactFieldName(field), BridgeValue::makeNumber(contactNumberFieldValue(contact, field)));
+  }
+  BridgeValue phones;
+  phones.kind = BridgeValue::Kind::Array;
+  for (const auto &phone : contact.phoneNumbers) {
+    phones.keys.emplace_back();
+    phones.values.push_back(labeledValueDictionary(phone.contactId, phone.value, phone.type, phone.emoji));
+  }
+  dict.set("phoneNumbers", std::move(phones));
+  BridgeValue emails;
+  emails.kind = BridgeValue::Kind::Array;
+  for (const auto &email : contact.emailAddresses) {
+    emails.keys.emplace_back();
+    emails.values.push_back(labeledValueDictionary(email.contactId, email.value, email.type, email.emoji));
+  }
+  dict.set("emailAddresses", std::move(emails));
+  return dict;
+}
+
+void serialize(const BridgeValue &value, std::string &out) {
+  switch (value.kind) {
+  case BridgeValue::Kind::String:
+    out.push_back('"');
+    out.append(value.string);
+    out.push_back('"');
+    break;
+  case BridgeValue::Kind::Number:
+    out.append(std::to_string(value.number));
+    break;
+  case BridgeValue::Kind::Array:
+    out.push_back('[');
+    for (size_t i = 0; i < value.values.size(); ++i) {
+      if (i > 0) {
+        out.push_back(',');
+      }
+      serialize(value.values[i], out);
+    }
+    out.push_back(']');
+    break;
+  case BridgeValue::Kind::Object:
+    out.push_back('{');
+    for (size_t i = 0; i < value.values.size(); ++i) {
+      if (i > 0) {
+        out.push_back(',');
+      }
+      out.push_back('"');
+      out.append(value.keys[i]);
+      out.append("\":");
+      serialize(value.values[i], out);
+    }
+    out.push_back('}');
+    break;
+  }
+}
+
+constexpr size_t kVisibleRows = 50;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {1000, 20000, 100000}, {1000});
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+
+    {
+      AllocationScope allocations;
+      Stopwatch stopwatch;
+      std::vector<BridgeValue> dictionaries;
+      dictionaries.reserve(book.size());
+      for (const auto &contact : book) {
+        dictionaries.push_back(contactToDictionary(contact));
+      }
+      BridgeValue array;
+      array.kind = BridgeValue::Kind::Array;
+      array.values = std::move(dictionaries);
+      array.keys.resize(array.values.size());
+      std::string payload;
+      serialize(array, payload);
+      doNotOptimize(payload.size());
+      double seconds = stopwatch.elapsedSeconds();
+      reportResult("dictionary fetch", size, seconds, static_cast<double>(size), "contacts");
+      reportBytes("dictionary fetch peak heap", size, static_cast<double>(allocations.peakBytes()));
+    }
+
+    {
+      AllocationScope allocations;
+      Stopwatch stopwatch;
+      auto columns = std::make_shared<const ContactColumns>(book);
+      double buildSeconds = stopwatch.elapsedSeconds();
+      size_t touched = 0;
+      size_t visible = std::min(kVisibleRows, columns->size());
+      for (size_t row = 0; row < visible; ++row) {
+        for (size_t field = 0; field < kContactStringFieldCount; ++field) {
+          touched += columns->stringAt(row, static_cast<ContactStringField>(field)).size();
+        }
+        for (size_t i = 0; i < columns->phoneNumberCount(row); ++i) {
+          touched += columns->phoneNumberAt(row, i).value.size();
+        }
+      }
+      doNotOptimize(touched);
+      double seconds = stopwatch.elapsedSeconds();
+      reportResult("columnar build", size, buildSeconds, static_cast<double>(size), "contacts");
+      reportResult("columnar build + first screen", size, seconds, static_cast<double>(size), "contacts");
+      reportBytes("columnar peak heap", size, static_cast<double>(allocations.peakBytes()));
+      reportBytes("columnar snapshot size", size, static_cast<double>(columns->memoryUsage()));
+
+      stopwatch.reset();
+      size_t scanned = 0;
+      for (size_t row = 0; row < columns->size(); ++row) {
+        scanned += columns->stringAt(row, ContactStringField::DisplayName).size();
+      }
+      doNotOptimize(scanned);
+      reportResult("columnar full scan displayName", size, stopwatch.elapsedSeconds(), static_cast<double>(size),
+                   "rows");
+    }
+  }
+  return 0;
+}
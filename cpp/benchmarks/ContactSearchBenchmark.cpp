@@ -0,0 +1,229 @@
+//
+//  ContactSearchBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Query latency of ContactSearchIndex against a linear scan of every
+//  contact's matchString, which is what searching the store directly costs
+//  on each keystroke. Also reports build, incremental update, save and load
+//  times and the size of the persisted index.
+//
+//  The fuzzy pass runs queries with typos and initials derived from the book
+//  itself and reports recall@10 for the typo queries: how often a contact
+//  whose name contains the intended given and family names is among the first
+//  ten results. Initials are too ambiguous to score and only count for
+//  latency. A full run fails when fuzzy quickSearch
+//  misses its latency target.
+//
+
+#include "BenchmarkUtil.h"
+#include "ContactSearchIndex.h"
+#include "SyntheticAddressBook.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+// Search-as-you-type sequences: each prefix is one keystroke
+const char *const kTypedQueries[] = {"j", "ja", "jam", "jame", "james", "s", "sm", "smi", "wei c", "415", "gmail"};
+
+constexpr size_t kRecallDepth = 10;
+constexpr size_t kFuzzyQueryCount = 500;
+// p99 budget for one keystroke of fuzzy search-as-you-type at 100k contacts
+constexpr double kFuzzyP99TargetSeconds = 0.005;
+
+struct FuzzyQuery {
+  std::string text;
+  std::string givenName;
+  std::string familyName;
+  bool scored = true;
+};
+
+std::string transposed(std::string word) {
+  if (word.size() >= 4) {
+    std::swap(word[1], word[2]);
+  }
+  return word;
+}
+
+std::string substituted(std::string word) {
+  if (word.size() >= 4) {
+    word[word.size() - 2] = word[word.size() - 2] == 'x' ? 'q' : 'x';
+  }
+  return word;
+}
+
+std::string dropped(std::string word) {
+  if (word.size() >= 4) {
+    word.erase(2, 1);
+  }
+  return word;
+}
+
+// Typos, prefixes with typos and initials, as people type them
+std::vector<FuzzyQuery> makeFuzzyQueries(const std::vector<Contact> &book) {
+  std::vector<FuzzyQuery> queries;
+  for (size_t i = 0; queries.size() < kFuzzyQueryCount && i < book.size(); ++i) {
+    const Contact &contact = book[(i * 7919) % book.size()];
+    std::string given = text::folded(contact.givenName);
+    std::string family = text::folded(contact.familyName);
+    if (given.size() < 4 || family.size() < 4) {
+      continue;
+    }
+    std::string text;
+    bool scored = true;
+    switch (queries.size() % 4) {
+    case 0:
+      text = transposed(given) + " " + family;
+      break;
+    case 1:
+      text = given.substr(0, 3) + " " + substituted(family);
+      break;
+    case 2:
+      text = dropped(family) + " " + given.substr(0, 2);
+      break;
+    default:
+      text = std::string(1, given[0]) + family[0];
+      scored = false;
+      break;
+    }
+    queries.push_back({std::move(text), given, family, scored});
+  }
+  return queries;
+}
+
+double percentile(std::vector<double> samples, double fraction) {
+  if (samples.empty()) {
+    return 0;
+  }
+  std::sort(samples.begin(), samples.end());
+  size_t index = static_cast<size_t>(fraction * static_cast<double>(samples.size() - 1));
+  return samples[index];
+}
+
+void reportLatency(const char *name, size_t size, const std::vector<double> &samples) {
+  char label[64];
+  std::snprintf(label, sizeof(label), "%s p50", name);
+  reportResult(label, size, percentile(samples, 0.5), 1, "queries");
+  std::snprintf(label, sizeof(label), "%s p99", name);
+  reportResult(label, size, percentile(samples, 0.99), 1, "queries");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000}, {2000});
+  const int rounds = args.quick ? 2 : 20;
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+
+    ContactSearchIndex index;
+    Stopwatch build;
+    index.syncWith(book);
+    reportResult("index build", size, build.elapsedSeconds(), static_cast<double>(size), "contacts");
+    reportCount("index terms", size, static_cast<double>(index.termCount()), "terms");
+
+    std::vector<double> indexed;
+    std::vector<double> scanned;
+    size_t sink = 0;
+    for (int round = 0; round < rounds; ++round) {
+      for (const char *query : kTypedQueries) {
+        Stopwatch stopwatch;
+        auto results = index.quickSearch(query);
+        indexed.push_back(stopwatch.elapsedSeconds());
+        sink += results.size();
+
+        stopwatch.reset();
+        std::vector<const Contact *> matches;
+        for (const auto &contact : book) {
+          if (text::containsCaseInsensitive(contact.matchString, query)) {
+            matches.push_back(&contact);
+            if (matches.size() == ContactSearchIndex::kQuickSearchLimit) {
+              break;
+            }
+          }
+        }
+        scanned.push_back(stopwatch.elapsedSeconds());
+        sink += matches.size();
+      }
+    }
+    doNotOptimize(sink);
+    reportLatency("quickSearch index", size, indexed);
+    reportLatency("quickSearch linear scan", size, scanned);
+
+    std::unordered_map<std::string, const Contact *> byId;
+    for (const auto &contact : book) {
+      byId.emplace(contact.identifier, &contact);
+    }
+    std::vector<FuzzyQuery> fuzzyQueries = makeFuzzyQueries(book);
+    std::vector<double> fuzzy;
+    size_t scored = 0;
+    size_t found = 0;
+    for (const auto &query : fuzzyQueries) {
+      Stopwatch stopwatch;
+      auto results = index.quickSearch(query.text);
+      fuzzy.push_back(stopwatch.elapsedSeconds());
+      if (!query.scored) {
+        continue;
+      }
+      scored++;
+      for (size_t i = 0; i < results.size() && i < kRecallDepth; ++i) {
+        std::string name = " " + text::folded(byId[results[i]]->displayName) + " ";
+        if (name.find(" " + query.givenName + " ") != std::string::npos &&
+            name.find(" " + query.familyName + " ") != std::string::npos) {
+          found++;
+          break;
+        }
+      }
+    }
+    reportLatency("quickSearch fuzzy", size, fuzzy);
+    double recall = scored == 0 ? 0 : static_cast<double>(found) / static_cast<double>(scored);
+    reportCount("fuzzy recall@10", size, recall * 100, "%");
+    if (!args.quick && size <= 100000 && percentile(fuzzy, 0.99) > kFuzzyP99TargetSeconds) {
+      std::fprintf(stderr, "fuzzy quickSearch p99 %.3f ms exceeds the %.1f ms target\n",
+                   percentile(fuzzy, 0.99) * 1000, kFuzzyP99TargetSeconds * 1000);
+      return 1;
+    }
+
+    // One edited contact after a store change notification
+    Stopwatch update;
+    size_t changes = 0;
+    for (size_t i = 0; i < 100; ++i) {
+      Contact edited = book[(i * 7919) % book.size()];
+      edited.nickname = "Edited" + std::to_string(i);
+      changes += index.upsert(edited) ? 1 : 0;
+    }
+    reportResult("incremental upsert", size, update.elapsedSeconds(), static_cast<double>(changes), "contacts");
+
+    std::string path = "cm_search_benchmark_" + std::to_string(size) + ".bin";
+    Stopwatch save;
+    bool saved = index.save(path);
+    reportResult("index save", size, save.elapsedSeconds(), 1, "saves");
+
+    ContactSearchIndex loaded;
+    Stopwatch load;
+    bool restored = saved && loaded.load(path);
+    reportResult("index load", size, load.elapsedSeconds(), 1, "loads");
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (file) {
+      std::fseek(file, 0, SEEK_END);
+      reportBytes("index file size", size, static_cast<double>(std::ftell(file)));
+      std::fclose(file);
+    }
+    std::remove(path.c_str());
+    if (!restored || loaded.size() != index.size()) {
+      std::fprintf(stderr, "index did not survive save/load\n");
+      return 1;
+    }
+  }
+  return 0;
+}
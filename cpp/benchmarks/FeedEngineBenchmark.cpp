@@ -0,0 +1,94 @@
+//
+//  FeedEngineBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Scrolls the feed engine through a whole synthetic feed against the local
+//  feed stand-in, once with offset pages and once with cursor pages, while
+//  a new event is published every few pages. Reports scroll time, rows the
+//  server read, events shown twice or dropped by the engine, and how many
+//  events stay resident with and without the window.
+//
+
+#include "BenchmarkUtil.h"
+#include "FeedEngine.h"
+#include "SimulatedFeedServer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr size_t kPageSize = 20;
+constexpr size_t kViewport = 10;
+constexpr size_t kPublishEvery = 100;
+
+struct ScrollResult {
+  double seconds = 0;
+  uint64_t rowsScanned = 0;
+  FeedEngineStats stats;
+  size_t peakResident = 0;
+};
+
+ScrollResult scrollThrough(const std::vector<SocialEvent> &events, testing::FeedPaging paging,
+                           size_t maxResidentItems) {
+  testing::SimulatedFeedServer server("getFeed", paging);
+  for (const SocialEvent &event : events) {
+    server.publish(event);
+  }
+  FeedEngineOptions options;
+  options.pageSize = kPageSize;
+  options.maxResidentItems = maxResidentItems;
+  FeedEngine engine(server, options);
+
+  ScrollResult result;
+  double newest = events.empty() ? 0 : events.front().createdAt;
+  size_t published = 0;
+  Stopwatch stopwatch;
+  for (size_t first = 0; first < engine.size() || engine.hasMore(); first += kViewport / 2) {
+    engine.setViewport(first, kViewport);
+    if (first % kPublishEvery == 0) {
+      SocialEvent fresh;
+      fresh.eventId = "fresh-" + std::to_string(published++);
+      fresh.createdAt = newest + 60.0 * static_cast<double>(published);
+      server.publish(fresh);
+    }
+    result.peakResident = std::max(result.peakResident, engine.stats().residentItems);
+  }
+  result.seconds = stopwatch.elapsedSeconds();
+  result.rowsScanned = server.rowsScanned();
+  result.stats = engine.stats();
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000}, {2000});
+
+  for (size_t size : args.sizes) {
+    std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(size);
+
+    ScrollResult offset = scrollThrough(events, testing::FeedPaging::Offset, 200);
+    reportResult("scroll: offset pages", size, offset.seconds, static_cast<double>(size), "events");
+    reportCount("server rows read: offset pages", size, static_cast<double>(offset.rowsScanned), "rows");
+    reportCount("repeated events dropped: offset pages", size,
+                static_cast<double>(offset.stats.duplicatesDropped), "events");
+
+    ScrollResult cursor = scrollThrough(events, testing::FeedPaging::Cursor, 200);
+    reportResult("scroll: cursor pages", size, cursor.seconds, static_cast<double>(size), "events");
+    reportCount("server rows read: cursor pages", size, static_cast<double>(cursor.rowsScanned), "rows");
+    reportCount("repeated events dropped: cursor pages", size,
+                static_cast<double>(cursor.stats.duplicatesDropped), "events");
+    reportCount("peak resident events: window of 200", size, static_cast<double>(cursor.peakResident), "events");
+
+    ScrollResult unbounded = scrollThrough(events, testing::FeedPaging::Cursor, std::numeric_limits<size_t>::max());
+    reportCount("peak resident events: unbounded", size, static_cast<double>(unbounded.peakResident), "events");
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+//
+//  FollowStateBenchmark.cpp
+//  ContactsManagerCore
+//
+//  "Follow all" over a list of suggested users against the local API
+//  stand-in with injected latency: one request per user, awaited in turn as
+//  the per-tap calls do today, versus the follow state store flushed once,
+//  both with the per-user calls issued together and against a batch
+//  endpoint. Reports wall time and requests, and local isFollowing lookups.
+//
+
+#include "BenchmarkUtil.h"
+#include "FollowStateStore.h"
+#include "SimulatedApiServer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+ApiResponse accepted(const ApiRequest &) {
+  return ApiResponse{200, "{\"success\":true}", ""};
+}
+
+void sendAndWait(ApiTransport &transport, ApiRequest request) {
+  std::mutex mutex;
+  std::condition_variable answered;
+  bool done = false;
+  transport.send(std::move(request), [&](ApiResponse) {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+    answered.notify_all();
+  });
+  std::unique_lock<std::mutex> lock(mutex);
+  answered.wait(lock, [&] { return done; });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {20, 100}, {20});
+  std::chrono::microseconds latency(args.quick ? 2000 : 20000);
+
+  for (size_t size : args.sizes) {
+    std::vector<std::string> userIds;
+    for (size_t i = 0; i < size; ++i) {
+      userIds.push_back("user-" + std::to_string(i));
+    }
+
+    testing::SimulatedApiServer serial(latency);
+    serial.route("POST", "/api/v1/social/follow", accepted);
+    Stopwatch stopwatch;
+    for (const std::string &userId : userIds) {
+      ApiRequest request;
+      request.method = "POST";
+      request.endpoint = "/api/v1/social/follow";
+      request.parameters = {{"user_id", userId}};
+      sendAndWait(serial, std::move(request));
+    }
+    reportResult("follow all: request per user", size, stopwatch.elapsedSeconds(), static_cast<double>(size),
+                 "follows");
+    reportCount("requests: request per user", size, static_cast<double>(serial.requestCount()), "requests");
+
+    testing::SimulatedApiServer coalesced(latency);
+    coalesced.route("POST", "/api/v1/social/follow", accepted);
+    {
+      FollowStateStore store(coalesced);
+      store.setFollowing({});
+      stopwatch.reset();
+      for (const std::string &userId : userIds) {
+        store.follow(userId);
+      }
+      store.flush();
+      coalesced.waitIdle();
+      reportResult("follow all: coalesced per user", size, stopwatch.elapsedSeconds(), static_cast<double>(size),
+                   "follows");
+      reportCount("requests: coalesced per user", size, static_cast<double>(coalesced.requestCount()), "requests");
+    }
+
+    FollowStateOptions options;
+    options.batchEndpoint = "/api/v1/social/follow/batch";
+    testing::SimulatedApiServer batched(latency);
+    batched.route("POST", options.batchEndpoint, accepted);
+    FollowStateStore store(batched, options);
+    store.setFollowing({});
+    stopwatch.reset();
+    for (const std::string &userId : userIds) {
+      store.follow(userId);
+    }
+    double optimistic = stopwatch.elapsedSeconds();
+    store.flush();
+    batched.waitIdle();
+    reportResult("follow all: batched", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "follows");
+    reportResult("follow all: shown as followed", size, optimistic, static_cast<double>(size), "follows");
+    reportCount("requests: batched", size, static_cast<double>(batched.requestCount()), "requests");
+
+    stopwatch.reset();
+    size_t following = 0;
+    for (size_t round = 0; round < 1000; ++round) {
+      for (const std::string &userId : userIds) {
+        following += store.isFollowing(userId).value_or(false) ? 1 : 0;
+      }
+    }
+    reportResult("isFollowing: local", size, stopwatch.elapsedSeconds(), static_cast<double>(1000 * size),
+                 "lookups");
+    doNotOptimize(following);
+  }
+  return 0;
+}
@@ -0,0 +1,122 @@
+//
+//  FollowingSetBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Builds the following set from UUID user IDs and answers follow badges
+//  for screens of 500 rows, a tenth of them followed. Compares memory per
+//  follow with a hash set of the IDs, and lookups with and without the
+//  Bloom filter in front of the sorted hashes.
+//
+
+#include "BenchmarkUtil.h"
+#include "ContactHashing.h"
+#include "FollowingSet.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr size_t kScreenRows = 500;
+constexpr size_t kScreens = 200;
+
+std::string uuid(std::mt19937_64 &random) {
+  uint64_t high = random();
+  uint64_t low = random();
+  char buffer[40];
+  std::snprintf(buffer, sizeof(buffer), "%08x-%04x-%04x-%04x-%012llx", static_cast<unsigned>(high >> 32),
+                static_cast<unsigned>((high >> 16) & 0xffff), static_cast<unsigned>(high & 0xffff),
+                static_cast<unsigned>(low >> 48), static_cast<unsigned long long>(low & 0xffffffffffffULL));
+  return buffer;
+}
+
+// Nodes, buckets and out-of-line string storage of std::unordered_set<std::string>
+size_t hashSetBytes(const std::unordered_set<std::string> &set) {
+  size_t bytes = set.bucket_count() * sizeof(void *);
+  for (const std::string &id : set) {
+    bytes += sizeof(void *) + sizeof(size_t) + sizeof(std::string);
+    bytes += id.capacity() > 15 ? ((id.capacity() + 1 + 15) / 16) * 16 : 0;
+  }
+  return bytes;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000, 1000000}, {10000});
+
+  for (size_t size : args.sizes) {
+    std::mt19937_64 random(42);
+    std::vector<std::string> following;
+    for (size_t i = 0; i < size; ++i) {
+      following.push_back(uuid(random));
+    }
+
+    Stopwatch stopwatch;
+    FollowingSet set;
+    set.assign(following);
+    reportResult("build", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "follows");
+    reportBytes("memory: following set", size, static_cast<double>(set.memoryBytes()));
+    reportCount("memory per follow: following set", size,
+                static_cast<double>(set.memoryBytes()) / static_cast<double>(size), "bytes");
+
+    std::unordered_set<std::string> hashSet(following.begin(), following.end());
+    reportCount("memory per follow: hash set of IDs", size,
+                static_cast<double>(hashSetBytes(hashSet)) / static_cast<double>(size), "bytes");
+
+    std::vector<std::string> rows;
+    for (size_t i = 0; i < kScreenRows; ++i) {
+      rows.push_back(i % 10 == 0 ? following[random() % size] : uuid(random));
+    }
+
+    stopwatch.reset();
+    size_t badges = 0;
+    for (size_t screen = 0; screen < kScreens; ++screen) {
+      for (const std::string &row : rows) {
+        badges += set.contains(row) ? 1 : 0;
+      }
+    }
+    reportResult("lookup: filter and sorted hashes", size, stopwatch.elapsedSeconds(),
+                 static_cast<double>(kScreens * kScreenRows), "lookups");
+
+    stopwatch.reset();
+    for (size_t screen = 0; screen < kScreens; ++screen) {
+      badges += set.containsEach(rows).size();
+    }
+    reportResult("lookup: screen at once", size, stopwatch.elapsedSeconds(),
+                 static_cast<double>(kScreens * kScreenRows), "lookups");
+
+    std::vector<uint64_t> sorted;
+    for (const std::string &id : following) {
+      sorted.push_back(fnv1a64(id));
+    }
+    std::sort(sorted.begin(), sorted.end());
+    stopwatch.reset();
+    for (size_t screen = 0; screen < kScreens; ++screen) {
+      for (const std::string &row : rows) {
+        badges += std::binary_search(sorted.begin(), sorted.end(), fnv1a64(row)) ? 1 : 0;
+      }
+    }
+    reportResult("lookup: sorted hashes only", size, stopwatch.elapsedSeconds(),
+                 static_cast<double>(kScreens * kScreenRows), "lookups");
+
+    stopwatch.reset();
+    for (size_t screen = 0; screen < kScreens; ++screen) {
+      for (const std::string &row : rows) {
+        badges += hashSet.count(row);
+      }
+    }
+    reportResult("lookup: hash set of IDs", size, stopwatch.elapsedSeconds(),
+                 static_cast<double>(kScreens * kScreenRows), "lookups");
+    doNotOptimize(badges);
+  }
+  return 0;
+}
@@ -0,0 +1,140 @@
+//
+//  MutualFollowBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Intersects sorted sets of hashed user IDs: two sets of the benchmark
+//  size sharing half their keys, merged by the scalar loop, by
+//  std::set_intersection and by the vector block merge, and a set of 1000
+//  against the full size, merged and galloped. Then builds the mutual
+//  follow index over lists of that size and times the count and first page.
+//
+
+#include "BenchmarkUtil.h"
+#include "MutualFollowIndex.h"
+#include "SortedIntersection.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr size_t kSmallSet = 1000;
+constexpr size_t kRepeats = 5;
+
+std::vector<uint64_t> sortedUnique(std::vector<uint64_t> keys) {
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {100000, 1000000}, {100000});
+
+  for (size_t size : args.sizes) {
+    std::mt19937_64 random(42);
+    std::vector<uint64_t> shared;
+    std::vector<uint64_t> a;
+    std::vector<uint64_t> b;
+    for (size_t i = 0; i < size; ++i) {
+      uint64_t key = random();
+      a.push_back(i % 2 == 0 ? key : random());
+      b.push_back(i % 2 == 0 ? key : random());
+    }
+    a = sortedUnique(std::move(a));
+    b = sortedUnique(std::move(b));
+    std::vector<uint32_t> positions(std::min(a.size(), b.size()));
+    double keys = static_cast<double>(kRepeats * (a.size() + b.size()));
+
+    Stopwatch stopwatch;
+    size_t scalar = 0;
+    for (size_t r = 0; r < kRepeats; ++r) {
+      scalar = intersectSortedScalar(a.data(), a.size(), b.data(), b.size(), positions.data());
+    }
+    reportResult("intersect half overlap: scalar merge", size, stopwatch.elapsedSeconds(), keys, "keys");
+
+    stopwatch.reset();
+    std::vector<uint64_t> common;
+    for (size_t r = 0; r < kRepeats; ++r) {
+      common.clear();
+      std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(common));
+    }
+    reportResult("intersect half overlap: std::set_intersection", size, stopwatch.elapsedSeconds(), keys, "keys");
+
+    stopwatch.reset();
+    size_t vectorized = 0;
+    for (size_t r = 0; r < kRepeats; ++r) {
+      vectorized = intersectSorted(a.data(), a.size(), b.data(), b.size(), positions.data());
+    }
+    reportResult("intersect half overlap: block merge", size, stopwatch.elapsedSeconds(), keys, "keys");
+    if (scalar != vectorized || common.size() != vectorized) {
+      std::fprintf(stderr, "intersection mismatch: %zu %zu %zu\n", scalar, common.size(), vectorized);
+      return 1;
+    }
+    reportCount("common keys", size, static_cast<double>(vectorized), "keys");
+
+    std::vector<uint64_t> small;
+    for (size_t i = 0; i < kSmallSet; ++i) {
+      small.push_back(i % 2 == 0 ? a[random() % a.size()] : random());
+    }
+    small = sortedUnique(std::move(small));
+    stopwatch.reset();
+    for (size_t r = 0; r < kRepeats; ++r) {
+      scalar = intersectSortedScalar(small.data(), small.size(), a.data(), a.size(), positions.data());
+    }
+    reportResult("intersect 1000 with all: scalar merge", size, stopwatch.elapsedSeconds(),
+                 static_cast<double>(kRepeats * small.size()), "keys");
+    stopwatch.reset();
+    for (size_t r = 0; r < kRepeats; ++r) {
+      vectorized = intersectSorted(small.data(), small.size(), a.data(), a.size(), positions.data());
+    }
+    reportResult("intersect 1000 with all: gallop", size, stopwatch.elapsedSeconds(),
+                 static_cast<double>(kRepeats * small.size()), "keys");
+    if (scalar != vectorized) {
+      std::fprintf(stderr, "gallop mismatch: %zu %zu\n", scalar, vectorized);
+      return 1;
+    }
+
+    std::vector<FollowRelationship> following;
+    std::vector<FollowRelationship> followers;
+    for (size_t i = 0; i < size; ++i) {
+      FollowRelationship out;
+      out.identifier = "f" + std::to_string(i);
+      out.userId = "user-" + std::to_string(i);
+      out.createdAt = static_cast<double>(random() % 100000000);
+      following.push_back(std::move(out));
+      FollowRelationship in;
+      in.userId = "user-" + std::to_string(i % 2 == 0 ? i : size + i);
+      followers.push_back(std::move(in));
+    }
+    MutualFollowIndex index;
+    stopwatch.reset();
+    index.setFollowing(std::move(following));
+    index.setFollowers(followers);
+    reportResult("index: build", size, stopwatch.elapsedSeconds(), static_cast<double>(2 * size), "relationships");
+    reportBytes("index: key memory", size, static_cast<double>(index.memoryBytes()));
+
+    stopwatch.reset();
+    size_t count = index.mutualCount();
+    reportResult("index: mutual count", size, stopwatch.elapsedSeconds(), static_cast<double>(2 * size), "keys");
+    stopwatch.reset();
+    std::vector<FollowRelationship> page = index.mutualPage(0, 20);
+    reportResult("index: first page after a change", size, stopwatch.elapsedSeconds(), static_cast<double>(count),
+                 "mutuals");
+    stopwatch.reset();
+    for (size_t skip = 20; skip < 2020; skip += 20) {
+      page = index.mutualPage(skip, 20);
+    }
+    reportResult("index: next 100 pages", size, stopwatch.elapsedSeconds(), 100, "pages");
+    doNotOptimize(page);
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+//
+//  PhoneNumberBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Phone normalization throughput over a large set of formatted numbers, with
+//  the byte loop and the vectorized scan side by side, and the cost of
+//  deduplicating and comparing numbers by PhoneKey versus by their digit
+//  strings (what comparing raw values after stripping formatting costs).
+//
+
+#include "BenchmarkUtil.h"
+#include "PhoneNumberKey.h"
+#include "SyntheticAddressBook.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+// Every number comes back in one of these shapes; a quarter are repeats of an
+// earlier number in a different shape
+std::vector<std::string> makePhoneValues(size_t count) {
+  testing::SplitMix64 random(11);
+  std::vector<std::string> values;
+  values.reserve(count);
+  std::vector<uint64_t> numbers;
+  numbers.reserve(count);
+  char buffer[48];
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t number = 2000000000ULL + random.nextBelow(8000000000ULL);
+    if (!numbers.empty() && random.nextBelow(4) == 0) {
+      number = numbers[random.nextBelow(numbers.size())];
+    }
+    numbers.push_back(number);
+    unsigned area = static_cast<unsigned>(number / 10000000);
+    unsigned exchange = static_cast<unsigned>(number / 10000 % 1000);
+    unsigned line = static_cast<unsigned>(number % 10000);
+    switch (random.nextBelow(6)) {
+    case 0:
+      std::snprintf(buffer, sizeof(buffer), "+1 (%03u) %03u-%04u", area, exchange, line);
+      break;
+    case 1:
+      std::snprintf(buffer, sizeof(buffer), "%03u-%03u-%04u", area, exchange, line);
+      break;
+    case 2:
+      std::snprintf(buffer, sizeof(buffer), "%03u%03u%04u", area, exchange, line);
+      break;
+    case 3:
+      std::snprintf(buffer, sizeof(buffer), "+1 %03u %03u %04u", area, exchange, line);
+      break;
+    case 4:
+      std::snprintf(buffer, sizeof(buffer), "001.%03u.%03u.%04u", area, exchange, line);
+      break;
+    default:
+      std::snprintf(buffer, sizeof(buffer), "1 (%03u) %03u-%04u ext. %u", area, exchange, line, line % 100);
+      break;
+    }
+    values.emplace_back(buffer);
+  }
+  return values;
+}
+
+// Digits only, the usual way of comparing phone strings
+std::string digitString(const std::string &value) {
+  std::string digits;
+  for (char c : value) {
+    if (c >= '0' && c <= '9') {
+      digits.push_back(c);
+    }
+  }
+  return digits;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {1000000}, {20000});
+  constexpr uint16_t kCountryCode = 1;
+
+  for (size_t size : args.sizes) {
+    std::vector<std::string> values = makePhoneValues(size);
+    std::vector<PhoneKey> keys(size);
+    std::vector<PhoneKey> scalarKeys(size);
+
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < size; ++i) {
+      scalarKeys[i] = phoneKeyForScalar(values[i], kCountryCode);
+    }
+    reportResult("normalize scalar", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "numbers");
+
+    stopwatch.reset();
+    for (size_t i = 0; i < size; ++i) {
+      keys[i] = phoneKeyFor(values[i], kCountryCode);
+    }
+    reportResult("normalize vectorized", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "numbers");
+
+    stopwatch.reset();
+    std::vector<std::string> digitStrings;
+    digitStrings.reserve(size);
+    for (const auto &value : values) {
+      digitStrings.push_back(digitString(value));
+    }
+    reportResult("digit strings", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "numbers");
+
+    for (size_t i = 0; i < size; ++i) {
+      if (keys[i] != scalarKeys[i]) {
+        std::fprintf(stderr, "vectorized and scalar keys differ for \"%s\"\n", values[i].c_str());
+        return 1;
+      }
+    }
+
+    stopwatch.reset();
+    std::unordered_set<std::string> uniqueStrings(digitStrings.begin(), digitStrings.end());
+    reportResult("dedup digit strings (hash set)", size, stopwatch.elapsedSeconds(), static_cast<double>(size),
+                 "numbers");
+    stopwatch.reset();
+    std::unordered_set<PhoneKey, PhoneKeyHash> uniqueKeys(keys.begin(), keys.end());
+    reportResult("dedup keys (hash set)", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "numbers");
+    // Fixed-width keys can also be deduplicated by sorting plain integers
+    stopwatch.reset();
+    std::vector<uint64_t> sortedBits;
+    sortedBits.reserve(size);
+    for (PhoneKey key : keys) {
+      sortedBits.push_back(key.bits());
+    }
+    std::sort(sortedBits.begin(), sortedBits.end());
+    sortedBits.erase(std::unique(sortedBits.begin(), sortedBits.end()), sortedBits.end());
+    reportResult("dedup keys (sort)", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "numbers");
+    reportCount("distinct digit strings", size, static_cast<double>(uniqueStrings.size()), "numbers");
+    reportCount("distinct keys", size, static_cast<double>(uniqueKeys.size()), "numbers");
+
+    // Neighbouring values, as when diffing a contact against its last synced copy
+    size_t equal = 0;
+    stopwatch.reset();
+    for (size_t i = 1; i < size; ++i) {
+      equal += digitStrings[i] == digitStrings[i - 1] ? 1 : 0;
+    }
+    reportResult("compare digit strings", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "pairs");
+    stopwatch.reset();
+    for (size_t i = 1; i < size; ++i) {
+      equal += phoneKeysMatch(keys[i], keys[i - 1]) ? 1 : 0;
+    }
+    reportResult("compare keys", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "pairs");
+    doNotOptimize(equal);
+  }
+  return 0;
+}
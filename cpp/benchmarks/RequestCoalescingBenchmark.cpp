@@ -0,0 +1,102 @@
+//
+//  RequestCoalescingBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Screens mounting together against the local API stand-in with injected
+//  latency, each loading user info, the three recommendation endpoints and
+//  the first feed page, as happens when several React Native screens start
+//  at once. Compares requests, response bytes and time until every screen
+//  has its data, with and without the single-flight layer.
+//
+
+#include "BenchmarkUtil.h"
+#include "SimulatedApiServer.h"
+#include "SingleFlightTransport.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+const char *const kEndpoints[] = {
+    "/api/v1/user/info",
+    "/api/v1/recommendations/invite",
+    "/api/v1/recommendations/contacts-using-app",
+    "/api/v1/recommendations/users-you-might-know",
+    "/api/v1/social/feed",
+};
+
+void routeAll(testing::SimulatedApiServer &server) {
+  for (const char *endpoint : kEndpoints) {
+    std::string body(4096, 'x');
+    server.route("GET", endpoint, [body](const ApiRequest &) { return ApiResponse{200, body, ""}; });
+  }
+}
+
+// Every screen sends every request from its own thread; returns when all are answered
+double mountScreens(ApiTransport &transport, size_t screens) {
+  std::mutex mutex;
+  std::condition_variable answered;
+  size_t remaining = screens * (sizeof(kEndpoints) / sizeof(kEndpoints[0]));
+  Stopwatch stopwatch;
+  std::vector<std::thread> threads;
+  for (size_t s = 0; s < screens; ++s) {
+    threads.emplace_back([&] {
+      for (const char *endpoint : kEndpoints) {
+        ApiRequest request;
+        request.endpoint = endpoint;
+        if (std::string(endpoint) == "/api/v1/social/feed") {
+          request.parameters = {{"skip", "0"}, {"limit", "20"}};
+        }
+        transport.send(request, [&](ApiResponse) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (--remaining == 0) {
+            answered.notify_all();
+          }
+        });
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  answered.wait(lock, [&] { return remaining == 0; });
+  return stopwatch.elapsedSeconds();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {4, 16}, {4});
+  std::chrono::microseconds latency(args.quick ? 2000 : 40000);
+
+  for (size_t screens : args.sizes) {
+    testing::SimulatedApiServer direct(latency);
+    routeAll(direct);
+    double seconds = mountScreens(direct, screens);
+    direct.waitIdle();
+    reportResult("mount: direct", screens, seconds, static_cast<double>(screens), "screens");
+    reportCount("requests: direct", screens, static_cast<double>(direct.requestCount()), "requests");
+    reportBytes("response bytes: direct", screens, static_cast<double>(direct.bytesSent()));
+
+    testing::SimulatedApiServer server(latency);
+    routeAll(server);
+    SingleFlightTransport transport(server, [] { return std::string("user-1"); });
+    seconds = mountScreens(transport, screens);
+    server.waitIdle();
+    reportResult("mount: single flight", screens, seconds, static_cast<double>(screens), "screens");
+    reportCount("requests: single flight", screens, static_cast<double>(server.requestCount()), "requests");
+    reportBytes("response bytes: single flight", screens, static_cast<double>(server.bytesSent()));
+    reportCount("deduplicated", screens, static_cast<double>(transport.stats().deduplicated), "requests");
+  }
+  return 0;
+}
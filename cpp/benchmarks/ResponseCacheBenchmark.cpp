@@ -0,0 +1,139 @@
+//
+//  ResponseCacheBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Repeated mounts of a screen that loads the three recommendation endpoints,
+//  against the local API stand-in with injected latency. Mounts are 20
+//  seconds apart and responses change every five minutes. Compares time to
+//  first paint and network use of plain requests with the stale-while-
+//  revalidate client.
+//
+
+#include "BenchmarkUtil.h"
+#include "ResponseCache.h"
+#include "SimulatedApiServer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+using namespace std::chrono_literals;
+
+namespace {
+
+const char *const kEndpoints[] = {
+    "/api/v1/recommendations/invite",
+    "/api/v1/recommendations/contacts-using-app",
+    "/api/v1/recommendations/users-you-might-know",
+};
+constexpr size_t kResultsPerEndpoint = 20;
+constexpr double kMountInterval = 20;
+constexpr double kChangeInterval = 300;
+
+std::string recommendationsBody(const char *endpoint, size_t version) {
+  std::string body = "[";
+  for (size_t i = 0; i < kResultsPerEndpoint; ++i) {
+    char item[160];
+    std::snprintf(item, sizeof(item),
+                  "%s{\"id\":\"%s-%zu-%zu\",\"fullName\":\"Synthetic Person %zu\",\"score\":0.%zu}",
+                  i == 0 ? "" : ",", endpoint, version, i, i, 99 - i);
+    body += item;
+  }
+  body += "]";
+  return body;
+}
+
+// Waits for the first delivery of each of a mount's requests
+class FirstPaint {
+public:
+  explicit FirstPaint(size_t expected) : remaining_(expected) {}
+
+  void delivered() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (remaining_ > 0 && --remaining_ == 0) {
+      ready_.notify_all();
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return remaining_ == 0; });
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  size_t remaining_;
+};
+
+void reportMillis(const char *name, size_t size, double millis) {
+  std::printf("%-36s n=%-8zu %10.3f ms\n", name, size, millis);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {100}, {20});
+  std::chrono::microseconds latency = args.quick ? 2ms : 30ms;
+
+  for (size_t mounts : args.sizes) {
+    double now = 1700000000;
+    testing::SimulatedApiServer server(latency);
+    for (const char *endpoint : kEndpoints) {
+      server.route("GET", endpoint, [endpoint, &now](const ApiRequest &) {
+        return ApiResponse{200, recommendationsBody(endpoint, static_cast<size_t>(now / kChangeInterval)), ""};
+      });
+    }
+
+    double uncachedMillis = 0;
+    for (size_t mount = 0; mount < mounts; ++mount) {
+      FirstPaint paint(3);
+      Stopwatch stopwatch;
+      for (const char *endpoint : kEndpoints) {
+        ApiRequest request;
+        request.endpoint = endpoint;
+        request.parameters = {{"limit", "20"}};
+        server.send(request, [&paint](ApiResponse) { paint.delivered(); });
+      }
+      paint.wait();
+      uncachedMillis += stopwatch.elapsedMillis();
+      server.waitIdle();
+      now += kMountInterval;
+    }
+    reportMillis("first paint: uncached", mounts, uncachedMillis / static_cast<double>(mounts));
+    reportCount("requests: uncached", mounts, static_cast<double>(server.requestCount()), "requests");
+    reportCount("response bytes: uncached", mounts, static_cast<double>(server.bytesSent()), "bytes");
+
+    server.resetCounters();
+    now = 1700000000;
+    ResponseCache cache;
+    CachingApiClient client(server, cache, [&now] { return now; });
+    double cachedMillis = 0;
+    for (size_t mount = 0; mount < mounts; ++mount) {
+      FirstPaint paint(3);
+      Stopwatch stopwatch;
+      for (const char *endpoint : kEndpoints) {
+        ApiRequest request;
+        request.endpoint = endpoint;
+        request.parameters = {{"limit", "20"}};
+        client.get(request, "user-benchmark", [&paint](const CachedApiResponse &) { paint.delivered(); });
+      }
+      paint.wait();
+      cachedMillis += stopwatch.elapsedMillis();
+      server.waitIdle();
+      now += kMountInterval;
+    }
+    ResponseCacheStats stats = cache.stats();
+    reportMillis("first paint: cached", mounts, cachedMillis / static_cast<double>(mounts));
+    reportCount("requests: cached", mounts, static_cast<double>(server.requestCount()), "requests");
+    reportCount("response bytes: cached", mounts, static_cast<double>(server.bytesSent()), "bytes");
+    std::printf("%-36s n=%-8zu hits=%zu stale=%zu misses=%zu revalidated=%zu\n", "cache", mounts, stats.hits,
+                stats.staleHits, stats.misses, stats.revalidations);
+  }
+  return 0;
+}
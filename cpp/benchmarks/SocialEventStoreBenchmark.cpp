@@ -0,0 +1,97 @@
+//
+//  SocialEventStoreBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Four feeds of the same size over one synthetic event pool, each sharing
+//  most of its events with the others the way getFeed, getForYouFeed,
+//  getUpcomingEvents and getUserEvents do. Compares the memory of a copy
+//  per feed with the normalized store, and reports the cold start: loading
+//  the persisted store and reading the first screen of every feed.
+//
+
+#include "BenchmarkUtil.h"
+#include "SimulatedFeedServer.h"
+#include "SocialEventStore.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+const char *const kFeeds[] = {"getFeed", "getForYouFeed", "getUpcomingEvents", "getUserEvents"};
+constexpr size_t kFirstScreen = 20;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {1000, 10000}, {500});
+
+  for (size_t size : args.sizes) {
+    // Each feed covers size events at a different offset into a pool of 1.5 x size
+    std::vector<SocialEvent> pool = testing::makeSyntheticFeedEvents(size + size / 2);
+    std::vector<std::vector<SocialEvent>> feeds;
+    for (size_t i = 0; i < 4; ++i) {
+      size_t first = i * size / 8;
+      feeds.emplace_back(pool.begin() + static_cast<std::ptrdiff_t>(first),
+                         pool.begin() + static_cast<std::ptrdiff_t>(first + size));
+    }
+
+    // A store per feed holds what converting every list separately keeps alive
+    size_t perFeedBytes = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      SocialEventStore separate(SocialEventStoreOptions{pool.size(), SIZE_MAX, pool.size()});
+      separate.storeFeedPage(kFeeds[i], feeds[i], "", true);
+      perFeedBytes += separate.stats().bytes;
+    }
+    reportBytes("memory: copy per feed", size, static_cast<double>(perFeedBytes));
+
+    SocialEventStoreOptions options;
+    options.maxEvents = pool.size();
+    options.maxBytes = perFeedBytes;
+    options.maxFeedEvents = pool.size();
+    SocialEventStore store(options);
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < 4; ++i) {
+      store.storeFeedPage(kFeeds[i], feeds[i], "", true);
+    }
+    reportResult("store: four feeds", size, stopwatch.elapsedSeconds(), static_cast<double>(4 * size), "events");
+    reportBytes("memory: normalized", size, static_cast<double>(store.stats().bytes));
+
+    std::string path = "cm_event_store_benchmark.bin";
+    stopwatch.reset();
+    bool saved = store.save(path);
+    reportResult("save", size, stopwatch.elapsedSeconds(), static_cast<double>(store.stats().events), "events");
+
+    SocialEventStore cold(options);
+    stopwatch.reset();
+    bool loaded = cold.load(path);
+    size_t shown = 0;
+    for (const char *feed : kFeeds) {
+      shown += cold.feed(feed, kFirstScreen).events.size();
+    }
+    reportResult("cold start: load and first screens", size, stopwatch.elapsedSeconds(),
+                 static_cast<double>(cold.stats().events), "events");
+    if (!saved || !loaded || shown != 4 * kFirstScreen) {
+      std::fprintf(stderr, "event store round trip failed\n");
+      return 1;
+    }
+    std::remove(path.c_str());
+
+    stopwatch.reset();
+    size_t found = 0;
+    for (size_t round = 0; round < 10; ++round) {
+      for (const SocialEvent &event : pool) {
+        found += cold.event(event.eventId) ? 1 : 0;
+      }
+    }
+    reportResult("lookup by eventId", size, stopwatch.elapsedSeconds(), static_cast<double>(10 * pool.size()),
+                 "lookups");
+    doNotOptimize(found);
+  }
+  return 0;
+}
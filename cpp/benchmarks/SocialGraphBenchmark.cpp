@@ -0,0 +1,67 @@
+//
+//  SocialGraphBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Builds the local social graph from synthetic books and follow lists and
+//  re-ranks 10k server candidates. Reports build time, graph memory and
+//  ranking throughput, plus how many of the top 100 the user has a local
+//  tie to before and after re-ranking.
+//
+
+#include "BenchmarkUtil.h"
+#include "LocalSocialGraph.h"
+#include "SyntheticAddressBook.h"
+#include "SyntheticSocialGraph.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr size_t kTop = 100;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000}, {2000});
+  size_t candidateCount = args.quick ? 2000 : 10000;
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+    testing::SyntheticSocialGraph social = testing::makeSyntheticSocialGraph(book, size / 10, candidateCount);
+    SocialGraphOptions options;
+    options.defaultCountryCode = 1;
+
+    Stopwatch stopwatch;
+    LocalSocialGraph graph(book, social.following, social.followers, social.interactionCounts, options);
+    reportResult("graph: build", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "contacts");
+    reportBytes("graph: memory", size, static_cast<double>(graph.memoryBytes()));
+    reportCount("graph: attribute nodes", size, static_cast<double>(graph.attributeCount()), "nodes");
+
+    stopwatch.reset();
+    std::vector<RankedCandidate> ranked = graph.rank(social.candidates);
+    reportResult("rank: 10k candidates", size, stopwatch.elapsedSeconds(),
+                 static_cast<double>(social.candidates.size()), "candidates");
+    doNotOptimize(ranked);
+
+    size_t serverTies = 0;
+    size_t localTies = 0;
+    for (size_t i = 0, shown = 0; i < social.candidates.size() && shown < kTop; ++i) {
+      CandidateFeatures features = graph.featuresFor(social.candidates[i]);
+      if (!features.alreadyFollowing) {
+        serverTies += features.followsYou || features.inAddressBook ? 1 : 0;
+        shown++;
+      }
+    }
+    for (size_t i = 0; i < std::min(kTop, ranked.size()); ++i) {
+      localTies += ranked[i].features.followsYou || ranked[i].features.inAddressBook ? 1 : 0;
+    }
+    reportCount("top 100 with a tie: server order", size, static_cast<double>(serverTies), "candidates");
+    reportCount("top 100 with a tie: re-ranked", size, static_cast<double>(localTies), "candidates");
+  }
+  return 0;
+}
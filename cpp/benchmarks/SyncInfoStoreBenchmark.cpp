@@ -0,0 +1,166 @@
+//
+//  SyncInfoStoreBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Compares the sync-info persistence strategies. The archive baseline keeps
+//  every sync info in a map and rewrites the whole file on each save and
+//  decodes all of it on launch, like saveSyncInfoCache/loadSyncInfoCache;
+//  SyncInfoStore appends one record per save and maps the file on launch.
+//
+
+#include "BenchmarkUtil.h"
+#include "BinaryFile.h"
+#include "SyncInfoStore.h"
+#include "SyntheticAddressBook.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+constexpr size_t kSaves = 200;
+constexpr size_t kLookups = 100000;
+
+void saveArchive(const std::string &path, const std::unordered_map<std::string, SyncInfoRecord> &infos) {
+  std::string out;
+  binary::writeUint32(out, static_cast<uint32_t>(infos.size()));
+  for (const auto &entry : infos) {
+    binary::writeString(out, entry.first);
+    binary::writeUint64(out, entry.second.contentHash.low);
+    binary::writeUint64(out, entry.second.contentHash.high);
+    uint64_t syncedAt = 0;
+    std::memcpy(&syncedAt, &entry.second.lastSyncedAt, sizeof(syncedAt));
+    binary::writeUint64(out, syncedAt);
+    binary::writeUint32(out, entry.second.flags);
+  }
+  binary::writeFileAtomically(path, out);
+}
+
+std::unordered_map<std::string, SyncInfoRecord> loadArchive(const std::string &path) {
+  std::unordered_map<std::string, SyncInfoRecord> infos;
+  std::string data;
+  binary::readFile(path, data);
+  binary::Reader reader(data);
+  uint32_t count = 0;
+  reader.readUint32(count);
+  infos.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string contactId;
+    SyncInfoRecord record;
+    uint64_t syncedAt = 0;
+    reader.readString(contactId);
+    reader.readUint64(record.contentHash.low);
+    reader.readUint64(record.contentHash.high);
+    reader.readUint64(syncedAt);
+    std::memcpy(&record.lastSyncedAt, &syncedAt, sizeof(syncedAt));
+    reader.readUint32(record.flags);
+    infos.emplace(std::move(contactId), record);
+  }
+  return infos;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {10000, 100000}, {1000});
+  std::string archivePath = "cm_sync_info_benchmark.archive";
+  std::string storePath = "cm_sync_info_benchmark.bin";
+
+  for (size_t size : args.sizes) {
+    testing::SplitMix64 random(size);
+    std::vector<std::string> ids;
+    std::unordered_map<std::string, SyncInfoRecord> infos;
+    ids.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+      ids.push_back("contact-" + std::to_string(i));
+      SyncInfoRecord record;
+      record.contentHash.low = random.next();
+      record.contentHash.high = random.next();
+      record.lastSyncedAt = 1.7e9 + static_cast<double>(i);
+      infos.emplace(ids.back(), record);
+    }
+    saveArchive(archivePath, infos);
+    std::remove(storePath.c_str());
+    {
+      SyncInfoStore store;
+      store.open(storePath);
+      for (const auto &id : ids) {
+        store.put(id, infos[id]);
+      }
+      store.compact();
+    }
+
+    {
+      Stopwatch stopwatch;
+      for (size_t i = 0; i < kSaves; ++i) {
+        SyncInfoRecord &record = infos[ids[random.nextBelow(size)]];
+        record.lastSyncedAt += 1;
+        saveArchive(archivePath, infos);
+      }
+      reportResult("archive save per contact", size, stopwatch.elapsedSeconds(), kSaves, "saves");
+    }
+
+    SyncInfoStore store;
+    {
+      store.open(storePath);
+      // Keep the measured appends out of the compaction path
+      store.setCompactionThreshold(SIZE_MAX);
+      Stopwatch stopwatch;
+      for (size_t i = 0; i < kSaves; ++i) {
+        const std::string &id = ids[random.nextBelow(size)];
+        SyncInfoRecord record = *store.get(id);
+        record.lastSyncedAt += 1;
+        store.put(id, record);
+      }
+      reportResult("store append per contact", size, stopwatch.elapsedSeconds(), kSaves, "saves");
+      store.close();
+    }
+
+    {
+      Stopwatch stopwatch;
+      auto loaded = loadArchive(archivePath);
+      doNotOptimize(loaded.size());
+      reportResult("archive launch decode", size, stopwatch.elapsedSeconds(), static_cast<double>(size),
+                   "records");
+    }
+
+    {
+      Stopwatch stopwatch;
+      store.open(storePath);
+      doNotOptimize(store.size());
+      reportResult("store launch open", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "records");
+    }
+
+    {
+      size_t lookups = args.quick ? 1000 : kLookups;
+      Stopwatch stopwatch;
+      size_t found = 0;
+      for (size_t i = 0; i < lookups; ++i) {
+        found += store.get(ids[random.nextBelow(size)]).has_value() ? 1 : 0;
+      }
+      reportResult("store lookup", size, stopwatch.elapsedSeconds(), static_cast<double>(lookups), "lookups");
+      if (found != lookups) {
+        std::fprintf(stderr, "store lookups found %zu of %zu records\n", found, lookups);
+        return 1;
+      }
+    }
+
+    {
+      Stopwatch stopwatch;
+      store.compact();
+      reportResult("store compaction", size, stopwatch.elapsedSeconds(), static_cast<double>(size), "records");
+    }
+    store.close();
+  }
+
+  std::remove(archivePath.c_str());
+  std::remove(storePath.c_str());
+  return 0;
+}
@@ -0,0 +1,79 @@
+//
+//  SyncWireFormatBenchmark.cpp
+//  ContactsManagerCore
+//
+//  Encodes a synthetic book as one bulk-create body in each wire encoding and
+//  reports the body size and encode throughput, plus the server-side decode
+//  of each so a broken encoding fails the run.
+//
+
+#include "BenchmarkUtil.h"
+#include "CborDecoder.h"
+#include "ServerContactJson.h"
+#include "SyncWireFormat.h"
+#include "SyntheticAddressBook.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace contactsmanager::benchmark;
+
+namespace {
+
+const ServerContactContext kContext{"org-benchmark", "source-benchmark"};
+
+struct Variant {
+  const char *name;
+  WireEncoding encoding;
+};
+
+bool measure(const Variant &variant, const std::vector<Contact> &book, const testing::JsonValue &expected,
+             int iterations) {
+  std::string body;
+  Stopwatch stopwatch;
+  for (int i = 0; i < iterations; ++i) {
+    body = encodeBulkCreateBody(book.data(), book.size(), kContext, false, variant.encoding);
+    doNotOptimize(body);
+  }
+  double seconds = stopwatch.elapsedSeconds() / iterations;
+
+  std::optional<testing::JsonValue> decoded = testing::decodeRequestBody(body, variant.encoding);
+  if (!decoded || *decoded != expected) {
+    std::fprintf(stderr, "%s body does not decode to the JSON body\n", variant.name);
+    return false;
+  }
+  reportResult(variant.name, book.size(), seconds, static_cast<double>(book.size()), "contacts");
+  reportBytes(variant.name, book.size(), static_cast<double>(body.size()));
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchmarkArgs args = parseBenchmarkArgs(argc, argv, {5000, 20000}, {500});
+  int iterations = args.quick ? 1 : 5;
+  const Variant variants[] = {
+      {"json", {WireFormat::Json, WireCompression::None}},
+      {"json + deflate", {WireFormat::Json, WireCompression::Deflate}},
+      {"cbor", {WireFormat::Cbor, WireCompression::None}},
+      {"cbor + deflate", {WireFormat::Cbor, WireCompression::Deflate}},
+      {"cbor + gzip", {WireFormat::Cbor, WireCompression::Gzip}},
+  };
+
+  for (size_t size : args.sizes) {
+    std::vector<Contact> book = testing::makeSyntheticAddressBook(size);
+    std::optional<testing::JsonValue> expected =
+        testing::JsonValue::parse(encodeBulkCreateBody(book, kContext, false));
+    if (!expected) {
+      return 1;
+    }
+    for (const Variant &variant : variants) {
+      if (!measure(variant, book, *expected, iterations)) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,289 @@
+//
+//  ContactListHostObject.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactListHostObject.h"
+
+#include "Base64.h"
+
+#include <cmath>
+#include <string>
+
+namespace contactsmanager {
+
+using namespace facebook;
+
+namespace {
+
+jsi::String makeString(jsi::Runtime &runtime, std::string_view value) {
+  return jsi::String::createFromUtf8(runtime, reinterpret_cast<const uint8_t *>(value.data()), value.size());
+}
+
+jsi::Object labeledValueObject(jsi::Runtime &runtime, const LabeledValueView &view) {
+  jsi::Object object(runtime);
+  object.setProperty(runtime, "contactId", makeString(runtime, view.contactId));
+  object.setProperty(runtime, "value", makeString(runtime, view.value));
+  object.setProperty(runtime, "type", makeString(runtime, view.type));
+  object.setProperty(runtime, "emoji", makeString(runtime, view.emoji));
+  return object;
+}
+
+jsi::Object postalAddressObject(jsi::Runtime &runtime, const PostalAddressView &view) {
+  jsi::Object object(runtime);
+  object.setProperty(runtime, "contactId", makeString(runtime, view.contactId));
+  object.setProperty(runtime, "street", makeString(runtime, view.street));
+  object.setProperty(runtime, "city", makeString(runtime, view.city));
+  object.setProperty(runtime, "state", makeString(runtime, view.state));
+  object.setProperty(runtime, "postalCode", makeString(runtime, view.postalCode));
+  object.setProperty(runtime, "country", makeString(runtime, view.country));
+  object.setProperty(runtime, "type", makeString(runtime, view.type));
+  object.setProperty(runtime, "emoji", makeString(runtime, view.emoji));
+  return object;
+}
+
+jsi::Object dateObject(jsi::Runtime &runtime, const ContactDateView &view) {
+  jsi::Object object(runtime);
+  object.setProperty(runtime, "contactId", makeString(runtime, view.contactId));
+  // Milliseconds, like birthday
+  object.setProperty(runtime, "date", jsi::Value(view.date * 1000));
+  object.setProperty(runtime, "type", makeString(runtime, view.type));
+  return object;
+}
+
+jsi::Object socialProfileObject(jsi::Runtime &runtime, const SocialProfileView &view) {
+  jsi::Object object(runtime);
+  object.setProperty(runtime, "contactId", makeString(runtime, view.contactId));
+  object.setProperty(runtime, "service", makeString(runtime, view.service));
+  object.setProperty(runtime, "username", makeString(runtime, view.username));
+  object.setProperty(runtime, "urlString", makeString(runtime, view.urlString));
+  return object;
+}
+
+jsi::Object relationObject(jsi::Runtime &runtime, const RelationView &view) {
+  jsi::Object object(runtime);
+  object.setProperty(runtime, "contactId", makeString(runtime, view.contactId));
+  object.setProperty(runtime, "name", makeString(runtime, view.name));
+  object.setProperty(runtime, "type", makeString(runtime, view.type));
+  return object;
+}
+
+jsi::Object instantMessageObject(jsi::Runtime &runtime, const InstantMessageView &view) {
+  jsi::Object object(runtime);
+  object.setProperty(runtime, "contactId", makeString(runtime, view.contactId));
+  object.setProperty(runtime, "service", makeString(runtime, view.service));
+  object.setProperty(runtime, "username", makeString(runtime, view.username));
+  object.setProperty(runtime, "type", makeString(runtime, view.type));
+  return object;
+}
+
+jsi::Object avatarObject(jsi::Runtime &runtime, std::string_view contactId, std::string_view url) {
+  jsi::Object object(runtime);
+  object.setProperty(runtime, "contactId", makeString(runtime, contactId));
+  object.setProperty(runtime, "url", makeString(runtime, url));
+  return object;
+}
+
+// Builds a JS array of count items from makeItem(i)
+template <typename MakeItem>
+jsi::Array makeArray(jsi::Runtime &runtime, size_t count, MakeItem makeItem) {
+  jsi::Array array(runtime, count);
+  for (size_t i = 0; i < count; ++i) {
+    array.setValueAtIndex(runtime, i, makeItem(i));
+  }
+  return array;
+}
+
+// Base64, as contactToDictionary sends photos in inline mode; undefined when absent
+jsi::Value imageBytesValue(jsi::Runtime &runtime, std::string_view bytes) {
+  if (bytes.empty()) {
+    return jsi::Value::undefined();
+  }
+  return makeString(runtime, base64::encode(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size()));
+}
+
+bool isBooleanField(ContactNumberField field) {
+  return field == ContactNumberField::IsDeleted || field == ContactNumberField::ImageDataAvailable;
+}
+
+const char *const kCollectionNames[] = {
+    "phoneNumbers", "emailAddresses", "addresses", "dates", "urlAddresses", "socialProfiles", "relations",
+    "instantMessageAddresses", "interests", "avatars",
+};
+
+size_t rowIndexArgument(jsi::Runtime &runtime, const jsi::Value &value, size_t count) {
+  if (!value.isNumber()) {
+    throw jsi::JSError(runtime, "ContactList: index must be a number");
+  }
+  double index = value.getNumber();
+  if (index < 0 || index >= static_cast<double>(count) || std::floor(index) != index) {
+    throw jsi::JSError(runtime, "ContactList: index out of range");
+  }
+  return static_cast<size_t>(index);
+}
+
+} // namespace
+
+jsi::Value contactFieldValue(jsi::Runtime &runtime, const ContactColumns &columns, size_t row,
+                             const std::string &name) {
+  if (auto field = contactStringFieldNamed(name)) {
+    return makeString(runtime, columns.stringAt(row, *field));
+  }
+  if (auto field = contactNumberFieldNamed(name)) {
+    if (*field == ContactNumberField::Birthday) {
+      // Matches the dictionary path: birthday is omitted when absent, in milliseconds otherwise
+      return columns.hasBirthday(row) ? jsi::Value(columns.numberAt(row, *field) * 1000) : jsi::Value::undefined();
+    }
+    double value = columns.numberAt(row, *field);
+    return isBooleanField(*field) ? jsi::Value(value != 0) : jsi::Value(value);
+  }
+  std::string_view contactId = columns.stringAt(row, ContactStringField::Identifier);
+  if (name == "phoneNumbers") {
+    return makeArray(runtime, columns.phoneNumberCount(row),
+                     [&](size_t i) { return labeledValueObject(runtime, columns.phoneNumberAt(row, i)); });
+  }
+  if (name == "emailAddresses") {
+    return makeArray(runtime, columns.emailAddressCount(row),
+                     [&](size_t i) { return labeledValueObject(runtime, columns.emailAddressAt(row, i)); });
+  }
+  if (name == "addresses") {
+    return makeArray(runtime, columns.addressCount(row),
+                     [&](size_t i) { return postalAddressObject(runtime, columns.addressAt(row, i)); });
+  }
+  if (name == "dates") {
+    return makeArray(runtime, columns.dateCount(row),
+                     [&](size_t i) { return dateObject(runtime, columns.dateAt(row, i)); });
+  }
+  if (name == "urlAddresses") {
+    return makeArray(runtime, columns.urlAddressCount(row),
+                     [&](size_t i) { return labeledValueObject(runtime, columns.urlAddressAt(row, i)); });
+  }
+  if (name == "socialProfiles") {
+    return makeArray(runtime, columns.socialProfileCount(row),
+                     [&](size_t i) { return socialProfileObject(runtime, columns.socialProfileAt(row, i)); });
+  }
+  if (name == "relations") {
+    return makeArray(runtime, columns.relationCount(row),
+                     [&](size_t i) { return relationObject(runtime, columns.relationAt(row, i)); });
+  }
+  if (name == "instantMessageAddresses") {
+    return makeArray(runtime, columns.instantMessageCount(row),
+                     [&](size_t i) { return instantMessageObject(runtime, columns.instantMessageAt(row, i)); });
+  }
+  if (name == "interests") {
+    return makeArray(runtime, columns.interestCount(row),
+                     [&](size_t i) { return makeString(runtime, columns.interestAt(row, i)); });
+  }
+  if (name == "avatars") {
+    return makeArray(runtime, columns.avatarCount(row),
+                     [&](size_t i) { return avatarObject(runtime, contactId, columns.avatarAt(row, i)); });
+  }
+  // Optional fields are undefined when absent, as the dictionary path omits them
+  if (name == "imageId") {
+    std::string_view imageId = columns.imageIdAt(row);
+    return imageId.empty() ? jsi::Value::undefined() : jsi::Value(makeString(runtime, imageId));
+  }
+  if (name == "imageData") {
+    return imageBytesValue(runtime, columns.imageDataAt(row));
+  }
+  if (name == "thumbnailImageData") {
+    return imageBytesValue(runtime, columns.thumbnailImageDataAt(row));
+  }
+  return jsi::Value::undefined();
+}
+
+jsi::Value ContactListHostObject::get(jsi::Runtime &runtime, const jsi::PropNameID &propName) {
+  std::string name = propName.utf8(runtime);
+  auto columns = columns_;
+
+  if (name == "length") {
+    return jsi::Value(static_cast<double>(columns->size()));
+  }
+  if (name == "get") {
+    return jsi::Function::createFromHostFunction(
+        runtime, propName, 1,
+        [columns](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+          size_t row = rowIndexArgument(rt, count > 0 ? args[0] : jsi::Value::undefined(), columns->size());
+          return jsi::Object::createFromHostObject(rt, std::make_shared<ContactRowHostObject>(columns, row));
+        });
+  }
+  if (name == "getField") {
+    return jsi::Function::createFromHostFunction(
+        runtime, propName, 2,
+        [columns](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+          size_t row = rowIndexArgument(rt, count > 0 ? args[0] : jsi::Value::undefined(), columns->size());
+          if (count < 2 || !args[1].isString()) {
+            throw jsi::JSError(rt, "ContactList: field name must be a string");
+          }
+          return contactFieldValue(rt, *columns, row, args[1].getString(rt).utf8(rt));
+        });
+  }
+  return jsi::Value::undefined();
+}
+
+std::vector<jsi::PropNameID> ContactListHostObject::getPropertyNames(jsi::Runtime &runtime) {
+  std::vector<jsi::PropNameID> names;
+  names.push_back(jsi::PropNameID::forAscii(runtime, "length"));
+  names.push_back(jsi::PropNameID::forAscii(runtime, "get"));
+  names.push_back(jsi::PropNameID::forAscii(runtime, "getField"));
+  return names;
+}
+
+jsi::Value ContactRowHostObject::get(jsi::Runtime &runtime, const jsi::PropNameID &propName) {
+  return contactFieldValue(runtime, *columns_, row_, propName.utf8(runtime));
+}
+
+std::vector<jsi::PropNameID> ContactRowHostObject::getPropertyNames(jsi::Runtime &runtime) {
+  std::vector<jsi::PropNameID> names;
+  for (size_t i = 0; i < kContactStringFieldCount; ++i) {
+    names.push_back(jsi::PropNameID::forAscii(runtime, contactFieldName(static_cast<ContactStringField>(i))));
+  }
+  for (size_t i = 0; i < kContactNumberFieldCount; ++i) {
+    auto field = static_cast<ContactNumberField>(i);
+    if (field == ContactNumberField::Birthday && !columns_->hasBirthday(row_)) {
+      continue;
+    }
+    names.push_back(jsi::PropNameID::forAscii(runtime, contactFieldName(field)));
+  }
+  for (const char *collection : kCollectionNames) {
+    names.push_back(jsi::PropNameID::forAscii(runtime, collection));
+  }
+  if (!columns_->imageIdAt(row_).empty()) {
+    names.push_back(jsi::PropNameID::forAscii(runtime, "imageId"));
+  }
+  if (!columns_->imageDataAt(row_).empty()) {
+    names.push_back(jsi::PropNameID::forAscii(runtime, "imageData"));
+  }
+  if (!columns_->thumbnailImageDataAt(row_).empty()) {
+    names.push_back(jsi::PropNameID::forAscii(runtime, "thumbnailImageData"));
+  }
+  return names;
+}
+
+void installContactListBindings(jsi::Runtime &runtime) {
+  auto contactList = jsi::Function::createFromHostFunction(
+      runtime, jsi::PropNameID::forAscii(runtime, "__ContactsManagerContactList"), 1,
+      [](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        if (count < 1 || !args[0].isNumber()) {
+          return jsi::Value::undefined();
+        }
+        auto columns = ContactColumnRegistry::sharedInstance().get(static_cast<uint64_t>(args[0].getNumber()));
+        if (!columns) {
+          return jsi::Value::undefined();
+        }
+        return jsi::Object::createFromHostObject(rt, std::make_shared<ContactListHostObject>(std::move(columns)));
+      });
+  runtime.global().setProperty(runtime, "__ContactsManagerContactList", std::move(contactList));
+
+  auto releaseContactList = jsi::Function::createFromHostFunction(
+      runtime, jsi::PropNameID::forAscii(runtime, "__ContactsManagerReleaseContactList"), 1,
+      [](jsi::Runtime &, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        if (count < 1 || !args[0].isNumber()) {
+          return jsi::Value(false);
+        }
+        return jsi::Value(ContactColumnRegistry::sharedInstance().release(static_cast<uint64_t>(args[0].getNumber())));
+      });
+  runtime.global().setProperty(runtime, "__ContactsManagerReleaseContactList", std::move(releaseContactList));
+}
+
+} // namespace contactsmanager
@@ -0,0 +1,64 @@
+//
+//  ContactListHostObject.h
+//  ContactsManagerCore
+//
+//  JSI view over a ContactColumns snapshot. JS indexes the list and reads
+//  fields on demand; nothing is materialized per contact until it is touched.
+//  Requires the React Native JSI headers, so it is compiled by the pod only.
+//
+
+#pragma once
+
+#include "ContactColumns.h"
+
+#include <jsi/jsi.h>
+
+#include <memory>
+#include <vector>
+
+namespace contactsmanager {
+
+/**
+ * HostObject for a whole snapshot: `length`, `get(index)`, `getField(index, name)`
+ */
+class ContactListHostObject : public facebook::jsi::HostObject {
+public:
+  explicit ContactListHostObject(std::shared_ptr<const ContactColumns> columns) : columns_(std::move(columns)) {}
+
+  facebook::jsi::Value get(facebook::jsi::Runtime &runtime, const facebook::jsi::PropNameID &name) override;
+  std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime &runtime) override;
+
+private:
+  std::shared_ptr<const ContactColumns> columns_;
+};
+
+/**
+ * HostObject for one row; property reads go straight to the columns
+ */
+class ContactRowHostObject : public facebook::jsi::HostObject {
+public:
+  ContactRowHostObject(std::shared_ptr<const ContactColumns> columns, size_t row)
+      : columns_(std::move(columns)), row_(row) {}
+
+  facebook::jsi::Value get(facebook::jsi::Runtime &runtime, const facebook::jsi::PropNameID &name) override;
+  std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime &runtime) override;
+
+private:
+  std::shared_ptr<const ContactColumns> columns_;
+  size_t row_;
+};
+
+/**
+ * Reads a single field of a row as a JS value (undefined for unknown names)
+ */
+facebook::jsi::Value contactFieldValue(facebook::jsi::Runtime &runtime, const ContactColumns &columns, size_t row,
+                                       const std::string &name);
+
+/**
+ * Installs the global functions used by src/services/contactsService.ts:
+ *   __ContactsManagerContactList(handle) -> ContactListHostObject | undefined
+ *   __ContactsManagerReleaseContactList(handle) -> boolean
+ */
+void installContactListBindings(facebook::jsi::Runtime &runtime);
+
+} // namespace contactsmanager
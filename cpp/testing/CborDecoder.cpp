@@ -0,0 +1,227 @@
+//
+//  CborDecoder.cpp
+//  ContactsManagerCore
+//
+
+#include "CborDecoder.h"
+
+#include "CborWriter.h"
+#include "DeflateStream.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+namespace {
+
+constexpr size_t kMaxDepth = 128;
+constexpr uint8_t kBreak = 0xff;
+constexpr uint64_t kStringRefNamespaceTag = 256;
+constexpr uint64_t kStringRefTag = 25;
+// Additional information 31: indefinite length
+constexpr uint8_t kIndefinite = 31;
+
+class Decoder {
+public:
+  explicit Decoder(std::string_view bytes) : bytes_(bytes) {}
+
+  bool decodeDocument(JsonValue &value) { return decodeValue(value, 0) && offset_ == bytes_.size(); }
+
+private:
+  bool readByte(uint8_t &byte) {
+    if (offset_ >= bytes_.size()) {
+      return false;
+    }
+    byte = static_cast<uint8_t>(bytes_[offset_++]);
+    return true;
+  }
+
+  bool readArgument(uint8_t info, uint64_t &value) {
+    if (info < 24) {
+      value = info;
+      return true;
+    }
+    if (info > 27) {
+      return false;
+    }
+    size_t length = size_t(1) << (info - 24);
+    value = 0;
+    for (size_t i = 0; i < length; ++i) {
+      uint8_t byte;
+      if (!readByte(byte)) {
+        return false;
+      }
+      value = (value << 8) | byte;
+    }
+    return true;
+  }
+
+  bool peekBreak() {
+    if (offset_ < bytes_.size() && static_cast<uint8_t>(bytes_[offset_]) == kBreak) {
+      offset_++;
+      return true;
+    }
+    return false;
+  }
+
+  bool readText(uint64_t length, std::string &text) {
+    if (length > bytes_.size() - offset_) {
+      return false;
+    }
+    text.assign(bytes_.data() + offset_, static_cast<size_t>(length));
+    offset_ += static_cast<size_t>(length);
+    // Numbered the same way the writer numbers it
+    if (!namespaces_.empty() && text.size() >= cborMinSharedStringLength(namespaces_.back().size())) {
+      namespaces_.back().push_back(text);
+    }
+    return true;
+  }
+
+  bool decodeFloat(uint8_t info, JsonValue &value) {
+    uint64_t bits;
+    if (!readArgument(info, bits)) {
+      return false;
+    }
+    value.type = JsonValue::Type::Number;
+    if (info == 25) {
+      // Half precision (RFC 8949 appendix D)
+      int exponent = static_cast<int>((bits >> 10) & 0x1f);
+      double mantissa = static_cast<double>(bits & 0x3ff);
+      double magnitude = exponent == 0    ? std::ldexp(mantissa, -24)
+                         : exponent == 31 ? (mantissa == 0 ? INFINITY : NAN)
+                                          : std::ldexp(mantissa + 1024, exponent - 25);
+      value.number = (bits & 0x8000) ? -magnitude : magnitude;
+    } else if (info == 26) {
+      uint32_t narrow = static_cast<uint32_t>(bits);
+      float single;
+      std::memcpy(&single, &narrow, sizeof(single));
+      value.number = single;
+    } else {
+      std::memcpy(&value.number, &bits, sizeof(value.number));
+    }
+    return true;
+  }
+
+  bool decodeValue(JsonValue &value, size_t depth) {
+    uint8_t initial;
+    if (depth > kMaxDepth || !readByte(initial)) {
+      return false;
+    }
+    uint8_t major = initial >> 5;
+    uint8_t info = initial & 0x1f;
+    uint64_t argument = 0;
+    bool indefinite = info == kIndefinite && (major == 4 || major == 5);
+    if (major != 7 && !indefinite && !readArgument(info, argument)) {
+      return false;
+    }
+
+    switch (major) {
+    case 0:
+    case 1:
+      value.type = JsonValue::Type::Number;
+      value.number = major == 0 ? static_cast<double>(argument) : -1.0 - static_cast<double>(argument);
+      return true;
+    case 3:
+      value.type = JsonValue::Type::String;
+      return readText(argument, value.string);
+    case 4:
+      value.type = JsonValue::Type::Array;
+      for (uint64_t i = 0; indefinite || i < argument; ++i) {
+        if (indefinite && peekBreak()) {
+          return true;
+        }
+        value.array.emplace_back();
+        if (!decodeValue(value.array.back(), depth + 1)) {
+          return false;
+        }
+      }
+      return true;
+    case 5:
+      value.type = JsonValue::Type::Object;
+      for (uint64_t i = 0; indefinite || i < argument; ++i) {
+        if (indefinite && peekBreak()) {
+          return true;
+        }
+        JsonValue key;
+        JsonValue member;
+        if (!decodeValue(key, depth + 1) || key.type != JsonValue::Type::String ||
+            !decodeValue(member, depth + 1)) {
+          return false;
+        }
+        value.object.emplace_back(std::move(key.string), std::move(member));
+      }
+      return true;
+    case 6:
+      if (argument == kStringRefNamespaceTag) {
+        namespaces_.emplace_back();
+        bool decoded = decodeValue(value, depth + 1);
+        namespaces_.pop_back();
+        return decoded;
+      }
+      if (argument == kStringRefTag) {
+        uint8_t indexHead;
+        uint64_t index;
+        if (namespaces_.empty() || !readByte(indexHead) || (indexHead >> 5) != 0 ||
+            !readArgument(indexHead & 0x1f, index) || index >= namespaces_.back().size()) {
+          return false;
+        }
+        value.type = JsonValue::Type::String;
+        value.string = namespaces_.back()[static_cast<size_t>(index)];
+        return true;
+      }
+      return false;
+    case 7:
+      switch (info) {
+      case 20:
+      case 21:
+        value = JsonValue::makeBool(info == 21);
+        return true;
+      case 22:
+        value.type = JsonValue::Type::Null;
+        return true;
+      case 25:
+      case 26:
+      case 27:
+        return decodeFloat(info, value);
+      default:
+        return false;
+      }
+    default:
+      return false;
+    }
+  }
+
+  std::string_view bytes_;
+  size_t offset_ = 0;
+  std::vector<std::vector<std::string>> namespaces_;
+};
+
+} // namespace
+
+std::optional<JsonValue> decodeCbor(std::string_view bytes) {
+  JsonValue value;
+  Decoder decoder(bytes);
+  if (!decoder.decodeDocument(value)) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+std::optional<JsonValue> decodeRequestBody(std::string_view body, WireEncoding encoding) {
+  std::string inflated;
+  if (encoding.compression != WireCompression::None) {
+    if (!inflateBytes(body, inflated)) {
+      return std::nullopt;
+    }
+    body = inflated;
+  }
+  return encoding.format == WireFormat::Cbor ? decodeCbor(body) : JsonValue::parse(body);
+}
+
+} // namespace testing
+} // namespace contactsmanager
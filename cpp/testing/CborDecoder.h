@@ -0,0 +1,31 @@
+//
+//  CborDecoder.h
+//  ContactsManagerCore
+//
+//  Decodes the CBOR the core writes into a JsonValue, standing in for the
+//  server's decoder: definite and indefinite maps and arrays, text strings,
+//  integers, floats, simple values and stringref namespaces. Byte strings,
+//  other tags and non-string map keys are rejected since sync bodies never
+//  contain them.
+//
+
+#pragma once
+
+#include "JsonValue.h"
+#include "SyncWireFormat.h"
+
+#include <optional>
+#include <string_view>
+
+namespace contactsmanager {
+namespace testing {
+
+std::optional<JsonValue> decodeCbor(std::string_view bytes);
+
+/**
+ * Undoes the Content-Encoding and parses the body as its Content-Type
+ */
+std::optional<JsonValue> decodeRequestBody(std::string_view body, WireEncoding encoding);
+
+} // namespace testing
+} // namespace contactsmanager
@@ -0,0 +1,332 @@
+//
+//  JsonValue.cpp
+//  ContactsManagerCore
+//
+
+#include "JsonValue.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace contactsmanager {
+namespace testing {
+
+namespace {
+
+constexpr size_t kMaxDepth = 128;
+
+class Parser {
+public:
+  explicit Parser(std::string_view text) : text_(text) {}
+
+  bool parseDocument(JsonValue &value) {
+    if (!parseValue(value, 0)) {
+      return false;
+    }
+    skipWhitespace();
+    return offset_ == text_.size();
+  }
+
+private:
+  void skipWhitespace() {
+    while (offset_ < text_.size() &&
+           (text_[offset_] == ' ' || text_[offset_] == '\n' || text_[offset_] == '\r' || text_[offset_] == '\t')) {
+      offset_++;
+    }
+  }
+
+  bool consume(char expected) {
+    skipWhitespace();
+    if (offset_ < text_.size() && text_[offset_] == expected) {
+      offset_++;
+      return true;
+    }
+    return false;
+  }
+
+  bool consumeLiteral(std::string_view literal) {
+    if (text_.substr(offset_, literal.size()) != literal) {
+      return false;
+    }
+    offset_ += literal.size();
+    return true;
+  }
+
+  bool parseValue(JsonValue &value, size_t depth) {
+    if (depth > kMaxDepth) {
+      return false;
+    }
+    skipWhitespace();
+    if (offset_ >= text_.size()) {
+      return false;
+    }
+    char c = text_[offset_];
+    if (c == '{') {
+      return parseObject(value, depth);
+    }
+    if (c == '[') {
+      return parseArray(value, depth);
+    }
+    if (c == '"') {
+      value.type = JsonValue::Type::String;
+      return parseString(value.string);
+    }
+    if (c == 't' || c == 'f') {
+      value.type = JsonValue::Type::Bool;
+      value.boolean = c == 't';
+      return consumeLiteral(value.boolean ? "true" : "false");
+    }
+    if (c == 'n') {
+      value.type = JsonValue::Type::Null;
+      return consumeLiteral("null");
+    }
+    return parseNumber(value);
+  }
+
+  bool parseObject(JsonValue &value, size_t depth) {
+    value.type = JsonValue::Type::Object;
+    offset_++;
+    if (consume('}')) {
+      return true;
+    }
+    do {
+      skipWhitespace();
+      std::string key;
+      JsonValue member;
+      if (offset_ >= text_.size() || text_[offset_] != '"' || !parseString(key) || !consume(':') ||
+          !parseValue(member, depth + 1)) {
+        return false;
+      }
+      value.object.emplace_back(std::move(key), std::move(member));
+    } while (consume(','));
+    return consume('}');
+  }
+
+  bool parseArray(JsonValue &value, size_t depth) {
+    value.type = JsonValue::Type::Array;
+    offset_++;
+    if (consume(']')) {
+      return true;
+    }
+    do {
+      JsonValue element;
+      if (!parseValue(element, depth + 1)) {
+        return false;
+      }
+      value.array.push_back(std::move(element));
+    } while (consume(','));
+    return consume(']');
+  }
+
+  bool parseHex4(uint32_t &code) {
+    if (offset_ + 4 > text_.size()) {
+      return false;
+    }
+    code = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      char c = text_[offset_++];
+      code <<= 4;
+      if (c >= '0' && c <= '9') {
+        code |= static_cast<uint32_t>(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        code |= static_cast<uint32_t>(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        code |= static_cast<uint32_t>(c - 'A' + 10);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void appendUtf8(std::string &out, uint32_t code) {
+    if (code < 0x80) {
+      out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+  }
+
+  bool parseString(std::string &out) {
+    offset_++;
+    while (offset_ < text_.size()) {
+      char c = text_[offset_++];
+      if (c == '"') {
+        return true;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return false;
+      }
+      if (c != '\\') {
+        out.push_back(c);
+        continue;
+      }
+      if (offset_ >= text_.size()) {
+        return false;
+      }
+      char escape = text_[offset_++];
+      switch (escape) {
+      case '"':
+      case '\\':
+      case '/':
+        out.push_back(escape);
+        break;
+      case 'b':
+        out.push_back('\b');
+        break;
+      case 'f':
+        out.push_back('\f');
+        break;
+      case 'n':
+        out.push_back('\n');
+        break;
+      case 'r':
+        out.push_back('\r');
+        break;
+      case 't':
+        out.push_back('\t');
+        break;
+      case 'u': {
+        uint32_t code = 0;
+        if (!parseHex4(code)) {
+          return false;
+        }
+        if (code >= 0xD800 && code < 0xDC00) {
+          uint32_t low = 0;
+          if (!consumeLiteral("\\u") || !parseHex4(low) || low < 0xDC00 || low >= 0xE000) {
+            return false;
+          }
+          code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        appendUtf8(out, code);
+        break;
+      }
+      default:
+        return false;
+      }
+    }
+    return false;
+  }
+
+  bool parseNumber(JsonValue &value) {
+    size_t start = offset_;
+    while (offset_ < text_.size()) {
+      char c = text_[offset_];
+      if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+        offset_++;
+      } else {
+        break;
+      }
+    }
+    if (start == offset_) {
+      return false;
+    }
+    std::string number(text_.substr(start, offset_ - start));
+    char *end = nullptr;
+    value.type = JsonValue::Type::Number;
+    value.number = std::strtod(number.c_str(), &end);
+    return end == number.c_str() + number.size();
+  }
+
+  std::string_view text_;
+  size_t offset_ = 0;
+};
+
+} // namespace
+
+JsonValue JsonValue::makeBool(bool value) {
+  JsonValue result;
+  result.type = Type::Bool;
+  result.boolean = value;
+  return result;
+}
+
+JsonValue JsonValue::makeString(std::string value) {
+  JsonValue result;
+  result.type = Type::String;
+  result.string = std::move(value);
+  return result;
+}
+
+const JsonValue *JsonValue::find(std::string_view key) const {
+  for (const auto &member : object) {
+    if (member.first == key) {
+      return &member.second;
+    }
+  }
+  return nullptr;
+}
+
+JsonValue *JsonValue::find(std::string_view key) {
+  return const_cast<JsonValue *>(static_cast<const JsonValue *>(this)->find(key));
+}
+
+void JsonValue::set(std::string_view key, JsonValue value) {
+  if (JsonValue *existing = find(key)) {
+    *existing = std::move(value);
+    return;
+  }
+  object.emplace_back(std::string(key), std::move(value));
+}
+
+bool JsonValue::erase(std::string_view key) {
+  for (auto it = object.begin(); it != object.end(); ++it) {
+    if (it->first == key) {
+      object.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+std::optional<JsonValue> JsonValue::parse(std::string_view text) {
+  JsonValue value;
+  Parser parser(text);
+  if (!parser.parseDocument(value)) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+bool operator==(const JsonValue &lhs, const JsonValue &rhs) {
+  if (lhs.type != rhs.type) {
+    return false;
+  }
+  switch (lhs.type) {
+  case JsonValue::Type::Null:
+    return true;
+  case JsonValue::Type::Bool:
+    return lhs.boolean == rhs.boolean;
+  case JsonValue::Type::Number:
+    return lhs.number == rhs.number;
+  case JsonValue::Type::String:
+    return lhs.string == rhs.string;
+  case JsonValue::Type::Array:
+    return lhs.array == rhs.array;
+  case JsonValue::Type::Object:
+    if (lhs.object.size() != rhs.object.size()) {
+      return false;
+    }
+    for (const auto &member : lhs.object) {
+      const JsonValue *other = rhs.find(member.first);
+      if (!other || *other != member.second) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+} // namespace testing
+} // namespace contactsmanager
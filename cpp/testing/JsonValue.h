@@ -0,0 +1,58 @@
+//
+//  JsonValue.h
+//  ContactsManagerCore
+//
+//  Small JSON document model and parser so the local server stand-ins can
+//  read the request bodies the core writes.
+//
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+struct JsonValue {
+  enum class Type { Null, Bool, Number, String, Array, Object };
+
+  Type type = Type::Null;
+  bool boolean = false;
+  double number = 0;
+  std::string string;
+  std::vector<JsonValue> array;
+  // Members in document order
+  std::vector<std::pair<std::string, JsonValue>> object;
+
+  static JsonValue makeBool(bool value);
+  static JsonValue makeString(std::string value);
+
+  bool isNull() const { return type == Type::Null; }
+
+  const JsonValue *find(std::string_view key) const;
+  JsonValue *find(std::string_view key);
+
+  /**
+   * Replaces the member or appends it
+   */
+  void set(std::string_view key, JsonValue value);
+  bool erase(std::string_view key);
+
+  /**
+   * Parses a complete document; nullopt on any syntax error or trailing data
+   */
+  static std::optional<JsonValue> parse(std::string_view text);
+};
+
+/**
+ * Deep equality; object members are compared regardless of order
+ */
+bool operator==(const JsonValue &lhs, const JsonValue &rhs);
+inline bool operator!=(const JsonValue &lhs, const JsonValue &rhs) { return !(lhs == rhs); }
+
+} // namespace testing
+} // namespace contactsmanager
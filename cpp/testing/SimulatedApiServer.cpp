@@ -0,0 +1,135 @@
+//
+//  SimulatedApiServer.cpp
+//  ContactsManagerCore
+//
+
+#include "SimulatedApiServer.h"
+
+#include "ContactHashing.h"
+
+#include <cstdio>
+
+namespace contactsmanager {
+namespace testing {
+
+SimulatedApiServer::SimulatedApiServer(std::chrono::microseconds latency) : latency_(latency) {}
+
+SimulatedApiServer::~SimulatedApiServer() {
+  waitIdle();
+}
+
+void SimulatedApiServer::route(std::string method, std::string endpoint, Route route) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  routes_[{std::move(method), std::move(endpoint)}] = std::move(route);
+}
+
+void SimulatedApiServer::send(ApiRequest request, std::function<void(ApiResponse response)> done) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  requests_.push_back(request);
+  bool fail = failNext_ > 0;
+  failNext_ -= fail ? 1 : 0;
+  std::chrono::microseconds latency = latency_;
+
+  threads_.emplace_back([this, request = std::move(request), done = std::move(done), latency, fail]() {
+    std::this_thread::sleep_for(latency);
+    {
+      std::unique_lock<std::mutex> held(mutex_);
+      released_.wait(held, [this] { return !held_; });
+    }
+    done(fail ? ApiResponse{} : answer(request));
+  });
+}
+
+void SimulatedApiServer::waitIdle() {
+  // Callbacks may send follow-up requests, so keep joining until none are left
+  for (;;) {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      threads.swap(threads_);
+    }
+    if (threads.empty()) {
+      return;
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+}
+
+void SimulatedApiServer::setLatency(std::chrono::microseconds latency) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  latency_ = latency;
+}
+
+void SimulatedApiServer::failNext(size_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  failNext_ = count;
+}
+
+void SimulatedApiServer::hold() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  held_ = true;
+}
+
+void SimulatedApiServer::release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  held_ = false;
+  released_.notify_all();
+}
+
+size_t SimulatedApiServer::requestCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return requests_.size();
+}
+
+size_t SimulatedApiServer::notModifiedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return notModified_;
+}
+
+uint64_t SimulatedApiServer::bytesSent() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytesSent_;
+}
+
+std::vector<ApiRequest> SimulatedApiServer::requests() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return requests_;
+}
+
+void SimulatedApiServer::resetCounters() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  requests_.clear();
+  notModified_ = 0;
+  bytesSent_ = 0;
+}
+
+std::string SimulatedApiServer::etagFor(const std::string &body) {
+  char buffer[24];
+  std::snprintf(buffer, sizeof(buffer), "\"%016llx\"", static_cast<unsigned long long>(fnv1a64(body)));
+  return std::string(buffer);
+}
+
+ApiResponse SimulatedApiServer::answer(const ApiRequest &request) {
+  // Handlers run under the lock, one at a time, like a single server shard
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = routes_.find({request.method, request.endpoint});
+  if (found == routes_.end()) {
+    return ApiResponse{404, "{\"error\":\"not found\"}", ""};
+  }
+  ApiResponse response = found->second(request);
+  if (response.statusCode == 200) {
+    response.etag = etagFor(response.body);
+    if (!request.ifNoneMatch.empty() && request.ifNoneMatch == response.etag) {
+      response.statusCode = 304;
+      response.body.clear();
+      notModified_++;
+    }
+  }
+  bytesSent_ += response.body.size();
+  return response;
+}
+
+} // namespace testing
+} // namespace contactsmanager
@@ -0,0 +1,95 @@
+//
+//  SimulatedApiServer.h
+//  ContactsManagerCore
+//
+//  Host stand-in for the API behind CMAPIClient. Routes are handlers keyed by
+//  method and endpoint; each request is answered on its own thread after a
+//  modelled latency. 200 responses carry an ETag derived from the body, and a
+//  request whose If-None-Match names the current ETag gets an empty 304, the
+//  way the server's conditional GET support does. Requests can be made to
+//  fail, and every request is recorded for assertions.
+//
+
+#pragma once
+
+#include "ApiTransport.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+class SimulatedApiServer : public ApiTransport {
+public:
+  /**
+   * Answers one request; the ETag is filled in by the server
+   */
+  using Route = std::function<ApiResponse(const ApiRequest &request)>;
+
+  explicit SimulatedApiServer(std::chrono::microseconds latency = std::chrono::microseconds(0));
+  ~SimulatedApiServer() override;
+
+  SimulatedApiServer(const SimulatedApiServer &) = delete;
+  SimulatedApiServer &operator=(const SimulatedApiServer &) = delete;
+
+  void route(std::string method, std::string endpoint, Route route);
+
+  void send(ApiRequest request, std::function<void(ApiResponse response)> done) override;
+
+  /**
+   * Blocks until every request sent so far has been answered
+   */
+  void waitIdle();
+
+  void setLatency(std::chrono::microseconds latency);
+
+  /**
+   * The next count requests get no response (status 0) after their latency
+   */
+  void failNext(size_t count);
+
+  /**
+   * While held, requests wait after their latency until release, so tests
+   * control what is in flight when
+   */
+  void hold();
+  void release();
+
+  size_t requestCount() const;
+  size_t notModifiedCount() const;
+  uint64_t bytesSent() const;
+  std::vector<ApiRequest> requests() const;
+  void resetCounters();
+
+  /**
+   * ETag the server sends for a body
+   */
+  static std::string etagFor(const std::string &body);
+
+private:
+  ApiResponse answer(const ApiRequest &request);
+
+  mutable std::mutex mutex_;
+  std::map<std::pair<std::string, std::string>, Route> routes_;
+  std::vector<std::thread> threads_;
+  std::chrono::microseconds latency_;
+  bool held_ = false;
+  std::condition_variable released_;
+  size_t failNext_ = 0;
+  size_t notModified_ = 0;
+  uint64_t bytesSent_ = 0;
+  std::vector<ApiRequest> requests_;
+};
+
+} // namespace testing
+} // namespace contactsmanager
@@ -0,0 +1,149 @@
+//
+//  SimulatedContactStore.cpp
+//  ContactsManagerCore
+//
+
+#include "SimulatedContactStore.h"
+
+#include <cstdlib>
+
+namespace contactsmanager {
+namespace testing {
+
+SimulatedContactStore::SimulatedContactStore(std::vector<Contact> contacts) : contacts_(std::move(contacts)) {
+  positions_.reserve(contacts_.size());
+  for (size_t i = 0; i < contacts_.size(); ++i) {
+    positions_.emplace(contacts_[i].identifier, i);
+  }
+}
+
+void SimulatedContactStore::enumerate(const std::function<bool(Contact &&)> &visit) const {
+  for (const auto &contact : contacts_) {
+    recordsRead_.fetch_add(1, std::memory_order_relaxed);
+    if (!visit(Contact(contact))) {
+      return;
+    }
+  }
+}
+
+std::vector<Contact> SimulatedContactStore::fetchBatch(size_t batchSize, size_t batchIndex) const {
+  std::vector<Contact> batch;
+  if (batchSize == 0) {
+    return batch;
+  }
+  size_t start = batchIndex * batchSize;
+  batch.reserve(batchSize);
+  size_t index = 0;
+  enumerate([&](Contact &&contact) {
+    if (index++ < start) {
+      return true;
+    }
+    batch.push_back(std::move(contact));
+    return batch.size() < batchSize;
+  });
+  return batch;
+}
+
+std::vector<Contact> SimulatedContactStore::fetchContacts(const std::vector<std::string> &identifiers) const {
+  std::vector<Contact> contacts;
+  contacts.reserve(identifiers.size());
+  for (const auto &identifier : identifiers) {
+    auto position = positions_.find(identifier);
+    if (position != positions_.end()) {
+      recordsRead_.fetch_add(1, std::memory_order_relaxed);
+      contacts.push_back(contacts_[position->second]);
+    }
+  }
+  return contacts;
+}
+
+void SimulatedContactStore::addContact(Contact contact) {
+  if (positions_.count(contact.identifier) != 0) {
+    updateContact(std::move(contact));
+    return;
+  }
+  std::string identifier = contact.identifier;
+  positions_.emplace(identifier, contacts_.size());
+  contacts_.push_back(std::move(contact));
+  recordEvent(ContactChangeKind::Added, std::move(identifier));
+}
+
+bool SimulatedContactStore::updateContact(Contact contact) {
+  auto position = positions_.find(contact.identifier);
+  if (position == positions_.end()) {
+    return false;
+  }
+  std::string identifier = contact.identifier;
+  contacts_[position->second] = std::move(contact);
+  recordEvent(ContactChangeKind::Updated, std::move(identifier));
+  return true;
+}
+
+bool SimulatedContactStore::removeContact(std::string_view identifier) {
+  auto position = positions_.find(std::string(identifier));
+  if (position == positions_.end()) {
+    return false;
+  }
+  size_t removed = position->second;
+  positions_.erase(position);
+  contacts_.erase(contacts_.begin() + static_cast<std::ptrdiff_t>(removed));
+  for (size_t i = removed; i < contacts_.size(); ++i) {
+    positions_[contacts_[i].identifier] = i;
+  }
+  recordEvent(ContactChangeKind::Deleted, std::string(identifier));
+  return true;
+}
+
+void SimulatedContactStore::setHistoryLimit(size_t limit) {
+  historyLimit_ = limit;
+  trimHistory();
+}
+
+void SimulatedContactStore::dropHistory() {
+  historyStart_ += history_.size();
+  history_.clear();
+  droppedBefore_ = historyStart_;
+}
+
+std::string SimulatedContactStore::currentHistoryToken() const {
+  return std::to_string(historyStart_ + history_.size());
+}
+
+ChangeHistoryStatus SimulatedContactStore::changesSince(const std::string &token,
+                                                        const std::function<void(const ContactChangeEvent &)> &visit,
+                                                        std::string &nextToken) const {
+  char *end = nullptr;
+  unsigned long long sequence = std::strtoull(token.c_str(), &end, 10);
+  uint64_t current = historyStart_ + history_.size();
+  if (token.empty() || *end != '\0' || sequence > current) {
+    return ChangeHistoryStatus::Unavailable;
+  }
+  if (sequence < droppedBefore_) {
+    return ChangeHistoryStatus::DropEverything;
+  }
+  if (sequence < historyStart_) {
+    return ChangeHistoryStatus::Expired;
+  }
+  for (size_t i = static_cast<size_t>(sequence - historyStart_); i < history_.size(); ++i) {
+    visit(history_[i]);
+  }
+  nextToken = std::to_string(current);
+  return ChangeHistoryStatus::Ok;
+}
+
+void SimulatedContactStore::recordEvent(ContactChangeKind kind, std::string identifier) {
+  history_.push_back(ContactChangeEvent{kind, std::move(identifier)});
+  trimHistory();
+}
+
+void SimulatedContactStore::trimHistory() {
+  if (history_.size() <= historyLimit_) {
+    return;
+  }
+  size_t excess = history_.size() - historyLimit_;
+  history_.erase(history_.begin(), history_.begin() + static_cast<std::ptrdiff_t>(excess));
+  historyStart_ += excess;
+}
+
+} // namespace testing
+} // namespace contactsmanager
@@ -0,0 +1,116 @@
+//
+//  SimulatedContactStore.h
+//  ContactsManagerCore
+//
+//  Host stand-in for CNContactStore. Like the real store it can only be read
+//  by enumerating from the first contact, so the batchSize/batchIndex API has
+//  to skip over every earlier batch on each call. Mutations are recorded in a
+//  change history with the same token semantics as CNChangeHistoryFetchRequest,
+//  including expiry of old history and drop-everything resets.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "ContactChangeFeed.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+class SimulatedContactStore {
+public:
+  explicit SimulatedContactStore(std::vector<Contact> contacts);
+
+  size_t size() const { return contacts_.size(); }
+
+  /**
+   * Visits contacts in store order, handing each visitor a fresh copy as the
+   * store materializes a new record per row; stops when visit returns false
+   */
+  void enumerate(const std::function<bool(Contact &&)> &visit) const;
+
+  /**
+   * Equivalent of fetchContactsWithBatchSize:batchIndex: on top of enumerate
+   */
+  std::vector<Contact> fetchBatch(size_t batchSize, size_t batchIndex) const;
+
+  /**
+   * Equivalent of unifiedContactsMatchingPredicate: with an identifier
+   * predicate; unknown identifiers are skipped
+   */
+  std::vector<Contact> fetchContacts(const std::vector<std::string> &identifiers) const;
+
+  /**
+   * Mutations, each recorded in the change history. Not safe to call while
+   * another thread reads the store.
+   */
+  void addContact(Contact contact);
+  bool updateContact(Contact contact);
+  bool removeContact(std::string_view identifier);
+
+  /**
+   * Keeps at most limit events; older tokens then report Expired
+   */
+  void setHistoryLimit(size_t limit);
+
+  /**
+   * Makes every token issued so far report DropEverything
+   */
+  void dropHistory();
+
+  std::string currentHistoryToken() const;
+  ChangeHistoryStatus changesSince(const std::string &token,
+                                   const std::function<void(const ContactChangeEvent &)> &visit,
+                                   std::string &nextToken) const;
+
+  /**
+   * Records the store has materialized since construction or the last reset
+   */
+  uint64_t recordsRead() const { return recordsRead_.load(std::memory_order_relaxed); }
+  void resetCounters() { recordsRead_.store(0, std::memory_order_relaxed); }
+
+private:
+  void recordEvent(ContactChangeKind kind, std::string identifier);
+  void trimHistory();
+
+  std::vector<Contact> contacts_;
+  std::unordered_map<std::string, size_t> positions_;
+  mutable std::atomic<uint64_t> recordsRead_{0};
+
+  // history_[i] moved the store from sequence historyStart_ + i to historyStart_ + i + 1
+  std::vector<ContactChangeEvent> history_;
+  uint64_t historyStart_ = 0;
+  uint64_t droppedBefore_ = 0;
+  size_t historyLimit_ = SIZE_MAX;
+};
+
+/**
+ * ContactChangeHistory over a simulated store
+ */
+class SimulatedChangeHistory : public ContactChangeHistory {
+public:
+  explicit SimulatedChangeHistory(const SimulatedContactStore &store) : store_(store) {}
+
+  std::string currentToken() const override { return store_.currentHistoryToken(); }
+
+  ChangeHistoryStatus changesSince(const std::string &token,
+                                   const std::function<void(const ContactChangeEvent &)> &visit,
+                                   std::string &nextToken) const override {
+    return store_.changesSince(token, visit, nextToken);
+  }
+
+private:
+  const SimulatedContactStore &store_;
+};
+
+} // namespace testing
+} // namespace contactsmanager
@@ -0,0 +1,195 @@
+//
+//  SimulatedFeedServer.cpp
+//  ContactsManagerCore
+//
+
+#include "SimulatedFeedServer.h"
+
+#include "FeedCursor.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace contactsmanager {
+namespace testing {
+
+namespace {
+
+bool eventBefore(const SocialEvent &lhs, const SocialEvent &rhs) {
+  return feedPositionBefore(feedPositionOf(lhs), feedPositionOf(rhs));
+}
+
+} // namespace
+
+SimulatedFeedServer::SimulatedFeedServer(std::string feed, FeedPaging paging, std::chrono::microseconds latency)
+    : feed_(std::move(feed)), paging_(paging), latency_(latency) {}
+
+SimulatedFeedServer::~SimulatedFeedServer() {
+  waitIdle();
+}
+
+void SimulatedFeedServer::publish(SocialEvent event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto place = std::upper_bound(events_.begin(), events_.end(), event, eventBefore);
+  events_.insert(place, std::move(event));
+}
+
+bool SimulatedFeedServer::remove(const std::string &eventId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = std::find_if(events_.begin(), events_.end(),
+                            [&](const SocialEvent &event) { return event.eventId == eventId; });
+  if (found == events_.end()) {
+    return false;
+  }
+  events_.erase(found);
+  return true;
+}
+
+size_t SimulatedFeedServer::eventCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_.size();
+}
+
+std::optional<FeedPage> SimulatedFeedServer::page(const std::string &cursor, size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  requests_++;
+  size_t first = 0;
+  if (paging_ == FeedPaging::Offset) {
+    if (!cursor.empty()) {
+      auto parsed = std::from_chars(cursor.data(), cursor.data() + cursor.size(), first);
+      if (parsed.ec != std::errc() || parsed.ptr != cursor.data() + cursor.size()) {
+        return std::nullopt;
+      }
+    }
+    // OFFSET reads and discards every row before the page
+    rowsScanned_ += std::min(first, events_.size());
+  } else if (!cursor.empty()) {
+    std::optional<FeedPosition> position = decodeFeedCursor(feed_, cursor);
+    if (!position) {
+      return std::nullopt;
+    }
+    first = static_cast<size_t>(
+        std::upper_bound(events_.begin(), events_.end(), *position,
+                         [](const FeedPosition &lhs, const SocialEvent &rhs) {
+                           return feedPositionBefore(lhs, feedPositionOf(rhs));
+                         }) -
+        events_.begin());
+  }
+
+  FeedPage page;
+  first = std::min(first, events_.size());
+  size_t last = std::min(events_.size(), first + limit);
+  page.items.assign(events_.begin() + static_cast<std::ptrdiff_t>(first),
+                    events_.begin() + static_cast<std::ptrdiff_t>(last));
+  rowsScanned_ += last - first;
+  if (last < events_.size() && !page.items.empty()) {
+    page.nextCursor = paging_ == FeedPaging::Offset ? std::to_string(last)
+                                                    : encodeFeedCursor(feed_, feedPositionOf(page.items.back()));
+  }
+  return page;
+}
+
+void SimulatedFeedServer::fetchPage(const std::string &cursor, size_t limit,
+                                    std::function<void(bool ok, FeedPage page)> done) {
+  bool fail = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fail = failNext_ > 0;
+    failNext_ -= fail ? 1 : 0;
+  }
+  auto answer = [this, cursor, limit, fail, done = std::move(done)]() {
+    std::optional<FeedPage> result = fail ? std::nullopt : page(cursor, limit);
+    done(result.has_value(), result ? std::move(*result) : FeedPage{});
+  };
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (latency_.count() == 0 && !held_) {
+    lock.unlock();
+    answer();
+    return;
+  }
+  threads_.emplace_back([this, latency = latency_, answer = std::move(answer)]() {
+    std::this_thread::sleep_for(latency);
+    {
+      std::unique_lock<std::mutex> held(mutex_);
+      released_.wait(held, [this] { return !held_; });
+    }
+    answer();
+  });
+}
+
+void SimulatedFeedServer::hold() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  held_ = true;
+}
+
+void SimulatedFeedServer::release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  held_ = false;
+  released_.notify_all();
+}
+
+void SimulatedFeedServer::waitIdle() {
+  // Deliveries may request follow-up pages, so keep joining until none are left
+  for (;;) {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      threads.swap(threads_);
+    }
+    if (threads.empty()) {
+      return;
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+}
+
+void SimulatedFeedServer::failNext(size_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  failNext_ = count;
+}
+
+size_t SimulatedFeedServer::requestCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return requests_;
+}
+
+uint64_t SimulatedFeedServer::rowsScanned() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return rowsScanned_;
+}
+
+void SimulatedFeedServer::resetCounters() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  requests_ = 0;
+  rowsScanned_ = 0;
+}
+
+std::vector<SocialEvent> makeSyntheticFeedEvents(size_t count, double newestAt) {
+  std::vector<SocialEvent> events;
+  events.reserve(count);
+  double createdAt = newestAt;
+  for (size_t i = 0; i < count; ++i) {
+    if (i % 10 != 9) {
+      createdAt -= 60;
+    }
+    SocialEvent event;
+    event.eventId = "event-" + std::to_string(i);
+    event.organizationId = "org-1";
+    event.userId = "user-" + std::to_string(i % 97);
+    event.eventType = i % 3 == 0 ? "meetup" : "post";
+    event.title = "Event " + std::to_string(i);
+    event.description = "Synthetic feed event number " + std::to_string(i);
+    event.createdAt = createdAt;
+    event.updatedAt = createdAt;
+    event.isPublic = true;
+    event.createdBy = EventCreator{"User " + std::to_string(i % 97), ""};
+    events.push_back(std::move(event));
+  }
+  std::sort(events.begin(), events.end(), eventBefore);
+  return events;
+}
+
+} // namespace testing
+} // namespace contactsmanager
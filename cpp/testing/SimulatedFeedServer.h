@@ -0,0 +1,104 @@
+//
+//  SimulatedFeedServer.h
+//  ContactsManagerCore
+//
+//  Host stand-in for one paginated feed endpoint. Events are kept newest
+//  first; pages are served either by opaque cursor (a keyset seek past the
+//  position the cursor names) or by offset (the cursor is the decimal
+//  number of items to skip), the way the endpoints paged before cursors.
+//  rowsScanned models the database work: an offset page reads every skipped
+//  row, a cursor page only the rows it returns.
+//
+
+#pragma once
+
+#include "FeedEngine.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+enum class FeedPaging { Cursor, Offset };
+
+class SimulatedFeedServer : public FeedSource {
+public:
+  /**
+   * Pages are answered on the calling thread when latency is zero, otherwise on a thread of their own
+   */
+  explicit SimulatedFeedServer(std::string feed, FeedPaging paging = FeedPaging::Cursor,
+                               std::chrono::microseconds latency = std::chrono::microseconds(0));
+  ~SimulatedFeedServer() override;
+
+  SimulatedFeedServer(const SimulatedFeedServer &) = delete;
+  SimulatedFeedServer &operator=(const SimulatedFeedServer &) = delete;
+
+  /**
+   * Adds an event at its place in the feed; a new event goes to the top
+   */
+  void publish(SocialEvent event);
+  bool remove(const std::string &eventId);
+  size_t eventCount() const;
+
+  /**
+   * The page after cursor, or nullopt for a cursor the feed rejects
+   */
+  std::optional<FeedPage> page(const std::string &cursor, size_t limit);
+
+  void fetchPage(const std::string &cursor, size_t limit,
+                 std::function<void(bool ok, FeedPage page)> done) override;
+
+  /**
+   * Blocks until every page requested so far has been delivered
+   */
+  void waitIdle();
+
+  /**
+   * The next count requests fail
+   */
+  void failNext(size_t count);
+
+  /**
+   * While held, pages are answered on their own thread and wait after their
+   * latency until release, so tests can observe a fetch in flight
+   */
+  void hold();
+  void release();
+
+  size_t requestCount() const;
+  uint64_t rowsScanned() const;
+  void resetCounters();
+
+private:
+  std::string feed_;
+  FeedPaging paging_;
+  std::chrono::microseconds latency_;
+
+  mutable std::mutex mutex_;
+  // Newest first; a deque so publishing at the top does not move the rest
+  std::deque<SocialEvent> events_;
+  std::vector<std::thread> threads_;
+  bool held_ = false;
+  std::condition_variable released_;
+  size_t failNext_ = 0;
+  size_t requests_ = 0;
+  uint64_t rowsScanned_ = 0;
+};
+
+/**
+ * count events "event-<n>", one a minute going back from newestAt, with
+ * every tenth sharing its neighbour's timestamp to exercise the tie-break
+ */
+std::vector<SocialEvent> makeSyntheticFeedEvents(size_t count, double newestAt = 1.7e9);
+
+} // namespace testing
+} // namespace contactsmanager
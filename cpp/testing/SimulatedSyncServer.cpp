@@ -0,0 +1,184 @@
+//
+//  SimulatedSyncServer.cpp
+//  ContactsManagerCore
+//
+
+#include "SimulatedSyncServer.h"
+
+#include "CborDecoder.h"
+
+#include <algorithm>
+
+namespace contactsmanager {
+namespace testing {
+
+namespace {
+
+const std::string *stringMember(const JsonValue &value, std::string_view key) {
+  const JsonValue *member = value.find(key);
+  return member && member->type == JsonValue::Type::String ? &member->string : nullptr;
+}
+
+} // namespace
+
+SimulatedSyncServer::SyncResult SimulatedSyncServer::handleBulkCreate(std::string_view body,
+                                                                      std::string_view idempotencyKey) {
+  return handleBulkCreate(body, WireEncoding{}, idempotencyKey);
+}
+
+SimulatedSyncServer::SyncResult SimulatedSyncServer::handleBulkCreate(std::string_view body, WireEncoding encoding,
+                                                                      std::string_view idempotencyKey) {
+  SyncResult result;
+  requestCount_++;
+  bytesReceived_ += body.size();
+  if (!idempotencyKey.empty()) {
+    auto replay = idempotentResults_.find(std::string(idempotencyKey));
+    if (replay != idempotentResults_.end()) {
+      replayedRequests_++;
+      return replay->second;
+    }
+  }
+  std::optional<JsonValue> document = decodeRequestBody(body, encoding);
+  const JsonValue *contacts = document ? document->find("contacts") : nullptr;
+  if (!contacts || contacts->type != JsonValue::Type::Array) {
+    return result;
+  }
+  for (const auto &contact : contacts->array) {
+    if (upsert(contact)) {
+      result.upserted++;
+    }
+  }
+  result.ok = true;
+  contactsApplied_ += result.upserted;
+  if (!idempotencyKey.empty()) {
+    idempotentResults_.emplace(std::string(idempotencyKey), result);
+  }
+  return result;
+}
+
+SimulatedSyncServer::SyncResult SimulatedSyncServer::handleDeltaSync(std::string_view body) {
+  SyncResult result;
+  requestCount_++;
+  bytesReceived_ += body.size();
+  std::optional<JsonValue> document = JsonValue::parse(body);
+  const JsonValue *contacts = document ? document->find("contacts") : nullptr;
+  const JsonValue *patches = document ? document->find("patches") : nullptr;
+  if (!contacts || contacts->type != JsonValue::Type::Array || !patches ||
+      patches->type != JsonValue::Type::Array) {
+    return result;
+  }
+  for (const auto &contact : contacts->array) {
+    if (upsert(contact)) {
+      result.upserted++;
+    }
+  }
+  for (const auto &patch : patches->array) {
+    bool rejected = false;
+    if (applyPatch(patch, rejected)) {
+      result.patched++;
+    } else if (rejected) {
+      result.rejected.push_back(*stringMember(patch, "sourceContactId"));
+    }
+  }
+  result.ok = true;
+  return result;
+}
+
+bool SimulatedSyncServer::upsert(JsonValue contact) {
+  const std::string *identifier = stringMember(contact, "sourceContactId");
+  if (!identifier || contact.type != JsonValue::Type::Object) {
+    return false;
+  }
+  std::string key = *identifier;
+  Record record;
+  if (const std::string *version = stringMember(contact, "version")) {
+    record.version = *version;
+  }
+  contact.erase("version");
+  record.contact = std::move(contact);
+  contacts_[key] = std::move(record);
+  return true;
+}
+
+bool SimulatedSyncServer::applyPatch(const JsonValue &patch, bool &rejected) {
+  const std::string *identifier = stringMember(patch, "sourceContactId");
+  const std::string *baseVersion = stringMember(patch, "baseVersion");
+  const std::string *version = stringMember(patch, "version");
+  if (!identifier || !baseVersion || !version) {
+    return false;
+  }
+  auto it = contacts_.find(*identifier);
+  if (it == contacts_.end() || it->second.version != *baseVersion) {
+    rejected = true;
+    return false;
+  }
+
+  // Apply to a copy so a malformed patch leaves the stored contact untouched
+  JsonValue contact = it->second.contact;
+  if (const JsonValue *set = patch.find("set")) {
+    for (const auto &field : set->object) {
+      if (field.second.isNull()) {
+        contact.erase(field.first);
+      } else {
+        contact.set(field.first, field.second);
+      }
+    }
+  }
+  if (const JsonValue *collections = patch.find("collections")) {
+    for (const auto &entry : collections->object) {
+      JsonValue *items = contact.find(entry.first);
+      if (!items || items->type != JsonValue::Type::Array) {
+        return false;
+      }
+      if (const JsonValue *replacement = entry.second.find("items")) {
+        *items = *replacement;
+        continue;
+      }
+      const JsonValue *removed = entry.second.find("remove");
+      const JsonValue *added = entry.second.find("add");
+      if (!removed || !added) {
+        return false;
+      }
+      std::vector<size_t> indices;
+      for (const auto &index : removed->array) {
+        if (index.type != JsonValue::Type::Number || index.number < 0 ||
+            static_cast<size_t>(index.number) >= items->array.size()) {
+          return false;
+        }
+        indices.push_back(static_cast<size_t>(index.number));
+      }
+      std::sort(indices.rbegin(), indices.rend());
+      for (size_t index : indices) {
+        items->array.erase(items->array.begin() + static_cast<std::ptrdiff_t>(index));
+      }
+      items->array.insert(items->array.end(), added->array.begin(), added->array.end());
+    }
+  }
+  it->second.contact = std::move(contact);
+  it->second.version = *version;
+  return true;
+}
+
+const JsonValue *SimulatedSyncServer::contact(std::string_view sourceContactId) const {
+  auto it = contacts_.find(std::string(sourceContactId));
+  return it == contacts_.end() ? nullptr : &it->second.contact;
+}
+
+std::string SimulatedSyncServer::version(std::string_view sourceContactId) const {
+  auto it = contacts_.find(std::string(sourceContactId));
+  return it == contacts_.end() ? std::string() : it->second.version;
+}
+
+void SimulatedSyncServer::forget(std::string_view sourceContactId) {
+  contacts_.erase(std::string(sourceContactId));
+}
+
+void SimulatedSyncServer::resetCounters() {
+  bytesReceived_ = 0;
+  requestCount_ = 0;
+  contactsApplied_ = 0;
+  replayedRequests_ = 0;
+}
+
+} // namespace testing
+} // namespace contactsmanager
@@ -0,0 +1,90 @@
+//
+//  SimulatedSyncServer.h
+//  ContactsManagerCore
+//
+//  Host stand-in for the contacts sync endpoint. It parses the request bodies
+//  the core writes (bulk create in any WireEncoding, and delta sync), keeps each contact in its
+//  CMServerContact JSON form with the version the client sent, and applies
+//  patches the way the server does: only on top of the named base version,
+//  with items stored exactly as sent. A request carrying an
+//  idempotency key the server has already seen gets the first result back
+//  without being applied again. Counts requests and body bytes so benchmarks
+//  can compare upload volume.
+//
+
+#pragma once
+
+#include "JsonValue.h"
+#include "SyncWireFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+class SimulatedSyncServer {
+public:
+  struct SyncResult {
+    // False when the body could not be parsed; nothing was applied
+    bool ok = false;
+    size_t upserted = 0;
+    size_t patched = 0;
+    // Patches whose base version the server does not hold; the client must upsert these
+    std::vector<std::string> rejected;
+  };
+
+  SyncResult handleBulkCreate(std::string_view body, std::string_view idempotencyKey = {});
+
+  /**
+   * Bulk create sent with a negotiated Content-Type and Content-Encoding
+   */
+  SyncResult handleBulkCreate(std::string_view body, WireEncoding encoding, std::string_view idempotencyKey = {});
+  SyncResult handleDeltaSync(std::string_view body);
+
+  /**
+   * Stored CMServerContact, without its version; nullptr when unknown
+   */
+  const JsonValue *contact(std::string_view sourceContactId) const;
+
+  /**
+   * Version the client last sent for the contact, empty if none
+   */
+  std::string version(std::string_view sourceContactId) const;
+
+  /**
+   * Drops the server's copy, as a server-side reset would
+   */
+  void forget(std::string_view sourceContactId);
+
+  size_t size() const { return contacts_.size(); }
+  uint64_t bytesReceived() const { return bytesReceived_; }
+  size_t requestCount() const { return requestCount_; }
+  // Contacts upserted by requests that were applied, not replayed
+  size_t contactsApplied() const { return contactsApplied_; }
+  size_t replayedRequests() const { return replayedRequests_; }
+  void resetCounters();
+
+private:
+  struct Record {
+    JsonValue contact;
+    std::string version;
+  };
+
+  bool upsert(JsonValue contact);
+  bool applyPatch(const JsonValue &patch, bool &rejected);
+
+  std::unordered_map<std::string, Record> contacts_;
+  std::unordered_map<std::string, SyncResult> idempotentResults_;
+  uint64_t bytesReceived_ = 0;
+  size_t requestCount_ = 0;
+  size_t contactsApplied_ = 0;
+  size_t replayedRequests_ = 0;
+};
+
+} // namespace testing
+} // namespace contactsmanager
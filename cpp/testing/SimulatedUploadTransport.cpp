@@ -0,0 +1,100 @@
+//
+//  SimulatedUploadTransport.cpp
+//  ContactsManagerCore
+//
+
+#include "SimulatedUploadTransport.h"
+
+#include <algorithm>
+
+namespace contactsmanager {
+namespace testing {
+
+SimulatedUploadTransport::SimulatedUploadTransport(Link link, Handler handler)
+    : link_(link), handler_(std::move(handler)) {}
+
+SimulatedUploadTransport::~SimulatedUploadTransport() {
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads.swap(threads_);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void SimulatedUploadTransport::failNext(size_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  failNext_ = count;
+}
+
+void SimulatedUploadTransport::stallNext(size_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stallNext_ = count;
+}
+
+void SimulatedUploadTransport::loseResponseNext(size_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  loseResponseNext_ = count;
+}
+
+size_t SimulatedUploadTransport::requestCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return requests_;
+}
+
+size_t SimulatedUploadTransport::maxConcurrent() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return maxConcurrent_;
+}
+
+void SimulatedUploadTransport::send(UploadRequest request, std::chrono::milliseconds timeout,
+                                    std::function<void(UploadResponse response)> done) {
+  std::chrono::microseconds latency = link_.roundTrip;
+  if (link_.bytesPerSecond > 0) {
+    latency += std::chrono::microseconds(static_cast<int64_t>(1e6 * static_cast<double>(request.body.size()) /
+                                                              link_.bytesPerSecond));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  requests_++;
+  maxConcurrent_ = std::max(maxConcurrent_, ++concurrent_);
+  bool stall = stallNext_ > 0;
+  bool fail = !stall && failNext_ > 0;
+  bool loseResponse = !stall && !fail && loseResponseNext_ > 0;
+  stallNext_ -= stall ? 1 : 0;
+  failNext_ -= fail ? 1 : 0;
+  loseResponseNext_ -= loseResponse ? 1 : 0;
+  if (stall || latency > timeout) {
+    latency = timeout;
+    stall = true;
+  }
+
+  threads_.emplace_back([this, request = std::move(request), done = std::move(done), latency, stall, fail,
+                         loseResponse]() {
+    std::this_thread::sleep_for(latency);
+    UploadResponse response;
+    if (stall) {
+      response.status = UploadStatus::TimedOut;
+    } else if (fail) {
+      response.status = UploadStatus::Failed;
+    } else {
+      std::lock_guard<std::mutex> handlerLock(handlerMutex_);
+      if (!handler_(request, response.body)) {
+        response.status = UploadStatus::Failed;
+      }
+      if (loseResponse) {
+        response = UploadResponse{UploadStatus::TimedOut, {}};
+      }
+    }
+    {
+      std::lock_guard<std::mutex> countLock(mutex_);
+      concurrent_--;
+    }
+    done(std::move(response));
+  });
+}
+
+} // namespace testing
+} // namespace contactsmanager
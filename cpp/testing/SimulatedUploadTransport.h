@@ -0,0 +1,84 @@
+//
+//  SimulatedUploadTransport.h
+//  ContactsManagerCore
+//
+//  Host stand-in for the network between the upload pipeline and the sync
+//  server. Each request completes on its own thread after a modelled latency
+//  (round trip plus body bytes over the link bandwidth); the handler, usually
+//  a SimulatedSyncServer, runs under one lock the way a single server shard
+//  would. Requests can be made to fail or to stall past their timeout.
+//
+
+#pragma once
+
+#include "ContactUploadPipeline.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+class SimulatedUploadTransport : public UploadTransport {
+public:
+  /**
+   * Handles one request and fills in the response body; false fails the request
+   */
+  using Handler = std::function<bool(const UploadRequest &request, std::string &response)>;
+
+  struct Link {
+    std::chrono::microseconds roundTrip{0};
+    // 0 for unlimited
+    double bytesPerSecond = 0;
+  };
+
+  SimulatedUploadTransport(Link link, Handler handler);
+  ~SimulatedUploadTransport() override;
+
+  SimulatedUploadTransport(const SimulatedUploadTransport &) = delete;
+  SimulatedUploadTransport &operator=(const SimulatedUploadTransport &) = delete;
+
+  void send(UploadRequest request, std::chrono::milliseconds timeout,
+            std::function<void(UploadResponse response)> done) override;
+
+  /**
+   * The next count requests fail after their round trip without reaching the handler
+   */
+  void failNext(size_t count);
+
+  /**
+   * The next count requests never answer and time out
+   */
+  void stallNext(size_t count);
+
+  /**
+   * The next count requests reach the handler, but their response is lost and they time out
+   */
+  void loseResponseNext(size_t count);
+
+  size_t requestCount() const;
+  size_t maxConcurrent() const;
+
+private:
+  Link link_;
+  Handler handler_;
+
+  mutable std::mutex mutex_;
+  // Serializes the handler separately so latency overlaps across requests
+  std::mutex handlerMutex_;
+  std::vector<std::thread> threads_;
+  size_t failNext_ = 0;
+  size_t stallNext_ = 0;
+  size_t loseResponseNext_ = 0;
+  size_t requests_ = 0;
+  size_t concurrent_ = 0;
+  size_t maxConcurrent_ = 0;
+};
+
+} // namespace testing
+} // namespace contactsmanager
@@ -0,0 +1,261 @@
+//
+//  SyntheticAddressBook.cpp
+//  ContactsManagerCore
+//
+
+#include "SyntheticAddressBook.h"
+
+#include <cstdio>
+
+namespace contactsmanager {
+namespace testing {
+
+namespace {
+
+const char *const kGivenNames[] = {
+    "James",  "Mary",    "John",    "Patricia", "Robert", "Jennifer", "Michael", "Linda",
+    "David",  "Barbara", "William", "Susan",    "Joseph", "Jessica",  "Thomas",  "Sarah",
+    "Carlos", "Karen",   "Daniel",  "Nancy",    "Matt",   "Lisa",     "Anthony", "Betty",
+    "Mark",   "Sandra",  "Steven",  "Ashley",   "Paul",   "Kimberly", "Andrew",  "Emily",
+    "Joshua", "Donna",   "Kenneth", "Michelle", "Kevin",  "Carol",    "Brian",   "Amanda",
+    "Arjun",  "Priya",   "Wei",     "Mei",      "Yuki",   "Hiro",     "Omar",    "Fatima",
+};
+
+const char *const kFamilyNames[] = {
+    "Smith",  "Johnson",  "Williams", "Brown",  "Jones",    "Garcia",   "Miller",   "Davis",
+    "Lopez",  "Martinez", "Hernandez", "Gonzalez", "Wilson", "Anderson", "Thomas",  "Taylor",
+    "Moore",  "Jackson",  "Martin",   "Lee",    "Perez",    "Thompson", "White",    "Harris",
+    "Clark",  "Lewis",    "Robinson", "Walker", "Young",    "Allen",    "King",     "Wright",
+    "Scott",  "Torres",   "Nguyen",   "Hill",   "Flores",   "Green",    "Adams",    "Nelson",
+    "Sharma", "Patel",    "Chen",     "Wang",   "Tanaka",   "Sato",     "Khan",     "Ali",
+};
+
+const char *const kOrganizations[] = {
+    "Acme Corp", "Globex", "Initech", "Umbrella", "Hooli", "Stark Industries",
+    "Wayne Enterprises", "Cyberdyne", "Soylent", "Vandelay Industries",
+};
+
+const char *const kJobTitles[] = {
+    "Engineer", "Designer", "Manager", "Director", "Analyst", "Consultant", "Founder", "Nurse",
+};
+
+const char *const kDomains[] = {
+    "gmail.com", "yahoo.com", "outlook.com", "icloud.com", "example.com", "company.io",
+};
+
+const char *const kCities[] = {
+    "San Francisco", "New York", "Austin", "Seattle", "Chicago", "Boston", "Denver", "Miami",
+};
+
+const char *const kPhoneLabels[] = {"mobile", "home", "work", "iPhone"};
+
+template <size_t N>
+const char *pick(const char *const (&pool)[N], SplitMix64 &random) {
+  return pool[random.nextBelow(N)];
+}
+
+std::string formatPhone(SplitMix64 &random) {
+  unsigned area = 200 + static_cast<unsigned>(random.nextBelow(800));
+  unsigned exchange = 200 + static_cast<unsigned>(random.nextBelow(800));
+  unsigned line = static_cast<unsigned>(random.nextBelow(10000));
+  char buffer[32];
+  switch (random.nextBelow(4)) {
+  case 0:
+    std::snprintf(buffer, sizeof(buffer), "+1 (%03u) %03u-%04u", area, exchange, line);
+    break;
+  case 1:
+    std::snprintf(buffer, sizeof(buffer), "%03u-%03u-%04u", area, exchange, line);
+    break;
+  case 2:
+    std::snprintf(buffer, sizeof(buffer), "%03u%03u%04u", area, exchange, line);
+    break;
+  default:
+    std::snprintf(buffer, sizeof(buffer), "+1 %03u %03u %04u", area, exchange, line);
+    break;
+  }
+  return buffer;
+}
+
+std::string emailLocalPart(const std::string &given, const std::string &family, size_t index) {
+  std::string local;
+  for (char c : given) {
+    local.push_back(static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c));
+  }
+  local.push_back('.');
+  for (char c : family) {
+    local.push_back(static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c));
+  }
+  local.append(std::to_string(index % 1000));
+  return local;
+}
+
+std::vector<uint8_t> makeImageBytes(size_t size, SplitMix64 &random) {
+  std::vector<uint8_t> bytes(size);
+  for (size_t i = 0; i < size; i += 8) {
+    uint64_t word = random.next();
+    for (size_t j = 0; j < 8 && i + j < size; ++j) {
+      bytes[i + j] = static_cast<uint8_t>(word >> (j * 8));
+    }
+  }
+  return bytes;
+}
+
+// Same digits, another common way of writing them
+std::string reformatPhone(const std::string &value, SplitMix64 &random) {
+  std::string digits;
+  for (char c : value) {
+    if (c >= '0' && c <= '9') {
+      digits.push_back(c);
+    }
+  }
+  if (digits.size() == 11) {
+    digits.erase(0, 1);
+  }
+  return random.nextBelow(2) == 0 ? "+1" + digits : "(" + digits.substr(0, 3) + ") " + digits.substr(3);
+}
+
+void swapAdjacentLetters(std::string &name, SplitMix64 &random) {
+  if (name.size() >= 4) {
+    size_t at = 1 + random.nextBelow(name.size() - 2);
+    std::swap(name[at], name[at + 1]);
+  }
+}
+
+} // namespace
+
+Contact makeSyntheticContact(size_t index, SplitMix64 &random, const SyntheticBookOptions &options) {
+  Contact contact("contact-" + std::to_string(index));
+  contact.givenName = pick(kGivenNames, random);
+  contact.familyName = pick(kFamilyNames, random);
+  if (random.nextBelow(4) == 0) {
+    contact.middleName = pick(kGivenNames, random);
+  }
+  if (random.nextBelow(3) == 0) {
+    contact.organizationName = pick(kOrganizations, random);
+    contact.jobTitle = pick(kJobTitles, random);
+  }
+
+  size_t phoneCount = 1 + random.nextBelow(3);
+  for (size_t i = 0; i < phoneCount; ++i) {
+    contact.phoneNumbers.push_back({contact.identifier, formatPhone(random), pick(kPhoneLabels, random), ""});
+  }
+  size_t emailCount = random.nextBelow(3);
+  for (size_t i = 0; i < emailCount; ++i) {
+    contact.emailAddresses.push_back(
+        {contact.identifier,
+         emailLocalPart(contact.givenName, contact.familyName, index + i) + "@" + pick(kDomains, random),
+         i == 0 ? "home" : "work", ""});
+  }
+  if (random.nextBelow(4) == 0) {
+    PostalAddress address;
+    address.contactId = contact.identifier;
+    address.street = std::to_string(1 + random.nextBelow(9999)) + " Main St";
+    address.city = pick(kCities, random);
+    address.state = "CA";
+    address.postalCode = std::to_string(10000 + random.nextBelow(89999));
+    address.country = "US";
+    address.type = "home";
+    contact.addresses.push_back(std::move(address));
+  }
+  if (random.nextBelow(8) == 0) {
+    contact.notes = "Met at " + std::string(pick(kCities, random)) + " conference";
+  }
+  if (random.nextBelow(5) == 0) {
+    contact.birthday = static_cast<double>(random.nextBelow(1000000000));
+  }
+  if (options.imageRate > 0 && random.nextUnit() < options.imageRate) {
+    contact.imageData = makeImageBytes(options.imageBytes, random);
+    contact.thumbnailImageData = makeImageBytes(options.thumbnailBytes, random);
+    contact.imageDataAvailable = true;
+  }
+  contact.createdAt = 1700000000.0 + static_cast<double>(index);
+  contact.updateDisplayInfo();
+  return contact;
+}
+
+Contact makeNamedContact(const std::string &identifier, const std::string &given, const std::string &family) {
+  Contact contact(identifier);
+  contact.givenName = given;
+  contact.familyName = family;
+  contact.updateDisplayInfo();
+  return contact;
+}
+
+std::vector<Contact> makeSyntheticAddressBook(size_t count, const SyntheticBookOptions &options) {
+  SplitMix64 random(options.seed);
+  std::vector<Contact> contacts;
+  contacts.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    contacts.push_back(makeSyntheticContact(i, random, options));
+  }
+  return contacts;
+}
+
+std::vector<std::pair<size_t, size_t>> appendSyntheticDuplicates(std::vector<Contact> &book, double rate,
+                                                                 uint64_t seed) {
+  SplitMix64 random(seed);
+  size_t originals = book.size();
+  std::vector<std::pair<size_t, size_t>> pairs;
+  for (size_t i = 0; i < originals; ++i) {
+    if (random.nextUnit() >= rate) {
+      continue;
+    }
+    Contact copy = book[i];
+    copy.identifier = "contact-" + std::to_string(book.size());
+    copy.createdAt = 1700000000.0 + static_cast<double>(book.size());
+    switch (random.nextBelow(4)) {
+    case 0:
+      swapAdjacentLetters(copy.familyName, random);
+      break;
+    case 1:
+      swapAdjacentLetters(copy.givenName, random);
+      break;
+    case 2:
+      copy.middleName.clear();
+      break;
+    default:
+      break;
+    }
+
+    bool keepPhone = copy.emailAddresses.empty() || random.nextBelow(4) != 0;
+    if (keepPhone) {
+      copy.phoneNumbers.resize(1 + random.nextBelow(copy.phoneNumbers.size()));
+      for (auto &phone : copy.phoneNumbers) {
+        phone.value = reformatPhone(phone.value, random);
+      }
+    } else {
+      copy.phoneNumbers.clear();
+    }
+    if (!copy.emailAddresses.empty() && (!keepPhone || random.nextBelow(2) == 0)) {
+      copy.emailAddresses.resize(1);
+      for (char &c : copy.emailAddresses[0].value) {
+        if (c >= 'a' && c <= 'z' && random.nextBelow(3) == 0) {
+          c = static_cast<char>(c - 'a' + 'A');
+        }
+      }
+    } else {
+      copy.emailAddresses.clear();
+    }
+    if (random.nextBelow(2) == 0) {
+      copy.addresses.clear();
+      copy.notes.clear();
+      copy.birthday.reset();
+    }
+    for (auto &item : copy.phoneNumbers) {
+      item.contactId = copy.identifier;
+    }
+    for (auto &item : copy.emailAddresses) {
+      item.contactId = copy.identifier;
+    }
+    for (auto &item : copy.addresses) {
+      item.contactId = copy.identifier;
+    }
+    copy.updateDisplayInfo();
+    pairs.emplace_back(i, book.size());
+    book.push_back(std::move(copy));
+  }
+  return pairs;
+}
+
+} // namespace testing
+} // namespace contactsmanager
@@ -0,0 +1,86 @@
+//
+//  SyntheticAddressBook.h
+//  ContactsManagerCore
+//
+//  Deterministic synthetic address books for tests and benchmarks.
+//
+
+#pragma once
+
+#include "Contact.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+/**
+ * SplitMix64 generator; fast, seedable and identical on every platform
+ */
+class SplitMix64 {
+public:
+  explicit SplitMix64(uint64_t seed) : state_(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  /**
+   * Uniform value in [0, bound)
+   */
+  uint64_t nextBelow(uint64_t bound) { return bound == 0 ? 0 : next() % bound; }
+
+  /**
+   * Uniform value in [0, 1)
+   */
+  double nextUnit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+  uint64_t state_;
+};
+
+/**
+ * Shape of a generated address book
+ */
+struct SyntheticBookOptions {
+  uint64_t seed = 42;
+  // Fraction of contacts that carry a full-size photo and thumbnail
+  double imageRate = 0.0;
+  size_t imageBytes = 0;
+  size_t thumbnailBytes = 0;
+};
+
+/**
+ * Generates a single contact; identifiers are "contact-<index>"
+ */
+Contact makeSyntheticContact(size_t index, SplitMix64 &random, const SyntheticBookOptions &options = {});
+
+/**
+ * Contact with just a given and family name, display info filled in
+ */
+Contact makeNamedContact(const std::string &identifier, const std::string &given, const std::string &family);
+
+/**
+ * Generates an address book of the given size
+ */
+std::vector<Contact> makeSyntheticAddressBook(size_t count, const SyntheticBookOptions &options = {});
+
+/**
+ * Appends a second entry for a random fraction of the book, changed the way a
+ * person ends up in an address book twice: numbers reformatted, email case
+ * changed, a name typo or a dropped middle name, some details missing. Every
+ * copy keeps at least one phone number or email address. Returns (original,
+ * copy) index pairs.
+ */
+std::vector<std::pair<size_t, size_t>> appendSyntheticDuplicates(std::vector<Contact> &book, double rate,
+                                                                 uint64_t seed = 7);
+
+} // namespace testing
+} // namespace contactsmanager
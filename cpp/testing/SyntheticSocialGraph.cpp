@@ -0,0 +1,108 @@
+//
+//  SyntheticSocialGraph.cpp
+//  ContactsManagerCore
+//
+
+#include "SyntheticSocialGraph.h"
+
+#include "PhoneNumberKey.h"
+#include "SyntheticAddressBook.h"
+
+namespace contactsmanager {
+namespace testing {
+
+namespace {
+
+const char *const kStrangerDomains[] = {"gmail.com", "company.io", "example.com", "startup.dev"};
+
+// A user of the app; linked to a book contact when one is given
+CanonicalContact makeUser(size_t number, const Contact *contact, SplitMix64 &random) {
+  CanonicalContact user;
+  user.identifier = "user-" + std::to_string(number);
+  user.organizationId = "org-synthetic";
+  user.organizationUserId = "org-user-" + std::to_string(number);
+  user.isActive = true;
+  user.createdAt = 1700000000.0 + static_cast<double>(number);
+  user.updatedAt = user.createdAt;
+  if (contact != nullptr) {
+    user.fullName = contact->givenName + " " + contact->familyName;
+    // Either detail is enough to find the contact; some users signed up with the other one
+    bool useEmail = !contact->emailAddresses.empty() && (contact->phoneNumbers.empty() || random.nextBelow(2) == 0);
+    if (useEmail) {
+      user.email = contact->emailAddresses[0].value;
+    } else if (!contact->phoneNumbers.empty()) {
+      user.phone = "+" + std::to_string(phoneKeyFor(contact->phoneNumbers[0].value, 1).digits());
+    }
+  } else {
+    user.fullName = "Stranger " + std::to_string(number);
+    user.email = "stranger" + std::to_string(number) + "@" +
+                 kStrangerDomains[random.nextBelow(sizeof(kStrangerDomains) / sizeof(kStrangerDomains[0]))];
+  }
+  return user;
+}
+
+// An edge between the user ("user-self") and other, in the direction userFollows gives
+FollowRelationship makeFollow(const CanonicalContact &other, size_t number, bool userFollows) {
+  FollowRelationship relationship;
+  relationship.identifier = "follow-" + std::to_string(number);
+  relationship.followerId = userFollows ? "user-self" : other.identifier;
+  relationship.followedId = userFollows ? other.identifier : "user-self";
+  relationship.userId = other.identifier;
+  relationship.displayName = other.fullName;
+  relationship.createdAt = other.createdAt;
+  relationship.isFollowing = userFollows;
+  if (userFollows) {
+    relationship.followed = other;
+  } else {
+    relationship.follower = other;
+  }
+  return relationship;
+}
+
+} // namespace
+
+SyntheticSocialGraph makeSyntheticSocialGraph(const std::vector<Contact> &book, size_t followCount,
+                                              size_t candidateCount, uint64_t seed) {
+  SplitMix64 random(seed);
+  SyntheticSocialGraph graph;
+  size_t nextUser = 0;
+  auto bookContact = [&]() -> const Contact * {
+    return book.empty() || random.nextBelow(2) == 0 ? nullptr : &book[random.nextBelow(book.size())];
+  };
+
+  std::vector<CanonicalContact> followed;
+  for (size_t i = 0; i < followCount; ++i) {
+    followed.push_back(makeUser(nextUser++, bookContact(), random));
+    graph.following.push_back(makeFollow(followed.back(), i, true));
+  }
+  std::vector<CanonicalContact> followers;
+  for (size_t i = 0; i < followCount; ++i) {
+    bool mutual = !followed.empty() && random.nextBelow(2) == 0;
+    followers.push_back(mutual ? followed[random.nextBelow(followed.size())]
+                               : makeUser(nextUser++, bookContact(), random));
+    graph.followers.push_back(makeFollow(followers.back(), followCount + i, false));
+  }
+
+  for (size_t i = 0; i < candidateCount; ++i) {
+    uint64_t kind = random.nextBelow(20);
+    if (kind < 2 && !followers.empty()) {
+      graph.candidates.push_back(followers[random.nextBelow(followers.size())]);
+    } else if (kind < 3 && !followed.empty()) {
+      graph.candidates.push_back(followed[random.nextBelow(followed.size())]);
+    } else if (kind < 11 && !book.empty()) {
+      graph.candidates.push_back(makeUser(nextUser++, &book[random.nextBelow(book.size())], random));
+    } else {
+      graph.candidates.push_back(makeUser(nextUser++, nullptr, random));
+    }
+  }
+
+  for (const auto &contact : book) {
+    if (random.nextBelow(10) == 0) {
+      graph.interactionCounts[contact.identifier] = static_cast<uint32_t>(1 + random.nextBelow(200));
+    }
+  }
+  return graph;
+}
+
+} // namespace testing
+} // namespace contactsmanager
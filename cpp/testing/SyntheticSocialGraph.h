@@ -0,0 +1,41 @@
+//
+//  SyntheticSocialGraph.h
+//  ContactsManagerCore
+//
+//  Deterministic follow lists and recommendation candidates around a
+//  synthetic address book, for tests and benchmarks of the social features.
+//
+
+#pragma once
+
+#include "Contact.h"
+#include "SocialModels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+struct SyntheticSocialGraph {
+  // The user is the follower; about half are in the address book
+  std::vector<FollowRelationship> following;
+  // The user is followed; about half of these are mutual
+  std::vector<FollowRelationship> followers;
+  // Server order: followers, people in the book and strangers mixed, a few already followed
+  std::vector<CanonicalContact> candidates;
+  // Calls and messages for about a tenth of the book
+  std::unordered_map<std::string, uint32_t> interactionCounts;
+};
+
+/**
+ * User IDs are "user-<n>"; canonical phones are E.164 with country code 1
+ */
+SyntheticSocialGraph makeSyntheticSocialGraph(const std::vector<Contact> &book, size_t followCount,
+                                              size_t candidateCount, uint64_t seed = 42);
+
+} // namespace testing
+} // namespace contactsmanager
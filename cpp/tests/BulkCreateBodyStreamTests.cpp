@@ -0,0 +1,104 @@
+//
+//  BulkCreateBodyStreamTests.cpp
+//  ContactsManagerCore
+//
+
+#include "BulkCreateBodyStream.h"
+#include "CborDecoder.h"
+#include "JsonValue.h"
+#include "ServerContactJson.h"
+#include "SimulatedSyncServer.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using testing::JsonValue;
+
+namespace {
+
+const ServerContactContext kContext{"org-1", "source-1"};
+
+std::string readAll(BulkCreateBodyStream &stream, size_t bufferSize) {
+  std::string body;
+  std::vector<char> buffer(bufferSize);
+  while (size_t length = stream.read(buffer.data(), buffer.size())) {
+    body.append(buffer.data(), length);
+  }
+  return body;
+}
+
+} // namespace
+
+CM_TEST(chunksMatchTheWholeBody) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(300);
+  std::string expected = encodeBulkCreateBody(book, kContext, true);
+
+  BulkCreateBodyStream stream(book.data(), book.size(), kContext, true);
+  std::string body;
+  size_t chunks = 0;
+  for (std::string_view chunk = stream.nextChunk(); !chunk.empty(); chunk = stream.nextChunk()) {
+    body.append(chunk);
+    chunks++;
+  }
+  CM_EXPECT(body == expected);
+  CM_EXPECT(stream.atEnd());
+  CM_EXPECT(!stream.failed());
+  CM_EXPECT_EQ(stream.bytesRead(), expected.size());
+  // One chunk per contact, the array opening riding on the first
+  CM_EXPECT_EQ(chunks, book.size() + 1);
+
+  // Buffer sizes that split contacts, and one larger than the body
+  for (size_t bufferSize : {size_t(1), size_t(7), size_t(4096), expected.size() * 2}) {
+    BulkCreateBodyStream reader(book.data(), book.size(), kContext, true);
+    CM_EXPECT(readAll(reader, bufferSize) == expected);
+    CM_EXPECT(reader.atEnd());
+    CM_EXPECT_EQ(reader.read(nullptr, 0), size_t(0));
+  }
+
+  BulkCreateBodyStream empty(nullptr, 0, kContext, false);
+  CM_EXPECT_EQ(readAll(empty, 16), std::string("{\"contacts\":[],\"skipDuplicates\":false}"));
+}
+
+CM_TEST(memoryIsBoundedByOneContact) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(2000);
+  size_t largestContact = 0;
+  for (const auto &contact : book) {
+    largestContact = std::max(largestContact, encodeBulkCreateBody(&contact, 1, kContext, false).size());
+  }
+
+  BulkCreateBodyStream stream(book.data(), book.size(), kContext, false);
+  size_t largestChunk = 0;
+  for (std::string_view chunk = stream.nextChunk(); !chunk.empty(); chunk = stream.nextChunk()) {
+    largestChunk = std::max(largestChunk, chunk.size());
+  }
+  CM_EXPECT(stream.atEnd());
+  CM_EXPECT(largestChunk <= largestContact);
+  CM_EXPECT(stream.bytesRead() > 100 * largestContact);
+}
+
+CM_TEST(compressedStreamsDecodeToTheJsonBody) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(400);
+  std::optional<JsonValue> expected = JsonValue::parse(encodeBulkCreateBody(book, kContext, true));
+  CM_ASSERT(expected.has_value());
+
+  for (WireFormat format : {WireFormat::Json, WireFormat::Cbor}) {
+    for (WireCompression compression : {WireCompression::None, WireCompression::Deflate, WireCompression::Gzip}) {
+      WireEncoding encoding{format, compression};
+      BulkCreateBodyStream stream(book.data(), book.size(), kContext, true, encoding);
+      std::string body = readAll(stream, 1000);
+      CM_EXPECT(stream.atEnd());
+      CM_EXPECT(body == encodeBulkCreateBody(book.data(), book.size(), kContext, true, encoding));
+
+      std::optional<JsonValue> decoded = testing::decodeRequestBody(body, encoding);
+      CM_ASSERT(decoded.has_value());
+      CM_EXPECT(*decoded == *expected);
+
+      testing::SimulatedSyncServer server;
+      CM_EXPECT_EQ(server.handleBulkCreate(body, encoding).upserted, book.size());
+    }
+  }
+}
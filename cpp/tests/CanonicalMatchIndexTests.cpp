@@ -0,0 +1,153 @@
+//
+//  CanonicalMatchIndexTests.cpp
+//  ContactsManagerCore
+//
+
+#include "CanonicalMatchIndex.h"
+#include "TestHarness.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+Contact person(const std::string &identifier, const std::string &phone, const std::string &email = {}) {
+  Contact contact(identifier);
+  contact.givenName = identifier;
+  if (!phone.empty()) {
+    contact.phoneNumbers.push_back({identifier, phone, "mobile", ""});
+  }
+  if (!email.empty()) {
+    contact.emailAddresses.push_back({identifier, email, "home", ""});
+  }
+  return contact;
+}
+
+LocalCanonicalContact canonical(const std::string &identifier, const std::string &source, const std::string &phone,
+                                const std::string &email = {}) {
+  LocalCanonicalContact entry;
+  entry.contactId = "server-" + identifier;
+  entry.sourceContactId = source;
+  entry.canonicalContact.identifier = identifier;
+  entry.canonicalContact.phone = phone;
+  entry.canonicalContact.email = email;
+  entry.canonicalContact.fullName = "User " + identifier;
+  entry.canonicalContact.isActive = true;
+  entry.canonicalContact.createdAt = 1700000000.5;
+  return entry;
+}
+
+} // namespace
+
+CM_TEST(keysIgnoreFormattingAndCase) {
+  CM_EXPECT_EQ(emailMatchKey(" Ada@Example.COM "), emailMatchKey("ada@example.com"));
+  CM_EXPECT(emailMatchKey("ada@example.com") != emailMatchKey("grace@example.com"));
+  CM_EXPECT_EQ(emailMatchKey("  "), uint64_t(0));
+  CM_EXPECT_EQ(phoneMatchKey("(555) 201-0001", 1), phoneMatchKey("+1 555 201 0001", 0));
+  CM_EXPECT_EQ(phoneMatchKey("call me", 1), uint64_t(0));
+}
+
+CM_TEST(contactsAreReindexedIncrementally) {
+  CanonicalMatchIndex index({1, 300});
+  CM_EXPECT(index.upsertContact(person("a", "555-201-0001", "ada@example.com")));
+  CM_EXPECT(index.upsertContact(person("b", "+1 555 201 0001")));
+  CM_EXPECT(!index.upsertContact(person("a", "(555) 201-0001", "ADA@example.com")));
+  CM_EXPECT(index.contactsMatching("", "+15552010001") == (std::vector<std::string>{"a", "b"}));
+  CM_EXPECT(index.contactsMatching("ada@example.com", "") == (std::vector<std::string>{"a"}));
+
+  // A changed email moves the contact; the phone key is untouched
+  CM_EXPECT(index.upsertContact(person("a", "555-201-0001", "countess@example.com")));
+  CM_EXPECT(index.contactsMatching("ada@example.com", "").empty());
+  CM_EXPECT(index.contactsMatching("countess@example.com", "+15552010001") == (std::vector<std::string>{"a", "b"}));
+
+  Contact deleted = person("b", "+1 555 201 0001");
+  deleted.isDeleted = true;
+  CM_EXPECT(index.upsertContact(deleted));
+  CM_EXPECT(!index.removeContact("b"));
+  CM_EXPECT(index.contactsMatching("", "+15552010001") == (std::vector<std::string>{"a"}));
+
+  // A sync drops contacts that are gone and picks up new ones
+  CM_EXPECT_EQ(index.syncWith({person("c", "555-777-0000"), person("d", "", "d@example.com")}), size_t(3));
+  CM_EXPECT_EQ(index.contactCount(), size_t(2));
+  CM_EXPECT(index.contactsMatching("countess@example.com", "555-201-0001").empty());
+}
+
+CM_TEST(canonicalContactsResolveToDeviceContacts) {
+  CanonicalMatchIndex index({1, 300});
+  index.syncWith({person("a", "555-201-0001"), person("b", "", "grace@navy.mil"), person("c", "555-300-0001")});
+
+  // The uploaded source wins while it is on the device
+  CM_EXPECT_EQ(index.resolveLocalContact(canonical("1", "c", "+15552010001")), std::string("c"));
+  // Otherwise the first contact sharing the phone or email
+  CM_EXPECT_EQ(index.resolveLocalContact(canonical("2", "gone", "+15552010001")), std::string("a"));
+  CM_EXPECT_EQ(index.resolveLocalContact(canonical("3", "", "+15559999999", "Grace@Navy.mil")), std::string("b"));
+  CM_EXPECT_EQ(index.resolveLocalContact(canonical("4", "", "+15559999999", "x@example.com")), std::string());
+}
+
+CM_TEST(cachedResponsesAreServedUntilTheirTtl) {
+  CanonicalMatchIndex index({1, 300});
+  index.syncWith({person("a", "555-201-0001"), person("b", "555-201-0002")});
+  CM_EXPECT(!index.contactsUsingApp(10, 1000).hit);
+
+  index.storeContactsUsingApp({canonical("1", "a", "+15552010001"), canonical("2", "", "+15552010002")}, 2, 1000);
+  CachedCanonicalMatches fresh = index.contactsUsingApp(2, 1299);
+  CM_ASSERT(fresh.hit && fresh.matches.size() == 2);
+  CM_EXPECT(!fresh.stale);
+  CM_EXPECT_EQ(fresh.matches[1].localContactId, std::string("b"));
+  CM_EXPECT_EQ(index.contactsUsingApp(1, 1000).matches.size(), size_t(1));
+
+  // Past the TTL (or with the clock turned back) the matches come back stale
+  CM_EXPECT(index.contactsUsingApp(2, 1300).stale);
+  CM_EXPECT(index.contactsUsingApp(2, 999).stale);
+  CM_EXPECT(index.contactsUsingApp(2, 1300).hit);
+
+  // A full page does not cover a larger limit; a short one is the whole list
+  CM_EXPECT(!index.contactsUsingApp(3, 1000).hit);
+  index.storeContactsUsingApp({canonical("1", "a", "+15552010001")}, 50, 1000);
+  CM_EXPECT(index.contactsUsingApp(100, 1000).hit);
+
+  // Resolution follows the device contacts without a refetch
+  index.removeContact("a");
+  CM_EXPECT(index.contactsUsingApp(100, 1000).matches[0].localContactId.empty());
+
+  index.invalidate();
+  CM_EXPECT(!index.contactsUsingApp(1, 1000).hit);
+}
+
+CM_TEST(saveAndLoadRoundTrip) {
+  CanonicalMatchIndex index({1, 300});
+  index.syncWith({person("a", "555-201-0001", "ada@example.com"), person("b", "555-201-0002"), person("c", "")});
+  index.storeContactsUsingApp({canonical("1", "", "+15552010002", "b@example.com")}, 20, 1000);
+  std::string path = testing::temporaryPath("canonical_match", "roundtrip");
+  CM_ASSERT(index.save(path));
+
+  CanonicalMatchIndex loaded({1, 300});
+  CM_ASSERT(loaded.load(path));
+  CM_EXPECT_EQ(loaded.contactCount(), size_t(3));
+  CM_EXPECT(loaded.contactsMatching("ADA@example.com", "") == (std::vector<std::string>{"a"}));
+  CachedCanonicalMatches cached = loaded.contactsUsingApp(20, 1100);
+  CM_ASSERT(cached.hit && cached.matches.size() == 1);
+  CM_EXPECT(!cached.stale);
+  CM_EXPECT_EQ(cached.matches[0].localContactId, std::string("b"));
+  CM_EXPECT_EQ(cached.matches[0].entry.canonicalContact.fullName, std::string("User 1"));
+  CM_EXPECT_EQ(cached.matches[0].entry.canonicalContact.createdAt, 1700000000.5);
+  CM_EXPECT(cached.matches[0].entry.canonicalContact.isActive);
+
+  // Truncated files are rejected and leave the index empty
+  FILE *file = std::fopen(path.c_str(), "rb");
+  CM_ASSERT(file != nullptr);
+  std::string data(4096, '\0');
+  data.resize(std::fread(&data[0], 1, data.size(), file));
+  std::fclose(file);
+  file = std::fopen(path.c_str(), "wb");
+  std::fwrite(data.data(), 1, data.size() - 3, file);
+  std::fclose(file);
+  CM_EXPECT(!loaded.load(path));
+  CM_EXPECT_EQ(loaded.contactCount(), size_t(0));
+  CM_EXPECT(!loaded.contactsUsingApp(20, 1100).hit);
+  CM_EXPECT(!loaded.load(testing::temporaryPath("canonical_match", "missing")));
+  std::remove(path.c_str());
+}
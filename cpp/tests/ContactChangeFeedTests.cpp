@@ -0,0 +1,281 @@
+//
+//  ContactChangeFeedTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactChangeFeed.h"
+#include "SimulatedContactStore.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+ContactScan scanOf(const testing::SimulatedContactStore &store) {
+  return [&store](const std::function<bool(Contact &&)> &emit) { store.enumerate(emit); };
+}
+
+std::vector<std::string> sorted(std::vector<std::string> identifiers) {
+  std::sort(identifiers.begin(), identifiers.end());
+  return identifiers;
+}
+
+// Syncs the store once so later changes come from the history
+void syncAll(ContactChangeTracker &tracker, const testing::SimulatedContactStore &store) {
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeSet changes = tracker.pendingChanges(history, scanOf(store));
+  tracker.commit(changes);
+}
+
+} // namespace
+
+CM_TEST(firstSyncScansEverything) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(100));
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeTracker tracker;
+
+  ContactChangeSet changes = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT(changes.fullScan);
+  CM_EXPECT_EQ(changes.added.size(), size_t(100));
+  CM_EXPECT(changes.updated.empty());
+  CM_EXPECT(changes.deleted.empty());
+  CM_EXPECT_EQ(changes.hashes.size(), size_t(100));
+  CM_EXPECT_EQ(store.recordsRead(), uint64_t(100));
+
+  // Nothing is recorded until the changes are committed
+  CM_EXPECT_EQ(tracker.size(), size_t(0));
+  CM_ASSERT(tracker.commit(changes));
+  CM_EXPECT_EQ(tracker.size(), size_t(100));
+  CM_EXPECT_EQ(tracker.token(), history.currentToken());
+}
+
+CM_TEST(editsDuringTheFirstScanAreReplayed) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(10));
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeTracker tracker;
+
+  // contact-1 is edited after the scan has already hashed it
+  bool edited = false;
+  ContactScan scan = [&](const std::function<bool(Contact &&)> &emit) {
+    store.enumerate([&](Contact &&contact) {
+      if (!edited && contact.identifier == "contact-5") {
+        edited = store.updateContact(testing::makeNamedContact("contact-1", "Grace", "Hopper"));
+      }
+      return emit(std::move(contact));
+    });
+  };
+  ContactChangeSet changes = tracker.pendingChanges(history, scan);
+  CM_ASSERT(edited);
+  CM_EXPECT(changes.fullScan);
+  CM_ASSERT(tracker.commit(changes));
+
+  changes = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT(!changes.fullScan);
+  CM_EXPECT_EQ(changes.updated, std::vector<std::string>{"contact-1"});
+}
+
+CM_TEST(historyReportsOnlyChangedContacts) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(1000));
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeTracker tracker;
+  syncAll(tracker, store);
+
+  store.addContact(testing::makeNamedContact("new-1", "Ada", "Lovelace"));
+  store.updateContact(testing::makeNamedContact("contact-5", "Grace", "Hopper"));
+  store.removeContact("contact-9");
+  store.resetCounters();
+
+  ContactChangeSet changes = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT(!changes.fullScan);
+  CM_EXPECT_EQ(changes.added, std::vector<std::string>{"new-1"});
+  CM_EXPECT_EQ(changes.updated, std::vector<std::string>{"contact-5"});
+  CM_EXPECT_EQ(changes.deleted, std::vector<std::string>{"contact-9"});
+  // The store is not enumerated
+  CM_EXPECT_EQ(store.recordsRead(), uint64_t(0));
+
+  CM_ASSERT(tracker.commit(changes));
+  CM_EXPECT(tracker.isKnown("new-1"));
+  CM_EXPECT(!tracker.isKnown("contact-9"));
+  CM_EXPECT(tracker.pendingChanges(history, scanOf(store)).empty());
+}
+
+CM_TEST(historyEventsAreCoalescedPerContact) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(10));
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeTracker tracker;
+  syncAll(tracker, store);
+
+  // Edited twice: one update
+  store.updateContact(testing::makeNamedContact("contact-1", "A", "One"));
+  store.updateContact(testing::makeNamedContact("contact-1", "B", "One"));
+  // Edited then deleted: one delete
+  store.updateContact(testing::makeNamedContact("contact-2", "C", "Two"));
+  store.removeContact("contact-2");
+  // Added then deleted before the sync: nothing
+  store.addContact(testing::makeNamedContact("temp", "D", "Temp"));
+  store.removeContact("temp");
+  // Deleted then re-added: an update
+  store.removeContact("contact-3");
+  store.addContact(testing::makeNamedContact("contact-3", "E", "Three"));
+  // Added then edited: one add
+  store.addContact(testing::makeNamedContact("new", "F", "New"));
+  store.updateContact(testing::makeNamedContact("new", "G", "New"));
+
+  ContactChangeSet changes = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT(!changes.fullScan);
+  CM_EXPECT_EQ(changes.added, std::vector<std::string>{"new"});
+  CM_EXPECT_EQ(changes.updated, (std::vector<std::string>{"contact-1", "contact-3"}));
+  CM_EXPECT_EQ(changes.deleted, std::vector<std::string>{"contact-2"});
+}
+
+CM_TEST(uncommittedChangesAreReplayed) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(10));
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeTracker tracker;
+  syncAll(tracker, store);
+
+  store.updateContact(testing::makeNamedContact("contact-4", "H", "Four"));
+  ContactChangeSet failed = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT_EQ(failed.updated, std::vector<std::string>{"contact-4"});
+
+  // The upload failed and was never committed; the next sync sees both edits
+  store.updateContact(testing::makeNamedContact("contact-6", "I", "Six"));
+  ContactChangeSet retried = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT_EQ(retried.updated, (std::vector<std::string>{"contact-4", "contact-6"}));
+
+  CM_ASSERT(tracker.commit(retried));
+  // A change set computed before that commit is stale
+  CM_EXPECT(!tracker.commit(failed));
+  CM_EXPECT_EQ(tracker.token(), retried.token);
+}
+
+CM_TEST(expiredHistoryFallsBackToFullScan) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(200));
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeTracker tracker;
+  syncAll(tracker, store);
+
+  store.setHistoryLimit(2);
+  store.updateContact(testing::makeNamedContact("contact-1", "J", "One"));
+  store.updateContact(testing::makeNamedContact("contact-2", "K", "Two"));
+  store.removeContact("contact-3");
+  store.addContact(testing::makeNamedContact("new", "L", "New"));
+  store.resetCounters();
+
+  ContactChangeSet changes = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT(changes.fullScan);
+  CM_EXPECT_EQ(store.recordsRead(), uint64_t(store.size()));
+  CM_EXPECT_EQ(changes.added, std::vector<std::string>{"new"});
+  CM_EXPECT_EQ(sorted(changes.updated), (std::vector<std::string>{"contact-1", "contact-2"}));
+  CM_EXPECT_EQ(changes.deleted, std::vector<std::string>{"contact-3"});
+
+  CM_ASSERT(tracker.commit(changes));
+  ContactChangeSet next = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT(!next.fullScan);
+  CM_EXPECT(next.empty());
+}
+
+CM_TEST(dropEverythingFallsBackToFullScan) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(50));
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeTracker tracker;
+  syncAll(tracker, store);
+
+  store.updateContact(testing::makeNamedContact("contact-7", "M", "Seven"));
+  store.dropHistory();
+
+  ContactChangeSet changes = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT(changes.fullScan);
+  CM_EXPECT(changes.added.empty());
+  CM_EXPECT_EQ(changes.updated, std::vector<std::string>{"contact-7"});
+  CM_EXPECT(changes.deleted.empty());
+}
+
+CM_TEST(unchangedContactsAreSkippedOnFullScans) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(100);
+  testing::SimulatedContactStore store(book);
+  ContactChangeTracker tracker;
+  CM_ASSERT(tracker.commit(tracker.pendingChanges(scanOf(store))));
+
+  // A phone number reformatted by the store is not a change
+  Contact reformatted = book[10];
+  if (!reformatted.phoneNumbers.empty()) {
+    std::string &value = reformatted.phoneNumbers[0].value;
+    value.erase(std::remove(value.begin(), value.end(), ' '), value.end());
+  }
+  store.updateContact(reformatted);
+  CM_EXPECT(tracker.pendingChanges(scanOf(store)).empty());
+
+  store.updateContact(testing::makeNamedContact("contact-10", "N", "Ten"));
+  CM_EXPECT_EQ(tracker.pendingChanges(scanOf(store)).updated, std::vector<std::string>{"contact-10"});
+}
+
+CM_TEST(historyChangesKeepTheirHashes) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(20));
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeTracker tracker;
+  syncAll(tracker, store);
+
+  store.updateContact(testing::makeNamedContact("contact-8", "O", "Eight"));
+  store.updateContact(testing::makeNamedContact("contact-9", "P", "Nine"));
+  ContactChangeSet changes = tracker.pendingChanges(history, scanOf(store));
+  CM_EXPECT(changes.hashes.empty());
+  // The caller hashes the contacts it fetched for upload
+  for (const auto &contact : store.fetchContacts({"contact-8"})) {
+    changes.hashes.emplace(contact.identifier, contactContentHash(contact));
+  }
+  CM_ASSERT(tracker.commit(changes));
+
+  // Only the contact committed without a hash is reported again by a full scan
+  CM_EXPECT_EQ(tracker.pendingChanges(scanOf(store)).updated, std::vector<std::string>{"contact-9"});
+}
+
+CM_TEST(trackerStateRoundTrips) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(300));
+  testing::SimulatedChangeHistory history(store);
+  ContactChangeTracker tracker;
+  syncAll(tracker, store);
+
+  std::string path = testing::temporaryPath("change_tracker", "roundtrip");
+  CM_ASSERT(tracker.save(path));
+  ContactChangeTracker loaded;
+  CM_ASSERT(loaded.load(path));
+  CM_EXPECT_EQ(loaded.size(), tracker.size());
+  CM_EXPECT_EQ(loaded.token(), tracker.token());
+
+  store.removeContact("contact-0");
+  ContactChangeSet changes = loaded.pendingChanges(history, scanOf(store));
+  CM_EXPECT(!changes.fullScan);
+  CM_EXPECT_EQ(changes.deleted, std::vector<std::string>{"contact-0"});
+  std::remove(path.c_str());
+}
+
+CM_TEST(loadRejectsCorruptTrackerFiles) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(50));
+  ContactChangeTracker tracker;
+  syncAll(tracker, store);
+  std::string path = testing::temporaryPath("change_tracker", "corrupt");
+  CM_ASSERT(tracker.save(path));
+
+  FILE *file = std::fopen(path.c_str(), "rb");
+  CM_ASSERT(file != nullptr);
+  std::string data(4096, '\0');
+  data.resize(std::fread(&data[0], 1, data.size(), file));
+  std::fclose(file);
+  file = std::fopen(path.c_str(), "wb");
+  std::fwrite(data.data(), 1, data.size() / 2, file);
+  std::fclose(file);
+
+  ContactChangeTracker loaded;
+  CM_EXPECT(!loaded.load(path));
+  CM_EXPECT_EQ(loaded.size(), size_t(0));
+  CM_EXPECT(loaded.token().empty());
+  CM_EXPECT(!loaded.load(testing::temporaryPath("change_tracker", "missing")));
+  std::remove(path.c_str());
+}
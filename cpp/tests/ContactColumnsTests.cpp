@@ -0,0 +1,135 @@
+//
+//  ContactColumnsTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactColumns.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace contactsmanager;
+
+CM_TEST(columnsRoundTripEveryField) {
+  auto book = testing::makeSyntheticAddressBook(200);
+  book[3].birthday.reset();
+  book[4].birthday = 86400.0;
+  book[5].isDeleted = true;
+  ContactColumns columns(book);
+  CM_ASSERT(columns.size() == book.size());
+
+  for (size_t row = 0; row < book.size(); ++row) {
+    const Contact &contact = book[row];
+    for (size_t i = 0; i < kContactStringFieldCount; ++i) {
+      auto field = static_cast<ContactStringField>(i);
+      CM_EXPECT(columns.stringAt(row, field) == contactStringFieldValue(contact, field));
+    }
+    CM_EXPECT_EQ(columns.hasBirthday(row), contact.birthday.has_value());
+    if (contact.birthday) {
+      CM_EXPECT_EQ(columns.numberAt(row, ContactNumberField::Birthday), *contact.birthday);
+    } else {
+      CM_EXPECT(std::isnan(columns.numberAt(row, ContactNumberField::Birthday)));
+    }
+    CM_EXPECT_EQ(columns.numberAt(row, ContactNumberField::IsDeleted), contact.isDeleted ? 1.0 : 0.0);
+    CM_EXPECT_EQ(columns.numberAt(row, ContactNumberField::CreatedAt), contact.createdAt);
+
+    CM_ASSERT(columns.phoneNumberCount(row) == contact.phoneNumbers.size());
+    for (size_t i = 0; i < contact.phoneNumbers.size(); ++i) {
+      LabeledValueView phone = columns.phoneNumberAt(row, i);
+      CM_EXPECT(phone.value == contact.phoneNumbers[i].value);
+      CM_EXPECT(phone.type == contact.phoneNumbers[i].type);
+      CM_EXPECT(phone.contactId == contact.identifier);
+    }
+    CM_ASSERT(columns.emailAddressCount(row) == contact.emailAddresses.size());
+    for (size_t i = 0; i < contact.emailAddresses.size(); ++i) {
+      CM_EXPECT(columns.emailAddressAt(row, i).value == contact.emailAddresses[i].value);
+    }
+  }
+}
+
+CM_TEST(columnsCarryEveryCollectionAndPhoto) {
+  testing::SyntheticBookOptions options;
+  options.imageRate = 1;
+  options.imageBytes = 256;
+  options.thumbnailBytes = 64;
+  auto book = testing::makeSyntheticAddressBook(3, options);
+  Contact &contact = book[1];
+  contact.addresses.clear();
+  contact.addresses.push_back({contact.identifier, "1 Main St", "Springfield", "IL", "62701", "US", "home", "🏠"});
+  contact.dates.push_back({contact.identifier, 86400, "anniversary"});
+  contact.urlAddresses.push_back({contact.identifier, "https://example.com", "homepage", ""});
+  contact.socialProfiles.push_back({contact.identifier, "twitter", "ada", "https://twitter.com/ada"});
+  contact.relations.push_back({contact.identifier, "Charles", "friend"});
+  contact.instantMessageAddresses.push_back({contact.identifier, "Skype", "ada.l", "work"});
+  contact.interests = {"math", "poetry"};
+  contact.avatars = {"https://example.com/ada.png"};
+  ContactColumns columns(book, {"", "image-1", ""});
+
+  CM_ASSERT(columns.addressCount(1) == 1);
+  PostalAddressView address = columns.addressAt(1, 0);
+  CM_EXPECT(address.contactId == contact.identifier);
+  CM_EXPECT(address.street == "1 Main St");
+  CM_EXPECT(address.postalCode == "62701");
+  CM_EXPECT(address.emoji == "🏠");
+  CM_ASSERT(columns.dateCount(1) == 1);
+  CM_EXPECT_EQ(columns.dateAt(1, 0).date, 86400.0);
+  CM_EXPECT(columns.dateAt(1, 0).type == "anniversary");
+  CM_ASSERT(columns.urlAddressCount(1) == 1);
+  CM_EXPECT(columns.urlAddressAt(1, 0).value == "https://example.com");
+  CM_ASSERT(columns.socialProfileCount(1) == 1);
+  CM_EXPECT(columns.socialProfileAt(1, 0).urlString == "https://twitter.com/ada");
+  CM_ASSERT(columns.relationCount(1) == 1);
+  CM_EXPECT(columns.relationAt(1, 0).name == "Charles");
+  CM_ASSERT(columns.instantMessageCount(1) == 1);
+  CM_EXPECT(columns.instantMessageAt(1, 0).username == "ada.l");
+  CM_ASSERT(columns.interestCount(1) == 2);
+  CM_EXPECT(columns.interestAt(1, 1) == "poetry");
+  CM_ASSERT(columns.avatarCount(1) == 1);
+  CM_EXPECT(columns.avatarAt(1, 0) == "https://example.com/ada.png");
+
+  CM_EXPECT(columns.imageIdAt(0).empty());
+  CM_EXPECT(columns.imageIdAt(1) == "image-1");
+  for (size_t row = 0; row < book.size(); ++row) {
+    CM_EXPECT_EQ(columns.dateCount(row), book[row].dates.size());
+    CM_EXPECT_EQ(columns.addressCount(row), book[row].addresses.size());
+    std::string_view image = columns.imageDataAt(row);
+    CM_EXPECT(std::equal(image.begin(), image.end(), book[row].imageData.begin(), book[row].imageData.end(),
+                         [](char lhs, uint8_t rhs) { return static_cast<uint8_t>(lhs) == rhs; }));
+    CM_EXPECT_EQ(columns.thumbnailImageDataAt(row).size(), book[row].thumbnailImageData.size());
+  }
+  CM_EXPECT(!columns.imageDataAt(0).empty());
+}
+
+CM_TEST(columnsHandleEmptyList) {
+  ContactColumns columns(std::vector<Contact>{});
+  CM_EXPECT_EQ(columns.size(), size_t(0));
+}
+
+CM_TEST(fieldNamesRoundTrip) {
+  for (size_t i = 0; i < kContactStringFieldCount; ++i) {
+    auto field = static_cast<ContactStringField>(i);
+    CM_EXPECT(contactStringFieldNamed(contactFieldName(field)) == field);
+  }
+  for (size_t i = 0; i < kContactNumberFieldCount; ++i) {
+    auto field = static_cast<ContactNumberField>(i);
+    CM_EXPECT(contactNumberFieldNamed(contactFieldName(field)) == field);
+  }
+  CM_EXPECT(!contactStringFieldNamed("phoneNumbers").has_value());
+}
+
+CM_TEST(registryHandlesAreReleased) {
+  auto &registry = ContactColumnRegistry::sharedInstance();
+  size_t before = registry.size();
+  auto columns = std::make_shared<const ContactColumns>(testing::makeSyntheticAddressBook(3));
+  uint64_t first = registry.add(columns);
+  uint64_t second = registry.add(columns);
+  CM_EXPECT(first != second);
+  CM_EXPECT(registry.get(first) == columns);
+  CM_EXPECT(registry.release(first));
+  CM_EXPECT(!registry.release(first));
+  CM_EXPECT(registry.get(first) == nullptr);
+  CM_EXPECT(registry.release(second));
+  CM_EXPECT_EQ(registry.size(), before);
+}
@@ -0,0 +1,169 @@
+//
+//  ContactCursorTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactCursor.h"
+#include "SimulatedContactStore.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+ContactCursor<Contact>::Enumerator enumeratorFor(const testing::SimulatedContactStore &store) {
+  return [&store](const std::function<bool(Contact &&)> &emit) { store.enumerate(emit); };
+}
+
+// Gives the producer time to run ahead as far as backpressure allows
+void settle() {
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+}
+
+} // namespace
+
+CM_TEST(cursorTokensRoundTrip) {
+  CursorToken token{7, 1234};
+  std::string text = formatCursorToken(token);
+  CM_EXPECT_EQ(text, std::string("7:1234"));
+  auto parsed = parseCursorToken(text);
+  CM_ASSERT(parsed.has_value());
+  CM_EXPECT_EQ(parsed->cursorId, uint64_t(7));
+  CM_EXPECT_EQ(parsed->offset, uint64_t(1234));
+
+  CM_EXPECT(!parseCursorToken("").has_value());
+  CM_EXPECT(!parseCursorToken("7").has_value());
+  CM_EXPECT(!parseCursorToken(":5").has_value());
+  CM_EXPECT(!parseCursorToken("7:").has_value());
+  CM_EXPECT(!parseCursorToken("7:5x").has_value());
+  CM_EXPECT(!parseCursorToken("-1:5").has_value());
+}
+
+CM_TEST(cursorPagesCoverStoreInOrder) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(1000));
+  ContactCursor<Contact> cursor(1, enumeratorFor(store), 64);
+
+  std::vector<std::string> identifiers;
+  CursorToken token = cursor.firstToken();
+  bool done = false;
+  while (!done) {
+    CursorPage<Contact> page = cursor.next(token, 150);
+    CM_ASSERT(page.status == CursorStatus::Ok);
+    CM_EXPECT(page.items.size() <= size_t(150));
+    for (const auto &contact : page.items) {
+      identifiers.push_back(contact.identifier);
+    }
+    token = page.next;
+    done = page.done;
+  }
+
+  CM_ASSERT(identifiers.size() == size_t(1000));
+  for (size_t i = 0; i < identifiers.size(); ++i) {
+    CM_EXPECT_EQ(identifiers[i], "contact-" + std::to_string(i));
+  }
+  // One pass over the store no matter how many pages were pulled
+  CM_EXPECT_EQ(store.recordsRead(), uint64_t(1000));
+}
+
+CM_TEST(cursorRejectsStaleTokens) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(100));
+  ContactCursor<Contact> cursor(3, enumeratorFor(store), 16);
+
+  CursorPage<Contact> first = cursor.next(cursor.firstToken(), 10);
+  CM_ASSERT(first.status == CursorStatus::Ok);
+  CM_EXPECT_EQ(first.next.offset, uint64_t(10));
+
+  // Replaying an old position or presenting another cursor's token fails
+  CM_EXPECT(cursor.next(cursor.firstToken(), 10).status == CursorStatus::StaleToken);
+  CM_EXPECT(cursor.next(CursorToken{4, 10}, 10).status == CursorStatus::StaleToken);
+
+  CursorPage<Contact> second = cursor.next(first.next, 10);
+  CM_ASSERT(second.status == CursorStatus::Ok);
+  CM_ASSERT(!second.items.empty());
+  CM_EXPECT_EQ(second.items.front().identifier, std::string("contact-10"));
+}
+
+CM_TEST(cursorRejectsConcurrentPulls) {
+  // Five contacts, then the store stalls until released
+  std::atomic<bool> released{false};
+  ContactCursor<Contact> cursor(5, [&](const std::function<bool(Contact &&)> &emit) {
+    for (size_t i = 0; i < 10; ++i) {
+      while (i == 5 && !released) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      if (!emit(Contact("contact-" + std::to_string(i)))) {
+        return;
+      }
+    }
+  });
+
+  CursorPage<Contact> first;
+  std::thread puller([&] { first = cursor.next(cursor.firstToken(), 10); });
+  while (!cursor.pulling() || cursor.enumeratedCount() < 5) {
+    std::this_thread::yield();
+  }
+  // Same token while the first pull waits: rejected instead of both proceeding
+  CM_EXPECT(cursor.next(cursor.firstToken(), 10).status == CursorStatus::Busy);
+
+  released = true;
+  puller.join();
+  CM_ASSERT(first.status == CursorStatus::Ok);
+  CM_EXPECT_EQ(first.items.size(), size_t(10));
+  CM_EXPECT(!cursor.pulling());
+  CursorPage<Contact> last = cursor.next(first.next, 10);
+  CM_EXPECT(last.status == CursorStatus::Ok);
+  CM_EXPECT(last.done);
+}
+
+CM_TEST(cursorAppliesBackpressure) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(5000));
+  ContactCursor<Contact> cursor(1, enumeratorFor(store), 32);
+
+  CursorPage<Contact> page = cursor.next(cursor.firstToken(), 50);
+  CM_ASSERT(page.items.size() == size_t(50));
+  settle();
+  // The producer runs at most one read-ahead window past what was pulled (+1 blocked in emit)
+  CM_EXPECT(store.recordsRead() <= uint64_t(50 + 32 + 1));
+  CM_EXPECT(!page.done);
+
+  cursor.close();
+  settle();
+  uint64_t readAtClose = store.recordsRead();
+  CM_EXPECT(readAtClose < uint64_t(5000));
+  CM_EXPECT(cursor.next(page.next, 10).status == CursorStatus::Closed);
+}
+
+CM_TEST(cursorReportsDoneOnShortStore) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(5));
+  ContactCursor<Contact> cursor(1, enumeratorFor(store));
+  CursorPage<Contact> page = cursor.next(cursor.firstToken(), 100);
+  CM_ASSERT(page.status == CursorStatus::Ok);
+  CM_EXPECT_EQ(page.items.size(), size_t(5));
+  CM_EXPECT(page.done);
+}
+
+CM_TEST(cursorRegistryClosesCursors) {
+  testing::SimulatedContactStore store(testing::makeSyntheticAddressBook(200));
+  ContactCursorRegistry<Contact> registry;
+  auto first = registry.open(enumeratorFor(store), 8);
+  auto second = registry.open(enumeratorFor(store), 8);
+  CM_EXPECT(first->cursorId() != second->cursorId());
+  CM_EXPECT_EQ(registry.size(), size_t(2));
+  CM_EXPECT(registry.get(first->cursorId()) == first);
+
+  CM_EXPECT(registry.close(first->cursorId()));
+  CM_EXPECT(!registry.close(first->cursorId()));
+  CM_EXPECT(registry.get(first->cursorId()) == nullptr);
+  CM_EXPECT(first->next(first->firstToken(), 1).status == CursorStatus::Closed);
+
+  registry.closeAll();
+  CM_EXPECT_EQ(registry.size(), size_t(0));
+  CM_EXPECT(second->next(second->firstToken(), 1).status == CursorStatus::Closed);
+}
@@ -0,0 +1,151 @@
+//
+//  ContactDeduplicationTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactDeduplication.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <cmath>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+Contact person(const std::string &identifier, const std::string &given, const std::string &family,
+               const std::string &phone, const std::string &email = {}) {
+  Contact contact(identifier);
+  contact.givenName = given;
+  contact.familyName = family;
+  if (!phone.empty()) {
+    contact.phoneNumbers.push_back({identifier, phone, "mobile", ""});
+  }
+  if (!email.empty()) {
+    contact.emailAddresses.push_back({identifier, email, "home", ""});
+  }
+  contact.updateDisplayInfo();
+  return contact;
+}
+
+bool near(double actual, double expected) {
+  return std::fabs(actual - expected) < 0.001;
+}
+
+} // namespace
+
+CM_TEST(soundexAndJaroWinklerMatchReferenceValues) {
+  CM_EXPECT_EQ(soundexCode("Robert"), std::string("R163"));
+  CM_EXPECT_EQ(soundexCode("Rupert"), std::string("R163"));
+  CM_EXPECT_EQ(soundexCode("Ashcraft"), std::string("A261"));
+  CM_EXPECT_EQ(soundexCode("Tymczak"), std::string("T522"));
+  CM_EXPECT_EQ(soundexCode("Pfister"), std::string("P236"));
+  CM_EXPECT_EQ(soundexCode("Lee"), std::string("L000"));
+  CM_EXPECT_EQ(soundexCode("Müller"), soundexCode("Muller"));
+  CM_EXPECT_EQ(soundexCode("王"), std::string());
+
+  CM_EXPECT(near(jaroWinklerSimilarity("martha", "marhta"), 0.961));
+  CM_EXPECT(near(jaroWinklerSimilarity("dwayne", "duane"), 0.840));
+  CM_EXPECT(near(jaroWinklerSimilarity("dixon", "dicksonx"), 0.813));
+  CM_EXPECT_EQ(jaroWinklerSimilarity("same", "same"), 1.0);
+  CM_EXPECT_EQ(jaroWinklerSimilarity("abc", ""), 0.0);
+  CM_EXPECT_EQ(jaroWinklerSimilarity("abc", "xyz"), 0.0);
+}
+
+CM_TEST(pairsNeedASharedDetailAndACompatibleName) {
+  DedupOptions options;
+  Contact ada = person("1", "Ada", "Lovelace", "+1 (555) 201-0001", "ada@example.com");
+
+  // Reformatted number, typo in the name
+  CM_EXPECT(scoreDuplicatePair(ada, person("2", "Ada", "Lovelcae", "555-201-0001"), options) >=
+            options.matchThreshold);
+  // Email in another case, fields swapped
+  CM_EXPECT(scoreDuplicatePair(ada, person("3", "Lovelace", "Ada", "", "ADA@Example.com"), options) >=
+            options.matchThreshold);
+  // A number saved without a name
+  CM_EXPECT(scoreDuplicatePair(ada, person("4", "", "", "+15552010001"), options) >= options.matchThreshold);
+
+  // The same name alone is not enough, and a shared family landline is not a duplicate
+  CM_EXPECT(scoreDuplicatePair(ada, person("5", "Ada", "Lovelace", "555-999-0000"), options) <
+            options.matchThreshold);
+  CM_EXPECT(scoreDuplicatePair(ada, person("6", "George", "Lovelace", "555-201-0001"), options) <
+            options.matchThreshold);
+}
+
+CM_TEST(clustersFollowMatchesAndExistingParents) {
+  std::vector<Contact> book = {
+      person("a", "Grace", "Hopper", "+1 555 300 0001", "grace@navy.mil"),
+      person("b", "Alan", "Turing", "+44 20 7946 0001"),
+      person("c", "Grace", "Hopper", "555-300-0001"),
+      person("d", "Grace", "Hopper", "", "GRACE@navy.mil"),
+      person("e", "Grace", "Hopper", "555-300-9999"),
+      person("f", "Alan", "Turing", "0044 20-7946-0001"),
+      person("g", "Grace", "Hopper", "555-300-0001"),
+      person("h", "Bletchley", "Park", "555-700-0001"),
+  };
+  // Deleted contacts never match; the user already linked h under f
+  book[6].isDeleted = true;
+  book[7].parentContactId = "f";
+
+  DedupOptions options;
+  DedupResult result = findDuplicateContacts(book, options);
+  CM_ASSERT(result.clusters.size() == 2);
+  // The richest member is kept; otherwise an existing parent
+  CM_EXPECT(result.clusters[0].members == (std::vector<uint32_t>{0, 2, 3}));
+  CM_EXPECT(result.clusters[1].members == (std::vector<uint32_t>{5, 1, 7}));
+  for (const auto &match : result.matches) {
+    CM_EXPECT(match.first < match.second);
+    CM_EXPECT(match.score >= options.matchThreshold);
+  }
+
+  CM_EXPECT_EQ(assignParentContactIds(book, result), size_t(3));
+  CM_EXPECT_EQ(book[2].parentContactId, std::string("a"));
+  CM_EXPECT_EQ(book[3].parentContactId, std::string("a"));
+  CM_EXPECT_EQ(book[1].parentContactId, std::string("f"));
+  CM_EXPECT(book[4].parentContactId.empty());
+  CM_EXPECT_EQ(assignParentContactIds(book, findDuplicateContacts(book, options)), size_t(0));
+}
+
+CM_TEST(oversizedBlocksAreComparedByNeighbourhood) {
+  // A switchboard number shared by a whole company
+  std::vector<Contact> book;
+  for (size_t i = 0; i < 500; ++i) {
+    book.push_back(person("c" + std::to_string(i), "Staff", "Member" + std::to_string(i), "555-100-0000"));
+  }
+  DedupOptions options;
+  DedupResult result = findDuplicateContacts(book, options);
+  // Each contact meets its window in the phone block and its name block
+  CM_EXPECT(result.candidatePairs <= book.size() * 2 * options.neighbourWindow);
+  CM_EXPECT(result.candidatePairs >= book.size());
+}
+
+CM_TEST(findsInjectedDuplicatesInASyntheticBook) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(3000);
+  std::vector<std::pair<size_t, size_t>> injected = testing::appendSyntheticDuplicates(book, 0.1);
+  CM_ASSERT(injected.size() > 200);
+
+  DedupResult result = findDuplicateContacts(book);
+  std::set<std::pair<size_t, size_t>> found;
+  for (const auto &cluster : result.clusters) {
+    for (size_t i = 0; i < cluster.members.size(); ++i) {
+      for (size_t j = i + 1; j < cluster.members.size(); ++j) {
+        found.emplace(std::min(cluster.members[i], cluster.members[j]),
+                      std::max(cluster.members[i], cluster.members[j]));
+      }
+    }
+  }
+  size_t truePositives = 0;
+  for (const auto &pair : injected) {
+    truePositives += found.count(pair);
+  }
+  double recall = static_cast<double>(truePositives) / static_cast<double>(injected.size());
+  double precision = static_cast<double>(truePositives) / static_cast<double>(found.size());
+  CM_EXPECT(recall >= 0.95);
+  CM_EXPECT(precision >= 0.98);
+  // Candidates stay a small multiple of the book
+  CM_EXPECT(result.candidatePairs < book.size() * 20);
+}
@@ -0,0 +1,223 @@
+//
+//  ContactDeltaTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactDelta.h"
+#include "ContactHashing.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace contactsmanager;
+
+namespace {
+
+Contact makeContact() {
+  Contact contact("c1");
+  contact.givenName = "Ada";
+  contact.familyName = "Lovelace";
+  contact.organizationName = "Analytical Engines";
+  contact.phoneNumbers = {{"c1", "+1 555 0100", "mobile", ""}, {"c1", "+1 555 0101", "home", ""},
+                          {"c1", "+1 555 0102", "work", ""}};
+  contact.emailAddresses = {{"c1", "ada@example.com", "home", ""}};
+  contact.birthday = 1000.0;
+  contact.updateDisplayInfo();
+  return contact;
+}
+
+// Applies the diff to a copy of base and checks it reproduces current
+bool roundTrips(const Contact &base, const Contact &current) {
+  Contact patched = base;
+  ContactPatch patch = diffContacts(base, current);
+  return applyContactPatch(patched, patch) && contactHash128(patched) == contactHash128(current) &&
+         patched.matchString == current.matchString && patched.contactSection == current.contactSection;
+}
+
+} // namespace
+
+CM_TEST(unchangedContactHasEmptyPatch) {
+  Contact contact = makeContact();
+  ContactPatch patch = diffContacts(contact, contact);
+  CM_EXPECT_EQ(patch.fields, 0u);
+  CM_EXPECT(patch.collections.empty());
+  CM_EXPECT(patch.baseVersion == patch.version);
+}
+
+CM_TEST(scalarFieldsAreSetIndividually) {
+  Contact base = makeContact();
+  Contact current = base;
+  current.jobTitle = "Programmer";
+  current.birthday.reset();
+  ContactPatch patch = diffContacts(base, current);
+  CM_EXPECT_EQ(patch.fields, contactFieldBit(ContactField::JobTitle) | contactFieldBit(ContactField::Birthday));
+  CM_EXPECT_EQ(patch.values.jobTitle, std::string("Programmer"));
+  CM_EXPECT(!patch.values.birthday.has_value());
+  CM_EXPECT(patch.collections.empty());
+  CM_EXPECT(patch.baseVersion == serverContactHash128(base));
+  CM_EXPECT(patch.version == serverContactHash128(current));
+  CM_EXPECT(roundTrips(base, current));
+}
+
+CM_TEST(collectionEditsRemoveAndAppend) {
+  Contact base = makeContact();
+
+  // Dropping the middle number removes one index and appends nothing
+  Contact removed = base;
+  removed.phoneNumbers.erase(removed.phoneNumbers.begin() + 1);
+  ContactPatch patch = diffContacts(base, removed);
+  const CollectionPatch *phones = patch.collection(ContactCollection::PhoneNumbers);
+  CM_ASSERT(phones != nullptr);
+  CM_EXPECT(!phones->replace);
+  CM_EXPECT(phones->removed == std::vector<uint32_t>{1});
+  CM_EXPECT(patch.values.phoneNumbers.empty());
+  CM_EXPECT(roundTrips(base, removed));
+
+  // A new email is appended without resending the existing one
+  Contact added = base;
+  added.emailAddresses.push_back({"c1", "ada@work.example", "work", ""});
+  patch = diffContacts(base, added);
+  const CollectionPatch *emails = patch.collection(ContactCollection::EmailAddresses);
+  CM_ASSERT(emails != nullptr);
+  CM_EXPECT(emails->removed.empty());
+  CM_EXPECT_EQ(patch.values.emailAddresses.size(), size_t(1));
+  CM_EXPECT(patch.collection(ContactCollection::PhoneNumbers) == nullptr);
+  CM_EXPECT(roundTrips(base, added));
+
+  // Editing the last number removes it and appends the new value
+  Contact edited = base;
+  edited.phoneNumbers[2].value = "+1 555 0199";
+  patch = diffContacts(base, edited);
+  phones = patch.collection(ContactCollection::PhoneNumbers);
+  CM_ASSERT(phones != nullptr);
+  CM_EXPECT(phones->removed == std::vector<uint32_t>{2});
+  CM_EXPECT_EQ(patch.values.phoneNumbers.size(), size_t(1));
+  CM_EXPECT(roundTrips(base, edited));
+}
+
+CM_TEST(reorderedOrReplacedCollectionsAreSentWhole) {
+  Contact base = makeContact();
+  Contact reordered = base;
+  std::swap(reordered.phoneNumbers[0], reordered.phoneNumbers[2]);
+  CM_EXPECT(roundTrips(base, reordered));
+
+  Contact replaced = base;
+  replaced.emailAddresses = {{"c1", "countess@example.com", "home", ""}};
+  ContactPatch patch = diffContacts(base, replaced);
+  const CollectionPatch *emails = patch.collection(ContactCollection::EmailAddresses);
+  CM_ASSERT(emails != nullptr);
+  CM_EXPECT(emails->replace);
+  CM_EXPECT(roundTrips(base, replaced));
+
+  Contact cleared = base;
+  cleared.phoneNumbers.clear();
+  CM_EXPECT(roundTrips(base, cleared));
+
+  // Dropping the first number changes which one is primary
+  Contact demoted = base;
+  demoted.phoneNumbers.erase(demoted.phoneNumbers.begin());
+  patch = diffContacts(base, demoted);
+  const CollectionPatch *phones = patch.collection(ContactCollection::PhoneNumbers);
+  CM_ASSERT(phones != nullptr);
+  CM_EXPECT(phones->replace);
+  CM_EXPECT_EQ(patch.values.phoneNumbers.size(), size_t(2));
+  CM_EXPECT(roundTrips(base, demoted));
+}
+
+CM_TEST(unsyncedFieldsLeaveTheVersionAlone) {
+  Contact base = makeContact();
+  Contact current = base;
+  current.imageUrl = "https://example.com/ada.png";
+  current.interests = {"mathematics"};
+  ContactPatch patch = diffContacts(base, current);
+  CM_EXPECT_EQ(patch.fields, 0u);
+  CM_EXPECT(patch.collections.empty());
+  CM_EXPECT(patch.baseVersion == patch.version);
+  CM_EXPECT(!(contactHash128(base) == contactHash128(current)));
+}
+
+CM_TEST(randomEditsRoundTrip) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(200);
+  testing::SplitMix64 random(7);
+  for (size_t i = 0; i < book.size(); ++i) {
+    const Contact &base = book[i];
+    Contact current = testing::makeSyntheticContact(i + 1000, random);
+    current.identifier = base.identifier;
+    // Keep some of the base items so collections get partial patches
+    if (i % 2 == 0) {
+      current.phoneNumbers.insert(current.phoneNumbers.begin(), base.phoneNumbers.begin(), base.phoneNumbers.end());
+    }
+    CM_EXPECT(roundTrips(base, current));
+  }
+}
+
+CM_TEST(outOfRangeRemovalIsRejected) {
+  Contact base = makeContact();
+  Contact current = base;
+  current.phoneNumbers.pop_back();
+  ContactPatch patch = diffContacts(base, current);
+
+  Contact shorter = base;
+  shorter.phoneNumbers.resize(1);
+  shorter.givenName = "Unchanged";
+  CM_EXPECT(!applyContactPatch(shorter, patch));
+  CM_EXPECT_EQ(shorter.phoneNumbers.size(), size_t(1));
+  CM_EXPECT_EQ(shorter.givenName, std::string("Unchanged"));
+}
+
+CM_TEST(snapshotStorePatchesAgainstAcknowledgedVersion) {
+  ContactSnapshotStore store;
+  Contact contact = makeContact();
+  CM_EXPECT(!store.patchFor(contact).has_value());
+
+  store.put(contact);
+  CM_EXPECT(store.contains("c1"));
+  auto snapshot = store.get("c1");
+  CM_ASSERT(snapshot.has_value());
+  CM_EXPECT(contactHash128(*snapshot) == contactHash128(contact));
+  CM_EXPECT_EQ(snapshot->matchString, contact.matchString);
+
+  Contact current = contact;
+  current.phoneNumbers.push_back({"c1", "+1 555 0103", "iPhone", ""});
+  auto patch = store.patchFor(current);
+  CM_ASSERT(patch.has_value());
+  CM_EXPECT(patch->baseVersion == serverContactHash128(contact));
+  CM_EXPECT_EQ(patch->values.phoneNumbers.size(), size_t(1));
+
+  CM_EXPECT(store.remove("c1"));
+  CM_EXPECT(!store.patchFor(current).has_value());
+}
+
+CM_TEST(snapshotStoreSurvivesReload) {
+  std::string path = "cm_snapshot_store_test.bin";
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(50);
+  {
+    ContactSnapshotStore store;
+    for (const auto &contact : book) {
+      store.put(contact);
+    }
+    CM_ASSERT(store.save(path));
+  }
+  ContactSnapshotStore loaded;
+  CM_ASSERT(loaded.load(path));
+  CM_EXPECT_EQ(loaded.size(), book.size());
+  for (const auto &contact : book) {
+    auto snapshot = loaded.get(contact.identifier);
+    CM_ASSERT(snapshot.has_value());
+    CM_EXPECT(contactHash128(*snapshot) == contactHash128(contact));
+  }
+
+  // A truncated file leaves the store empty so every contact is upserted again
+  struct stat info;
+  CM_ASSERT(::stat(path.c_str(), &info) == 0);
+  CM_ASSERT(::truncate(path.c_str(), info.st_size / 2) == 0);
+  CM_EXPECT(!loaded.load(path));
+  CM_EXPECT_EQ(loaded.size(), size_t(0));
+  std::remove(path.c_str());
+}
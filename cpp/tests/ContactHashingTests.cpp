@@ -0,0 +1,124 @@
+//
+//  ContactHashingTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactHashing.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <string>
+
+using namespace contactsmanager;
+
+CM_TEST(fnv1aKnownVectors) {
+  CM_EXPECT_EQ(fnv1a64(""), 0xcbf29ce484222325ULL);
+  CM_EXPECT_EQ(fnv1a64("a"), 0xaf63dc4c8601ec8cULL);
+}
+
+CM_TEST(hashIsStableAndHex) {
+  auto book = testing::makeSyntheticAddressBook(10);
+  for (const auto &contact : book) {
+    std::string hash = generateContactHash(contact);
+    CM_EXPECT_EQ(hash.size(), size_t(32));
+    CM_EXPECT_EQ(hash, formatHash128(contactHash128(contact)));
+    CM_EXPECT_EQ(hash, generateContactHash(contact));
+  }
+}
+
+CM_TEST(hashChangesWhenFieldsChange) {
+  auto book = testing::makeSyntheticAddressBook(1);
+  Contact contact = book.front();
+  std::string original = generateContactHash(contact);
+
+  Contact renamed = contact;
+  renamed.givenName += "x";
+  CM_EXPECT(generateContactHash(renamed) != original);
+
+  Contact rephoned = contact;
+  rephoned.phoneNumbers.front().value += "9";
+  CM_EXPECT(generateContactHash(rephoned) != original);
+
+  // Same number without its formatting
+  Contact reformatted = contact;
+  std::string compact;
+  for (char c : contact.phoneNumbers.front().value) {
+    if (c == '+' || (c >= '0' && c <= '9')) {
+      compact.push_back(c);
+    }
+  }
+  reformatted.phoneNumbers.front().value = compact;
+  CM_EXPECT_EQ(generateContactHash(reformatted), original);
+
+  Contact synced = contact;
+  synced.lastSyncedAt = 99;
+  CM_EXPECT_EQ(generateContactHash(synced), original);
+}
+
+CM_TEST(streamingHashIgnoresChunking) {
+  std::string input;
+  for (size_t i = 0; i < 3000; ++i) {
+    input.push_back(static_cast<char>((i * 131) ^ (i >> 3)));
+  }
+  for (size_t length : {size_t(0), size_t(1), size_t(63), size_t(64), size_t(65), size_t(1024), size_t(3000)}) {
+    std::string_view prefix(input.data(), length);
+    Hash128 oneShot = hash128(prefix);
+    for (size_t chunk : {size_t(1), size_t(7), size_t(64), size_t(100)}) {
+      StreamingHasher hasher;
+      for (size_t offset = 0; offset < length; offset += chunk) {
+        hasher.update(prefix.substr(offset, chunk));
+      }
+      CM_EXPECT(hasher.digest() == oneShot);
+    }
+  }
+}
+
+CM_TEST(streamingHashIsStable) {
+  // Persisted digests depend on these values; they must not change across releases or platforms
+  CM_EXPECT_EQ(formatHash128(hash128("")), std::string("76a4be55118297ec51f4279f6f70dabe"));
+  CM_EXPECT_EQ(formatHash128(hash128("contact-1")), std::string("a87bf7fb7252953b558bab5d4f01241d"));
+  CM_EXPECT_EQ(formatHash128(hash128(std::string(1000, 'x'))), std::string("1eaf716c4e03777a9730b55c267aaff4"));
+
+  CM_EXPECT(hash128("a") != hash128("b"));
+  CM_EXPECT(hash128("a") != hash128("a", 1));
+  // Zero padding of the last stripe does not collide with real zero bytes
+  CM_EXPECT(hash128(std::string_view("a", 1)) != hash128(std::string_view("a\0", 2)));
+}
+
+CM_TEST(fieldsDoNotRunIntoEachOther) {
+  Contact lhs("1");
+  lhs.givenName = "ab";
+  lhs.familyName = "c";
+  Contact rhs("1");
+  rhs.givenName = "a";
+  rhs.familyName = "bc";
+  CM_EXPECT(contactHash128(lhs) != contactHash128(rhs));
+
+  // A phone number moved into the email list is a different contact
+  Contact phone("2");
+  phone.phoneNumbers.push_back({"2", "not a number", "home", ""});
+  Contact email("2");
+  email.emailAddresses.push_back({"2", "not a number", "home", ""});
+  CM_EXPECT(contactHash128(phone) != contactHash128(email));
+}
+
+CM_TEST(sectionDigestsLocateChanges) {
+  Contact contact = testing::makeSyntheticAddressBook(1).front();
+  ContactDigest original = contactDigest(contact);
+  CM_EXPECT_EQ(changedContactSections(original, contactDigest(contact)), 0u);
+
+  Contact edited = contact;
+  edited.jobTitle += " (updated)";
+  edited.emailAddresses.push_back({contact.identifier, "new@example.com", "work", ""});
+  uint32_t changed = changedContactSections(original, contactDigest(edited));
+  CM_EXPECT_EQ(changed, contactSectionBit(ContactSection::Organization) | contactSectionBit(ContactSection::Emails));
+
+  Contact renamed = contact;
+  renamed.familyName += "x";
+  CM_EXPECT_EQ(changedContactSections(original, contactDigest(renamed)), contactSectionBit(ContactSection::Name));
+
+  // Empty sections are seeded by position, so they do not share a digest
+  Contact empty("x");
+  ContactDigest emptyDigest = contactDigest(empty);
+  CM_EXPECT(emptyDigest.section(ContactSection::Notes) != emptyDigest.section(ContactSection::Image));
+}
@@ -0,0 +1,150 @@
+//
+//  ContactImageCacheTests.cpp
+//  ContactsManagerCore
+//
+
+#include "Base64.h"
+#include "ContactImageCache.h"
+#include "TestHarness.h"
+
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+ImageBytesView view(const std::vector<uint8_t> &bytes) {
+  return ImageBytesView{bytes.data(), bytes.size()};
+}
+
+std::vector<uint8_t> filled(size_t size, uint8_t seed) {
+  std::vector<uint8_t> bytes(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(seed + i * 31);
+  }
+  return bytes;
+}
+
+} // namespace
+
+CM_TEST(base64MatchesRfc4648Vectors) {
+  auto encode = [](const std::string &text) {
+    return base64::encode(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+  };
+  CM_EXPECT_EQ(encode(""), std::string(""));
+  CM_EXPECT_EQ(encode("f"), std::string("Zg=="));
+  CM_EXPECT_EQ(encode("fo"), std::string("Zm8="));
+  CM_EXPECT_EQ(encode("foo"), std::string("Zm9v"));
+  CM_EXPECT_EQ(encode("foobar"), std::string("Zm9vYmFy"));
+  CM_EXPECT_EQ(base64::encodedLength(4), size_t(8));
+
+  std::string decoded;
+  for (const char *text : {"", "f", "fo", "foo", "foobar", "\xff\x80"}) {
+    CM_EXPECT(base64::decode(encode(text), decoded));
+    CM_EXPECT_EQ(decoded, std::string(text));
+  }
+  for (const char *invalid : {"Zg=", "Zg=a", "Z===", "Zm9v=Zg=", "Zm9*"}) {
+    CM_EXPECT(!base64::decode(invalid, decoded));
+  }
+}
+
+CM_TEST(imageIdIsContentAddressed) {
+  auto full = filled(4096, 1);
+  auto thumb = filled(256, 2);
+  std::string id = ContactImageCache::imageIdForContent(view(full), view(thumb));
+  CM_EXPECT_EQ(id.size(), size_t(36));
+  CM_EXPECT_EQ(id.compare(0, 4, "img-"), 0);
+
+  auto copy = full;
+  CM_EXPECT_EQ(ContactImageCache::imageIdForContent(view(copy), view(thumb)), id);
+
+  copy[100] ^= 1;
+  CM_EXPECT(ContactImageCache::imageIdForContent(view(copy), view(thumb)) != id);
+
+  CM_EXPECT(ContactImageCache::imageIdForContent({}, view(thumb)) != id);
+  CM_EXPECT(ContactImageCache::imageIdForContent({}, {}).empty());
+}
+
+CM_TEST(registerCachesThumbnailEagerly) {
+  ContactImageCache cache;
+  auto full = filled(4096, 1);
+  auto thumb = filled(256, 2);
+  std::string id = cache.registerContactImages("contact-1", view(full), view(thumb), false);
+
+  auto cachedThumb = cache.lookup(id, ImageSizeClass::Thumbnail);
+  CM_ASSERT(cachedThumb != nullptr);
+  CM_EXPECT(*cachedThumb == thumb);
+  CM_EXPECT(cache.lookup(id, ImageSizeClass::Full) == nullptr);
+  CM_EXPECT_EQ(cache.contactIdForImage(id).value_or(""), std::string("contact-1"));
+
+  cache.store(id, ImageSizeClass::Full, view(full));
+  auto cachedFull = cache.lookup(id, ImageSizeClass::Full);
+  CM_ASSERT(cachedFull != nullptr);
+  CM_EXPECT(*cachedFull == full);
+
+  ImageCacheStats stats = cache.stats();
+  CM_EXPECT_EQ(stats.entries, size_t(2));
+  CM_EXPECT_EQ(stats.bytes, full.size() + thumb.size());
+  CM_EXPECT_EQ(stats.hits, size_t(2));
+  CM_EXPECT_EQ(stats.misses, size_t(1));
+}
+
+CM_TEST(sharedPhotosShareOneEntry) {
+  ContactImageCache cache;
+  auto full = filled(4096, 1);
+  auto thumb = filled(256, 2);
+  std::string first = cache.registerContactImages("contact-1", view(full), view(thumb), true);
+  std::string second = cache.registerContactImages("contact-2", view(full), view(thumb), true);
+  CM_EXPECT_EQ(first, second);
+  CM_EXPECT_EQ(cache.stats().entries, size_t(2));
+  CM_EXPECT_EQ(cache.stats().bytes, full.size() + thumb.size());
+}
+
+CM_TEST(evictsLeastRecentlyUsedWithinBudget) {
+  ContactImageCache cache(1000);
+  auto a = filled(400, 1);
+  auto b = filled(400, 2);
+  auto c = filled(400, 3);
+  std::string idA = cache.registerContactImages("a", {}, view(a), false);
+  std::string idB = cache.registerContactImages("b", {}, view(b), false);
+  CM_EXPECT(cache.lookup(idA, ImageSizeClass::Thumbnail) != nullptr);
+  std::string idC = cache.registerContactImages("c", {}, view(c), false);
+
+  CM_EXPECT(cache.lookup(idB, ImageSizeClass::Thumbnail) == nullptr);
+  CM_EXPECT(cache.lookup(idA, ImageSizeClass::Thumbnail) != nullptr);
+  CM_EXPECT(cache.lookup(idC, ImageSizeClass::Thumbnail) != nullptr);
+  CM_EXPECT_EQ(cache.stats().evictions, size_t(1));
+  CM_EXPECT(cache.stats().bytes <= size_t(1000));
+  // Evicted bytes can still be reloaded through the owning contact
+  CM_EXPECT_EQ(cache.contactIdForImage(idB).value_or(""), std::string("b"));
+
+  auto huge = filled(2000, 4);
+  cache.store(idA, ImageSizeClass::Full, view(huge));
+  CM_EXPECT(cache.lookup(idA, ImageSizeClass::Full) == nullptr);
+}
+
+CM_TEST(contactReferencesAreBounded) {
+  ContactImageCache cache(ContactImageCache::kDefaultByteBudget, 2);
+  auto a = filled(64, 1);
+  auto b = filled(64, 2);
+  auto c = filled(64, 3);
+  std::string idA = cache.registerContactImages("a", {}, view(a), false);
+  std::string idB = cache.registerContactImages("b", {}, view(b), false);
+  CM_EXPECT(cache.lookup(idA, ImageSizeClass::Thumbnail) != nullptr);
+  std::string idC = cache.registerContactImages("c", {}, view(c), false);
+
+  CM_EXPECT_EQ(cache.stats().contactReferences, size_t(2));
+  CM_EXPECT(!cache.contactIdForImage(idB).has_value());
+  CM_EXPECT_EQ(cache.contactIdForImage(idA).value_or(""), std::string("a"));
+  CM_EXPECT_EQ(cache.contactIdForImage(idC).value_or(""), std::string("c"));
+
+  cache.clear();
+  CM_EXPECT_EQ(cache.stats().contactReferences, size_t(0));
+}
+
+CM_TEST(sizeClassNames) {
+  CM_EXPECT(imageSizeClassNamed("thumbnail") == ImageSizeClass::Thumbnail);
+  CM_EXPECT(imageSizeClassNamed("full") == ImageSizeClass::Full);
+  CM_EXPECT(!imageSizeClassNamed("medium").has_value());
+}
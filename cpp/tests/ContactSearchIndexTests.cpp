@@ -0,0 +1,302 @@
+//
+//  ContactSearchIndexTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactSearchIndex.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+std::vector<std::string> sampleIds(const ContactSearchIndex &index, const std::string &query,
+                                   uint32_t fields = SearchField::All) {
+  return index.search(query, fields, 0, 100).identifiers;
+}
+
+// Optimal string alignment distance between query and the closest prefix of term
+size_t prefixEditDistance(const std::string &query, const std::string &term) {
+  std::vector<std::vector<size_t>> d(term.size() + 1, std::vector<size_t>(query.size() + 1));
+  size_t best = query.size();
+  for (size_t i = 0; i <= term.size(); ++i) {
+    for (size_t j = 0; j <= query.size(); ++j) {
+      if (i == 0 || j == 0) {
+        d[i][j] = i + j;
+        continue;
+      }
+      size_t cost = term[i - 1] == query[j - 1] ? 0 : 1;
+      d[i][j] = std::min({d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + cost});
+      if (i >= 2 && j >= 2 && term[i - 1] == query[j - 2] && term[i - 2] == query[j - 1]) {
+        d[i][j] = std::min(d[i][j], d[i - 2][j - 2] + 1);
+      }
+    }
+    best = std::min(best, d[i][query.size()]);
+  }
+  return best;
+}
+
+// What the index should match, computed the slow way
+bool tokenMatches(const std::string &queryToken, const std::string &token) {
+  if (token.compare(0, queryToken.size(), queryToken) == 0) {
+    return true;
+  }
+  if (token[0] == '\x01') {
+    return queryToken.size() >= 2 && queryToken.size() <= 4 &&
+           std::all_of(queryToken.begin(), queryToken.end(), [](char c) { return text::isAsciiAlpha(c); }) &&
+           token.compare(1, queryToken.size(), queryToken) == 0;
+  }
+  size_t maxEdits = text::isAsciiDigit(queryToken[0]) ? 0 : maxSearchEdits(queryToken.size());
+  return maxEdits > 0 && token[0] == queryToken[0] && prefixEditDistance(queryToken, token) <= maxEdits;
+}
+
+} // namespace
+
+CM_TEST(queryTokenization) {
+  auto tokens = searchQueryTokens("  Jo  SMI ");
+  CM_ASSERT(tokens.size() == size_t(2));
+  CM_EXPECT_EQ(tokens[0], std::string("jo"));
+  CM_EXPECT_EQ(tokens[1], std::string("smi"));
+
+  auto phone = searchQueryTokens("+1 (415) 555-01");
+  CM_ASSERT(phone.size() == size_t(1));
+  CM_EXPECT_EQ(phone[0], std::string("141555501"));
+
+  CM_EXPECT(searchQueryTokens("   ").empty());
+  CM_EXPECT_EQ(searchQueryTokens("ann ann").size(), size_t(1));
+}
+
+CM_TEST(prefixMatchesEveryQueryToken) {
+  ContactSearchIndex index;
+  index.upsert(testing::makeNamedContact("1", "John", "Smith"));
+  index.upsert(testing::makeNamedContact("2", "Johanna", "Smythe"));
+  index.upsert(testing::makeNamedContact("3", "Mary", "Johnson"));
+
+  CM_EXPECT_EQ(sampleIds(index, "jo").size(), size_t(3));
+  CM_EXPECT_EQ(sampleIds(index, "jo sm"), (std::vector<std::string>{"2", "1"}));
+  // Smythe is one edit away, so it follows the exact match
+  CM_EXPECT_EQ(sampleIds(index, "smith"), (std::vector<std::string>{"1", "2"}));
+  CM_EXPECT(sampleIds(index, "smithereens").empty());
+  CM_EXPECT(sampleIds(index, "ohn").empty());
+}
+
+CM_TEST(typosWithinTheEditBudgetStillMatch) {
+  CM_EXPECT_EQ(maxSearchEdits(2), size_t(0));
+  CM_EXPECT_EQ(maxSearchEdits(4), size_t(1));
+  CM_EXPECT_EQ(maxSearchEdits(8), size_t(2));
+
+  ContactSearchIndex index;
+  index.upsert(testing::makeNamedContact("1", "John", "Smith"));
+  index.upsert(testing::makeNamedContact("2", "Katherine", "Oconnell"));
+  index.upsert(testing::makeNamedContact("3", "Jane", "Doe"));
+
+  // Transposition, substitution, deletion and insertion
+  CM_EXPECT_EQ(sampleIds(index, "jhon"), (std::vector<std::string>{"1"}));
+  CM_EXPECT_EQ(sampleIds(index, "smoth"), (std::vector<std::string>{"1"}));
+  CM_EXPECT_EQ(sampleIds(index, "kathrine"), (std::vector<std::string>{"2"}));
+  CM_EXPECT_EQ(sampleIds(index, "oconnnell"), (std::vector<std::string>{"2"}));
+  // A typo in a token that is still being typed
+  CM_EXPECT_EQ(sampleIds(index, "katr"), (std::vector<std::string>{"2"}));
+  // Short tokens and digits must match exactly
+  CM_EXPECT(sampleIds(index, "jk").empty());
+  CM_EXPECT(sampleIds(index, "kzthxrinq").empty());
+}
+
+CM_TEST(initialsMatchNames) {
+  ContactSearchIndex index;
+  index.upsert(testing::makeNamedContact("1", "John", "Doe"));
+  Contact middle = testing::makeNamedContact("2", "Mary", "Jones");
+  middle.middleName = "Ann";
+  middle.updateDisplayInfo();
+  index.upsert(middle);
+  index.upsert(testing::makeNamedContact("3", "Jdrew", "Kim"));
+
+  // The name that starts with the letters comes before the initials match
+  CM_EXPECT_EQ(sampleIds(index, "jd"), (std::vector<std::string>{"3", "1"}));
+  CM_EXPECT_EQ(sampleIds(index, "maj"), (std::vector<std::string>{"2"}));
+  CM_EXPECT_EQ(sampleIds(index, "mj"), (std::vector<std::string>{"2"}));
+  CM_EXPECT(sampleIds(index, "jd", SearchField::Email).empty());
+}
+
+CM_TEST(diacriticsAreFolded) {
+  ContactSearchIndex index;
+  index.upsert(testing::makeNamedContact("1", "Jos\xC3\xA9", "M\xC3\xBCller"));
+  index.upsert(testing::makeNamedContact("2", "\xC5\x81ukasz", "Stra\xC3\x9F" "e"));
+
+  CM_EXPECT_EQ(sampleIds(index, "jose"), (std::vector<std::string>{"1"}));
+  CM_EXPECT_EQ(sampleIds(index, "JOS\xC3\x89 mul"), (std::vector<std::string>{"1"}));
+  CM_EXPECT_EQ(sampleIds(index, "lukasz"), (std::vector<std::string>{"2"}));
+  CM_EXPECT_EQ(sampleIds(index, "strasse"), (std::vector<std::string>{"2"}));
+}
+
+CM_TEST(betterMatchesRankFirst) {
+  ContactSearchIndex index;
+  // Display order alone would list these a, b, c, d
+  index.upsert(testing::makeNamedContact("a", "Aaron", "Marc"));
+  index.upsert(testing::makeNamedContact("b", "Bella", "Marcus"));
+  index.upsert(testing::makeNamedContact("c", "Carl", "Mark"));
+  Contact work = testing::makeNamedContact("d", "Dana", "Ng");
+  work.organizationName = "Mark & Co";
+  index.upsert(work);
+
+  SearchResults results = index.search("mark", SearchField::All, 0, 10);
+  // Exact name, exact organization, fuzzy name (Marc, Marcus)
+  CM_EXPECT_EQ(results.identifiers, (std::vector<std::string>{"c", "d", "a", "b"}));
+  CM_ASSERT(results.scores.size() == size_t(4));
+  CM_EXPECT(results.scores[0] > results.scores[1]);
+  CM_EXPECT(results.scores[1] > results.scores[2]);
+  CM_EXPECT_EQ(index.quickSearch("mark", 2), (std::vector<std::string>{"c", "d"}));
+
+  // Prefix matches tie and fall back to display order
+  CM_EXPECT_EQ(sampleIds(index, "ma"), (std::vector<std::string>{"a", "b", "c", "d"}));
+}
+
+CM_TEST(resultsComeBackInDisplayOrderWithPaging) {
+  ContactSearchIndex index;
+  index.upsert(testing::makeNamedContact("c", "Carl", "Adams"));
+  index.upsert(testing::makeNamedContact("a", "Alice", "Adams"));
+  index.upsert(testing::makeNamedContact("b", "Bob", "Adams"));
+
+  SearchResults page = index.search("adams", SearchField::All, 1, 1);
+  CM_EXPECT_EQ(page.totalCount, size_t(3));
+  CM_EXPECT_EQ(page.identifiers, (std::vector<std::string>{"b"}));
+  CM_EXPECT_EQ(index.search("adams", SearchField::All, 5, 10).identifiers.size(), size_t(0));
+  // An empty query lists everything
+  CM_EXPECT_EQ(sampleIds(index, ""), (std::vector<std::string>{"a", "b", "c"}));
+}
+
+CM_TEST(fieldMaskRestrictsMatches) {
+  ContactSearchIndex index;
+  Contact contact = testing::makeNamedContact("1", "Ada", "Lovelace");
+  contact.organizationName = "Analytical Engines";
+  contact.emailAddresses.push_back({"1", "countess@engines.io", "work", ""});
+  contact.phoneNumbers.push_back({"1", "+1 (415) 555-0100", "mobile", ""});
+  contact.notes = "Prefers letters";
+  PostalAddress address;
+  address.city = "London";
+  contact.addresses.push_back(address);
+  index.upsert(contact);
+
+  CM_EXPECT_EQ(sampleIds(index, "engines").size(), size_t(1));
+  CM_EXPECT_EQ(sampleIds(index, "engines", SearchField::Organization).size(), size_t(1));
+  CM_EXPECT_EQ(sampleIds(index, "engines", SearchField::Email).size(), size_t(1));
+  CM_EXPECT(sampleIds(index, "engines", SearchField::Name).empty());
+  CM_EXPECT_EQ(sampleIds(index, "lond", SearchField::Address).size(), size_t(1));
+  CM_EXPECT(sampleIds(index, "lond", SearchField::Name | SearchField::Notes).empty());
+  CM_EXPECT_EQ(sampleIds(index, "letters", SearchField::Notes).size(), size_t(1));
+  CM_EXPECT_EQ(sampleIds(index, "count", SearchField::Email).size(), size_t(1));
+
+  // Phones match with and without the country code and regardless of formatting
+  CM_EXPECT_EQ(sampleIds(index, "415-555", SearchField::Phone).size(), size_t(1));
+  CM_EXPECT_EQ(sampleIds(index, "1415555", SearchField::Phone).size(), size_t(1));
+  CM_EXPECT(sampleIds(index, "555", SearchField::Phone).empty());
+  CM_EXPECT(sampleIds(index, "415", SearchField::Name).empty());
+}
+
+CM_TEST(upsertSkipsUnchangedAndReindexesChanged) {
+  ContactSearchIndex index;
+  Contact contact = testing::makeNamedContact("1", "Grace", "Hopper");
+  CM_EXPECT(index.upsert(contact));
+  CM_EXPECT(!index.upsert(contact));
+
+  contact.familyName = "Murray";
+  contact.updateDisplayInfo();
+  CM_EXPECT(index.upsert(contact));
+  CM_EXPECT(sampleIds(index, "hopper").empty());
+  CM_EXPECT_EQ(sampleIds(index, "murr").size(), size_t(1));
+  CM_EXPECT_EQ(index.size(), size_t(1));
+
+  contact.isDeleted = true;
+  CM_EXPECT(index.upsert(contact));
+  CM_EXPECT_EQ(index.size(), size_t(0));
+  CM_EXPECT_EQ(index.termCount(), size_t(0));
+}
+
+CM_TEST(syncWithRemovesMissingContacts) {
+  auto book = testing::makeSyntheticAddressBook(500);
+  ContactSearchIndex index;
+  CM_EXPECT_EQ(index.syncWith(book), size_t(500));
+  CM_EXPECT_EQ(index.syncWith(book), size_t(0));
+
+  book.erase(book.begin(), book.begin() + 100);
+  book[0].givenName = "Zebediah";
+  book[0].updateDisplayInfo();
+  CM_EXPECT_EQ(index.syncWith(book), size_t(101));
+  CM_EXPECT_EQ(index.size(), size_t(400));
+  CM_EXPECT_EQ(sampleIds(index, "zebediah"), (std::vector<std::string>{book[0].identifier}));
+}
+
+CM_TEST(indexAgreesWithLinearScan) {
+  auto book = testing::makeSyntheticAddressBook(2000);
+  ContactSearchIndex index;
+  index.syncWith(book);
+
+  for (const char *query : {"ja", "mar", "smith", "gmail", "wei ch", "acme", "engineer", "jnoes", "mraia gonzales",
+                            "ap", "wlliams", "engnieer"}) {
+    auto queryTokens = searchQueryTokens(query);
+    size_t expected = 0;
+    for (const auto &contact : book) {
+      auto tokens = searchTokensForContact(contact);
+      bool all = true;
+      for (const auto &queryToken : queryTokens) {
+        bool any = false;
+        for (const auto &token : tokens) {
+          any = any || tokenMatches(queryToken, token.text);
+        }
+        all = all && any;
+      }
+      expected += all ? 1 : 0;
+    }
+    CM_EXPECT_EQ(index.search(query, SearchField::All, 0, 10).totalCount, expected);
+  }
+}
+
+CM_TEST(indexSurvivesSaveAndLoad) {
+  auto book = testing::makeSyntheticAddressBook(300);
+  ContactSearchIndex index;
+  index.syncWith(book);
+  std::string path = testing::temporaryPath("search_index", "roundtrip");
+  CM_ASSERT(index.save(path));
+
+  ContactSearchIndex loaded;
+  CM_ASSERT(loaded.load(path));
+  CM_EXPECT_EQ(loaded.size(), index.size());
+  CM_EXPECT_EQ(loaded.termCount(), index.termCount());
+  for (const char *query : {"a", "jo", "patel", "", "555"}) {
+    CM_EXPECT_EQ(loaded.search(query, SearchField::All, 0, 20).identifiers,
+                 index.search(query, SearchField::All, 0, 20).identifiers);
+  }
+  // Loaded documents keep their fingerprints, so a resync after a cold start is a no-op
+  CM_EXPECT_EQ(loaded.syncWith(book), size_t(0));
+  std::remove(path.c_str());
+}
+
+CM_TEST(loadRejectsCorruptFiles) {
+  ContactSearchIndex index;
+  index.syncWith(testing::makeSyntheticAddressBook(50));
+  std::string path = testing::temporaryPath("search_index", "corrupt");
+  CM_ASSERT(index.save(path));
+
+  // Truncate the file in the middle of a document
+  FILE *file = std::fopen(path.c_str(), "rb");
+  CM_ASSERT(file != nullptr);
+  std::string data(4096, '\0');
+  data.resize(std::fread(&data[0], 1, data.size(), file));
+  std::fclose(file);
+  file = std::fopen(path.c_str(), "wb");
+  std::fwrite(data.data(), 1, data.size() / 2, file);
+  std::fclose(file);
+
+  ContactSearchIndex loaded;
+  CM_EXPECT(!loaded.load(path));
+  CM_EXPECT_EQ(loaded.size(), size_t(0));
+  CM_EXPECT(!loaded.load(testing::temporaryPath("search_index", "missing")));
+  std::remove(path.c_str());
+}
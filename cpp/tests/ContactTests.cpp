@@ -0,0 +1,136 @@
+//
+//  ContactTests.cpp
+//  ContactsManagerCore
+//
+
+#include "Contact.h"
+#include "ContactHashing.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+#include "TextUtils.h"
+
+using namespace contactsmanager;
+
+CM_TEST(displayNameJoinsNameComponents) {
+  Contact contact("1");
+  contact.namePrefix = "Dr.";
+  contact.givenName = " Jane ";
+  contact.familyName = "Doe";
+  contact.updateDisplayInfo();
+  CM_EXPECT_EQ(contact.displayName, std::string("Dr. Jane Doe"));
+  CM_EXPECT_EQ(contact.contactSection, std::string("D"));
+}
+
+CM_TEST(displayNameFallsBackToOrganization) {
+  Contact contact("1");
+  contact.organizationName = "Acme";
+  contact.updateDisplayInfo();
+  CM_EXPECT_EQ(contact.displayName, std::string("Acme"));
+  CM_EXPECT_EQ(contact.contactSection, std::string("A"));
+}
+
+CM_TEST(displayInfoFallsBackToPhoneThenEmail) {
+  Contact contact("1");
+  contact.emailAddresses.push_back({"1", "a@b.com", "home", ""});
+  CM_EXPECT_EQ(contact.displayInfo(), std::string("a@b.com"));
+  contact.phoneNumbers.push_back({"1", "555-1234", "mobile", ""});
+  CM_EXPECT_EQ(contact.displayInfo(), std::string("555-1234"));
+}
+
+CM_TEST(sectionIsHashForNonLetters) {
+  Contact contact("1");
+  CM_EXPECT_EQ(contact.contactSectionForName(), std::string("#"));
+  contact.familyName = "9lives";
+  CM_EXPECT_EQ(contact.contactSectionForName(), std::string("#"));
+}
+
+CM_TEST(matchStringIsLowercaseAndIncludesPhoneDigits) {
+  Contact contact("1");
+  contact.givenName = "John";
+  contact.familyName = "Doe";
+  contact.phoneNumbers.push_back({"1", "+1 (555) 123-4567", "mobile", ""});
+  contact.emailAddresses.push_back({"1", "John@Example.com", "work", ""});
+  contact.updateDisplayInfo();
+  CM_EXPECT(contact.matchString.find("john doe") != std::string::npos);
+  CM_EXPECT(contact.matchString.find("15551234567") != std::string::npos);
+  CM_EXPECT(contact.matchString.find("john@example.com") != std::string::npos);
+  CM_EXPECT(contact.matchString.find('J') == std::string::npos);
+}
+
+CM_TEST(equalityIgnoresSyncBookkeeping) {
+  auto book = testing::makeSyntheticAddressBook(20);
+  for (const auto &contact : book) {
+    Contact copy = contact;
+    copy.lastSyncedAt = 123;
+    copy.dirtyTime = 456;
+    CM_EXPECT(contact.isEqualToContact(copy));
+    copy.phoneNumbers.push_back({copy.identifier, "1", "", ""});
+    CM_EXPECT(!contact.isEqualToContact(copy));
+  }
+}
+
+CM_TEST(equalityIgnoresPhoneFormatting) {
+  Contact contact("1");
+  contact.phoneNumbers.push_back({"1", "+1 (555) 123-4567", "mobile", ""});
+  Contact copy = contact;
+  copy.phoneNumbers.front().value = "+15551234567";
+  CM_EXPECT(contact.isEqualToContact(copy));
+  // A national number is the same number in its region
+  copy.phoneNumbers.front().value = "5551234567";
+  CM_EXPECT(contact.isEqualToContact(copy, 1));
+  CM_EXPECT(contactHash128(contact, 1) == contactHash128(copy, 1));
+  CM_EXPECT(!contact.isEqualToContact(copy, 44));
+  copy.phoneNumbers.front().value = "5551234568";
+  CM_EXPECT(!contact.isEqualToContact(copy, 1));
+}
+
+CM_TEST(defaultCallingCodeAppliesToEqualityAndHashing) {
+  Contact contact("1");
+  contact.phoneNumbers.push_back({"1", "+1 (555) 123-4567", "mobile", ""});
+  Contact national = contact;
+  national.phoneNumbers.front().value = "(555) 123-4567";
+  CM_EXPECT(!national.isEqualToContact(contact));
+
+  setDefaultCallingCode(1);
+  CM_EXPECT(national.isEqualToContact(contact));
+  CM_EXPECT(contactHash128(national) == contactHash128(contact));
+  CM_EXPECT(generateContactHash(national) == generateContactHash(contact));
+  setDefaultCallingCode(0);
+  CM_EXPECT(!(contactHash128(national) == contactHash128(contact)));
+}
+
+CM_TEST(equalContactsHashEqually) {
+  // "1234567" suffix-matches both; without a calling code equality must not, or it stops being transitive
+  Contact national("1");
+  national.phoneNumbers.push_back({"1", "123 4567", "mobile", ""});
+  Contact american = national;
+  american.phoneNumbers.front().value = "+1 1234567";
+  Contact british = national;
+  british.phoneNumbers.front().value = "+44 1234567";
+  CM_EXPECT(!national.isEqualToContact(american));
+  CM_EXPECT(!national.isEqualToContact(british));
+  CM_EXPECT(national.isEqualToContact(american, 1));
+  CM_EXPECT(!national.isEqualToContact(british, 1));
+
+  Contact reformatted = american;
+  reformatted.phoneNumbers.front().value = "+11234567";
+  CM_EXPECT(american.isEqualToContact(reformatted));
+  CM_EXPECT(contactHash128(american) == contactHash128(reformatted));
+  CM_EXPECT(!(contactHash128(national) == contactHash128(american)));
+}
+
+CM_TEST(syntheticBookIsDeterministic) {
+  auto first = testing::makeSyntheticAddressBook(50);
+  auto second = testing::makeSyntheticAddressBook(50);
+  CM_ASSERT(first.size() == second.size());
+  for (size_t i = 0; i < first.size(); ++i) {
+    CM_EXPECT(first[i].isEqualToContact(second[i]));
+  }
+}
+
+CM_TEST(containsCaseInsensitive) {
+  CM_EXPECT(text::containsCaseInsensitive("Hello World", "o wor"));
+  CM_EXPECT(text::containsCaseInsensitive("abc", ""));
+  CM_EXPECT(!text::containsCaseInsensitive("abc", "abcd"));
+  CM_EXPECT(!text::containsCaseInsensitive("abc", "x"));
+}
@@ -0,0 +1,173 @@
+//
+//  ContactUploadPipelineTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactUploadPipeline.h"
+#include "ServerContactJson.h"
+#include "SimulatedSyncServer.h"
+#include "SimulatedUploadTransport.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace std::chrono_literals;
+
+namespace {
+
+const ServerContactContext kContext{"org-1", "source-1"};
+
+struct Harness {
+  std::vector<Contact> book;
+  testing::SimulatedSyncServer server;
+  testing::SimulatedUploadTransport transport;
+
+  Harness(size_t size, std::chrono::microseconds roundTrip)
+      : book(testing::makeSyntheticAddressBook(size)),
+        transport({roundTrip, 0}, [this](const UploadRequest &request, std::string &) {
+          return server.handleBulkCreate(request.body).ok;
+        }) {}
+
+  ContactUploadPipeline::BatchEncoder encoder() const {
+    return [this](size_t offset, size_t count) {
+      return UploadRequest{encodeBulkCreateBody(book.data() + offset, count, kContext, false)};
+    };
+  }
+};
+
+UploadPipelineOptions smallBatches() {
+  UploadPipelineOptions options;
+  options.initialBatchSize = 20;
+  options.minBatchSize = 5;
+  options.maxBatchSize = 50;
+  options.uploadTimeout = 1000ms;
+  options.targetLatency = 20ms;
+  return options;
+}
+
+} // namespace
+
+CM_TEST(sizerFollowsLatency) {
+  UploadPipelineOptions options;
+  options.initialBatchSize = 100;
+  options.minBatchSize = 10;
+  options.maxBatchSize = 1000;
+  options.targetLatency = 1000ms;
+  AdaptiveBatchSizer sizer(options);
+
+  // Well inside the target: grows, but at most doubles per batch
+  sizer.recordSuccess(100, 10000, 100ms);
+  CM_EXPECT_EQ(sizer.batchSize(), size_t(200));
+  // Twice the target: moves halfway towards half the batch
+  sizer.recordSuccess(200, 20000, 2000ms);
+  CM_EXPECT_EQ(sizer.batchSize(), size_t(150));
+  sizer.recordFailure();
+  CM_EXPECT_EQ(sizer.batchSize(), size_t(75));
+  for (int i = 0; i < 10; ++i) {
+    sizer.recordFailure();
+  }
+  CM_EXPECT_EQ(sizer.batchSize(), size_t(10));
+  for (int i = 0; i < 20; ++i) {
+    sizer.recordSuccess(sizer.batchSize(), sizer.batchSize() * 100, 1ms);
+  }
+  CM_EXPECT_EQ(sizer.batchSize(), size_t(1000));
+}
+
+CM_TEST(sizerCapsBodyBytes) {
+  UploadPipelineOptions options;
+  options.initialBatchSize = 100;
+  options.maxBatchSize = 1000;
+  options.maxBodyBytes = 64 * 1024;
+  options.targetLatency = 1000ms;
+  AdaptiveBatchSizer sizer(options);
+  // 1 KiB per contact and a fast server: the body cap wins over latency
+  sizer.recordSuccess(100, 100 * 1024, 10ms);
+  CM_EXPECT_EQ(sizer.batchSize(), size_t(64));
+}
+
+CM_TEST(uploadsEveryContactWithBoundedConcurrency) {
+  Harness harness(600, 3000us);
+  UploadPipelineOptions options = smallBatches();
+  options.maxInFlight = 3;
+  ContactUploadPipeline pipeline(harness.transport, options);
+
+  std::vector<int> acknowledged(harness.book.size(), 0);
+  UploadReport report = pipeline.run(harness.book.size(), harness.encoder(),
+                                     [&](const UploadBatch &batch, const UploadResponse &) {
+                                       for (size_t i = 0; i < batch.count; ++i) {
+                                         acknowledged[batch.offset + i]++;
+                                       }
+                                     });
+  CM_EXPECT(report.ok);
+  CM_EXPECT_EQ(report.uploaded, harness.book.size());
+  CM_EXPECT_EQ(report.retries, size_t(0));
+  CM_EXPECT_EQ(report.batches, harness.transport.requestCount());
+  CM_EXPECT_EQ(harness.server.size(), harness.book.size());
+  CM_EXPECT_EQ(harness.server.bytesReceived(), report.bytes);
+  CM_EXPECT(harness.transport.maxConcurrent() <= options.maxInFlight);
+  CM_EXPECT(harness.transport.maxConcurrent() > 1);
+  for (int count : acknowledged) {
+    CM_EXPECT_EQ(count, 1);
+  }
+}
+
+CM_TEST(failedAndTimedOutBatchesAreRetriedInHalves) {
+  Harness harness(300, 1000us);
+  UploadPipelineOptions options = smallBatches();
+  options.uploadTimeout = 30ms;
+  harness.transport.failNext(2);
+  ContactUploadPipeline pipeline(harness.transport, options);
+  UploadReport report = pipeline.run(harness.book.size(), harness.encoder());
+  CM_EXPECT(report.ok);
+  CM_EXPECT(report.retries >= 4);
+  CM_EXPECT_EQ(harness.server.size(), harness.book.size());
+
+  Harness stalled(300, 1000us);
+  stalled.transport.stallNext(1);
+  ContactUploadPipeline stalledPipeline(stalled.transport, options);
+  auto started = std::chrono::steady_clock::now();
+  report = stalledPipeline.run(stalled.book.size(), stalled.encoder());
+  CM_EXPECT(report.ok);
+  CM_EXPECT(report.retries >= 2);
+  CM_EXPECT(std::chrono::steady_clock::now() - started >= options.uploadTimeout);
+  CM_EXPECT_EQ(stalled.server.size(), stalled.book.size());
+}
+
+CM_TEST(persistentFailureStopsTheUpload) {
+  Harness harness(200, 500us);
+  UploadPipelineOptions options = smallBatches();
+  options.maxAttempts = 2;
+  harness.transport.failNext(1000);
+  ContactUploadPipeline pipeline(harness.transport, options);
+  UploadReport report = pipeline.run(harness.book.size(), harness.encoder());
+  CM_EXPECT(!report.ok);
+  CM_EXPECT(!report.cancelled);
+  CM_EXPECT_EQ(report.uploaded, size_t(0));
+  CM_EXPECT_EQ(harness.server.size(), size_t(0));
+  // The first wave plus the halves of the first failure, not the whole book
+  CM_EXPECT(report.batches < harness.book.size() / options.minBatchSize);
+}
+
+CM_TEST(cancelWaitsForBatchesInFlight) {
+  Harness harness(1000, 2000us);
+  UploadPipelineOptions options = smallBatches();
+  ContactUploadPipeline pipeline(harness.transport, options);
+  UploadReport report = pipeline.run(harness.book.size(), harness.encoder(),
+                                     [&](const UploadBatch &, const UploadResponse &) { pipeline.cancel(); });
+  CM_EXPECT(!report.ok);
+  CM_EXPECT(report.cancelled);
+  CM_EXPECT(report.uploaded < harness.book.size());
+  // Every request that was sent finished before run() returned
+  CM_EXPECT_EQ(report.batches, harness.transport.requestCount());
+  CM_EXPECT_EQ(harness.server.size(), report.uploaded);
+
+  // The cancel does not carry over: the same pipeline finishes the upload
+  report = pipeline.run(harness.book.size(), harness.encoder());
+  CM_EXPECT(report.ok);
+  CM_EXPECT(!report.cancelled);
+  CM_EXPECT_EQ(harness.server.size(), harness.book.size());
+}
@@ -0,0 +1,217 @@
+//
+//  FeedEngineTests.cpp
+//  ContactsManagerCore
+//
+
+#include "FeedCursor.h"
+#include "FeedEngine.h"
+#include "SimulatedFeedServer.h"
+#include "TestHarness.h"
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+const char *const kFeed = "getFeed";
+
+void publishAll(testing::SimulatedFeedServer &server, const std::vector<SocialEvent> &events) {
+  for (const SocialEvent &event : events) {
+    server.publish(event);
+  }
+}
+
+SocialEvent newEvent(const std::string &eventId, double createdAt) {
+  SocialEvent event;
+  event.eventId = eventId;
+  event.createdAt = createdAt;
+  return event;
+}
+
+std::string idAt(const FeedEngine &engine, size_t position) {
+  std::optional<SocialEvent> event = engine.itemAt(position);
+  return event ? event->eventId : std::string();
+}
+
+} // namespace
+
+CM_TEST(cursorsRoundTripAndStayWithTheirFeed) {
+  FeedPosition position{1700000000.5, "event-42"};
+  std::string cursor = encodeFeedCursor(kFeed, position);
+  std::optional<FeedPosition> decoded = decodeFeedCursor(kFeed, cursor);
+  CM_ASSERT(decoded.has_value());
+  CM_EXPECT_EQ(decoded->createdAt, position.createdAt);
+  CM_EXPECT_EQ(decoded->identifier, position.identifier);
+
+  CM_EXPECT(!decodeFeedCursor("getUpcomingEvents", cursor));
+  CM_EXPECT(!decodeFeedCursor(kFeed, cursor.substr(0, cursor.size() - 4)));
+  CM_EXPECT(!decodeFeedCursor(kFeed, "20"));
+  CM_EXPECT(!decodeFeedCursor(kFeed, ""));
+
+  CM_EXPECT(feedPositionBefore(FeedPosition{2, "a"}, FeedPosition{1, "z"}));
+  CM_EXPECT(feedPositionBefore(FeedPosition{1, "b"}, FeedPosition{1, "a"}));
+  CM_EXPECT(!feedPositionBefore(FeedPosition{1, "a"}, FeedPosition{1, "a"}));
+}
+
+CM_TEST(cursorPagesDoNotShiftWhenEventsArePublished) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(50);
+  testing::SimulatedFeedServer cursorServer(kFeed);
+  testing::SimulatedFeedServer offsetServer(kFeed, testing::FeedPaging::Offset);
+  publishAll(cursorServer, events);
+  publishAll(offsetServer, events);
+
+  std::optional<FeedPage> cursorFirst = cursorServer.page("", 10);
+  std::optional<FeedPage> offsetFirst = offsetServer.page("", 10);
+  CM_ASSERT(cursorFirst && offsetFirst);
+  CM_EXPECT_EQ(cursorFirst->items.front().eventId, events[0].eventId);
+
+  for (int i = 0; i < 3; ++i) {
+    SocialEvent fresh = newEvent("fresh-" + std::to_string(i), events[0].createdAt + 60 * (i + 1));
+    cursorServer.publish(fresh);
+    offsetServer.publish(fresh);
+  }
+
+  std::optional<FeedPage> cursorSecond = cursorServer.page(cursorFirst->nextCursor, 10);
+  std::optional<FeedPage> offsetSecond = offsetServer.page(offsetFirst->nextCursor, 10);
+  CM_ASSERT(cursorSecond && offsetSecond);
+  for (size_t i = 0; i < 10; ++i) {
+    CM_EXPECT_EQ(cursorSecond->items[i].eventId, events[10 + i].eventId);
+  }
+  // The offset page repeats the last three items of the first page
+  CM_EXPECT_EQ(offsetSecond->items[0].eventId, events[7].eventId);
+
+  CM_EXPECT(!cursorServer.page(encodeFeedCursor("getForYouFeed", FeedPosition{1, "x"}), 10));
+  CM_EXPECT(!offsetServer.page("ten", 10));
+}
+
+CM_TEST(enginePrefetchesBeforeTheViewportReachesTheEnd) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(100);
+  testing::SimulatedFeedServer server(kFeed);
+  publishAll(server, events);
+  std::atomic<int> notifications{0};
+  FeedEngineOptions options;
+  options.pageSize = 20;
+  options.prefetchDistance = 10;
+  FeedEngine engine(server, options, [&] { notifications++; });
+
+  engine.setViewport(0, 10);
+  CM_EXPECT_EQ(server.requestCount(), size_t(1));
+  CM_EXPECT_EQ(engine.size(), size_t(20));
+  CM_EXPECT_EQ(notifications.load(), 1);
+
+  // Ten items short of the end is where the next page is requested
+  engine.setViewport(0, 11);
+  CM_EXPECT_EQ(server.requestCount(), size_t(2));
+  CM_EXPECT_EQ(engine.size(), size_t(40));
+
+  engine.setViewport(5, 10);
+  CM_EXPECT_EQ(server.requestCount(), size_t(2));
+
+  engine.setViewport(90, 10);
+  CM_EXPECT_EQ(engine.size(), size_t(100));
+  CM_EXPECT(!engine.hasMore());
+  for (size_t i = 0; i < events.size(); ++i) {
+    CM_EXPECT_EQ(idAt(engine, i), events[i].eventId);
+  }
+  CM_EXPECT(!engine.itemAt(100));
+  CM_EXPECT_EQ(engine.stats().duplicatesDropped, size_t(0));
+}
+
+CM_TEST(engineDropsEventsAlreadyPlaced) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(60);
+  testing::SimulatedFeedServer server(kFeed, testing::FeedPaging::Offset);
+  publishAll(server, events);
+  FeedEngineOptions options;
+  options.pageSize = 20;
+  options.prefetchDistance = 0;
+  FeedEngine engine(server, options);
+
+  engine.setViewport(0, 10);
+  CM_EXPECT_EQ(engine.size(), size_t(20));
+  for (int i = 0; i < 5; ++i) {
+    server.publish(newEvent("fresh-" + std::to_string(i), events[0].createdAt + 60 * (i + 1)));
+  }
+  engine.setViewport(15, 10);
+  CM_EXPECT_EQ(engine.stats().duplicatesDropped, size_t(5));
+  CM_EXPECT_EQ(engine.size(), size_t(35));
+
+  std::set<std::string> seen;
+  for (size_t i = 0; i < engine.size(); ++i) {
+    CM_EXPECT(seen.insert(idAt(engine, i)).second);
+  }
+  CM_EXPECT_EQ(idAt(engine, 20), events[20].eventId);
+}
+
+CM_TEST(engineEvictsFarPagesAndRefetchesThemInPlace) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(1000);
+  testing::SimulatedFeedServer server(kFeed);
+  publishAll(server, events);
+  FeedEngineOptions options;
+  options.pageSize = 20;
+  options.prefetchDistance = 10;
+  options.maxResidentItems = 60;
+  FeedEngine engine(server, options);
+
+  for (size_t first = 0; first <= 500; first += 5) {
+    engine.setViewport(first, 10);
+    CM_EXPECT(engine.stats().residentItems <= options.maxResidentItems);
+    CM_EXPECT_EQ(idAt(engine, first), events[first].eventId);
+  }
+  CM_EXPECT(engine.stats().pagesEvicted > 0);
+  CM_EXPECT(!engine.itemAt(0));
+  size_t size = engine.size();
+
+  // Gone from the feed while its page was evicted, and a newer event on top
+  CM_EXPECT(server.remove(events[3].eventId));
+  server.publish(newEvent("fresh", events[0].createdAt + 60));
+  size_t requests = server.requestCount();
+  engine.setViewport(0, 10);
+  CM_EXPECT(server.requestCount() > requests);
+  CM_EXPECT(engine.stats().pagesRefetched > 0);
+  CM_EXPECT_EQ(engine.size(), size);
+  CM_EXPECT_EQ(idAt(engine, 0), events[0].eventId);
+  CM_EXPECT(!engine.itemAt(3));
+  CM_EXPECT_EQ(idAt(engine, 4), events[4].eventId);
+  CM_EXPECT_EQ(idAt(engine, 19), events[19].eventId);
+  CM_EXPECT(!engine.itemAt(500));
+}
+
+CM_TEST(engineRetriesAFailedPageOnTheNextViewportChange) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(40);
+  testing::SimulatedFeedServer server(kFeed, testing::FeedPaging::Cursor, std::chrono::milliseconds(2));
+  publishAll(server, events);
+  FeedEngineOptions options;
+  options.pageSize = 20;
+  {
+    FeedEngine engine(server, options);
+    server.failNext(1);
+    server.hold();
+    engine.setViewport(0, 10);
+    CM_EXPECT(engine.isFetching());
+    server.release();
+    server.waitIdle();
+    CM_EXPECT_EQ(engine.size(), size_t(0));
+    CM_EXPECT_EQ(engine.stats().failedFetches, size_t(1));
+    CM_EXPECT(!engine.isFetching());
+
+    engine.setViewport(0, 10);
+    server.waitIdle();
+    CM_EXPECT_EQ(engine.size(), size_t(20));
+    CM_EXPECT_EQ(idAt(engine, 0), events[0].eventId);
+
+    engine.reload();
+    server.waitIdle();
+    CM_EXPECT_EQ(engine.size(), size_t(20));
+  }
+
+  // Destroying the engine with a page in flight waits for it
+  {
+    FeedEngine engine(server, options);
+    engine.setViewport(0, 30);
+  }
+  server.waitIdle();
+}
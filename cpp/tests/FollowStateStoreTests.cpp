@@ -0,0 +1,258 @@
+//
+//  FollowStateStoreTests.cpp
+//  ContactsManagerCore
+//
+
+#include "FollowStateStore.h"
+#include "JsonValue.h"
+#include "SimulatedApiServer.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using namespace std::chrono_literals;
+
+namespace {
+
+const char *const kBatchEndpoint = "/api/v1/social/follow/batch";
+
+FollowStateOptions batchOptions() {
+  FollowStateOptions options;
+  options.batchEndpoint = kBatchEndpoint;
+  return options;
+}
+
+// Server side follow list, updated by the batch and per-user routes
+class FollowServer {
+public:
+  explicit FollowServer(testing::SimulatedApiServer &server) {
+    FollowStateOptions defaults;
+    server.route("POST", defaults.followEndpoint, [this](const ApiRequest &request) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      following_.insert(request.parameters.front().second);
+      return ApiResponse{200, "{\"success\":true}", ""};
+    });
+    server.route("POST", defaults.unfollowEndpoint, [this](const ApiRequest &request) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      following_.erase(request.parameters.front().second);
+      return ApiResponse{200, "{\"success\":true}", ""};
+    });
+    server.route("POST", kBatchEndpoint, [this](const ApiRequest &request) {
+      std::optional<testing::JsonValue> body = testing::JsonValue::parse(request.body);
+      const testing::JsonValue *follow = body ? body->find("follow") : nullptr;
+      const testing::JsonValue *unfollow = body ? body->find("unfollow") : nullptr;
+      if (!follow || !unfollow) {
+        return ApiResponse{400, "{}", ""};
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto &userId : follow->array) {
+        following_.insert(userId.string);
+      }
+      for (const auto &userId : unfollow->array) {
+        following_.erase(userId.string);
+      }
+      batchSizes_.push_back(follow->array.size() + unfollow->array.size());
+      return ApiResponse{200, "{\"success\":true}", ""};
+    });
+  }
+
+  std::set<std::string> following() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return following_;
+  }
+
+  std::vector<size_t> batchSizes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batchSizes_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::set<std::string> following_;
+  std::vector<size_t> batchSizes_;
+};
+
+std::string userId(size_t n) {
+  return "user-" + std::to_string(n);
+}
+
+} // namespace
+
+CM_TEST(followAllIsOneBatchedRequest) {
+  testing::SimulatedApiServer server(5ms);
+  FollowServer followServer(server);
+  FollowStateStore store(server, batchOptions());
+  store.setFollowing({});
+
+  for (size_t i = 0; i < 50; ++i) {
+    store.follow(userId(i));
+    CM_EXPECT(store.isFollowing(userId(i)) == true);
+  }
+  CM_EXPECT(store.isFollowing(userId(50)) == false);
+  CM_EXPECT_EQ(server.requestCount(), size_t(0));
+
+  store.flush();
+  // Answered locally while the batch is in flight
+  CM_EXPECT(store.isFlushing());
+  CM_EXPECT(store.isFollowing(userId(7)) == true);
+  server.waitIdle();
+
+  CM_EXPECT_EQ(server.requestCount(), size_t(1));
+  CM_EXPECT_EQ(followServer.following().size(), size_t(50));
+  FollowStateStats stats = store.stats();
+  CM_EXPECT_EQ(stats.changesSent, size_t(50));
+  CM_EXPECT_EQ(stats.pending, size_t(0));
+  CM_EXPECT(!store.isFlushing());
+}
+
+CM_TEST(togglesCoalesceToTheFinalState) {
+  testing::SimulatedApiServer server(1ms);
+  FollowServer followServer(server);
+  FollowStateStore store(server, batchOptions());
+  store.setFollowing({"user-a"});
+
+  store.follow("user-b");
+  store.unfollow("user-b");
+  store.follow("user-c");
+  store.unfollow("user-c");
+  store.follow("user-c");
+  store.unfollow("user-a");
+  store.follow("user-a");
+  store.follow("user-a");
+
+  CM_EXPECT(store.isFollowing("user-b") == false);
+  CM_EXPECT(store.isFollowing("user-c") == true);
+  CM_EXPECT(store.isFollowing("user-a") == true);
+  CM_EXPECT_EQ(store.stats().pending, size_t(1));
+  CM_EXPECT_EQ(store.stats().coalesced, size_t(3));
+
+  store.flush();
+  server.waitIdle();
+  CM_EXPECT_EQ(server.requestCount(), size_t(1));
+  CM_EXPECT(followServer.batchSizes() == std::vector<size_t>{1});
+  CM_EXPECT(followServer.following() == std::set<std::string>{"user-c"});
+
+  // Nothing queued, nothing sent
+  store.flush();
+  server.waitIdle();
+  CM_EXPECT_EQ(server.requestCount(), size_t(1));
+}
+
+CM_TEST(failedBatchRollsBackToConfirmedState) {
+  testing::SimulatedApiServer server(2ms);
+  FollowServer followServer(server);
+  std::mutex mutex;
+  std::vector<std::string> rolledBack;
+  FollowStateStore store(server, batchOptions(),
+                         [&](const std::vector<std::string> &, const std::vector<std::string> &reverted) {
+                           std::lock_guard<std::mutex> lock(mutex);
+                           rolledBack.insert(rolledBack.end(), reverted.begin(), reverted.end());
+                         });
+  store.setFollowing({"user-a"});
+
+  store.follow("user-b");
+  store.unfollow("user-a");
+  store.follow("user-c");
+  server.failNext(1);
+  store.flush();
+  // Changed again while the failing batch is in flight
+  store.unfollow("user-c");
+  server.waitIdle();
+
+  CM_EXPECT(store.isFollowing("user-a") == true);
+  CM_EXPECT(store.isFollowing("user-b") == false);
+  CM_EXPECT(store.isFollowing("user-c") == false);
+  std::sort(rolledBack.begin(), rolledBack.end());
+  CM_EXPECT(rolledBack == (std::vector<std::string>{"user-a", "user-b"}));
+  CM_EXPECT_EQ(store.stats().rolledBack, size_t(2));
+  // user-c is back where the server has it, so nothing is left to send
+  CM_EXPECT(!store.hasPendingChanges());
+  CM_EXPECT(followServer.following().empty());
+}
+
+CM_TEST(changesQueuedDuringAFlushGoOutNext) {
+  testing::SimulatedApiServer server(3ms);
+  FollowServer followServer(server);
+  FollowStateOptions options = batchOptions();
+  options.maxBatchSize = 20;
+  FollowStateStore store(server, options);
+
+  for (size_t i = 0; i < 45; ++i) {
+    store.follow(userId(i));
+  }
+  CM_EXPECT(!store.isFollowing(userId(99)).has_value());
+  store.flush();
+  store.unfollow(userId(0));
+  store.follow(userId(100));
+  store.flush();
+  server.waitIdle();
+
+  // 45 split by the batch size, then the two made during the first batch
+  std::vector<size_t> sizes = followServer.batchSizes();
+  CM_EXPECT_EQ(server.requestCount(), size_t(3));
+  CM_EXPECT_EQ(sizes.size(), size_t(3));
+  std::set<std::string> following = followServer.following();
+  CM_EXPECT_EQ(following.size(), size_t(45));
+  CM_EXPECT(following.count(userId(0)) == 0);
+  CM_EXPECT(following.count(userId(100)) == 1);
+  CM_EXPECT(store.isFollowing(userId(0)) == false);
+
+  // A failure stops the chain until the next flush
+  for (size_t i = 200; i < 250; ++i) {
+    store.follow(userId(i));
+  }
+  server.failNext(1);
+  store.flush();
+  server.waitIdle();
+  CM_EXPECT_EQ(server.requestCount(), size_t(4));
+  CM_EXPECT_EQ(store.stats().pending, size_t(30));
+  store.flush();
+  server.waitIdle();
+  CM_EXPECT_EQ(followServer.following().size(), size_t(75));
+}
+
+CM_TEST(withoutABatchEndpointChangesGoOutPerUser) {
+  testing::SimulatedApiServer server(2ms);
+  FollowServer followServer(server);
+  std::mutex mutex;
+  std::vector<std::string> rolledBack;
+  FollowStateStore store(server, {},
+                         [&](const std::vector<std::string> &, const std::vector<std::string> &reverted) {
+                           std::lock_guard<std::mutex> lock(mutex);
+                           rolledBack.insert(rolledBack.end(), reverted.begin(), reverted.end());
+                         });
+  store.setFollowing({"user-a"});
+
+  store.follow("user-b");
+  store.unfollow("user-b");
+  store.follow("user-c");
+  store.unfollow("user-a");
+  store.follow("user-d");
+  store.flush();
+  server.waitIdle();
+
+  // One call per final change, none for the toggle that cancelled out
+  CM_EXPECT_EQ(server.requestCount(), size_t(3));
+  CM_EXPECT(followServer.following() == (std::set<std::string>{"user-c", "user-d"}));
+  CM_EXPECT(followServer.batchSizes().empty());
+
+  // Only the user whose call failed is rolled back
+  store.follow("user-e");
+  server.failNext(1);
+  store.flush();
+  server.waitIdle();
+  store.follow("user-f");
+  store.flush();
+  server.waitIdle();
+  CM_EXPECT(rolledBack == std::vector<std::string>{"user-e"});
+  CM_EXPECT(store.isFollowing("user-e") == false);
+  CM_EXPECT(store.isFollowing("user-f") == true);
+  CM_EXPECT(followServer.following() == (std::set<std::string>{"user-c", "user-d", "user-f"}));
+  CM_EXPECT(!store.hasPendingChanges());
+}
@@ -0,0 +1,99 @@
+//
+//  FollowingSetTests.cpp
+//  ContactsManagerCore
+//
+
+#include "BinaryFile.h"
+#include "FollowingSet.h"
+#include "TestHarness.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+std::vector<std::string> userIds(size_t first, size_t count) {
+  std::vector<std::string> ids;
+  for (size_t i = first; i < first + count; ++i) {
+    ids.push_back("user-" + std::to_string(i));
+  }
+  return ids;
+}
+
+} // namespace
+
+CM_TEST(answersMembershipExactly) {
+  FollowingSet set;
+  std::vector<std::string> following = userIds(0, 5000);
+  following.push_back("user-7");
+  set.assign(following);
+  CM_EXPECT_EQ(set.size(), size_t(5000));
+
+  for (const std::string &userId : userIds(0, 5000)) {
+    CM_EXPECT(set.contains(userId));
+  }
+  size_t wrong = 0;
+  for (const std::string &userId : userIds(5000, 50000)) {
+    wrong += set.contains(userId) ? 1 : 0;
+  }
+  CM_EXPECT_EQ(wrong, size_t(0));
+  CM_EXPECT(!set.contains(""));
+
+  std::vector<std::string> screen = {"user-1", "user-90000", "user-4999", "someone"};
+  CM_EXPECT(set.containsEach(screen) == (std::vector<bool>{true, false, true, false}));
+}
+
+CM_TEST(followsAndUnfollowsUpdateInPlace) {
+  FollowingSet set;
+  set.assign(userIds(0, 10));
+  CM_EXPECT(set.add("user-100"));
+  CM_EXPECT(!set.add("user-100"));
+  CM_EXPECT(set.contains("user-100"));
+  CM_EXPECT(set.remove("user-3"));
+  CM_EXPECT(!set.remove("user-3"));
+  CM_EXPECT(!set.contains("user-3"));
+  CM_EXPECT_EQ(set.size(), size_t(10));
+
+  // Growing far past the size the filter was built for
+  for (const std::string &userId : userIds(1000, 20000)) {
+    set.add(userId);
+  }
+  for (const std::string &userId : userIds(1000, 20000)) {
+    CM_EXPECT(set.contains(userId));
+  }
+  for (const std::string &userId : userIds(1000, 15000)) {
+    set.remove(userId);
+  }
+  CM_EXPECT_EQ(set.size(), size_t(5010));
+  CM_EXPECT(!set.contains("user-1000"));
+  CM_EXPECT(set.contains("user-20999"));
+  CM_EXPECT(set.contains("user-0"));
+  // Eight bytes per hash and a filter of about 12 bits per entry
+  CM_EXPECT(set.memoryBytes() < set.size() * 16);
+}
+
+CM_TEST(savesAndLoadsTheSet) {
+  FollowingSet set;
+  set.assign(userIds(0, 300));
+  std::string path = testing::temporaryPath("following_set", "roundtrip");
+  CM_ASSERT(set.save(path));
+
+  FollowingSet loaded;
+  CM_ASSERT(loaded.load(path));
+  CM_EXPECT_EQ(loaded.size(), size_t(300));
+  CM_EXPECT(loaded.contains("user-299"));
+  CM_EXPECT(!loaded.contains("user-300"));
+
+  std::string data;
+  CM_ASSERT(binary::readFile(path, data));
+  data.resize(data.size() - 1);
+  CM_ASSERT(binary::writeFileAtomically(path, data));
+  CM_EXPECT(!loaded.load(path));
+  CM_EXPECT_EQ(loaded.size(), size_t(0));
+  CM_EXPECT(!loaded.contains("user-1"));
+  CM_EXPECT(!loaded.load(testing::temporaryPath("following_set", "missing")));
+  std::remove(path.c_str());
+}
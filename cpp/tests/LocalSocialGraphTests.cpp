@@ -0,0 +1,163 @@
+//
+//  LocalSocialGraphTests.cpp
+//  ContactsManagerCore
+//
+
+#include "LocalSocialGraph.h"
+#include "SyntheticAddressBook.h"
+#include "SyntheticSocialGraph.h"
+#include "TestHarness.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+Contact person(const std::string &identifier, const std::string &given, const std::string &family,
+               const std::string &phone, const std::string &email, const std::string &organization = {}) {
+  Contact contact(identifier);
+  contact.givenName = given;
+  contact.familyName = family;
+  contact.organizationName = organization;
+  if (!phone.empty()) {
+    contact.phoneNumbers.push_back({identifier, phone, "mobile", ""});
+  }
+  if (!email.empty()) {
+    contact.emailAddresses.push_back({identifier, email, "work", ""});
+  }
+  return contact;
+}
+
+CanonicalContact user(const std::string &identifier, const std::string &phone, const std::string &email) {
+  CanonicalContact contact;
+  contact.identifier = identifier;
+  contact.phone = phone;
+  contact.email = email;
+  return contact;
+}
+
+FollowRelationship follow(const CanonicalContact &other, bool userFollows) {
+  FollowRelationship relationship;
+  relationship.followerId = userFollows ? "user-self" : other.identifier;
+  relationship.followedId = userFollows ? other.identifier : "user-self";
+  relationship.userId = other.identifier;
+  (userFollows ? relationship.followed : relationship.follower) = other;
+  return relationship;
+}
+
+struct Fixture {
+  std::vector<Contact> book;
+  std::vector<FollowRelationship> following;
+  std::vector<FollowRelationship> followers;
+  std::unordered_map<std::string, uint32_t> interactions;
+
+  Fixture() {
+    Contact self = person("me", "Sam", "Lowe", "555-100-0000", "sam@initech.com", "Initech");
+    self.relations.push_back({"me", "Carol Danvers", "spouse"});
+    book = {
+        self,
+        person("a", "Ann", "Ito", "555-200-0001", "ann@initech.com", "Initech"),
+        person("b", "Bo", "Berg", "555-200-0002", "bo@gmail.com"),
+        person("c", "Carol", "Danvers", "", "carol@gmail.com"),
+        person("e", "Eve", "Ek", "", "eve@hooli.com", "Hooli"),
+    };
+    interactions = {{"b", 50}, {"a", 5}};
+    following = {follow(user("user-e", "", "EVE@hooli.com"), true)};
+    followers = {follow(user("user-a", "+15552000001", ""), false)};
+  }
+
+  LocalSocialGraph graph(double serverRankWeight = 0.3) const {
+    SocialGraphOptions options;
+    options.defaultCountryCode = 1;
+    options.selfContactId = "me";
+    options.serverRankWeight = serverRankWeight;
+    return LocalSocialGraph(book, following, followers, interactions, options);
+  }
+};
+
+} // namespace
+
+CM_TEST(featuresComeFromTheBookAndFollowLists) {
+  Fixture fixture;
+  LocalSocialGraph graph = fixture.graph();
+  CM_EXPECT_EQ(graph.contactCount(), size_t(5));
+
+  CandidateFeatures stranger = graph.featuresFor(user("user-x", "+15559999999", "x@yahoo.com"));
+  CM_EXPECT(!stranger.inAddressBook && !stranger.followsYou && !stranger.alreadyFollowing);
+  CM_EXPECT_EQ(stranger.domainAffinity, 0.0);
+
+  CandidateFeatures bo = graph.featuresFor(user("user-b", "+1 555 200 0002", ""));
+  CM_EXPECT(bo.inAddressBook);
+  CM_EXPECT(bo.interactions > 0.999);
+  CM_EXPECT(!bo.sameEmailDomainAsYou);
+
+  CandidateFeatures ann = graph.featuresFor(user("user-a", "", ""));
+  CM_EXPECT(ann.followsYou);
+  // Found through the follower's expanded phone number
+  CandidateFeatures annByEmail = graph.featuresFor(user("other-id", "", "Ann@Initech.com"));
+  CM_EXPECT(annByEmail.followsYou && annByEmail.inAddressBook);
+  CM_EXPECT(annByEmail.sameOrganizationAsYou && annByEmail.sameEmailDomainAsYou);
+  CM_EXPECT(annByEmail.interactions > 0 && annByEmail.interactions < 1);
+
+  CM_EXPECT(graph.featuresFor(user("user-c", "", "carol@gmail.com")).isRelation);
+  CM_EXPECT(graph.featuresFor(user("user-e", "", "")).alreadyFollowing);
+  CM_EXPECT(graph.featuresFor(user("user-e2", "", "eve@hooli.com")).alreadyFollowing);
+
+  // A colleague the book does not know yet
+  CandidateFeatures colleague = graph.featuresFor(user("user-n", "", "new@initech.com"));
+  CM_EXPECT(!colleague.inAddressBook);
+  CM_EXPECT(colleague.sameEmailDomainAsYou);
+  CM_EXPECT(colleague.domainAffinity > 0);
+}
+
+CM_TEST(rankingPromotesLocalSignalsAndDropsFollowedUsers) {
+  Fixture fixture;
+  LocalSocialGraph graph = fixture.graph();
+  std::vector<CanonicalContact> candidates = {
+      user("user-x", "", "x@yahoo.com"),         user("user-b", "555-200-0002", ""),
+      user("user-a", "", "ann@initech.com"),     user("user-c", "", "carol@gmail.com"),
+      user("user-e", "", ""),                    user("user-n", "", "new@initech.com"),
+  };
+  std::vector<RankedCandidate> ranked = graph.rank(candidates);
+  CM_ASSERT(ranked.size() == 5);
+  CM_EXPECT_EQ(ranked[0].index, uint32_t(2));
+  CM_EXPECT_EQ(ranked[1].index, uint32_t(1));
+  // A relation beats a stranger the server preferred; a domain alone does not
+  CM_EXPECT_EQ(ranked[2].index, uint32_t(3));
+  CM_EXPECT_EQ(ranked[3].index, uint32_t(0));
+  for (size_t i = 1; i < ranked.size(); ++i) {
+    CM_EXPECT(ranked[i - 1].score >= ranked[i].score);
+    CM_EXPECT(ranked[i].index != 4);
+  }
+  CM_EXPECT_EQ(graph.rank(candidates, 2).size(), size_t(2));
+
+  // With only the server's order to go by, it is kept
+  LocalSocialGraph serverOnly = fixture.graph(1.0);
+  std::vector<RankedCandidate> kept = serverOnly.rank(candidates);
+  CM_ASSERT(kept.size() == 5);
+  CM_EXPECT_EQ(kept[0].index, uint32_t(0));
+  CM_EXPECT_EQ(kept[4].index, uint32_t(5));
+}
+
+CM_TEST(syntheticGraphsRankFollowersAndContactsFirst) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(2000);
+  testing::SyntheticSocialGraph social = testing::makeSyntheticSocialGraph(book, 200, 1000);
+  SocialGraphOptions options;
+  options.defaultCountryCode = 1;
+  LocalSocialGraph graph(book, social.following, social.followers, social.interactionCounts, options);
+
+  std::vector<RankedCandidate> ranked = graph.rank(social.candidates);
+  CM_ASSERT(!ranked.empty());
+  CM_EXPECT(ranked.size() < social.candidates.size());
+  size_t known = 0;
+  size_t top = ranked.size() / 4;
+  for (size_t i = 0; i < top; ++i) {
+    known += ranked[i].features.followsYou || ranked[i].features.inAddressBook ? 1 : 0;
+  }
+  CM_EXPECT(known * 10 >= top * 9);
+  CM_EXPECT(!ranked.back().features.followsYou);
+  CM_EXPECT(graph.memoryBytes() > 0);
+}
@@ -0,0 +1,104 @@
+//
+//  MutualFollowIndexTests.cpp
+//  ContactsManagerCore
+//
+
+#include "MutualFollowIndex.h"
+#include "TestHarness.h"
+
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+FollowRelationship following(const std::string &userId, double createdAt) {
+  FollowRelationship relationship;
+  relationship.identifier = "follow-" + userId;
+  relationship.followerId = "me";
+  relationship.followedId = userId;
+  relationship.userId = userId;
+  relationship.displayName = "User " + userId;
+  relationship.createdAt = createdAt;
+  return relationship;
+}
+
+FollowRelationship follower(const std::string &userId) {
+  FollowRelationship relationship;
+  relationship.identifier = "follower-" + userId;
+  relationship.followerId = userId;
+  relationship.followedId = "me";
+  relationship.userId = userId;
+  return relationship;
+}
+
+std::vector<std::string> userIdsOf(const std::vector<FollowRelationship> &page) {
+  std::vector<std::string> ids;
+  for (const FollowRelationship &relationship : page) {
+    ids.push_back(relationship.userId);
+  }
+  return ids;
+}
+
+} // namespace
+
+CM_TEST(mutualsArePagedNewestFirst) {
+  MutualFollowIndex index;
+  std::vector<FollowRelationship> followingList;
+  std::vector<FollowRelationship> followerList;
+  for (int i = 0; i < 100; ++i) {
+    followingList.push_back(following("u" + std::to_string(i), 1000 + i));
+    if (i % 3 == 0) {
+      followerList.push_back(follower("u" + std::to_string(i)));
+    }
+  }
+  followerList.push_back(follower("stranger"));
+  index.setFollowing(followingList);
+  index.setFollowers(followerList);
+
+  CM_EXPECT_EQ(index.mutualCount(), size_t(34));
+  CM_EXPECT(index.isMutual(mutualUserKey("u3")));
+  CM_EXPECT(!index.isMutual(mutualUserKey("u4")));
+  CM_EXPECT(!index.isMutual(mutualUserKey("stranger")));
+
+  CM_EXPECT(userIdsOf(index.mutualPage(0, 3)) == (std::vector<std::string>{"u99", "u96", "u93"}));
+  CM_EXPECT(userIdsOf(index.mutualPage(32, 10)) == (std::vector<std::string>{"u3", "u0"}));
+  CM_EXPECT(index.mutualPage(34, 10).empty());
+  CM_EXPECT_EQ(index.mutualPage(0, 3)[0].displayName, std::string("User u99"));
+}
+
+CM_TEST(listChangesUpdateMutuals) {
+  MutualFollowIndex index;
+  index.setFollowing({following("a", 1), following("b", 2)});
+  index.setFollowers({follower("a"), follower("c")});
+  CM_EXPECT_EQ(index.mutualCount(), size_t(1));
+
+  // c follows back, b starts following, a stops
+  CM_EXPECT(index.addFollowing(following("c", 3)));
+  CM_EXPECT(index.addFollower(follower("b")));
+  CM_EXPECT(!index.addFollower(follower("b")));
+  CM_EXPECT(index.removeFollowing(mutualUserKey("a")));
+  CM_EXPECT(!index.removeFollowing(mutualUserKey("a")));
+  CM_EXPECT_EQ(index.mutualCount(), size_t(2));
+  CM_EXPECT(userIdsOf(index.mutualPage(0, 10)) == (std::vector<std::string>{"c", "b"}));
+
+  CM_EXPECT(index.removeFollower(mutualUserKey("c")));
+  CM_EXPECT(userIdsOf(index.mutualPage(0, 10)) == (std::vector<std::string>{"b"}));
+  CM_EXPECT_EQ(index.followingCount(), size_t(2));
+  CM_EXPECT_EQ(index.followerCount(), size_t(2));
+}
+
+CM_TEST(expandedSidesAreKeyedByOrganizationUserId) {
+  FollowRelationship out = following("canonical-1", 5);
+  out.followed.organizationUserId = "org-user-1";
+  FollowRelationship in = follower("canonical-9");
+  in.follower.organizationUserId = "org-user-1";
+  CM_EXPECT_EQ(followingUserKey(out), followerUserKey(in));
+  CM_EXPECT_EQ(followingUserKey(out), mutualUserKey("org-user-1"));
+
+  MutualFollowIndex index;
+  index.setFollowing({out});
+  index.setFollowers({in});
+  CM_EXPECT_EQ(index.mutualCount(), size_t(1));
+}
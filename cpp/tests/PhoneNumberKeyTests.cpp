@@ -0,0 +1,119 @@
+//
+//  PhoneNumberKeyTests.cpp
+//  ContactsManagerCore
+//
+
+#include "PhoneNumberKey.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <string>
+#include <unordered_set>
+
+using namespace contactsmanager;
+
+CM_TEST(formattingVariantsShareAKey) {
+  PhoneKey key = phoneKeyFor("+1 (555) 123-4567");
+  CM_ASSERT(key.valid());
+  CM_EXPECT_EQ(key.digits(), uint64_t(15551234567ULL));
+  CM_EXPECT_EQ(key.length(), size_t(11));
+  CM_EXPECT(key.international());
+
+  for (const char *variant : {"+15551234567", "+1.555.123.4567", " +1 555 123 4567 ", "+1/555/123-4567",
+                              "+1\xC2\xA0" "555\xE2\x80\x91" "123\xE2\x80\x91" "4567"}) {
+    CM_EXPECT_EQ(phoneKeyFor(variant).bits(), key.bits());
+  }
+  CM_EXPECT(phoneKeyFor("5551234567") != key);
+  CM_EXPECT(phoneKeyFor("+1 555 123 4568") != key);
+}
+
+CM_TEST(countryPrefixes) {
+  // "00" is the international call prefix
+  CM_EXPECT_EQ(phoneKeyFor("0044 20 7946 0958").bits(), phoneKeyFor("+44 20 7946 0958").bits());
+  // A trunk zero is not part of the number
+  PhoneKey national = phoneKeyFor("020 7946 0958");
+  CM_EXPECT(!national.international());
+  CM_EXPECT_EQ(national.digits(), uint64_t(2079460958ULL));
+
+  // With a default country code national numbers become international
+  CM_EXPECT_EQ(phoneKeyFor("020 7946 0958", 44).bits(), phoneKeyFor("+44 20 7946 0958").bits());
+  CM_EXPECT_EQ(phoneKeyFor("(555) 123-4567", 1).bits(), phoneKeyFor("+1 555 123 4567").bits());
+  CM_EXPECT_EQ(phoneKeyFor("1 555 123 4567", 1).bits(), phoneKeyFor("+1 555 123 4567").bits());
+  CM_EXPECT(phoneKeyFor("+44 20 7946 0958", 1) == phoneKeyFor("+44 20 7946 0958"));
+}
+
+CM_TEST(extensionsAndInvalidValues) {
+  CM_EXPECT_EQ(phoneKeyFor("+1 555 123 4567 x89").bits(), phoneKeyFor("+15551234567").bits());
+  CM_EXPECT_EQ(phoneKeyFor("+1 555 123 4567 ext. 89").bits(), phoneKeyFor("+15551234567").bits());
+  CM_EXPECT_EQ(phoneKeyFor("5551234567,,1234#").bits(), phoneKeyFor("5551234567").bits());
+
+  CM_EXPECT(!phoneKeyFor("").valid());
+  CM_EXPECT(!phoneKeyFor(" - ").valid());
+  CM_EXPECT(!phoneKeyFor("1-800-FLOWERS").valid());
+  CM_EXPECT(!phoneKeyFor("+1 555 + 123").valid());
+  CM_EXPECT(!phoneKeyFor("+0 555 123").valid());
+  CM_EXPECT(!phoneKeyFor("1234567890123456").valid());
+  CM_EXPECT(phoneKeyFor("123456789012345").valid());
+  CM_EXPECT(!phoneKeyFor("1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0").valid());
+}
+
+CM_TEST(nationalNumbersMatchInternationalOnes) {
+  PhoneKey international = phoneKeyFor("+1 (555) 123-4567");
+  CM_EXPECT(phoneKeysMatch(international, phoneKeyFor("555-123-4567")));
+  CM_EXPECT(phoneKeysMatch(phoneKeyFor("07911 123456"), phoneKeyFor("+44 7911 123456")));
+  CM_EXPECT(!phoneKeysMatch(international, phoneKeyFor("555-123-4568")));
+  // Too short to be the national part, or too much left for a country code
+  CM_EXPECT(!phoneKeysMatch(international, phoneKeyFor("123-4567")));
+  CM_EXPECT(!phoneKeysMatch(phoneKeyFor("+49 30 1234 5678 901"), phoneKeyFor("5678901")));
+  CM_EXPECT(!phoneKeysMatch(PhoneKey(), PhoneKey()));
+
+  // Equality is exact once national numbers carry the default calling code
+  CM_EXPECT(phoneNumbersEqual("+1 (555) 123-4567", "+15551234567"));
+  CM_EXPECT(phoneNumbersEqual("+1 (555) 123-4567", "5551234567", 1));
+  CM_EXPECT(phoneNumbersEqual("07911 123456", "+44 7911 123456", 44));
+  CM_EXPECT(!phoneNumbersEqual("07911 123456", "+44 7911 123456", 1));
+  CM_EXPECT(phoneNumbersEqual("call me", "call me"));
+  CM_EXPECT(!phoneNumbersEqual("call me", "+1 555 123 4567"));
+}
+
+CM_TEST(regionsMapToCallingCodes) {
+  CM_EXPECT_EQ(callingCodeForRegion("US"), uint16_t(1));
+  CM_EXPECT_EQ(callingCodeForRegion("gb"), uint16_t(44));
+  CM_EXPECT_EQ(callingCodeForRegion("AD"), uint16_t(376));
+  CM_EXPECT_EQ(callingCodeForRegion("ZW"), uint16_t(263));
+  CM_EXPECT_EQ(callingCodeForRegion("ZZ"), uint16_t(0));
+  CM_EXPECT_EQ(callingCodeForRegion("USA"), uint16_t(0));
+  CM_EXPECT_EQ(callingCodeForRegion(""), uint16_t(0));
+}
+
+CM_TEST(vectorAndScalarScansAgree) {
+  const char kAlphabet[] = "0123456789 -.()/+xe#,;a\t\xC2\xA0";
+  testing::SplitMix64 random(7);
+  for (int i = 0; i < 20000; ++i) {
+    std::string value;
+    size_t length = random.nextBelow(40);
+    for (size_t j = 0; j < length; ++j) {
+      // Mostly digits and formatting, like real phone values
+      size_t pool = random.nextBelow(4) == 0 ? sizeof(kAlphabet) - 1 : 16;
+      value.push_back(kAlphabet[random.nextBelow(pool)]);
+    }
+    uint16_t countryCode = random.nextBelow(2) == 0 ? 0 : static_cast<uint16_t>(1 + random.nextBelow(999));
+    CM_EXPECT_EQ(phoneKeyFor(value, countryCode).bits(), phoneKeyForScalar(value, countryCode).bits());
+  }
+}
+
+CM_TEST(keysDeduplicateTheSyntheticBook) {
+  auto book = testing::makeSyntheticAddressBook(2000);
+  std::unordered_set<PhoneKey, PhoneKeyHash> keys;
+  std::unordered_set<std::string> values;
+  for (const auto &contact : book) {
+    for (const auto &phone : contact.phoneNumbers) {
+      PhoneKey key = phoneKeyFor(phone.value, 1);
+      CM_EXPECT(key.valid());
+      keys.insert(key);
+      values.insert(phone.value);
+    }
+  }
+  // The book writes the same numbers in several formats
+  CM_EXPECT(keys.size() <= values.size());
+}
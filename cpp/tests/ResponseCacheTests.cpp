@@ -0,0 +1,240 @@
+//
+//  ResponseCacheTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ResponseCache.h"
+#include "SimulatedApiServer.h"
+#include "TestHarness.h"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+const char *const kEndpoint = "/api/v1/recommendations/contacts-using-app";
+
+ApiRequest usingAppRequest(const std::string &limit) {
+  ApiRequest request;
+  request.endpoint = kEndpoint;
+  request.parameters = {{"limit", limit}};
+  return request;
+}
+
+class Collector {
+public:
+  CachingApiClient::Callback callback() {
+    return [this](const CachedApiResponse &result) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      results_.push_back(result);
+    };
+  }
+
+  std::vector<CachedApiResponse> take() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<CachedApiResponse> results;
+    results.swap(results_);
+    return results;
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<CachedApiResponse> results_;
+};
+
+} // namespace
+
+CM_TEST(keysIgnoreParameterOrderButNotUsers) {
+  ApiRequest lhs;
+  lhs.endpoint = "/api/v1/feed";
+  lhs.parameters = {{"skip", "0"}, {"limit", "20"}};
+  ApiRequest rhs = lhs;
+  rhs.parameters = {{"limit", "20"}, {"skip", "0"}};
+  CM_EXPECT_EQ(responseCacheKey(lhs, "user-1"), responseCacheKey(rhs, "user-1"));
+  CM_EXPECT(responseCacheKey(lhs, "user-1") != responseCacheKey(lhs, "user-2"));
+  rhs.parameters[0].second = "21";
+  CM_EXPECT(responseCacheKey(lhs, "user-1") != responseCacheKey(rhs, "user-1"));
+  CM_EXPECT_EQ(canonicalParameters({{"q", "a b&c"}, {"limit", "5"}}), std::string("limit=5&q=a%20b%26c"));
+}
+
+CM_TEST(lookupsAgeThroughFreshStaleAndExpired) {
+  ResponseCache cache(ResponseCacheOptions{8, 1 << 20, 60, 600});
+  CM_EXPECT(cache.lookup("k", 1000).state == CacheState::Missing);
+  cache.store("k", "body", "\"e1\"", 1000);
+  CM_EXPECT(cache.lookup("k", 1059).state == CacheState::Fresh);
+  CM_EXPECT(cache.lookup("k", 1060).state == CacheState::Stale);
+  CM_EXPECT(cache.lookup("k", 999).state == CacheState::Expired);
+  CacheLookup expired = cache.lookup("k", 1660);
+  CM_EXPECT(expired.state == CacheState::Expired);
+  CM_ASSERT(expired.response != nullptr);
+  CM_EXPECT_EQ(expired.response->etag, std::string("\"e1\""));
+
+  CM_ASSERT(cache.revalidated("k", 2000) != nullptr);
+  CM_EXPECT(cache.lookup("k", 2001).state == CacheState::Fresh);
+  // The response handed out before the renewal is unchanged
+  CM_EXPECT_EQ(expired.response->fetchedAt, 1000.0);
+
+  ResponseCacheStats stats = cache.stats();
+  CM_EXPECT_EQ(stats.hits, size_t(2));
+  CM_EXPECT_EQ(stats.staleHits, size_t(1));
+  CM_EXPECT_EQ(stats.misses, size_t(3));
+  CM_EXPECT_EQ(stats.revalidations, size_t(1));
+}
+
+CM_TEST(leastRecentlyUsedEntriesAreEvicted) {
+  ResponseCache cache(ResponseCacheOptions{3, 1 << 20, 60, 600});
+  cache.store("a", "1", "", 0);
+  cache.store("b", "2", "", 0);
+  cache.store("c", "3", "", 0);
+  cache.lookup("a", 1);
+  cache.store("d", "4", "", 0);
+  CM_EXPECT(cache.lookup("b", 1).state == CacheState::Missing);
+  CM_EXPECT(cache.lookup("a", 1).state == CacheState::Fresh);
+  CM_EXPECT_EQ(cache.stats().evictions, size_t(1));
+
+  // The byte budget holds as well
+  ResponseCache small(ResponseCacheOptions{8, 100, 60, 600});
+  small.store("a", std::string(60, 'x'), "", 0);
+  small.store("b", std::string(60, 'y'), "", 0);
+  CM_EXPECT_EQ(small.stats().entries, size_t(1));
+  CM_EXPECT(small.stats().bytes <= 100);
+
+  cache.store(responseCacheKey(usingAppRequest("5"), "u1"), "x", "", 0);
+  cache.store(responseCacheKey(usingAppRequest("6"), "u1"), "x", "", 0);
+  cache.store(responseCacheKey(usingAppRequest("5"), "u10"), "x", "", 0);
+  CM_EXPECT_EQ(cache.removeUser("u1"), size_t(2));
+  CM_EXPECT(cache.lookup(responseCacheKey(usingAppRequest("5"), "u10"), 1).state == CacheState::Fresh);
+}
+
+CM_TEST(clientServesStaleWhileRevalidating) {
+  testing::SimulatedApiServer server;
+  std::string body = "[{\"contactId\":\"1\"}]";
+  server.route("GET", kEndpoint, [&body](const ApiRequest &) { return ApiResponse{200, body, ""}; });
+  ResponseCache cache(ResponseCacheOptions{8, 1 << 20, 60, 600});
+  std::atomic<double> now{1000};
+  CachingApiClient client(server, cache, [&now] { return now.load(); });
+  Collector collector;
+
+  // Cold: one network response
+  client.get(usingAppRequest("10"), "u1", collector.callback());
+  server.waitIdle();
+  std::vector<CachedApiResponse> results = collector.take();
+  CM_ASSERT(results.size() == 1);
+  CM_EXPECT(!results[0].fromCache);
+  CM_EXPECT_EQ(results[0].response.body, body);
+
+  // Fresh: served synchronously, no request
+  now = 1030;
+  client.get(usingAppRequest("10"), "u1", collector.callback());
+  results = collector.take();
+  CM_ASSERT(results.size() == 1);
+  CM_EXPECT(results[0].fromCache && !results[0].stale);
+  CM_EXPECT_EQ(server.requestCount(), size_t(1));
+
+  // Stale and unchanged: served, then renewed by a 304 without a second delivery
+  now = 1100;
+  client.get(usingAppRequest("10"), "u1", collector.callback());
+  server.waitIdle();
+  results = collector.take();
+  CM_ASSERT(results.size() == 1);
+  CM_EXPECT(results[0].stale);
+  CM_EXPECT_EQ(server.notModifiedCount(), size_t(1));
+  CM_EXPECT_EQ(server.requests().back().ifNoneMatch, testing::SimulatedApiServer::etagFor(body));
+  CM_EXPECT(cache.lookup(responseCacheKey(usingAppRequest("10"), "u1"), 1110).state == CacheState::Fresh);
+
+  // Stale and changed: the new response follows the stale one
+  body = "[{\"contactId\":\"1\"},{\"contactId\":\"2\"}]";
+  now = 1200;
+  client.get(usingAppRequest("10"), "u1", collector.callback());
+  server.waitIdle();
+  results = collector.take();
+  CM_ASSERT(results.size() == 2);
+  CM_EXPECT(results[0].stale);
+  CM_EXPECT(!results[1].fromCache);
+  CM_EXPECT_EQ(results[1].response.body, body);
+
+  // Stale without an ETag: the unconditional 200 carries the same body and is not delivered again
+  std::string key = responseCacheKey(usingAppRequest("10"), "u1");
+  cache.store(key, body, "", 1200);
+  now = 1280;
+  client.get(usingAppRequest("10"), "u1", collector.callback());
+  server.waitIdle();
+  results = collector.take();
+  CM_ASSERT(results.size() == 1);
+  CM_EXPECT(results[0].stale);
+  CM_EXPECT_EQ(cache.lookup(key, 1290).response->etag, testing::SimulatedApiServer::etagFor(body));
+
+  // A failed revalidation keeps the stale response on screen
+  now = 1300;
+  server.failNext(1);
+  client.get(usingAppRequest("10"), "u1", collector.callback());
+  server.waitIdle();
+  CM_EXPECT_EQ(collector.take().size(), size_t(1));
+
+  // A cold failure is reported
+  server.failNext(1);
+  client.get(usingAppRequest("20"), "u1", collector.callback());
+  server.waitIdle();
+  results = collector.take();
+  CM_ASSERT(results.size() == 1);
+  CM_EXPECT_EQ(results[0].response.statusCode, 0);
+}
+
+CM_TEST(expiredResponsesStillRevalidateConditionally) {
+  testing::SimulatedApiServer server;
+  server.route("GET", kEndpoint, [](const ApiRequest &) { return ApiResponse{200, "[]", ""}; });
+  ResponseCache cache(ResponseCacheOptions{8, 1 << 20, 60, 600});
+  double now = 1000;
+  CachingApiClient client(server, cache, [&now] { return now; });
+  Collector collector;
+
+  client.get(usingAppRequest("10"), "u1", collector.callback());
+  server.waitIdle();
+  collector.take();
+
+  now = 5000;
+  client.get(usingAppRequest("10"), "u1", collector.callback());
+  server.waitIdle();
+  std::vector<CachedApiResponse> results = collector.take();
+  CM_ASSERT(results.size() == 1);
+  CM_EXPECT(results[0].fromCache && !results[0].stale);
+  CM_EXPECT_EQ(results[0].response.body, std::string("[]"));
+  CM_EXPECT_EQ(server.notModifiedCount(), size_t(1));
+  CM_EXPECT_EQ(server.bytesSent(), uint64_t(2));
+}
+
+CM_TEST(saveAndLoadKeepEntriesAndOrder) {
+  ResponseCache cache(ResponseCacheOptions{8, 1 << 20, 60, 600});
+  cache.store("a", "alpha", "\"a\"", 1000.25);
+  cache.store("b", "beta", "", 1000);
+  cache.store("c", "gamma", "\"c\"", 1000);
+  cache.lookup("a", 1001);
+  std::string path = testing::temporaryPath("response_cache", "roundtrip");
+  CM_ASSERT(cache.save(path));
+
+  // Reloading into a smaller cache keeps the most recently used entries
+  ResponseCache loaded(ResponseCacheOptions{2, 1 << 20, 60, 600});
+  CM_ASSERT(loaded.load(path));
+  CM_EXPECT_EQ(loaded.stats().entries, size_t(2));
+  CacheLookup a = loaded.lookup("a", 1001);
+  CM_ASSERT(a.state == CacheState::Fresh);
+  CM_EXPECT_EQ(a.response->body, std::string("alpha"));
+  CM_EXPECT_EQ(a.response->etag, std::string("\"a\""));
+  CM_EXPECT_EQ(a.response->fetchedAt, 1000.25);
+  CM_EXPECT(loaded.lookup("c", 1001).state == CacheState::Fresh);
+  CM_EXPECT(loaded.lookup("b", 1001).state == CacheState::Missing);
+
+  FILE *file = std::fopen(path.c_str(), "wb");
+  CM_ASSERT(file != nullptr);
+  std::fwrite("CMRC", 1, 4, file);
+  std::fclose(file);
+  CM_EXPECT(!loaded.load(path));
+  CM_EXPECT_EQ(loaded.stats().entries, size_t(0));
+  CM_EXPECT(!loaded.load(testing::temporaryPath("response_cache", "missing")));
+  std::remove(path.c_str());
+}
@@ -0,0 +1,211 @@
+//
+//  ServerContactJsonTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactHashing.h"
+#include "JsonValue.h"
+#include "ServerContactJson.h"
+#include "SimulatedSyncServer.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using testing::JsonValue;
+
+namespace {
+
+const ServerContactContext kContext{"org-1", "source-1"};
+
+JsonValue serverForm(const Contact &contact) {
+  std::string json;
+  JsonWriter writer(json);
+  writeServerContact(writer, contact, kContext);
+  return *JsonValue::parse(json);
+}
+
+// Sends the changed contacts the way a delta sync does, falling back to full
+// upserts for rejected patches, and acknowledges what the server accepted
+bool deltaSync(testing::SimulatedSyncServer &server, ContactSnapshotStore &snapshots,
+               const std::vector<Contact> &changed) {
+  DeltaSyncBody body = encodeDeltaSyncBody(changed, snapshots, kContext, false);
+  testing::SimulatedSyncServer::SyncResult result = server.handleDeltaSync(body.body);
+  if (!result.ok) {
+    return false;
+  }
+  std::vector<Contact> retry;
+  for (const auto &contact : changed) {
+    bool rejected = false;
+    for (const auto &identifier : result.rejected) {
+      rejected = rejected || identifier == contact.identifier;
+    }
+    if (rejected) {
+      snapshots.remove(contact.identifier);
+      retry.push_back(contact);
+    } else {
+      snapshots.put(contact);
+    }
+  }
+  return retry.empty() || deltaSync(server, snapshots, retry);
+}
+
+} // namespace
+
+CM_TEST(writerEscapesAndSeparates) {
+  std::string out;
+  JsonWriter writer(out);
+  writer.beginObject();
+  writer.field("text", "a\"b\\c\n\x01");
+  writer.key("list");
+  writer.beginArray();
+  writer.intValue(-3);
+  writer.doubleValue(0.1);
+  writer.boolValue(true);
+  writer.nullValue();
+  writer.beginObject();
+  writer.endObject();
+  writer.endArray();
+  writer.key("nan");
+  writer.doubleValue(0.0 / 0.0);
+  writer.endObject();
+  CM_EXPECT_EQ(out, std::string("{\"text\":\"a\\\"b\\\\c\\n\\u0001\",\"list\":[-3,0.1,true,null,{}],\"nan\":null}"));
+  CM_EXPECT_EQ(writer.depth(), size_t(0));
+
+  auto parsed = JsonValue::parse(out);
+  CM_ASSERT(parsed.has_value());
+  CM_EXPECT_EQ(parsed->find("text")->string, std::string("a\"b\\c\n\x01"));
+}
+
+CM_TEST(isoDatesMatchTheFrameworkFormat) {
+  CM_EXPECT_EQ(formatIso8601(0), std::string("1970-01-01T00:00:00Z"));
+  CM_EXPECT_EQ(formatIso8601(951782400), std::string("2000-02-29T00:00:00Z"));
+  CM_EXPECT_EQ(formatIso8601(1700000000.75), std::string("2023-11-14T22:13:20Z"));
+  CM_EXPECT_EQ(formatIso8601(-1), std::string("1969-12-31T23:59:59Z"));
+}
+
+CM_TEST(serverContactHasTheBulkCreateShape) {
+  Contact contact("c1");
+  contact.givenName = "Ada";
+  contact.phoneNumbers = {{"c1", "+1 555 0100", "mobile", ""}, {"c1", "+1 555 0101", "home", "📱"}};
+  contact.updateDisplayInfo();
+  JsonValue json = serverForm(contact);
+
+  CM_EXPECT_EQ(json.find("sourceContactId")->string, std::string("c1"));
+  CM_EXPECT_EQ(json.find("organizationId")->string, std::string("org-1"));
+  CM_EXPECT_EQ(json.find("displayName")->string, contact.displayName);
+  // Required keys are always present, optional ones only when set
+  CM_EXPECT(json.find("notes") != nullptr);
+  CM_EXPECT(json.find("familyName") == nullptr);
+  CM_EXPECT(json.find("birthday") == nullptr);
+  const JsonValue *phones = json.find("phoneNumbers");
+  CM_ASSERT(phones != nullptr && phones->array.size() == 2);
+  CM_EXPECT(phones->array[0].find("isPrimary")->boolean);
+  CM_EXPECT(!phones->array[1].find("isPrimary")->boolean);
+  CM_EXPECT_EQ(phones->array[1].find("emoji")->string, std::string("📱"));
+  CM_EXPECT(json.find("urls")->array.empty());
+
+  std::string body = encodeBulkCreateBody({contact, contact}, kContext, true);
+  auto parsed = JsonValue::parse(body);
+  CM_ASSERT(parsed.has_value());
+  CM_EXPECT_EQ(parsed->find("contacts")->array.size(), size_t(2));
+  CM_EXPECT(parsed->find("skipDuplicates")->boolean);
+}
+
+CM_TEST(patchesReproduceTheFullContactOnTheServer) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(300);
+  testing::SimulatedSyncServer server;
+  ContactSnapshotStore snapshots;
+  CM_ASSERT(deltaSync(server, snapshots, book));
+  CM_EXPECT_EQ(server.size(), book.size());
+
+  testing::SplitMix64 random(11);
+  std::vector<Contact> changed;
+  for (size_t i = 0; i < book.size(); i += 3) {
+    Contact contact = book[i];
+    switch (i % 4) {
+    case 0:
+      contact.phoneNumbers.push_back({contact.identifier, "+44 20 7946 0000", "work", ""});
+      break;
+    case 1:
+      contact.phoneNumbers.erase(contact.phoneNumbers.begin());
+      contact.notes = "";
+      break;
+    case 2:
+      contact.jobTitle = "Astronaut";
+      contact.birthday = 86400.0 * 365;
+      break;
+    default:
+      contact = testing::makeSyntheticContact(i, random);
+      contact.identifier = book[i].identifier;
+      break;
+    }
+    contact.updateDisplayInfo();
+    book[i] = contact;
+    changed.push_back(contact);
+  }
+
+  DeltaSyncBody body = encodeDeltaSyncBody(changed, snapshots, kContext, false);
+  CM_EXPECT(!body.patched.empty());
+  CM_ASSERT(deltaSync(server, snapshots, changed));
+  for (const auto &contact : book) {
+    const JsonValue *stored = server.contact(contact.identifier);
+    CM_ASSERT(stored != nullptr);
+    CM_EXPECT(*stored == serverForm(contact));
+    CM_EXPECT_EQ(server.version(contact.identifier), formatHash128(serverContactHash128(contact)));
+  }
+}
+
+CM_TEST(missingBaseVersionFallsBackToUpsert) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(10);
+  testing::SimulatedSyncServer server;
+  ContactSnapshotStore snapshots;
+  CM_ASSERT(deltaSync(server, snapshots, book));
+
+  // The server lost one contact; the client still has its snapshot
+  server.forget(book[4].identifier);
+  std::vector<Contact> changed = {book[3], book[4]};
+  changed[0].jobTitle = "Pilot";
+  changed[1].jobTitle = "Pilot";
+
+  DeltaSyncBody body = encodeDeltaSyncBody(changed, snapshots, kContext, false);
+  CM_EXPECT_EQ(body.patched.size(), size_t(2));
+  testing::SimulatedSyncServer::SyncResult result = server.handleDeltaSync(body.body);
+  CM_ASSERT(result.ok);
+  CM_EXPECT_EQ(result.patched, size_t(1));
+  CM_ASSERT(result.rejected.size() == 1);
+  CM_EXPECT_EQ(result.rejected[0], book[4].identifier);
+
+  snapshots.put(changed[0]);
+  snapshots.remove(changed[1].identifier);
+  body = encodeDeltaSyncBody({changed[1]}, snapshots, kContext, false);
+  CM_EXPECT(body.upserted == std::vector<std::string>{book[4].identifier});
+  result = server.handleDeltaSync(body.body);
+  CM_EXPECT_EQ(result.upserted, size_t(1));
+  CM_EXPECT(*server.contact(book[4].identifier) == serverForm(changed[1]));
+}
+
+CM_TEST(patchesNeverExceedTheFullContact) {
+  Contact base("c1");
+  base.givenName = "A";
+  base.updateDisplayInfo();
+  ContactSnapshotStore snapshots;
+  snapshots.put(base);
+
+  // Everything changed: the full contact is smaller than a patch plus versions
+  Contact current("c1");
+  current.givenName = "B";
+  current.updateDisplayInfo();
+  DeltaSyncBody body = encodeDeltaSyncBody({current}, snapshots, kContext, false);
+  CM_EXPECT_EQ(body.upserted.size() + body.patched.size(), size_t(1));
+
+  std::string full;
+  JsonWriter writer(full);
+  writeServerContact(writer, current, kContext);
+  std::string patch;
+  JsonWriter patchWriter(patch);
+  writeContactPatch(patchWriter, *snapshots.patchFor(current));
+  CM_EXPECT_EQ(body.patched.size(), size_t(patch.size() < full.size() ? 1 : 0));
+}
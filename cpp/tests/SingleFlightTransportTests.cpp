@@ -0,0 +1,183 @@
+//
+//  SingleFlightTransportTests.cpp
+//  ContactsManagerCore
+//
+
+#include "SimulatedApiServer.h"
+#include "SingleFlightTransport.h"
+#include "TestHarness.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+const char *const kUserInfo = "/api/v1/user/info";
+const char *const kFeed = "/api/v1/social/feed";
+
+class Responses {
+public:
+  std::function<void(ApiResponse)> callback() {
+    return [this](ApiResponse response) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      responses_.push_back(std::move(response));
+    };
+  }
+
+  std::vector<ApiResponse> all() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return responses_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<ApiResponse> responses_;
+};
+
+ApiRequest get(const char *endpoint, std::vector<std::pair<std::string, std::string>> parameters = {}) {
+  ApiRequest request;
+  request.endpoint = endpoint;
+  request.parameters = std::move(parameters);
+  return request;
+}
+
+void routeEcho(testing::SimulatedApiServer &server, const char *method, const char *endpoint) {
+  std::string name = endpoint;
+  server.route(method, endpoint, [name](const ApiRequest &request) {
+    return ApiResponse{200, name + "?" + canonicalParameters(request.parameters), ""};
+  });
+}
+
+} // namespace
+
+CM_TEST(concurrentIdenticalRequestsShareOneRoundTrip) {
+  testing::SimulatedApiServer server;
+  routeEcho(server, "GET", kUserInfo);
+  SingleFlightTransport transport(server, [] { return std::string("user-1"); });
+  Responses responses;
+
+  // Held until every caller has joined the round trip
+  server.hold();
+  std::vector<std::thread> screens;
+  for (int i = 0; i < 8; ++i) {
+    screens.emplace_back([&] { transport.send(get(kUserInfo), responses.callback()); });
+  }
+  for (auto &screen : screens) {
+    screen.join();
+  }
+  CM_EXPECT_EQ(transport.stats().inFlight, size_t(1));
+  CM_EXPECT(responses.all().empty());
+  server.release();
+  server.waitIdle();
+
+  CM_EXPECT_EQ(server.requestCount(), size_t(1));
+  std::vector<ApiResponse> all = responses.all();
+  CM_EXPECT_EQ(all.size(), size_t(8));
+  for (const ApiResponse &response : all) {
+    CM_EXPECT_EQ(response.statusCode, 200);
+    CM_EXPECT_EQ(response.body, std::string(kUserInfo) + "?");
+  }
+  SingleFlightStats stats = transport.stats();
+  CM_EXPECT_EQ(stats.requests, size_t(8));
+  CM_EXPECT_EQ(stats.sent, size_t(1));
+  CM_EXPECT_EQ(stats.deduplicated, size_t(7));
+  CM_EXPECT_EQ(stats.inFlight, size_t(0));
+
+  // Answered requests are not reused
+  transport.send(get(kUserInfo), responses.callback());
+  server.waitIdle();
+  CM_EXPECT_EQ(server.requestCount(), size_t(2));
+}
+
+CM_TEST(onlyIdenticalRequestsOfOneIdentityAreShared) {
+  testing::SimulatedApiServer server;
+  routeEcho(server, "GET", kFeed);
+  routeEcho(server, "GET", kUserInfo);
+  std::string identity = "user-1";
+  std::mutex identityMutex;
+  SingleFlightTransport transport(server, [&] {
+    std::lock_guard<std::mutex> lock(identityMutex);
+    return identity;
+  });
+  Responses responses;
+
+  server.hold();
+  transport.send(get(kFeed, {{"skip", "0"}, {"limit", "20"}}), responses.callback());
+  transport.send(get(kFeed, {{"limit", "20"}, {"skip", "0"}}), responses.callback());
+  transport.send(get(kFeed, {{"skip", "20"}, {"limit", "20"}}), responses.callback());
+  ApiRequest revalidation = get(kFeed, {{"skip", "0"}, {"limit", "20"}});
+  revalidation.ifNoneMatch = "\"etag\"";
+  transport.send(revalidation, responses.callback());
+
+  ApiRequest open = get(kUserInfo);
+  open.requiresAuth = false;
+  transport.send(open, responses.callback());
+  transport.send(get(kUserInfo), responses.callback());
+  {
+    std::lock_guard<std::mutex> lock(identityMutex);
+    identity = "user-2";
+  }
+  transport.send(get(kUserInfo), responses.callback());
+  transport.send(open, responses.callback());
+  server.release();
+  server.waitIdle();
+
+  // Feed pages 0 (twice), 20 and the revalidation; public info once, info per user
+  CM_EXPECT_EQ(server.requestCount(), size_t(6));
+  CM_EXPECT_EQ(transport.stats().deduplicated, size_t(2));
+  CM_EXPECT_EQ(responses.all().size(), size_t(8));
+}
+
+CM_TEST(writesAndFailuresAreNotMerged) {
+  testing::SimulatedApiServer server;
+  routeEcho(server, "GET", kFeed);
+  routeEcho(server, "POST", "/api/v1/social/follow");
+  SingleFlightTransport transport(server, [] { return std::string("user-1"); });
+  Responses responses;
+
+  ApiRequest follow;
+  follow.method = "POST";
+  follow.endpoint = "/api/v1/social/follow";
+  follow.parameters = {{"user_id", "user-9"}};
+  server.hold();
+  transport.send(follow, responses.callback());
+  transport.send(follow, responses.callback());
+  server.release();
+  server.waitIdle();
+  CM_EXPECT_EQ(server.requestCount(), size_t(2));
+
+  // A failed round trip fails every caller sharing it
+  server.failNext(1);
+  server.hold();
+  std::atomic<int> failures{0};
+  for (int i = 0; i < 3; ++i) {
+    transport.send(get(kFeed), [&](ApiResponse response) { failures += response.statusCode == 0 ? 1 : 0; });
+  }
+  server.release();
+  server.waitIdle();
+  CM_EXPECT_EQ(failures.load(), 3);
+  CM_EXPECT_EQ(server.requestCount(), size_t(3));
+
+  testing::SimulatedApiServer readServer;
+  routeEcho(readServer, "POST", kFeed);
+  SingleFlightOptions options;
+  options.includeWrites = true;
+  SingleFlightTransport reads(readServer, {}, options);
+  ApiRequest query;
+  query.method = "POST";
+  query.endpoint = kFeed;
+  query.body = "{\"limit\":20}";
+  readServer.hold();
+  reads.send(query, responses.callback());
+  reads.send(query, responses.callback());
+  query.body = "{\"limit\":40}";
+  reads.send(query, responses.callback());
+  readServer.release();
+  readServer.waitIdle();
+  CM_EXPECT_EQ(readServer.requestCount(), size_t(2));
+}
@@ -0,0 +1,189 @@
+//
+//  SocialEventStoreTests.cpp
+//  ContactsManagerCore
+//
+
+#include "BinaryFile.h"
+#include "SimulatedFeedServer.h"
+#include "SocialEventStore.h"
+#include "TestHarness.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+std::vector<SocialEvent> slice(const std::vector<SocialEvent> &events, size_t first, size_t count) {
+  return std::vector<SocialEvent>(events.begin() + static_cast<std::ptrdiff_t>(first),
+                                  events.begin() + static_cast<std::ptrdiff_t>(first + count));
+}
+
+std::vector<std::string> idsOf(const CachedFeed &feed) {
+  std::vector<std::string> ids;
+  for (const auto &event : feed.events) {
+    ids.push_back(event->eventId);
+  }
+  return ids;
+}
+
+} // namespace
+
+CM_TEST(feedsShareOneEntryPerEvent) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(30);
+  SocialEventStore store;
+  store.storeFeedPage("getFeed", slice(events, 0, 20), "feed-cursor", true);
+  store.storeFeedPage("getForYouFeed", slice(events, 10, 20), "", true);
+
+  SocialEventStoreStats stats = store.stats();
+  CM_EXPECT_EQ(stats.events, size_t(30));
+  CM_EXPECT_EQ(stats.feeds, size_t(2));
+  CM_EXPECT_EQ(stats.feedEntries, size_t(40));
+
+  CachedFeed feed = store.feed("getFeed");
+  CachedFeed forYou = store.feed("getForYouFeed");
+  CM_EXPECT(feed.complete && forYou.complete);
+  CM_EXPECT_EQ(feed.nextCursor, std::string("feed-cursor"));
+  CM_EXPECT_EQ(feed.events.size(), size_t(20));
+  CM_EXPECT(feed.events[10].get() == forYou.events[0].get());
+  CM_EXPECT_EQ(store.feed("getFeed", 5).events.size(), size_t(5));
+  CM_EXPECT(!store.feed("getUserEvents").complete);
+
+  // Later pages append only events the feed does not list yet
+  store.storeFeedPage("getFeed", slice(events, 15, 15), "", false);
+  CM_EXPECT_EQ(store.feed("getFeed").events.size(), size_t(30));
+  CM_EXPECT(store.feed("getFeed").nextCursor.empty());
+}
+
+CM_TEST(updatesAndDeletesApplyInPlace) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(10);
+  SocialEventStore store;
+  store.storeFeedPage("getFeed", events, "", true);
+  store.storeFeedPage("getUpcomingEvents", slice(events, 2, 5), "", true);
+
+  SocialEvent updated = events[3];
+  updated.title = "Renamed";
+  updated.updatedAt = events[3].updatedAt + 10;
+  CM_EXPECT(store.updateEvent(updated));
+  CM_EXPECT_EQ(store.feed("getFeed").events[3]->title, std::string("Renamed"));
+  CM_EXPECT_EQ(store.feed("getUpcomingEvents").events[1]->title, std::string("Renamed"));
+
+  // A page fetched before the update does not undo it
+  store.storeFeedPage("getFeed", events, "", true);
+  CM_EXPECT_EQ(store.event(events[3].eventId)->title, std::string("Renamed"));
+
+  SocialEvent unknown;
+  unknown.eventId = "missing";
+  CM_EXPECT(!store.updateEvent(unknown));
+
+  CM_EXPECT(store.removeEvent(events[4].eventId));
+  CM_EXPECT(!store.event(events[4].eventId));
+  std::vector<std::string> upcoming = idsOf(store.feed("getUpcomingEvents"));
+  CM_EXPECT_EQ(upcoming.size(), size_t(4));
+  CM_EXPECT_EQ(upcoming[2], events[5].eventId);
+  CM_EXPECT_EQ(store.feed("getFeed").events.size(), size_t(9));
+  CM_EXPECT(!store.removeEvent(events[4].eventId));
+}
+
+CM_TEST(evictsLeastRecentlyUsedEvents) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(30);
+  SocialEventStoreOptions options;
+  options.maxEvents = 20;
+  SocialEventStore store(options);
+  store.storeFeedPage("getFeed", slice(events, 0, 10), "feed-cursor", true);
+  store.storeFeedPage("getUserEvents", slice(events, 10, 10), "", true);
+  // Reading the feed keeps its events over the older user events
+  CM_EXPECT(store.feed("getFeed").complete);
+  store.storeFeedPage("getForYouFeed", slice(events, 20, 5), "", true);
+
+  SocialEventStoreStats stats = store.stats();
+  CM_EXPECT_EQ(stats.events, size_t(20));
+  CM_EXPECT_EQ(stats.evictions, size_t(5));
+  CM_EXPECT(store.feed("getFeed").complete);
+  CachedFeed userEvents = store.feed("getUserEvents");
+  CM_EXPECT(!userEvents.complete);
+  CM_EXPECT(userEvents.events.empty());
+  CM_EXPECT(userEvents.nextCursor.empty());
+  // The evicted events' IDs went with them
+  CM_EXPECT_EQ(stats.feedEntries, size_t(15));
+  // A later page cannot follow a feed that was cut short; the next first page replaces it
+  store.storeFeedPage("getUserEvents", slice(events, 25, 2), "more", false);
+  CM_EXPECT(store.feed("getUserEvents").events.empty());
+  store.storeFeedPage("getUserEvents", slice(events, 25, 2), "more", true);
+  CM_EXPECT(store.feed("getUserEvents").complete);
+
+  SocialEventStoreOptions tight;
+  tight.maxBytes = 4096;
+  SocialEventStore small(tight);
+  small.storeFeedPage("getFeed", events, "", true);
+  CM_EXPECT(small.stats().bytes <= tight.maxBytes);
+  CM_EXPECT(small.stats().events < events.size());
+}
+
+CM_TEST(feedsKeepAtMostMaxFeedEvents) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(30);
+  SocialEventStoreOptions options;
+  options.maxFeedEvents = 12;
+  SocialEventStore store(options);
+  store.storeFeedPage("getFeed", slice(events, 0, 10), "page-2", true);
+  CM_EXPECT(store.feed("getFeed").complete);
+
+  store.storeFeedPage("getFeed", slice(events, 10, 10), "page-3", false);
+  CachedFeed feed = store.feed("getFeed");
+  CM_EXPECT(!feed.complete);
+  CM_EXPECT(feed.nextCursor.empty());
+  CM_EXPECT_EQ(feed.events.size(), size_t(12));
+  CM_EXPECT_EQ(store.stats().feedEntries, size_t(12));
+  // The events themselves are still stored for the other feeds
+  CM_EXPECT_EQ(store.stats().events, size_t(20));
+
+  std::string path = testing::temporaryPath("event_store", "cut_short");
+  CM_ASSERT(store.save(path));
+  SocialEventStore loaded(options);
+  CM_ASSERT(loaded.load(path));
+  CM_EXPECT(!loaded.feed("getFeed").complete);
+  CM_EXPECT_EQ(loaded.feed("getFeed").events.size(), size_t(12));
+  std::remove(path.c_str());
+}
+
+CM_TEST(savesAndLoadsEventsAndFeeds) {
+  std::vector<SocialEvent> events = testing::makeSyntheticFeedEvents(25);
+  events[0].metadata = {{"capacity", "40"}, {"room", "B"}};
+  events[0].location = "Main hall";
+  SocialEventStore store;
+  store.storeFeedPage("getFeed", slice(events, 0, 20), "feed-cursor", true);
+  store.storeFeedPage("getUpcomingEvents", slice(events, 15, 10), "", true);
+  std::string path = testing::temporaryPath("event_store", "roundtrip");
+  CM_ASSERT(store.save(path));
+
+  SocialEventStore loaded;
+  CM_ASSERT(loaded.load(path));
+  CM_EXPECT_EQ(loaded.stats().events, size_t(25));
+  CachedFeed feed = loaded.feed("getFeed");
+  CM_EXPECT(feed.complete);
+  CM_EXPECT_EQ(feed.nextCursor, std::string("feed-cursor"));
+  CM_EXPECT(idsOf(feed) == idsOf(store.feed("getFeed")));
+  CM_EXPECT(feed.events[0]->metadata == events[0].metadata);
+  CM_EXPECT_EQ(feed.events[0]->location, std::string("Main hall"));
+  CM_EXPECT_EQ(feed.events[0]->createdAt, events[0].createdAt);
+  CM_EXPECT(feed.events[0]->isPublic);
+  CM_EXPECT_EQ(loaded.feed("getUpcomingEvents").events.size(), size_t(10));
+
+  SocialEventStoreOptions options;
+  options.maxEvents = 10;
+  SocialEventStore bounded(options);
+  CM_ASSERT(bounded.load(path));
+  CM_EXPECT_EQ(bounded.stats().events, size_t(10));
+
+  // A file cut short is rejected whole
+  std::string data;
+  CM_ASSERT(binary::readFile(path, data));
+  data.resize(data.size() - 3);
+  CM_ASSERT(binary::writeFileAtomically(path, data));
+  CM_EXPECT(!loaded.load(path));
+  CM_EXPECT_EQ(loaded.stats().events, size_t(0));
+  CM_EXPECT(!loaded.load(testing::temporaryPath("event_store", "missing")));
+  std::remove(path.c_str());
+}
@@ -0,0 +1,92 @@
+//
+//  SortedIntersectionTests.cpp
+//  ContactsManagerCore
+//
+
+#include "SortedIntersection.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace contactsmanager;
+
+namespace {
+
+// count keys from [0, universe), sorted and unique
+std::vector<uint64_t> randomSet(std::mt19937_64 &random, size_t count, uint64_t universe) {
+  std::vector<uint64_t> keys;
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back(random() % universe);
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+bool matchesScalar(const std::vector<uint64_t> &a, const std::vector<uint64_t> &b) {
+  size_t room = std::min(a.size(), b.size());
+  std::vector<uint32_t> expected(room + 1);
+  std::vector<uint32_t> actual(room + 1);
+  size_t expectedCount = intersectSortedScalar(a.data(), a.size(), b.data(), b.size(), expected.data());
+  size_t actualCount = intersectSorted(a.data(), a.size(), b.data(), b.size(), actual.data());
+  expected.resize(expectedCount);
+  actual.resize(actualCount);
+  return expected == actual &&
+         intersectSorted(a.data(), a.size(), b.data(), b.size(), nullptr) == expectedCount;
+}
+
+} // namespace
+
+CM_TEST(intersectsSmallHandWrittenSets) {
+  std::vector<uint64_t> a = {1, 3, 5, 7, 9, 11, 13, 15, 17};
+  std::vector<uint64_t> b = {2, 3, 4, 5, 15, 16, 17, 100};
+  std::vector<uint32_t> positions(8);
+  size_t count = intersectSorted(a.data(), a.size(), b.data(), b.size(), positions.data());
+  positions.resize(count);
+  CM_EXPECT(positions == (std::vector<uint32_t>{1, 2, 7, 8}));
+  CM_EXPECT_EQ(intersectSorted(a.data(), a.size(), b.data(), 0, nullptr), size_t(0));
+  CM_EXPECT_EQ(intersectSorted(a.data(), a.size(), a.data(), a.size(), nullptr), a.size());
+
+  // Keys that differ only in one 32-bit half must not match
+  std::vector<uint64_t> high = {0x100000001ULL, 0x200000002ULL, 0x300000003ULL, 0x400000004ULL};
+  std::vector<uint64_t> low = {0x000000001ULL, 0x100000002ULL, 0x300000004ULL, 0x500000004ULL};
+  CM_EXPECT_EQ(intersectSorted(high.data(), high.size(), low.data(), low.size(), nullptr), size_t(0));
+  CM_EXPECT_EQ(intersectSorted(high.data(), high.size(), high.data(), high.size(), nullptr), size_t(4));
+}
+
+CM_TEST(matchesTheScalarMergeAtEveryShape) {
+  std::mt19937_64 random(7);
+  const size_t sizes[] = {0, 1, 3, 4, 5, 8, 31, 64, 1000, 5000};
+  for (size_t aSize : sizes) {
+    for (size_t bSize : sizes) {
+      // Dense universes overlap heavily, sparse ones barely
+      for (uint64_t universe : {uint64_t(2 * (aSize + bSize) + 1), uint64_t(1) << 40}) {
+        std::vector<uint64_t> a = randomSet(random, aSize, universe);
+        std::vector<uint64_t> b = randomSet(random, bSize, universe);
+        CM_EXPECT(matchesScalar(a, b));
+      }
+    }
+  }
+}
+
+CM_TEST(gallopsWhenOneSideIsMuchSmaller) {
+  std::mt19937_64 random(11);
+  std::vector<uint64_t> large = randomSet(random, 200000, uint64_t(1) << 62);
+  std::vector<uint64_t> small;
+  for (size_t i = 0; i < large.size(); i += 997) {
+    small.push_back(large[i]);
+    small.push_back(large[i] + 1);
+  }
+  std::sort(small.begin(), small.end());
+  small.erase(std::unique(small.begin(), small.end()), small.end());
+  small.push_back(large.back() + 5);
+  small.insert(small.begin(), 0);
+
+  CM_EXPECT(matchesScalar(small, large));
+  CM_EXPECT(matchesScalar(large, small));
+  size_t expected = (large.size() + 996) / 997;
+  CM_EXPECT(intersectSorted(small.data(), small.size(), large.data(), large.size(), nullptr) >= expected);
+}
@@ -0,0 +1,245 @@
+//
+//  SyncInfoStoreTests.cpp
+//  ContactsManagerCore
+//
+
+#include "SyncInfoStore.h"
+#include "TestHarness.h"
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace contactsmanager;
+
+namespace {
+
+uint64_t fileSize(const std::string &path) {
+  struct stat info;
+  return ::stat(path.c_str(), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+}
+
+SyncInfoRecord makeRecord(uint64_t hash, double syncedAt, uint32_t flags = 0) {
+  SyncInfoRecord record;
+  record.contentHash.low = hash;
+  record.contentHash.high = ~hash;
+  record.lastSyncedAt = syncedAt;
+  record.flags = flags;
+  return record;
+}
+
+std::string contactId(size_t index) {
+  return "contact-" + std::to_string(index);
+}
+
+} // namespace
+
+CM_TEST(recordsRoundTripAcrossReopen) {
+  std::string path = testing::temporaryPath("sync_info", "roundtrip");
+  {
+    SyncInfoStore store;
+    CM_ASSERT(store.open(path));
+    CM_EXPECT_EQ(store.size(), size_t(0));
+    CM_ASSERT(store.put("a", makeRecord(1, 10.5)));
+    CM_ASSERT(store.put("b", makeRecord(2, 20.0, SyncFlag::Dirty)));
+    CM_ASSERT(store.put("a", makeRecord(3, 30.0, SyncFlag::Deleted)));
+    CM_EXPECT_EQ(store.size(), size_t(2));
+    CM_EXPECT(*store.get("a") == makeRecord(3, 30.0, SyncFlag::Deleted));
+    CM_EXPECT(!store.get("missing").has_value());
+  }
+
+  SyncInfoStore store;
+  CM_ASSERT(store.open(path));
+  CM_EXPECT_EQ(store.size(), size_t(2));
+  CM_EXPECT(*store.get("a") == makeRecord(3, 30.0, SyncFlag::Deleted));
+  CM_EXPECT(*store.get("b") == makeRecord(2, 20.0, SyncFlag::Dirty));
+  CM_EXPECT_EQ(store.discardedRecordCount(), size_t(0));
+  std::remove(path.c_str());
+}
+
+CM_TEST(updatesAppendOneRecord) {
+  std::string path = testing::temporaryPath("sync_info", "append");
+  SyncInfoStore store;
+  CM_ASSERT(store.open(path));
+  uint64_t before = fileSize(path);
+  for (size_t i = 0; i < 10; ++i) {
+    CM_ASSERT(store.put("same", makeRecord(i, static_cast<double>(i))));
+    CM_EXPECT_EQ(fileSize(path), before + (i + 1) * SyncInfoStore::kRecordSize);
+  }
+  CM_EXPECT_EQ(store.size(), size_t(1));
+  std::remove(path.c_str());
+}
+
+CM_TEST(removeWritesATombstone) {
+  std::string path = testing::temporaryPath("sync_info", "remove");
+  {
+    SyncInfoStore store;
+    CM_ASSERT(store.open(path));
+    store.put("a", makeRecord(1, 1));
+    store.put("b", makeRecord(2, 2));
+    CM_EXPECT(store.remove("a"));
+    CM_EXPECT(!store.remove("a"));
+    CM_EXPECT(!store.get("a").has_value());
+    CM_EXPECT_EQ(store.size(), size_t(1));
+  }
+  SyncInfoStore store;
+  CM_ASSERT(store.open(path));
+  CM_EXPECT(!store.get("a").has_value());
+  CM_EXPECT_EQ(store.size(), size_t(1));
+  std::remove(path.c_str());
+}
+
+CM_TEST(compactionKeepsLatestRecords) {
+  std::string path = testing::temporaryPath("sync_info", "compact");
+  std::unordered_map<std::string, SyncInfoRecord> expected;
+  SyncInfoStore store;
+  CM_ASSERT(store.open(path));
+  store.setCompactionThreshold(64);
+  for (size_t round = 0; round < 5; ++round) {
+    for (size_t i = 0; i < 100; ++i) {
+      if ((i + round) % 7 == 0) {
+        store.remove(contactId(i));
+        expected.erase(contactId(i));
+      } else {
+        SyncInfoRecord record = makeRecord(i * 10 + round, static_cast<double>(round));
+        store.put(contactId(i), record);
+        expected[contactId(i)] = record;
+      }
+    }
+  }
+  // Automatic compaction keeps the tail below the threshold
+  CM_EXPECT(store.tailRecordCount() < size_t(64));
+  CM_ASSERT(store.compact());
+  CM_EXPECT_EQ(store.tailRecordCount(), size_t(0));
+  CM_EXPECT_EQ(store.size(), expected.size());
+  CM_EXPECT_EQ(fileSize(path), SyncInfoStore::kHeaderSize + expected.size() * SyncInfoStore::kRecordSize);
+
+  SyncInfoStore reopened;
+  CM_ASSERT(reopened.open(path));
+  CM_EXPECT_EQ(reopened.size(), expected.size());
+  for (size_t i = 0; i < 100; ++i) {
+    auto found = expected.find(contactId(i));
+    auto record = reopened.get(contactId(i));
+    CM_EXPECT_EQ(record.has_value(), found != expected.end());
+    if (record && found != expected.end()) {
+      CM_EXPECT(*record == found->second);
+    }
+  }
+  size_t visited = 0;
+  reopened.forEach([&](uint64_t, const SyncInfoRecord &) { visited++; });
+  CM_EXPECT_EQ(visited, expected.size());
+  std::remove(path.c_str());
+}
+
+CM_TEST(tornTailRecordIsDiscarded) {
+  std::string path = testing::temporaryPath("sync_info", "torn");
+  {
+    SyncInfoStore store;
+    CM_ASSERT(store.open(path));
+    for (size_t i = 0; i < 10; ++i) {
+      store.put(contactId(i), makeRecord(i, 1));
+    }
+    CM_ASSERT(store.compact());
+    store.put("tail-1", makeRecord(100, 2));
+    store.put("tail-2", makeRecord(200, 3));
+  }
+  // Crash half-way through writing the second tail record
+  uint64_t size = fileSize(path);
+  CM_ASSERT(::truncate(path.c_str(), static_cast<off_t>(size - SyncInfoStore::kRecordSize / 2)) == 0);
+
+  {
+    SyncInfoStore store;
+    CM_ASSERT(store.open(path));
+    CM_EXPECT_EQ(store.discardedRecordCount(), size_t(1));
+    CM_EXPECT_EQ(store.size(), size_t(11));
+    CM_EXPECT(store.get("tail-1").has_value());
+    CM_EXPECT(!store.get("tail-2").has_value());
+    CM_EXPECT_EQ(fileSize(path), size - SyncInfoStore::kRecordSize);
+    // Appends continue at the recovered end
+    CM_ASSERT(store.put("tail-3", makeRecord(300, 4)));
+  }
+  SyncInfoStore store;
+  CM_ASSERT(store.open(path));
+  CM_EXPECT_EQ(store.discardedRecordCount(), size_t(0));
+  CM_EXPECT_EQ(store.size(), size_t(12));
+  CM_EXPECT(*store.get("tail-3") == makeRecord(300, 4));
+  std::remove(path.c_str());
+}
+
+CM_TEST(corruptTailRecordEndsTheTail) {
+  std::string path = testing::temporaryPath("sync_info", "corrupt");
+  {
+    SyncInfoStore store;
+    CM_ASSERT(store.open(path));
+    store.put("a", makeRecord(1, 1));
+    store.put("b", makeRecord(2, 2));
+    store.put("c", makeRecord(3, 3));
+  }
+  // Flip a byte inside the second record (a write that never fully reached the disk)
+  FILE *file = std::fopen(path.c_str(), "r+b");
+  CM_ASSERT(file != nullptr);
+  std::fseek(file, static_cast<long>(SyncInfoStore::kHeaderSize + SyncInfoStore::kRecordSize + 12), SEEK_SET);
+  std::fputc(0x5a, file);
+  std::fclose(file);
+
+  SyncInfoStore store;
+  CM_ASSERT(store.open(path));
+  CM_EXPECT_EQ(store.discardedRecordCount(), size_t(2));
+  CM_EXPECT(store.get("a").has_value());
+  CM_EXPECT(!store.get("b").has_value());
+  CM_EXPECT(!store.get("c").has_value());
+  CM_EXPECT_EQ(fileSize(path), uint64_t(SyncInfoStore::kHeaderSize + SyncInfoStore::kRecordSize));
+  std::remove(path.c_str());
+}
+
+CM_TEST(crashDuringCompactionKeepsTheOldFile) {
+  std::string path = testing::temporaryPath("sync_info", "interrupted");
+  {
+    SyncInfoStore store;
+    CM_ASSERT(store.open(path));
+    store.put("a", makeRecord(1, 1));
+    store.put("b", makeRecord(2, 2));
+  }
+  // A compaction that died before its rename leaves only a stray temporary file
+  std::string compactionPath = path + ".tmp";
+  FILE *file = std::fopen(compactionPath.c_str(), "wb");
+  CM_ASSERT(file != nullptr);
+  std::fputs("partial", file);
+  std::fclose(file);
+
+  SyncInfoStore store;
+  CM_ASSERT(store.open(path));
+  CM_EXPECT_EQ(store.size(), size_t(2));
+  CM_ASSERT(store.compact());
+  CM_EXPECT(*store.get("b") == makeRecord(2, 2));
+  std::remove(compactionPath.c_str());
+  std::remove(path.c_str());
+}
+
+CM_TEST(rejectsForeignFilesAndRecreatesTornHeaders) {
+  std::string path = testing::temporaryPath("sync_info", "foreign");
+  FILE *file = std::fopen(path.c_str(), "wb");
+  CM_ASSERT(file != nullptr);
+  std::fputs("this is not a sync info store at all", file);
+  std::fclose(file);
+  SyncInfoStore store;
+  CM_EXPECT(!store.open(path));
+  CM_EXPECT(!store.isOpen());
+  CM_EXPECT(!store.put("a", makeRecord(1, 1)));
+
+  // Shorter than a header: the process died while creating the file
+  file = std::fopen(path.c_str(), "wb");
+  std::fputs("CMSS", file);
+  std::fclose(file);
+  CM_ASSERT(store.open(path));
+  CM_EXPECT_EQ(store.size(), size_t(0));
+  CM_ASSERT(store.put("a", makeRecord(1, 1)));
+
+  CM_ASSERT(store.clear());
+  CM_EXPECT_EQ(store.size(), size_t(0));
+  CM_EXPECT_EQ(fileSize(path), uint64_t(SyncInfoStore::kHeaderSize));
+  std::remove(path.c_str());
+}
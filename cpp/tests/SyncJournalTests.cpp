@@ -0,0 +1,299 @@
+//
+//  SyncJournalTests.cpp
+//  ContactsManagerCore
+//
+
+#include "ContactHashing.h"
+#include "JsonValue.h"
+#include "ResumableContactSync.h"
+#include "ServerContactJson.h"
+#include "SimulatedSyncServer.h"
+#include "SimulatedUploadTransport.h"
+#include "SyncInfoStore.h"
+#include "SyncJournal.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace contactsmanager;
+using namespace std::chrono_literals;
+
+namespace {
+
+const ServerContactContext kContext{"org-1", "source-1"};
+
+std::vector<JournalEntry> entriesFor(uint64_t firstKey, size_t count) {
+  std::vector<JournalEntry> entries;
+  for (size_t i = 0; i < count; ++i) {
+    entries.push_back({firstKey + i, hash128("contact-" + std::to_string(firstKey + i))});
+  }
+  return entries;
+}
+
+off_t fileSize(const std::string &path) {
+  struct stat info;
+  return ::stat(path.c_str(), &info) == 0 ? info.st_size : -1;
+}
+
+std::string encodeBody(const std::vector<const Contact *> &contacts) {
+  return encodeBulkCreateBody(contacts, kContext, false);
+}
+
+UploadPipelineOptions smallBatches() {
+  UploadPipelineOptions options;
+  options.initialBatchSize = 20;
+  options.minBatchSize = 5;
+  options.maxBatchSize = 40;
+  options.maxInFlight = 3;
+  options.uploadTimeout = 1000ms;
+  options.targetLatency = 20ms;
+  return options;
+}
+
+// Runs a sync that dies once the server has handled crashAfter requests: that
+// request and any still in flight reach the server, but their responses are
+// lost with the process
+ResumableSyncReport runUntilCrash(const std::string &path, testing::SimulatedSyncServer &server,
+                                  const std::vector<Contact> &book, size_t crashAfter) {
+  SyncJournal journal;
+  if (!journal.open(path)) {
+    return {};
+  }
+  size_t handled = 0;
+  ResumableContactSync *running = nullptr;
+  testing::SimulatedUploadTransport transport({500us, 0}, [&](const UploadRequest &request, std::string &) {
+    server.handleBulkCreate(request.body, request.idempotencyKey);
+    if (++handled < crashAfter) {
+      return true;
+    }
+    if (handled == crashAfter) {
+      running->cancel();
+    }
+    return false;
+  });
+  ResumableContactSync sync(journal, transport, smallBatches());
+  running = &sync;
+  return sync.run("session-1", book, encodeBody);
+}
+
+ResumableSyncReport resume(testing::SimulatedSyncServer &server, const std::vector<Contact> &book,
+                           SyncJournal &journal) {
+  testing::SimulatedUploadTransport transport({500us, 0}, [&](const UploadRequest &request, std::string &) {
+    return server.handleBulkCreate(request.body, request.idempotencyKey).ok;
+  });
+  ResumableContactSync sync(journal, transport, smallBatches());
+  return sync.run("session-2", book, encodeBody);
+}
+
+} // namespace
+
+CM_TEST(journalReplaysSessionAcrossReopen) {
+  std::string path = "cm_sync_journal_replay.bin";
+  std::remove(path.c_str());
+  std::string first;
+  std::string second;
+  {
+    SyncJournal journal;
+    CM_ASSERT(journal.open(path));
+    CM_EXPECT(journal.sessionId().empty());
+    CM_EXPECT(journal.beginBatch(entriesFor(1, 3)).empty());
+    CM_ASSERT(journal.beginSession("s1"));
+    first = journal.beginBatch(entriesFor(1, 3));
+    second = journal.beginBatch(entriesFor(10, 2));
+    CM_EXPECT(!first.empty() && first != second);
+    CM_EXPECT(journal.acknowledgeBatch(first));
+    CM_EXPECT(!journal.acknowledgeBatch("unknown"));
+  }
+
+  SyncJournal journal;
+  CM_ASSERT(journal.open(path));
+  CM_EXPECT_EQ(journal.sessionId(), std::string("s1"));
+  CM_EXPECT_EQ(journal.acknowledgedCount(), size_t(3));
+  CM_EXPECT(journal.isAcknowledged(entriesFor(2, 1)[0]));
+  CM_EXPECT(!journal.isAcknowledged({2, hash128("changed")}));
+  std::vector<PendingBatch> pending = journal.pendingBatches();
+  CM_ASSERT(pending.size() == 1);
+  CM_EXPECT_EQ(pending[0].idempotencyKey, second);
+  CM_EXPECT_EQ(pending[0].entries.size(), size_t(2));
+  CM_EXPECT(pending[0].entries[1].contentHash == entriesFor(11, 1)[0].contentHash);
+  // Keys keep counting after a reopen, so a resumed run never reuses one
+  std::string third = journal.beginBatch(entriesFor(20, 1));
+  CM_EXPECT(third != first && third != second);
+
+  CM_EXPECT(journal.abandonBatch(second));
+  CM_EXPECT_EQ(journal.pendingBatches().size(), size_t(1));
+  CM_ASSERT(journal.finishSession());
+  CM_EXPECT(journal.sessionId().empty());
+  CM_EXPECT_EQ(journal.acknowledgedCount(), size_t(0));
+  CM_EXPECT_EQ(fileSize(path), off_t(8));
+  std::remove(path.c_str());
+}
+
+CM_TEST(journalDropsTornAndCorruptRecords) {
+  std::string path = "cm_sync_journal_torn.bin";
+  std::remove(path.c_str());
+  std::string first;
+  off_t afterAck = 0;
+  {
+    SyncJournal journal;
+    CM_ASSERT(journal.open(path));
+    CM_ASSERT(journal.beginSession("s1"));
+    first = journal.beginBatch(entriesFor(1, 4));
+    CM_ASSERT(journal.acknowledgeBatch(first));
+    afterAck = fileSize(path);
+    journal.beginBatch(entriesFor(5, 4));
+  }
+
+  // A crash while writing the second begin record
+  CM_ASSERT(::truncate(path.c_str(), fileSize(path) - 5) == 0);
+  {
+    SyncJournal journal;
+    CM_ASSERT(journal.open(path));
+    CM_EXPECT(journal.discardedBytes() > 0);
+    CM_EXPECT_EQ(fileSize(path), afterAck);
+    CM_EXPECT_EQ(journal.acknowledgedCount(), size_t(4));
+    CM_EXPECT(journal.pendingBatches().empty());
+  }
+
+  // A flipped byte in the ack turns the batch back into a pending one
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(afterAck - 6);
+    file.put('\x7f');
+  }
+  {
+    SyncJournal journal;
+    CM_ASSERT(journal.open(path));
+    CM_EXPECT_EQ(journal.acknowledgedCount(), size_t(0));
+    std::vector<PendingBatch> pending = journal.pendingBatches();
+    CM_ASSERT(pending.size() == 1);
+    CM_EXPECT_EQ(pending[0].idempotencyKey, first);
+  }
+
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "not a journal";
+  }
+  SyncJournal journal;
+  CM_EXPECT(!journal.open(path));
+  std::remove(path.c_str());
+}
+
+CM_TEST(resumedSyncAppliesEveryContactExactlyOnce) {
+  std::string path = "cm_sync_journal_crash.bin";
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(300);
+  for (size_t crashAfter = 1; crashAfter <= 6; ++crashAfter) {
+    std::remove(path.c_str());
+    testing::SimulatedSyncServer server;
+    ResumableSyncReport crashed = runUntilCrash(path, server, book, crashAfter);
+    CM_EXPECT(!crashed.ok);
+    CM_EXPECT(crashed.cancelled);
+    if (crashAfter % 2 == 0) {
+      // The process also died halfway through writing an ack
+      std::ofstream file(path, std::ios::binary | std::ios::app);
+      file.write("\x03\x00\x00\x00\x20\x00\x00", 7);
+    }
+
+    SyncJournal journal;
+    CM_ASSERT(journal.open(path));
+    CM_EXPECT_EQ(journal.sessionId(), std::string("session-1"));
+    CM_EXPECT(!journal.pendingBatches().empty());
+    size_t acknowledged = journal.acknowledgedCount();
+
+    ResumableSyncReport report = resume(server, book, journal);
+    CM_EXPECT(report.ok);
+    CM_EXPECT(report.resumed);
+    CM_EXPECT_EQ(report.skipped, acknowledged);
+    CM_EXPECT(report.resent > 0);
+    CM_EXPECT_EQ(report.skipped + report.resent + report.upload.uploaded, book.size());
+    CM_EXPECT_EQ(server.size(), book.size());
+    // Batches whose answer was lost came back under their keys and were not applied twice
+    CM_EXPECT_EQ(server.contactsApplied(), book.size());
+    CM_EXPECT(server.replayedRequests() > 0);
+    CM_EXPECT(journal.sessionId().empty());
+  }
+  std::remove(path.c_str());
+}
+
+CM_TEST(timedOutBatchesAreRetriedUnderTheirKeys) {
+  std::string path = "cm_sync_journal_timeout.bin";
+  std::remove(path.c_str());
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(200);
+  testing::SimulatedSyncServer server;
+  testing::SimulatedUploadTransport transport({500us, 0}, [&](const UploadRequest &request, std::string &) {
+    return server.handleBulkCreate(request.body, request.idempotencyKey).ok;
+  });
+  // Applied by the server, but the client only sees the timeout
+  transport.loseResponseNext(2);
+  SyncJournal journal;
+  CM_ASSERT(journal.open(path));
+  ResumableContactSync sync(journal, transport, smallBatches());
+  ResumableSyncReport report = sync.run("session-1", book, encodeBody);
+  CM_EXPECT(report.ok);
+  CM_EXPECT_EQ(report.upload.retries, size_t(2));
+  CM_EXPECT_EQ(server.size(), book.size());
+  CM_EXPECT_EQ(server.contactsApplied(), book.size());
+  CM_EXPECT_EQ(server.replayedRequests(), size_t(2));
+
+  // Rejected batches are split and their parts sent under new keys
+  testing::SimulatedSyncServer splitServer;
+  testing::SimulatedUploadTransport failing({500us, 0}, [&](const UploadRequest &request, std::string &) {
+    return splitServer.handleBulkCreate(request.body, request.idempotencyKey).ok;
+  });
+  failing.failNext(2);
+  ResumableContactSync splitSync(journal, failing, smallBatches());
+  report = splitSync.run("session-2", book, encodeBody);
+  CM_EXPECT(report.ok);
+  CM_EXPECT(report.upload.retries >= 4);
+  CM_EXPECT_EQ(splitServer.contactsApplied(), book.size());
+  CM_EXPECT_EQ(splitServer.replayedRequests(), size_t(0));
+  journal.close();
+  std::remove(path.c_str());
+}
+
+CM_TEST(resumedSyncUploadsContactsChangedSinceTheCrash) {
+  std::string path = "cm_sync_journal_changed.bin";
+  std::remove(path.c_str());
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(200);
+  testing::SimulatedSyncServer server;
+  runUntilCrash(path, server, book, 4);
+
+  SyncJournal journal;
+  CM_ASSERT(journal.open(path));
+  std::vector<PendingBatch> pending = journal.pendingBatches();
+  CM_ASSERT(!pending.empty());
+  // Edit one acknowledged contact and one in a batch whose answer was lost
+  size_t acknowledged = 0;
+  size_t inFlight = 0;
+  for (size_t i = 0; i < book.size(); ++i) {
+    JournalEntry entry{SyncInfoStore::keyFor(book[i].identifier), contactHash128(book[i])};
+    if (journal.isAcknowledged(entry)) {
+      acknowledged = i;
+    }
+    if (entry.contactKey == pending[0].entries[0].contactKey) {
+      inFlight = i;
+    }
+  }
+  for (size_t index : {acknowledged, inFlight}) {
+    book[index].jobTitle = "Changed after the crash";
+    book[index].updateDisplayInfo();
+  }
+
+  ResumableSyncReport report = resume(server, book, journal);
+  CM_EXPECT(report.ok);
+  CM_EXPECT_EQ(server.size(), book.size());
+  for (size_t index : {acknowledged, inFlight}) {
+    const testing::JsonValue *stored = server.contact(book[index].identifier);
+    CM_ASSERT(stored != nullptr);
+    CM_EXPECT_EQ(stored->find("jobTitle")->string, std::string("Changed after the crash"));
+  }
+  std::remove(path.c_str());
+}
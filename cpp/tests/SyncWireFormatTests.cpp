@@ -0,0 +1,200 @@
+//
+//  SyncWireFormatTests.cpp
+//  ContactsManagerCore
+//
+
+#include "CborDecoder.h"
+#include "CborWriter.h"
+#include "DeflateStream.h"
+#include "JsonValue.h"
+#include "ServerContactJson.h"
+#include "SimulatedSyncServer.h"
+#include "SyncWireFormat.h"
+#include "SyntheticAddressBook.h"
+#include "TestHarness.h"
+
+#include <string>
+#include <vector>
+
+using namespace contactsmanager;
+using testing::JsonValue;
+
+namespace {
+
+const ServerContactContext kContext{"org-1", "source-1"};
+
+std::string hex(const std::string &bytes) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string text;
+  for (unsigned char byte : bytes) {
+    text.push_back(kDigits[byte >> 4]);
+    text.push_back(kDigits[byte & 0xf]);
+  }
+  return text;
+}
+
+template <typename Write>
+std::string cbor(Write write, bool shareStrings = false) {
+  std::string out;
+  CborWriter writer(out, shareStrings);
+  write(writer);
+  return hex(out);
+}
+
+} // namespace
+
+CM_TEST(cborMatchesRfcExamples) {
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.intValue(0); }), std::string("00"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.intValue(23); }), std::string("17"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.intValue(24); }), std::string("1818"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.intValue(1000); }), std::string("1903e8"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.intValue(1000000); }), std::string("1a000f4240"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.intValue(1000000000000); }), std::string("1b000000e8d4a51000"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.intValue(-1); }), std::string("20"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.intValue(-1000); }), std::string("3903e7"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.doubleValue(1.1); }), std::string("fb3ff199999999999a"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.doubleValue(0.0 / 0.0); }), std::string("f6"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.boolValue(true); }), std::string("f5"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.stringValue("IETF"); }), std::string("6449455446"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) { w.stringValue("\xc3\xbc"); }), std::string("62c3bc"));
+  CM_EXPECT_EQ(cbor([](CborWriter &w) {
+                 w.beginObject();
+                 w.field("a", "A");
+                 w.key("b");
+                 w.beginArray();
+                 w.nullValue();
+                 w.endArray();
+                 w.endObject();
+               }),
+               std::string("bf6161614161629ff6ffff"));
+}
+
+CM_TEST(cborSharesRepeatedStrings) {
+  std::string out;
+  CborWriter writer(out);
+  writer.beginArray();
+  for (int i = 0; i < 3; ++i) {
+    writer.beginObject();
+    writer.field("label", "mobile");
+    writer.field("ab", "ab");
+    writer.endObject();
+  }
+  writer.endArray();
+  CM_EXPECT_EQ(writer.depth(), size_t(0));
+  // Namespace tag, then "label" and "mobile" in full once and as refs 0 and 1
+  // after; two-byte strings are too short to number
+  CM_EXPECT_EQ(hex(out), std::string("d90100"
+                                     "9f"
+                                     "bf656c6162656c666d6f62696c65626162626162ff"
+                                     "bfd81900d81901626162626162ff"
+                                     "bfd81900d81901626162626162ff"
+                                     "ff"));
+
+  auto decoded = testing::decodeCbor(out);
+  CM_ASSERT(decoded.has_value());
+  CM_ASSERT(decoded->array.size() == 3);
+  for (const auto &item : decoded->array) {
+    CM_EXPECT_EQ(item.find("label")->string, std::string("mobile"));
+    CM_EXPECT_EQ(item.find("ab")->string, std::string("ab"));
+  }
+
+  std::string plain;
+  CborWriter plainWriter(plain, false);
+  plainWriter.beginArray();
+  for (int i = 0; i < 3; ++i) {
+    plainWriter.beginObject();
+    plainWriter.field("label", "mobile");
+    plainWriter.field("ab", "ab");
+    plainWriter.endObject();
+  }
+  plainWriter.endArray();
+  CM_EXPECT(out.size() < plain.size());
+  CM_EXPECT(testing::decodeCbor(plain) == decoded);
+}
+
+CM_TEST(cborDecoderRejectsMalformedInput) {
+  CM_EXPECT(!testing::decodeCbor("").has_value());
+  // Truncated string, missing break, reference outside a namespace, trailing byte
+  CM_EXPECT(!testing::decodeCbor("\x64IE").has_value());
+  CM_EXPECT(!testing::decodeCbor("\x9f\x01").has_value());
+  CM_EXPECT(!testing::decodeCbor(std::string("\xd8\x19\x00", 3)).has_value());
+  CM_EXPECT(!testing::decodeCbor(std::string("\x01\x01", 2)).has_value());
+  auto half = testing::decodeCbor(std::string("\xf9\x3c\x00", 3));
+  CM_ASSERT(half.has_value());
+  CM_EXPECT_EQ(half->number, 1.0);
+}
+
+CM_TEST(deflateStreamRoundTrips) {
+  std::string input;
+  for (int i = 0; i < 5000; ++i) {
+    input += "contact " + std::to_string(i) + " mobile +1 555 0100\n";
+  }
+  for (DeflateFormat format : {DeflateFormat::Zlib, DeflateFormat::Gzip}) {
+    std::string compressed;
+    DeflateStream stream(compressed, format);
+    // Uneven pieces, as the encoder hands over one contact at a time
+    for (size_t offset = 0; offset < input.size(); offset += 997) {
+      CM_ASSERT(stream.write(std::string_view(input).substr(offset, 997)));
+    }
+    CM_ASSERT(stream.finish());
+    CM_EXPECT(!stream.write("late"));
+    CM_EXPECT_EQ(stream.bytesIn(), input.size());
+    CM_EXPECT(compressed.size() < input.size() / 4);
+
+    std::string inflated;
+    CM_ASSERT(inflateBytes(compressed, inflated));
+    CM_EXPECT(inflated == input);
+    std::string truncated;
+    CM_EXPECT(!inflateBytes(std::string_view(compressed).substr(0, compressed.size() / 2), truncated));
+  }
+  std::string garbage;
+  CM_EXPECT(!inflateBytes("not deflate", garbage));
+}
+
+CM_TEST(everyEncodingDecodesToTheJsonBody) {
+  std::vector<Contact> book = testing::makeSyntheticAddressBook(250);
+  book[3].birthday = 86400.0 * 365;
+  book[4].contactType = 2;
+  std::optional<JsonValue> expected = JsonValue::parse(encodeBulkCreateBody(book, kContext, true));
+  CM_ASSERT(expected.has_value());
+
+  size_t jsonSize = 0;
+  for (WireFormat format : {WireFormat::Json, WireFormat::Cbor}) {
+    for (WireCompression compression : {WireCompression::None, WireCompression::Deflate, WireCompression::Gzip}) {
+      WireEncoding encoding{format, compression};
+      std::string body = encodeBulkCreateBody(book.data(), book.size(), kContext, true, encoding);
+      CM_ASSERT(!body.empty());
+      std::optional<JsonValue> decoded = testing::decodeRequestBody(body, encoding);
+      CM_ASSERT(decoded.has_value());
+      CM_EXPECT(*decoded == *expected);
+      if (format == WireFormat::Json && compression == WireCompression::None) {
+        jsonSize = body.size();
+        CM_EXPECT(body == encodeBulkCreateBody(book, kContext, true));
+      } else {
+        CM_EXPECT(body.size() < jsonSize);
+      }
+
+      testing::SimulatedSyncServer server;
+      CM_EXPECT_EQ(server.handleBulkCreate(body, encoding).upserted, book.size());
+      CM_EXPECT(*server.contact(book[3].identifier) == expected->find("contacts")->array[3]);
+    }
+  }
+}
+
+CM_TEST(encodingIsNegotiatedFromServerHeaders) {
+  WireEncoding plain;
+  CM_EXPECT(negotiateWireEncoding("", "") == plain);
+  CM_EXPECT(negotiateWireEncoding("application/json", "identity") == plain);
+
+  WireEncoding best{WireFormat::Cbor, WireCompression::Deflate};
+  CM_EXPECT(negotiateWireEncoding("application/json, Application/CBOR", "gzip, deflate") == best);
+  CM_EXPECT(negotiateWireEncoding("application/cbor;q=0.9", "deflate;q=1") == best);
+
+  WireEncoding gzip{WireFormat::Json, WireCompression::Gzip};
+  CM_EXPECT(negotiateWireEncoding("application/cbor;q=0", "deflate; q=0.0, gzip") == gzip);
+  CM_EXPECT(negotiateWireEncoding("application/cborx", "xgzip, gzip") == gzip);
+
+  CM_EXPECT_EQ(std::string(wireContentType(WireFormat::Cbor)), std::string("application/cbor"));
+  CM_EXPECT_EQ(std::string(wireContentEncoding(WireCompression::None)), std::string());
+  CM_EXPECT_EQ(std::string(wireContentEncoding(WireCompression::Gzip)), std::string("gzip"));
+}
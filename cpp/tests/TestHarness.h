@@ -0,0 +1,108 @@
+//
+//  TestHarness.h
+//  ContactsManagerCore
+//
+//  Minimal self-registering test harness so the core builds without external
+//  test dependencies. Each test source links TestMain.cpp and runs under ctest.
+//
+
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace contactsmanager {
+namespace testing {
+
+struct TestCase {
+  const char *name;
+  std::function<void()> body;
+};
+
+std::vector<TestCase> &registeredTests();
+
+/**
+ * Records a failed expectation for the currently running test
+ */
+void reportFailure(const char *file, int line, const std::string &message);
+
+struct TestRegistrar {
+  TestRegistrar(const char *name, std::function<void()> body) {
+    registeredTests().push_back({name, std::move(body)});
+  }
+};
+
+/**
+ * File in the working directory for a test that persists state, e.g.
+ * temporaryPath("sync_info", "roundtrip") is cm_sync_info_roundtrip.bin.
+ * A file left behind by an earlier run is removed first.
+ */
+inline std::string temporaryPath(const char *prefix, const char *name) {
+  std::string path = std::string("cm_") + prefix + "_" + name + ".bin";
+  std::remove(path.c_str());
+  return path;
+}
+
+template <typename T>
+std::string describe(const T &value) {
+  std::ostringstream stream;
+  stream << value;
+  return stream.str();
+}
+
+inline std::string describe(const std::string &value) {
+  return "\"" + value + "\"";
+}
+
+inline std::string describe(bool value) {
+  return value ? "true" : "false";
+}
+
+template <typename T>
+std::string describe(const std::vector<T> &values) {
+  std::string out = "[";
+  for (size_t i = 0; i < values.size(); ++i) {
+    out += (i == 0 ? "" : ", ") + describe(values[i]);
+  }
+  return out + "]";
+}
+
+} // namespace testing
+} // namespace contactsmanager
+
+#define CM_TEST(name)                                                                              \
+  static void name();                                                                              \
+  static ::contactsmanager::testing::TestRegistrar name##_registrar(#name, name);                  \
+  static void name()
+
+#define CM_EXPECT(condition)                                                                       \
+  do {                                                                                             \
+    if (!(condition)) {                                                                            \
+      ::contactsmanager::testing::reportFailure(__FILE__, __LINE__, "expected " #condition);       \
+    }                                                                                              \
+  } while (0)
+
+// Operands are copied: a reference to a member of a temporary would dangle
+#define CM_EXPECT_EQ(actual, expected)                                                             \
+  do {                                                                                             \
+    const auto cmActual = (actual);                                                                \
+    const auto cmExpected = (expected);                                                            \
+    if (!(cmActual == cmExpected)) {                                                               \
+      ::contactsmanager::testing::reportFailure(                                                   \
+          __FILE__, __LINE__,                                                                      \
+          std::string(#actual " == " #expected ", got ") +                                         \
+              ::contactsmanager::testing::describe(cmActual) + " vs " +                            \
+              ::contactsmanager::testing::describe(cmExpected));                                   \
+    }                                                                                              \
+  } while (0)
+
+#define CM_ASSERT(condition)                                                                       \
+  do {                                                                                             \
+    if (!(condition)) {                                                                            \
+      ::contactsmanager::testing::reportFailure(__FILE__, __LINE__, "required " #condition);       \
+      return;                                                                                      \
+    }                                                                                              \
+  } while (0)
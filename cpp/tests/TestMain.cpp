@@ -0,0 +1,52 @@
+//
+//  TestMain.cpp
+//  ContactsManagerCore
+//
+
+#include "TestHarness.h"
+
+#include <cstring>
+
+namespace contactsmanager {
+namespace testing {
+
+namespace {
+int gFailures = 0;
+const char *gCurrentTest = "";
+} // namespace
+
+std::vector<TestCase> &registeredTests() {
+  static std::vector<TestCase> tests;
+  return tests;
+}
+
+void reportFailure(const char *file, int line, const std::string &message) {
+  ++gFailures;
+  std::fprintf(stderr, "  %s:%d: %s: %s\n", file, line, gCurrentTest, message.c_str());
+}
+
+} // namespace testing
+} // namespace contactsmanager
+
+int main(int argc, char **argv) {
+  using namespace contactsmanager::testing;
+  const char *filter = argc > 1 ? argv[1] : nullptr;
+  int failedTests = 0;
+  int ranTests = 0;
+  for (const auto &test : registeredTests()) {
+    if (filter && std::strstr(test.name, filter) == nullptr) {
+      continue;
+    }
+    int failuresBefore = gFailures;
+    gCurrentTest = test.name;
+    test.body();
+    ++ranTests;
+    bool passed = gFailures == failuresBefore;
+    if (!passed) {
+      ++failedTests;
+    }
+    std::printf("[%s] %s\n", passed ? " OK " : "FAIL", test.name);
+  }
+  std::printf("%d/%d tests passed\n", ranTests - failedTests, ranTests);
+  return failedTests == 0 ? 0 : 1;
+}
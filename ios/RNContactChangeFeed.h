@@ -0,0 +1,67 @@
+#import <Foundation/Foundation.h>
+#import <ContactsManagerObjc/ContactsManagerObjc.h>
+
+#ifdef __cplusplus
+#include <vector>
+
+#include "ContactChangeFeed.h"
+#endif
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Contacts changed in the store since the last committed sync
+ */
+@interface RNContactChanges : NSObject
+
+@property (nonatomic, copy) NSArray<CMContact *> *added;
+@property (nonatomic, copy) NSArray<CMContact *> *updated;
+@property (nonatomic, copy) NSArray<NSString *> *deletedIdentifiers;
+// YES when the change history could not be used and the whole store was hashed
+@property (nonatomic) BOOL fullScan;
+// Pass to commitChangesWithToken: once the changes are synced
+@property (nonatomic, copy) NSString *token;
+
+@end
+
+/**
+ * Incremental sync feed over the contact store's change history, backed by the
+ * core ContactChangeTracker and persisted under Application Support.
+ */
+@interface RNContactChangeFeed : NSObject
+
++ (instancetype)sharedFeed;
+
+/**
+ * Computes the changes since the last commit on a background queue. The
+ * change set stays pending until it is committed or replaced.
+ */
+- (void)fetchChangesWithCompletion:(void (^)(RNContactChanges *_Nullable changes, NSError *_Nullable error))completion;
+
+/**
+ * Marks the pending changes with this token as synced
+ * @return NO if the token does not belong to the pending changes
+ */
+- (BOOL)commitChangesWithToken:(NSString *)token;
+
+/**
+ * Forgets every synced contact; the next fetch does a full scan
+ */
+- (void)reset;
+
+#ifdef __cplusplus
+/**
+ * Changes to the store since the last commit of tracker, replayed from the
+ * store's change history or found by a full scan when the history cannot be
+ * used. Runs synchronously; call it off the main thread. The sync feed uses
+ * its own tracker, so other consumers keep theirs.
+ * @param scanned Receives every contact in the store when a full scan ran
+ */
++ (contactsmanager::ContactChangeSet)changesSinceTracker:(const contactsmanager::ContactChangeTracker &)tracker
+                                                 scanned:(nullable std::vector<contactsmanager::Contact> *)scanned
+                                                   error:(NSError **)error;
+#endif
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,290 @@
+#import "RNContactChangeFeed.h"
+#import "RNContactCoreBridge.h"
+
+#import <Contacts/Contacts.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "ContactChangeFeed.h"
+
+using contactsmanager::ChangeHistoryStatus;
+using contactsmanager::ContactChangeEvent;
+using contactsmanager::ContactChangeKind;
+
+@interface RNChangeHistoryVisitor : NSObject <CNChangeHistoryEventVisitor>
+
+@property (nonatomic, readonly) BOOL dropEverything;
+
+- (instancetype)initWithVisit:(const std::function<void(const ContactChangeEvent &)> *)visit;
+
+@end
+
+@implementation RNChangeHistoryVisitor {
+    const std::function<void(const ContactChangeEvent &)> *_visit;
+}
+
+- (instancetype)initWithVisit:(const std::function<void(const ContactChangeEvent &)> *)visit {
+    if (self = [super init]) {
+        _visit = visit;
+    }
+    return self;
+}
+
+- (void)visitDropEverythingEvent:(CNChangeHistoryDropEverythingEvent *)event {
+    _dropEverything = YES;
+}
+
+- (void)visitAddContactEvent:(CNChangeHistoryAddContactEvent *)event {
+    (*_visit)(ContactChangeEvent{ContactChangeKind::Added, [RNContactCoreBridge stdStringFromString:event.contact.identifier]});
+}
+
+- (void)visitUpdateContactEvent:(CNChangeHistoryUpdateContactEvent *)event {
+    (*_visit)(ContactChangeEvent{ContactChangeKind::Updated, [RNContactCoreBridge stdStringFromString:event.contact.identifier]});
+}
+
+- (void)visitDeleteContactEvent:(CNChangeHistoryDeleteContactEvent *)event {
+    (*_visit)(ContactChangeEvent{ContactChangeKind::Deleted, [RNContactCoreBridge stdStringFromString:event.contactIdentifier]});
+}
+
+@end
+
+namespace {
+
+std::string tokenString(NSData *token) {
+    return token ? [RNContactCoreBridge stdStringFromString:[token base64EncodedStringWithOptions:0]] : std::string();
+}
+
+// CNContactStore change history; tokens are the store's NSData tokens in base64
+class CNContactChangeHistory final : public contactsmanager::ContactChangeHistory {
+public:
+    explicit CNContactChangeHistory(CNContactStore *store) : store_(store) {}
+
+    std::string currentToken() const override {
+        return tokenString(store_.currentHistoryToken);
+    }
+
+    ChangeHistoryStatus changesSince(const std::string &token,
+                                     const std::function<void(const ContactChangeEvent &)> &visit,
+                                     std::string &nextToken) const override {
+        NSData *startingToken = [[NSData alloc] initWithBase64EncodedString:[NSString stringWithUTF8String:token.c_str()] options:0];
+        if (!startingToken) {
+            return ChangeHistoryStatus::Unavailable;
+        }
+
+        CNChangeHistoryFetchRequest *request = [CNChangeHistoryFetchRequest new];
+        request.startingToken = startingToken;
+        request.shouldUnifyResults = YES;
+        request.includeGroupChanges = NO;
+        // Only identifiers are needed; changed contacts are fetched afterwards
+        request.additionalContactKeyDescriptors = @[];
+
+        NSError *error = nil;
+        CNFetchResult<NSEnumerator<CNChangeHistoryEvent *> *> *result = [store_ enumeratorForChangeHistoryFetchRequest:request error:&error];
+        if (!result) {
+            if (error.code == CNErrorCodeChangeHistoryExpired) {
+                return ChangeHistoryStatus::Expired;
+            }
+            NSLog(@"RNContactChangeFeed: change history fetch failed: %@", error.localizedDescription);
+            return ChangeHistoryStatus::Unavailable;
+        }
+
+        RNChangeHistoryVisitor *visitor = [[RNChangeHistoryVisitor alloc] initWithVisit:&visit];
+        for (CNChangeHistoryEvent *event in result.value) {
+            @autoreleasepool {
+                [event acceptEventVisitor:visitor];
+            }
+            if (visitor.dropEverything) {
+                return ChangeHistoryStatus::DropEverything;
+            }
+        }
+        nextToken = tokenString(result.currentHistoryToken);
+        return ChangeHistoryStatus::Ok;
+    }
+
+private:
+    CNContactStore *store_;
+};
+
+} // namespace
+
+@implementation RNContactChanges
+@end
+
+@implementation RNContactChangeFeed {
+    // Serializes loading, computing, committing and saving the tracker
+    dispatch_queue_t _queue;
+    BOOL _loaded;
+    std::unique_ptr<contactsmanager::ContactChangeSet> _pending;
+}
+
++ (instancetype)sharedFeed {
+    static RNContactChangeFeed *feed;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        feed = [RNContactChangeFeed new];
+    });
+    return feed;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _queue = dispatch_queue_create("io.contactsmanager.change-feed", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (NSString *)trackerPath {
+    NSURL *directory = [[NSFileManager defaultManager] URLForDirectory:NSApplicationSupportDirectory
+                                                              inDomain:NSUserDomainMask
+                                                     appropriateForURL:nil
+                                                                create:YES
+                                                                 error:nil];
+    directory = [directory URLByAppendingPathComponent:@"ContactsManager" isDirectory:YES];
+    [[NSFileManager defaultManager] createDirectoryAtURL:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    return [directory URLByAppendingPathComponent:@"change-feed.bin"].path;
+}
+
+// Called on _queue
+- (void)loadIfNeeded {
+    if (_loaded) {
+        return;
+    }
+    _loaded = YES;
+    // A missing or corrupt file leaves the tracker empty, which means one full scan
+    contactsmanager::ContactChangeTracker::sharedInstance().load([RNContactCoreBridge stdStringFromString:[self trackerPath]]);
+}
+
+- (void)fetchChangesWithCompletion:(void (^)(RNContactChanges *_Nullable, NSError *_Nullable))completion {
+    dispatch_async(_queue, ^{
+        [self loadIfNeeded];
+
+        NSError *scanError = nil;
+        auto changes = std::make_unique<contactsmanager::ContactChangeSet>(
+            [RNContactChangeFeed changesSinceTracker:contactsmanager::ContactChangeTracker::sharedInstance()
+                                             scanned:nullptr
+                                               error:&scanError]);
+        if (scanError) {
+            completion(nil, scanError);
+            return;
+        }
+
+        CNContactStore *store = [CNContactStore new];
+        NSArray *keysToFetch = [CMContactMapper keysToFetch:NO];
+
+        // Load the added and updated contacts for upload; their hashes are committed with the changes
+        NSMutableArray<NSString *> *identifiers = [NSMutableArray arrayWithCapacity:changes->added.size() + changes->updated.size()];
+        for (const auto *list : {&changes->added, &changes->updated}) {
+            for (const auto &identifier : *list) {
+                [identifiers addObject:[NSString stringWithUTF8String:identifier.c_str()]];
+            }
+        }
+        NSMutableDictionary<NSString *, CMContact *> *byIdentifier = [NSMutableDictionary dictionaryWithCapacity:identifiers.count];
+        if (identifiers.count > 0) {
+            NSError *error = nil;
+            NSArray<CNContact *> *cnContacts = [store unifiedContactsMatchingPredicate:[CNContact predicateForContactsWithIdentifiers:identifiers]
+                                                                           keysToFetch:keysToFetch
+                                                                                 error:&error];
+            if (!cnContacts) {
+                completion(nil, error);
+                return;
+            }
+            for (CNContact *cnContact in cnContacts) {
+                @autoreleasepool {
+                    CMContact *contact = [CMContactMapper contactFromCNContact:cnContact];
+                    byIdentifier[cnContact.identifier] = contact;
+                    contactsmanager::Contact core = [RNContactCoreBridge coreContactFromContact:contact includeImageData:NO];
+                    uint64_t hash = contactsmanager::contactContentHash(core);
+                    changes->hashes.emplace(std::move(core.identifier), hash);
+                }
+            }
+        }
+
+        RNContactChanges *result = [RNContactChanges new];
+        NSMutableArray<CMContact *> *added = [NSMutableArray arrayWithCapacity:changes->added.size()];
+        NSMutableArray<CMContact *> *updated = [NSMutableArray arrayWithCapacity:changes->updated.size()];
+        NSMutableArray<NSString *> *deleted = [NSMutableArray arrayWithCapacity:changes->deleted.size()];
+        NSUInteger offset = 0;
+        for (NSString *identifier in identifiers) {
+            // Contacts deleted after the history was read are picked up by the next fetch
+            CMContact *contact = byIdentifier[identifier];
+            if (contact) {
+                [(offset < changes->added.size() ? added : updated) addObject:contact];
+            }
+            offset++;
+        }
+        for (const auto &identifier : changes->deleted) {
+            [deleted addObject:[NSString stringWithUTF8String:identifier.c_str()]];
+        }
+        result.added = added;
+        result.updated = updated;
+        result.deletedIdentifiers = deleted;
+        result.fullScan = changes->fullScan;
+        result.token = [NSString stringWithUTF8String:changes->token.c_str()];
+
+        self->_pending = std::move(changes);
+        completion(result, nil);
+    });
+}
+
++ (contactsmanager::ContactChangeSet)changesSinceTracker:(const contactsmanager::ContactChangeTracker &)tracker
+                                                 scanned:(std::vector<contactsmanager::Contact> *)scanned
+                                                   error:(NSError **)error {
+    CNContactStore *store = [CNContactStore new];
+    NSArray *keysToFetch = [CMContactMapper keysToFetch:NO];
+    // The scan runs synchronously inside pendingChanges
+    NSError *scanError = nil;
+    contactsmanager::ContactScan scan = [store, keysToFetch, scanned, &scanError](const std::function<bool(contactsmanager::Contact &&)> &emit) {
+        CNContactFetchRequest *request = [[CNContactFetchRequest alloc] initWithKeysToFetch:keysToFetch];
+        NSError *fetchError = nil;
+        [store enumerateContactsWithFetchRequest:request error:&fetchError usingBlock:^(CNContact * _Nonnull cnContact, BOOL * _Nonnull stop) {
+            @autoreleasepool {
+                CMContact *contact = [CMContactMapper contactFromCNContact:cnContact];
+                contactsmanager::Contact core = [RNContactCoreBridge coreContactFromContact:contact includeImageData:NO];
+                if (scanned) {
+                    scanned->push_back(core);
+                }
+                if (!emit(std::move(core))) {
+                    *stop = YES;
+                }
+            }
+        }];
+        scanError = fetchError;
+    };
+
+    CNContactChangeHistory history(store);
+    contactsmanager::ContactChangeSet changes = tracker.pendingChanges(history, scan);
+    if (error) {
+        *error = scanError;
+    }
+    return changes;
+}
+
+- (BOOL)commitChangesWithToken:(NSString *)token {
+    __block BOOL committed = NO;
+    dispatch_sync(_queue, ^{
+        [self loadIfNeeded];
+        if (!self->_pending || self->_pending->token != [RNContactCoreBridge stdStringFromString:token]) {
+            return;
+        }
+        auto &tracker = contactsmanager::ContactChangeTracker::sharedInstance();
+        committed = tracker.commit(*self->_pending);
+        self->_pending.reset();
+        if (committed) {
+            tracker.save([RNContactCoreBridge stdStringFromString:[self trackerPath]]);
+        }
+    });
+    return committed;
+}
+
+- (void)reset {
+    dispatch_async(_queue, ^{
+        self->_loaded = YES;
+        self->_pending.reset();
+        contactsmanager::ContactChangeTracker::sharedInstance().clear();
+        [[NSFileManager defaultManager] removeItemAtPath:[self trackerPath] error:nil];
+    });
+}
+
+@end
@@ -0,0 +1,56 @@
+#import <Foundation/Foundation.h>
+#import <ContactsManagerObjc/ContactsManagerObjc.h>
+
+#ifdef __cplusplus
+#include <string>
+#include <vector>
+
+#include "Contact.h"
+#include "ContactImageCache.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Converts between ContactsManagerObjc models and the portable C++ core in cpp/.
+ * Objective-C++ only; include from .mm files.
+ */
+@interface RNContactCoreBridge : NSObject
+
+/**
+ * Copy an NSString into a UTF-8 std::string (nil becomes an empty string)
+ */
++ (std::string)stdStringFromString:(nullable NSString *)string;
+
+/**
+ * Borrow the bytes of an NSData (nil becomes an empty view); valid while data is alive
+ */
++ (contactsmanager::ImageBytesView)imageBytesFromData:(nullable NSData *)data;
+
+/**
+ * Convert a CMContact into the core contact model
+ */
++ (contactsmanager::Contact)coreContactFromContact:(CMContact *)contact;
+
+/**
+ * Convert a CMContact into the core contact model
+ * @param includeImageData Whether to copy imageData and thumbnailImageData
+ */
++ (contactsmanager::Contact)coreContactFromContact:(CMContact *)contact includeImageData:(BOOL)includeImageData;
+
+/**
+ * Convert an array of CMContact objects into core contacts, preserving order
+ */
++ (std::vector<contactsmanager::Contact>)coreContactsFromContacts:(NSArray<CMContact *> *)contacts;
+
+/**
+ * Convert an array of CMContact objects into core contacts, preserving order
+ * @param includeImageData Whether to copy imageData and thumbnailImageData
+ */
++ (std::vector<contactsmanager::Contact>)coreContactsFromContacts:(NSArray<CMContact *> *)contacts
+                                                 includeImageData:(BOOL)includeImageData;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif
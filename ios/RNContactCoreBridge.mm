@@ -0,0 +1,169 @@
+#import "RNContactCoreBridge.h"
+
+using contactsmanager::Contact;
+
+@implementation RNContactCoreBridge
+
++ (void)initialize {
+    if (self == [RNContactCoreBridge class]) {
+        // Every contact reaches the core through this class, so national numbers are completed with the device
+        // region's calling code before anything is compared or hashed
+        NSString *region = [[NSLocale currentLocale] objectForKey:NSLocaleCountryCode];
+        contactsmanager::setDefaultCallingCode(contactsmanager::callingCodeForRegion([self stdStringFromString:region]));
+    }
+}
+
++ (std::string)stdStringFromString:(NSString *)string {
+    if (!string || [string isKindOfClass:[NSNull class]]) {
+        return std::string();
+    }
+    const char *utf8 = string.UTF8String;
+    return utf8 ? std::string(utf8) : std::string();
+}
+
++ (contactsmanager::ImageBytesView)imageBytesFromData:(NSData *)data {
+    if (!data || data.length == 0) {
+        return {};
+    }
+    return {static_cast<const uint8_t *>(data.bytes), data.length};
+}
+
++ (std::vector<uint8_t>)bytesFromData:(NSData *)data {
+    if (!data || data.length == 0) {
+        return {};
+    }
+    const uint8_t *bytes = static_cast<const uint8_t *>(data.bytes);
+    return std::vector<uint8_t>(bytes, bytes + data.length);
+}
+
++ (Contact)coreContactFromContact:(CMContact *)contact {
+    return [self coreContactFromContact:contact includeImageData:YES];
+}
+
++ (Contact)coreContactFromContact:(CMContact *)contact includeImageData:(BOOL)includeImageData {
+    Contact core([self stdStringFromString:contact.identifier]);
+
+    core.displayName = [self stdStringFromString:contact.displayName];
+    core.contactType = contact.contactType;
+    core.namePrefix = [self stdStringFromString:contact.namePrefix];
+    core.givenName = [self stdStringFromString:contact.givenName];
+    core.middleName = [self stdStringFromString:contact.middleName];
+    core.familyName = [self stdStringFromString:contact.familyName];
+    core.previousFamilyName = [self stdStringFromString:contact.previousFamilyName];
+    core.nameSuffix = [self stdStringFromString:contact.nameSuffix];
+    core.nickname = [self stdStringFromString:contact.nickname];
+    core.organizationName = [self stdStringFromString:contact.organizationName];
+    core.departmentName = [self stdStringFromString:contact.departmentName];
+    core.jobTitle = [self stdStringFromString:contact.jobTitle];
+    core.notes = [self stdStringFromString:contact.notes];
+    core.bio = [self stdStringFromString:contact.bio];
+    core.location = [self stdStringFromString:contact.location];
+    core.contactSection = [self stdStringFromString:contact.contactSection];
+    core.matchString = [self stdStringFromString:contact.matchString];
+    core.parentContactId = [self stdStringFromString:contact.parentContactId];
+    core.sourceId = [self stdStringFromString:contact.sourceId];
+
+    core.isDeleted = contact.isDeleted;
+    core.dirtyTime = contact.dirtyTime;
+    core.lastSyncedAt = contact.lastSyncedAt;
+    core.createdAt = contact.createdAt;
+
+    if (contact.birthday) {
+        core.birthday = [contact.birthday timeIntervalSince1970];
+    }
+
+    core.imageUrl = [self stdStringFromString:contact.imageUrl];
+    core.imageDataAvailable = contact.imageDataAvailable;
+    if (includeImageData) {
+        core.imageData = [self bytesFromData:contact.imageData];
+        core.thumbnailImageData = [self bytesFromData:contact.thumbnailImageData];
+    }
+
+    core.phoneNumbers.reserve(contact.phoneNumbers.count);
+    for (CMContactPhoneNumber *phone in contact.phoneNumbers) {
+        core.phoneNumbers.push_back({[self stdStringFromString:phone.contactId],
+                                     [self stdStringFromString:phone.value],
+                                     [self stdStringFromString:phone.type],
+                                     [self stdStringFromString:phone.emoji]});
+    }
+
+    core.emailAddresses.reserve(contact.emailAddresses.count);
+    for (CMContactEmailAddress *email in contact.emailAddresses) {
+        core.emailAddresses.push_back({[self stdStringFromString:email.contactId],
+                                       [self stdStringFromString:email.value],
+                                       [self stdStringFromString:email.type],
+                                       [self stdStringFromString:email.emoji]});
+    }
+
+    for (CMContactAddress *address in contact.addresses) {
+        contactsmanager::PostalAddress coreAddress;
+        coreAddress.contactId = [self stdStringFromString:address.contactId];
+        coreAddress.street = [self stdStringFromString:address.street];
+        coreAddress.city = [self stdStringFromString:address.city];
+        coreAddress.state = [self stdStringFromString:address.state];
+        coreAddress.postalCode = [self stdStringFromString:address.postalCode];
+        coreAddress.country = [self stdStringFromString:address.country];
+        coreAddress.type = [self stdStringFromString:address.type];
+        coreAddress.emoji = [self stdStringFromString:address.emoji];
+        core.addresses.push_back(std::move(coreAddress));
+    }
+
+    for (CMContactDate *date in contact.dates) {
+        core.dates.push_back({[self stdStringFromString:date.contactId],
+                              [date.date timeIntervalSince1970],
+                              [self stdStringFromString:date.type]});
+    }
+
+    for (CMContactURL *url in contact.urlAddresses) {
+        core.urlAddresses.push_back({[self stdStringFromString:url.contactId],
+                                     [self stdStringFromString:url.value],
+                                     [self stdStringFromString:url.type],
+                                     [self stdStringFromString:url.emoji]});
+    }
+
+    for (CMContactSocialProfile *profile in contact.socialProfiles) {
+        core.socialProfiles.push_back({[self stdStringFromString:profile.contactId],
+                                       [self stdStringFromString:profile.service],
+                                       [self stdStringFromString:profile.username],
+                                       [self stdStringFromString:profile.urlString]});
+    }
+
+    for (CMContactRelation *relation in contact.relations) {
+        core.relations.push_back({[self stdStringFromString:relation.contactId],
+                                  [self stdStringFromString:relation.name],
+                                  [self stdStringFromString:relation.type]});
+    }
+
+    for (CMContactInstantMessage *im in contact.instantMessageAddresses) {
+        core.instantMessageAddresses.push_back({[self stdStringFromString:im.contactId],
+                                                [self stdStringFromString:im.service],
+                                                [self stdStringFromString:im.username],
+                                                [self stdStringFromString:im.type]});
+    }
+
+    for (NSString *interest in contact.interests) {
+        core.interests.push_back([self stdStringFromString:interest]);
+    }
+
+    for (NSString *avatar in contact.avatars) {
+        core.avatars.push_back([self stdStringFromString:avatar]);
+    }
+
+    return core;
+}
+
++ (std::vector<Contact>)coreContactsFromContacts:(NSArray<CMContact *> *)contacts {
+    return [self coreContactsFromContacts:contacts includeImageData:YES];
+}
+
++ (std::vector<Contact>)coreContactsFromContacts:(NSArray<CMContact *> *)contacts
+                                includeImageData:(BOOL)includeImageData {
+    std::vector<Contact> result;
+    result.reserve(contacts.count);
+    for (CMContact *contact in contacts) {
+        result.push_back([self coreContactFromContact:contact includeImageData:includeImageData]);
+    }
+    return result;
+}
+
+@end
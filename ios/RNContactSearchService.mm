@@ -1,9 +1,54 @@
 #import "RNContactSearchService.h"
+#import "RNContactChangeFeed.h"
+#import "RNContactCoreBridge.h"
 
-@implementation RNContactSearchService
+#import <Contacts/Contacts.h>
+
+#include <atomic>
+
+#include "ContactChangeFeed.h"
+#include "ContactSearchIndex.h"
+
+@implementation RNContactSearchService {
+    // Serializes loading, refreshing and saving the persistent search index
+    dispatch_queue_t _indexQueue;
+    // Read from the module queue without waiting on a refresh in progress
+    std::atomic<bool> _indexReady;
+    BOOL _indexStale;
+    // Store changes already applied to the index; separate from the sync feed's tracker
+    contactsmanager::ContactChangeTracker _indexTracker;
+}
 
 RCT_EXPORT_MODULE()
 
+- (instancetype)init {
+    if (self = [super init]) {
+        _indexQueue = dispatch_queue_create("io.contactsmanager.search-index", DISPATCH_QUEUE_SERIAL);
+        _indexStale = YES;
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(contactStoreDidChange:)
+                                                     name:CNContactStoreDidChangeNotification
+                                                   object:nil];
+        dispatch_async(_indexQueue, ^{
+            std::string path = [RNContactCoreBridge stdStringFromString:[self searchIndexPath]];
+            if (contactsmanager::ContactSearchIndex::sharedInstance().load(path)) {
+                self->_indexReady = true;
+                // Without its tracker the index is brought up to date by one full resync
+                self->_indexTracker.load([RNContactCoreBridge stdStringFromString:[self indexTrackerPath]]);
+            }
+        });
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
++ (BOOL)requiresMainQueueSetup {
+    return NO;
+}
+
 RCT_EXPORT_METHOD(searchContacts:(NSString *)query
                   fieldType:(NSInteger)fieldType
                   offset:(NSInteger)offset
@@ -13,6 +58,27 @@ RCT_EXPORT_METHOD(searchContacts:(NSString *)query
 {
     NSLog(@"RNContactSearchService: searchContacts called with query: %@", query);
 
+    [self refreshSearchIndexIfNeeded];
+    if ([self isSearchIndexReady]) {
+        auto results = contactsmanager::ContactSearchIndex::sharedInstance().search(
+            [RNContactCoreBridge stdStringFromString:query], static_cast<uint32_t>(fieldType),
+            static_cast<size_t>(MAX(offset, 0)), static_cast<size_t>(MAX(limit, 0)));
+        NSError *error = nil;
+        NSArray<CMContact *> *contacts = [self contactsWithIdentifiers:results.identifiers error:&error];
+        if (contacts) {
+            NSMutableArray *contactsArray = [NSMutableArray arrayWithCapacity:contacts.count];
+            for (CMContact *contact in contacts) {
+                [contactsArray addObject:[self contactToDictionary:contact]];
+            }
+            resolve(@{
+                @"contacts": contactsArray,
+                @"totalCount": @(results.totalCount)
+            });
+            return;
+        }
+        NSLog(@"RNContactSearchService: indexed search fell back to the store: %@", error.localizedDescription);
+    }
+
     // Get the search service from the contact service
     CMContactSearchService *searchService = [[CMContactService sharedInstance] searchService];
     if (!searchService) {
@@ -52,6 +118,23 @@ RCT_EXPORT_METHOD(quickSearch:(NSString *)query
 {
     NSLog(@"RNContactSearchService: quickSearch called with query: %@", query);
 
+    [self refreshSearchIndexIfNeeded];
+    if ([self isSearchIndexReady]) {
+        auto identifiers = contactsmanager::ContactSearchIndex::sharedInstance().quickSearch(
+            [RNContactCoreBridge stdStringFromString:query]);
+        NSError *error = nil;
+        NSArray<CMContact *> *contacts = [self contactsWithIdentifiers:identifiers error:&error];
+        if (contacts) {
+            NSMutableArray *contactsArray = [NSMutableArray arrayWithCapacity:contacts.count];
+            for (CMContact *contact in contacts) {
+                [contactsArray addObject:[self contactToDictionary:contact]];
+            }
+            resolve(contactsArray);
+            return;
+        }
+        NSLog(@"RNContactSearchService: indexed quick search fell back to the store: %@", error.localizedDescription);
+    }
+
     CMContactSearchService *searchService = [[CMContactService sharedInstance] searchService];
     if (!searchService) {
         reject(@"search_error", @"Search service not available. Make sure ContactService is initialized.", nil);
@@ -95,6 +178,150 @@ RCT_EXPORT_METHOD(getContactsCount:(RCTPromiseResolveBlock)resolve
     }];
 }
 
+#pragma mark - Search index
+
+- (NSString *)searchIndexPath {
+    return [[self searchIndexDirectory] stringByAppendingPathComponent:@"search-index.bin"];
+}
+
+- (NSString *)indexTrackerPath {
+    return [[self searchIndexDirectory] stringByAppendingPathComponent:@"search-index-changes.bin"];
+}
+
+- (NSString *)searchIndexDirectory {
+    NSURL *directory = [[NSFileManager defaultManager] URLForDirectory:NSApplicationSupportDirectory
+                                                              inDomain:NSUserDomainMask
+                                                     appropriateForURL:nil
+                                                                create:YES
+                                                                 error:nil];
+    directory = [directory URLByAppendingPathComponent:@"ContactsManager" isDirectory:YES];
+    [[NSFileManager defaultManager] createDirectoryAtURL:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    return directory.path;
+}
+
+- (BOOL)isSearchIndexReady {
+    return _indexReady.load();
+}
+
+- (void)contactStoreDidChange:(NSNotification *)notification {
+    dispatch_async(_indexQueue, ^{
+        self->_indexStale = YES;
+    });
+    [self refreshSearchIndexIfNeeded];
+}
+
+// Brings the index in line with the store. The changed identifiers come from the store's change history, so
+// only those contacts are refetched; the whole book is read only when the history cannot be used.
+- (void)refreshSearchIndexIfNeeded {
+    dispatch_async(_indexQueue, ^{
+        if (!self->_indexStale) {
+            return;
+        }
+        if ([[CMContactService sharedInstance] contactsAccessStatus] != CNAuthorizationStatusAuthorized) {
+            return;
+        }
+        self->_indexStale = NO;
+
+        std::vector<contactsmanager::Contact> scanned;
+        std::vector<std::string> removed;
+        NSError *error = nil;
+        contactsmanager::ContactChangeSet changes = [RNContactChangeFeed changesSinceTracker:self->_indexTracker
+                                                                                     scanned:&scanned
+                                                                                       error:&error];
+        if (!error && !changes.fullScan) {
+            [self fetchChangedContacts:changes into:scanned removed:removed error:&error];
+        }
+        if (error) {
+            NSLog(@"RNContactSearchService: search index refresh failed: %@", error.localizedDescription);
+            self->_indexStale = YES;
+            return;
+        }
+
+        auto &index = contactsmanager::ContactSearchIndex::sharedInstance();
+        size_t applied = 0;
+        if (changes.fullScan) {
+            applied = index.syncWith(scanned);
+        } else {
+            for (const auto &contact : scanned) {
+                applied += index.upsert(contact) ? 1 : 0;
+            }
+            for (const auto &identifier : removed) {
+                applied += index.remove(identifier) ? 1 : 0;
+            }
+        }
+        // The tracker is saved only after the index it describes
+        if ((applied > 0 || !self->_indexReady) &&
+            !index.save([RNContactCoreBridge stdStringFromString:[self searchIndexPath]])) {
+            self->_indexTracker.clear();
+        } else if (self->_indexTracker.commit(changes)) {
+            self->_indexTracker.save([RNContactCoreBridge stdStringFromString:[self indexTrackerPath]]);
+        }
+        NSLog(@"RNContactSearchService: search index refreshed with %zu changes%@", applied,
+              changes.fullScan ? @" (full resync)" : @"");
+        self->_indexReady = true;
+    });
+}
+
+// Loads the added and updated contacts of an incremental change set and lists the identifiers to drop from the
+// index, including contacts deleted after the history was read
+- (void)fetchChangedContacts:(contactsmanager::ContactChangeSet &)changes
+                        into:(std::vector<contactsmanager::Contact> &)contacts
+                     removed:(std::vector<std::string> &)removed
+                       error:(NSError **)error {
+    std::vector<std::string> identifiers = changes.added;
+    identifiers.insert(identifiers.end(), changes.updated.begin(), changes.updated.end());
+    NSArray<CMContact *> *fetched = [self contactsWithIdentifiers:identifiers error:error];
+    if (!fetched) {
+        return;
+    }
+    contacts.reserve(fetched.count);
+    for (CMContact *contact in fetched) {
+        @autoreleasepool {
+            contacts.push_back([RNContactCoreBridge coreContactFromContact:contact includeImageData:NO]);
+            changes.hashes.emplace(contacts.back().identifier, contactsmanager::contactContentHash(contacts.back()));
+        }
+    }
+    removed = changes.deleted;
+    for (const auto &identifier : identifiers) {
+        if (changes.hashes.count(identifier) == 0) {
+            removed.push_back(identifier);
+        }
+    }
+}
+
+// Loads the matched contacts from the store, preserving the index's result order
+- (nullable NSArray<CMContact *> *)contactsWithIdentifiers:(const std::vector<std::string> &)identifiers
+                                                     error:(NSError **)error {
+    if (identifiers.empty()) {
+        return @[];
+    }
+    NSMutableArray<NSString *> *ids = [NSMutableArray arrayWithCapacity:identifiers.size()];
+    for (const auto &identifier : identifiers) {
+        [ids addObject:[NSString stringWithUTF8String:identifier.c_str()]];
+    }
+
+    CNContactStore *store = [CNContactStore new];
+    NSArray<CNContact *> *cnContacts = [store unifiedContactsMatchingPredicate:[CNContact predicateForContactsWithIdentifiers:ids]
+                                                                   keysToFetch:[CMContactMapper keysToFetch:NO]
+                                                                         error:error];
+    if (!cnContacts) {
+        return nil;
+    }
+
+    NSMutableDictionary<NSString *, CMContact *> *byIdentifier = [NSMutableDictionary dictionaryWithCapacity:cnContacts.count];
+    for (CNContact *cnContact in cnContacts) {
+        byIdentifier[cnContact.identifier] = [CMContactMapper contactFromCNContact:cnContact];
+    }
+    NSMutableArray<CMContact *> *contacts = [NSMutableArray arrayWithCapacity:ids.count];
+    for (NSString *identifier in ids) {
+        CMContact *contact = byIdentifier[identifier];
+        if (contact) {
+            [contacts addObject:contact];
+        }
+    }
+    return contacts;
+}
+
 #pragma mark - Helper methods
 
 // Helper to convert CMContact to NSDictionary
@@ -1,5 +1,6 @@
 #import <React/RCTBridgeModule.h>
+#import <React/RCTInvalidating.h>
 #import <ContactsManagerObjc/ContactsManagerObjc.h>
 
-@interface RNContactService : NSObject <RCTBridgeModule>
+@interface RNContactService : NSObject <RCTBridgeModule, RCTInvalidating>
 @end
@@ -1,9 +1,40 @@
 #import "RNContactService.h"
+#import "RNContactChangeFeed.h"
+#import "RNContactCoreBridge.h"
 
-@implementation RNContactService
+#import <Contacts/Contacts.h>
+#import <React/RCTBridge+Private.h>
+#import <jsi/jsi.h>
+
+#include <memory>
+
+#include "ContactColumns.h"
+#include "ContactCursor.h"
+#include "ContactImageCache.h"
+#include "jsi/ContactListHostObject.h"
+
+@implementation RNContactService {
+    // Base64 imageData/thumbnailImageData on every contact (the default, which existing
+    // consumers rely on); NO sends an imageId resolved through getContactImage instead
+    BOOL _inlineImageData;
+}
+
+@synthesize bridge = _bridge;
 
 RCT_EXPORT_MODULE()
 
+- (instancetype)init {
+    if (self = [super init]) {
+        _inlineImageData = YES;
+    }
+    return self;
+}
+
+// A JS reload drops the cursors without closing them; their producers would otherwise stay blocked
+- (void)invalidate {
+    contactsmanager::ContactCursorRegistry<CMContact *>::sharedInstance().closeAll();
+}
+
 RCT_EXPORT_METHOD(initialize:(NSString *)apiKey
                   userInfo:(NSDictionary *)userInfoDict
                   token:(NSString *)token
@@ -119,6 +150,9 @@ RCT_EXPORT_METHOD(reset:(RCTPromiseResolveBlock)resolve
         if (error) {
             reject(@"reset_error", error.localizedDescription, error);
         } else {
+            contactsmanager::ContactImageCache::sharedInstance().clear();
+            contactsmanager::ContactCursorRegistry<CMContact *>::sharedInstance().closeAll();
+            [[RNContactChangeFeed sharedFeed] reset];
             resolve(@{@"success": @(success)});
         }
     }];
@@ -212,6 +246,164 @@ RCT_EXPORT_METHOD(fetchContactsWithBatch:(NSInteger)batchSize
     }];
 }
 
+RCT_EXPORT_METHOD(openContactCursor:(NSInteger)fieldType
+                  readAhead:(NSInteger)readAhead
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSLog(@"RNContactService: openContactCursor called with fieldType: %ld, readAhead: %ld", (long)fieldType, (long)readAhead);
+
+    // Enumerate the store once on the cursor's producer thread; it blocks while JS is not pulling
+    auto enumerator = [fieldType](const std::function<bool(CMContact *&&)> &emit) {
+        CNContactStore *store = [CNContactStore new];
+        BOOL includeNotes = fieldType == CMContactFieldTypeNotes;
+        CNContactFetchRequest *request = [[CNContactFetchRequest alloc] initWithKeysToFetch:[CMContactMapper keysToFetch:includeNotes]];
+        request.sortOrder = CNContactSortOrderUserDefault;
+
+        NSError *error = nil;
+        [store enumerateContactsWithFetchRequest:request error:&error usingBlock:^(CNContact * _Nonnull cnContact, BOOL * _Nonnull stop) {
+            @autoreleasepool {
+                if (fieldType == CMContactFieldTypePhone && cnContact.phoneNumbers.count == 0) {
+                    return;
+                }
+                if (fieldType == CMContactFieldTypeEmail && cnContact.emailAddresses.count == 0) {
+                    return;
+                }
+                CMContact *contact = [CMContactMapper contactFromCNContact:cnContact];
+                if (!emit(std::move(contact))) {
+                    *stop = YES;
+                }
+            }
+        }];
+        if (error) {
+            NSLog(@"RNContactService: contact cursor enumeration failed: %@", error.localizedDescription);
+        }
+    };
+
+    size_t window = readAhead > 0 ? static_cast<size_t>(readAhead)
+                                  : contactsmanager::ContactCursor<CMContact *>::kDefaultReadAhead;
+    auto cursor = contactsmanager::ContactCursorRegistry<CMContact *>::sharedInstance().open(enumerator, window);
+    std::string token = contactsmanager::formatCursorToken(cursor->firstToken());
+    resolve(@{@"token": [NSString stringWithUTF8String:token.c_str()]});
+}
+
+RCT_EXPORT_METHOD(readContactCursor:(NSString *)token
+                  count:(NSInteger)count
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    auto position = contactsmanager::parseCursorToken([RNContactCoreBridge stdStringFromString:token]);
+    if (!position) {
+        reject(@"invalid_argument", [NSString stringWithFormat:@"Invalid cursor token: %@", token], nil);
+        return;
+    }
+    auto cursor = contactsmanager::ContactCursorRegistry<CMContact *>::sharedInstance().get(position->cursorId);
+    if (!cursor) {
+        reject(@"cursor_closed", @"Contact cursor is closed", nil);
+        return;
+    }
+
+    // A pull waits for the producer; keep it off the module queue
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        auto page = cursor->next(*position, count > 0 ? static_cast<size_t>(count) : 1);
+        switch (page.status) {
+            case contactsmanager::CursorStatus::StaleToken:
+                reject(@"stale_cursor_token", @"Cursor token is not the cursor's current position", nil);
+                return;
+            case contactsmanager::CursorStatus::Busy:
+                reject(@"cursor_busy", @"Another pull on this cursor has not finished", nil);
+                return;
+            case contactsmanager::CursorStatus::Closed:
+                reject(@"cursor_closed", @"Contact cursor is closed", nil);
+                return;
+            case contactsmanager::CursorStatus::Ok:
+                break;
+        }
+
+        NSMutableArray *contactsArray = [NSMutableArray arrayWithCapacity:page.items.size()];
+        for (CMContact *contact : page.items) {
+            [contactsArray addObject:[self contactToDictionary:contact]];
+        }
+        if (page.done) {
+            contactsmanager::ContactCursorRegistry<CMContact *>::sharedInstance().close(position->cursorId);
+        }
+
+        std::string next = contactsmanager::formatCursorToken(page.next);
+        resolve(@{
+            @"contacts": contactsArray,
+            @"token": [NSString stringWithUTF8String:next.c_str()],
+            @"done": @(page.done)
+        });
+    });
+}
+
+RCT_EXPORT_METHOD(closeContactCursor:(NSString *)token
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSLog(@"RNContactService: closeContactCursor called with token: %@", token);
+
+    auto position = contactsmanager::parseCursorToken([RNContactCoreBridge stdStringFromString:token]);
+    if (!position) {
+        reject(@"invalid_argument", [NSString stringWithFormat:@"Invalid cursor token: %@", token], nil);
+        return;
+    }
+    resolve(@(contactsmanager::ContactCursorRegistry<CMContact *>::sharedInstance().close(position->cursorId)));
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(installContactListBindings)
+{
+    NSLog(@"RNContactService: installContactListBindings called");
+
+    // JSI bindings need the JS runtime; sync methods run on the JS thread
+    RCTCxxBridge *cxxBridge = (RCTCxxBridge *)self.bridge;
+    if (!cxxBridge || ![cxxBridge respondsToSelector:@selector(runtime)] || cxxBridge.runtime == nullptr) {
+        return @(NO);
+    }
+
+    facebook::jsi::Runtime *runtime = static_cast<facebook::jsi::Runtime *>(cxxBridge.runtime);
+    contactsmanager::installContactListBindings(*runtime);
+    return @(YES);
+}
+
+RCT_EXPORT_METHOD(fetchContactList:(NSInteger)fieldType
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSLog(@"RNContactService: fetchContactList called with fieldType: %ld", (long)fieldType);
+
+    [[CMContactService sharedInstance] fetchContactsWithFieldType:fieldType completion:^(NSArray<CMContact *> * _Nullable contacts, NSError * _Nullable error) {
+        if (error) {
+            reject(@"fetch_error", error.localizedDescription, error);
+            return;
+        }
+
+        // Build one columnar snapshot instead of a dictionary per contact; JS reads it through JSI.
+        // Photos travel the way contactToDictionary sends them: bytes inline, or an image ID per row
+        NSArray<CMContact *> *fetched = contacts ?: @[];
+        std::vector<std::string> imageIds;
+        if (!self->_inlineImageData) {
+            imageIds.reserve(fetched.count);
+            for (CMContact *contact in fetched) {
+                imageIds.push_back(contactsmanager::ContactImageCache::sharedInstance().registerContactImages(
+                    [RNContactCoreBridge stdStringFromString:contact.identifier],
+                    [RNContactCoreBridge imageBytesFromData:contact.imageData],
+                    [RNContactCoreBridge imageBytesFromData:contact.thumbnailImageData],
+                    false));
+            }
+        }
+        auto columns = std::make_shared<const contactsmanager::ContactColumns>(
+            [RNContactCoreBridge coreContactsFromContacts:fetched includeImageData:self->_inlineImageData],
+            imageIds);
+        uint64_t handle = contactsmanager::ContactColumnRegistry::sharedInstance().add(columns);
+
+        resolve(@{
+            @"handle": @(handle),
+            @"count": @(columns->size())
+        });
+    }];
+}
+
 RCT_EXPORT_METHOD(fetchContactWithId:(NSString *)identifier
                   resolver:(RCTPromiseResolveBlock)resolve
                   rejecter:(RCTPromiseRejectBlock)reject)
@@ -235,6 +427,75 @@ RCT_EXPORT_METHOD(fetchContactWithId:(NSString *)identifier
     }];
 }
 
+RCT_EXPORT_METHOD(setImageTransferMode:(NSString *)mode
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSLog(@"RNContactService: setImageTransferMode called with mode: %@", mode);
+
+    if ([mode isEqualToString:@"inline"]) {
+        _inlineImageData = YES;
+    } else if ([mode isEqualToString:@"handle"]) {
+        _inlineImageData = NO;
+    } else {
+        reject(@"invalid_argument", [NSString stringWithFormat:@"Unknown image transfer mode: %@", mode], nil);
+        return;
+    }
+    resolve(@(YES));
+}
+
+RCT_EXPORT_METHOD(getContactImage:(NSString *)imageId
+                  sizeClass:(NSString *)sizeClassName
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSLog(@"RNContactService: getContactImage called with imageId: %@, sizeClass: %@", imageId, sizeClassName);
+
+    auto sizeClass = contactsmanager::imageSizeClassNamed([RNContactCoreBridge stdStringFromString:sizeClassName]);
+    if (!sizeClass) {
+        reject(@"invalid_argument", [NSString stringWithFormat:@"Unknown image size class: %@", sizeClassName], nil);
+        return;
+    }
+
+    auto &cache = contactsmanager::ContactImageCache::sharedInstance();
+    std::string cacheId = [RNContactCoreBridge stdStringFromString:imageId];
+    if (auto bytes = cache.lookup(cacheId, *sizeClass)) {
+        resolve([self base64StringFromBytes:*bytes]);
+        return;
+    }
+
+    // Not cached (full images are never cached eagerly): reload through the owning contact
+    auto contactId = cache.contactIdForImage(cacheId);
+    if (!contactId) {
+        resolve([NSNull null]);
+        return;
+    }
+
+    NSString *identifier = [NSString stringWithUTF8String:contactId->c_str()];
+    [[CMContactService sharedInstance] fetchContactWithIdentifier:identifier completion:^(CMContact * _Nullable contact, NSError * _Nullable error) {
+        if (error) {
+            reject(@"fetch_error", error.localizedDescription, error);
+            return;
+        }
+
+        contactsmanager::ImageBytesView full = [RNContactCoreBridge imageBytesFromData:contact.imageData];
+        contactsmanager::ImageBytesView thumbnail = [RNContactCoreBridge imageBytesFromData:contact.thumbnailImageData];
+        // The photo changed since the ID was handed out; the caller should refetch the contact
+        if (contactsmanager::ContactImageCache::imageIdForContent(full, thumbnail) != cacheId) {
+            resolve([NSNull null]);
+            return;
+        }
+
+        contactsmanager::ImageBytesView requested = *sizeClass == contactsmanager::ImageSizeClass::Full ? full : thumbnail;
+        if (requested.empty()) {
+            resolve([NSNull null]);
+            return;
+        }
+        cache.store(cacheId, *sizeClass, requested);
+        resolve([[NSData dataWithBytes:requested.data length:requested.size] base64EncodedStringWithOptions:0]);
+    }];
+}
+
 RCT_EXPORT_METHOD(getContactsCount:(RCTPromiseResolveBlock)resolve
                   reject:(RCTPromiseRejectBlock)reject)
 {
@@ -316,6 +577,45 @@ RCT_EXPORT_METHOD(getContactsForSync:(RCTPromiseResolveBlock)resolve
     }];
 }
 
+RCT_EXPORT_METHOD(getContactChangesForSync:(RCTPromiseResolveBlock)resolve
+                  reject:(RCTPromiseRejectBlock)reject)
+{
+    NSLog(@"RNContactService: getContactChangesForSync called");
+
+    [[RNContactChangeFeed sharedFeed] fetchChangesWithCompletion:^(RNContactChanges * _Nullable changes, NSError * _Nullable error) {
+        if (error || !changes) {
+            reject(@"sync_error", error.localizedDescription ?: @"Failed to read contact changes", error);
+            return;
+        }
+
+        NSMutableArray *added = [NSMutableArray arrayWithCapacity:changes.added.count];
+        for (CMContact *contact in changes.added) {
+            [added addObject:[self contactToDictionary:contact]];
+        }
+        NSMutableArray *updated = [NSMutableArray arrayWithCapacity:changes.updated.count];
+        for (CMContact *contact in changes.updated) {
+            [updated addObject:[self contactToDictionary:contact]];
+        }
+
+        resolve(@{
+            @"added": added,
+            @"updated": updated,
+            @"deletedIds": changes.deletedIdentifiers,
+            @"fullScan": @(changes.fullScan),
+            @"token": changes.token
+        });
+    }];
+}
+
+RCT_EXPORT_METHOD(commitContactChanges:(NSString *)token
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSLog(@"RNContactService: commitContactChanges called");
+
+    resolve(@([[RNContactChangeFeed sharedFeed] commitChangesWithToken:token ?: @""]));
+}
+
 RCT_EXPORT_METHOD(startSync:(NSString *)sourceId
                   userId:(NSString *)userId
                   resolver:(RCTPromiseResolveBlock)resolve
@@ -383,12 +683,24 @@ RCT_EXPORT_METHOD(cancelSync:(RCTPromiseResolveBlock)resolve
     dict[@"imageUrl"] = contact.imageUrl ?: @"";
     dict[@"imageDataAvailable"] = @(contact.imageDataAvailable);
 
-    if (contact.imageData) {
-        dict[@"imageData"] = [contact.imageData base64EncodedStringWithOptions:0];
-    }
+    if (_inlineImageData) {
+        if (contact.imageData) {
+            dict[@"imageData"] = [contact.imageData base64EncodedStringWithOptions:0];
+        }
 
-    if (contact.thumbnailImageData) {
-        dict[@"thumbnailImageData"] = [contact.thumbnailImageData base64EncodedStringWithOptions:0];
+        if (contact.thumbnailImageData) {
+            dict[@"thumbnailImageData"] = [contact.thumbnailImageData base64EncodedStringWithOptions:0];
+        }
+    } else {
+        // Send an opaque image ID; bytes are served on demand by getContactImage
+        std::string imageId = contactsmanager::ContactImageCache::sharedInstance().registerContactImages(
+            [RNContactCoreBridge stdStringFromString:contact.identifier],
+            [RNContactCoreBridge imageBytesFromData:contact.imageData],
+            [RNContactCoreBridge imageBytesFromData:contact.thumbnailImageData],
+            false);
+        if (!imageId.empty()) {
+            dict[@"imageId"] = [NSString stringWithUTF8String:imageId.c_str()];
+        }
     }
 
     // Add birthday if available
@@ -419,19 +731,91 @@ RCT_EXPORT_METHOD(cancelSync:(RCTPromiseResolveBlock)resolve
     }
     dict[@"emailAddresses"] = emailAddresses;
 
-    // Simplified, would need to implement for all contact properties
-    dict[@"addresses"] = @[];
-    dict[@"dates"] = @[];
-    dict[@"urlAddresses"] = @[];
-    dict[@"socialProfiles"] = @[];
-    dict[@"relations"] = @[];
-    dict[@"instantMessageAddresses"] = @[];
-    dict[@"interests"] = @[];
-    dict[@"avatars"] = @[];
+    NSMutableArray *addresses = [NSMutableArray array];
+    for (CMContactAddress *address in contact.addresses) {
+        [addresses addObject:@{
+            @"contactId": contact.identifier,
+            @"street": address.street ?: @"",
+            @"city": address.city ?: @"",
+            @"state": address.state ?: @"",
+            @"postalCode": address.postalCode ?: @"",
+            @"country": address.country ?: @"",
+            @"type": address.type ?: @"",
+            @"emoji": address.emoji ?: @""
+        }];
+    }
+    dict[@"addresses"] = addresses;
+
+    NSMutableArray *dates = [NSMutableArray array];
+    for (CMContactDate *date in contact.dates) {
+        [dates addObject:@{
+            @"contactId": contact.identifier,
+            @"date": @([date.date timeIntervalSince1970] * 1000),
+            @"type": date.type ?: @""
+        }];
+    }
+    dict[@"dates"] = dates;
+
+    NSMutableArray *urlAddresses = [NSMutableArray array];
+    for (CMContactURL *url in contact.urlAddresses) {
+        [urlAddresses addObject:@{
+            @"contactId": contact.identifier,
+            @"value": url.value ?: @"",
+            @"type": url.type ?: @"",
+            @"emoji": url.emoji ?: @""
+        }];
+    }
+    dict[@"urlAddresses"] = urlAddresses;
+
+    NSMutableArray *socialProfiles = [NSMutableArray array];
+    for (CMContactSocialProfile *profile in contact.socialProfiles) {
+        [socialProfiles addObject:@{
+            @"contactId": contact.identifier,
+            @"service": profile.service ?: @"",
+            @"username": profile.username ?: @"",
+            @"urlString": profile.urlString ?: @""
+        }];
+    }
+    dict[@"socialProfiles"] = socialProfiles;
+
+    NSMutableArray *relations = [NSMutableArray array];
+    for (CMContactRelation *relation in contact.relations) {
+        [relations addObject:@{
+            @"contactId": contact.identifier,
+            @"name": relation.name ?: @"",
+            @"type": relation.type ?: @""
+        }];
+    }
+    dict[@"relations"] = relations;
+
+    NSMutableArray *instantMessageAddresses = [NSMutableArray array];
+    for (CMContactInstantMessage *im in contact.instantMessageAddresses) {
+        [instantMessageAddresses addObject:@{
+            @"contactId": contact.identifier,
+            @"service": im.service ?: @"",
+            @"username": im.username ?: @"",
+            @"type": im.type ?: @""
+        }];
+    }
+    dict[@"instantMessageAddresses"] = instantMessageAddresses;
+
+    dict[@"interests"] = contact.interests ?: @[];
+
+    NSMutableArray *avatars = [NSMutableArray array];
+    for (NSString *avatar in contact.avatars) {
+        [avatars addObject:@{@"contactId": contact.identifier, @"url": avatar}];
+    }
+    dict[@"avatars"] = avatars;
 
     return dict;
 }
 
+// Helper to base64 encode cached image bytes for the bridge
+- (NSString *)base64StringFromBytes:(const std::vector<uint8_t> &)bytes {
+    NSData *data = [NSData dataWithBytesNoCopy:(void *)bytes.data() length:bytes.size() freeWhenDone:NO];
+    return [data base64EncodedStringWithOptions:0];
+}
+
 // Helper to convert NSDictionary to CMContact
 - (CMContact *)dictionaryToContact:(NSDictionary *)dict {
     if (!dict) {
@@ -13,6 +13,10 @@ import type {
   ContactDate,
   ContactURL,
   ContactAvatar,
+  ContactList,
+  ContactCursor,
+  ContactCursorPage,
+  ContactChanges,
   SearchResult,
   ContactsManagerOptions,
 } from './types';
@@ -30,6 +34,10 @@ export type {
   ContactDate,
   ContactURL,
   ContactAvatar,
+  ContactList,
+  ContactCursor,
+  ContactCursorPage,
+  ContactChanges,
   SearchResult,
   ContactsManagerOptions,
 };
@@ -67,12 +75,18 @@ export {
   reset,
   fetchContacts,
   fetchContactsWithFieldType,
+  openContactCursor,
+  fetchContactList,
   fetchContactWithId,
+  setImageTransferMode,
+  getContactImage,
   getContactsCount,
   enableBackgroundSync,
   scheduleBackgroundSyncTask,
   hasContactChanged,
   getContactsForSync,
+  getContactChangesForSync,
+  commitContactChanges,
   startSync,
   cancelSync,
 } from './services/contactsService';
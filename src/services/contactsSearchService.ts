@@ -16,7 +16,8 @@ export enum SearchFieldType {
 }
 
 /**
- * Search contacts with a query string and field type filter
+ * Search contacts with a query string and field type filter. Matches tolerate
+ * small typos and name initials, and come back best match first.
  * @param query The search query
  * @param fieldType Bitmask of fields to search (default: all fields)
  * @param offset Starting index for pagination
@@ -36,7 +37,7 @@ export function searchContacts(
 }
 
 /**
- * Perform a quick search for real-time filtering
+ * Perform a quick search for real-time filtering, best matches first
  * @param query The search query
  * @returns Promise resolving to an array of contacts
  */
@@ -1,5 +1,15 @@
 import { NativeModules } from 'react-native';
-import type { Contact, ContactFieldType, UserInfo } from '../types';
+import { ContactFieldType } from '../types';
+import type {
+  Contact,
+  ContactChanges,
+  ContactCursor,
+  ContactCursorPage,
+  ContactList,
+  ImageSizeClass,
+  ImageTransferMode,
+  UserInfo,
+} from '../types';
 
 // Direct access to the native module
 const { RNContactService } = NativeModules;
@@ -149,7 +159,8 @@ export function fetchContactsWithFieldType(
 }
 
 /**
- * Fetch contacts in batches
+ * Fetch contacts in batches.
+ * Each call re-enumerates the address book from the start; prefer openContactCursor to walk it all.
  * @param batchSize The number of contacts to fetch per batch
  * @param batchIndex The index of the batch (0-based)
  * @returns Promise resolving to an array of contacts
@@ -164,6 +175,120 @@ export function fetchContactsWithBatch(
   return RNContactService.fetchContactsWithBatch(batchSize, batchIndex);
 }
 
+/**
+ * Open a cursor that enumerates the address book once and hands out pages on demand.
+ * Each next() resumes from the position token of the previous page.
+ * @param fieldType The type of fields to fetch
+ * On Android the cursor pages through a single fetch and readAhead is ignored.
+ * @param readAhead How many contacts native may buffer ahead of the last pull (0 for the default)
+ * @returns Promise resolving to a contact cursor
+ */
+export async function openContactCursor(
+  fieldType: ContactFieldType = ContactFieldType.Any,
+  readAhead = 0
+): Promise<ContactCursor> {
+  console.log(`Opening contact cursor with fieldType: ${fieldType}...`);
+  const opened: { token: string } = await RNContactService.openContactCursor(
+    fieldType,
+    readAhead
+  );
+  let token = opened.token;
+  let finished = false;
+  // Pulls run one at a time so each presents the token of the page before it
+  let previous: Promise<unknown> = Promise.resolve();
+
+  const pull = async (count: number): Promise<ContactCursorPage> => {
+    if (finished) {
+      return { contacts: [], done: true };
+    }
+    const page: { contacts: Contact[]; token: string; done: boolean } =
+      await RNContactService.readContactCursor(token, count);
+    token = page.token;
+    finished = page.done;
+    return { contacts: page.contacts, done: page.done };
+  };
+
+  return {
+    next: (count: number): Promise<ContactCursorPage> => {
+      const result = previous.then(() => pull(count));
+      previous = result.catch(() => undefined);
+      return result;
+    },
+    close: async () => {
+      if (finished) {
+        return;
+      }
+      finished = true;
+      await RNContactService.closeContactCursor(token);
+    },
+  };
+}
+
+type NativeContactList = Pick<ContactList, 'length' | 'get' | 'getField'>;
+
+// Globals installed by RNContactService.installContactListBindings (cpp/jsi)
+type ContactListGlobals = {
+  __ContactsManagerContactList?: (
+    handle: number
+  ) => NativeContactList | undefined;
+  __ContactsManagerReleaseContactList?: (handle: number) => boolean;
+};
+
+let contactListBindingsInstalled = false;
+
+function installContactListBindings(): boolean {
+  if (!contactListBindingsInstalled) {
+    try {
+      contactListBindingsInstalled =
+        RNContactService.installContactListBindings() === true;
+    } catch (error) {
+      console.log('Contact list JSI bindings unavailable:', error);
+    }
+  }
+  return contactListBindingsInstalled;
+}
+
+/**
+ * Fetch contacts as a lazily-read list backed by a native columnar snapshot.
+ * Falls back to the dictionary path when JSI is not available.
+ * Call release() on the list once it is no longer displayed.
+ * @param fieldType The type of fields to fetch
+ * @returns Promise resolving to a contact list
+ */
+export async function fetchContactList(
+  fieldType: ContactFieldType = ContactFieldType.Any
+): Promise<ContactList> {
+  console.log(`Fetching contact list with fieldType: ${fieldType}...`);
+  const globals = globalThis as unknown as ContactListGlobals;
+
+  if (
+    !installContactListBindings() ||
+    !globals.__ContactsManagerContactList
+  ) {
+    const contacts = await fetchContactsWithFieldType(fieldType);
+    return {
+      length: contacts.length,
+      get: (index) => contacts[index] as Contact,
+      getField: (index, field) => (contacts[index] as Contact)[field],
+      release: () => {},
+    };
+  }
+
+  const { handle } = await RNContactService.fetchContactList(fieldType);
+  const list = globals.__ContactsManagerContactList(handle);
+  if (!list) {
+    throw new Error('Contact list snapshot is no longer available');
+  }
+  return {
+    length: list.length,
+    get: (index) => list.get(index),
+    getField: (index, field) => list.getField(index, field),
+    release: () => {
+      globals.__ContactsManagerReleaseContactList?.(handle);
+    },
+  };
+}
+
 /**
  * Fetch a single contact by ID
  * @param id The identifier of the contact to fetch
@@ -174,6 +299,32 @@ export function fetchContactWithId(id: string): Promise<Contact> {
   return RNContactService.fetchContactWithId(id);
 }
 
+/**
+ * Choose how contact photos are returned by the fetch methods
+ * Android only supports 'inline'.
+ * @param mode 'inline' (default) to send base64 image data, 'handle' to send an imageId
+ * @returns Promise resolving to success status
+ */
+export function setImageTransferMode(
+  mode: ImageTransferMode
+): Promise<boolean> {
+  console.log(`Setting image transfer mode: ${mode}...`);
+  return RNContactService.setImageTransferMode(mode);
+}
+
+/**
+ * Load the bytes of a contact photo by its imageId (iOS only; Android sends photos inline)
+ * @param imageId The imageId returned on the contact
+ * @param sizeClass Which size of the photo to load
+ * @returns Promise resolving to base64 image data, or null if the photo is gone or changed
+ */
+export function getContactImage(
+  imageId: string,
+  sizeClass: ImageSizeClass = 'thumbnail'
+): Promise<string | null> {
+  return RNContactService.getContactImage(imageId, sizeClass);
+}
+
 /**
  * Get the total count of contacts
  * @returns Promise resolving to the count
@@ -229,6 +380,27 @@ export function getContactsForSync(): Promise<Contact[]> {
   return RNContactService.getContactsForSync();
 }
 
+/**
+ * Get only the contacts added, updated or deleted since the last committed sync.
+ * The changes are replayed until commitContactChanges is called with their token.
+ * Android has no change history, so every change set there is a full scan with all contacts added.
+ * @returns Promise resolving to the pending changes
+ */
+export function getContactChangesForSync(): Promise<ContactChanges> {
+  console.log('Getting contact changes for sync...');
+  return RNContactService.getContactChangesForSync();
+}
+
+/**
+ * Mark the changes returned by getContactChangesForSync as synced
+ * @param token The token of the synced changes
+ * @returns Promise resolving to false if the token is not the pending changes' token
+ */
+export function commitContactChanges(token: string): Promise<boolean> {
+  console.log('Committing contact changes...');
+  return RNContactService.commitContactChanges(token);
+}
+
 /**
  * Start a sync operation
  * @param sourceId The source ID for sync
@@ -263,13 +435,19 @@ export const ContactsService = {
   fetchContacts,
   fetchContactsWithFieldType,
   fetchContactsWithBatch,
+  openContactCursor,
+  fetchContactList,
   fetchContactWithId,
+  setImageTransferMode,
+  getContactImage,
   getContactsCount,
   enableBackgroundSync,
   scheduleBackgroundSyncTask,
   checkHealth,
   hasContactChanged,
   getContactsForSync,
+  getContactChangesForSync,
+  commitContactChanges,
   startSync,
   cancelSync,
 };
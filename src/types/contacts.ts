@@ -118,8 +118,9 @@ export type Contact = {
 
   // Image data
   imageUrl?: string;
-  imageData?: string; // base64 encoded
-  thumbnailImageData?: string; // base64 encoded
+  imageData?: string; // base64 encoded, only in 'inline' image transfer mode
+  thumbnailImageData?: string; // base64 encoded, only in 'inline' image transfer mode
+  imageId?: string; // opaque image handle, resolve with getContactImage
   imageDataAvailable?: boolean;
 
   // Extra data
@@ -138,3 +139,66 @@ export type Contact = {
   sourceId?: string;
   createdAt: number;
 };
+
+/**
+ * One page pulled from a ContactCursor
+ */
+export interface ContactCursorPage {
+  contacts: Contact[];
+  /** True once the address book is exhausted; the cursor is then closed */
+  done: boolean;
+}
+
+/**
+ * Pull-based cursor over a single enumeration of the address book.
+ * Native reads only a bounded window ahead of what has been pulled,
+ * so stop calling next() once the list view is full and close() the cursor.
+ */
+export interface ContactCursor {
+  /** Pull up to count contacts; a call made while another is pending waits for it */
+  next(count: number): Promise<ContactCursorPage>;
+  /** Stop the enumeration and free native resources */
+  close(): Promise<void>;
+}
+
+/**
+ * How contact photos are returned by the fetch methods.
+ * 'inline' (default) sends base64 imageData/thumbnailImageData; 'handle' opts in to an imageId
+ * resolved through getContactImage, which keeps photo bytes off the bridge until rendered.
+ */
+export type ImageTransferMode = 'handle' | 'inline';
+
+/**
+ * Size class requested from getContactImage
+ */
+export type ImageSizeClass = 'thumbnail' | 'full';
+
+/**
+ * Contact list backed by a native columnar snapshot.
+ * Rows and fields are read on demand instead of shipping one object per contact.
+ */
+export interface ContactList {
+  /** Number of contacts in the snapshot */
+  readonly length: number;
+  /** Lazy view of the contact at the given index */
+  get(index: number): Contact;
+  /** Reads a single field without creating a row view */
+  getField<K extends keyof Contact>(index: number, field: K): Contact[K];
+  /** Frees the native snapshot; the list must not be used afterwards */
+  release(): void;
+}
+
+/**
+ * Contacts changed in the address book since the last committed sync.
+ * Read from the store's change history; when that is unavailable or expired
+ * every contact is hashed once and fullScan is set.
+ */
+export interface ContactChanges {
+  added: Contact[];
+  updated: Contact[];
+  deletedIds: string[];
+  /** True when the change history could not be used */
+  fullScan: boolean;
+  /** Pass to commitContactChanges once the changes are synced */
+  token: string;
+}